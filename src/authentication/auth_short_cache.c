@@ -0,0 +1,371 @@
+#include "auth_short_cache.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/random.h>
+
+#include "authentication.h"
+
+typedef struct AuthShortCacheEntry {
+    uint64_t handle;
+    uint64_t credential_hash;
+    Rpc__AuthSysParams *authsysparams;
+
+    // next entries in the buckets of this entry's handle and of its credential
+    struct AuthShortCacheEntry *next_by_handle;
+    struct AuthShortCacheEntry *next_by_credential;
+
+    // neighbouring entries in the list of all entries, ordered from the most to the least recently used one
+    struct AuthShortCacheEntry *lru_prev, *lru_next;
+} AuthShortCacheEntry;
+
+/*
+ * Entries are found both by their handle (when a call with a short credential arrives) and by their credential
+ * (when a call with a full AUTH_SYS credential arrives, so that the same credential is always given the same handle).
+ */
+typedef struct AuthShortCache {
+    AuthShortCacheEntry *buckets_by_handle[AUTH_SHORT_CACHE_NUM_BUCKETS];
+    AuthShortCacheEntry *buckets_by_credential[AUTH_SHORT_CACHE_NUM_BUCKETS];
+
+    AuthShortCacheEntry *lru_head, *lru_tail;
+    size_t num_entries;
+} AuthShortCache;
+
+static AuthShortCache auth_short_cache;
+
+static pthread_mutex_t auth_short_cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static uint64_t hash_bytes(uint64_t hash, const void *bytes, size_t size) {
+    const uint8_t *data = bytes;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= data[i];
+        hash *= 1099511628211ULL;
+    }
+
+    return hash;
+}
+
+/*
+ * FNV-1a hash of the fields of an AuthSysParams that identify a client, i.e. all fields except the timestamp.
+ */
+static uint64_t hash_authsysparams(const Rpc__AuthSysParams *authsysparams) {
+    uint64_t hash = 14695981039346656037ULL;
+
+    const char *machinename = authsysparams->machinename == NULL ? "" : authsysparams->machinename;
+    hash = hash_bytes(hash, machinename, strlen(machinename));
+    hash = hash_bytes(hash, &authsysparams->uid, sizeof(authsysparams->uid));
+    hash = hash_bytes(hash, &authsysparams->gid, sizeof(authsysparams->gid));
+
+    return hash_bytes(hash, authsysparams->gids, sizeof(uint32_t) * authsysparams->n_gids);
+}
+
+static bool are_authsysparams_equal(const Rpc__AuthSysParams *a, const Rpc__AuthSysParams *b) {
+    const char *machinename_a = a->machinename == NULL ? "" : a->machinename;
+    const char *machinename_b = b->machinename == NULL ? "" : b->machinename;
+
+    return a->uid == b->uid && a->gid == b->gid && a->n_gids == b->n_gids &&
+           strcmp(machinename_a, machinename_b) == 0 &&
+           (a->n_gids == 0 || memcmp(a->gids, b->gids, sizeof(uint32_t) * a->n_gids) == 0);
+}
+
+/*
+ * Creates a heap-allocated copy of the given AuthSysParams, to be kept in the cache.
+ *
+ * Returns NULL on failure.
+ */
+static Rpc__AuthSysParams *copy_authsysparams(const Rpc__AuthSysParams *authsysparams) {
+    Rpc__AuthSysParams *copy = malloc(sizeof(Rpc__AuthSysParams));
+    if (copy == NULL) {
+        return NULL;
+    }
+    rpc__auth_sys_params__init(copy);
+
+    copy->timestamp = authsysparams->timestamp;
+    copy->uid = authsysparams->uid;
+    copy->gid = authsysparams->gid;
+
+    copy->machinename = strdup(authsysparams->machinename == NULL ? "" : authsysparams->machinename);
+    copy->gids = malloc(sizeof(uint32_t) * (authsysparams->n_gids > 0 ? authsysparams->n_gids : 1));
+    if (copy->machinename == NULL || copy->gids == NULL) {
+        free(copy->machinename);
+        free(copy->gids);
+        free(copy);
+        return NULL;
+    }
+    copy->n_gids = authsysparams->n_gids;
+    if (copy->n_gids > 0) {
+        memcpy(copy->gids, authsysparams->gids, sizeof(uint32_t) * copy->n_gids);
+    }
+
+    return copy;
+}
+
+static void free_auth_short_cache_entry(AuthShortCacheEntry *entry) {
+    free(entry->authsysparams->machinename);
+    free(entry->authsysparams->gids);
+    free(entry->authsysparams);
+    free(entry);
+}
+
+static size_t get_handle_bucket(uint64_t handle) {
+    return (size_t)handle & (AUTH_SHORT_CACHE_NUM_BUCKETS - 1);
+}
+
+static size_t get_credential_bucket(uint64_t credential_hash) {
+    return (size_t)credential_hash & (AUTH_SHORT_CACHE_NUM_BUCKETS - 1);
+}
+
+/*
+ * Returns the entry with the given handle, or NULL if there's none.
+ */
+static AuthShortCacheEntry *lookup_entry_by_handle(uint64_t handle) {
+    AuthShortCacheEntry *entry = auth_short_cache.buckets_by_handle[get_handle_bucket(handle)];
+    while (entry != NULL && entry->handle != handle) {
+        entry = entry->next_by_handle;
+    }
+
+    return entry;
+}
+
+/*
+ * Places a fresh handle, that isn't the handle of any entry in the cache, in 'handle'.
+ *
+ * Each handle is drawn from the kernel's random number generator, so that a client that sees its own handle
+ * can't guess the handles of other clients, nor take a handle given out by an earlier run of the server for one
+ * given out by this one.
+ *
+ * Returns 0 on success and > 0 on failure.
+ */
+static int generate_auth_short_handle(uint64_t *handle) {
+    do {
+        uint8_t *random_bytes = (uint8_t *)handle;
+        size_t num_random_bytes = 0;
+        while (num_random_bytes < sizeof(uint64_t)) {
+            ssize_t n = getrandom(random_bytes + num_random_bytes, sizeof(uint64_t) - num_random_bytes, 0);
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                perror("generate_auth_short_handle: getrandom failed");
+                return 1;
+            }
+            num_random_bytes += n;
+        }
+    } while (lookup_entry_by_handle(*handle) != NULL);
+
+    return 0;
+}
+
+static void encode_auth_short_handle(uint64_t handle, uint8_t *out) {
+    for (int i = AUTH_SHORT_HANDLE_SIZE - 1; i >= 0; i--) {
+        out[i] = handle & 0xff;
+        handle >>= 8;
+    }
+}
+
+static uint64_t decode_auth_short_handle(const uint8_t *bytes) {
+    uint64_t handle = 0;
+    for (int i = 0; i < AUTH_SHORT_HANDLE_SIZE; i++) {
+        handle = (handle << 8) | bytes[i];
+    }
+
+    return handle;
+}
+
+/*
+ * LRU list
+ */
+
+static void unlink_from_lru_list(AuthShortCacheEntry *entry) {
+    if (entry->lru_prev != NULL) {
+        entry->lru_prev->lru_next = entry->lru_next;
+    } else {
+        auth_short_cache.lru_head = entry->lru_next;
+    }
+    if (entry->lru_next != NULL) {
+        entry->lru_next->lru_prev = entry->lru_prev;
+    } else {
+        auth_short_cache.lru_tail = entry->lru_prev;
+    }
+
+    entry->lru_prev = entry->lru_next = NULL;
+}
+
+static void push_to_lru_list_front(AuthShortCacheEntry *entry) {
+    entry->lru_prev = NULL;
+    entry->lru_next = auth_short_cache.lru_head;
+    if (auth_short_cache.lru_head != NULL) {
+        auth_short_cache.lru_head->lru_prev = entry;
+    } else {
+        auth_short_cache.lru_tail = entry;
+    }
+    auth_short_cache.lru_head = entry;
+}
+
+static void mark_as_most_recently_used(AuthShortCacheEntry *entry) {
+    if (auth_short_cache.lru_head == entry) {
+        return;
+    }
+
+    unlink_from_lru_list(entry);
+    push_to_lru_list_front(entry);
+}
+
+/*
+ * Removes the least recently used entry from the cache and frees it.
+ */
+static void evict_least_recently_used_entry(void) {
+    AuthShortCacheEntry *entry = auth_short_cache.lru_tail;
+    if (entry == NULL) {
+        return;
+    }
+
+    AuthShortCacheEntry **link = &auth_short_cache.buckets_by_handle[get_handle_bucket(entry->handle)];
+    while (*link != entry) {
+        link = &(*link)->next_by_handle;
+    }
+    *link = entry->next_by_handle;
+
+    link = &auth_short_cache.buckets_by_credential[get_credential_bucket(entry->credential_hash)];
+    while (*link != entry) {
+        link = &(*link)->next_by_credential;
+    }
+    *link = entry->next_by_credential;
+
+    unlink_from_lru_list(entry);
+    auth_short_cache.num_entries--;
+
+    free_auth_short_cache_entry(entry);
+}
+
+/*
+ * Places the short handle for the given AUTH_SYS credential in 'handle', which must have room for
+ * AUTH_SHORT_HANDLE_SIZE bytes. A credential the server has already handed out a handle for is given the same handle
+ * again, and any other credential is remembered under a fresh handle.
+ *
+ * Returns 0 on success and > 0 on failure.
+ */
+int issue_auth_short_handle(const Rpc__AuthSysParams *authsysparams, uint8_t *handle) {
+    if (authsysparams == NULL || handle == NULL) {
+        return 1;
+    }
+
+    uint64_t credential_hash = hash_authsysparams(authsysparams);
+    size_t credential_bucket = get_credential_bucket(credential_hash);
+
+    pthread_mutex_lock(&auth_short_cache_mutex);
+
+    for (AuthShortCacheEntry *entry = auth_short_cache.buckets_by_credential[credential_bucket]; entry != NULL;
+         entry = entry->next_by_credential) {
+        if (entry->credential_hash == credential_hash &&
+            are_authsysparams_equal(entry->authsysparams, authsysparams)) {
+            mark_as_most_recently_used(entry);
+            encode_auth_short_handle(entry->handle, handle);
+
+            pthread_mutex_unlock(&auth_short_cache_mutex);
+            return 0;
+        }
+    }
+
+    AuthShortCacheEntry *entry = malloc(sizeof(AuthShortCacheEntry));
+    if (entry == NULL) {
+        pthread_mutex_unlock(&auth_short_cache_mutex);
+        fprintf(stderr, "issue_auth_short_handle: failed to allocate memory\n");
+        return 2;
+    }
+    entry->authsysparams = copy_authsysparams(authsysparams);
+    if (entry->authsysparams == NULL) {
+        pthread_mutex_unlock(&auth_short_cache_mutex);
+        fprintf(stderr, "issue_auth_short_handle: failed to allocate memory\n");
+        free(entry);
+        return 3;
+    }
+
+    if (auth_short_cache.num_entries >= AUTH_SHORT_CACHE_CAPACITY) {
+        evict_least_recently_used_entry();
+    }
+
+    if (generate_auth_short_handle(&entry->handle) > 0) {
+        pthread_mutex_unlock(&auth_short_cache_mutex);
+        fprintf(stderr, "issue_auth_short_handle: failed to generate a handle\n");
+        free_auth_short_cache_entry(entry);
+        return 4;
+    }
+    entry->credential_hash = credential_hash;
+
+    size_t handle_bucket = get_handle_bucket(entry->handle);
+    entry->next_by_handle = auth_short_cache.buckets_by_handle[handle_bucket];
+    auth_short_cache.buckets_by_handle[handle_bucket] = entry;
+    entry->next_by_credential = auth_short_cache.buckets_by_credential[credential_bucket];
+    auth_short_cache.buckets_by_credential[credential_bucket] = entry;
+
+    push_to_lru_list_front(entry);
+    auth_short_cache.num_entries++;
+
+    encode_auth_short_handle(entry->handle, handle);
+
+    pthread_mutex_unlock(&auth_short_cache_mutex);
+
+    return 0;
+}
+
+/*
+ * Returns an AUTH_SYS OpaqueAuth with the credential that the given short handle was handed out for, or NULL if the
+ * handle was not handed out by this server or has been forgotten since, or if the credential couldn't be copied.
+ *
+ * The user of this function takes the responsibility to deallocate the returned OpaqueAuth using
+ * 'free_opaque_auth' function.
+ */
+Rpc__OpaqueAuth *expand_auth_short_handle(const uint8_t *handle, size_t handle_size) {
+    if (handle == NULL || handle_size != AUTH_SHORT_HANDLE_SIZE) {
+        return NULL;
+    }
+
+    uint64_t decoded_handle = decode_auth_short_handle(handle);
+
+    pthread_mutex_lock(&auth_short_cache_mutex);
+
+    AuthShortCacheEntry *entry = lookup_entry_by_handle(decoded_handle);
+    if (entry == NULL) {
+        pthread_mutex_unlock(&auth_short_cache_mutex);
+        return NULL;
+    }
+    mark_as_most_recently_used(entry);
+
+    // copied out while the cache is locked, as the entry may be evicted as soon as it is unlocked
+    Rpc__AuthSysParams *authsysparams = entry->authsysparams;
+    Rpc__OpaqueAuth *credential =
+        create_auth_sys_opaque_auth(authsysparams->machinename, authsysparams->uid, authsysparams->gid,
+                                    authsysparams->n_gids, authsysparams->gids);
+    if (credential != NULL) {
+        credential->auth_sys->timestamp = authsysparams->timestamp;
+    }
+
+    pthread_mutex_unlock(&auth_short_cache_mutex);
+
+    return credential;
+}
+
+/*
+ * Forgets all credentials the server has handed out short handles for.
+ */
+void clean_up_auth_short_cache(void) {
+    pthread_mutex_lock(&auth_short_cache_mutex);
+
+    AuthShortCacheEntry *entry = auth_short_cache.lru_head;
+    while (entry != NULL) {
+        AuthShortCacheEntry *next = entry->lru_next;
+        free_auth_short_cache_entry(entry);
+        entry = next;
+    }
+
+    memset(auth_short_cache.buckets_by_handle, 0, sizeof(auth_short_cache.buckets_by_handle));
+    memset(auth_short_cache.buckets_by_credential, 0, sizeof(auth_short_cache.buckets_by_credential));
+    auth_short_cache.lru_head = auth_short_cache.lru_tail = NULL;
+    auth_short_cache.num_entries = 0;
+
+    pthread_mutex_unlock(&auth_short_cache_mutex);
+}
@@ -0,0 +1,33 @@
+#ifndef auth_short_cache__header__INCLUDED
+#define auth_short_cache__header__INCLUDED
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "src/serialization/rpc/rpc.pb-c.h"
+
+/*
+ * The server hands out a short handle (an AUTH_SHORT verifier) for every AUTH_SYS credential it receives, and
+ * remembers the credential behind each handle, so that clients can send the handle in place of the full AUTH_SYS
+ * credential on their following calls (RFC 5531, section 14).
+ *
+ * At most AUTH_SHORT_CACHE_CAPACITY credentials are remembered, and the least recently used one is forgotten to make
+ * room for a new one. A client whose handle has been forgotten gets an AUTH_REJECTEDCRED error and falls back to its
+ * AUTH_SYS credential.
+ */
+#ifndef AUTH_SHORT_CACHE_CAPACITY
+#define AUTH_SHORT_CACHE_CAPACITY 4096
+#endif
+
+#define AUTH_SHORT_CACHE_NUM_BUCKETS 1024 // must be a power of 2
+
+#define AUTH_SHORT_HANDLE_SIZE 8 // size in bytes of the handles handed out by this server
+
+int issue_auth_short_handle(const Rpc__AuthSysParams *authsysparams, uint8_t *handle);
+
+Rpc__OpaqueAuth *expand_auth_short_handle(const uint8_t *handle, size_t handle_size);
+
+void clean_up_auth_short_cache(void);
+
+#endif /* auth_short_cache__header__INCLUDED */
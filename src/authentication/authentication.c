@@ -7,13 +7,13 @@
  * constructed OpaqueAuth using free_opaque_auth function.
  */
 Rpc__OpaqueAuth *create_auth_none_opaque_auth(void) {
-    Rpc__OpaqueAuth *opaque_auth = malloc(sizeof(Rpc__OpaqueAuth));
+    Rpc__OpaqueAuth *opaque_auth = rpc_arena_alloc(sizeof(Rpc__OpaqueAuth));
     rpc__opaque_auth__init(opaque_auth);
 
     opaque_auth->flavor = RPC__AUTH_FLAVOR__AUTH_NONE;
     opaque_auth->body_case = RPC__OPAQUE_AUTH__BODY_EMPTY;
 
-    Google__Protobuf__Empty *empty = malloc(sizeof(Google__Protobuf__Empty));
+    Google__Protobuf__Empty *empty = rpc_arena_alloc(sizeof(Google__Protobuf__Empty));
     google__protobuf__empty__init(empty);
     opaque_auth->empty = empty;
 
@@ -29,32 +29,32 @@ Rpc__OpaqueAuth *create_auth_none_opaque_auth(void) {
  */
 Rpc__OpaqueAuth *create_auth_sys_opaque_auth(char *machine_name, uint32_t uid, uint32_t gid, uint32_t number_of_gids,
                                              uint32_t *gids) {
-    Rpc__OpaqueAuth *opaque_auth = malloc(sizeof(Rpc__OpaqueAuth));
+    Rpc__OpaqueAuth *opaque_auth = rpc_arena_alloc(sizeof(Rpc__OpaqueAuth));
     rpc__opaque_auth__init(opaque_auth);
 
     opaque_auth->flavor = RPC__AUTH_FLAVOR__AUTH_SYS;
     opaque_auth->body_case = RPC__OPAQUE_AUTH__BODY_AUTH_SYS;
 
-    Rpc__AuthSysParams *authsysparams = malloc(sizeof(Rpc__AuthSysParams));
+    Rpc__AuthSysParams *authsysparams = rpc_arena_alloc(sizeof(Rpc__AuthSysParams));
     rpc__auth_sys_params__init(authsysparams);
     authsysparams->timestamp = time(NULL);
 
     if (strlen(machine_name) <= MAX_MACHINENAME_LEN) {
-        authsysparams->machinename = strdup(machine_name);
+        authsysparams->machinename = rpc_arena_strdup(machine_name);
     } else {
         // truncate the name down to MAX_MACHINENAME_LEN characters
         char name[MAX_MACHINENAME_LEN + 1];
         memcpy(name, machine_name, MAX_MACHINENAME_LEN);
         name[MAX_MACHINENAME_LEN] = '\0';
 
-        authsysparams->machinename = strdup(name);
+        authsysparams->machinename = rpc_arena_strdup(name);
     }
 
     authsysparams->uid = uid;
     authsysparams->gid = gid;
 
     authsysparams->n_gids = number_of_gids <= MAX_N_GIDS ? number_of_gids : MAX_N_GIDS;
-    authsysparams->gids = malloc(sizeof(uint32_t) * authsysparams->n_gids);
+    authsysparams->gids = rpc_arena_alloc(sizeof(uint32_t) * authsysparams->n_gids);
     for (int offset = 0; offset < authsysparams->n_gids; offset++) {
         authsysparams->gids[offset] = gids[offset];
     }
@@ -64,10 +64,30 @@ Rpc__OpaqueAuth *create_auth_sys_opaque_auth(char *machine_name, uint32_t uid, u
     return opaque_auth;
 }
 
+/*
+ * Creates a OpaqueAuth with AUTH_SHORT flavor carrying a copy of the given short handle.
+ *
+ * The user of this function takes the responsibility to deallocate the
+ * constructed OpaqueAuth using free_opaque_auth function.
+ */
+Rpc__OpaqueAuth *create_auth_short_opaque_auth(const uint8_t *handle, size_t handle_size) {
+    Rpc__OpaqueAuth *opaque_auth = rpc_arena_alloc(sizeof(Rpc__OpaqueAuth));
+    rpc__opaque_auth__init(opaque_auth);
+
+    opaque_auth->flavor = RPC__AUTH_FLAVOR__AUTH_SHORT;
+    opaque_auth->body_case = RPC__OPAQUE_AUTH__BODY_AUTH_SHORT;
+
+    opaque_auth->auth_short.data = rpc_arena_alloc(handle_size);
+    memcpy(opaque_auth->auth_short.data, handle, handle_size);
+    opaque_auth->auth_short.len = handle_size;
+
+    return opaque_auth;
+}
+
 /*
  * Deallocates all heap-allocated fields of the given OpaqueAuth and
  * the OpaqueAuth itself.
- * Works only for OpaqueAuth's with AUTH_NONE or AUTH_SYS flavor.
+ * Works only for OpaqueAuth's with AUTH_NONE, AUTH_SYS, or AUTH_SHORT flavor.
  *
  * Does nothing if the opaque_auth is NULL.
  */
@@ -77,21 +97,24 @@ void free_opaque_auth(Rpc__OpaqueAuth *opaque_auth) {
     }
 
     if (opaque_auth->flavor == RPC__AUTH_FLAVOR__AUTH_NONE) {
-        free(opaque_auth->empty);
-        free(opaque_auth);
+        rpc_arena_free(opaque_auth->empty);
+        rpc_arena_free(opaque_auth);
     } else if (opaque_auth->flavor == RPC__AUTH_FLAVOR__AUTH_SYS) {
         if (opaque_auth->auth_sys == NULL) {
-            free(opaque_auth);
+            rpc_arena_free(opaque_auth);
             return;
         }
 
         Rpc__AuthSysParams *authsysparams = opaque_auth->auth_sys;
-        free(authsysparams->machinename);
+        rpc_arena_free(authsysparams->machinename);
 
-        free(authsysparams->gids);
+        rpc_arena_free(authsysparams->gids);
 
-        free(authsysparams);
+        rpc_arena_free(authsysparams);
 
-        free(opaque_auth);
+        rpc_arena_free(opaque_auth);
+    } else if (opaque_auth->flavor == RPC__AUTH_FLAVOR__AUTH_SHORT) {
+        rpc_arena_free(opaque_auth->auth_short.data);
+        rpc_arena_free(opaque_auth);
     }
 }
@@ -3,9 +3,12 @@
 
 #define MAX_MACHINENAME_LEN 255 // max length of the machinename string in AuthSysParams
 #define MAX_N_GIDS 32           // max number of gids in AuthSysParams
+#define MAX_AUTH_SHORT_SIZE 400 // max size of the short handle in an AUTH_SHORT OpaqueAuth
 
 #include "src/serialization/rpc/rpc.pb-c.h"
 
+#include "src/common_rpc/rpc_arena.h"
+
 #include "time.h"
 #include <stdlib.h>
 #include <string.h>
@@ -15,6 +18,8 @@ Rpc__OpaqueAuth *create_auth_none_opaque_auth(void);
 Rpc__OpaqueAuth *create_auth_sys_opaque_auth(char *machine_name, uint32_t uid, uint32_t gid, uint32_t number_of_gids,
                                              uint32_t *gids);
 
+Rpc__OpaqueAuth *create_auth_short_opaque_auth(const uint8_t *handle, size_t handle_size);
+
 void free_opaque_auth(Rpc__OpaqueAuth *opaque_auth);
 
 #endif /* authentication__header__INCLUDED */
\ No newline at end of file
@@ -89,9 +89,12 @@ int validate_rpc_reply_structure(Rpc__RpcMsg *rpc_reply) {
                             "OpaqueAuth->empty, in received RPC reply.\n");
             return 12;
         }
-    }
-    // TODO (QNFS-52): Implement AUTH_SHORT
-    else {
+    } else if (verifier->flavor == RPC__AUTH_FLAVOR__AUTH_SHORT) {
+        if (verifier->body_case != RPC__OPAQUE_AUTH__BODY_AUTH_SHORT) {
+            fprintf(stderr, "Something went wrong at server - inconsistent OpaqueAuth->flavor and body_case.\n");
+            return 11;
+        }
+    } else {
         fprintf(
             stderr,
             "Something went wrong at server - verifier flavor is %d which is not supported, in received RPC reply.\n",
@@ -149,7 +152,8 @@ int validate_rpc_reply_structure(Rpc__RpcMsg *rpc_reply) {
  * it has SUCCESS AcceptStat.
  *
  * Returns 0 if the RPC message is a valid RPC reply with AcceptedReply as body and SUCCESS AcceptStat, otherwise an
- * appropriate error message is printed and an error code > 0 is returned.
+ * appropriate error message is printed and an error code > 0 is returned - RPC_PROC_UNAVAIL_ERROR_CODE if the server
+ * doesn't have the called procedure.
  */
 int validate_successful_accepted_reply(Rpc__RpcMsg *rpc_reply) {
     int error_code = validate_rpc_reply_structure(rpc_reply);
@@ -188,6 +192,9 @@ int validate_successful_accepted_reply(Rpc__RpcMsg *rpc_reply) {
                 "Accepted RPC Reply: requested RPC program version not supported, min version=%d, max version=%d\n",
                 mismatch_info->low, mismatch_info->high);
         return 4;
+    case RPC__ACCEPT_STAT__PROC_UNAVAIL:
+        fprintf(stderr, "Accepted RPC Reply with AcceptStat: PROC_UNAVAIL\n");
+        return RPC_PROC_UNAVAIL_ERROR_CODE;
     default:
         char *accept_stat = rpc_accept_stat_to_string(accepted_reply->stat);
         fprintf(stderr, "Accepted RPC Reply with AcceptStat: %s\n", accept_stat);
@@ -9,6 +9,10 @@
 
 #include "src/parsing/parsing.h"
 
+// returned by 'validate_successful_accepted_reply' for a reply saying the server doesn't have the called procedure, so
+// that clients can fall back to an older procedure
+#define RPC_PROC_UNAVAIL_ERROR_CODE 6
+
 /*
  * Functions implemented in client_common_rpc.c file.
  */
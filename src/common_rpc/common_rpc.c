@@ -4,19 +4,23 @@
  * Generates the xid for the next RPC message (no matter whether call or reply).
  */
 uint32_t generate_rpc_xid(void) {
-    static int xid = 1;
-    return xid++;
+    static uint32_t xid = 1;
+    return __atomic_fetch_add(&xid, 1, __ATOMIC_RELAXED); // RPCs are sent from several threads
 }
 
 /*
- * Deserializes the RPC message from the network representation back to a C structure.
+ * Deserializes the RPC message encoded with the given codec from the network representation back to a C structure.
+ * The type of the procedure results in an XDR encoded reply is taken from the given call body it replies to.
  * Returns NULL if deserialization was unsuccessful.
  *
  * The user of this function takes on the responsibility to call 'rpc__rpc_msg__free_unpacked(rpc_reply, NULL)'
  * when it's done using the rpc_reply and it's subfields (e.g. procedure parameters).
  */
-Rpc__RpcMsg *deserialize_rpc_msg(uint8_t *rpc_msg_buffer, size_t bytes_received) {
-    Rpc__RpcMsg *rpc_msg = rpc__rpc_msg__unpack(NULL, bytes_received, rpc_msg_buffer);
+Rpc__RpcMsg *deserialize_rpc_msg(RpcCodec codec, uint8_t *rpc_msg_buffer, size_t bytes_received,
+                                 Rpc__CallBody *replied_call_body) {
+    Rpc__RpcMsg *rpc_msg = codec == RPC_CODEC_XDR
+                               ? unpack_xdr_rpc_msg(NULL, bytes_received, rpc_msg_buffer, replied_call_body, true)
+                               : rpc__rpc_msg__unpack(NULL, bytes_received, rpc_msg_buffer);
     if (rpc_msg == NULL) {
         fprintf(stderr, "Error unpacking received message\n");
         return NULL;
@@ -7,6 +7,10 @@
 
 #include "src/serialization/rpc/rpc.pb-c.h"
 
+#include "rpc_arena.h"
+#include "rpc_codec.h"
+#include "rpc_msg_encoding.h"
+
 #define NFS_RPC_MSG_BUFFER_SIZE 20000 // size of the buffer allocated for receiving a NFS RPC message
 
 /*
@@ -15,7 +19,8 @@
 
 uint32_t generate_rpc_xid(void);
 
-Rpc__RpcMsg *deserialize_rpc_msg(uint8_t *rpc_msg_buffer, size_t bytes_received);
+Rpc__RpcMsg *deserialize_rpc_msg(RpcCodec codec, uint8_t *rpc_msg_buffer, size_t bytes_received,
+                                 Rpc__CallBody *replied_call_body);
 
 void log_rpc_msg_info(Rpc__RpcMsg *rpc_msg);
 
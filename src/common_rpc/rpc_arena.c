@@ -0,0 +1,265 @@
+#include "rpc_arena.h"
+
+#include <stdalign.h>
+
+#define RPC_ARENA_ALIGNMENT alignof(max_align_t)
+#define RPC_ARENA_ALIGN_UP(size) (((size) + RPC_ARENA_ALIGNMENT - 1) & ~(RPC_ARENA_ALIGNMENT - 1))
+
+/*
+ * A block of memory allocations are bumped from. The header is followed by 'capacity' bytes of usable memory.
+ */
+typedef struct RpcArenaBlock {
+    struct RpcArenaBlock *next;
+    size_t capacity;
+    size_t used;
+} RpcArenaBlock;
+
+#define RPC_ARENA_BLOCK_HEADER_SIZE RPC_ARENA_ALIGN_UP(sizeof(RpcArenaBlock))
+#define RPC_ARENA_BLOCK_DATA(block) ((uint8_t *)(block) + RPC_ARENA_BLOCK_HEADER_SIZE)
+
+typedef struct RpcArena {
+    // number of 'begin_rpc_arena' calls not yet matched by 'end_rpc_arena', non-zero while serving an RPC
+    unsigned int depth;
+
+    // blocks holding the allocations of the RPC being served, the one being bumped from first
+    RpcArenaBlock *blocks;
+
+    // empty RPC_ARENA_BLOCK_SIZE blocks kept for the next RPC
+    RpcArenaBlock *free_blocks;
+    size_t num_free_blocks;
+
+    // counted for the RPC being served, and added to the totals once it's done
+    uint64_t num_allocations;
+    uint64_t num_system_allocations;
+} RpcArena;
+
+static __thread RpcArena *rpc_arena = NULL;
+
+static pthread_once_t rpc_arena_key_once = PTHREAD_ONCE_INIT;
+static pthread_key_t rpc_arena_key; // gives the arena of a thread back to the system when the thread exits
+
+static RpcArenaStats rpc_arena_stats = {0};
+
+static void free_rpc_arena_blocks(RpcArenaBlock *block) {
+    while (block != NULL) {
+        RpcArenaBlock *next = block->next;
+        free(block);
+        block = next;
+    }
+}
+
+static void destroy_rpc_arena(void *arg) {
+    RpcArena *arena = (RpcArena *)arg;
+    if (arena == NULL) {
+        return;
+    }
+
+    free_rpc_arena_blocks(arena->blocks);
+    free_rpc_arena_blocks(arena->free_blocks);
+    free(arena);
+}
+
+static void create_rpc_arena_key(void) {
+    pthread_key_create(&rpc_arena_key, destroy_rpc_arena);
+}
+
+/*
+ * Returns the arena of the calling thread, creating it on first use, or NULL if it couldn't be created.
+ */
+static RpcArena *get_rpc_arena(void) {
+    if (rpc_arena != NULL) {
+        return rpc_arena;
+    }
+
+    RpcArena *arena = calloc(1, sizeof(RpcArena));
+    if (arena == NULL) {
+        fprintf(stderr, "get_rpc_arena: failed to allocate memory\n");
+        return NULL;
+    }
+
+    pthread_once(&rpc_arena_key_once, create_rpc_arena_key);
+    pthread_setspecific(rpc_arena_key, arena);
+
+    rpc_arena = arena;
+
+    return arena;
+}
+
+/*
+ * Makes the given arena bump allocate from a block with at least 'size' bytes free, taking it from the
+ * retained blocks if one is big enough, and allocating it otherwise.
+ *
+ * Returns the block on success, and NULL on failure.
+ */
+static RpcArenaBlock *add_rpc_arena_block(RpcArena *arena, size_t size) {
+    RpcArenaBlock *block = NULL;
+    if (size <= RPC_ARENA_BLOCK_SIZE && arena->free_blocks != NULL) {
+        block = arena->free_blocks;
+        arena->free_blocks = block->next;
+        arena->num_free_blocks--;
+    } else {
+        size_t capacity = size > RPC_ARENA_BLOCK_SIZE ? size : RPC_ARENA_BLOCK_SIZE;
+        block = malloc(RPC_ARENA_BLOCK_HEADER_SIZE + capacity);
+        if (block == NULL) {
+            fprintf(stderr, "add_rpc_arena_block: failed to allocate memory\n");
+            return NULL;
+        }
+        block->capacity = capacity;
+        arena->num_system_allocations++;
+    }
+    block->used = 0;
+
+    RpcArenaBlock *current_block = arena->blocks;
+    if (current_block != NULL && size > RPC_ARENA_BLOCK_SIZE / 4 &&
+        current_block->capacity - current_block->used >= RPC_ARENA_BLOCK_SIZE / 4) {
+        // a large allocation goes in a block behind the current one, which smaller allocations keep filling
+        block->next = current_block->next;
+        current_block->next = block;
+    } else {
+        block->next = arena->blocks;
+        arena->blocks = block;
+    }
+
+    return block;
+}
+
+/*
+ * Starts serving an RPC on the calling thread - until 'end_rpc_arena' is called, everything allocated with the
+ * arena functions is taken from the arena of the thread.
+ */
+void begin_rpc_arena(void) {
+    RpcArena *arena = get_rpc_arena();
+    if (arena == NULL) {
+        return; // allocations will fall back to malloc()
+    }
+
+    if (arena->depth++ > 0) {
+        return; // an RPC served while serving another one shares the arena of the outer RPC
+    }
+    arena->num_allocations = 0;
+    arena->num_system_allocations = 0;
+}
+
+/*
+ * Finishes serving an RPC on the calling thread, releasing everything allocated from its arena since the
+ * matching 'begin_rpc_arena' at once. Nothing allocated in the meantime may be used after this.
+ */
+void end_rpc_arena(void) {
+    RpcArena *arena = rpc_arena;
+    if (arena == NULL || arena->depth == 0 || --arena->depth > 0) {
+        return;
+    }
+
+    RpcArenaBlock *block = arena->blocks;
+    while (block != NULL) {
+        RpcArenaBlock *next = block->next;
+
+        if (block->capacity == RPC_ARENA_BLOCK_SIZE && arena->num_free_blocks < RPC_ARENA_MAX_RETAINED_BLOCKS) {
+            block->next = arena->free_blocks;
+            arena->free_blocks = block;
+            arena->num_free_blocks++;
+        } else {
+            free(block);
+        }
+
+        block = next;
+    }
+    arena->blocks = NULL;
+
+    __atomic_fetch_add(&rpc_arena_stats.num_rpcs, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&rpc_arena_stats.num_arena_allocations, arena->num_allocations, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&rpc_arena_stats.num_system_allocations, arena->num_system_allocations, __ATOMIC_RELAXED);
+}
+
+/*
+ * Allocates 'size' bytes, aligned for any type, from the arena of the calling thread if it is serving an RPC,
+ * and with malloc() otherwise.
+ *
+ * Returns NULL on failure.
+ *
+ * The user of this function takes the responsibility to free the allocated memory with 'rpc_arena_free'.
+ */
+void *rpc_arena_alloc(size_t size) {
+    RpcArena *arena = rpc_arena;
+    if (arena == NULL || arena->depth == 0) {
+        __atomic_fetch_add(&rpc_arena_stats.num_system_allocations, 1, __ATOMIC_RELAXED);
+        return malloc(size);
+    }
+
+    size_t aligned_size = RPC_ARENA_ALIGN_UP(size > 0 ? size : 1);
+
+    RpcArenaBlock *block = arena->blocks;
+    if (block == NULL || block->capacity - block->used < aligned_size) {
+        block = add_rpc_arena_block(arena, aligned_size);
+        if (block == NULL) {
+            return NULL;
+        }
+    }
+
+    void *pointer = RPC_ARENA_BLOCK_DATA(block) + block->used;
+    block->used += aligned_size;
+    arena->num_allocations++;
+
+    return pointer;
+}
+
+/*
+ * Duplicates the given string with 'rpc_arena_alloc'.
+ *
+ * Returns NULL on failure.
+ */
+char *rpc_arena_strdup(const char *string) {
+    size_t length = strlen(string);
+
+    char *copy = rpc_arena_alloc(length + 1);
+    if (copy == NULL) {
+        return NULL;
+    }
+    memcpy(copy, string, length + 1);
+
+    return copy;
+}
+
+/*
+ * Frees memory allocated with 'rpc_arena_alloc'. Memory in the arena of the calling thread is left in place until
+ * the RPC being served finishes, and anything else is given to free().
+ *
+ * Does nothing if the given 'pointer' is NULL.
+ */
+void rpc_arena_free(void *pointer) {
+    if (pointer == NULL) {
+        return;
+    }
+
+    RpcArena *arena = rpc_arena;
+    if (arena != NULL && arena->depth > 0) {
+        for (RpcArenaBlock *block = arena->blocks; block != NULL; block = block->next) {
+            uint8_t *block_data = RPC_ARENA_BLOCK_DATA(block);
+            if ((uint8_t *)pointer >= block_data && (uint8_t *)pointer < block_data + block->used) {
+                return;
+            }
+        }
+    }
+
+    free(pointer);
+}
+
+/*
+ * Places the totals of arena allocations over all threads so far in 'stats'.
+ */
+void get_rpc_arena_stats(RpcArenaStats *stats) {
+    stats->num_rpcs = __atomic_load_n(&rpc_arena_stats.num_rpcs, __ATOMIC_RELAXED);
+    stats->num_arena_allocations = __atomic_load_n(&rpc_arena_stats.num_arena_allocations, __ATOMIC_RELAXED);
+    stats->num_system_allocations = __atomic_load_n(&rpc_arena_stats.num_system_allocations, __ATOMIC_RELAXED);
+}
+
+static void *protobuf_c_rpc_arena_alloc(void *allocator_data, size_t size) {
+    return rpc_arena_alloc(size);
+}
+
+static void protobuf_c_rpc_arena_free(void *allocator_data, void *pointer) {
+    rpc_arena_free(pointer);
+}
+
+ProtobufCAllocator rpc_arena_allocator = {
+    .alloc = protobuf_c_rpc_arena_alloc, .free = protobuf_c_rpc_arena_free, .allocator_data = NULL};
@@ -0,0 +1,59 @@
+#ifndef rpc_arena__header__INCLUDED
+#define rpc_arena__header__INCLUDED
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <protobuf-c/protobuf-c.h>
+
+/*
+ * Every server thread has an arena, from which everything built while serving a single RPC is bump allocated:
+ * the unpacked call and procedure parameters, the procedure results, and the reply around them. Memory taken from
+ * the arena is never freed piece by piece - the whole arena is emptied at once when the reply has been sent, and
+ * its blocks are kept for the next RPC served by the same thread.
+ *
+ * Outside of an RPC (on clients, or on a server thread between two RPCs), the arena functions fall back to
+ * malloc() and free(), so the same code can build messages on both sides.
+ */
+#define RPC_ARENA_BLOCK_SIZE (64 * 1024)
+
+// number of RPC_ARENA_BLOCK_SIZE blocks a thread keeps between two RPCs - anything beyond is given back to the system
+#define RPC_ARENA_MAX_RETAINED_BLOCKS 4
+
+/*
+ * Totals over all threads since the process started.
+ */
+typedef struct RpcArenaStats {
+    uint64_t num_rpcs;
+
+    // allocations served from an arena while serving an RPC
+    uint64_t num_arena_allocations;
+
+    // calls to malloc() made for new arena blocks, and for allocations made outside of an RPC
+    uint64_t num_system_allocations;
+} RpcArenaStats;
+
+/*
+ * ProtobufCAllocator that unpacks messages into the arena of the calling thread, to be passed to every
+ * '*__unpack' and '*__free_unpacked' on the server.
+ */
+extern ProtobufCAllocator rpc_arena_allocator;
+
+void begin_rpc_arena(void);
+
+void end_rpc_arena(void);
+
+void *rpc_arena_alloc(size_t size);
+
+char *rpc_arena_strdup(const char *string);
+
+void rpc_arena_free(void *pointer);
+
+void get_rpc_arena_stats(RpcArenaStats *stats);
+
+#endif /* rpc_arena__header__INCLUDED */
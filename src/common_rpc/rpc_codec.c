@@ -0,0 +1,115 @@
+#include "rpc_codec.h"
+
+// the codec of the RPC call being served by the calling thread
+static __thread RpcCodec rpc_call_codec = RPC_CODEC_PROTOBUF;
+
+/*
+ * Tells the codec of the RPC message in the given buffer.
+ *
+ * An XDR encoded call starts with the xid, the message type CALL (0) and the RPC version 2, each 4 bytes long. A
+ * protobuf encoded RpcMsg never has four zero bytes right after its first four (at least one of them would be a
+ * field tag, and 0 is not a valid one), so everything else is taken to be protobuf.
+ */
+RpcCodec detect_rpc_codec(const uint8_t *rpc_msg_buffer, size_t rpc_msg_size) {
+    if (rpc_msg_size < 3 * XDR_UNIT_SIZE) {
+        return RPC_CODEC_PROTOBUF;
+    }
+
+    XdrDecoder decoder = {.data = rpc_msg_buffer, .size = rpc_msg_size, .offset = XDR_UNIT_SIZE};
+    uint32_t mtype = xdr_unpack_uint32(&decoder);
+    uint32_t rpcvers = xdr_unpack_uint32(&decoder);
+
+    return mtype == RPC__MSG_TYPE__CALL && rpcvers == 2 ? RPC_CODEC_XDR : RPC_CODEC_PROTOBUF;
+}
+
+/*
+ * Records the codec of the RPC call the calling thread is about to serve, so that its procedure parameters are
+ * unpacked, and its reply is encoded, with the same codec.
+ */
+void set_rpc_call_codec(RpcCodec codec) {
+    rpc_call_codec = codec;
+}
+
+/*
+ * Returns the codec of the RPC call being served by the calling thread.
+ */
+RpcCodec get_rpc_call_codec(void) {
+    return rpc_call_codec;
+}
+
+/*
+ * Returns the size of the given procedure parameters or results once encoded with the given codec.
+ */
+size_t get_rpc_payload_packed_size(RpcCodec codec, const ProtobufCMessage *message) {
+    switch (codec) {
+    case RPC_CODEC_XDR:
+        return get_xdr_message_packed_size(message);
+    case RPC_CODEC_PROTOBUF:
+    default:
+        return protobuf_c_message_get_packed_size(message);
+    }
+}
+
+/*
+ * Encodes the given procedure parameters or results with the given codec into 'buffer', which must have room for
+ * 'get_rpc_payload_packed_size' bytes.
+ *
+ * Returns the number of bytes written.
+ */
+size_t pack_rpc_payload(RpcCodec codec, const ProtobufCMessage *message, uint8_t *buffer) {
+    switch (codec) {
+    case RPC_CODEC_XDR:
+        return pack_xdr_message(message, buffer);
+    case RPC_CODEC_PROTOBUF:
+    default:
+        return protobuf_c_message_pack(message, buffer);
+    }
+}
+
+/*
+ * Decodes the procedure parameters or results of the given type in data[0, len), encoded with the given codec.
+ *
+ * Returns NULL if decoding was unsuccessful.
+ *
+ * The user of this function takes the responsibility to free the message with the '*__free_unpacked' function of
+ * its type, given the same allocator.
+ */
+void *unpack_rpc_payload(RpcCodec codec, const ProtobufCMessageDescriptor *descriptor, ProtobufCAllocator *allocator,
+                         size_t len, const uint8_t *data) {
+    switch (codec) {
+    case RPC_CODEC_XDR:
+        return unpack_xdr_message(descriptor, allocator, len, data);
+    case RPC_CODEC_PROTOBUF:
+    default:
+        return protobuf_c_message_unpack(descriptor, allocator, len, data);
+    }
+}
+
+/*
+ * Returns the size of the given RpcMsg once encoded with the given codec.
+ */
+size_t get_rpc_msg_packed_size(RpcCodec codec, const Rpc__RpcMsg *rpc_msg) {
+    switch (codec) {
+    case RPC_CODEC_XDR:
+        return get_xdr_rpc_msg_packed_size(rpc_msg);
+    case RPC_CODEC_PROTOBUF:
+    default:
+        return rpc__rpc_msg__get_packed_size(rpc_msg);
+    }
+}
+
+/*
+ * Encodes the given RpcMsg with the given codec into 'buffer', which must have room for 'get_rpc_msg_packed_size'
+ * bytes.
+ *
+ * Returns the number of bytes written.
+ */
+size_t pack_rpc_msg(RpcCodec codec, const Rpc__RpcMsg *rpc_msg, uint8_t *buffer) {
+    switch (codec) {
+    case RPC_CODEC_XDR:
+        return pack_xdr_rpc_msg(rpc_msg, buffer);
+    case RPC_CODEC_PROTOBUF:
+    default:
+        return rpc__rpc_msg__pack(rpc_msg, buffer);
+    }
+}
@@ -0,0 +1,43 @@
+#ifndef rpc_codec__header__INCLUDED
+#define rpc_codec__header__INCLUDED
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "src/serialization/rpc/rpc.pb-c.h"
+#include "src/serialization/xdr/xdr.h"
+#include <protobuf-c/protobuf-c.h>
+
+/*
+ * Wire formats RPC messages and the procedure parameters and results they carry can be encoded in.
+ *
+ * A client picks the codec of each of its connections. A server tells the codec of every call it receives from the
+ * first bytes of the call (see 'detect_rpc_codec'), and replies in the same codec.
+ */
+typedef enum RpcCodec {
+    RPC_CODEC_PROTOBUF = 0,
+    RPC_CODEC_XDR = 1 // RFC 5531 and RFC 1094
+} RpcCodec;
+
+RpcCodec detect_rpc_codec(const uint8_t *rpc_msg_buffer, size_t rpc_msg_size);
+
+void set_rpc_call_codec(RpcCodec codec);
+
+RpcCodec get_rpc_call_codec(void);
+
+size_t get_rpc_payload_packed_size(RpcCodec codec, const ProtobufCMessage *message);
+
+size_t pack_rpc_payload(RpcCodec codec, const ProtobufCMessage *message, uint8_t *buffer);
+
+void *unpack_rpc_payload(RpcCodec codec, const ProtobufCMessageDescriptor *descriptor, ProtobufCAllocator *allocator,
+                         size_t len, const uint8_t *data);
+
+size_t get_rpc_msg_packed_size(RpcCodec codec, const Rpc__RpcMsg *rpc_msg);
+
+size_t pack_rpc_msg(RpcCodec codec, const Rpc__RpcMsg *rpc_msg, uint8_t *buffer);
+
+#endif /* rpc_codec__header__INCLUDED */
@@ -0,0 +1,376 @@
+#include "rpc_compression.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <lz4.h>
+#include <zstd.h>
+
+/*
+ * zstd contexts of a thread, reused across its compressions and decompressions instead of being made for each.
+ */
+typedef struct RpcCompressionContexts {
+    ZSTD_CCtx *zstd_compression_context;
+    ZSTD_DCtx *zstd_decompression_context;
+} RpcCompressionContexts;
+
+static __thread RpcCompressionContexts *rpc_compression_contexts = NULL;
+
+static pthread_once_t rpc_compression_key_once = PTHREAD_ONCE_INIT;
+static pthread_key_t rpc_compression_key; // frees the zstd contexts of a thread when the thread exits
+
+static RpcCompressionStats rpc_compression_stats = {0};
+
+/*
+ * Leading bytes of file formats whose data is already compressed.
+ */
+typedef struct CompressedFormatSignature {
+    const uint8_t *bytes;
+    size_t size;
+} CompressedFormatSignature;
+
+static const CompressedFormatSignature compressed_format_signatures[] = {
+    {(const uint8_t *)"\x1f\x8b", 2},                 // gzip
+    {(const uint8_t *)"\x28\xb5\x2f\xfd", 4},         // zstd
+    {(const uint8_t *)"\x04\x22\x4d\x18", 4},         // LZ4 frame
+    {(const uint8_t *)"\xfd\x37\x7a\x58\x5a\x00", 6}, // xz
+    {(const uint8_t *)"BZh", 3},                      // bzip2
+    {(const uint8_t *)"PK\x03\x04", 4},               // zip, and formats built on it (docx, jar, ...)
+    {(const uint8_t *)"7z\xbc\xaf\x27\x1c", 6},       // 7z
+    {(const uint8_t *)"\x89PNG", 4},                  // PNG
+    {(const uint8_t *)"\xff\xd8\xff", 3},             // JPEG
+};
+
+static void destroy_rpc_compression_contexts(void *arg) {
+    RpcCompressionContexts *contexts = (RpcCompressionContexts *)arg;
+    if (contexts == NULL) {
+        return;
+    }
+
+    ZSTD_freeCCtx(contexts->zstd_compression_context);
+    ZSTD_freeDCtx(contexts->zstd_decompression_context);
+    free(contexts);
+}
+
+static void create_rpc_compression_key(void) {
+    pthread_key_create(&rpc_compression_key, destroy_rpc_compression_contexts);
+}
+
+/*
+ * Returns the zstd contexts of the calling thread, making them on first use.
+ *
+ * Returns NULL on failure.
+ */
+static RpcCompressionContexts *get_rpc_compression_contexts(void) {
+    if (rpc_compression_contexts != NULL) {
+        return rpc_compression_contexts;
+    }
+
+    pthread_once(&rpc_compression_key_once, create_rpc_compression_key);
+
+    RpcCompressionContexts *contexts = malloc(sizeof(RpcCompressionContexts));
+    if (contexts == NULL) {
+        return NULL;
+    }
+    contexts->zstd_compression_context = ZSTD_createCCtx();
+    contexts->zstd_decompression_context = ZSTD_createDCtx();
+    if (contexts->zstd_compression_context == NULL || contexts->zstd_decompression_context == NULL) {
+        destroy_rpc_compression_contexts(contexts);
+        return NULL;
+    }
+
+    pthread_setspecific(rpc_compression_key, contexts);
+    rpc_compression_contexts = contexts;
+
+    return contexts;
+}
+
+static uint64_t get_thread_cpu_time_ns(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+
+    return (uint64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+static bool has_compressed_format_signature(const uint8_t *data, size_t size) {
+    for (size_t i = 0; i < sizeof(compressed_format_signatures) / sizeof(compressed_format_signatures[0]); i++) {
+        const CompressedFormatSignature *signature = &compressed_format_signatures[i];
+        if (size >= signature->size && memcmp(data, signature->bytes, signature->size) == 0) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*
+ * Compresses the first RPC_COMPRESSION_SAMPLE_SIZE bytes of the given data with LZ4, the cheaper of the two
+ * compressions, and returns true if they shrank enough for the whole of the data to be worth compressing.
+ */
+static bool sample_compresses_well(const uint8_t *data, size_t size) {
+    int sample_size = size < RPC_COMPRESSION_SAMPLE_SIZE ? size : RPC_COMPRESSION_SAMPLE_SIZE;
+
+    char compressed_sample[LZ4_COMPRESSBOUND(RPC_COMPRESSION_SAMPLE_SIZE)];
+    int compressed_sample_size =
+        LZ4_compress_default((const char *)data, compressed_sample, sample_size, sizeof(compressed_sample));
+
+    return compressed_sample_size > 0 &&
+           compressed_sample_size <= sample_size - sample_size / RPC_COMPRESSION_MIN_SAVING;
+}
+
+static RpcCompressionPolicySlot *get_rpc_compression_policy_slot(RpcCompressionPolicy *policy, uint64_t file_id) {
+    RpcCompressionPolicySlot *slot = &policy->slots[file_id % RPC_COMPRESSION_POLICY_NUM_SLOTS];
+    if (slot->file_id != file_id) {
+        slot->file_id = file_id;
+        slot->compressibility = RPC_COMPRESSIBILITY_UNKNOWN;
+        slot->num_skips_left = 0;
+    }
+
+    return slot;
+}
+
+static void set_rpc_compressibility(RpcCompressionPolicy *policy, uint64_t file_id, bool compressible) {
+    pthread_mutex_lock(&policy->lock);
+
+    RpcCompressionPolicySlot *slot = get_rpc_compression_policy_slot(policy, file_id);
+    if (compressible) {
+        slot->compressibility = RPC_COMPRESSIBILITY_COMPRESSIBLE;
+        slot->num_skips_left = 0;
+    } else {
+        slot->compressibility = RPC_COMPRESSIBILITY_INCOMPRESSIBLE;
+        slot->num_skips_left = RPC_COMPRESSION_RESAMPLE_INTERVAL;
+    }
+
+    pthread_mutex_unlock(&policy->lock);
+}
+
+void init_rpc_compression_policy(RpcCompressionPolicy *policy) {
+    pthread_mutex_init(&policy->lock, NULL);
+    memset(policy->slots, 0, sizeof(policy->slots));
+}
+
+void destroy_rpc_compression_policy(RpcCompressionPolicy *policy) {
+    pthread_mutex_destroy(&policy->lock);
+}
+
+/*
+ * Returns the bitmask (1 << RpcCompression) of compressions this build supports.
+ */
+uint32_t get_supported_rpc_compressions(void) {
+#if RPC_COMPRESSION
+    return (1 << RPC_COMPRESSION_LZ4) | (1 << RPC_COMPRESSION_ZSTD);
+#else
+    return 0;
+#endif
+}
+
+/*
+ * Returns true if the given compression is one this build supports. RPC_COMPRESSION_NONE is always supported.
+ */
+bool is_rpc_compression_supported(uint32_t compression) {
+    return compression == RPC_COMPRESSION_NONE ||
+           (compression < 32 && (get_supported_rpc_compressions() & (1u << compression)) != 0);
+}
+
+/*
+ * Picks the compression a client uses on its connection to a server supporting the given bitmask of compressions,
+ * given the round trip time in microseconds to that server: LZ4 if the server is on the same LAN, as it's cheap
+ * enough to not slow down fast links, and zstd if it's across a WAN, where the bandwidth saved is worth more than the
+ * CPU time. Either falls back to the other if it's not supported on both sides.
+ */
+RpcCompression choose_rpc_compression(uint32_t server_compressions, uint64_t round_trip_time) {
+    uint32_t compressions = server_compressions & get_supported_rpc_compressions();
+
+    RpcCompression preferred = round_trip_time >= RPC_COMPRESSION_WAN_RTT ? RPC_COMPRESSION_ZSTD : RPC_COMPRESSION_LZ4;
+    RpcCompression fallback = preferred == RPC_COMPRESSION_ZSTD ? RPC_COMPRESSION_LZ4 : RPC_COMPRESSION_ZSTD;
+    if (compressions & (1 << preferred)) {
+        return preferred;
+    }
+    if (compressions & (1 << fallback)) {
+        return fallback;
+    }
+
+    return RPC_COMPRESSION_NONE;
+}
+
+/*
+ * Decides whether the given data of the file with the given ID is worth compressing. Data that is too small, or
+ * starts like an already compressed file format, is never compressed. Otherwise, the first transfer of a file samples
+ * its data, and later transfers follow the outcome - a file whose data didn't compress well is sampled again only
+ * after RPC_COMPRESSION_RESAMPLE_INTERVAL transfers.
+ */
+bool should_compress_rpc_payload_data(RpcCompressionPolicy *policy, uint64_t file_id, const uint8_t *data,
+                                      size_t size) {
+    if (size < RPC_COMPRESSION_MIN_SIZE) {
+        return false;
+    }
+
+    pthread_mutex_lock(&policy->lock);
+
+    RpcCompressionPolicySlot *slot = get_rpc_compression_policy_slot(policy, file_id);
+    RpcCompressibility compressibility = slot->compressibility;
+    if (compressibility == RPC_COMPRESSIBILITY_INCOMPRESSIBLE && slot->num_skips_left > 0) {
+        slot->num_skips_left--;
+    }
+    bool sample = compressibility == RPC_COMPRESSIBILITY_UNKNOWN ||
+                  (compressibility == RPC_COMPRESSIBILITY_INCOMPRESSIBLE && slot->num_skips_left == 0);
+
+    pthread_mutex_unlock(&policy->lock);
+
+    if (compressibility == RPC_COMPRESSIBILITY_COMPRESSIBLE) {
+        return true;
+    }
+    if (!sample) {
+        __atomic_fetch_add(&rpc_compression_stats.num_skipped, 1, __ATOMIC_RELAXED);
+        return false;
+    }
+
+    uint64_t start = get_thread_cpu_time_ns();
+    bool compressible = !has_compressed_format_signature(data, size) && sample_compresses_well(data, size);
+    __atomic_fetch_add(&rpc_compression_stats.compression_ns, get_thread_cpu_time_ns() - start, __ATOMIC_RELAXED);
+
+    set_rpc_compressibility(policy, file_id, compressible);
+    if (!compressible) {
+        __atomic_fetch_add(&rpc_compression_stats.num_skipped, 1, __ATOMIC_RELAXED);
+    }
+
+    return compressible;
+}
+
+/*
+ * Returns the largest size 'size' bytes of data can take once compressed with the given compression.
+ */
+size_t get_rpc_compression_bound(RpcCompression compression, size_t size) {
+    switch (compression) {
+    case RPC_COMPRESSION_LZ4:
+        return LZ4_compressBound(size);
+    case RPC_COMPRESSION_ZSTD:
+        return ZSTD_compressBound(size);
+    default:
+        return size;
+    }
+}
+
+/*
+ * Compresses the given data of the file with the given ID into 'compressed_data', which must have room for
+ * 'get_rpc_compression_bound' bytes, and places the compressed size in 'compressed_size'.
+ *
+ * Returns 0 on success and > 0 if the data couldn't be compressed or didn't shrink enough to be worth sending
+ * compressed, in which case the file is remembered as incompressible and its data should be sent as it is.
+ */
+int compress_rpc_payload_data(RpcCompressionPolicy *policy, RpcCompression compression, uint64_t file_id,
+                              const uint8_t *data, size_t size, uint8_t *compressed_data, size_t *compressed_size) {
+    size_t capacity = get_rpc_compression_bound(compression, size);
+
+    uint64_t start = get_thread_cpu_time_ns();
+
+    int error_code = 0;
+    switch (compression) {
+    case RPC_COMPRESSION_LZ4: {
+        int lz4_size = LZ4_compress_default((const char *)data, (char *)compressed_data, size, capacity);
+        if (lz4_size <= 0) {
+            error_code = 1;
+            break;
+        }
+        *compressed_size = lz4_size;
+        break;
+    }
+    case RPC_COMPRESSION_ZSTD: {
+        RpcCompressionContexts *contexts = get_rpc_compression_contexts();
+        if (contexts == NULL) {
+            error_code = 2;
+            break;
+        }
+        size_t zstd_size = ZSTD_compressCCtx(contexts->zstd_compression_context, compressed_data, capacity, data, size,
+                                             RPC_COMPRESSION_ZSTD_LEVEL);
+        if (ZSTD_isError(zstd_size)) {
+            error_code = 3;
+            break;
+        }
+        *compressed_size = zstd_size;
+        break;
+    }
+    default:
+        error_code = 4;
+    }
+
+    __atomic_fetch_add(&rpc_compression_stats.compression_ns, get_thread_cpu_time_ns() - start, __ATOMIC_RELAXED);
+
+    if (error_code == 0 && *compressed_size > size - size / RPC_COMPRESSION_MIN_SAVING) {
+        error_code = 5;
+    }
+    if (error_code > 0) {
+        set_rpc_compressibility(policy, file_id, false);
+        __atomic_fetch_add(&rpc_compression_stats.num_skipped, 1, __ATOMIC_RELAXED);
+
+        return error_code;
+    }
+
+    __atomic_fetch_add(&rpc_compression_stats.num_compressed, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&rpc_compression_stats.uncompressed_bytes, size, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&rpc_compression_stats.compressed_bytes, *compressed_size, __ATOMIC_RELAXED);
+
+    return 0;
+}
+
+/*
+ * Decompresses the given data, compressed with the given compression, into 'data', which must decompress to exactly
+ * 'size' bytes.
+ *
+ * Returns 0 on success and > 0 on failure.
+ */
+int decompress_rpc_payload_data(RpcCompression compression, const uint8_t *compressed_data, size_t compressed_size,
+                                uint8_t *data, size_t size) {
+    uint64_t start = get_thread_cpu_time_ns();
+
+    int error_code = 0;
+    switch (compression) {
+    case RPC_COMPRESSION_LZ4: {
+        int lz4_size = LZ4_decompress_safe((const char *)compressed_data, (char *)data, compressed_size, size);
+        if (lz4_size < 0 || (size_t)lz4_size != size) {
+            error_code = 1;
+        }
+        break;
+    }
+    case RPC_COMPRESSION_ZSTD: {
+        RpcCompressionContexts *contexts = get_rpc_compression_contexts();
+        if (contexts == NULL) {
+            error_code = 2;
+            break;
+        }
+        size_t zstd_size =
+            ZSTD_decompressDCtx(contexts->zstd_decompression_context, data, size, compressed_data, compressed_size);
+        if (ZSTD_isError(zstd_size) || zstd_size != size) {
+            error_code = 3;
+        }
+        break;
+    }
+    default:
+        error_code = 4;
+    }
+
+    if (error_code > 0) {
+        return error_code;
+    }
+
+    __atomic_fetch_add(&rpc_compression_stats.decompression_ns, get_thread_cpu_time_ns() - start, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&rpc_compression_stats.num_decompressed, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&rpc_compression_stats.decompressed_bytes, size, __ATOMIC_RELAXED);
+
+    return 0;
+}
+
+/*
+ * Places the totals of compressions and decompressions over all threads so far in 'stats'.
+ */
+void get_rpc_compression_stats(RpcCompressionStats *stats) {
+    stats->num_compressed = __atomic_load_n(&rpc_compression_stats.num_compressed, __ATOMIC_RELAXED);
+    stats->num_skipped = __atomic_load_n(&rpc_compression_stats.num_skipped, __ATOMIC_RELAXED);
+    stats->uncompressed_bytes = __atomic_load_n(&rpc_compression_stats.uncompressed_bytes, __ATOMIC_RELAXED);
+    stats->compressed_bytes = __atomic_load_n(&rpc_compression_stats.compressed_bytes, __ATOMIC_RELAXED);
+    stats->compression_ns = __atomic_load_n(&rpc_compression_stats.compression_ns, __ATOMIC_RELAXED);
+    stats->num_decompressed = __atomic_load_n(&rpc_compression_stats.num_decompressed, __ATOMIC_RELAXED);
+    stats->decompressed_bytes = __atomic_load_n(&rpc_compression_stats.decompressed_bytes, __ATOMIC_RELAXED);
+    stats->decompression_ns = __atomic_load_n(&rpc_compression_stats.decompression_ns, __ATOMIC_RELAXED);
+}
@@ -0,0 +1,121 @@
+#ifndef rpc_compression__header__INCLUDED
+#define rpc_compression__header__INCLUDED
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Compressions the file data of READ results and WRITE parameters can be sent with, an extension to RFC 1094.
+ *
+ * The server advertises the compressions it supports in the results of STATFS, and a client picks one of them for
+ * its connection - LZ4 if the server is close by, and zstd if it's across a WAN. The client asks for that compression
+ * in every READ and compresses the data of its WRITEs with it, and the server compresses the data of READ results with
+ * it, each only when the data is expected to compress well (see 'should_compress_rpc_payload_data').
+ *
+ * Only the protobuf codec carries the compression fields - the XDR codec keeps to the wire format of RFC 1094, so
+ * nothing is ever compressed over it.
+ */
+typedef enum RpcCompression {
+    RPC_COMPRESSION_NONE = 0,
+    RPC_COMPRESSION_LZ4 = 1,
+    RPC_COMPRESSION_ZSTD = 2
+} RpcCompression;
+
+/*
+ * If disabled, neither the server nor the client support any compression.
+ */
+#ifndef RPC_COMPRESSION
+#define RPC_COMPRESSION 1
+#endif
+
+// clients whose STATFS round trip takes at least this many microseconds pick zstd over LZ4
+#ifndef RPC_COMPRESSION_WAN_RTT
+#define RPC_COMPRESSION_WAN_RTT 2000
+#endif
+
+#define RPC_COMPRESSION_ZSTD_LEVEL 3
+
+// data smaller than this is never compressed
+#define RPC_COMPRESSION_MIN_SIZE 512
+
+// bytes from the start of the data compressed with LZ4 to guess whether the whole of it compresses well
+#define RPC_COMPRESSION_SAMPLE_SIZE 4096
+
+// data is only sent compressed if it shrinks by at least 1 / RPC_COMPRESSION_MIN_SAVING of its size
+#define RPC_COMPRESSION_MIN_SAVING 8
+
+// data of a file that didn't compress well is sent as it is this many times before it is sampled again
+#define RPC_COMPRESSION_RESAMPLE_INTERVAL 64
+
+#define RPC_COMPRESSION_POLICY_NUM_SLOTS 1024
+
+typedef enum RpcCompressibility {
+    RPC_COMPRESSIBILITY_UNKNOWN = 0,
+    RPC_COMPRESSIBILITY_COMPRESSIBLE = 1,
+    RPC_COMPRESSIBILITY_INCOMPRESSIBLE = 2
+} RpcCompressibility;
+
+typedef struct RpcCompressionPolicySlot {
+    uint64_t file_id;
+    RpcCompressibility compressibility;
+
+    // transfers of an incompressible file left before its data is sampled again
+    uint32_t num_skips_left;
+} RpcCompressionPolicySlot;
+
+/*
+ * Remembers how well the data of recently transferred files compressed, so that data which is already compressed
+ * (media, archives, ...) isn't compressed again on every transfer. Files are identified by their inode numbers, and
+ * a file takes over the slot of any other file whose inode number maps to the same slot.
+ */
+typedef struct RpcCompressionPolicy {
+    pthread_mutex_t lock;
+    RpcCompressionPolicySlot slots[RPC_COMPRESSION_POLICY_NUM_SLOTS];
+} RpcCompressionPolicy;
+
+/*
+ * Totals over all threads since the process started.
+ */
+typedef struct RpcCompressionStats {
+    // data sent compressed, and data sent as it is because it wasn't expected to compress well
+    uint64_t num_compressed;
+    uint64_t num_skipped;
+
+    // sizes of the data sent compressed, before and after compression
+    uint64_t uncompressed_bytes;
+    uint64_t compressed_bytes;
+
+    // thread CPU time spent sampling and compressing data
+    uint64_t compression_ns;
+
+    uint64_t num_decompressed;
+    uint64_t decompressed_bytes;
+    uint64_t decompression_ns;
+} RpcCompressionStats;
+
+void init_rpc_compression_policy(RpcCompressionPolicy *policy);
+
+void destroy_rpc_compression_policy(RpcCompressionPolicy *policy);
+
+uint32_t get_supported_rpc_compressions(void);
+
+bool is_rpc_compression_supported(uint32_t compression);
+
+RpcCompression choose_rpc_compression(uint32_t server_compressions, uint64_t round_trip_time);
+
+bool should_compress_rpc_payload_data(RpcCompressionPolicy *policy, uint64_t file_id, const uint8_t *data,
+                                      size_t size);
+
+size_t get_rpc_compression_bound(RpcCompression compression, size_t size);
+
+int compress_rpc_payload_data(RpcCompressionPolicy *policy, RpcCompression compression, uint64_t file_id,
+                              const uint8_t *data, size_t size, uint8_t *compressed_data, size_t *compressed_size);
+
+int decompress_rpc_payload_data(RpcCompression compression, const uint8_t *compressed_data, size_t compressed_size,
+                                uint8_t *data, size_t size);
+
+void get_rpc_compression_stats(RpcCompressionStats *stats);
+
+#endif /* rpc_compression__header__INCLUDED */
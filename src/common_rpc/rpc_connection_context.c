@@ -7,12 +7,18 @@
 #include <netinet/tcp.h>
 #include <sys/socket.h>
 #include <sys/types.h>
+#include <sys/un.h>
 #include <unistd.h>
 
+#include "src/transport/tcp/ktls.h"
 #include "src/transport/tcp/tcp_rpc_server.h"
 
 #include "src/transport/quic/quic_rpc_client.h"
 
+#include "src/transport/shm/shm_region.h"
+
+#include "src/nfs/nfs_common.h"
+
 /*
  * Given a RpcConnectionContext without an initialized TCP client socket,
  * creates a TCP client socket and connects it to the server given by its IPv4
@@ -64,6 +70,10 @@ int connect_to_tcp_server(RpcConnectionContext *rpc_connection_context) {
 
     tcp_client->tcp_rpc_client_socket_fd = tcp_rpc_client_socket_fd;
     pthread_mutex_init(&tcp_client->tcp_connection_mutex, NULL);
+    RecordBuffer empty_record_buffer = RECORD_BUFFER_INIT;
+    tcp_client->reply_rpc_msg_buffer = empty_record_buffer;
+    tcp_client->num_rpcs = 0;
+    tcp_client->last_stats_report_time = (struct timespec){0};
 
     transport_connection->tcp_client = tcp_client;
     rpc_connection_context->transport_connection = transport_connection;
@@ -87,6 +97,130 @@ int connect_to_tcp_server(RpcConnectionContext *rpc_connection_context) {
     return 0;
 }
 
+/*
+ * Given a RpcConnectionContext without an initialized TCP client socket, connects a TCP client socket to the
+ * server like 'connect_to_tcp_server', performs a TLS handshake with the server over it, and hands the
+ * encryption of the connection over to kernel TLS, so that RPCs are then sent over it as over plain TCP.
+ *
+ * The user of this function takes the responsibility to close the client TCP socket opened here.
+ *
+ * Returns 0 on success and > 0 on failure.
+ */
+int connect_to_tls_server(RpcConnectionContext *rpc_connection_context) {
+    int error_code = connect_to_tcp_server(rpc_connection_context);
+    if (error_code > 0) {
+        return error_code;
+    }
+
+    TcpClient *tcp_client = rpc_connection_context->transport_connection->tcp_client;
+
+    SSL_CTX *ktls_client_context = create_ktls_client_context();
+    if (ktls_client_context == NULL) {
+        error_code = 8;
+    } else {
+        error_code = perform_ktls_handshake(ktls_client_context, *tcp_client->tcp_rpc_client_socket_fd, false);
+        SSL_CTX_free(ktls_client_context);
+        if (error_code > 0) {
+            error_code = 9;
+        }
+    }
+
+    if (error_code > 0) {
+        close(*tcp_client->tcp_rpc_client_socket_fd);
+        free(tcp_client->tcp_rpc_client_socket_fd);
+        pthread_mutex_destroy(&tcp_client->tcp_connection_mutex);
+        free(tcp_client);
+
+        free(rpc_connection_context->transport_connection);
+        rpc_connection_context->transport_connection = NULL;
+    }
+
+    return error_code;
+}
+
+/*
+ * Given a RpcConnectionContext without an initialized shared-memory connection, connects to the Unix domain
+ * socket of the shared-memory server running on this host at the port in the RpcConnectionContext, maps the
+ * region of memory the server hands over through it, and saves the shared-memory client in the given
+ * RpcConnectionContext. The server IPv4 address in the RpcConnectionContext is not used.
+ *
+ * The user of this function takes the responsibility to close the Unix domain socket and unmap the region
+ * opened here.
+ *
+ * Returns 0 on success and > 0 on failure.
+ */
+int connect_to_shm_server(RpcConnectionContext *rpc_connection_context) {
+    if (rpc_connection_context == NULL) {
+        return 1;
+    }
+
+    struct sockaddr_un shm_server_addr;
+    memset(&shm_server_addr, 0, sizeof(shm_server_addr));
+    shm_server_addr.sun_family = AF_UNIX;
+    if (get_shm_socket_path(rpc_connection_context->server_port, shm_server_addr.sun_path,
+                            sizeof(shm_server_addr.sun_path)) > 0) {
+        return 2;
+    }
+
+    int unix_socket_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (unix_socket_fd < 0) {
+        perror_msg("connect_to_shm_server: Socket creation failed");
+        return 3;
+    }
+
+    if (connect(unix_socket_fd, (struct sockaddr *)&shm_server_addr, sizeof(shm_server_addr)) < 0) {
+        perror_msg("Connection to the server failed");
+
+        close(unix_socket_fd);
+
+        return 4;
+    }
+
+    // the server hands over the memory shared with it as soon as the connection is accepted
+    int shm_region_fd;
+    if (receive_shm_region_fd(unix_socket_fd, &shm_region_fd) > 0) {
+        close(unix_socket_fd);
+
+        return 5;
+    }
+    ShmRegion *shm_region = map_shm_region(shm_region_fd);
+    close(shm_region_fd);
+    if (shm_region == NULL) {
+        close(unix_socket_fd);
+
+        return 6;
+    }
+
+    TransportConnection *transport_connection = malloc(sizeof(TransportConnection));
+    if (transport_connection == NULL) {
+        unmap_shm_region(shm_region);
+        close(unix_socket_fd);
+
+        return 7;
+    }
+
+    ShmClient *shm_client = malloc(sizeof(ShmClient));
+    if (shm_client == NULL) {
+        free(transport_connection);
+        unmap_shm_region(shm_region);
+        close(unix_socket_fd);
+
+        return 8;
+    }
+
+    shm_client->unix_socket_fd = unix_socket_fd;
+    shm_client->shm_region = shm_region;
+    pthread_mutex_init(&shm_client->shm_connection_mutex, NULL);
+    RecordBuffer empty_record_buffer = RECORD_BUFFER_INIT;
+    shm_client->reply_rpc_msg_buffer = empty_record_buffer;
+    shm_client->num_rpcs = 0;
+
+    transport_connection->shm_client = shm_client;
+    rpc_connection_context->transport_connection = transport_connection;
+
+    return 0;
+}
+
 /*
  * Creates an underlying UDP socket which can be used for sending QUIC packets.
  *
@@ -116,21 +250,25 @@ int create_quic_udp_socket(char *host, char *port, struct addrinfo **peer, QuicC
     };
     quic_client->socket_fd = udp_socket;
 
+    if (init_udp_batching_context(&quic_client->udp_batching_context, udp_socket) > 0) {
+        fprintf(stderr, "create_socket: failed to set up batched I/O on socket\n");
+        return 1;
+    }
+
     return 0;
 }
 
 /*
- * Given a RpcConnectionContext without an initialized QUIC connection,
- * creates a QUIC client UDP socket and connects it to the server given by its IPv4
- * address and port in the RpcConnectionContext, and saves that QUIC connection context
- * in the given RpcConnectionContext.
+ * Creates a QUIC client with its own UDP socket and starts connecting it to the server given by its IPv4
+ * address and port in the given RpcConnectionContext, and places the QUIC client in 'created_quic_client'.
+ * The connection is established by the client's event loop thread, started by the first RPC sent over it.
  *
- * The user of this function takes the responsibility to close the QUIC connection
- * opened here.
+ * The user of this function takes the responsibility to close the QUIC connection opened here, and
+ * deallocate the QUIC client with 'free_quic_client'.
  *
  * Returns 0 on success and > 0 on failure.
  */
-int connect_to_quic_server(RpcConnectionContext *rpc_connection_context) {
+static int connect_quic_client(RpcConnectionContext *rpc_connection_context, QuicClient **created_quic_client) {
     if (rpc_connection_context == NULL) {
         return 1;
     }
@@ -143,6 +281,17 @@ int connect_to_quic_server(RpcConnectionContext *rpc_connection_context) {
     if (quic_client == NULL) {
         return 3;
     }
+    if (init_submission_ring(&quic_client->submission_ring, SUBMISSION_RING_CAPACITY) > 0) {
+        free(quic_client);
+
+        return 3;
+    }
+    if (init_submission_ring(&quic_client->retirement_ring, SUBMISSION_RING_CAPACITY) > 0) {
+        free_submission_ring(&quic_client->submission_ring);
+        free(quic_client);
+
+        return 3;
+    }
     quic_client->quic_config = NULL;
     quic_client->tls_config = NULL;
     quic_client->quic_endpoint = NULL;
@@ -154,21 +303,25 @@ int connect_to_quic_server(RpcConnectionContext *rpc_connection_context) {
     pthread_mutex_init(&quic_client->connection_established_lock, NULL);
     pthread_cond_init(&quic_client->connection_established_condition_variable, NULL);
     quic_client->connection_established = false;
+    quic_client->early_data_available = false;
 
-    pthread_mutex_init(&quic_client->stream_allocation_queue_lock, NULL);
-    quic_client->stream_allocation_queue_back = quic_client->stream_allocation_queue_front = NULL;
+    quic_client->session_cache_path = NULL;
+    quic_client->bdp_cache_path = NULL;
+    QuicResumptionState empty_resumption_state = QUIC_RESUMPTION_STATE_INIT;
+    quic_client->resumption_state = empty_resumption_state;
 
     pthread_mutex_init(&quic_client->connection_closed_lock, NULL);
     pthread_cond_init(&quic_client->connection_closed_condition_variable, NULL);
     quic_client->connection_closed = false;
 
     quic_client->main_stream = NULL;
-    quic_client->auxiliary_streams_list_head = NULL;
-    pthread_mutex_init(&quic_client->auxiliary_streams_list_lock, NULL);
+    init_stream_pool(&quic_client->auxiliary_stream_pool);
+    init_pipelined_stream(&quic_client->pipelined_stream);
+    quic_client->outstanding_bytes = 0;
+    quic_client->num_rpcs_submitted = 0;
 
-    quic_client->stream_contexts = NULL;
-    pthread_mutex_init(&quic_client->stream_contexts_list_lock, NULL);
-    pthread_cond_init(&quic_client->stream_contexts_condition_variable, NULL);
+    init_stream_context_table(&quic_client->stream_contexts);
+    quic_client->deferred_stream_contexts_front = quic_client->deferred_stream_contexts_back = NULL;
 
     int ret = 0;
 
@@ -177,6 +330,8 @@ int connect_to_quic_server(RpcConnectionContext *rpc_connection_context) {
     char port_number[10];
     sprintf(port_number, "%u", rpc_connection_context->server_port);
     if (create_quic_udp_socket(rpc_connection_context->server_ipv4_addr, port_number, &peer, quic_client) != 0) {
+        free_submission_ring(&quic_client->submission_ring);
+        free_submission_ring(&quic_client->retirement_ring);
         free(quic_client);
 
         return 4;
@@ -187,18 +342,33 @@ int connect_to_quic_server(RpcConnectionContext *rpc_connection_context) {
     if (quic_client->quic_config == NULL) {
         fprintf(stderr, "connect_to_quic_server: failed to create config\n");
 
+        free_submission_ring(&quic_client->submission_ring);
+        free_submission_ring(&quic_client->retirement_ring);
+        free_udp_batching_context(&quic_client->udp_batching_context);
         free(quic_client);
 
         return 5;
     }
     quic_config_set_recv_udp_payload_size(quic_client->quic_config, MAX_DATAGRAM_SIZE);
 
+    // size the congestion and flow control windows from the BDP measured on earlier connections to this server
+    char *session_cache_path =
+        get_quic_session_cache_path(rpc_connection_context->server_ipv4_addr, rpc_connection_context->server_port);
+    quic_client->bdp_cache_path = get_quic_bdp_cache_path(session_cache_path);
+    free(session_cache_path);
+    init_quic_transport_tuning(&quic_client->transport_tuning, load_quic_bdp(quic_client->bdp_cache_path));
+    apply_quic_transport_tuning(quic_client->quic_config, &quic_client->transport_tuning);
+
     // create and set TLS config
     const char *const protos[1] = {"rpc"};
     quic_client->tls_config = quic_tls_config_new_client_config(protos, 1, true);
     if (quic_client->tls_config == NULL) {
         fprintf(stderr, "connect_to_quic_server: failed to create TLS config\n");
 
+        free_submission_ring(&quic_client->submission_ring);
+        free_submission_ring(&quic_client->retirement_ring);
+        free_udp_batching_context(&quic_client->udp_batching_context);
+        free(quic_client->bdp_cache_path);
         free(quic_client);
 
         quic_config_free(quic_client->quic_config);
@@ -214,6 +384,10 @@ int connect_to_quic_server(RpcConnectionContext *rpc_connection_context) {
     if (quic_client->quic_endpoint == NULL) {
         fprintf(stderr, "connect_to_quic_server: failed to create quic endpoint\n");
 
+        free_submission_ring(&quic_client->submission_ring);
+        free_submission_ring(&quic_client->retirement_ring);
+        free_udp_batching_context(&quic_client->udp_batching_context);
+        free(quic_client->bdp_cache_path);
         free(quic_client);
 
         quic_config_free(quic_client->quic_config);
@@ -223,25 +397,31 @@ int connect_to_quic_server(RpcConnectionContext *rpc_connection_context) {
         return 8;
     }
 
-    // save this transport connection in the RPC connection context
-    TransportConnection *transport_connection = malloc(sizeof(TransportConnection));
-    if (transport_connection == NULL) {
-        free(quic_client);
+    // resume the last connection to this server if its TLS session was saved, so that the first RPCs can be
+    // sent as 0-RTT data
+    quic_client->session_cache_path =
+        get_quic_session_cache_path(rpc_connection_context->server_ipv4_addr, rpc_connection_context->server_port);
+    load_quic_resumption_state(quic_client->session_cache_path, &quic_client->resumption_state);
 
-        quic_config_free(quic_client->quic_config);
-        quic_tls_config_free(quic_client->tls_config);
+    // connect to the server
+    QuicResumptionState *resumption_state = &quic_client->resumption_state;
+    int error_code = quic_endpoint_connect(quic_client->quic_endpoint, (struct sockaddr *)&quic_client->local_addr,
+                                           quic_client->local_addr_len, peer->ai_addr, peer->ai_addrlen, NULL,
+                                           resumption_state->session, resumption_state->session_len,
+                                           resumption_state->token, resumption_state->token_len, NULL, NULL);
 
-        return 9;
-    }
-    transport_connection->quic_client = quic_client;
-    rpc_connection_context->transport_connection = transport_connection;
+    // the connection keeps its own copy, and a new session and token will be saved when it is closed
+    free_quic_resumption_state(&quic_client->resumption_state);
 
-    // connect to the server
-    if (quic_endpoint_connect(quic_client->quic_endpoint, (struct sockaddr *)&quic_client->local_addr,
-                              quic_client->local_addr_len, peer->ai_addr, peer->ai_addrlen, NULL, NULL, 0, NULL, 0,
-                              NULL, NULL) < 0) {
+    if (error_code < 0) {
         fprintf(stderr, "execute_rpc_call_quic: failed to connect to client\n");
 
+        free(quic_client->session_cache_path);
+
+        free_submission_ring(&quic_client->submission_ring);
+        free_submission_ring(&quic_client->retirement_ring);
+        free_udp_batching_context(&quic_client->udp_batching_context);
+        free(quic_client->bdp_cache_path);
         free(quic_client);
 
         quic_config_free(quic_client->quic_config);
@@ -254,6 +434,142 @@ int connect_to_quic_server(RpcConnectionContext *rpc_connection_context) {
     }
     freeaddrinfo(peer);
 
+    *created_quic_client = quic_client;
+
+    return 0;
+}
+
+/*
+ * Closes the QUIC connection of the given QUIC client, if its event loop thread has been started, and
+ * deallocates the QUIC client.
+ */
+static void free_quic_client(QuicClient *quic_client) {
+    if (quic_client == NULL) {
+        return;
+    }
+
+    if (quic_client->successfully_created_event_loop_thread) {
+        // make the event loop thread execute the connection closing callback
+        ev_async_send(quic_client->event_loop, &quic_client->connection_closing_async_watcher);
+
+        pthread_mutex_lock(&quic_client->connection_closed_lock);
+        while (!quic_client->connection_closed) {
+            pthread_cond_wait(&quic_client->connection_closed_condition_variable, &quic_client->connection_closed_lock);
+        }
+        pthread_mutex_unlock(&quic_client->connection_closed_lock);
+
+        pthread_join(quic_client->event_loop_thread, NULL);
+    }
+
+    if (quic_client->event_loop != NULL) {
+        ev_loop_destroy(quic_client->event_loop);
+    }
+
+    close(quic_client->socket_fd);
+    free_udp_batching_context(&quic_client->udp_batching_context);
+
+    if (quic_client->tls_config != NULL) {
+        quic_tls_config_free(quic_client->tls_config);
+    }
+    if (quic_client->quic_endpoint != NULL) {
+        quic_endpoint_free(quic_client->quic_endpoint);
+    }
+    if (quic_client->quic_config != NULL) {
+        quic_config_free(quic_client->quic_config);
+    }
+
+    free_stream_context_table(&quic_client->stream_contexts);
+
+    free_stream_pool(&quic_client->auxiliary_stream_pool);
+
+    free(quic_client->session_cache_path);
+    free_quic_resumption_state(&quic_client->resumption_state);
+    free(quic_client->bdp_cache_path);
+
+    free(quic_client->main_stream);
+    free_pipelined_stream(&quic_client->pipelined_stream);
+
+    pthread_mutex_destroy(&quic_client->connection_established_lock);
+    pthread_cond_destroy(&quic_client->connection_established_condition_variable);
+
+    free_submission_ring(&quic_client->submission_ring);
+    free_submission_ring(&quic_client->retirement_ring);
+
+    pthread_mutex_destroy(&quic_client->connection_closed_lock);
+    pthread_cond_destroy(&quic_client->connection_closed_condition_variable);
+
+    free(quic_client);
+}
+
+/*
+ * Closes all QUIC connections in the given pool, and deallocates their QUIC clients and the pool itself.
+ */
+static void free_quic_client_pool(QuicClientPool *quic_client_pool) {
+    if (quic_client_pool == NULL) {
+        return;
+    }
+
+    for (int i = 0; i < quic_client_pool->num_quic_clients; i++) {
+        free_quic_client(quic_client_pool->quic_clients[i]);
+    }
+
+    free(quic_client_pool);
+}
+
+/*
+ * Given a RpcConnectionContext without initialized QUIC connections, opens a pool of QUIC connections,
+ * each with its own UDP socket and event loop thread, to the server given by its IPv4 address and port in
+ * the RpcConnectionContext, and saves that pool in the given RpcConnectionContext.
+ *
+ * The user of this function takes the responsibility to close the QUIC connections opened here.
+ *
+ * Returns 0 on success and > 0 on failure.
+ */
+int connect_to_quic_server(RpcConnectionContext *rpc_connection_context) {
+    if (rpc_connection_context == NULL) {
+        return 1;
+    }
+
+    QuicClientPool *quic_client_pool = malloc(sizeof(QuicClientPool));
+    if (quic_client_pool == NULL) {
+        return 2;
+    }
+    quic_client_pool->num_quic_clients = 0;
+    quic_client_pool->next_quic_client = 0;
+
+    int pool_size = get_quic_client_pool_size();
+    for (int i = 0; i < pool_size; i++) {
+        int error_code = connect_quic_client(rpc_connection_context, &quic_client_pool->quic_clients[i]);
+        if (error_code > 0) {
+            fprintf(stderr, "connect_to_quic_server: failed to open QUIC connection %d with error code %d\n", i,
+                    error_code);
+
+            free_quic_client_pool(quic_client_pool);
+
+            return 3;
+        }
+        quic_client_pool->num_quic_clients++;
+    }
+
+    // at least one connection is left for non-bulk RPCs
+    quic_client_pool->num_bulk_quic_clients = QUIC_CLIENT_POOL_NUM_BULK_CONNECTIONS;
+    if (quic_client_pool->num_bulk_quic_clients > pool_size - 1) {
+        quic_client_pool->num_bulk_quic_clients = pool_size - 1;
+    }
+    if (quic_client_pool->num_bulk_quic_clients < 0) {
+        quic_client_pool->num_bulk_quic_clients = 0;
+    }
+
+    // save this transport connection in the RPC connection context
+    TransportConnection *transport_connection = malloc(sizeof(TransportConnection));
+    if (transport_connection == NULL) {
+        free_quic_client_pool(quic_client_pool);
+
+        return 4;
+    }
+    transport_connection->quic_client_pool = quic_client_pool;
+    rpc_connection_context->transport_connection = transport_connection;
+
     return 0;
 }
 
@@ -277,6 +593,16 @@ RpcConnectionContext *create_rpc_connection_context(char *server_ipv4_address, u
     rpc_connection_context->credential = credential;
     rpc_connection_context->verifier = verifier;
 
+    rpc_connection_context->rpc_codec = RPC_CODEC_PROTOBUF;
+
+    rpc_connection_context->auth_short_handle_size = 0;
+
+    rpc_connection_context->readdir2_unavailable = false;
+
+    rpc_connection_context->transfer_size = NFS_MAXDATA;
+
+    rpc_connection_context->payload_compression = RPC_COMPRESSION_NONE;
+
     int error_code;
     rpc_connection_context->transport_protocol = transport_protocol;
     switch (transport_protocol) {
@@ -292,6 +618,18 @@ RpcConnectionContext *create_rpc_connection_context(char *server_ipv4_address, u
             return NULL;
         }
         break;
+    case TRANSPORT_PROTOCOL_TLS:
+        error_code = connect_to_tls_server(rpc_connection_context);
+        if (error_code > 0) {
+            printf("create_rpc_connection_context: Failed to connect to the TLS server with error code %d\n",
+                   error_code);
+
+            free(rpc_connection_context->server_ipv4_addr);
+            free(rpc_connection_context);
+
+            return NULL;
+        }
+        break;
     case TRANSPORT_PROTOCOL_QUIC:
         error_code = connect_to_quic_server(rpc_connection_context);
         if (error_code > 0) {
@@ -304,15 +642,103 @@ RpcConnectionContext *create_rpc_connection_context(char *server_ipv4_address, u
             return NULL;
         }
         break;
+    case TRANSPORT_PROTOCOL_SHM:
+        error_code = connect_to_shm_server(rpc_connection_context);
+        if (error_code > 0) {
+            printf("create_rpc_connection_context: Failed to connect to the shared-memory server with error code %d\n",
+                   error_code);
+
+            free(rpc_connection_context->server_ipv4_addr);
+            free(rpc_connection_context);
+
+            return NULL;
+        }
+        break;
     default:
         free(rpc_connection_context->server_ipv4_addr);
         free(rpc_connection_context);
         return NULL;
     }
 
+    pthread_mutex_init(&rpc_connection_context->auth_short_mutex, NULL);
+    init_rpc_compression_policy(&rpc_connection_context->compression_policy);
+
     return rpc_connection_context;
 }
 
+/*
+ * Returns the credential to send with the next RPC call on the given connection - an AUTH_SHORT credential built in
+ * 'short_credential' if the server has handed out a short handle for the connection's credential (the handle is
+ * copied into 'short_handle', which must have room for MAX_AUTH_SHORT_SIZE bytes), and the connection's credential
+ * otherwise.
+ */
+Rpc__OpaqueAuth *get_rpc_call_credential(RpcConnectionContext *rpc_connection_context,
+                                         Rpc__OpaqueAuth *short_credential, uint8_t *short_handle) {
+    pthread_mutex_lock(&rpc_connection_context->auth_short_mutex);
+    size_t short_handle_size = rpc_connection_context->auth_short_handle_size;
+    memcpy(short_handle, rpc_connection_context->auth_short_handle, short_handle_size);
+    pthread_mutex_unlock(&rpc_connection_context->auth_short_mutex);
+
+    if (short_handle_size == 0) {
+        return rpc_connection_context->credential;
+    }
+
+    rpc__opaque_auth__init(short_credential);
+    short_credential->flavor = RPC__AUTH_FLAVOR__AUTH_SHORT;
+    short_credential->body_case = RPC__OPAQUE_AUTH__BODY_AUTH_SHORT;
+    short_credential->auth_short.data = short_handle;
+    short_credential->auth_short.len = short_handle_size;
+
+    return short_credential;
+}
+
+/*
+ * Keeps track of the short handle of the given connection's credential, given the reply to an RPC call made on it,
+ * and whether the call was sent with the short credential from 'get_rpc_call_credential'.
+ *
+ * A short handle handed out in the verifier of a successful reply is sent in place of the full credential from then
+ * on. If the server rejected a short credential as one it does not know (anymore), it is forgotten, and true is
+ * returned to tell that the call should be sent again with the full credential. Otherwise returns false.
+ */
+bool update_auth_short_handle(RpcConnectionContext *rpc_connection_context, Rpc__RpcMsg *rpc_reply,
+                              bool sent_short_credential) {
+    if (rpc_reply == NULL || rpc_reply->body_case != RPC__RPC_MSG__BODY_RBODY || rpc_reply->rbody == NULL) {
+        return false;
+    }
+    Rpc__ReplyBody *reply_body = rpc_reply->rbody;
+
+    if (reply_body->reply_case == RPC__REPLY_BODY__REPLY_RREPLY && reply_body->rreply != NULL) {
+        Rpc__RejectedReply *rejected_reply = reply_body->rreply;
+        if (!sent_short_credential || rejected_reply->stat != RPC__REJECT_STAT__AUTH_ERROR ||
+            rejected_reply->auth_stat != RPC__AUTH_STAT__AUTH_REJECTEDCRED) {
+            return false;
+        }
+
+        pthread_mutex_lock(&rpc_connection_context->auth_short_mutex);
+        rpc_connection_context->auth_short_handle_size = 0;
+        pthread_mutex_unlock(&rpc_connection_context->auth_short_mutex);
+
+        return true;
+    }
+
+    if (reply_body->reply_case != RPC__REPLY_BODY__REPLY_AREPLY || reply_body->areply == NULL ||
+        reply_body->areply->verifier == NULL) {
+        return false;
+    }
+    Rpc__OpaqueAuth *verifier = reply_body->areply->verifier;
+    if (verifier->flavor != RPC__AUTH_FLAVOR__AUTH_SHORT || verifier->body_case != RPC__OPAQUE_AUTH__BODY_AUTH_SHORT ||
+        verifier->auth_short.len == 0 || verifier->auth_short.len > MAX_AUTH_SHORT_SIZE) {
+        return false;
+    }
+
+    pthread_mutex_lock(&rpc_connection_context->auth_short_mutex);
+    memcpy(rpc_connection_context->auth_short_handle, verifier->auth_short.data, verifier->auth_short.len);
+    rpc_connection_context->auth_short_handle_size = verifier->auth_short.len;
+    pthread_mutex_unlock(&rpc_connection_context->auth_short_mutex);
+
+    return false;
+}
+
 /*
  * Creates a RpcConnectionContext with the given server IP address and server port,
  * the credential and verifier both having flavor AUTH_NONE, and the given transport protocol identifier.
@@ -397,6 +823,7 @@ void free_rpc_connection_context(RpcConnectionContext *rpc_connection_context) {
 
     switch (rpc_connection_context->transport_protocol) {
     case TRANSPORT_PROTOCOL_TCP:
+    case TRANSPORT_PROTOCOL_TLS:
         // close the TCP client socket if it was correctly opened
         if (rpc_connection_context->transport_connection != NULL &&
             rpc_connection_context->transport_connection->tcp_client != NULL) {
@@ -404,12 +831,16 @@ void free_rpc_connection_context(RpcConnectionContext *rpc_connection_context) {
 
             int *tcp_rpc_client_socket_fd = tcp_client->tcp_rpc_client_socket_fd;
             if (tcp_rpc_client_socket_fd != NULL && *tcp_rpc_client_socket_fd >= 0) {
+                // final statistics of the connection
+                report_tcp_connection_stats(*tcp_rpc_client_socket_fd, "client", tcp_client->num_rpcs);
+
                 close(*tcp_rpc_client_socket_fd);
             }
 
             free(tcp_rpc_client_socket_fd);
 
             pthread_mutex_destroy(&tcp_client->tcp_connection_mutex);
+            release_record_buffer(&tcp_client->reply_rpc_msg_buffer);
 
             free(tcp_client);
         }
@@ -418,66 +849,27 @@ void free_rpc_connection_context(RpcConnectionContext *rpc_connection_context) {
 
         break;
     case TRANSPORT_PROTOCOL_QUIC:
-        // close the QUIC connection if it was correctly set up
-        if (rpc_connection_context->transport_connection != NULL &&
-            rpc_connection_context->transport_connection->quic_client != NULL) {
-            QuicClient *quic_client = rpc_connection_context->transport_connection->quic_client;
-
-            if (quic_client != NULL) {
-                // make the event loop thread execute the connection closing callback
-                ev_async_send(quic_client->event_loop, &quic_client->connection_closing_async_watcher);
-
-                pthread_mutex_lock(&quic_client->connection_closed_lock);
-                while (!quic_client->connection_closed) {
-                    pthread_cond_wait(&quic_client->connection_closed_condition_variable,
-                                      &quic_client->connection_closed_lock);
-                }
-                pthread_mutex_unlock(&quic_client->connection_closed_lock);
-
-                if (quic_client->successfully_created_event_loop_thread) {
-                    pthread_join(quic_client->event_loop_thread, NULL);
-                }
-
-                if (quic_client->event_loop != NULL) {
-                    ev_loop_destroy(quic_client->event_loop);
-                }
-
-                close(quic_client->socket_fd);
-
-                if (quic_client->tls_config != NULL) {
-                    quic_tls_config_free(quic_client->tls_config);
-                }
-                if (quic_client->quic_endpoint != NULL) {
-                    quic_endpoint_free(quic_client->quic_endpoint);
-                }
-                if (quic_client->quic_config != NULL) {
-                    quic_config_free(quic_client->quic_config);
-                }
-
-                free_stream_contexts_list(quic_client->stream_contexts, &quic_client->stream_contexts_list_lock,
-                                          &quic_client->stream_contexts_condition_variable);
-
-                pthread_mutex_destroy(&quic_client->stream_contexts_list_lock);
-                pthread_cond_destroy(&quic_client->stream_contexts_condition_variable);
-
-                free_streams_list(quic_client->auxiliary_streams_list_head, &quic_client->auxiliary_streams_list_lock);
-
-                pthread_mutex_destroy(&quic_client->auxiliary_streams_list_lock);
-
-                free(quic_client->main_stream);
+        // close the QUIC connections if they were correctly set up
+        if (rpc_connection_context->transport_connection != NULL) {
+            free_quic_client_pool(rpc_connection_context->transport_connection->quic_client_pool);
+        }
 
-                pthread_mutex_destroy(&quic_client->connection_established_lock);
-                pthread_cond_destroy(&quic_client->connection_established_condition_variable);
+        free(rpc_connection_context->transport_connection);
 
-                free_stream_allocation_queue(quic_client->stream_allocation_queue_back);
+        break;
+    case TRANSPORT_PROTOCOL_SHM:
+        // close the Unix domain socket, which tells the server thread to terminate, and unmap the shared memory
+        if (rpc_connection_context->transport_connection != NULL &&
+            rpc_connection_context->transport_connection->shm_client != NULL) {
+            ShmClient *shm_client = rpc_connection_context->transport_connection->shm_client;
 
-                pthread_mutex_destroy(&quic_client->stream_allocation_queue_lock);
+            close(shm_client->unix_socket_fd);
+            unmap_shm_region(shm_client->shm_region);
 
-                pthread_mutex_destroy(&quic_client->connection_closed_lock);
-                pthread_cond_destroy(&quic_client->connection_closed_condition_variable);
-            }
+            pthread_mutex_destroy(&shm_client->shm_connection_mutex);
+            release_record_buffer(&shm_client->reply_rpc_msg_buffer);
 
-            free(quic_client);
+            free(shm_client);
         }
 
         free(rpc_connection_context->transport_connection);
@@ -485,5 +877,8 @@ void free_rpc_connection_context(RpcConnectionContext *rpc_connection_context) {
         break;
     }
 
+    pthread_mutex_destroy(&rpc_connection_context->auth_short_mutex);
+    destroy_rpc_compression_policy(&rpc_connection_context->compression_policy);
+
     free(rpc_connection_context);
 }
\ No newline at end of file
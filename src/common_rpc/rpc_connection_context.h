@@ -4,6 +4,8 @@
 #define _POSIX_C_SOURCE 200809L // so we can use gethostname()
 
 #include <errno.h>
+#include <pthread.h>
+#include <stdbool.h>
 #include <stdlib.h>
 #include <unistd.h>
 
@@ -14,12 +16,27 @@
 
 #include "src/transport/transport_common.h"
 
+#include "rpc_codec.h"
+#include "rpc_compression.h"
+
 /*
  * 'Context' of a RPC connection specifies the IPv4 address and port of
  * the server, the credential and verifier that should be sent as
  * part of CallBody of any RPC call sent to this server,
  * the identifier of the transport protocol to be used for sending RPCs,
+ * the codec RPCs are encoded with (protobuf unless changed after creation),
  * and the TCP client socket that is connected to the NFS server.
+ *
+ * Once the server has handed out a short handle (AUTH_SHORT) for the AUTH_SYS
+ * credential, the handle is sent in place of the credential.
+ *
+ * Directories are read with READDIR2 until the server turns down a READDIR2
+ * call as an unavailable procedure, and with READDIR from then on.
+ *
+ * READs, WRITEs and READDIRs move at most 'transfer_size' bytes each, which
+ * is NFS_MAXDATA until the client has asked the server for its transfer size
+ * with 'negotiate_transfer_parameters'. The same call picks the compression
+ * the data of READs and WRITEs is sent with, which is none until then.
  */
 typedef struct RpcConnectionContext {
     char *server_ipv4_addr;
@@ -30,6 +47,19 @@ typedef struct RpcConnectionContext {
 
     TransportProtocol transport_protocol;
     TransportConnection *transport_connection;
+
+    RpcCodec rpc_codec;
+
+    pthread_mutex_t auth_short_mutex;
+    uint8_t auth_short_handle[MAX_AUTH_SHORT_SIZE];
+    size_t auth_short_handle_size; // 0 while the server has not handed out a short handle
+
+    bool readdir2_unavailable; // accessed atomically, as it is set by whichever thread first finds out
+
+    uint32_t transfer_size;
+
+    RpcCompression payload_compression;
+    RpcCompressionPolicy compression_policy; // decides which WRITEs are worth compressing
 } RpcConnectionContext;
 
 RpcConnectionContext *create_rpc_connection_context(char *server_ipv4_address, uint16_t server_port,
@@ -42,6 +72,12 @@ RpcConnectionContext *create_auth_none_rpc_connection_context(char *server_ipv4_
 RpcConnectionContext *create_auth_sys_rpc_connection_context(char *server_ipv4_address, uint16_t server_port,
                                                              TransportProtocol transport_protocol);
 
+Rpc__OpaqueAuth *get_rpc_call_credential(RpcConnectionContext *rpc_connection_context,
+                                         Rpc__OpaqueAuth *short_credential, uint8_t *short_handle);
+
+bool update_auth_short_handle(RpcConnectionContext *rpc_connection_context, Rpc__RpcMsg *rpc_reply,
+                              bool sent_short_credential);
+
 void free_rpc_connection_context(RpcConnectionContext *rpc_connection_context);
 
 #endif /* rpc_connection_context__header__INCLUDED */
\ No newline at end of file
@@ -0,0 +1,489 @@
+#include "rpc_msg_encoding.h"
+
+#include "common_rpc.h"
+
+/*
+ * Single-pass encoding and decoding of RPC messages.
+ *
+ * Procedure parameters and results travel inside an RpcMsg as the value of an Any. Packing them into a buffer of
+ * their own and then packing the RpcMsg around that buffer would copy them a second time, so instead they are packed
+ * into a buffer with RPC_PAYLOAD_HEADROOM free bytes in front, and the rest of the RpcMsg is serialized into those
+ * free bytes, right in front of the payload. Decoding does the reverse - only the envelope around the payload is
+ * unpacked, and the Any is pointed at the payload where it lies in the received record.
+ */
+
+#define PROTOBUF_WIRE_TYPE_VARINT 0
+#define PROTOBUF_WIRE_TYPE_64BIT 1
+#define PROTOBUF_WIRE_TYPE_LENGTH_DELIMITED 2
+#define PROTOBUF_WIRE_TYPE_32BIT 5
+
+#define PROTOBUF_MAX_VARINT_SIZE 10
+
+// the payload of a call is RpcMsg.cbody (3) -> CallBody.params (7) -> Any.value (2)
+static const uint32_t call_payload_field_path[] = {3, 7, 2};
+// the payload of a reply is RpcMsg.rbody (4) -> ReplyBody.areply (2) -> AcceptedReply.results (3) -> Any.value (2)
+static const uint32_t reply_payload_field_path[] = {4, 2, 3, 2};
+
+#define RPC_PAYLOAD_FIELD_PATH_MAX_DEPTH 4
+
+/*
+ * Allocates a buffer for 'payload_size' bytes of packed procedure parameters or results, with RPC_PAYLOAD_HEADROOM
+ * free bytes in front of it for the RpcMsg that will carry it. The buffer is taken from the arena of the calling
+ * thread while it serves an RPC.
+ *
+ * Returns the start of the payload on success, and NULL on failure.
+ *
+ * The user of this function takes the responsibility to free the buffer with 'free_rpc_payload_buffer'.
+ */
+uint8_t *allocate_rpc_payload_buffer(size_t payload_size) {
+    uint8_t *buffer = rpc_arena_alloc(RPC_PAYLOAD_HEADROOM + payload_size);
+    if (buffer == NULL) {
+        fprintf(stderr, "allocate_rpc_payload_buffer: failed to allocate memory\n");
+        return NULL;
+    }
+
+    return buffer + RPC_PAYLOAD_HEADROOM;
+}
+
+/*
+ * Frees a buffer allocated with 'allocate_rpc_payload_buffer', given the start of its payload.
+ *
+ * Does nothing if the given 'payload_buffer' is NULL.
+ */
+void free_rpc_payload_buffer(uint8_t *payload_buffer) {
+    if (payload_buffer == NULL) {
+        return;
+    }
+
+    rpc_arena_free(payload_buffer - RPC_PAYLOAD_HEADROOM);
+}
+
+/*
+ * Returns the Any carrying the procedure parameters of the given RPC call or the procedure results of the given
+ * RPC reply, or NULL if the RpcMsg has no such Any.
+ */
+static Google__Protobuf__Any *get_rpc_msg_payload_any(Rpc__RpcMsg *rpc_msg) {
+    if (rpc_msg->body_case == RPC__RPC_MSG__BODY_CBODY && rpc_msg->cbody != NULL) {
+        return rpc_msg->cbody->params;
+    }
+
+    if (rpc_msg->body_case == RPC__RPC_MSG__BODY_RBODY && rpc_msg->rbody != NULL) {
+        Rpc__ReplyBody *reply_body = rpc_msg->rbody;
+        if (reply_body->reply_case != RPC__REPLY_BODY__REPLY_AREPLY || reply_body->areply == NULL) {
+            return NULL;
+        }
+
+        Rpc__AcceptedReply *accepted_reply = reply_body->areply;
+        if (accepted_reply->reply_data_case != RPC__ACCEPTED_REPLY__REPLY_DATA_RESULTS) {
+            return NULL;
+        }
+
+        return accepted_reply->results;
+    }
+
+    return NULL;
+}
+
+/*
+ * A ProtobufCBuffer that serializes an RpcMsg into the headroom in front of its payload, skipping the payload
+ * itself, which is already in place.
+ */
+typedef struct InPlaceRpcMsgBuffer {
+    ProtobufCBuffer base;
+
+    const ProtobufCBinaryData *payload;
+    uint8_t *next_byte;
+
+    bool payload_reached;
+    bool serialized_past_payload; // the headroom only has room for what comes before the payload
+} InPlaceRpcMsgBuffer;
+
+static void append_to_in_place_rpc_msg_buffer(ProtobufCBuffer *buffer, size_t len, const uint8_t *data) {
+    InPlaceRpcMsgBuffer *in_place_buffer = (InPlaceRpcMsgBuffer *)buffer;
+
+    if (in_place_buffer->payload_reached) {
+        in_place_buffer->serialized_past_payload |= len > 0;
+        return;
+    }
+
+    if (data == in_place_buffer->payload->data && len == in_place_buffer->payload->len) {
+        in_place_buffer->payload_reached = true;
+        return;
+    }
+
+    memcpy(in_place_buffer->next_byte, data, len);
+    in_place_buffer->next_byte += len;
+}
+
+/*
+ * Protobuf encodes the given RpcMsg into the headroom in front of its payload. The sizes of all the nested messages
+ * are computed up front, which tells exactly where in the headroom the serialized RpcMsg has to start.
+ *
+ * Returns 0 on success, and > 0 if the RpcMsg can't be serialized in place.
+ */
+static int encode_protobuf_rpc_msg_in_place(Rpc__RpcMsg *rpc_msg, EncodedRpcMsg *encoded_rpc_msg) {
+    size_t rpc_msg_size = rpc__rpc_msg__get_packed_size(rpc_msg);
+
+    Google__Protobuf__Any *payload_any = get_rpc_msg_payload_any(rpc_msg);
+    if (payload_any == NULL || payload_any->value.data == NULL || payload_any->value.len == 0 ||
+        rpc_msg_size - payload_any->value.len > RPC_PAYLOAD_HEADROOM) {
+        return 1;
+    }
+    uint8_t *rpc_msg_start = payload_any->value.data - (rpc_msg_size - payload_any->value.len);
+
+    InPlaceRpcMsgBuffer in_place_buffer = {0};
+    in_place_buffer.base.append = append_to_in_place_rpc_msg_buffer;
+    in_place_buffer.payload = &payload_any->value;
+    in_place_buffer.next_byte = rpc_msg_start;
+
+    rpc__rpc_msg__pack_to_buffer(rpc_msg, &in_place_buffer.base);
+
+    if (!in_place_buffer.payload_reached || in_place_buffer.serialized_past_payload ||
+        in_place_buffer.next_byte != payload_any->value.data) {
+        // the payload is not the last thing serialized, so the RpcMsg has to be packed into a buffer of its own
+        return 2;
+    }
+
+    encoded_rpc_msg->data = rpc_msg_start;
+    encoded_rpc_msg->size = rpc_msg_size;
+    encoded_rpc_msg->allocated_buffer = NULL;
+
+    return 0;
+}
+
+/*
+ * XDR encodes the given RpcMsg into the headroom in front of its payload, which always comes last in XDR.
+ *
+ * Returns 0 on success, and > 0 if the RpcMsg can't be serialized in place.
+ */
+static int encode_xdr_rpc_msg_in_place(Rpc__RpcMsg *rpc_msg, EncodedRpcMsg *encoded_rpc_msg) {
+    Google__Protobuf__Any *payload_any = get_rpc_msg_payload_any(rpc_msg);
+    if (payload_any == NULL || payload_any->value.data == NULL || payload_any->value.len == 0) {
+        return 1;
+    }
+
+    size_t header_size = get_xdr_rpc_msg_header_size(rpc_msg);
+    size_t rpc_msg_size = get_xdr_rpc_msg_packed_size(rpc_msg);
+    if (header_size > RPC_PAYLOAD_HEADROOM || rpc_msg_size != header_size + payload_any->value.len) {
+        return 2; // e.g. results in an unsuccessful reply, which XDR leaves out
+    }
+    uint8_t *rpc_msg_start = payload_any->value.data - header_size;
+
+    pack_xdr_rpc_msg_header(rpc_msg, rpc_msg_start);
+
+    encoded_rpc_msg->data = rpc_msg_start;
+    encoded_rpc_msg->size = rpc_msg_size;
+    encoded_rpc_msg->allocated_buffer = NULL;
+
+    return 0;
+}
+
+/*
+ * Serializes the given RpcMsg for sending with the given codec.
+ *
+ * If the RpcMsg carries procedure parameters or results, their buffer must have been allocated with
+ * 'allocate_rpc_payload_buffer', and the RpcMsg is then serialized into the headroom in front of them, so that
+ * they are not copied. Otherwise, the RpcMsg is packed into a new buffer.
+ *
+ * Returns 0 on success and > 0 on failure.
+ *
+ * The user of this function takes the responsibility to call 'free_encoded_rpc_msg' once the RpcMsg is sent, and
+ * must keep the payload buffer around until then.
+ */
+int encode_rpc_msg(RpcCodec codec, Rpc__RpcMsg *rpc_msg, EncodedRpcMsg *encoded_rpc_msg) {
+    if (rpc_msg == NULL || encoded_rpc_msg == NULL) {
+        return 1;
+    }
+
+    int error_code;
+    switch (codec) {
+    case RPC_CODEC_XDR:
+        error_code = encode_xdr_rpc_msg_in_place(rpc_msg, encoded_rpc_msg);
+        break;
+    case RPC_CODEC_PROTOBUF:
+    default:
+        error_code = encode_protobuf_rpc_msg_in_place(rpc_msg, encoded_rpc_msg);
+    }
+    if (error_code == 0) {
+        return 0;
+    }
+
+    size_t rpc_msg_size = get_rpc_msg_packed_size(codec, rpc_msg);
+    uint8_t *rpc_msg_buffer = malloc(rpc_msg_size);
+    if (rpc_msg_buffer == NULL) {
+        fprintf(stderr, "encode_rpc_msg: failed to allocate memory\n");
+        return 2;
+    }
+    pack_rpc_msg(codec, rpc_msg, rpc_msg_buffer);
+
+    encoded_rpc_msg->data = rpc_msg_buffer;
+    encoded_rpc_msg->size = rpc_msg_size;
+    encoded_rpc_msg->allocated_buffer = rpc_msg_buffer;
+
+    return 0;
+}
+
+/*
+ * Frees up the buffer of the given serialized RpcMsg, if it has one of its own.
+ *
+ * Does nothing if the given 'encoded_rpc_msg' is NULL.
+ */
+void free_encoded_rpc_msg(EncodedRpcMsg *encoded_rpc_msg) {
+    if (encoded_rpc_msg == NULL) {
+        return;
+    }
+
+    free(encoded_rpc_msg->allocated_buffer);
+    encoded_rpc_msg->allocated_buffer = NULL;
+}
+
+/*
+ * A length-delimited field (a nested message, string, or bytes) found in a serialized message.
+ */
+typedef struct LengthDelimitedField {
+    size_t field_offset;  // offset of the field tag
+    size_t length_offset; // offset of the length prefix
+    size_t data_offset;
+    size_t data_size;
+} LengthDelimitedField;
+
+/*
+ * Reads the varint starting at the given offset of the buffer ending at 'end', and moves the offset past it.
+ *
+ * Returns 0 on success and > 0 if the varint is malformed.
+ */
+static int read_varint(const uint8_t *buffer, size_t end, size_t *offset, uint64_t *value) {
+    *value = 0;
+    for (int shift = 0; shift < 64 && *offset < end; shift += 7) {
+        uint8_t byte = buffer[(*offset)++];
+        *value |= (uint64_t)(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+/*
+ * Writes the given value as a varint to the given buffer, and returns the number of bytes written.
+ */
+static size_t write_varint(uint64_t value, uint8_t *buffer) {
+    size_t size = 0;
+    while (value >= 0x80) {
+        buffer[size++] = (value & 0x7F) | 0x80;
+        value >>= 7;
+    }
+    buffer[size++] = value;
+
+    return size;
+}
+
+/*
+ * Finds the length-delimited field with the given number among the fields of the message serialized in
+ * buffer[begin, end).
+ *
+ * Returns 0 on success, and > 0 if the message is malformed, or the field is not in it exactly once.
+ */
+static int find_length_delimited_field(const uint8_t *buffer, size_t begin, size_t end, uint32_t field_number,
+                                       LengthDelimitedField *field) {
+    bool found = false;
+
+    size_t offset = begin;
+    while (offset < end) {
+        size_t field_offset = offset;
+
+        uint64_t tag;
+        if (read_varint(buffer, end, &offset, &tag) > 0) {
+            return 1;
+        }
+
+        size_t length_offset;
+        uint64_t value;
+        switch (tag & 0x7) {
+        case PROTOBUF_WIRE_TYPE_VARINT:
+            if (read_varint(buffer, end, &offset, &value) > 0) {
+                return 1;
+            }
+            break;
+        case PROTOBUF_WIRE_TYPE_64BIT:
+            if (end - offset < 8) {
+                return 1;
+            }
+            offset += 8;
+            break;
+        case PROTOBUF_WIRE_TYPE_32BIT:
+            if (end - offset < 4) {
+                return 1;
+            }
+            offset += 4;
+            break;
+        case PROTOBUF_WIRE_TYPE_LENGTH_DELIMITED:
+            length_offset = offset;
+            if (read_varint(buffer, end, &offset, &value) > 0 || value > end - offset) {
+                return 1;
+            }
+
+            if ((tag >> 3) == field_number) {
+                if (found) {
+                    return 2;
+                }
+                found = true;
+
+                field->field_offset = field_offset;
+                field->length_offset = length_offset;
+                field->data_offset = offset;
+                field->data_size = value;
+            }
+
+            offset += value;
+            break;
+        default:
+            // groups are never used in the RPC messages
+            return 1;
+        }
+    }
+
+    return found ? 0 : 3;
+}
+
+/*
+ * Follows the given path of nested length-delimited fields through the message serialized in the given buffer,
+ * placing each field of the path in 'fields'.
+ *
+ * Returns 0 on success and > 0 if the path can't be followed.
+ */
+static int find_nested_length_delimited_field(const uint8_t *buffer, size_t size, const uint32_t *field_path,
+                                              size_t depth, LengthDelimitedField *fields) {
+    size_t begin = 0, end = size;
+    for (size_t i = 0; i < depth; i++) {
+        if (find_length_delimited_field(buffer, begin, end, field_path[i], &fields[i]) > 0) {
+            return 1;
+        }
+
+        begin = fields[i].data_offset;
+        end = fields[i].data_offset + fields[i].data_size;
+    }
+
+    return 0;
+}
+
+/*
+ * Unpacks the RPC message in the given buffer with the RPC arena allocator.
+ *
+ * Returns NULL if deserialization was unsuccessful.
+ */
+static Rpc__RpcMsg *unpack_rpc_msg(uint8_t *rpc_msg_buffer, size_t rpc_msg_size) {
+    Rpc__RpcMsg *rpc_msg = rpc__rpc_msg__unpack(&rpc_arena_allocator, rpc_msg_size, rpc_msg_buffer);
+    if (rpc_msg == NULL) {
+        fprintf(stderr, "unpack_rpc_msg: error unpacking received message\n");
+        return NULL;
+    }
+
+    return rpc_msg;
+}
+
+/*
+ * Deserializes the RPC message encoded with the given codec in the given buffer, without copying the procedure
+ * parameters or results it carries - the value of their Any is left pointing into the given buffer.
+ *
+ * With protobuf, the envelope around the payload is copied out, with the payload field cut out of it and the
+ * lengths of the messages enclosing it shortened accordingly, and only that is unpacked. RPC messages without a
+ * payload, or whose payload can't be found unambiguously, are deserialized as usual. With XDR, the payload always
+ * comes last, and the header in front of it is decoded directly. Either way, the RpcMsg is unpacked into the arena
+ * of the calling thread while it serves an RPC.
+ *
+ * Returns NULL if deserialization was unsuccessful.
+ *
+ * The user of this function takes the responsibility to keep the given buffer unchanged while using the RpcMsg,
+ * and to free it with 'free_rpc_msg_decoded_in_place', given the same buffer.
+ */
+Rpc__RpcMsg *decode_rpc_msg_in_place(RpcCodec codec, uint8_t *rpc_msg_buffer, size_t rpc_msg_size) {
+    if (codec == RPC_CODEC_XDR) {
+        Rpc__RpcMsg *rpc_msg = unpack_xdr_rpc_msg(&rpc_arena_allocator, rpc_msg_size, rpc_msg_buffer, NULL, false);
+        if (rpc_msg == NULL) {
+            fprintf(stderr, "decode_rpc_msg_in_place: error decoding received message\n");
+        }
+
+        return rpc_msg;
+    }
+
+    LengthDelimitedField fields[RPC_PAYLOAD_FIELD_PATH_MAX_DEPTH];
+    size_t depth = sizeof(call_payload_field_path) / sizeof(call_payload_field_path[0]);
+    if (find_nested_length_delimited_field(rpc_msg_buffer, rpc_msg_size, call_payload_field_path, depth, fields) > 0) {
+        depth = sizeof(reply_payload_field_path) / sizeof(reply_payload_field_path[0]);
+        if (find_nested_length_delimited_field(rpc_msg_buffer, rpc_msg_size, reply_payload_field_path, depth,
+                                               fields) > 0) {
+            return unpack_rpc_msg(rpc_msg_buffer, rpc_msg_size);
+        }
+    }
+
+    LengthDelimitedField *payload_field = &fields[depth - 1];
+    size_t payload_field_end = payload_field->data_offset + payload_field->data_size;
+
+    // work out the shortened lengths of the enclosing messages, from the innermost one out
+    uint64_t envelope_lengths[RPC_PAYLOAD_FIELD_PATH_MAX_DEPTH];
+    size_t removed_size = payload_field_end - payload_field->field_offset;
+    for (size_t i = depth - 1; i-- > 0;) {
+        envelope_lengths[i] = fields[i].data_size - removed_size;
+
+        uint8_t length_prefix[PROTOBUF_MAX_VARINT_SIZE];
+        removed_size += (fields[i].data_offset - fields[i].length_offset) -
+                        write_varint(envelope_lengths[i], length_prefix);
+    }
+
+    size_t envelope_size = rpc_msg_size - removed_size;
+    if (envelope_size > RPC_PAYLOAD_HEADROOM) {
+        return unpack_rpc_msg(rpc_msg_buffer, rpc_msg_size);
+    }
+
+    // copy out everything except the payload field, rewriting the length prefixes of the enclosing messages
+    uint8_t envelope[RPC_PAYLOAD_HEADROOM];
+    size_t envelope_offset = 0, offset = 0;
+    for (size_t i = 0; i + 1 < depth; i++) {
+        memcpy(envelope + envelope_offset, rpc_msg_buffer + offset, fields[i].length_offset - offset);
+        envelope_offset += fields[i].length_offset - offset;
+        envelope_offset += write_varint(envelope_lengths[i], envelope + envelope_offset);
+        offset = fields[i].data_offset;
+    }
+    memcpy(envelope + envelope_offset, rpc_msg_buffer + offset, payload_field->field_offset - offset);
+    envelope_offset += payload_field->field_offset - offset;
+    memcpy(envelope + envelope_offset, rpc_msg_buffer + payload_field_end, rpc_msg_size - payload_field_end);
+
+    Rpc__RpcMsg *rpc_msg = unpack_rpc_msg(envelope, envelope_size);
+    if (rpc_msg == NULL) {
+        return NULL;
+    }
+
+    Google__Protobuf__Any *payload_any = get_rpc_msg_payload_any(rpc_msg);
+    if (payload_any == NULL || payload_any->value.data != NULL) {
+        // the payload was not where the oneof cases of the unpacked envelope say it is
+        rpc__rpc_msg__free_unpacked(rpc_msg, &rpc_arena_allocator);
+        return unpack_rpc_msg(rpc_msg_buffer, rpc_msg_size);
+    }
+    payload_any->value.data = rpc_msg_buffer + payload_field->data_offset;
+    payload_any->value.len = payload_field->data_size;
+
+    return rpc_msg;
+}
+
+/*
+ * Frees up an RpcMsg deserialized with 'decode_rpc_msg_in_place' from the given buffer.
+ *
+ * Does nothing if the given 'rpc_msg' is NULL.
+ */
+void free_rpc_msg_decoded_in_place(Rpc__RpcMsg *rpc_msg, const uint8_t *rpc_msg_buffer, size_t rpc_msg_size) {
+    if (rpc_msg == NULL) {
+        return;
+    }
+
+    // the payload is not owned by the RpcMsg if it lies in the buffer it was decoded from
+    Google__Protobuf__Any *payload_any = get_rpc_msg_payload_any(rpc_msg);
+    if (payload_any != NULL && payload_any->value.data >= rpc_msg_buffer &&
+        payload_any->value.data < rpc_msg_buffer + rpc_msg_size) {
+        payload_any->value.data = NULL;
+        payload_any->value.len = 0;
+    }
+
+    rpc__rpc_msg__free_unpacked(rpc_msg, &rpc_arena_allocator);
+}
@@ -0,0 +1,48 @@
+#ifndef rpc_msg_encoding__header__INCLUDED
+#define rpc_msg_encoding__header__INCLUDED
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "src/serialization/rpc/rpc.pb-c.h"
+#include <protobuf-c/protobuf-c.h>
+
+#include "rpc_codec.h"
+
+/*
+ * Number of free bytes kept in front of every buffer of packed procedure parameters or results allocated with
+ * 'allocate_rpc_payload_buffer'. The rest of the RpcMsg around the payload (xid, call or reply body, credential,
+ * verifier, the Any type URL, and the length prefixes of all of them) is serialized into these bytes, so that the
+ * payload is never copied into a second buffer. The largest such envelope is a call with an AUTH_SYS credential
+ * carrying a 255 byte machine name and 16 gids, in either codec.
+ */
+#define RPC_PAYLOAD_HEADROOM 512
+
+/*
+ * A serialized RpcMsg, ready to be sent.
+ */
+typedef struct EncodedRpcMsg {
+    uint8_t *data;
+    size_t size;
+
+    // NULL if the RpcMsg was serialized in place around its payload, otherwise the buffer holding it
+    uint8_t *allocated_buffer;
+} EncodedRpcMsg;
+
+uint8_t *allocate_rpc_payload_buffer(size_t payload_size);
+
+void free_rpc_payload_buffer(uint8_t *payload_buffer);
+
+int encode_rpc_msg(RpcCodec codec, Rpc__RpcMsg *rpc_msg, EncodedRpcMsg *encoded_rpc_msg);
+
+void free_encoded_rpc_msg(EncodedRpcMsg *encoded_rpc_msg);
+
+Rpc__RpcMsg *decode_rpc_msg_in_place(RpcCodec codec, uint8_t *rpc_msg_buffer, size_t rpc_msg_size);
+
+void free_rpc_msg_decoded_in_place(Rpc__RpcMsg *rpc_msg, const uint8_t *rpc_msg_buffer, size_t rpc_msg_size);
+
+#endif /* rpc_msg_encoding__header__INCLUDED */
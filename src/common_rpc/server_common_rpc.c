@@ -15,27 +15,68 @@
 
 #include "src/transport/tcp/tcp_record_marking.h"
 
+// the short handle for the credential of the RPC call being served by the calling thread, if it was given one
+static __thread uint8_t rpc_call_short_handle[AUTH_SHORT_HANDLE_SIZE];
+static __thread bool has_rpc_call_short_handle = false;
+
+/*
+ * Returns the credential that procedures should see for the RPC call being served by the calling thread, given the
+ * validated credential of the call.
+ *
+ * A short (AUTH_SHORT) credential is replaced by the AUTH_SYS credential its handle was handed out for, so
+ * procedures only ever see AUTH_NONE and AUTH_SYS credentials. A call made with an AUTH_SYS credential gets a short
+ * handle for it in the verifier of its reply, which the client can send instead of the full credential from then on.
+ *
+ * Returns NULL if the given credential is a short one whose handle this server does not know (anymore), in which
+ * case the call should be rejected with AUTH_REJECTEDCRED. The returned credential is deallocated using
+ * 'free_opaque_auth' if it is not the given one.
+ */
+Rpc__OpaqueAuth *resolve_rpc_call_credential(Rpc__OpaqueAuth *credential) {
+    has_rpc_call_short_handle = false;
+
+    switch (credential->flavor) {
+    case RPC__AUTH_FLAVOR__AUTH_SHORT:
+        return expand_auth_short_handle(credential->auth_short.data, credential->auth_short.len);
+    case RPC__AUTH_FLAVOR__AUTH_SYS:
+        has_rpc_call_short_handle = issue_auth_short_handle(credential->auth_sys, rpc_call_short_handle) == 0;
+        return credential;
+    default:
+        return credential;
+    }
+}
+
+/*
+ * Creates the verifier for the reply to the RPC call being served by the calling thread - an AUTH_SHORT one if the
+ * call was given a short handle by 'resolve_rpc_call_credential', and an AUTH_NONE one otherwise.
+ */
+static Rpc__OpaqueAuth *create_reply_verifier(void) {
+    if (has_rpc_call_short_handle) {
+        return create_auth_short_opaque_auth(rpc_call_short_handle, AUTH_SHORT_HANDLE_SIZE);
+    }
+
+    return create_auth_none_opaque_auth();
+}
+
 /*
  * Wraps the procedure results given in the buffer 'results_buffer' of size 'results_size' into an Any
- * message, along with a type 'results_type' of the result (e.g. nfs/AttrStat).
+ * message, along with a type 'results_type' of the result (e.g. nfs/AttrStat). The 'results_buffer' must have been
+ * allocated with 'allocate_rpc_payload_buffer', so that the reply can be serialized around it without copying it.
  *
  * The user of this function takes the responsibility to free the Any, the OpaqueAuth, and the
  * AcceptedReply itself, using the the 'free_accepted_reply' function.
  */
 Rpc__AcceptedReply *wrap_procedure_results_in_successful_accepted_reply(size_t results_size, uint8_t *results_buffer,
                                                                         char *results_type) {
-    Rpc__AcceptedReply *accepted_reply = malloc(sizeof(Rpc__AcceptedReply));
+    Rpc__AcceptedReply *accepted_reply = rpc_arena_alloc(sizeof(Rpc__AcceptedReply));
     rpc__accepted_reply__init(accepted_reply);
 
-    // currently supported AUTH_NONE and AUTH_SYS can always just send a AUTH_NONE OpaqueAuth from server
-    // TODO (QNFS-52): Implement AUTH_SHORT
-    accepted_reply->verifier = create_auth_none_opaque_auth();
+    accepted_reply->verifier = create_reply_verifier();
 
     accepted_reply->stat = RPC__ACCEPT_STAT__SUCCESS;
     accepted_reply->reply_data_case = RPC__ACCEPTED_REPLY__REPLY_DATA_RESULTS;
 
     // wrap procedure results into Any
-    Google__Protobuf__Any *results = malloc(sizeof(Google__Protobuf__Any));
+    Google__Protobuf__Any *results = rpc_arena_alloc(sizeof(Google__Protobuf__Any));
     google__protobuf__any__init(results);
     results->type_url = results_type;
     results->value.data = results_buffer;
@@ -54,17 +95,15 @@ Rpc__AcceptedReply *wrap_procedure_results_in_successful_accepted_reply(size_t r
  * AcceptedReply itself, using the 'free_accepted_reply' function.
  */
 Rpc__AcceptedReply *create_prog_mismatch_accepted_reply(uint32_t low, uint32_t high) {
-    Rpc__AcceptedReply *accepted_reply = malloc(sizeof(Rpc__AcceptedReply));
+    Rpc__AcceptedReply *accepted_reply = rpc_arena_alloc(sizeof(Rpc__AcceptedReply));
     rpc__accepted_reply__init(accepted_reply);
 
-    // currently supported AUTH_NONE and AUTH_SYS can always just send a AUTH_NONE OpaqueAuth from server
-    // TODO (QNFS-52): Implement AUTH_SHORT
-    accepted_reply->verifier = create_auth_none_opaque_auth();
+    accepted_reply->verifier = create_reply_verifier();
 
     accepted_reply->stat = RPC__ACCEPT_STAT__PROG_MISMATCH;
     accepted_reply->reply_data_case = RPC__ACCEPTED_REPLY__REPLY_DATA_MISMATCH_INFO;
 
-    Rpc__MismatchInfo *mismatch_info = malloc(sizeof(Rpc__MismatchInfo));
+    Rpc__MismatchInfo *mismatch_info = rpc_arena_alloc(sizeof(Rpc__MismatchInfo));
     rpc__mismatch_info__init(mismatch_info);
     mismatch_info->low = 2;
     mismatch_info->high = 2;
@@ -89,17 +128,15 @@ Rpc__AcceptedReply *create_default_case_accepted_reply(Rpc__AcceptStat default_c
         return NULL;
     }
 
-    Rpc__AcceptedReply *accepted_reply = malloc(sizeof(Rpc__AcceptedReply));
+    Rpc__AcceptedReply *accepted_reply = rpc_arena_alloc(sizeof(Rpc__AcceptedReply));
     rpc__accepted_reply__init(accepted_reply);
 
-    // currently supported AUTH_NONE and AUTH_SYS can always just send a AUTH_NONE OpaqueAuth from server
-    // TODO (QNFS-52): Implement AUTH_SHORT
-    accepted_reply->verifier = create_auth_none_opaque_auth();
+    accepted_reply->verifier = create_reply_verifier();
 
     accepted_reply->stat = default_case_accept_stat;
     accepted_reply->reply_data_case = RPC__ACCEPTED_REPLY__REPLY_DATA_DEFAULT_CASE;
 
-    Google__Protobuf__Empty *empty = malloc(sizeof(Google__Protobuf__Empty));
+    Google__Protobuf__Empty *empty = rpc_arena_alloc(sizeof(Google__Protobuf__Empty));
     google__protobuf__empty__init(empty);
     accepted_reply->default_case = empty;
 
@@ -148,18 +185,18 @@ void free_accepted_reply(Rpc__AcceptedReply *accepted_reply) {
 
         if (results->value.data != NULL) {
             // free the buffer containing packed procedure results inside the Any
-            free(results->value.data);
+            free_rpc_payload_buffer(results->value.data);
         }
-        free(results);
+        rpc_arena_free(results);
     } else if (accepted_reply->stat == RPC__ACCEPT_STAT__PROG_MISMATCH) {
-        free(accepted_reply->mismatch_info);
+        rpc_arena_free(accepted_reply->mismatch_info);
     } else {
         // for all other AcceptStat's - PROG_UNAVAIL, GARBAGE_ARGS, SYSTEM_ERR, etc. we only need to free the Empty
         // default_case
-        free(accepted_reply->default_case);
+        rpc_arena_free(accepted_reply->default_case);
     }
 
-    free(accepted_reply);
+    rpc_arena_free(accepted_reply);
 }
 
 /*
@@ -170,13 +207,13 @@ void free_accepted_reply(Rpc__AcceptedReply *accepted_reply) {
  * RejectedReply itself, using the 'free_rejected_reply' function.
  */
 Rpc__RejectedReply *create_rpc_mismatch_rejected_reply(uint32_t low, uint32_t high) {
-    Rpc__RejectedReply *rejected_reply = malloc(sizeof(Rpc__RejectedReply));
+    Rpc__RejectedReply *rejected_reply = rpc_arena_alloc(sizeof(Rpc__RejectedReply));
     rpc__rejected_reply__init(rejected_reply);
 
     rejected_reply->stat = RPC__REJECT_STAT__RPC_MISMATCH;
     rejected_reply->reply_data_case = RPC__REJECTED_REPLY__REPLY_DATA_MISMATCH_INFO;
 
-    Rpc__MismatchInfo *mismatch_info = malloc(sizeof(Rpc__MismatchInfo));
+    Rpc__MismatchInfo *mismatch_info = rpc_arena_alloc(sizeof(Rpc__MismatchInfo));
     rpc__mismatch_info__init(mismatch_info);
     mismatch_info->low = low;
     mismatch_info->high = high;
@@ -194,7 +231,7 @@ Rpc__RejectedReply *create_rpc_mismatch_rejected_reply(uint32_t low, uint32_t hi
  * using the 'free_rejected_reply' function.
  */
 Rpc__RejectedReply *create_auth_error_rejected_reply(Rpc__AuthStat stat) {
-    Rpc__RejectedReply *rejected_reply = malloc(sizeof(Rpc__RejectedReply));
+    Rpc__RejectedReply *rejected_reply = rpc_arena_alloc(sizeof(Rpc__RejectedReply));
     rpc__rejected_reply__init(rejected_reply);
 
     rejected_reply->stat = RPC__REJECT_STAT__AUTH_ERROR;
@@ -216,8 +253,170 @@ void free_rejected_reply(Rpc__RejectedReply *rejected_reply) {
     }
 
     if (rejected_reply->stat == RPC__REJECT_STAT__RPC_MISMATCH) {
-        free(rejected_reply->mismatch_info);
+        rpc_arena_free(rejected_reply->mismatch_info);
+    }
+
+    rpc_arena_free(rejected_reply);
+}
+
+/*
+ * Sending replies
+ */
+
+/*
+ * Sends the given AcceptedReply back to the RPC client with the given reply sender.
+ *
+ * Returns 0 on success, and > 0 on failure.
+ */
+int send_rpc_accepted_reply_message(RpcReplySender *reply_sender, Rpc__AcceptedReply *accepted_reply) {
+    Rpc__ReplyBody reply_body = RPC__REPLY_BODY__INIT;
+    reply_body.stat = RPC__REPLY_STAT__MSG_ACCEPTED;
+    reply_body.reply_case = RPC__REPLY_BODY__REPLY_AREPLY; // reply_case is not actually transfered over network
+    reply_body.areply = accepted_reply;
+
+    return reply_sender->send_reply_body(reply_sender->reply_destination, &reply_body);
+}
+
+/*
+ * Sends the given RejectedReply back to the RPC client with the given reply sender.
+ *
+ * Returns 0 on success, and > 0 on failure.
+ */
+int send_rpc_rejected_reply_message(RpcReplySender *reply_sender, Rpc__RejectedReply *rejected_reply) {
+    Rpc__ReplyBody reply_body = RPC__REPLY_BODY__INIT;
+    reply_body.stat = RPC__REPLY_STAT__MSG_DENIED;
+    reply_body.reply_case = RPC__REPLY_BODY__REPLY_RREPLY; // reply_case is not actually transfered over network
+    reply_body.rreply = rejected_reply;
+
+    return reply_sender->send_reply_body(reply_sender->reply_destination, &reply_body);
+}
+
+/*
+ * Prints out the given error message, and sends an AUTH_ERROR RejectedReply with the given AuthStat back to the RPC
+ * client with the given reply sender.
+ *
+ * Returns 0 on success and > 0 on failure.
+ */
+int send_auth_error_rejected_reply(RpcReplySender *reply_sender, char *error_msg, Rpc__AuthStat auth_stat) {
+    fprintf(stdout, "%s", error_msg);
+
+    Rpc__RejectedReply *rejected_reply = create_auth_error_rejected_reply(auth_stat);
+
+    int error_code = send_rpc_rejected_reply_message(reply_sender, rejected_reply);
+    free_rejected_reply(rejected_reply);
+    if (error_code > 0) {
+        fprintf(stdout, "Server failed to send AUTH_ERROR RejectedReply\n");
+        return 1;
+    }
+
+    return 0;
+}
+
+/*
+ * Validates the 'credential' and 'verifier' OpaqueAuth pair from some RPC CallBody, to check that they have the correct
+ * structure (no NULL fields) and correspond to a supported authentication flavor.
+ *
+ * Returns < 0 on failure.
+ * On success, returns 0 if the credential and verifier pair are correct, and if the credential and verifier pair are
+ * incorrect, returns > 0 and sends an appropriate RejectedReply with the given reply sender.
+ */
+int validate_credential_and_verifier(RpcReplySender *reply_sender, Rpc__OpaqueAuth *credential,
+                                     Rpc__OpaqueAuth *verifier) {
+    int error_code;
+
+    if (credential == NULL) {
+        error_code = send_auth_error_rejected_reply(
+            reply_sender, "Server received an RPC call with 'credential' being NULL.\n", RPC__AUTH_STAT__AUTH_BADCRED);
+        return error_code > 0 ? -1 : 1;
+    }
+    if (credential->flavor == RPC__AUTH_FLAVOR__AUTH_NONE) {
+        if (credential->body_case != RPC__OPAQUE_AUTH__BODY_EMPTY) {
+            error_code = send_auth_error_rejected_reply(reply_sender,
+                                                        "Server received an RPC call with AUTH_NONE credential, with "
+                                                        "inconsistent credential->flavor and credential->body_case.\n",
+                                                        RPC__AUTH_STAT__AUTH_BADCRED);
+            return error_code > 0 ? -1 : 1;
+        }
+        if (credential->empty == NULL) {
+            error_code = send_auth_error_rejected_reply(
+                reply_sender,
+                "Server received an RPC call with AUTH_NONE credential, with credential->empty being NULL.\n",
+                RPC__AUTH_STAT__AUTH_BADCRED);
+            return error_code > 0 ? -1 : 1;
+        }
+    } else if (credential->flavor == RPC__AUTH_FLAVOR__AUTH_SYS) {
+        if (credential->body_case != RPC__OPAQUE_AUTH__BODY_AUTH_SYS) {
+            error_code = send_auth_error_rejected_reply(reply_sender,
+                                                        "Server received an RPC call with AUTH_SYS credential, with "
+                                                        "inconsistent credential->flavor and credential->body_case.\n",
+                                                        RPC__AUTH_STAT__AUTH_BADCRED);
+            return error_code > 0 ? -1 : 1;
+        }
+
+        if (credential->auth_sys == NULL) {
+            error_code = send_auth_error_rejected_reply(
+                reply_sender,
+                "Server received an RPC call with AUTH_SYS credential, with credential->auth_sys being NULL.\n",
+                RPC__AUTH_STAT__AUTH_BADCRED);
+            return error_code > 0 ? -1 : 1;
+        }
+        Rpc__AuthSysParams *authsysparams = credential->auth_sys;
+
+        if (authsysparams->machinename == NULL) {
+            error_code = send_auth_error_rejected_reply(reply_sender,
+                                                        "Server received an RPC call with AUTH_SYS credential, "
+                                                        "with credential->auth_sys->machinename being NULL.\n",
+                                                        RPC__AUTH_STAT__AUTH_BADCRED);
+            return error_code > 0 ? -1 : 1;
+        }
+        if (authsysparams->gids == NULL) {
+            error_code = send_auth_error_rejected_reply(
+                reply_sender,
+                "Server received an RPC call with AUTH_SYS credential, with credential->auth_sys->gids being NULL.\n",
+                RPC__AUTH_STAT__AUTH_BADCRED);
+            return error_code > 0 ? -1 : 1;
+        }
+    } else if (credential->flavor == RPC__AUTH_FLAVOR__AUTH_SHORT) {
+        if (credential->body_case != RPC__OPAQUE_AUTH__BODY_AUTH_SHORT) {
+            error_code = send_auth_error_rejected_reply(reply_sender,
+                                                        "Server received an RPC call with AUTH_SHORT credential, with "
+                                                        "inconsistent credential->flavor and credential->body_case.\n",
+                                                        RPC__AUTH_STAT__AUTH_BADCRED);
+            return error_code > 0 ? -1 : 1;
+        }
+    } else {
+        error_code = send_auth_error_rejected_reply(
+            reply_sender, "Server received an RPC call with unsupported authentication flavor.\n",
+            RPC__AUTH_STAT__AUTH_BADCRED);
+        return error_code > 0 ? -1 : 1;
+    }
+
+    if (verifier == NULL) {
+        error_code = send_auth_error_rejected_reply(
+            reply_sender, "Server received an RPC call with 'verifier' being NULL.\n", RPC__AUTH_STAT__AUTH_BADVERF);
+        return error_code > 0 ? -1 : 1;
+    }
+    if (verifier->flavor == RPC__AUTH_FLAVOR__AUTH_NONE) {
+        if (verifier->body_case != RPC__OPAQUE_AUTH__BODY_EMPTY) {
+            error_code = send_auth_error_rejected_reply(reply_sender,
+                                                        "Server received an RPC call with AUTH_NONE verifier, with "
+                                                        "inconsistent verifier->flavor and verifier->body_case.\n",
+                                                        RPC__AUTH_STAT__AUTH_BADVERF);
+            return error_code > 0 ? -1 : 1;
+        }
+        if (verifier->empty == NULL) {
+            error_code = send_auth_error_rejected_reply(
+                reply_sender, "Server received an RPC call with AUTH_NONE verifier, with verifier->empty being NULL.\n",
+                RPC__AUTH_STAT__AUTH_BADVERF);
+            return error_code > 0 ? -1 : 1;
+        }
+    } else {
+        // in AUTH_NONE, AUTH_SYS, and AUTH_SHORT, verifier in CallBody always has AUTH_NONE flavor
+        error_code = send_auth_error_rejected_reply(
+            reply_sender, "Server received an RPC call with 'verifier' having unsupported flavor.\n",
+            RPC__AUTH_STAT__AUTH_BADVERF);
+        return error_code > 0 ? -1 : 1;
     }
 
-    free(rejected_reply);
+    return 0;
 }
@@ -5,12 +5,19 @@
 
 #include "src/transport/tcp/tcp_record_marking.h"
 
+#include "src/authentication/auth_short_cache.h"
 #include "src/authentication/authentication.h"
 
 /*
  * Functions implemented in server_common_rpc.c file.
  */
 
+/*
+ * Credentials
+ */
+
+Rpc__OpaqueAuth *resolve_rpc_call_credential(Rpc__OpaqueAuth *credential);
+
 /*
  * AcceptedReply
  */
@@ -38,6 +45,36 @@ Rpc__RejectedReply *create_auth_error_rejected_reply(Rpc__AuthStat stat);
 
 void free_rejected_reply(Rpc__RejectedReply *rejected_reply);
 
+/*
+ * Sending replies
+ */
+
+/*
+ * Sends the given ReplyBody back to the RPC client in a RpcMsg, to the given destination of the reply over the
+ * transport the RPC call arrived on (e.g. the client's TCP socket).
+ *
+ * Returns 0 on success, and > 0 on failure.
+ */
+typedef int (*SendRpcReplyBody)(void *reply_destination, Rpc__ReplyBody *reply_body);
+
+/*
+ * Sends the replies to an RPC call back to the RPC client - each transport provides its own function that sends a
+ * ReplyBody, along with where the replies to the call go.
+ */
+typedef struct RpcReplySender {
+    SendRpcReplyBody send_reply_body;
+    void *reply_destination;
+} RpcReplySender;
+
+int send_rpc_accepted_reply_message(RpcReplySender *reply_sender, Rpc__AcceptedReply *accepted_reply);
+
+int send_rpc_rejected_reply_message(RpcReplySender *reply_sender, Rpc__RejectedReply *rejected_reply);
+
+int send_auth_error_rejected_reply(RpcReplySender *reply_sender, char *error_msg, Rpc__AuthStat auth_stat);
+
+int validate_credential_and_verifier(RpcReplySender *reply_sender, Rpc__OpaqueAuth *credential,
+                                     Rpc__OpaqueAuth *verifier);
+
 /*
  * Functions that must be implemented in any specific RPC program written.
  * E.g. the Nfs+Mount server implementation will implement the below functions.
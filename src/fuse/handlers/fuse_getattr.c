@@ -14,30 +14,20 @@ void *blocking_getattr(void *arg) {
 
     memset(stbuf, 0, sizeof(struct stat));
 
-    Nfs__FType file_type;
+    // resolve the path and get the file's attributes in a single round trip
     int error_code;
-    Nfs__FHandle *file_fhandle = resolve_absolute_path(rpc_connection_context, filesystem_root_fhandle,
-                                                       getattr_data->path, &file_type, &error_code);
-    if (file_fhandle == NULL) {
-        printf("nfs_getattr: failed to resolve the path %s to a file\n", getattr_data->path);
+    Nfs__FHandle file_fhandle = NFS__FHANDLE__INIT; // the server puts the resolved file here
+    Nfs__AttrStat *attrstat =
+        call_nfs_procedure_on_path(rpc_connection_context, filesystem_root_fhandle, getattr_data->path, 1,
+                                   &file_fhandle.base, &nfs__attr_stat__descriptor, &error_code);
+    if (attrstat == NULL) {
+        printf("nfs_getattr: failed to resolve the path %s to a file and get its attributes\n", getattr_data->path);
 
         callback_data->error_code = -error_code;
 
         goto signal;
     }
 
-    Nfs__AttrStat *attrstat = malloc(sizeof(Nfs__AttrStat));
-    int status = nfs_procedure_1_get_file_attributes(rpc_connection_context, *file_fhandle, attrstat);
-    if (status != 0) {
-        printf("Error: Invalid RPC reply received from the server with status %d\n", status);
-
-        free(attrstat);
-
-        callback_data->error_code = -EIO;
-
-        goto signal;
-    }
-
     if (validate_nfs_attr_stat(attrstat) > 0) {
         printf("Error: Invalid NFS procedure result received from the server\n");
 
@@ -68,31 +58,9 @@ void *blocking_getattr(void *arg) {
         goto signal;
     }
 
-    stbuf->st_dev = attrstat->attributes->fsid;
-    stbuf->st_ino = attrstat->attributes->fileid;
-    stbuf->st_mode = attrstat->attributes->mode;
-    stbuf->st_nlink = attrstat->attributes->nlink;
-
-    stbuf->st_uid = attrstat->attributes->uid;
-    stbuf->st_gid = attrstat->attributes->gid;
-
-    stbuf->st_rdev = attrstat->attributes->rdev;
-    stbuf->st_size = attrstat->attributes->size;
-    stbuf->st_blksize = attrstat->attributes->blocksize;
-    stbuf->st_blocks = attrstat->attributes->blocks;
-
-    stbuf->st_atim.tv_sec = attrstat->attributes->atime->seconds;
-    stbuf->st_atim.tv_nsec = attrstat->attributes->atime->useconds;
-
-    stbuf->st_mtim.tv_sec = attrstat->attributes->mtime->seconds;
-    stbuf->st_mtim.tv_nsec = attrstat->attributes->mtime->useconds;
-
-    stbuf->st_ctim.tv_sec = attrstat->attributes->ctime->seconds;
-    stbuf->st_ctim.tv_nsec = attrstat->attributes->ctime->useconds;
+    fattr_to_stat(attrstat->attributes, stbuf);
 
     nfs__attr_stat__free_unpacked(attrstat, NULL);
-    free(file_fhandle->nfs_filehandle);
-    free(file_fhandle);
 
     callback_data->error_code = 0;
 
@@ -12,21 +12,9 @@ void *blocking_mkdir(void *arg) {
 
     MkdirData *mknod_data = (MkdirData *)callback_data->return_data;
 
-    Nfs__FType file_type;
-    int error_code;
-    Nfs__FHandle *containing_directory_fhandle =
-        resolve_absolute_path(rpc_connection_context, filesystem_root_fhandle, mknod_data->containing_directory_path,
-                              &file_type, &error_code);
-    if (containing_directory_fhandle == NULL) {
-        printf("nfs_mknod: failed to resolve the path %s to a file\n", mknod_data->containing_directory_path);
-
-        callback_data->error_code = -error_code;
-
-        goto signal;
-    }
-
+    Nfs__FHandle containing_directory_fhandle = NFS__FHANDLE__INIT; // the server puts the resolved directory here
     Nfs__DirOpArgs diropargs = NFS__DIR_OP_ARGS__INIT;
-    diropargs.dir = containing_directory_fhandle;
+    diropargs.dir = &containing_directory_fhandle;
 
     Nfs__FileName filename = NFS__FILE_NAME__INIT;
     filename.filename = mknod_data->new_directory_name;
@@ -48,14 +36,16 @@ void *blocking_mkdir(void *arg) {
 
     createargs.attributes = &sattr;
 
-    Nfs__DirOpRes *diropres = malloc(sizeof(Nfs__DirOpRes));
-    int status = nfs_procedure_14_create_directory(rpc_connection_context, createargs, diropres);
-    if (status != 0) {
-        printf("Error: Invalid RPC reply received from the server with status %d\n", status);
-
-        free(diropres);
+    // resolve the containing directory and create the directory in a single round trip
+    int error_code;
+    Nfs__DirOpRes *diropres = call_nfs_procedure_on_path(rpc_connection_context, filesystem_root_fhandle,
+                                                         mknod_data->containing_directory_path, 14, &createargs.base,
+                                                         &nfs__dir_op_res__descriptor, &error_code);
+    if (diropres == NULL) {
+        printf("nfs_mkdir: failed to resolve the path %s to a directory and create the directory in it\n",
+               mknod_data->containing_directory_path);
 
-        callback_data->error_code = -EIO;
+        callback_data->error_code = -error_code;
 
         goto signal;
     }
@@ -91,8 +81,6 @@ void *blocking_mkdir(void *arg) {
     }
 
     nfs__dir_op_res__free_unpacked(diropres, NULL);
-    free(containing_directory_fhandle->nfs_filehandle);
-    free(containing_directory_fhandle);
 
     callback_data->error_code = 0;
 
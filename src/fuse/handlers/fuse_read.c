@@ -1,7 +1,5 @@
 #include "handlers.h"
 
-#define READ_BYTES_PER_RPC 5000
-
 typedef struct ReadData {
     char *path;
 
@@ -29,18 +27,20 @@ void *blocking_read(void *arg) {
         goto signal;
     }
 
+    size_t read_bytes_per_rpc = rpc_connection_context->transfer_size;
+
     read_data->bytes_read = 0;
-    uint64_t file_size = READ_BYTES_PER_RPC; // we will know the file size after the first READ RPC
+    uint64_t file_size = read_bytes_per_rpc; // we will know the file size after the first READ RPC
     do {
         Nfs__ReadArgs readargs = NFS__READ_ARGS__INIT;
         readargs.file = file_fhandle;
         readargs.offset = read_data->offset + read_data->bytes_read;
 
         size_t bytes_left_to_read = read_data->bytes_to_read - read_data->bytes_read;
-        if (bytes_left_to_read < READ_BYTES_PER_RPC) {
+        if (bytes_left_to_read < read_bytes_per_rpc) {
             readargs.count = bytes_left_to_read;
         } else {
-            readargs.count = READ_BYTES_PER_RPC;
+            readargs.count = read_bytes_per_rpc;
         }
 
         readargs.totalcount = 0; // unused field
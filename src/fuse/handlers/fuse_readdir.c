@@ -1,42 +1,83 @@
 #include "handlers.h"
 
-#define READDIR_BYTES_PER_RPC 500
-
 typedef struct ReaddirData {
     char *path;
 
     void *buffer;
     fuse_fill_dir_t filler;
+    enum fuse_readdir_flags flags;
 } ReaddirData;
 
-typedef struct FileNamesList {
+typedef struct DirectoryEntriesList {
     char *filename;
-    struct FileNamesList *next;
-} FileNamesList;
+    int has_attributes; // the server leaves out the attributes of '.' and '..', and READDIR doesn't give them at all
+    struct stat attributes;
+    struct DirectoryEntriesList *next;
+} DirectoryEntriesList;
 
-void *blocking_readdir(void *arg) {
-    CallbackData *callback_data = (CallbackData *)arg;
+/*
+ * Adds a directory entry with the given name, and the given attributes if they are not NULL, to the end of the list
+ * given by its head and tail.
+ */
+static void append_directory_entry(DirectoryEntriesList **head, DirectoryEntriesList **tail, const char *filename,
+                                   Nfs__FAttr *attributes) {
+    DirectoryEntriesList *new_entries_list_entry = malloc(sizeof(DirectoryEntriesList));
+    new_entries_list_entry->filename = strdup(filename);
+    new_entries_list_entry->has_attributes = attributes != NULL;
+    if (attributes != NULL) {
+        fattr_to_stat(attributes, &new_entries_list_entry->attributes);
+    }
+    new_entries_list_entry->next = NULL;
 
-    ReaddirData *readdir_data = (ReaddirData *)callback_data->return_data;
+    if (*tail == NULL) {
+        *head = *tail = new_entries_list_entry;
+    } else {
+        (*tail)->next = new_entries_list_entry;
+        *tail = new_entries_list_entry;
+    }
+}
 
-    void *buffer = readdir_data->buffer;
-    fuse_fill_dir_t filler = readdir_data->filler;
+static void clean_up_directory_entries_list(DirectoryEntriesList *head) {
+    while (head != NULL) {
+        DirectoryEntriesList *next = head->next;
 
-    Nfs__FType file_type;
-    int error_code;
-    Nfs__FHandle *file_fhandle = resolve_absolute_path(rpc_connection_context, filesystem_root_fhandle,
-                                                       readdir_data->path, &file_type, &error_code);
-    if (file_fhandle == NULL) {
-        printf("nfs_readdir: failed to resolve the path %s to a file\n", readdir_data->path);
+        free(head->filename);
+        free(head);
 
-        callback_data->error_code = -error_code;
+        head = next;
+    }
+}
 
-        goto signal;
+/*
+ * Returns 0 if the given status of a READDIR, READDIR2 or READDIRPLUS call is NFS_OK, and the negative error code to
+ * give to FUSE otherwise.
+ */
+static int get_readdir_error_code(Nfs__Stat nfs_stat) {
+    if (nfs_stat == NFS__STAT__NFS_OK) {
+        return 0;
     }
 
-    FileNamesList *filenames_list_head = NULL;
-    FileNamesList *filenames_list_tail = NULL;
+    if (nfs_stat == NFS__STAT__NFSERR_ACCES) {
+        printf("Error: Permission denied\n");
+
+        return -EACCES;
+    }
+
+    char *string_status = nfs_stat_to_string(nfs_stat);
+    printf("Error: Failed to read directory entries with status %s\n", string_status);
+    free(string_status);
+
+    return map_nfs_error(nfs_stat);
+}
 
+/*
+ * Reads all entries of the given directory with READDIRPLUS, along with their attributes, so that listing a directory
+ * doesn't need a LOOKUP and a GETATTR for every entry, and adds them to the given list.
+ *
+ * Returns 0 on success and the appropriate negative error code on failure.
+ */
+static int read_directory_entries_plus(Nfs__FHandle *directory_fhandle, DirectoryEntriesList **head,
+                                       DirectoryEntriesList **tail) {
     uint64_t offset_cookie = 0;
     int read_all_directory_entries = 0;
     while (!read_all_directory_entries) {
@@ -44,65 +85,173 @@ void *blocking_readdir(void *arg) {
         nfs_cookie.value = offset_cookie;
 
         Nfs__ReadDirArgs readdirargs = NFS__READ_DIR_ARGS__INIT;
-        readdirargs.dir = file_fhandle;
+        readdirargs.dir = directory_fhandle;
         readdirargs.cookie = &nfs_cookie;
-        readdirargs.count = READDIR_BYTES_PER_RPC;
+        readdirargs.count = rpc_connection_context->transfer_size;
 
-        Nfs__ReadDirRes *readdirres = malloc(sizeof(Nfs__ReadDirRes));
-        int status = nfs_procedure_16_read_from_directory(rpc_connection_context, readdirargs, readdirres);
+        Nfs__ReadDirPlusRes *readdirplusres = malloc(sizeof(Nfs__ReadDirPlusRes));
+        int status = nfs_procedure_19_read_from_directory_plus(rpc_connection_context, readdirargs, readdirplusres);
         if (status != 0) {
             printf("Error: Invalid RPC reply received from the server with status %d\n", status);
 
-            callback_data->error_code = -EIO;
+            free(readdirplusres);
 
-            free(readdirres);
+            return -EIO;
+        }
+
+        if (validate_nfs_read_dir_plus_res(readdirplusres) > 0) {
+            printf("Error: Invalid NFS procedure result received from the server\n");
+
+            nfs__read_dir_plus_res__free_unpacked(readdirplusres, NULL);
 
-            goto signal;
+            return -EIO;
         }
 
-        if (validate_nfs_read_dir_res(readdirres) > 0) {
+        int error_code = get_readdir_error_code(readdirplusres->nfs_status->stat);
+        if (error_code < 0) {
+            nfs__read_dir_plus_res__free_unpacked(readdirplusres, NULL);
+
+            return error_code;
+        }
+
+        // remember all found directory entries
+        Nfs__DirectoryEntriesPlusList *entries = readdirplusres->readdirplusok->entries;
+        while (entries != NULL) {
+            append_directory_entry(head, tail, entries->name->filename, entries->attributes);
+
+            // update the UNIX directory stream offset cookie
+            offset_cookie = entries->cookie->value;
+
+            entries = entries->nextentry;
+        }
+
+        if (readdirplusres->readdirplusok->eof) {
+            read_all_directory_entries = 1;
+        }
+
+        nfs__read_dir_plus_res__free_unpacked(readdirplusres, NULL);
+    }
+
+    return 0;
+}
+
+/*
+ * Reads the names of all entries of the given directory with READDIR2, and adds them to the given list.
+ *
+ * Returns 0 on success, 1 if the server doesn't have READDIR2 (in which case nothing was read), and the appropriate
+ * negative error code on failure.
+ */
+static int read_directory_entries_2(Nfs__FHandle *directory_fhandle, DirectoryEntriesList **head,
+                                    DirectoryEntriesList **tail) {
+    uint64_t offset_cookie = 0;
+    int read_all_directory_entries = 0;
+    while (!read_all_directory_entries) {
+        Nfs__NfsCookie nfs_cookie = NFS__NFS_COOKIE__INIT;
+        nfs_cookie.value = offset_cookie;
+
+        Nfs__ReadDirArgs readdirargs = NFS__READ_DIR_ARGS__INIT;
+        readdirargs.dir = directory_fhandle;
+        readdirargs.cookie = &nfs_cookie;
+        readdirargs.count = rpc_connection_context->transfer_size;
+
+        Nfs__ReadDir2Res *readdir2res = malloc(sizeof(Nfs__ReadDir2Res));
+        int status = nfs_procedure_20_read_from_directory_2(rpc_connection_context, readdirargs, readdir2res);
+        if (status == RPC_PROC_UNAVAIL_ERROR_CODE && offset_cookie == 0) {
+            free(readdir2res);
+
+            return 1;
+        }
+        if (status != 0) {
+            printf("Error: Invalid RPC reply received from the server with status %d\n", status);
+
+            free(readdir2res);
+
+            return -EIO;
+        }
+
+        if (validate_nfs_read_dir2_res(readdir2res) > 0) {
             printf("Error: Invalid NFS procedure result received from the server\n");
 
-            callback_data->error_code = -EIO;
+            nfs__read_dir2_res__free_unpacked(readdir2res, NULL);
 
-            nfs__read_dir_res__free_unpacked(readdirres, NULL);
+            return -EIO;
+        }
+
+        int error_code = get_readdir_error_code(readdir2res->nfs_status->stat);
+        if (error_code < 0) {
+            nfs__read_dir2_res__free_unpacked(readdir2res, NULL);
 
-            goto signal;
+            return error_code;
         }
 
-        if (readdirres->nfs_status->stat == NFS__STAT__NFSERR_ACCES) {
-            printf("Error: Permission denied\n");
+        // remember all found directory entries - the names were checked to be NUL-terminated inside 'names'
+        Nfs__ReadDir2Ok *readdir2ok = readdir2res->readdir2ok;
+        for (size_t i = 0; i < readdir2ok->n_fileids; i++) {
+            append_directory_entry(head, tail, (char *)readdir2ok->names.data + readdir2ok->name_offsets[i], NULL);
+        }
 
-            callback_data->error_code = -EACCES;
+        // update the UNIX directory stream offset cookie
+        if (readdir2ok->n_cookies > 0) {
+            offset_cookie = readdir2ok->cookies[readdir2ok->n_cookies - 1];
+        }
 
-            nfs__read_dir_res__free_unpacked(readdirres, NULL);
+        if (readdir2ok->eof) {
+            read_all_directory_entries = 1;
+        }
 
-            goto signal;
-        } else if (readdirres->nfs_status->stat != NFS__STAT__NFS_OK) {
-            char *string_status = nfs_stat_to_string(readdirres->nfs_status->stat);
-            printf("Error: Failed to read directory entries with status %s\n", string_status);
-            free(string_status);
+        nfs__read_dir2_res__free_unpacked(readdir2res, NULL);
+    }
 
-            callback_data->error_code = map_nfs_error(readdirres->nfs_status->stat);
+    return 0;
+}
+
+/*
+ * Reads the names of all entries of the given directory with READDIR, and adds them to the given list.
+ *
+ * Returns 0 on success and the appropriate negative error code on failure.
+ */
+static int read_directory_entries(Nfs__FHandle *directory_fhandle, DirectoryEntriesList **head,
+                                  DirectoryEntriesList **tail) {
+    uint64_t offset_cookie = 0;
+    int read_all_directory_entries = 0;
+    while (!read_all_directory_entries) {
+        Nfs__NfsCookie nfs_cookie = NFS__NFS_COOKIE__INIT;
+        nfs_cookie.value = offset_cookie;
+
+        Nfs__ReadDirArgs readdirargs = NFS__READ_DIR_ARGS__INIT;
+        readdirargs.dir = directory_fhandle;
+        readdirargs.cookie = &nfs_cookie;
+        readdirargs.count = rpc_connection_context->transfer_size;
+
+        Nfs__ReadDirRes *readdirres = malloc(sizeof(Nfs__ReadDirRes));
+        int status = nfs_procedure_16_read_from_directory(rpc_connection_context, readdirargs, readdirres);
+        if (status != 0) {
+            printf("Error: Invalid RPC reply received from the server with status %d\n", status);
+
+            free(readdirres);
+
+            return -EIO;
+        }
+
+        if (validate_nfs_read_dir_res(readdirres) > 0) {
+            printf("Error: Invalid NFS procedure result received from the server\n");
 
             nfs__read_dir_res__free_unpacked(readdirres, NULL);
 
-            goto signal;
+            return -EIO;
+        }
+
+        int error_code = get_readdir_error_code(readdirres->nfs_status->stat);
+        if (error_code < 0) {
+            nfs__read_dir_res__free_unpacked(readdirres, NULL);
+
+            return error_code;
         }
 
         // remember all found directory entries
         Nfs__DirectoryEntriesList *entries = readdirres->readdirok->entries;
         while (entries != NULL) {
-            // add the filename to the end of the list
-            FileNamesList *new_filenames_list_entry = malloc(sizeof(FileNamesList));
-            new_filenames_list_entry->filename = strdup(entries->name->filename);
-            new_filenames_list_entry->next = NULL;
-            if (filenames_list_tail == NULL) {
-                filenames_list_head = filenames_list_tail = new_filenames_list_entry;
-            } else {
-                filenames_list_tail->next = new_filenames_list_entry;
-                filenames_list_tail = new_filenames_list_entry;
-            }
+            append_directory_entry(head, tail, entries->name->filename, NULL);
 
             // update the UNIX directory stream offset cookie
             offset_cookie = entries->cookie->value;
@@ -117,24 +266,73 @@ void *blocking_readdir(void *arg) {
         nfs__read_dir_res__free_unpacked(readdirres, NULL);
     }
 
-    // give all file names in this directory
-    FileNamesList *filenames_list = filenames_list_head;
-    while (filenames_list != NULL) {
-        filler(buffer, filenames_list->filename, NULL, 0, 0); // modify the NULL,0,0 args to give entry attributes now
+    return 0;
+}
+
+void *blocking_readdir(void *arg) {
+    CallbackData *callback_data = (CallbackData *)arg;
+
+    ReaddirData *readdir_data = (ReaddirData *)callback_data->return_data;
+
+    void *buffer = readdir_data->buffer;
+    fuse_fill_dir_t filler = readdir_data->filler;
+
+    Nfs__FType file_type;
+    int error_code;
+    Nfs__FHandle *file_fhandle = resolve_absolute_path(rpc_connection_context, filesystem_root_fhandle,
+                                                       readdir_data->path, &file_type, &error_code);
+    if (file_fhandle == NULL) {
+        printf("nfs_readdir: failed to resolve the path %s to a file\n", readdir_data->path);
+
+        callback_data->error_code = -error_code;
+
+        goto signal;
+    }
+
+    DirectoryEntriesList *entries_list_head = NULL;
+    DirectoryEntriesList *entries_list_tail = NULL;
+
+    // the kernel asks for attributes when it expects to look the entries up - otherwise only the names are needed,
+    // which READDIR2 gives most cheaply, if the server has it
+    if (readdir_data->flags & FUSE_READDIR_PLUS) {
+        error_code = read_directory_entries_plus(file_fhandle, &entries_list_head, &entries_list_tail);
+    } else {
+        error_code = 1;
+        if (!__atomic_load_n(&rpc_connection_context->readdir2_unavailable, __ATOMIC_RELAXED)) {
+            error_code = read_directory_entries_2(file_fhandle, &entries_list_head, &entries_list_tail);
+        }
+        if (error_code == 1) {
+            // the server doesn't have READDIR2, so READDIR is used on this connection from now on
+            __atomic_store_n(&rpc_connection_context->readdir2_unavailable, true, __ATOMIC_RELAXED);
 
-        filenames_list = filenames_list->next;
+            error_code = read_directory_entries(file_fhandle, &entries_list_head, &entries_list_tail);
+        }
     }
+    if (error_code < 0) {
+        callback_data->error_code = error_code;
 
-    // clean up the filenames list
-    while (filenames_list_head != NULL) {
-        FileNamesList *next = filenames_list_head->next;
+        clean_up_directory_entries_list(entries_list_head);
+        free(file_fhandle->nfs_filehandle);
+        free(file_fhandle);
 
-        free(filenames_list_head->filename);
-        free(filenames_list_head);
+        goto signal;
+    }
+
+    // give all entries in this directory, with their attributes where we have them so that the kernel caches them
+    enum fuse_fill_dir_flags fill_flags = (readdir_data->flags & FUSE_READDIR_PLUS) ? FUSE_FILL_DIR_PLUS : 0;
+    DirectoryEntriesList *entries_list = entries_list_head;
+    while (entries_list != NULL) {
+        if (entries_list->has_attributes) {
+            filler(buffer, entries_list->filename, &entries_list->attributes, 0, fill_flags);
+        } else {
+            filler(buffer, entries_list->filename, NULL, 0, 0);
+        }
 
-        filenames_list_head = next;
+        entries_list = entries_list->next;
     }
 
+    clean_up_directory_entries_list(entries_list_head);
+
     free(file_fhandle->nfs_filehandle);
     free(file_fhandle);
 
@@ -165,6 +363,7 @@ int nfs_readdir(const char *path, void *buffer, fuse_fill_dir_t filler, off_t of
     readdir_data.path = discard_const(path);
     readdir_data.buffer = buffer;
     readdir_data.filler = filler;
+    readdir_data.flags = flags;
 
     callback_data.return_data = &readdir_data;
 
@@ -11,30 +11,20 @@ void *blocking_readlink(void *arg) {
     CallbackData *callback_data = (CallbackData *)arg;
     ReadlinkData *readlink_data = (ReadlinkData *)callback_data->return_data;
 
-    Nfs__FType file_type;
+    // resolve the path and read from the symbolic link in a single round trip
     int error_code;
-    Nfs__FHandle *file_fhandle = resolve_absolute_path(rpc_connection_context, filesystem_root_fhandle,
-                                                       readlink_data->path, &file_type, &error_code);
-    if (file_fhandle == NULL) {
-        printf("nfs_readlink: failed to resolve the path %s to a file\n", readlink_data->path);
+    Nfs__FHandle file_fhandle = NFS__FHANDLE__INIT; // the server puts the resolved file here
+    Nfs__ReadLinkRes *readlinkres =
+        call_nfs_procedure_on_path(rpc_connection_context, filesystem_root_fhandle, readlink_data->path, 5,
+                                   &file_fhandle.base, &nfs__read_link_res__descriptor, &error_code);
+    if (readlinkres == NULL) {
+        printf("nfs_readlink: failed to resolve the path %s to a file and read from it\n", readlink_data->path);
 
         callback_data->error_code = -error_code;
 
         goto signal;
     }
 
-    Nfs__ReadLinkRes *readlinkres = malloc(sizeof(Nfs__ReadLinkRes));
-    int status = nfs_procedure_5_read_from_symbolic_link(rpc_connection_context, *file_fhandle, readlinkres);
-    if (status != 0) {
-        printf("Error: Invalid RPC reply received from the server with status %d\n", status);
-
-        free(readlinkres);
-
-        callback_data->error_code = -EIO;
-
-        goto signal;
-    }
-
     if (validate_nfs_read_link_res(readlinkres) > 0) {
         printf("Error: Invalid NFS procedure result received from the server\n");
 
@@ -69,8 +59,6 @@ void *blocking_readlink(void *arg) {
     strncpy(readlink_data->buffer, readlinkres->data->path, readlink_data->max_bytes_to_read);
     readlink_data->buffer[readlink_data->max_bytes_to_read - 1] = '\0'; // null terminate the retrieved path
 
-    free(file_fhandle->nfs_filehandle);
-    free(file_fhandle);
     nfs__read_link_res__free_unpacked(readlinkres, NULL);
 
     callback_data->error_code = 0;
@@ -10,34 +10,24 @@ void *blocking_rmdir(void *arg) {
 
     RmdirData *rmdir_data = (RmdirData *)callback_data->return_data;
 
-    Nfs__FType file_type;
-    int error_code;
-    Nfs__FHandle *containing_directory_fhandle =
-        resolve_absolute_path(rpc_connection_context, filesystem_root_fhandle, rmdir_data->containing_directory_path,
-                              &file_type, &error_code);
-    if (containing_directory_fhandle == NULL) {
-        printf("nfs_mknod: failed to resolve the path %s to a file\n", rmdir_data->containing_directory_path);
-
-        callback_data->error_code = -error_code;
-
-        goto signal;
-    }
-
+    Nfs__FHandle containing_directory_fhandle = NFS__FHANDLE__INIT; // the server puts the resolved directory here
     Nfs__DirOpArgs diropargs = NFS__DIR_OP_ARGS__INIT;
-    diropargs.dir = containing_directory_fhandle;
+    diropargs.dir = &containing_directory_fhandle;
 
     Nfs__FileName filename = NFS__FILE_NAME__INIT;
     filename.filename = rmdir_data->directory_name;
     diropargs.name = &filename;
 
-    Nfs__NfsStat *nfsstat = malloc(sizeof(Nfs__NfsStat));
-    int status = nfs_procedure_15_remove_directory(rpc_connection_context, diropargs, nfsstat);
-    if (status != 0) {
-        printf("Error: Invalid RPC reply received from the server with status %d\n", status);
-
-        free(nfsstat);
+    // resolve the containing directory and remove the directory in a single round trip
+    int error_code;
+    Nfs__NfsStat *nfsstat = call_nfs_procedure_on_path(rpc_connection_context, filesystem_root_fhandle,
+                                                       rmdir_data->containing_directory_path, 15, &diropargs.base,
+                                                       &nfs__nfs_stat__descriptor, &error_code);
+    if (nfsstat == NULL) {
+        printf("nfs_rmdir: failed to resolve the path %s to a directory and remove the directory from it\n",
+               rmdir_data->containing_directory_path);
 
-        callback_data->error_code = -EIO;
+        callback_data->error_code = -error_code;
 
         goto signal;
     }
@@ -73,8 +63,6 @@ void *blocking_rmdir(void *arg) {
     }
 
     nfs__nfs_stat__free_unpacked(nfsstat, NULL);
-    free(containing_directory_fhandle->nfs_filehandle);
-    free(containing_directory_fhandle);
 
     callback_data->error_code = 0;
 
@@ -11,23 +11,11 @@ void *blocking_symlink(void *arg) {
     CallbackData *callback_data = (CallbackData *)arg;
     SymlinkData *symlink_data = (SymlinkData *)callback_data->return_data;
 
-    Nfs__FType file_type;
-    int error_code;
-    Nfs__FHandle *containing_directory_fhandle =
-        resolve_absolute_path(rpc_connection_context, filesystem_root_fhandle, symlink_data->containing_directory_path,
-                              &file_type, &error_code);
-    if (containing_directory_fhandle == NULL) {
-        printf("nfs_symlink: failed to resolve the path %s to a file\n", symlink_data->containing_directory_path);
-
-        callback_data->error_code = -error_code;
-
-        goto signal;
-    }
-
+    Nfs__FHandle containing_directory_fhandle = NFS__FHANDLE__INIT; // the server puts the resolved directory here
     Nfs__SymLinkArgs symlinkargs = NFS__SYM_LINK_ARGS__INIT;
 
     Nfs__DirOpArgs from_diropargs = NFS__DIR_OP_ARGS__INIT;
-    from_diropargs.dir = containing_directory_fhandle;
+    from_diropargs.dir = &containing_directory_fhandle;
     Nfs__FileName file_name = NFS__FILE_NAME__INIT;
     file_name.filename = symlink_data->symlink_name;
     from_diropargs.name = &file_name;
@@ -51,14 +39,16 @@ void *blocking_symlink(void *arg) {
 
     symlinkargs.attributes = &sattr;
 
-    Nfs__NfsStat *nfsstat = malloc(sizeof(Nfs__NfsStat));
-    int status = nfs_procedure_13_create_symbolic_link(rpc_connection_context, symlinkargs, nfsstat);
-    if (status != 0) {
-        printf("Error: Invalid RPC reply received from the server with status %d\n", status);
-
-        free(nfsstat);
+    // resolve the containing directory and create the symbolic link in a single round trip
+    int error_code;
+    Nfs__NfsStat *nfsstat = call_nfs_procedure_on_path(rpc_connection_context, filesystem_root_fhandle,
+                                                       symlink_data->containing_directory_path, 13, &symlinkargs.base,
+                                                       &nfs__nfs_stat__descriptor, &error_code);
+    if (nfsstat == NULL) {
+        printf("nfs_symlink: failed to resolve the path %s to a directory and create the symbolic link in it\n",
+               symlink_data->containing_directory_path);
 
-        callback_data->error_code = -EIO;
+        callback_data->error_code = -error_code;
 
         goto signal;
     }
@@ -94,8 +84,6 @@ void *blocking_symlink(void *arg) {
     }
 
     nfs__nfs_stat__free_unpacked(nfsstat, NULL);
-    free(containing_directory_fhandle->nfs_filehandle);
-    free(containing_directory_fhandle);
 
     callback_data->error_code = 0;
 
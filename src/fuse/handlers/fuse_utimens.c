@@ -16,20 +16,9 @@ void *blocking_utimens(void *arg) {
 
     UtimensData *utimens_data = (UtimensData *)callback_data->return_data;
 
-    Nfs__FType file_type;
-    int error_code;
-    Nfs__FHandle *file_fhandle = resolve_absolute_path(rpc_connection_context, filesystem_root_fhandle,
-                                                       utimens_data->path, &file_type, &error_code);
-    if (file_fhandle == NULL) {
-        printf("nfs_getattr: failed to resolve the path %s to a file\n", utimens_data->path);
-
-        callback_data->error_code = -error_code;
-
-        goto signal;
-    }
-
+    Nfs__FHandle file_fhandle = NFS__FHANDLE__INIT; // the server puts the resolved file here
     Nfs__SAttrArgs sattrargs = NFS__SATTR_ARGS__INIT;
-    sattrargs.file = file_fhandle;
+    sattrargs.file = &file_fhandle;
 
     Nfs__SAttr sattr = NFS__SATTR__INIT;
     sattr.mode = -1;
@@ -69,14 +58,15 @@ void *blocking_utimens(void *arg) {
 
     sattrargs.attributes = &sattr;
 
-    Nfs__AttrStat *attrstat = malloc(sizeof(Nfs__AttrStat));
-    int status = nfs_procedure_2_set_file_attributes(rpc_connection_context, sattrargs, attrstat);
-    if (status != 0) {
-        printf("Error: Invalid RPC reply received from the server with status %d\n", status);
-
-        free(attrstat);
+    // resolve the path and set the file's timestamps in a single round trip
+    int error_code;
+    Nfs__AttrStat *attrstat =
+        call_nfs_procedure_on_path(rpc_connection_context, filesystem_root_fhandle, utimens_data->path, 2,
+                                   &sattrargs.base, &nfs__attr_stat__descriptor, &error_code);
+    if (attrstat == NULL) {
+        printf("nfs_utimens: failed to resolve the path %s to a file and set its timestamps\n", utimens_data->path);
 
-        callback_data->error_code = -EIO;
+        callback_data->error_code = -error_code;
 
         goto signal;
     }
@@ -112,8 +102,6 @@ void *blocking_utimens(void *arg) {
     }
 
     nfs__attr_stat__free_unpacked(attrstat, NULL);
-    free(file_fhandle->nfs_filehandle);
-    free(file_fhandle);
 
     callback_data->error_code = 0;
 
@@ -1,7 +1,5 @@
 #include "handlers.h"
 
-#define WRITE_BYTES_PER_RPC 5000
-
 typedef struct WriteData {
     char *path;
 
@@ -29,6 +27,8 @@ void *blocking_write(void *arg) {
         goto signal;
     }
 
+    size_t write_bytes_per_rpc = rpc_connection_context->transfer_size;
+
     write_data->bytes_written = 0;
     while (write_data->bytes_written < write_data->write_buffer_size) {
         Nfs__WriteArgs writeargs = NFS__WRITE_ARGS__INIT;
@@ -37,10 +37,10 @@ void *blocking_write(void *arg) {
 
         writeargs.nfsdata.data = write_data->write_buffer + write_data->bytes_written;
         size_t bytes_left_to_write = write_data->write_buffer_size - write_data->bytes_written;
-        if (bytes_left_to_write < WRITE_BYTES_PER_RPC) {
+        if (bytes_left_to_write < write_bytes_per_rpc) {
             writeargs.nfsdata.len = bytes_left_to_write;
         } else {
-            writeargs.nfsdata.len = WRITE_BYTES_PER_RPC;
+            writeargs.nfsdata.len = write_bytes_per_rpc;
         }
 
         writeargs.beginoffset = writeargs.totalcount = 0; // unused fields
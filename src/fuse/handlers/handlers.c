@@ -61,3 +61,32 @@ int map_nfs_error(int nfs_status) {
         return -EIO; // default to I/O error for unknown cases
     }
 }
+
+/*
+ * Fills in the given stat structure from the given NFS file attributes.
+ */
+void fattr_to_stat(Nfs__FAttr *fattr, struct stat *stbuf) {
+    memset(stbuf, 0, sizeof(struct stat));
+
+    stbuf->st_dev = fattr->fsid;
+    stbuf->st_ino = fattr->fileid;
+    stbuf->st_mode = fattr->mode;
+    stbuf->st_nlink = fattr->nlink;
+
+    stbuf->st_uid = fattr->uid;
+    stbuf->st_gid = fattr->gid;
+
+    stbuf->st_rdev = fattr->rdev;
+    stbuf->st_size = fattr->size;
+    stbuf->st_blksize = fattr->blocksize;
+    stbuf->st_blocks = fattr->blocks;
+
+    stbuf->st_atim.tv_sec = fattr->atime->seconds;
+    stbuf->st_atim.tv_nsec = fattr->atime->useconds;
+
+    stbuf->st_mtim.tv_sec = fattr->mtime->seconds;
+    stbuf->st_mtim.tv_nsec = fattr->mtime->useconds;
+
+    stbuf->st_ctim.tv_sec = fattr->ctime->seconds;
+    stbuf->st_ctim.tv_nsec = fattr->ctime->useconds;
+}
\ No newline at end of file
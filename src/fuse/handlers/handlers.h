@@ -30,6 +30,8 @@ void wait_for_nfs_reply(CallbackData *callback_data);
 
 int map_nfs_error(int nfs_status);
 
+void fattr_to_stat(Nfs__FAttr *fattr, struct stat *stbuf);
+
 int nfs_getattr(const char *path, struct stat *stbuf, struct fuse_file_info *fi);
 
 int nfs_readdir(const char *path, void *buffer, fuse_fill_dir_t filler, off_t offset, struct fuse_file_info *fi,
@@ -50,6 +50,8 @@ Nfs__FHandle *filesystem_root_fhandle;
 
 TransportProtocol chosen_transport_protocol;
 
+RpcCodec chosen_rpc_codec = RPC_CODEC_PROTOBUF;
+
 /*
  * Cleans up all Nfs client state before the client shuts down.
  */
@@ -79,6 +81,7 @@ int mount_remote_filesystem(char *server_ipv4_address, uint16_t server_port, cha
         printf("Error: Failed to create AUTH_SYS Rpc connection context\n");
         return 1;
     }
+    rpc_connection_context->rpc_codec = chosen_rpc_codec;
 
     // mount the NFS share
     Mount__DirPath dirpath = MOUNT__DIR_PATH__INIT;
@@ -143,14 +146,20 @@ int mount_remote_filesystem(char *server_ipv4_address, uint16_t server_port, cha
     nfs__fhandle__init(filesystem_root_fhandle);
     filesystem_root_fhandle->nfs_filehandle = nfs_filehandle_copy;
 
+    // find out how much data the server moves in a single RPC and how it can be compressed - if it can't tell us, we
+    // stay with NFS_MAXDATA and no compression
+    if (negotiate_transfer_parameters(rpc_connection_context, *filesystem_root_fhandle) > 0) {
+        printf("Failed to get the transfer parameters of the server, using %d bytes\n", NFS_MAXDATA);
+    }
+
     return 0;
 }
 
 int main(int argc, char *argv[]) {
-    if (argc != 6) {
+    if (argc != 6 && argc != 7) {
         fprintf(stderr,
-                "Error: Incorrect usage. Correct usage: %s <IPv4 addr> <port number> --proto=<tcp or quic> <remote "
-                "absolute path> <mount point> \n",
+                "Error: Incorrect usage. Correct usage: %s <IPv4 addr> <port number> --proto=<tcp, tls, quic or shm> "
+                "<remote absolute path> <mount point> [--codec=<protobuf or xdr>]\n",
                 argv[0]);
         return 1;
     }
@@ -167,14 +176,34 @@ int main(int argc, char *argv[]) {
         char *protocol = argv[3] + strlen(proto_flag);
         if (strcmp(protocol, "tcp") == 0) {
             chosen_transport_protocol = TRANSPORT_PROTOCOL_TCP;
+        } else if (strcmp(protocol, "tls") == 0) {
+            chosen_transport_protocol = TRANSPORT_PROTOCOL_TLS;
         } else if (strcmp(protocol, "quic") == 0) {
             chosen_transport_protocol = TRANSPORT_PROTOCOL_QUIC;
+        } else if (strcmp(protocol, "shm") == 0) {
+            chosen_transport_protocol = TRANSPORT_PROTOCOL_SHM;
         } else {
             fprintf(stderr, "Error: Invalid transport protocol: %s\n", protocol);
             return 1;
         }
     }
 
+    const char *codec_flag = "--codec=";
+    if (argc == 7 && strncmp(argv[6], codec_flag, strlen(codec_flag)) == 0) {
+        char *codec = argv[6] + strlen(codec_flag);
+        if (strcmp(codec, "protobuf") == 0) {
+            chosen_rpc_codec = RPC_CODEC_PROTOBUF;
+        } else if (strcmp(codec, "xdr") == 0) {
+            chosen_rpc_codec = RPC_CODEC_XDR;
+        } else {
+            fprintf(stderr, "Error: Invalid codec: %s\n", codec);
+            return 1;
+        }
+    } else if (argc == 7) {
+        fprintf(stderr, "Error: Invalid argument: %s\n", argv[6]);
+        return 1;
+    }
+
     char *remote_absolute_path = argv[4];
 
     // initialize NFS client state
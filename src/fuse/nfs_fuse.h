@@ -17,4 +17,6 @@ extern Nfs__FHandle *filesystem_root_fhandle;
 
 extern TransportProtocol chosen_transport_protocol;
 
+extern RpcCodec chosen_rpc_codec;
+
 #endif /* nfs_fuse__HEADER__INCLUDED */
\ No newline at end of file
@@ -6,20 +6,66 @@
 
 #include "src/nfs/clients/nfs_client.h"
 
+/*
+ * Packs the given procedure parameters into a new COMPOUND operation, that runs the given procedure on the current
+ * filehandle.
+ *
+ * Returns 0 on success and > 0 on failure.
+ *
+ * The user of this function takes the responsibility to free 'operation->parameters.data'.
+ */
+static int create_compound_operation(RpcCodec codec, uint32_t procedure_number, const ProtobufCMessage *parameters,
+                                     Nfs__CompoundOp *operation) {
+    nfs__compound_op__init(operation);
+    operation->procedure = procedure_number;
+    operation->use_current_fhandle = 1;
+
+    size_t parameters_size = get_rpc_payload_packed_size(codec, parameters);
+    operation->parameters.data = malloc(parameters_size > 0 ? parameters_size : 1);
+    if (operation->parameters.data == NULL) {
+        return 1;
+    }
+    operation->parameters.len = pack_rpc_payload(codec, parameters, operation->parameters.data);
+
+    return 0;
+}
+
+/*
+ * Maps the status of a failed LOOKUP of a pathname component to an error code.
+ */
+static int map_lookup_error(Nfs__Stat stat) {
+    switch (stat) {
+    case NFS__STAT__NFSERR_ACCES:
+        return EACCES;
+    case NFS__STAT__NFSERR_NOTDIR:
+        return ENOTDIR;
+    default:
+        return ENOENT;
+    }
+}
+
 /*
  * Given the PRC connection context and the fhandle of the filesystem root, resolves the given absolute path
- * (i.e. starting with a /) to a file as specified in https://man7.org/linux/man-pages/man7/path_resolution.7.html.
+ * (i.e. starting with a /), and then optionally runs the given Nfs procedure on the resolved file - all in a single
+ * NFSPROC_COMPOUND call.
  *
- * Performs LOOKUP procedures from the filesystem root to resolve component by component of the
- * pathname. Returns the NFS fhandle of the resolved file and places that file's type in the 'ftype' argument.
+ * The path is resolved by a LOOKUP operation of every pathname component, each one in the directory found by the one
+ * before. If 'parameters' is not NULL, the procedure 'procedure_number' then runs on the resolved file in place of the
+ * FHandle in 'parameters' (which must be present, but may be empty).
  *
- * On failure, returns NULL and places the error appropriate error code in 'error_code' argument.
+ * Returns the CompoundRes, in which the first 'num_lookups' results are those of the LOOKUP operations (all of
+ * which succeeded), and the next one, if present, is that of the procedure. Places the number of pathname components
+ * in 'num_lookups'.
  *
- * The user of this function takes the responsibility to free the received Nfs__FHandle and
- * the NfsFh__NfsFileHandle inside it.
+ * On failure, returns NULL and places the appropriate error code in 'error_code' argument.
+ *
+ * The user of this function takes the responsibility to free the received Nfs__CompoundRes with
+ * nfs__compound_res__free_unpacked(compoundres, NULL).
  */
-Nfs__FHandle *resolve_absolute_path(RpcConnectionContext *rpc_connection_context, Nfs__FHandle *filesystem_root_fhandle,
-                                    char *path, Nfs__FType *ftype, int *error_code) {
+static Nfs__CompoundRes *run_compound_on_path(RpcConnectionContext *rpc_connection_context,
+                                              Nfs__FHandle *filesystem_root_fhandle, char *path,
+                                              uint32_t procedure_number, const ProtobufCMessage *parameters,
+                                              size_t *num_lookups, int *error_code) {
     if (rpc_connection_context == NULL) {
         *error_code = EINVAL;
         return NULL;
@@ -40,135 +86,268 @@ Nfs__FHandle *resolve_absolute_path(RpcConnectionContext *rpc_connection_context
         return NULL;
     }
 
-    Nfs__FHandle *curr_fhandle = filesystem_root_fhandle;
-    Nfs__FType curr_ftype = NFS__FTYPE__NFDIR;
-
     int pathname_length = strlen(path);
+    if (pathname_length > NFS_MAXPATHLEN) {
+        *error_code = ENAMETOOLONG;
+        return NULL;
+    }
+
+    RpcCodec codec = rpc_connection_context->rpc_codec;
+
     char *path_copy = malloc(sizeof(char) * (pathname_length + 1));
     strncpy(path_copy, path, pathname_length);
     path_copy[pathname_length] = '\0';
 
-    // look up component by component of the pathname
-    char *save_ptr;
-    char *pathname_component = strtok_r(path_copy, "/", &save_ptr);
-    int is_first_component = 1;
-    while (pathname_component != NULL) {
-        if (curr_ftype != NFS__FTYPE__NFDIR) {
-            free(path_copy);
+    // a pathname of at most NFS_MAXPATHLEN bytes has fewer than NFS_MAX_COMPOUND_OPERATIONS components
+    Nfs__CompoundOp *operations = malloc(sizeof(Nfs__CompoundOp) * NFS_MAX_COMPOUND_OPERATIONS);
+    Nfs__CompoundOp **operation_pointers = malloc(sizeof(Nfs__CompoundOp *) * NFS_MAX_COMPOUND_OPERATIONS);
+    if (operations == NULL || operation_pointers == NULL) {
+        free(path_copy);
+        free(operations);
+        free(operation_pointers);
 
-            *error_code = ENOTDIR;
+        *error_code = EIO;
 
-            return NULL;
-        }
+        return NULL;
+    }
 
-        // look up this pathname component
+    Nfs__CompoundArgs compoundargs = NFS__COMPOUND_ARGS__INIT;
+    compoundargs.fhandle = filesystem_root_fhandle;
+    compoundargs.operations = operation_pointers;
+
+    // the server runs every LOOKUP in the directory found by the previous one, in place of this empty FHandle
+    Nfs__FHandle current_fhandle = NFS__FHANDLE__INIT;
+
+    // look up component by component of the pathname
+    int status = 0;
+    char *save_ptr;
+    char *pathname_component = strtok_r(path_copy, "/", &save_ptr);
+    while (pathname_component != NULL && status == 0) {
         Nfs__DirOpArgs diropargs = NFS__DIR_OP_ARGS__INIT;
-        diropargs.dir = curr_fhandle;
+        diropargs.dir = &current_fhandle;
         Nfs__FileName file_name = NFS__FILE_NAME__INIT;
         file_name.filename = pathname_component;
         diropargs.name = &file_name;
 
-        Nfs__DirOpRes *diropres = malloc(sizeof(Nfs__DirOpRes));
-        int status = nfs_procedure_4_look_up_file_name(rpc_connection_context, diropargs, diropres);
+        Nfs__CompoundOp *operation = &operations[compoundargs.n_operations];
+        status = create_compound_operation(codec, 4, &diropargs.base, operation);
+        operation_pointers[compoundargs.n_operations++] = operation;
+
+        // get the next pathname component
+        pathname_component = strtok_r(NULL, "/", &save_ptr);
+    }
+    *num_lookups = compoundargs.n_operations;
+
+    // then run the procedure on the resolved file
+    if (parameters != NULL && status == 0) {
+        Nfs__CompoundOp *operation = &operations[compoundargs.n_operations];
+        status = create_compound_operation(codec, procedure_number, parameters, operation);
+        operation_pointers[compoundargs.n_operations++] = operation;
+    }
+
+    Nfs__CompoundRes *compoundres = NULL;
+    if (status == 0) {
+        compoundres = malloc(sizeof(Nfs__CompoundRes));
+        status = nfs_procedure_18_compound(rpc_connection_context, compoundargs, compoundres);
         if (status != 0) {
             printf("Error: Invalid RPC reply received from the server with status %d\n", status);
 
-            free(path_copy);
-            free(diropres);
+            free(compoundres);
+            compoundres = NULL;
+        }
+    }
 
-            *error_code = EIO;
+    for (size_t i = 0; i < compoundargs.n_operations; i++) {
+        free(operations[i].parameters.data);
+    }
+    free(operations);
+    free(operation_pointers);
+    free(path_copy);
 
-            return NULL;
-        }
+    if (compoundres == NULL) {
+        *error_code = EIO;
 
-        if (validate_nfs_dir_op_res(diropres) > 0) {
-            printf("Error: Invalid NFS LOOKUP procedure result received from the server\n");
+        return NULL;
+    }
 
-            free(path_copy);
-            nfs__dir_op_res__free_unpacked(diropres, NULL);
+    if (validate_nfs_compound_res(compoundres) > 0) {
+        printf("Error: Invalid NFS COMPOUND procedure result received from the server\n");
+
+        nfs__compound_res__free_unpacked(compoundres, NULL);
+
+        *error_code = EIO;
+
+        return NULL;
+    }
+
+    // check that every pathname component was found
+    for (size_t i = 0; i < *num_lookups; i++) {
+        if (i >= compoundres->n_results) {
+            printf("Error: Server did not run all LOOKUP operations while resolving pathname %s\n", path);
+
+            nfs__compound_res__free_unpacked(compoundres, NULL);
 
             *error_code = EIO;
 
             return NULL;
         }
 
-        if (diropres->nfs_status->stat == NFS__STAT__NFSERR_ACCES) {
+        Nfs__Stat stat = compoundres->results[i]->nfs_status->stat;
+        if (stat == NFS__STAT__NFSERR_ACCES) {
             printf("Error: Permission denied\n");
 
-            free(path_copy);
-            nfs__dir_op_res__free_unpacked(diropres, NULL);
+            nfs__compound_res__free_unpacked(compoundres, NULL);
 
             *error_code = EACCES;
 
             return NULL;
-        } else if (diropres->nfs_status->stat != NFS__STAT__NFS_OK) {
-            char *string_status = nfs_stat_to_string(diropres->nfs_status->stat);
-            printf("Error: Failed to lookup pathname component %s while resolving pathname %s, with status %s\n",
-                   pathname_component, path, string_status);
+        } else if (stat != NFS__STAT__NFS_OK) {
+            char *string_status = nfs_stat_to_string(stat);
+            printf("Error: Failed to lookup pathname component %zu while resolving pathname %s, with status %s\n",
+                   i + 1, path, string_status);
             free(string_status);
 
-            free(path_copy);
-            nfs__dir_op_res__free_unpacked(diropres, NULL);
+            nfs__compound_res__free_unpacked(compoundres, NULL);
 
-            *error_code = ENOENT;
+            *error_code = map_lookup_error(stat);
 
             return NULL;
         }
+    }
 
-        curr_ftype = diropres->diropok->attributes->nfs_ftype->ftype;
+    *error_code = 0;
 
-        // free the previous file handle if it's not the starting one
-        if (!is_first_component) {
-            free(curr_fhandle->nfs_filehandle);
-            free(curr_fhandle);
-        }
-        is_first_component = 0;
+    return compoundres;
+}
 
-        // make a stack allocated fhandle for this looked up file
-        NfsFh__NfsFileHandle *nfs_filehandle = malloc(sizeof(NfsFh__NfsFileHandle));
-        if (nfs_filehandle == NULL) {
-            free(path_copy);
-            nfs__dir_op_res__free_unpacked(diropres, NULL);
+/*
+ * Given the PRC connection context and the fhandle of the filesystem root, resolves the given absolute path
+ * (i.e. starting with a /) to a file as specified in https://man7.org/linux/man-pages/man7/path_resolution.7.html.
+ *
+ * Performs LOOKUP procedures from the filesystem root to resolve component by component of the pathname, all in a
+ * single NFSPROC_COMPOUND call. Returns the NFS fhandle of the resolved file and places that file's type in the
+ * 'ftype' argument.
+ *
+ * On failure, returns NULL and places the error appropriate error code in 'error_code' argument.
+ *
+ * The user of this function takes the responsibility to free the received Nfs__FHandle and
+ * the NfsFh__NfsFileHandle inside it.
+ */
+Nfs__FHandle *resolve_absolute_path(RpcConnectionContext *rpc_connection_context, Nfs__FHandle *filesystem_root_fhandle,
+                                    char *path, Nfs__FType *ftype, int *error_code) {
+    size_t num_lookups;
+    Nfs__CompoundRes *compoundres = run_compound_on_path(rpc_connection_context, filesystem_root_fhandle, path, 0,
+                                                         NULL, &num_lookups, error_code);
+    if (compoundres == NULL) {
+        return NULL;
+    }
 
-            *error_code = EIO;
+    // make a heap allocated copy of the resolved file's NFS fhandle
+    Nfs__FHandle *file_fhandle = malloc(sizeof(Nfs__FHandle));
+    nfs__fhandle__init(file_fhandle);
+    NfsFh__NfsFileHandle *file_nfs_filehandle = malloc(sizeof(NfsFh__NfsFileHandle));
+    nfs_fh__nfs_file_handle__init(file_nfs_filehandle);
+    file_fhandle->nfs_filehandle = file_nfs_filehandle;
 
-            return NULL;
-        }
-        *nfs_filehandle = deep_copy_nfs_filehandle(diropres->diropok->file->nfs_filehandle);
-        nfs__dir_op_res__free_unpacked(diropres, NULL);
-        curr_fhandle = malloc(sizeof(Nfs__FHandle));
-        if (curr_fhandle == NULL) {
-            free(path_copy);
+    if (num_lookups == 0) {
+        // the path is the filesystem root itself
+        *file_nfs_filehandle = deep_copy_nfs_filehandle(filesystem_root_fhandle->nfs_filehandle);
+        *ftype = NFS__FTYPE__NFDIR;
 
-            *error_code = EIO;
+        nfs__compound_res__free_unpacked(compoundres, NULL);
 
-            return NULL;
-        }
-        nfs__fhandle__init(curr_fhandle);
-        curr_fhandle->nfs_filehandle = nfs_filehandle;
+        *error_code = 0;
 
-        // get the next pathname component
-        pathname_component = strtok_r(NULL, "/", &save_ptr);
+        return file_fhandle;
     }
 
-    free(path_copy);
+    // the last LOOKUP found the file
+    ProtobufCBinaryData results = compoundres->results[num_lookups - 1]->results;
+    Nfs__DirOpRes *diropres =
+        unpack_rpc_payload(rpc_connection_context->rpc_codec, &nfs__dir_op_res__descriptor, NULL, results.len,
+                           results.data);
+    nfs__compound_res__free_unpacked(compoundres, NULL);
+    if (validate_nfs_dir_op_res(diropres) > 0) {
+        printf("Error: Invalid NFS LOOKUP procedure result received from the server\n");
 
-    *ftype = curr_ftype;
+        if (diropres != NULL) {
+            nfs__dir_op_res__free_unpacked(diropres, NULL);
+        }
+        free(file_nfs_filehandle);
+        free(file_fhandle);
 
-    // make a heap allocated copy of the resolved file's NFS fhandle
-    Nfs__FHandle *file_fhandle = malloc(sizeof(Nfs__FHandle));
-    nfs__fhandle__init(file_fhandle);
-    NfsFh__NfsFileHandle *file_nfs_filehandle = malloc(sizeof(NfsFh__NfsFileHandle));
-    nfs_fh__nfs_file_handle__init(file_nfs_filehandle);
-    *file_nfs_filehandle = deep_copy_nfs_filehandle(curr_fhandle->nfs_filehandle);
-    file_fhandle->nfs_filehandle = file_nfs_filehandle;
+        *error_code = EIO;
 
-    if (!is_first_component) {
-        free(curr_fhandle->nfs_filehandle);
-        free(curr_fhandle);
+        return NULL;
     }
 
+    *file_nfs_filehandle = deep_copy_nfs_filehandle(diropres->diropok->file->nfs_filehandle);
+    *ftype = diropres->diropok->attributes->nfs_ftype->ftype;
+
+    nfs__dir_op_res__free_unpacked(diropres, NULL);
+
     *error_code = 0;
 
     return file_fhandle;
-}
\ No newline at end of file
+}
+
+/*
+ * Given the PRC connection context and the fhandle of the filesystem root, resolves the given absolute path
+ * (i.e. starting with a /) and runs the given Nfs procedure on the resolved file, in a single round trip.
+ *
+ * The procedure runs on the resolved file in place of the FHandle in 'parameters' (the directory for directory
+ * operations, and the file otherwise), which must be present but may be empty.
+ *
+ * Returns the procedure results, unpacked with the given descriptor. On failure to resolve the path or to run the
+ * procedure, returns NULL and places the appropriate error code in 'error_code' argument.
+ *
+ * The user of this function takes the responsibility to free the received procedure results with the
+ * '*__free_unpacked' function of their type, given a NULL allocator.
+ */
+void *call_nfs_procedure_on_path(RpcConnectionContext *rpc_connection_context, Nfs__FHandle *filesystem_root_fhandle,
+                                 char *path, uint32_t procedure_number, const ProtobufCMessage *parameters,
+                                 const ProtobufCMessageDescriptor *results_descriptor, int *error_code) {
+    size_t num_lookups;
+    Nfs__CompoundRes *compoundres = run_compound_on_path(rpc_connection_context, filesystem_root_fhandle, path,
+                                                         procedure_number, parameters, &num_lookups, error_code);
+    if (compoundres == NULL) {
+        return NULL;
+    }
+
+    if (compoundres->n_results != num_lookups + 1) {
+        printf("Error: Server did not run procedure %u after resolving pathname %s\n", procedure_number, path);
+
+        nfs__compound_res__free_unpacked(compoundres, NULL);
+
+        *error_code = EIO;
+
+        return NULL;
+    }
+
+    // a failed operation without results is one that the server could not run at all
+    Nfs__CompoundOpRes *operation_result = compoundres->results[num_lookups];
+    if (operation_result->nfs_status->stat != NFS__STAT__NFS_OK && operation_result->results.len == 0) {
+        printf("Error: Server failed to run procedure %u on pathname %s\n", procedure_number, path);
+
+        nfs__compound_res__free_unpacked(compoundres, NULL);
+
+        *error_code = EIO;
+
+        return NULL;
+    }
+
+    void *results = unpack_rpc_payload(rpc_connection_context->rpc_codec, results_descriptor, NULL,
+                                       operation_result->results.len, operation_result->results.data);
+    nfs__compound_res__free_unpacked(compoundres, NULL);
+    if (results == NULL) {
+        printf("Error: Failed to unpack the results of procedure %u from the server\n", procedure_number);
+
+        *error_code = EIO;
+
+        return NULL;
+    }
+
+    *error_code = 0;
+
+    return results;
+}
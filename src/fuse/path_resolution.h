@@ -8,4 +8,8 @@
 Nfs__FHandle *resolve_absolute_path(RpcConnectionContext *rpc_connection_context, Nfs__FHandle *filesystem_root_fhandle,
                                     char *path, Nfs__FType *ftype, int *error_code);
 
+void *call_nfs_procedure_on_path(RpcConnectionContext *rpc_connection_context, Nfs__FHandle *filesystem_root_fhandle,
+                                 char *path, uint32_t procedure_number, const ProtobufCMessage *parameters,
+                                 const ProtobufCMessageDescriptor *results_descriptor, int *error_code);
+
 #endif /* path_resolution__HEADER__INCLUDED */
\ No newline at end of file
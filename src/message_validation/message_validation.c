@@ -324,5 +324,176 @@ int validate_nfs_read_link_res(Nfs__ReadLinkRes *readlinkres) {
         }
     }
 
+    return 0;
+}
+/*
+ * Validates the structure of the given CompoundRes - the results of the individual operations are validated by
+ * whoever unpacks them.
+ *
+ * Returns 0 on success and > 0 on failure.
+ */
+int validate_nfs_compound_res(Nfs__CompoundRes *compoundres) {
+    if (compoundres == NULL) {
+        return 1;
+    }
+
+    if (compoundres->nfs_status == NULL) {
+        return 1;
+    }
+
+    for (size_t i = 0; i < compoundres->n_results; i++) {
+        Nfs__CompoundOpRes *operation_result = compoundres->results[i];
+        if (operation_result == NULL) {
+            return 1;
+        }
+
+        if (operation_result->nfs_status == NULL) {
+            return 1;
+        }
+
+        // only the last operation that was run may have failed
+        if (operation_result->nfs_status->stat != NFS__STAT__NFS_OK && i != compoundres->n_results - 1) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/*
+ * Validates the structure of the given ReadDirPlusOk.
+ *
+ * Returns 0 on success and > 0 on failure.
+ */
+int validate_nfs_read_dir_plus_ok(Nfs__ReadDirPlusOk *readdirplusok) {
+    if (readdirplusok == NULL) {
+        return 1;
+    }
+
+    Nfs__DirectoryEntriesPlusList *entries = readdirplusok->entries;
+    while (entries != NULL) {
+        if (entries->name == NULL || entries->name->filename == NULL) {
+            return 1;
+        }
+
+        if (entries->cookie == NULL) {
+            return 1;
+        }
+
+        // the filehandle and the attributes of an entry are either both given or both left out
+        if ((entries->file == NULL) != (entries->attributes == NULL)) {
+            return 1;
+        }
+        if (entries->file != NULL && (validate_nfs_fhandle(entries->file) > 0 ||
+                                      validate_nfs_fattr(entries->attributes) > 0)) {
+            return 1;
+        }
+
+        entries = entries->nextentry;
+    }
+
+    return 0;
+}
+
+/*
+ * Validates the structure of the given ReadDirPlusRes.
+ *
+ * Returns 0 on success and > 0 on failure.
+ */
+int validate_nfs_read_dir_plus_res(Nfs__ReadDirPlusRes *readdirplusres) {
+    if (readdirplusres == NULL) {
+        return 1;
+    }
+
+    if (readdirplusres->nfs_status == NULL) {
+        return 1;
+    }
+
+    if (readdirplusres->nfs_status->stat == NFS__STAT__NFS_OK) {
+        if (readdirplusres->body_case != NFS__READ_DIR_PLUS_RES__BODY_READDIRPLUSOK) {
+            return 1;
+        }
+        if (validate_nfs_read_dir_plus_ok(readdirplusres->readdirplusok) > 0) {
+            return 1;
+        }
+    } else {
+        if (readdirplusres->body_case != NFS__READ_DIR_PLUS_RES__BODY_DEFAULT_CASE) {
+            return 1;
+        }
+        if (readdirplusres->default_case == NULL) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/*
+ * Validates the structure of the given ReadDir2Ok - every entry has a fileid, a cookie and a name offset, and every
+ * name offset is the start of a NUL-terminated name inside 'names', so names can be used in place.
+ *
+ * Returns 0 on success and > 0 on failure.
+ */
+int validate_nfs_read_dir2_ok(Nfs__ReadDir2Ok *readdir2ok) {
+    if (readdir2ok == NULL) {
+        return 1;
+    }
+
+    if (readdir2ok->n_cookies != readdir2ok->n_fileids || readdir2ok->n_name_offsets != readdir2ok->n_fileids) {
+        return 1;
+    }
+
+    if (readdir2ok->n_fileids == 0) {
+        return 0;
+    }
+
+    // the last name is NUL-terminated, so every name starting right after a NUL byte is too
+    if (readdir2ok->names.len == 0 || readdir2ok->names.data[readdir2ok->names.len - 1] != '\0') {
+        return 1;
+    }
+
+    for (size_t i = 0; i < readdir2ok->n_name_offsets; i++) {
+        uint32_t name_offset = readdir2ok->name_offsets[i];
+        if (name_offset >= readdir2ok->names.len) {
+            return 1;
+        }
+        if (name_offset > 0 && readdir2ok->names.data[name_offset - 1] != '\0') {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/*
+ * Validates the structure of the given ReadDir2Res.
+ *
+ * Returns 0 on success and > 0 on failure.
+ */
+int validate_nfs_read_dir2_res(Nfs__ReadDir2Res *readdir2res) {
+    if (readdir2res == NULL) {
+        return 1;
+    }
+
+    if (readdir2res->nfs_status == NULL) {
+        return 1;
+    }
+
+    if (readdir2res->nfs_status->stat == NFS__STAT__NFS_OK) {
+        if (readdir2res->body_case != NFS__READ_DIR2_RES__BODY_READDIR2OK) {
+            return 1;
+        }
+        if (validate_nfs_read_dir2_ok(readdir2res->readdir2ok) > 0) {
+            return 1;
+        }
+    } else {
+        if (readdir2res->body_case != NFS__READ_DIR2_RES__BODY_DEFAULT_CASE) {
+            return 1;
+        }
+        if (readdir2res->default_case == NULL) {
+            return 1;
+        }
+    }
+
     return 0;
 }
\ No newline at end of file
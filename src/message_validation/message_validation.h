@@ -18,4 +18,10 @@ int validate_nfs_read_res(Nfs__ReadRes *readres);
 
 int validate_nfs_read_link_res(Nfs__ReadLinkRes *readlinkres);
 
+int validate_nfs_compound_res(Nfs__CompoundRes *compoundres);
+
+int validate_nfs_read_dir_plus_res(Nfs__ReadDirPlusRes *readdirplusres);
+
+int validate_nfs_read_dir2_res(Nfs__ReadDir2Res *readdir2res);
+
 #endif /* message_validation__HEADER__INCLUDED */
\ No newline at end of file
@@ -15,11 +15,15 @@ int mount_procedure_0_do_nothing(RpcConnectionContext *rpc_connection_context) {
     Rpc__RpcMsg *rpc_reply;
     switch (rpc_connection_context->transport_protocol) {
     case TRANSPORT_PROTOCOL_TCP:
+    case TRANSPORT_PROTOCOL_TLS:
         rpc_reply = invoke_rpc_remote_tcp(rpc_connection_context, MOUNT_RPC_PROGRAM_NUMBER, 2, 0, parameters);
         break;
     case TRANSPORT_PROTOCOL_QUIC:
         rpc_reply = invoke_rpc_remote_quic(rpc_connection_context, MOUNT_RPC_PROGRAM_NUMBER, 2, 0, parameters, true);
         break;
+    case TRANSPORT_PROTOCOL_SHM:
+        rpc_reply = invoke_rpc_remote_shm(rpc_connection_context, MOUNT_RPC_PROGRAM_NUMBER, 2, 0, parameters);
+        break;
     default:
         rpc_reply = invoke_rpc_remote_tcp(rpc_connection_context, MOUNT_RPC_PROGRAM_NUMBER, 2, 0, parameters);
     }
@@ -60,10 +64,12 @@ int mount_procedure_0_do_nothing(RpcConnectionContext *rpc_connection_context) {
  */
 int mount_procedure_1_add_mount_entry(RpcConnectionContext *rpc_connection_context, Mount__DirPath dirpath,
                                       Mount__FhStatus *result) {
+    RpcCodec codec = rpc_connection_context->rpc_codec;
+
     // serialize the DirPath
-    size_t dirpath_size = mount__dir_path__get_packed_size(&dirpath);
-    uint8_t *dirpath_buffer = malloc(dirpath_size);
-    mount__dir_path__pack(&dirpath, dirpath_buffer);
+    size_t dirpath_size = get_rpc_payload_packed_size(codec, &dirpath.base);
+    uint8_t *dirpath_buffer = allocate_rpc_payload_buffer(dirpath_size);
+    pack_rpc_payload(codec, &dirpath.base, dirpath_buffer);
 
     // Any message to wrap DirPath
     Google__Protobuf__Any parameters = GOOGLE__PROTOBUF__ANY__INIT;
@@ -75,15 +81,19 @@ int mount_procedure_1_add_mount_entry(RpcConnectionContext *rpc_connection_conte
     Rpc__RpcMsg *rpc_reply;
     switch (rpc_connection_context->transport_protocol) {
     case TRANSPORT_PROTOCOL_TCP:
+    case TRANSPORT_PROTOCOL_TLS:
         rpc_reply = invoke_rpc_remote_tcp(rpc_connection_context, MOUNT_RPC_PROGRAM_NUMBER, 2, 1, parameters);
         break;
     case TRANSPORT_PROTOCOL_QUIC:
         rpc_reply = invoke_rpc_remote_quic(rpc_connection_context, MOUNT_RPC_PROGRAM_NUMBER, 2, 1, parameters, true);
         break;
+    case TRANSPORT_PROTOCOL_SHM:
+        rpc_reply = invoke_rpc_remote_shm(rpc_connection_context, MOUNT_RPC_PROGRAM_NUMBER, 2, 1, parameters);
+        break;
     default:
         rpc_reply = invoke_rpc_remote_tcp(rpc_connection_context, MOUNT_RPC_PROGRAM_NUMBER, 2, 1, parameters);
     }
-    free(dirpath_buffer);
+    free_rpc_payload_buffer(dirpath_buffer);
 
     // validate RPC reply
     int error_code = validate_successful_accepted_reply(rpc_reply);
@@ -114,8 +124,8 @@ int mount_procedure_1_add_mount_entry(RpcConnectionContext *rpc_connection_conte
     }
 
     // now we can unpack the FhStatus from the Any message
-    Mount__FhStatus *fh_status =
-        mount__fh_status__unpack(NULL, procedure_results->value.len, procedure_results->value.data);
+    Mount__FhStatus *fh_status = unpack_rpc_payload(codec, &mount__fh_status__descriptor, NULL,
+                                                    procedure_results->value.len, procedure_results->value.data);
     if (fh_status == NULL) {
         fprintf(stderr, "MOUNTPROC_MNT: Failed to unpack Mount__FhStatus\n");
 
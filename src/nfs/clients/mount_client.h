@@ -10,6 +10,7 @@
 #include "src/common_rpc/rpc_connection_context.h"
 
 #include "src/transport/quic/quic_rpc_client.h"
+#include "src/transport/shm/shm_rpc_client.h"
 #include "src/transport/tcp/tcp_rpc_client.h"
 
 #include "../nfs_common.h"
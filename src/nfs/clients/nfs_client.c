@@ -15,11 +15,15 @@ int nfs_procedure_0_do_nothing(RpcConnectionContext *rpc_connection_context) {
     Rpc__RpcMsg *rpc_reply;
     switch (rpc_connection_context->transport_protocol) {
     case TRANSPORT_PROTOCOL_TCP:
+    case TRANSPORT_PROTOCOL_TLS:
         rpc_reply = invoke_rpc_remote_tcp(rpc_connection_context, NFS_RPC_PROGRAM_NUMBER, 2, 0, parameters);
         break;
     case TRANSPORT_PROTOCOL_QUIC:
         rpc_reply = invoke_rpc_remote_quic(rpc_connection_context, NFS_RPC_PROGRAM_NUMBER, 2, 0, parameters, true);
         break;
+    case TRANSPORT_PROTOCOL_SHM:
+        rpc_reply = invoke_rpc_remote_shm(rpc_connection_context, NFS_RPC_PROGRAM_NUMBER, 2, 0, parameters);
+        break;
     default:
         rpc_reply = invoke_rpc_remote_tcp(rpc_connection_context, NFS_RPC_PROGRAM_NUMBER, 2, 0, parameters);
     }
@@ -61,10 +65,12 @@ int nfs_procedure_0_do_nothing(RpcConnectionContext *rpc_connection_context) {
  */
 int nfs_procedure_1_get_file_attributes(RpcConnectionContext *rpc_connection_context, Nfs__FHandle fhandle,
                                         Nfs__AttrStat *result) {
+    RpcCodec codec = rpc_connection_context->rpc_codec;
+
     // serialize the FHandle
-    size_t fhandle_size = nfs__fhandle__get_packed_size(&fhandle);
-    uint8_t *fhandle_buffer = malloc(fhandle_size);
-    nfs__fhandle__pack(&fhandle, fhandle_buffer);
+    size_t fhandle_size = get_rpc_payload_packed_size(codec, &fhandle.base);
+    uint8_t *fhandle_buffer = allocate_rpc_payload_buffer(fhandle_size);
+    pack_rpc_payload(codec, &fhandle.base, fhandle_buffer);
 
     // Any message to wrap FHandle
     Google__Protobuf__Any parameters = GOOGLE__PROTOBUF__ANY__INIT;
@@ -76,15 +82,19 @@ int nfs_procedure_1_get_file_attributes(RpcConnectionContext *rpc_connection_con
     Rpc__RpcMsg *rpc_reply;
     switch (rpc_connection_context->transport_protocol) {
     case TRANSPORT_PROTOCOL_TCP:
+    case TRANSPORT_PROTOCOL_TLS:
         rpc_reply = invoke_rpc_remote_tcp(rpc_connection_context, NFS_RPC_PROGRAM_NUMBER, 2, 1, parameters);
         break;
     case TRANSPORT_PROTOCOL_QUIC:
         rpc_reply = invoke_rpc_remote_quic(rpc_connection_context, NFS_RPC_PROGRAM_NUMBER, 2, 1, parameters, true);
         break;
+    case TRANSPORT_PROTOCOL_SHM:
+        rpc_reply = invoke_rpc_remote_shm(rpc_connection_context, NFS_RPC_PROGRAM_NUMBER, 2, 1, parameters);
+        break;
     default:
         rpc_reply = invoke_rpc_remote_tcp(rpc_connection_context, NFS_RPC_PROGRAM_NUMBER, 2, 1, parameters);
     }
-    free(fhandle_buffer);
+    free_rpc_payload_buffer(fhandle_buffer);
 
     // validate RPC reply
     int error_code = validate_successful_accepted_reply(rpc_reply);
@@ -114,8 +124,8 @@ int nfs_procedure_1_get_file_attributes(RpcConnectionContext *rpc_connection_con
     }
 
     // now we can unpack the AttrStat from the Any message
-    Nfs__AttrStat *attr_stat =
-        nfs__attr_stat__unpack(NULL, procedure_results->value.len, procedure_results->value.data);
+    Nfs__AttrStat *attr_stat = unpack_rpc_payload(codec, &nfs__attr_stat__descriptor, NULL,
+                                                  procedure_results->value.len, procedure_results->value.data);
     if (attr_stat == NULL) {
         fprintf(stderr, "NFSPROC_GETATTR: Failed to unpack Nfs__AttrStat\n");
 
@@ -143,10 +153,12 @@ int nfs_procedure_1_get_file_attributes(RpcConnectionContext *rpc_connection_con
  */
 int nfs_procedure_2_set_file_attributes(RpcConnectionContext *rpc_connection_context, Nfs__SAttrArgs sattrargs,
                                         Nfs__AttrStat *result) {
+    RpcCodec codec = rpc_connection_context->rpc_codec;
+
     // serialize the SAttrArgs
-    size_t sattrargs_size = nfs__sattr_args__get_packed_size(&sattrargs);
-    uint8_t *sattrargs_buffer = malloc(sattrargs_size);
-    nfs__sattr_args__pack(&sattrargs, sattrargs_buffer);
+    size_t sattrargs_size = get_rpc_payload_packed_size(codec, &sattrargs.base);
+    uint8_t *sattrargs_buffer = allocate_rpc_payload_buffer(sattrargs_size);
+    pack_rpc_payload(codec, &sattrargs.base, sattrargs_buffer);
 
     // Any message to wrap SAttrArgs
     Google__Protobuf__Any parameters = GOOGLE__PROTOBUF__ANY__INIT;
@@ -158,15 +170,19 @@ int nfs_procedure_2_set_file_attributes(RpcConnectionContext *rpc_connection_con
     Rpc__RpcMsg *rpc_reply;
     switch (rpc_connection_context->transport_protocol) {
     case TRANSPORT_PROTOCOL_TCP:
+    case TRANSPORT_PROTOCOL_TLS:
         rpc_reply = invoke_rpc_remote_tcp(rpc_connection_context, NFS_RPC_PROGRAM_NUMBER, 2, 2, parameters);
         break;
     case TRANSPORT_PROTOCOL_QUIC:
         rpc_reply = invoke_rpc_remote_quic(rpc_connection_context, NFS_RPC_PROGRAM_NUMBER, 2, 2, parameters, true);
         break;
+    case TRANSPORT_PROTOCOL_SHM:
+        rpc_reply = invoke_rpc_remote_shm(rpc_connection_context, NFS_RPC_PROGRAM_NUMBER, 2, 2, parameters);
+        break;
     default:
         rpc_reply = invoke_rpc_remote_tcp(rpc_connection_context, NFS_RPC_PROGRAM_NUMBER, 2, 2, parameters);
     }
-    free(sattrargs_buffer);
+    free_rpc_payload_buffer(sattrargs_buffer);
 
     // validate RPC reply
     int error_code = validate_successful_accepted_reply(rpc_reply);
@@ -196,8 +212,8 @@ int nfs_procedure_2_set_file_attributes(RpcConnectionContext *rpc_connection_con
     }
 
     // now we can unpack the AttrStat from the Any message
-    Nfs__AttrStat *attr_stat =
-        nfs__attr_stat__unpack(NULL, procedure_results->value.len, procedure_results->value.data);
+    Nfs__AttrStat *attr_stat = unpack_rpc_payload(codec, &nfs__attr_stat__descriptor, NULL,
+                                                  procedure_results->value.len, procedure_results->value.data);
     if (attr_stat == NULL) {
         fprintf(stderr, "NFSPROC_SETATTR: Failed to unpack Nfs__AttrStat\n");
 
@@ -225,10 +241,12 @@ int nfs_procedure_2_set_file_attributes(RpcConnectionContext *rpc_connection_con
  */
 int nfs_procedure_4_look_up_file_name(RpcConnectionContext *rpc_connection_context, Nfs__DirOpArgs diropargs,
                                       Nfs__DirOpRes *result) {
+    RpcCodec codec = rpc_connection_context->rpc_codec;
+
     // serialize the DirOpArgs
-    size_t diropargs_size = nfs__dir_op_args__get_packed_size(&diropargs);
-    uint8_t *diropargs_buffer = malloc(diropargs_size);
-    nfs__dir_op_args__pack(&diropargs, diropargs_buffer);
+    size_t diropargs_size = get_rpc_payload_packed_size(codec, &diropargs.base);
+    uint8_t *diropargs_buffer = allocate_rpc_payload_buffer(diropargs_size);
+    pack_rpc_payload(codec, &diropargs.base, diropargs_buffer);
 
     // Any message to wrap DirOpArgs
     Google__Protobuf__Any parameters = GOOGLE__PROTOBUF__ANY__INIT;
@@ -240,15 +258,19 @@ int nfs_procedure_4_look_up_file_name(RpcConnectionContext *rpc_connection_conte
     Rpc__RpcMsg *rpc_reply;
     switch (rpc_connection_context->transport_protocol) {
     case TRANSPORT_PROTOCOL_TCP:
+    case TRANSPORT_PROTOCOL_TLS:
         rpc_reply = invoke_rpc_remote_tcp(rpc_connection_context, NFS_RPC_PROGRAM_NUMBER, 2, 4, parameters);
         break;
     case TRANSPORT_PROTOCOL_QUIC:
         rpc_reply = invoke_rpc_remote_quic(rpc_connection_context, NFS_RPC_PROGRAM_NUMBER, 2, 4, parameters, true);
         break;
+    case TRANSPORT_PROTOCOL_SHM:
+        rpc_reply = invoke_rpc_remote_shm(rpc_connection_context, NFS_RPC_PROGRAM_NUMBER, 2, 4, parameters);
+        break;
     default:
         rpc_reply = invoke_rpc_remote_tcp(rpc_connection_context, NFS_RPC_PROGRAM_NUMBER, 2, 4, parameters);
     }
-    free(diropargs_buffer);
+    free_rpc_payload_buffer(diropargs_buffer);
 
     // validate RPC reply
     int error_code = validate_successful_accepted_reply(rpc_reply);
@@ -278,8 +300,8 @@ int nfs_procedure_4_look_up_file_name(RpcConnectionContext *rpc_connection_conte
     }
 
     // now we can unpack the DirOpRes from the Any message
-    Nfs__DirOpRes *diropres =
-        nfs__dir_op_res__unpack(NULL, procedure_results->value.len, procedure_results->value.data);
+    Nfs__DirOpRes *diropres = unpack_rpc_payload(codec, &nfs__dir_op_res__descriptor, NULL,
+                                                 procedure_results->value.len, procedure_results->value.data);
     if (diropres == NULL) {
         fprintf(stderr, "NFSPROC_LOOKUP: Failed to unpack Nfs__DirOpRes\n");
 
@@ -307,10 +329,12 @@ int nfs_procedure_4_look_up_file_name(RpcConnectionContext *rpc_connection_conte
  */
 int nfs_procedure_5_read_from_symbolic_link(RpcConnectionContext *rpc_connection_context, Nfs__FHandle fhandle,
                                             Nfs__ReadLinkRes *result) {
+    RpcCodec codec = rpc_connection_context->rpc_codec;
+
     // serialize the FHandle
-    size_t fhandle_size = nfs__fhandle__get_packed_size(&fhandle);
-    uint8_t *fhandle_buffer = malloc(fhandle_size);
-    nfs__fhandle__pack(&fhandle, fhandle_buffer);
+    size_t fhandle_size = get_rpc_payload_packed_size(codec, &fhandle.base);
+    uint8_t *fhandle_buffer = allocate_rpc_payload_buffer(fhandle_size);
+    pack_rpc_payload(codec, &fhandle.base, fhandle_buffer);
 
     // Any message to wrap FHandle
     Google__Protobuf__Any parameters = GOOGLE__PROTOBUF__ANY__INIT;
@@ -322,15 +346,19 @@ int nfs_procedure_5_read_from_symbolic_link(RpcConnectionContext *rpc_connection
     Rpc__RpcMsg *rpc_reply;
     switch (rpc_connection_context->transport_protocol) {
     case TRANSPORT_PROTOCOL_TCP:
+    case TRANSPORT_PROTOCOL_TLS:
         rpc_reply = invoke_rpc_remote_tcp(rpc_connection_context, NFS_RPC_PROGRAM_NUMBER, 2, 5, parameters);
         break;
     case TRANSPORT_PROTOCOL_QUIC:
         rpc_reply = invoke_rpc_remote_quic(rpc_connection_context, NFS_RPC_PROGRAM_NUMBER, 2, 5, parameters, true);
         break;
+    case TRANSPORT_PROTOCOL_SHM:
+        rpc_reply = invoke_rpc_remote_shm(rpc_connection_context, NFS_RPC_PROGRAM_NUMBER, 2, 5, parameters);
+        break;
     default:
         rpc_reply = invoke_rpc_remote_tcp(rpc_connection_context, NFS_RPC_PROGRAM_NUMBER, 2, 5, parameters);
     }
-    free(fhandle_buffer);
+    free_rpc_payload_buffer(fhandle_buffer);
 
     // validate RPC reply
     int error_code = validate_successful_accepted_reply(rpc_reply);
@@ -360,8 +388,8 @@ int nfs_procedure_5_read_from_symbolic_link(RpcConnectionContext *rpc_connection
     }
 
     // now we can unpack the ReadLinkres from the Any message
-    Nfs__ReadLinkRes *readlinkres =
-        nfs__read_link_res__unpack(NULL, procedure_results->value.len, procedure_results->value.data);
+    Nfs__ReadLinkRes *readlinkres = unpack_rpc_payload(codec, &nfs__read_link_res__descriptor, NULL,
+                                                       procedure_results->value.len, procedure_results->value.data);
     if (readlinkres == NULL) {
         fprintf(stderr, "NFSPROC_READLINK: Failed to unpack Nfs__ReadLinkRes\n");
 
@@ -377,6 +405,76 @@ int nfs_procedure_5_read_from_symbolic_link(RpcConnectionContext *rpc_connection
     return 0;
 }
 
+/*
+ * Decompresses the data of the given READ results in place, if the server sent it compressed.
+ *
+ * Returns 0 on success and > 0 on failure.
+ */
+static int decompress_read_data(Nfs__ReadResBody *readresbody) {
+    if (readresbody->compression == RPC_COMPRESSION_NONE) {
+        return 0;
+    }
+    if (!is_rpc_compression_supported(readresbody->compression) ||
+        readresbody->uncompressed_size > NFS_MAX_TRANSFER_SIZE) {
+        return 1;
+    }
+
+    uint8_t *data = malloc(readresbody->uncompressed_size > 0 ? readresbody->uncompressed_size : 1);
+    if (data == NULL) {
+        return 2;
+    }
+    if (decompress_rpc_payload_data(readresbody->compression, readresbody->nfsdata.data, readresbody->nfsdata.len,
+                                    data, readresbody->uncompressed_size) > 0) {
+        free(data);
+        return 3;
+    }
+
+    free(readresbody->nfsdata.data);
+    readresbody->nfsdata.data = data;
+    readresbody->nfsdata.len = readresbody->uncompressed_size;
+    readresbody->compression = RPC_COMPRESSION_NONE;
+
+    return 0;
+}
+
+/*
+ * Compresses the data of the given WRITE parameters, if the connection has a compression and the data is expected to
+ * compress well.
+ *
+ * Returns the buffer holding the compressed data, which the user of this function takes the responsibility to free
+ * once the parameters are serialized, or NULL if the data is left as it is.
+ */
+static uint8_t *compress_write_data(RpcConnectionContext *rpc_connection_context, Nfs__WriteArgs *writeargs) {
+    RpcCompression compression = rpc_connection_context->payload_compression;
+    if (compression == RPC_COMPRESSION_NONE || writeargs->file == NULL || writeargs->file->nfs_filehandle == NULL) {
+        return NULL;
+    }
+
+    uint64_t file_id = writeargs->file->nfs_filehandle->inode_number;
+    RpcCompressionPolicy *policy = &rpc_connection_context->compression_policy;
+    if (!should_compress_rpc_payload_data(policy, file_id, writeargs->nfsdata.data, writeargs->nfsdata.len)) {
+        return NULL;
+    }
+
+    uint8_t *compressed_data = malloc(get_rpc_compression_bound(compression, writeargs->nfsdata.len));
+    if (compressed_data == NULL) {
+        return NULL;
+    }
+    size_t compressed_size;
+    if (compress_rpc_payload_data(policy, compression, file_id, writeargs->nfsdata.data, writeargs->nfsdata.len,
+                                  compressed_data, &compressed_size) > 0) {
+        free(compressed_data);
+        return NULL;
+    }
+
+    writeargs->compression = compression;
+    writeargs->uncompressed_size = writeargs->nfsdata.len;
+    writeargs->nfsdata.data = compressed_data;
+    writeargs->nfsdata.len = compressed_size;
+
+    return compressed_data;
+}
+
 /*
  * Calls the NFSPROC_READ Nfs procedure.
  * On successful run, returns 0 and places procedure result in 'result'.
@@ -389,10 +487,15 @@ int nfs_procedure_5_read_from_symbolic_link(RpcConnectionContext *rpc_connection
  */
 int nfs_procedure_6_read_from_file(RpcConnectionContext *rpc_connection_context, Nfs__ReadArgs readargs,
                                    Nfs__ReadRes *result) {
+    RpcCodec codec = rpc_connection_context->rpc_codec;
+
+    // let the server send the data compressed
+    readargs.accepted_compression = rpc_connection_context->payload_compression;
+
     // serialize the ReadArgs
-    size_t readargs_size = nfs__read_args__get_packed_size(&readargs);
-    uint8_t *readargs_buffer = malloc(readargs_size);
-    nfs__read_args__pack(&readargs, readargs_buffer);
+    size_t readargs_size = get_rpc_payload_packed_size(codec, &readargs.base);
+    uint8_t *readargs_buffer = allocate_rpc_payload_buffer(readargs_size);
+    pack_rpc_payload(codec, &readargs.base, readargs_buffer);
 
     // Any message to wrap ReadArgs
     Google__Protobuf__Any parameters = GOOGLE__PROTOBUF__ANY__INIT;
@@ -404,15 +507,19 @@ int nfs_procedure_6_read_from_file(RpcConnectionContext *rpc_connection_context,
     Rpc__RpcMsg *rpc_reply;
     switch (rpc_connection_context->transport_protocol) {
     case TRANSPORT_PROTOCOL_TCP:
+    case TRANSPORT_PROTOCOL_TLS:
         rpc_reply = invoke_rpc_remote_tcp(rpc_connection_context, NFS_RPC_PROGRAM_NUMBER, 2, 6, parameters);
         break;
     case TRANSPORT_PROTOCOL_QUIC:
         rpc_reply = invoke_rpc_remote_quic(rpc_connection_context, NFS_RPC_PROGRAM_NUMBER, 2, 6, parameters, true);
         break;
+    case TRANSPORT_PROTOCOL_SHM:
+        rpc_reply = invoke_rpc_remote_shm(rpc_connection_context, NFS_RPC_PROGRAM_NUMBER, 2, 6, parameters);
+        break;
     default:
         rpc_reply = invoke_rpc_remote_tcp(rpc_connection_context, NFS_RPC_PROGRAM_NUMBER, 2, 6, parameters);
     }
-    free(readargs_buffer);
+    free_rpc_payload_buffer(readargs_buffer);
 
     // validate RPC reply
     int error_code = validate_successful_accepted_reply(rpc_reply);
@@ -442,7 +549,8 @@ int nfs_procedure_6_read_from_file(RpcConnectionContext *rpc_connection_context,
     }
 
     // now we can unpack the ReadRes from the Any message
-    Nfs__ReadRes *readres = nfs__read_res__unpack(NULL, procedure_results->value.len, procedure_results->value.data);
+    Nfs__ReadRes *readres = unpack_rpc_payload(codec, &nfs__read_res__descriptor, NULL, procedure_results->value.len,
+                                               procedure_results->value.data);
     if (readres == NULL) {
         fprintf(stderr, "NFSPROC_READ: Failed to unpack Nfs__ReadRes\n");
 
@@ -450,6 +558,16 @@ int nfs_procedure_6_read_from_file(RpcConnectionContext *rpc_connection_context,
         return -3;
     }
 
+    // hand the data back as it was read from the file
+    if (readres->body_case == NFS__READ_RES__BODY_READRESBODY && readres->readresbody != NULL &&
+        decompress_read_data(readres->readresbody) > 0) {
+        fprintf(stderr, "NFSPROC_READ: Failed to decompress the data read\n");
+
+        nfs__read_res__free_unpacked(readres, NULL);
+        rpc__rpc_msg__free_unpacked(rpc_reply, NULL);
+        return -4;
+    }
+
     // place readres into the result
     *result = *readres;
 
@@ -470,10 +588,15 @@ int nfs_procedure_6_read_from_file(RpcConnectionContext *rpc_connection_context,
  */
 int nfs_procedure_8_write_to_file(RpcConnectionContext *rpc_connection_context, Nfs__WriteArgs writeargs,
                                   Nfs__AttrStat *result) {
+    RpcCodec codec = rpc_connection_context->rpc_codec;
+
+    uint8_t *compressed_data = compress_write_data(rpc_connection_context, &writeargs);
+
     // serialize the ReadArgs
-    size_t writeargs_size = nfs__write_args__get_packed_size(&writeargs);
-    uint8_t *writeargs_buffer = malloc(writeargs_size);
-    nfs__write_args__pack(&writeargs, writeargs_buffer);
+    size_t writeargs_size = get_rpc_payload_packed_size(codec, &writeargs.base);
+    uint8_t *writeargs_buffer = allocate_rpc_payload_buffer(writeargs_size);
+    pack_rpc_payload(codec, &writeargs.base, writeargs_buffer);
+    free(compressed_data);
 
     // Any message to wrap WriteArgs
     Google__Protobuf__Any parameters = GOOGLE__PROTOBUF__ANY__INIT;
@@ -485,15 +608,19 @@ int nfs_procedure_8_write_to_file(RpcConnectionContext *rpc_connection_context,
     Rpc__RpcMsg *rpc_reply;
     switch (rpc_connection_context->transport_protocol) {
     case TRANSPORT_PROTOCOL_TCP:
+    case TRANSPORT_PROTOCOL_TLS:
         rpc_reply = invoke_rpc_remote_tcp(rpc_connection_context, NFS_RPC_PROGRAM_NUMBER, 2, 8, parameters);
         break;
     case TRANSPORT_PROTOCOL_QUIC:
         rpc_reply = invoke_rpc_remote_quic(rpc_connection_context, NFS_RPC_PROGRAM_NUMBER, 2, 8, parameters, true);
         break;
+    case TRANSPORT_PROTOCOL_SHM:
+        rpc_reply = invoke_rpc_remote_shm(rpc_connection_context, NFS_RPC_PROGRAM_NUMBER, 2, 8, parameters);
+        break;
     default:
         rpc_reply = invoke_rpc_remote_tcp(rpc_connection_context, NFS_RPC_PROGRAM_NUMBER, 2, 8, parameters);
     }
-    free(writeargs_buffer);
+    free_rpc_payload_buffer(writeargs_buffer);
 
     // validate RPC reply
     int error_code = validate_successful_accepted_reply(rpc_reply);
@@ -523,7 +650,8 @@ int nfs_procedure_8_write_to_file(RpcConnectionContext *rpc_connection_context,
     }
 
     // now we can unpack the AttrStat from the Any message
-    Nfs__AttrStat *attrstat = nfs__attr_stat__unpack(NULL, procedure_results->value.len, procedure_results->value.data);
+    Nfs__AttrStat *attrstat = unpack_rpc_payload(codec, &nfs__attr_stat__descriptor, NULL, procedure_results->value.len,
+                                                 procedure_results->value.data);
     if (attrstat == NULL) {
         fprintf(stderr, "NFSPROC_READ: Failed to unpack Nfs__AttrStat\n");
 
@@ -551,10 +679,12 @@ int nfs_procedure_8_write_to_file(RpcConnectionContext *rpc_connection_context,
  */
 int nfs_procedure_9_create_file(RpcConnectionContext *rpc_connection_context, Nfs__CreateArgs createargs,
                                 Nfs__DirOpRes *result) {
+    RpcCodec codec = rpc_connection_context->rpc_codec;
+
     // serialize the CreateArgs
-    size_t createargs_size = nfs__create_args__get_packed_size(&createargs);
-    uint8_t *createargs_buffer = malloc(createargs_size);
-    nfs__create_args__pack(&createargs, createargs_buffer);
+    size_t createargs_size = get_rpc_payload_packed_size(codec, &createargs.base);
+    uint8_t *createargs_buffer = allocate_rpc_payload_buffer(createargs_size);
+    pack_rpc_payload(codec, &createargs.base, createargs_buffer);
 
     // Any message to wrap CreateArgs
     Google__Protobuf__Any parameters = GOOGLE__PROTOBUF__ANY__INIT;
@@ -566,15 +696,19 @@ int nfs_procedure_9_create_file(RpcConnectionContext *rpc_connection_context, Nf
     Rpc__RpcMsg *rpc_reply;
     switch (rpc_connection_context->transport_protocol) {
     case TRANSPORT_PROTOCOL_TCP:
+    case TRANSPORT_PROTOCOL_TLS:
         rpc_reply = invoke_rpc_remote_tcp(rpc_connection_context, NFS_RPC_PROGRAM_NUMBER, 2, 9, parameters);
         break;
     case TRANSPORT_PROTOCOL_QUIC:
         rpc_reply = invoke_rpc_remote_quic(rpc_connection_context, NFS_RPC_PROGRAM_NUMBER, 2, 9, parameters, true);
         break;
+    case TRANSPORT_PROTOCOL_SHM:
+        rpc_reply = invoke_rpc_remote_shm(rpc_connection_context, NFS_RPC_PROGRAM_NUMBER, 2, 9, parameters);
+        break;
     default:
         rpc_reply = invoke_rpc_remote_tcp(rpc_connection_context, NFS_RPC_PROGRAM_NUMBER, 2, 9, parameters);
     }
-    free(createargs_buffer);
+    free_rpc_payload_buffer(createargs_buffer);
 
     // validate RPC reply
     int error_code = validate_successful_accepted_reply(rpc_reply);
@@ -604,8 +738,8 @@ int nfs_procedure_9_create_file(RpcConnectionContext *rpc_connection_context, Nf
     }
 
     // now we can unpack the DirOpRes from the Any message
-    Nfs__DirOpRes *diropres =
-        nfs__dir_op_res__unpack(NULL, procedure_results->value.len, procedure_results->value.data);
+    Nfs__DirOpRes *diropres = unpack_rpc_payload(codec, &nfs__dir_op_res__descriptor, NULL,
+                                                 procedure_results->value.len, procedure_results->value.data);
     if (diropres == NULL) {
         fprintf(stderr, "NFSPROC_CREATE: Failed to unpack Nfs__DirOpRes\n");
 
@@ -633,10 +767,12 @@ int nfs_procedure_9_create_file(RpcConnectionContext *rpc_connection_context, Nf
  */
 int nfs_procedure_10_remove_file(RpcConnectionContext *rpc_connection_context, Nfs__DirOpArgs diropargs,
                                  Nfs__NfsStat *result) {
+    RpcCodec codec = rpc_connection_context->rpc_codec;
+
     // serialize the DirOpArgs
-    size_t diropargs_size = nfs__dir_op_args__get_packed_size(&diropargs);
-    uint8_t *diropargs_buffer = malloc(diropargs_size);
-    nfs__dir_op_args__pack(&diropargs, diropargs_buffer);
+    size_t diropargs_size = get_rpc_payload_packed_size(codec, &diropargs.base);
+    uint8_t *diropargs_buffer = allocate_rpc_payload_buffer(diropargs_size);
+    pack_rpc_payload(codec, &diropargs.base, diropargs_buffer);
 
     // Any message to wrap DirOpArgs
     Google__Protobuf__Any parameters = GOOGLE__PROTOBUF__ANY__INIT;
@@ -648,15 +784,19 @@ int nfs_procedure_10_remove_file(RpcConnectionContext *rpc_connection_context, N
     Rpc__RpcMsg *rpc_reply;
     switch (rpc_connection_context->transport_protocol) {
     case TRANSPORT_PROTOCOL_TCP:
+    case TRANSPORT_PROTOCOL_TLS:
         rpc_reply = invoke_rpc_remote_tcp(rpc_connection_context, NFS_RPC_PROGRAM_NUMBER, 2, 10, parameters);
         break;
     case TRANSPORT_PROTOCOL_QUIC:
         rpc_reply = invoke_rpc_remote_quic(rpc_connection_context, NFS_RPC_PROGRAM_NUMBER, 2, 10, parameters, true);
         break;
+    case TRANSPORT_PROTOCOL_SHM:
+        rpc_reply = invoke_rpc_remote_shm(rpc_connection_context, NFS_RPC_PROGRAM_NUMBER, 2, 10, parameters);
+        break;
     default:
         rpc_reply = invoke_rpc_remote_tcp(rpc_connection_context, NFS_RPC_PROGRAM_NUMBER, 2, 10, parameters);
     }
-    free(diropargs_buffer);
+    free_rpc_payload_buffer(diropargs_buffer);
 
     // validate RPC reply
     int error_code = validate_successful_accepted_reply(rpc_reply);
@@ -686,7 +826,8 @@ int nfs_procedure_10_remove_file(RpcConnectionContext *rpc_connection_context, N
     }
 
     // now we can unpack the NfsStat from the Any message
-    Nfs__NfsStat *nfs_status = nfs__nfs_stat__unpack(NULL, procedure_results->value.len, procedure_results->value.data);
+    Nfs__NfsStat *nfs_status = unpack_rpc_payload(codec, &nfs__nfs_stat__descriptor, NULL, procedure_results->value.len,
+                                                  procedure_results->value.data);
     if (nfs_status == NULL) {
         fprintf(stderr, "NFSPROC_REMOVE: Failed to unpack Nfs__NfsStat\n");
 
@@ -714,10 +855,12 @@ int nfs_procedure_10_remove_file(RpcConnectionContext *rpc_connection_context, N
  */
 int nfs_procedure_11_rename_file(RpcConnectionContext *rpc_connection_context, Nfs__RenameArgs renameargs,
                                  Nfs__NfsStat *result) {
+    RpcCodec codec = rpc_connection_context->rpc_codec;
+
     // serialize the RenameArgs
-    size_t renameargs_size = nfs__rename_args__get_packed_size(&renameargs);
-    uint8_t *renameargs_buffer = malloc(renameargs_size);
-    nfs__rename_args__pack(&renameargs, renameargs_buffer);
+    size_t renameargs_size = get_rpc_payload_packed_size(codec, &renameargs.base);
+    uint8_t *renameargs_buffer = allocate_rpc_payload_buffer(renameargs_size);
+    pack_rpc_payload(codec, &renameargs.base, renameargs_buffer);
 
     // Any message to wrap RenameArgs
     Google__Protobuf__Any parameters = GOOGLE__PROTOBUF__ANY__INIT;
@@ -729,15 +872,19 @@ int nfs_procedure_11_rename_file(RpcConnectionContext *rpc_connection_context, N
     Rpc__RpcMsg *rpc_reply;
     switch (rpc_connection_context->transport_protocol) {
     case TRANSPORT_PROTOCOL_TCP:
+    case TRANSPORT_PROTOCOL_TLS:
         rpc_reply = invoke_rpc_remote_tcp(rpc_connection_context, NFS_RPC_PROGRAM_NUMBER, 2, 11, parameters);
         break;
     case TRANSPORT_PROTOCOL_QUIC:
         rpc_reply = invoke_rpc_remote_quic(rpc_connection_context, NFS_RPC_PROGRAM_NUMBER, 2, 11, parameters, true);
         break;
+    case TRANSPORT_PROTOCOL_SHM:
+        rpc_reply = invoke_rpc_remote_shm(rpc_connection_context, NFS_RPC_PROGRAM_NUMBER, 2, 11, parameters);
+        break;
     default:
         rpc_reply = invoke_rpc_remote_tcp(rpc_connection_context, NFS_RPC_PROGRAM_NUMBER, 2, 11, parameters);
     }
-    free(renameargs_buffer);
+    free_rpc_payload_buffer(renameargs_buffer);
 
     // validate RPC reply
     int error_code = validate_successful_accepted_reply(rpc_reply);
@@ -767,7 +914,8 @@ int nfs_procedure_11_rename_file(RpcConnectionContext *rpc_connection_context, N
     }
 
     // now we can unpack the NfsStat from the Any message
-    Nfs__NfsStat *nfs_status = nfs__nfs_stat__unpack(NULL, procedure_results->value.len, procedure_results->value.data);
+    Nfs__NfsStat *nfs_status = unpack_rpc_payload(codec, &nfs__nfs_stat__descriptor, NULL, procedure_results->value.len,
+                                                  procedure_results->value.data);
     if (nfs_status == NULL) {
         fprintf(stderr, "NFSPROC_RENAME: Failed to unpack Nfs__NfsStat\n");
 
@@ -795,10 +943,12 @@ int nfs_procedure_11_rename_file(RpcConnectionContext *rpc_connection_context, N
  */
 int nfs_procedure_12_create_link_to_file(RpcConnectionContext *rpc_connection_context, Nfs__LinkArgs linkargs,
                                          Nfs__NfsStat *result) {
+    RpcCodec codec = rpc_connection_context->rpc_codec;
+
     // serialize the LinkArgs
-    size_t linkargs_size = nfs__link_args__get_packed_size(&linkargs);
-    uint8_t *linkargs_buffer = malloc(linkargs_size);
-    nfs__link_args__pack(&linkargs, linkargs_buffer);
+    size_t linkargs_size = get_rpc_payload_packed_size(codec, &linkargs.base);
+    uint8_t *linkargs_buffer = allocate_rpc_payload_buffer(linkargs_size);
+    pack_rpc_payload(codec, &linkargs.base, linkargs_buffer);
 
     // Any message to wrap LinkArgs
     Google__Protobuf__Any parameters = GOOGLE__PROTOBUF__ANY__INIT;
@@ -810,15 +960,19 @@ int nfs_procedure_12_create_link_to_file(RpcConnectionContext *rpc_connection_co
     Rpc__RpcMsg *rpc_reply;
     switch (rpc_connection_context->transport_protocol) {
     case TRANSPORT_PROTOCOL_TCP:
+    case TRANSPORT_PROTOCOL_TLS:
         rpc_reply = invoke_rpc_remote_tcp(rpc_connection_context, NFS_RPC_PROGRAM_NUMBER, 2, 12, parameters);
         break;
     case TRANSPORT_PROTOCOL_QUIC:
         rpc_reply = invoke_rpc_remote_quic(rpc_connection_context, NFS_RPC_PROGRAM_NUMBER, 2, 12, parameters, true);
         break;
+    case TRANSPORT_PROTOCOL_SHM:
+        rpc_reply = invoke_rpc_remote_shm(rpc_connection_context, NFS_RPC_PROGRAM_NUMBER, 2, 12, parameters);
+        break;
     default:
         rpc_reply = invoke_rpc_remote_tcp(rpc_connection_context, NFS_RPC_PROGRAM_NUMBER, 2, 12, parameters);
     }
-    free(linkargs_buffer);
+    free_rpc_payload_buffer(linkargs_buffer);
 
     // validate RPC reply
     int error_code = validate_successful_accepted_reply(rpc_reply);
@@ -848,7 +1002,8 @@ int nfs_procedure_12_create_link_to_file(RpcConnectionContext *rpc_connection_co
     }
 
     // now we can unpack the NfsStat from the Any message
-    Nfs__NfsStat *nfsstat = nfs__nfs_stat__unpack(NULL, procedure_results->value.len, procedure_results->value.data);
+    Nfs__NfsStat *nfsstat = unpack_rpc_payload(codec, &nfs__nfs_stat__descriptor, NULL, procedure_results->value.len,
+                                               procedure_results->value.data);
     if (nfsstat == NULL) {
         fprintf(stderr, "NFSPROC_LINK: Failed to unpack Nfs__NfsStat\n");
 
@@ -876,10 +1031,12 @@ int nfs_procedure_12_create_link_to_file(RpcConnectionContext *rpc_connection_co
  */
 int nfs_procedure_13_create_symbolic_link(RpcConnectionContext *rpc_connection_context, Nfs__SymLinkArgs symlinkargs,
                                           Nfs__NfsStat *result) {
+    RpcCodec codec = rpc_connection_context->rpc_codec;
+
     // serialize the SymLinkArgs
-    size_t symlinkargs_size = nfs__sym_link_args__get_packed_size(&symlinkargs);
-    uint8_t *symlinkargs_buffer = malloc(symlinkargs_size);
-    nfs__sym_link_args__pack(&symlinkargs, symlinkargs_buffer);
+    size_t symlinkargs_size = get_rpc_payload_packed_size(codec, &symlinkargs.base);
+    uint8_t *symlinkargs_buffer = allocate_rpc_payload_buffer(symlinkargs_size);
+    pack_rpc_payload(codec, &symlinkargs.base, symlinkargs_buffer);
 
     // Any message to wrap SymLinkArgs
     Google__Protobuf__Any parameters = GOOGLE__PROTOBUF__ANY__INIT;
@@ -891,15 +1048,19 @@ int nfs_procedure_13_create_symbolic_link(RpcConnectionContext *rpc_connection_c
     Rpc__RpcMsg *rpc_reply;
     switch (rpc_connection_context->transport_protocol) {
     case TRANSPORT_PROTOCOL_TCP:
+    case TRANSPORT_PROTOCOL_TLS:
         rpc_reply = invoke_rpc_remote_tcp(rpc_connection_context, NFS_RPC_PROGRAM_NUMBER, 2, 13, parameters);
         break;
     case TRANSPORT_PROTOCOL_QUIC:
         rpc_reply = invoke_rpc_remote_quic(rpc_connection_context, NFS_RPC_PROGRAM_NUMBER, 2, 13, parameters, true);
         break;
+    case TRANSPORT_PROTOCOL_SHM:
+        rpc_reply = invoke_rpc_remote_shm(rpc_connection_context, NFS_RPC_PROGRAM_NUMBER, 2, 13, parameters);
+        break;
     default:
         rpc_reply = invoke_rpc_remote_tcp(rpc_connection_context, NFS_RPC_PROGRAM_NUMBER, 2, 13, parameters);
     }
-    free(symlinkargs_buffer);
+    free_rpc_payload_buffer(symlinkargs_buffer);
 
     // validate RPC reply
     int error_code = validate_successful_accepted_reply(rpc_reply);
@@ -929,7 +1090,8 @@ int nfs_procedure_13_create_symbolic_link(RpcConnectionContext *rpc_connection_c
     }
 
     // now we can unpack the NfsStat from the Any message
-    Nfs__NfsStat *nfsstat = nfs__nfs_stat__unpack(NULL, procedure_results->value.len, procedure_results->value.data);
+    Nfs__NfsStat *nfsstat = unpack_rpc_payload(codec, &nfs__nfs_stat__descriptor, NULL, procedure_results->value.len,
+                                               procedure_results->value.data);
     if (nfsstat == NULL) {
         fprintf(stderr, "NFSPROC_SYMLINK: Failed to unpack Nfs__NfsStat\n");
 
@@ -957,10 +1119,12 @@ int nfs_procedure_13_create_symbolic_link(RpcConnectionContext *rpc_connection_c
  */
 int nfs_procedure_14_create_directory(RpcConnectionContext *rpc_connection_context, Nfs__CreateArgs createargs,
                                       Nfs__DirOpRes *result) {
+    RpcCodec codec = rpc_connection_context->rpc_codec;
+
     // serialize the CreateArgs
-    size_t createargs_size = nfs__create_args__get_packed_size(&createargs);
-    uint8_t *createargs_buffer = malloc(createargs_size);
-    nfs__create_args__pack(&createargs, createargs_buffer);
+    size_t createargs_size = get_rpc_payload_packed_size(codec, &createargs.base);
+    uint8_t *createargs_buffer = allocate_rpc_payload_buffer(createargs_size);
+    pack_rpc_payload(codec, &createargs.base, createargs_buffer);
 
     // Any message to wrap CreateArgs
     Google__Protobuf__Any parameters = GOOGLE__PROTOBUF__ANY__INIT;
@@ -972,15 +1136,19 @@ int nfs_procedure_14_create_directory(RpcConnectionContext *rpc_connection_conte
     Rpc__RpcMsg *rpc_reply;
     switch (rpc_connection_context->transport_protocol) {
     case TRANSPORT_PROTOCOL_TCP:
+    case TRANSPORT_PROTOCOL_TLS:
         rpc_reply = invoke_rpc_remote_tcp(rpc_connection_context, NFS_RPC_PROGRAM_NUMBER, 2, 14, parameters);
         break;
     case TRANSPORT_PROTOCOL_QUIC:
         rpc_reply = invoke_rpc_remote_quic(rpc_connection_context, NFS_RPC_PROGRAM_NUMBER, 2, 14, parameters, true);
         break;
+    case TRANSPORT_PROTOCOL_SHM:
+        rpc_reply = invoke_rpc_remote_shm(rpc_connection_context, NFS_RPC_PROGRAM_NUMBER, 2, 14, parameters);
+        break;
     default:
         rpc_reply = invoke_rpc_remote_tcp(rpc_connection_context, NFS_RPC_PROGRAM_NUMBER, 2, 14, parameters);
     }
-    free(createargs_buffer);
+    free_rpc_payload_buffer(createargs_buffer);
 
     // validate RPC reply
     int error_code = validate_successful_accepted_reply(rpc_reply);
@@ -1010,8 +1178,8 @@ int nfs_procedure_14_create_directory(RpcConnectionContext *rpc_connection_conte
     }
 
     // now we can unpack the DirOpRes from the Any message
-    Nfs__DirOpRes *diropres =
-        nfs__dir_op_res__unpack(NULL, procedure_results->value.len, procedure_results->value.data);
+    Nfs__DirOpRes *diropres = unpack_rpc_payload(codec, &nfs__dir_op_res__descriptor, NULL,
+                                                 procedure_results->value.len, procedure_results->value.data);
     if (diropres == NULL) {
         fprintf(stderr, "NFSPROC_MKDIR: Failed to unpack Nfs__DirOpRes\n");
 
@@ -1039,10 +1207,12 @@ int nfs_procedure_14_create_directory(RpcConnectionContext *rpc_connection_conte
  */
 int nfs_procedure_15_remove_directory(RpcConnectionContext *rpc_connection_context, Nfs__DirOpArgs diropargs,
                                       Nfs__NfsStat *result) {
+    RpcCodec codec = rpc_connection_context->rpc_codec;
+
     // serialize the DirOpArgs
-    size_t diropargs_size = nfs__dir_op_args__get_packed_size(&diropargs);
-    uint8_t *diropargs_buffer = malloc(diropargs_size);
-    nfs__dir_op_args__pack(&diropargs, diropargs_buffer);
+    size_t diropargs_size = get_rpc_payload_packed_size(codec, &diropargs.base);
+    uint8_t *diropargs_buffer = allocate_rpc_payload_buffer(diropargs_size);
+    pack_rpc_payload(codec, &diropargs.base, diropargs_buffer);
 
     // Any message to wrap DirOpArgs
     Google__Protobuf__Any parameters = GOOGLE__PROTOBUF__ANY__INIT;
@@ -1054,15 +1224,19 @@ int nfs_procedure_15_remove_directory(RpcConnectionContext *rpc_connection_conte
     Rpc__RpcMsg *rpc_reply;
     switch (rpc_connection_context->transport_protocol) {
     case TRANSPORT_PROTOCOL_TCP:
+    case TRANSPORT_PROTOCOL_TLS:
         rpc_reply = invoke_rpc_remote_tcp(rpc_connection_context, NFS_RPC_PROGRAM_NUMBER, 2, 15, parameters);
         break;
     case TRANSPORT_PROTOCOL_QUIC:
         rpc_reply = invoke_rpc_remote_quic(rpc_connection_context, NFS_RPC_PROGRAM_NUMBER, 2, 15, parameters, true);
         break;
+    case TRANSPORT_PROTOCOL_SHM:
+        rpc_reply = invoke_rpc_remote_shm(rpc_connection_context, NFS_RPC_PROGRAM_NUMBER, 2, 15, parameters);
+        break;
     default:
         rpc_reply = invoke_rpc_remote_tcp(rpc_connection_context, NFS_RPC_PROGRAM_NUMBER, 2, 15, parameters);
     }
-    free(diropargs_buffer);
+    free_rpc_payload_buffer(diropargs_buffer);
 
     // validate RPC reply
     int error_code = validate_successful_accepted_reply(rpc_reply);
@@ -1092,7 +1266,8 @@ int nfs_procedure_15_remove_directory(RpcConnectionContext *rpc_connection_conte
     }
 
     // now we can unpack the NfsStat from the Any message
-    Nfs__NfsStat *nfs_status = nfs__nfs_stat__unpack(NULL, procedure_results->value.len, procedure_results->value.data);
+    Nfs__NfsStat *nfs_status = unpack_rpc_payload(codec, &nfs__nfs_stat__descriptor, NULL, procedure_results->value.len,
+                                                  procedure_results->value.data);
     if (nfs_status == NULL) {
         fprintf(stderr, "NFSPROC_RMDIR: Failed to unpack Nfs__NfsStat\n");
 
@@ -1120,10 +1295,12 @@ int nfs_procedure_15_remove_directory(RpcConnectionContext *rpc_connection_conte
  */
 int nfs_procedure_16_read_from_directory(RpcConnectionContext *rpc_connection_context, Nfs__ReadDirArgs readdirargs,
                                          Nfs__ReadDirRes *result) {
+    RpcCodec codec = rpc_connection_context->rpc_codec;
+
     // serialize the ReadDirArgs
-    size_t readdirargs_size = nfs__read_dir_args__get_packed_size(&readdirargs);
-    uint8_t *readdirargs_buffer = malloc(readdirargs_size);
-    nfs__read_dir_args__pack(&readdirargs, readdirargs_buffer);
+    size_t readdirargs_size = get_rpc_payload_packed_size(codec, &readdirargs.base);
+    uint8_t *readdirargs_buffer = allocate_rpc_payload_buffer(readdirargs_size);
+    pack_rpc_payload(codec, &readdirargs.base, readdirargs_buffer);
 
     // Any message to wrap ReadDirArgs
     Google__Protobuf__Any parameters = GOOGLE__PROTOBUF__ANY__INIT;
@@ -1135,15 +1312,19 @@ int nfs_procedure_16_read_from_directory(RpcConnectionContext *rpc_connection_co
     Rpc__RpcMsg *rpc_reply;
     switch (rpc_connection_context->transport_protocol) {
     case TRANSPORT_PROTOCOL_TCP:
+    case TRANSPORT_PROTOCOL_TLS:
         rpc_reply = invoke_rpc_remote_tcp(rpc_connection_context, NFS_RPC_PROGRAM_NUMBER, 2, 16, parameters);
         break;
     case TRANSPORT_PROTOCOL_QUIC:
         rpc_reply = invoke_rpc_remote_quic(rpc_connection_context, NFS_RPC_PROGRAM_NUMBER, 2, 16, parameters, true);
         break;
+    case TRANSPORT_PROTOCOL_SHM:
+        rpc_reply = invoke_rpc_remote_shm(rpc_connection_context, NFS_RPC_PROGRAM_NUMBER, 2, 16, parameters);
+        break;
     default:
         rpc_reply = invoke_rpc_remote_tcp(rpc_connection_context, NFS_RPC_PROGRAM_NUMBER, 2, 16, parameters);
     }
-    free(readdirargs_buffer);
+    free_rpc_payload_buffer(readdirargs_buffer);
 
     // validate RPC reply
     int error_code = validate_successful_accepted_reply(rpc_reply);
@@ -1173,8 +1354,8 @@ int nfs_procedure_16_read_from_directory(RpcConnectionContext *rpc_connection_co
     }
 
     // now we can unpack the ReadDirRes from the Any message
-    Nfs__ReadDirRes *readdirres =
-        nfs__read_dir_res__unpack(NULL, procedure_results->value.len, procedure_results->value.data);
+    Nfs__ReadDirRes *readdirres = unpack_rpc_payload(codec, &nfs__read_dir_res__descriptor, NULL,
+                                                     procedure_results->value.len, procedure_results->value.data);
     if (readdirres == NULL) {
         fprintf(stderr, "NFSPROC_READDIR: Failed to unpack Nfs__ReadDirRes\n");
 
@@ -1202,10 +1383,12 @@ int nfs_procedure_16_read_from_directory(RpcConnectionContext *rpc_connection_co
  */
 int nfs_procedure_17_get_filesystem_attributes(RpcConnectionContext *rpc_connection_context, Nfs__FHandle fhandle,
                                                Nfs__StatFsRes *result) {
+    RpcCodec codec = rpc_connection_context->rpc_codec;
+
     // serialize the FHandle
-    size_t fhandle_size = nfs__fhandle__get_packed_size(&fhandle);
-    uint8_t *fhandle_buffer = malloc(fhandle_size);
-    nfs__fhandle__pack(&fhandle, fhandle_buffer);
+    size_t fhandle_size = get_rpc_payload_packed_size(codec, &fhandle.base);
+    uint8_t *fhandle_buffer = allocate_rpc_payload_buffer(fhandle_size);
+    pack_rpc_payload(codec, &fhandle.base, fhandle_buffer);
 
     // Any message to wrap FHandle
     Google__Protobuf__Any parameters = GOOGLE__PROTOBUF__ANY__INIT;
@@ -1217,15 +1400,19 @@ int nfs_procedure_17_get_filesystem_attributes(RpcConnectionContext *rpc_connect
     Rpc__RpcMsg *rpc_reply;
     switch (rpc_connection_context->transport_protocol) {
     case TRANSPORT_PROTOCOL_TCP:
+    case TRANSPORT_PROTOCOL_TLS:
         rpc_reply = invoke_rpc_remote_tcp(rpc_connection_context, NFS_RPC_PROGRAM_NUMBER, 2, 17, parameters);
         break;
     case TRANSPORT_PROTOCOL_QUIC:
         rpc_reply = invoke_rpc_remote_quic(rpc_connection_context, NFS_RPC_PROGRAM_NUMBER, 2, 17, parameters, true);
         break;
+    case TRANSPORT_PROTOCOL_SHM:
+        rpc_reply = invoke_rpc_remote_shm(rpc_connection_context, NFS_RPC_PROGRAM_NUMBER, 2, 17, parameters);
+        break;
     default:
         rpc_reply = invoke_rpc_remote_tcp(rpc_connection_context, NFS_RPC_PROGRAM_NUMBER, 2, 17, parameters);
     }
-    free(fhandle_buffer);
+    free_rpc_payload_buffer(fhandle_buffer);
 
     // validate RPC reply
     int error_code = validate_successful_accepted_reply(rpc_reply);
@@ -1255,8 +1442,8 @@ int nfs_procedure_17_get_filesystem_attributes(RpcConnectionContext *rpc_connect
     }
 
     // now we can unpack the StatFsRes from the Any message
-    Nfs__StatFsRes *statfsres =
-        nfs__stat_fs_res__unpack(NULL, procedure_results->value.len, procedure_results->value.data);
+    Nfs__StatFsRes *statfsres = unpack_rpc_payload(codec, &nfs__stat_fs_res__descriptor, NULL,
+                                                   procedure_results->value.len, procedure_results->value.data);
     if (statfsres == NULL) {
         fprintf(stderr, "NFSPROC_STATFS: Failed to unpack Nfs__StatFsRes\n");
 
@@ -1269,5 +1456,336 @@ int nfs_procedure_17_get_filesystem_attributes(RpcConnectionContext *rpc_connect
 
     rpc__rpc_msg__free_unpacked(rpc_reply, NULL);
 
+    return 0;
+}
+/*
+ * Calls the NFSPROC_COMPOUND Nfs procedure, an extension to RFC 1094.
+ * On successful run, returns 0 and places procedure result in 'result'.
+ * On unsuccessful run, returns error code > 0 if validation of the RPC message failed - this is
+ * the validation error code, and returns error code < 0 if validation of procedure results (type checking
+ * and deserialization) failed.
+ *
+ * In case this function returns 0, the user of this function takes responsibility
+ * to call nfs__compound_res__free_unpacked(compoundres, NULL) on the received Nfs__CompoundRes eventually.
+ */
+int nfs_procedure_18_compound(RpcConnectionContext *rpc_connection_context, Nfs__CompoundArgs compoundargs,
+                              Nfs__CompoundRes *result) {
+    RpcCodec codec = rpc_connection_context->rpc_codec;
+
+    // serialize the CompoundArgs
+    size_t compoundargs_size = get_rpc_payload_packed_size(codec, &compoundargs.base);
+    uint8_t *compoundargs_buffer = allocate_rpc_payload_buffer(compoundargs_size);
+    pack_rpc_payload(codec, &compoundargs.base, compoundargs_buffer);
+
+    // Any message to wrap CompoundArgs
+    Google__Protobuf__Any parameters = GOOGLE__PROTOBUF__ANY__INIT;
+    parameters.type_url = "nfs/CompoundArgs";
+    parameters.value.data = compoundargs_buffer;
+    parameters.value.len = compoundargs_size;
+
+    // send RPC call over the desired transport protocol
+    Rpc__RpcMsg *rpc_reply;
+    switch (rpc_connection_context->transport_protocol) {
+    case TRANSPORT_PROTOCOL_TCP:
+    case TRANSPORT_PROTOCOL_TLS:
+        rpc_reply = invoke_rpc_remote_tcp(rpc_connection_context, NFS_RPC_PROGRAM_NUMBER, 2, 18, parameters);
+        break;
+    case TRANSPORT_PROTOCOL_QUIC:
+        rpc_reply = invoke_rpc_remote_quic(rpc_connection_context, NFS_RPC_PROGRAM_NUMBER, 2, 18, parameters, true);
+        break;
+    case TRANSPORT_PROTOCOL_SHM:
+        rpc_reply = invoke_rpc_remote_shm(rpc_connection_context, NFS_RPC_PROGRAM_NUMBER, 2, 18, parameters);
+        break;
+    default:
+        rpc_reply = invoke_rpc_remote_tcp(rpc_connection_context, NFS_RPC_PROGRAM_NUMBER, 2, 18, parameters);
+    }
+    free_rpc_payload_buffer(compoundargs_buffer);
+
+    // validate RPC reply
+    int error_code = validate_successful_accepted_reply(rpc_reply);
+    if (error_code > 0) {
+        rpc__rpc_msg__free_unpacked(rpc_reply, NULL);
+        return error_code;
+    }
+
+    log_rpc_msg_info(rpc_reply);
+
+    // extract procedure results
+    Rpc__AcceptedReply *accepted_reply = (rpc_reply->rbody)->areply;
+    Google__Protobuf__Any *procedure_results = accepted_reply->results;
+    if (procedure_results == NULL) {
+        fprintf(stderr, "NFSPROC_COMPOUND: procedure_results is NULL - This shouldn't happen, 'validated_rpc_reply' "
+                        "checked that procedure_results is not NULL\n");
+        rpc__rpc_msg__free_unpacked(rpc_reply, NULL);
+        return -1;
+    }
+
+    // check that procedure results contain the right type
+    if (procedure_results->type_url == NULL || strcmp(procedure_results->type_url, "nfs/CompoundRes") != 0) {
+        fprintf(stderr, "NFSPROC_COMPOUND: Expected nfs/CompoundRes but received %s\n", procedure_results->type_url);
+
+        rpc__rpc_msg__free_unpacked(rpc_reply, NULL);
+        return -2;
+    }
+
+    // now we can unpack the CompoundRes from the Any message
+    Nfs__CompoundRes *compoundres = unpack_rpc_payload(codec, &nfs__compound_res__descriptor, NULL,
+                                                       procedure_results->value.len, procedure_results->value.data);
+    if (compoundres == NULL) {
+        fprintf(stderr, "NFSPROC_COMPOUND: Failed to unpack Nfs__CompoundRes\n");
+
+        rpc__rpc_msg__free_unpacked(rpc_reply, NULL);
+        return -3;
+    }
+
+    // place CompoundRes into the result
+    *result = *compoundres;
+
+    rpc__rpc_msg__free_unpacked(rpc_reply, NULL);
+
+    return 0;
+}
+
+/*
+ * Calls the NFSPROC_READDIRPLUS Nfs procedure.
+ * On successful run, returns 0 and places procedure result in 'result'.
+ * On unsuccessful run, returns error code > 0 if validation of the RPC message failed - this is
+ * the validation error code, and returns error code < 0 if validation of procedure results (type checking
+ * and deserialization) failed.
+ *
+ * In case this function returns 0, the user of this function takes responsibility
+ * to call nfs__read_dir_plus_res__free_unpacked(readdirplusres, NULL) on the received Nfs__ReadDirPlusRes
+ * eventually.
+ */
+int nfs_procedure_19_read_from_directory_plus(RpcConnectionContext *rpc_connection_context,
+                                              Nfs__ReadDirArgs readdirargs, Nfs__ReadDirPlusRes *result) {
+    RpcCodec codec = rpc_connection_context->rpc_codec;
+
+    // serialize the ReadDirArgs
+    size_t readdirargs_size = get_rpc_payload_packed_size(codec, &readdirargs.base);
+    uint8_t *readdirargs_buffer = allocate_rpc_payload_buffer(readdirargs_size);
+    pack_rpc_payload(codec, &readdirargs.base, readdirargs_buffer);
+
+    // Any message to wrap ReadDirArgs
+    Google__Protobuf__Any parameters = GOOGLE__PROTOBUF__ANY__INIT;
+    parameters.type_url = "nfs/ReadDirArgs";
+    parameters.value.data = readdirargs_buffer;
+    parameters.value.len = readdirargs_size;
+
+    // send RPC call over the desired transport protocol
+    Rpc__RpcMsg *rpc_reply;
+    switch (rpc_connection_context->transport_protocol) {
+    case TRANSPORT_PROTOCOL_TCP:
+    case TRANSPORT_PROTOCOL_TLS:
+        rpc_reply = invoke_rpc_remote_tcp(rpc_connection_context, NFS_RPC_PROGRAM_NUMBER, 2, 19, parameters);
+        break;
+    case TRANSPORT_PROTOCOL_QUIC:
+        rpc_reply = invoke_rpc_remote_quic(rpc_connection_context, NFS_RPC_PROGRAM_NUMBER, 2, 19, parameters, true);
+        break;
+    case TRANSPORT_PROTOCOL_SHM:
+        rpc_reply = invoke_rpc_remote_shm(rpc_connection_context, NFS_RPC_PROGRAM_NUMBER, 2, 19, parameters);
+        break;
+    default:
+        rpc_reply = invoke_rpc_remote_tcp(rpc_connection_context, NFS_RPC_PROGRAM_NUMBER, 2, 19, parameters);
+    }
+    free_rpc_payload_buffer(readdirargs_buffer);
+
+    // validate RPC reply
+    int error_code = validate_successful_accepted_reply(rpc_reply);
+    if (error_code > 0) {
+        rpc__rpc_msg__free_unpacked(rpc_reply, NULL);
+        return error_code;
+    }
+
+    log_rpc_msg_info(rpc_reply);
+
+    // extract procedure results
+    Rpc__AcceptedReply *accepted_reply = (rpc_reply->rbody)->areply;
+    Google__Protobuf__Any *procedure_results = accepted_reply->results;
+    if (procedure_results == NULL) {
+        fprintf(stderr, "NFSPROC_READDIRPLUS: procedure_results is NULL - This shouldn't happen, 'validated_rpc_reply' "
+                        "checked that procedure_results is not NULL\n");
+        rpc__rpc_msg__free_unpacked(rpc_reply, NULL);
+        return -1;
+    }
+
+    // check that procedure results contain the right type
+    if (procedure_results->type_url == NULL || strcmp(procedure_results->type_url, "nfs/ReadDirPlusRes") != 0) {
+        fprintf(stderr, "NFSPROC_READDIRPLUS: Expected nfs/ReadDirPlusRes but received %s\n",
+                procedure_results->type_url);
+
+        rpc__rpc_msg__free_unpacked(rpc_reply, NULL);
+        return -2;
+    }
+
+    // now we can unpack the ReadDirPlusRes from the Any message
+    Nfs__ReadDirPlusRes *readdirplusres = unpack_rpc_payload(codec, &nfs__read_dir_plus_res__descriptor, NULL,
+                                                             procedure_results->value.len,
+                                                             procedure_results->value.data);
+    if (readdirplusres == NULL) {
+        fprintf(stderr, "NFSPROC_READDIRPLUS: Failed to unpack Nfs__ReadDirPlusRes\n");
+
+        rpc__rpc_msg__free_unpacked(rpc_reply, NULL);
+        return -3;
+    }
+
+    // place readdirplusres into the result
+    *result = *readdirplusres;
+
+    rpc__rpc_msg__free_unpacked(rpc_reply, NULL);
+
+    return 0;
+}
+
+/*
+ * Calls the NFSPROC_READDIR2 Nfs procedure.
+ * On successful run, returns 0 and places procedure result in 'result'.
+ * On unsuccessful run, returns error code > 0 if validation of the RPC message failed - this is
+ * the validation error code, and returns error code < 0 if validation of procedure results (type checking
+ * and deserialization) failed. Servers that predate READDIR2 make this return RPC_PROC_UNAVAIL_ERROR_CODE, after
+ * which the caller should read directories with READDIR instead.
+ *
+ * In case this function returns 0, the user of this function takes responsibility
+ * to call nfs__read_dir2_res__free_unpacked(readdir2res, NULL) on the received Nfs__ReadDir2Res
+ * eventually.
+ */
+int nfs_procedure_20_read_from_directory_2(RpcConnectionContext *rpc_connection_context, Nfs__ReadDirArgs readdirargs,
+                                           Nfs__ReadDir2Res *result) {
+    RpcCodec codec = rpc_connection_context->rpc_codec;
+
+    // serialize the ReadDirArgs
+    size_t readdirargs_size = get_rpc_payload_packed_size(codec, &readdirargs.base);
+    uint8_t *readdirargs_buffer = allocate_rpc_payload_buffer(readdirargs_size);
+    pack_rpc_payload(codec, &readdirargs.base, readdirargs_buffer);
+
+    // Any message to wrap ReadDirArgs
+    Google__Protobuf__Any parameters = GOOGLE__PROTOBUF__ANY__INIT;
+    parameters.type_url = "nfs/ReadDirArgs";
+    parameters.value.data = readdirargs_buffer;
+    parameters.value.len = readdirargs_size;
+
+    // send RPC call over the desired transport protocol
+    Rpc__RpcMsg *rpc_reply;
+    switch (rpc_connection_context->transport_protocol) {
+    case TRANSPORT_PROTOCOL_TCP:
+    case TRANSPORT_PROTOCOL_TLS:
+        rpc_reply = invoke_rpc_remote_tcp(rpc_connection_context, NFS_RPC_PROGRAM_NUMBER, 2, 20, parameters);
+        break;
+    case TRANSPORT_PROTOCOL_QUIC:
+        rpc_reply = invoke_rpc_remote_quic(rpc_connection_context, NFS_RPC_PROGRAM_NUMBER, 2, 20, parameters, true);
+        break;
+    case TRANSPORT_PROTOCOL_SHM:
+        rpc_reply = invoke_rpc_remote_shm(rpc_connection_context, NFS_RPC_PROGRAM_NUMBER, 2, 20, parameters);
+        break;
+    default:
+        rpc_reply = invoke_rpc_remote_tcp(rpc_connection_context, NFS_RPC_PROGRAM_NUMBER, 2, 20, parameters);
+    }
+    free_rpc_payload_buffer(readdirargs_buffer);
+
+    // validate RPC reply
+    int error_code = validate_successful_accepted_reply(rpc_reply);
+    if (error_code > 0) {
+        rpc__rpc_msg__free_unpacked(rpc_reply, NULL);
+        return error_code;
+    }
+
+    log_rpc_msg_info(rpc_reply);
+
+    // extract procedure results
+    Rpc__AcceptedReply *accepted_reply = (rpc_reply->rbody)->areply;
+    Google__Protobuf__Any *procedure_results = accepted_reply->results;
+    if (procedure_results == NULL) {
+        fprintf(stderr, "NFSPROC_READDIR2: procedure_results is NULL - This shouldn't happen, 'validated_rpc_reply' "
+                        "checked that procedure_results is not NULL\n");
+        rpc__rpc_msg__free_unpacked(rpc_reply, NULL);
+        return -1;
+    }
+
+    // check that procedure results contain the right type
+    if (procedure_results->type_url == NULL || strcmp(procedure_results->type_url, "nfs/ReadDir2Res") != 0) {
+        fprintf(stderr, "NFSPROC_READDIR2: Expected nfs/ReadDir2Res but received %s\n", procedure_results->type_url);
+
+        rpc__rpc_msg__free_unpacked(rpc_reply, NULL);
+        return -2;
+    }
+
+    // now we can unpack the ReadDir2Res from the Any message
+    Nfs__ReadDir2Res *readdir2res = unpack_rpc_payload(codec, &nfs__read_dir2_res__descriptor, NULL,
+                                                       procedure_results->value.len, procedure_results->value.data);
+    if (readdir2res == NULL) {
+        fprintf(stderr, "NFSPROC_READDIR2: Failed to unpack Nfs__ReadDir2Res\n");
+
+        rpc__rpc_msg__free_unpacked(rpc_reply, NULL);
+        return -3;
+    }
+
+    // place readdir2res into the result
+    *result = *readdir2res;
+
+    rpc__rpc_msg__free_unpacked(rpc_reply, NULL);
+
+    return 0;
+}
+
+/*
+ * Asks the server for its transfer size and the compressions it supports with the NFSPROC_STATFS Nfs procedure, on
+ * the filesystem of the given directory, and saves in the given RpcConnectionContext the number of bytes its READs,
+ * WRITEs and READDIRs should move at most, and the compression the data of its READs and WRITEs is sent with.
+ *
+ * The advertised transfer size is limited to between NFS_MAXDATA, which every server accepts, and
+ * NFS_MAX_TRANSFER_SIZE. The compression is picked from the round trip time of the STATFS call (see
+ * 'choose_rpc_compression'), and is none over shared memory, where copying the data costs less than compressing it,
+ * and with the XDR codec, which has no room for it. If the server can't be asked, the transfer size stays NFS_MAXDATA
+ * and nothing is compressed.
+ *
+ * Returns 0 on success and > 0 on failure.
+ */
+int negotiate_transfer_parameters(RpcConnectionContext *rpc_connection_context, Nfs__FHandle directory_fhandle) {
+    if (rpc_connection_context == NULL) {
+        return 1;
+    }
+
+    Nfs__StatFsRes *statfsres = malloc(sizeof(Nfs__StatFsRes));
+    if (statfsres == NULL) {
+        return 2;
+    }
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    int status = nfs_procedure_17_get_filesystem_attributes(rpc_connection_context, directory_fhandle, statfsres);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    if (status != 0) {
+        fprintf(stderr, "negotiate_transfer_parameters: STATFS failed with status %d\n", status);
+
+        free(statfsres);
+        return 3;
+    }
+
+    if (statfsres->nfs_status == NULL || statfsres->nfs_status->stat != NFS__STAT__NFS_OK ||
+        statfsres->body_case != NFS__STAT_FS_RES__BODY_FS_INFO || statfsres->fs_info == NULL) {
+        fprintf(stderr, "negotiate_transfer_parameters: STATFS did not return the attributes of the filesystem\n");
+
+        nfs__stat_fs_res__free_unpacked(statfsres, NULL);
+        return 4;
+    }
+
+    uint32_t transfer_size = statfsres->fs_info->tsize;
+    if (transfer_size < NFS_MAXDATA) {
+        transfer_size = NFS_MAXDATA;
+    }
+    if (transfer_size > NFS_MAX_TRANSFER_SIZE) {
+        transfer_size = NFS_MAX_TRANSFER_SIZE;
+    }
+    rpc_connection_context->transfer_size = transfer_size;
+
+    if (rpc_connection_context->transport_protocol != TRANSPORT_PROTOCOL_SHM &&
+        rpc_connection_context->rpc_codec == RPC_CODEC_PROTOBUF) {
+        uint64_t round_trip_time = (end.tv_sec - start.tv_sec) * 1000000 + (end.tv_nsec - start.tv_nsec) / 1000;
+        rpc_connection_context->payload_compression =
+            choose_rpc_compression(statfsres->fs_info->compression_algorithms, round_trip_time);
+    }
+
+    nfs__stat_fs_res__free_unpacked(statfsres, NULL);
+
     return 0;
 }
\ No newline at end of file
@@ -10,6 +10,7 @@
 #include "src/common_rpc/rpc_connection_context.h"
 
 #include "src/transport/quic/quic_rpc_client.h"
+#include "src/transport/shm/shm_rpc_client.h"
 #include "src/transport/tcp/tcp_rpc_client.h"
 
 #include "../nfs_common.h"
@@ -70,4 +71,15 @@ int nfs_procedure_16_read_from_directory(RpcConnectionContext *rpc_connection_co
 int nfs_procedure_17_get_filesystem_attributes(RpcConnectionContext *rpc_connection_context, Nfs__FHandle fhandle,
                                                Nfs__StatFsRes *result);
 
+int nfs_procedure_18_compound(RpcConnectionContext *rpc_connection_context, Nfs__CompoundArgs compoundargs,
+                              Nfs__CompoundRes *result);
+
+int nfs_procedure_19_read_from_directory_plus(RpcConnectionContext *rpc_connection_context,
+                                              Nfs__ReadDirArgs readdirargs, Nfs__ReadDirPlusRes *result);
+
+int nfs_procedure_20_read_from_directory_2(RpcConnectionContext *rpc_connection_context, Nfs__ReadDirArgs readdirargs,
+                                           Nfs__ReadDir2Res *result);
+
+int negotiate_transfer_parameters(RpcConnectionContext *rpc_connection_context, Nfs__FHandle directory_fhandle);
+
 #endif /* nfs_client__header__INCLUDED */
\ No newline at end of file
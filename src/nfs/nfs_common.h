@@ -7,10 +7,59 @@
 #define NFS_RPC_PROGRAM_NUMBER 10003
 #define MOUNT_RPC_PROGRAM_NUMBER 10005
 
+/*
+ * Procedures of the Mount RPC program.
+ */
+#define MOUNTPROC_NULL 0
+#define MOUNTPROC_MNT 1
+#define MOUNTPROC_DUMP 2
+#define MOUNTPROC_UMNT 3
+#define MOUNTPROC_UMNTALL 4
+#define MOUNTPROC_EXPORT 5
+
+/*
+ * Procedures of the Nfs RPC program - NFSPROC_ROOT and NFSPROC_WRITECACHE are obsolete, and NFSPROC_COMPOUND,
+ * NFSPROC_READDIRPLUS and NFSPROC_READDIR2 are extensions to RFC 1094.
+ */
+#define NFSPROC_NULL 0
+#define NFSPROC_GETATTR 1
+#define NFSPROC_SETATTR 2
+#define NFSPROC_ROOT 3
+#define NFSPROC_LOOKUP 4
+#define NFSPROC_READLINK 5
+#define NFSPROC_READ 6
+#define NFSPROC_WRITECACHE 7
+#define NFSPROC_WRITE 8
+#define NFSPROC_CREATE 9
+#define NFSPROC_REMOVE 10
+#define NFSPROC_RENAME 11
+#define NFSPROC_LINK 12
+#define NFSPROC_SYMLINK 13
+#define NFSPROC_MKDIR 14
+#define NFSPROC_RMDIR 15
+#define NFSPROC_READDIR 16
+#define NFSPROC_STATFS 17
+#define NFSPROC_COMPOUND 18
+#define NFSPROC_READDIRPLUS 19
+#define NFSPROC_READDIR2 20
+
 #define NFS_MAXDATA 8192    // max number of bytes of data in a read/write request
 #define NFS_MAXPATHLEN 1024 // max number of bytes in a pathname (Path protobuf message)
 #define NFS_MAXNAMLEN 255   // max number of bytes in a file name (FileName protobuf message)
 #define NFS_COOKIESIZE 4    // size in bytes of the opaque cookie passed by READDIR procedure
 #define NFS_FHSIZE 32       // size in bytes of the nfs filehandle
 
+/*
+ * Largest number of bytes of data the server moves in a single READ or WRITE, and of directory entries in a single
+ * READDIR2, advertised to clients as the 'tsize' in the results of STATFS. This goes beyond the NFS_MAXDATA of RFC
+ * 1094, so clients only make transfers this large once STATFS has told them the server supports them.
+ */
+#define NFS_MAX_TRANSFER_SIZE (1024 * 1024)
+
+/*
+ * NFSPROC_COMPOUND is an extension to RFC 1094 - enough operations to look up every component of the longest
+ * pathname, and then run one more procedure on the file found.
+ */
+#define NFS_MAX_COMPOUND_OPERATIONS (NFS_MAXPATHLEN / 2 + 1)
+
 #endif /* nfs_common__header__INCLUDED */
\ No newline at end of file
@@ -0,0 +1,127 @@
+#include "attributes_cache.h"
+
+#include <string.h>
+
+#include "src/common_rpc/rpc_msg_encoding.h"
+
+static void get_attributes_cache_key(const struct stat *file_stat, AttributesCacheKey *key) {
+    // zeroed first, so that keys can be compared with memcmp() despite padding
+    memset(key, 0, sizeof(AttributesCacheKey));
+
+    key->inode_number = file_stat->st_ino;
+    key->device = file_stat->st_dev;
+    key->ctime = file_stat->st_ctim;
+
+    key->atime = file_stat->st_atim;
+    key->mtime = file_stat->st_mtim;
+    key->mode = file_stat->st_mode;
+    key->nlink = file_stat->st_nlink;
+    key->uid = file_stat->st_uid;
+    key->gid = file_stat->st_gid;
+    key->size = file_stat->st_size;
+    key->blocksize = file_stat->st_blksize;
+    key->rdev = file_stat->st_rdev;
+    key->blocks = file_stat->st_blocks;
+}
+
+static AttributesCacheSlot *get_attributes_cache_slot(AttributesCache *attributes_cache, ino_t inode_number) {
+    return &attributes_cache->slots[inode_number % ATTRIBUTES_CACHE_NUM_SLOTS];
+}
+
+static pthread_mutex_t *get_attributes_cache_lock(AttributesCache *attributes_cache, ino_t inode_number) {
+    // derived from the index of the slot, so that a slot is always guarded by the same lock
+    return &attributes_cache->locks[(inode_number % ATTRIBUTES_CACHE_NUM_SLOTS) % ATTRIBUTES_CACHE_NUM_LOCKS];
+}
+
+void init_attributes_cache(AttributesCache *attributes_cache) {
+    for (size_t i = 0; i < ATTRIBUTES_CACHE_NUM_LOCKS; i++) {
+        pthread_mutex_init(&attributes_cache->locks[i], NULL);
+    }
+    for (size_t i = 0; i < ATTRIBUTES_CACHE_NUM_SLOTS; i++) {
+        attributes_cache->slots[i].valid = false;
+    }
+}
+
+/*
+ * Looks up the packed AttrStat results, in the given codec, of the file with the given stats, and if they are cached,
+ * places a copy of them in a buffer allocated with 'allocate_rpc_payload_buffer' in 'attr_stat_buffer', and their
+ * size in 'attr_stat_size'.
+ *
+ * Returns 0 if the results were cached and 1 if they weren't (or couldn't be copied).
+ *
+ * The user of this function takes the responsibility to free the 'attr_stat_buffer' with 'free_rpc_payload_buffer',
+ * or to hand it over to 'wrap_procedure_results_in_successful_accepted_reply'.
+ */
+int get_cached_attr_stat(AttributesCache *attributes_cache, RpcCodec codec, const struct stat *file_stat,
+                         uint8_t **attr_stat_buffer, size_t *attr_stat_size) {
+    AttributesCacheKey key;
+    get_attributes_cache_key(file_stat, &key);
+
+    pthread_mutex_t *lock = get_attributes_cache_lock(attributes_cache, key.inode_number);
+    pthread_mutex_lock(lock);
+
+    AttributesCacheSlot *slot = get_attributes_cache_slot(attributes_cache, key.inode_number);
+    if (!slot->valid || slot->codec != codec || memcmp(&slot->key, &key, sizeof(AttributesCacheKey)) != 0) {
+        pthread_mutex_unlock(lock);
+        return 1;
+    }
+
+    uint8_t *buffer = allocate_rpc_payload_buffer(slot->results_size);
+    if (buffer == NULL) {
+        pthread_mutex_unlock(lock);
+        return 1;
+    }
+    memcpy(buffer, slot->results, slot->results_size);
+    *attr_stat_buffer = buffer;
+    *attr_stat_size = slot->results_size;
+
+    pthread_mutex_unlock(lock);
+
+    return 0;
+}
+
+/*
+ * Caches the given packed AttrStat results, in the given codec, of the file with the given stats, in place of any
+ * results cached in the same slot.
+ *
+ * Does nothing if the results are larger than ATTRIBUTES_CACHE_MAX_RESULTS_SIZE.
+ */
+void add_cached_attr_stat(AttributesCache *attributes_cache, RpcCodec codec, const struct stat *file_stat,
+                          const uint8_t *attr_stat_buffer, size_t attr_stat_size) {
+    if (attr_stat_size > ATTRIBUTES_CACHE_MAX_RESULTS_SIZE) {
+        return;
+    }
+
+    AttributesCacheKey key;
+    get_attributes_cache_key(file_stat, &key);
+
+    pthread_mutex_t *lock = get_attributes_cache_lock(attributes_cache, key.inode_number);
+    pthread_mutex_lock(lock);
+
+    AttributesCacheSlot *slot = get_attributes_cache_slot(attributes_cache, key.inode_number);
+    slot->valid = true;
+    memcpy(&slot->key, &key, sizeof(AttributesCacheKey)); // padding included
+    slot->codec = codec;
+    memcpy(slot->results, attr_stat_buffer, attr_stat_size);
+    slot->results_size = attr_stat_size;
+
+    pthread_mutex_unlock(lock);
+}
+
+/*
+ * Drops the cached results of the file with the given inode number, if there are any.
+ *
+ * Procedures call this before they change a file or a directory. Results cached by a GETATTR that runs between the
+ * invalidation and the change carry the stats from before the change in their key, so they are missed afterwards.
+ */
+void invalidate_cached_attr_stat(AttributesCache *attributes_cache, ino_t inode_number) {
+    pthread_mutex_t *lock = get_attributes_cache_lock(attributes_cache, inode_number);
+    pthread_mutex_lock(lock);
+
+    AttributesCacheSlot *slot = get_attributes_cache_slot(attributes_cache, inode_number);
+    if (slot->valid && slot->key.inode_number == inode_number) {
+        slot->valid = false;
+    }
+
+    pthread_mutex_unlock(lock);
+}
@@ -0,0 +1,75 @@
+#ifndef attributes_cache__header__INCLUDED
+#define attributes_cache__header__INCLUDED
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include "src/common_rpc/rpc_codec.h"
+
+#define ATTRIBUTES_CACHE_NUM_SLOTS 1024
+
+// slots are guarded by striped locks, so that server threads looking at different files rarely wait for each other
+#define ATTRIBUTES_CACHE_NUM_LOCKS 64
+
+// packed AttrStat results larger than this aren't cached (they take about 150 bytes in protobuf and 72 in XDR)
+#define ATTRIBUTES_CACHE_MAX_RESULTS_SIZE 256
+
+/*
+ * The parts of the stats of a file that end up in its attributes (FAttr).
+ */
+typedef struct AttributesCacheKey {
+    ino_t inode_number;
+    dev_t device;
+    struct timespec ctime;
+
+    // changed without touching ctime - atime by reads, and the rest only within a single ctime tick
+    struct timespec atime;
+    struct timespec mtime;
+    mode_t mode;
+    nlink_t nlink;
+    uid_t uid;
+    gid_t gid;
+    off_t size;
+    blksize_t blocksize;
+    dev_t rdev;
+    blkcnt_t blocks;
+} AttributesCacheKey;
+
+typedef struct AttributesCacheSlot {
+    bool valid;
+    AttributesCacheKey key;
+    RpcCodec codec;
+
+    size_t results_size;
+    uint8_t results[ATTRIBUTES_CACHE_MAX_RESULTS_SIZE];
+} AttributesCacheSlot;
+
+/*
+ * Successful GETATTR results (AttrStat), packed, of recently looked at files. A file takes over the slot of any other
+ * file whose inode number maps to the same slot.
+ *
+ * Results are keyed by the inode number and ctime of the file, along with the rest of its stats that go into its
+ * attributes, so a file whose stats have changed in any way since its results were packed misses the cache. On top
+ * of that, procedures that change a file or a directory invalidate its results before changing it, so the server
+ * doesn't depend on the granularity of file timestamps for its own changes.
+ */
+typedef struct AttributesCache {
+    pthread_mutex_t locks[ATTRIBUTES_CACHE_NUM_LOCKS];
+    AttributesCacheSlot slots[ATTRIBUTES_CACHE_NUM_SLOTS];
+} AttributesCache;
+
+void init_attributes_cache(AttributesCache *attributes_cache);
+
+int get_cached_attr_stat(AttributesCache *attributes_cache, RpcCodec codec, const struct stat *file_stat,
+                         uint8_t **attr_stat_buffer, size_t *attr_stat_size);
+
+void add_cached_attr_stat(AttributesCache *attributes_cache, RpcCodec codec, const struct stat *file_stat,
+                          const uint8_t *attr_stat_buffer, size_t attr_stat_size);
+
+void invalidate_cached_attr_stat(AttributesCache *attributes_cache, ino_t inode_number);
+
+#endif /* attributes_cache__header__INCLUDED */
@@ -1,6 +1,7 @@
 #include "directory_reading.h"
 
 #include <errno.h>
+#include <fcntl.h>
 #include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -8,9 +9,17 @@
 #include <time.h>
 
 #include "src/error_handling/error_handling.h"
+#include "src/path_building/path_building.h"
 
 #define READDIR_SESSION_TIMEOUT 30 // a ReadDir session expires after not being touched for this many seconds
 
+// largest size the fileid, cookie and name offset of a READDIR2 entry take together - packed varints of 10, 10 and 5
+// bytes in protobuf, or 8, 8 and 4 bytes in XDR
+#define READDIR2_MAX_ENTRY_OVERHEAD 25
+
+#define READDIR2_INITIAL_NUM_ENTRIES 64 // entries the arrays of a READDIR2 result have room for at first
+#define READDIR2_INITIAL_NAMES_SIZE 2048 // bytes the names of a READDIR2 result have room for at first
+
 pthread_mutex_t readdir_sessions_mutex =
     PTHREAD_MUTEX_INITIALIZER; // mutex for protecting concurrent access to any ReadDirSessionsList
 
@@ -408,16 +417,111 @@ void clean_up_directory_entries_list(Nfs__DirectoryEntriesList *directory_entrie
     while (directory_entries_list_head != NULL) {
         Nfs__DirectoryEntriesList *next = directory_entries_list_head->nextentry;
 
-        free(directory_entries_list_head->name->filename);
-        free(directory_entries_list_head->name);
-        free(directory_entries_list_head->cookie);
+        rpc_arena_free(directory_entries_list_head->name->filename);
+        rpc_arena_free(directory_entries_list_head->name);
+        rpc_arena_free(directory_entries_list_head->cookie);
 
-        free(directory_entries_list_head);
+        rpc_arena_free(directory_entries_list_head);
 
         directory_entries_list_head = next;
     }
 }
 
+/*
+ * Deallocates the given list of READDIRPLUS directory entries, built by 'read_from_directory_plus'. The NFS filehandles
+ * in the entries belong to the inode cache and are not freed.
+ */
+void clean_up_directory_entries_plus_list(Nfs__DirectoryEntriesPlusList *directory_entries_list_head) {
+    while (directory_entries_list_head != NULL) {
+        Nfs__DirectoryEntriesPlusList *next = directory_entries_list_head->nextentry;
+
+        rpc_arena_free(directory_entries_list_head->name->filename);
+        rpc_arena_free(directory_entries_list_head->name);
+        rpc_arena_free(directory_entries_list_head->cookie);
+        rpc_arena_free(directory_entries_list_head->file);
+        clean_up_fattr(directory_entries_list_head->attributes);
+        rpc_arena_free(directory_entries_list_head->attributes);
+
+        rpc_arena_free(directory_entries_list_head);
+
+        directory_entries_list_head = next;
+    }
+}
+
+/*
+ * Fetches the ReadDir session for the given client and directory (or creates a new one if no such session is
+ * currently active) from the given collection of active ReadDir sessions, positions its directory stream at the
+ * given cookie, and places the session in 'readdir_session'.
+ *
+ * Must be called with the 'readdir_sessions_mutex' held.
+ *
+ * Returns 0 on success and > 0 on failure.
+ */
+static int seek_readdir_session(Rpc__AuthSysParams *client_authsysparams, char *directory_absolute_path,
+                                ino_t directory_inode_number, ReadDirSessionsList **active_readdir_sessions,
+                                long offset_cookie, ReadDirSession **readdir_session) {
+    if (find_readdir_session(client_authsysparams, directory_inode_number, *active_readdir_sessions) != 0) {
+        // there is no active ReadDir session for this client and directory, so create one
+        int error_code = add_new_readdir_session(client_authsysparams, directory_absolute_path, directory_inode_number,
+                                                 active_readdir_sessions);
+        if (error_code > 0) {
+            fprintf(stderr, "seek_readdir_session: failed to create a new ReadDir session\n");
+
+            return 3;
+        }
+    }
+
+    // get the ReadDir session for this client and directory
+    *readdir_session = get_readdir_session(client_authsysparams, directory_inode_number, *active_readdir_sessions);
+    if (*readdir_session == NULL) {
+        fprintf(stderr, "seek_readdir_session: ReadDir session for client %s:%d:%d and directory %s not found\n",
+                client_authsysparams->machinename, client_authsysparams->uid, client_authsysparams->gid,
+                directory_absolute_path);
+
+        return 4;
+    }
+
+    // 0 is a special cookie value meaning client wants to start from beginning of directory stream
+    if (offset_cookie == 0) {
+        rewinddir((*readdir_session)->directory_stream);
+    } else {
+        // set the position within directory stream to the specified cookie
+        seekdir((*readdir_session)->directory_stream, offset_cookie);
+    }
+
+    return 0;
+}
+
+/*
+ * Marks the given ReadDir session as just read from, and removes it from the given list of active ReadDir sessions
+ * if its directory stream was read to the end.
+ *
+ * Must be called with the 'readdir_sessions_mutex' held.
+ *
+ * Returns 0 on success and > 0 on failure.
+ */
+static int release_readdir_session(Rpc__AuthSysParams *client_authsysparams, char *directory_absolute_path,
+                                   ino_t directory_inode_number, ReadDirSessionsList **active_readdir_sessions,
+                                   ReadDirSession *readdir_session, int end_of_stream) {
+    // update the time of the last read from this directory stream
+    readdir_session->last_readdir_rpc_timestamp = time(NULL);
+
+    // if the stream was read to the end, close it
+    if (end_of_stream == 1) {
+        int error_code = remove_readdir_session(client_authsysparams, directory_inode_number, active_readdir_sessions);
+        if (error_code > 0) {
+            fprintf(stderr,
+                    "release_readdir_session: failed removing the ReadDir session client %s:%d:%d and directory %s\n",
+                    client_authsysparams->machinename, client_authsysparams->uid, client_authsysparams->gid,
+                    directory_absolute_path);
+
+            return 7;
+        }
+    }
+
+    return 0;
+}
+
 /*
  * Given a client (by its AUTH_SYS parameters) and a directory by its absolute path and inode number,
  * fetches the ReadDir session for this client and directory (or creates a new one if no such session is
@@ -433,7 +537,7 @@ void clean_up_directory_entries_list(Nfs__DirectoryEntriesList *directory_entrie
  *
  * In case of successful execution, the user of this function takes the responsibility to free all
  * directory entries, Nfs__FileName's, Nfs__FileName.filename's, and Nfs__NfsCookie's inside them
- * using the clean_up_directory_entries_list() function.
+ * using the clean_up_directory_entries_list() function. They are all allocated with 'rpc_arena_alloc'.
  */
 int read_from_directory(Rpc__AuthSysParams *client_authsysparams, char *directory_absolute_path,
                         ino_t directory_inode_number, ReadDirSessionsList **active_readdir_sessions, long offset_cookie,
@@ -450,38 +554,13 @@ int read_from_directory(Rpc__AuthSysParams *client_authsysparams, char *director
 
     pthread_mutex_lock(&readdir_sessions_mutex);
 
-    if (find_readdir_session(client_authsysparams, directory_inode_number, *active_readdir_sessions) != 0) {
-        // there is no active ReadDir session for this client and directory, so create one
-        int error_code = add_new_readdir_session(client_authsysparams, directory_absolute_path, directory_inode_number,
-                                                 active_readdir_sessions);
-        if (error_code > 0) {
-            fprintf(stderr, "read_from_directory: failed to create a new ReadDir session\n");
-
-            pthread_mutex_unlock(&readdir_sessions_mutex);
-
-            return 3;
-        }
-    }
-
-    // get the ReadDir session for this client and directory
-    ReadDirSession *readdir_session =
-        get_readdir_session(client_authsysparams, directory_inode_number, *active_readdir_sessions);
-    if (readdir_session == NULL) {
-        fprintf(stderr, "read_from_directory: ReadDir session for client %s:%d:%d and directory %s not found\n",
-                client_authsysparams->machinename, client_authsysparams->uid, client_authsysparams->gid,
-                directory_absolute_path);
-
+    ReadDirSession *readdir_session;
+    int error_code = seek_readdir_session(client_authsysparams, directory_absolute_path, directory_inode_number,
+                                          active_readdir_sessions, offset_cookie, &readdir_session);
+    if (error_code > 0) {
         pthread_mutex_unlock(&readdir_sessions_mutex);
 
-        return 4;
-    }
-
-    // 0 is a special cookie value meaning client wants to start from beginning of directory stream
-    if (offset_cookie == 0) {
-        rewinddir(readdir_session->directory_stream);
-    } else {
-        // set the position within directory stream to the specified cookie
-        seekdir(readdir_session->directory_stream, offset_cookie);
+        return error_code;
     }
 
     uint32_t total_size = 0;
@@ -509,14 +588,14 @@ int read_from_directory(Rpc__AuthSysParams *client_authsysparams, char *director
         }
 
         // construct a new directory entry
-        Nfs__DirectoryEntriesList *new_directory_entry = malloc(sizeof(Nfs__DirectoryEntriesList));
+        Nfs__DirectoryEntriesList *new_directory_entry = rpc_arena_alloc(sizeof(Nfs__DirectoryEntriesList));
         nfs__directory_entries_list__init(new_directory_entry);
         new_directory_entry->fileid =
             directory_entry->d_ino; // fileid in FAttr is inode number, so this fileid should also be inode number
 
-        Nfs__FileName *file_name = malloc(sizeof(Nfs__FileName));
+        Nfs__FileName *file_name = rpc_arena_alloc(sizeof(Nfs__FileName));
         nfs__file_name__init(file_name);
-        file_name->filename = strdup(
+        file_name->filename = rpc_arena_strdup(
             directory_entry
                 ->d_name); // make a copy of the file name to persist after this dirent is deallocated by closedir()
         new_directory_entry->name = file_name;
@@ -533,16 +612,18 @@ int read_from_directory(Rpc__AuthSysParams *client_authsysparams, char *director
 
             return 6;
         }
-        Nfs__NfsCookie *nfs_cookie = malloc(sizeof(Nfs__NfsCookie));
+        Nfs__NfsCookie *nfs_cookie = rpc_arena_alloc(sizeof(Nfs__NfsCookie));
         nfs__nfs_cookie__init(nfs_cookie);
         nfs_cookie->value = posix_cookie;
         new_directory_entry->cookie = nfs_cookie;
 
         new_directory_entry->nextentry = NULL;
 
-        // check we're not exceeding limit on bytes read, using Protobuf get_packed_size
-        size_t directory_entry_packed_size = nfs__directory_entries_list__get_packed_size(new_directory_entry);
+        // check we're not exceeding limit on bytes read, using the packed size in the codec of the RPC call
+        size_t directory_entry_packed_size =
+            get_rpc_payload_packed_size(get_rpc_call_codec(), &new_directory_entry->base);
         if (total_size + directory_entry_packed_size > byte_count) {
+            clean_up_directory_entries_list(new_directory_entry);
             break;
         }
         total_size += directory_entry_packed_size;
@@ -558,28 +639,377 @@ int read_from_directory(Rpc__AuthSysParams *client_authsysparams, char *director
         }
     } while (total_size < byte_count);
 
-    // update the time of the last read from this directory stream
-    readdir_session->last_readdir_rpc_timestamp = time(NULL);
+    error_code = release_readdir_session(client_authsysparams, directory_absolute_path, directory_inode_number,
+                                         active_readdir_sessions, readdir_session, *end_of_stream);
+    if (error_code > 0) {
+        // clean up the directory entries allocated so far
+        clean_up_directory_entries_list(directory_entries_list_head);
 
-    // if the stream was read to the end, close it
-    if (*end_of_stream == 1) {
-        int error_code = remove_readdir_session(client_authsysparams, directory_inode_number, active_readdir_sessions);
-        if (error_code > 0) {
-            fprintf(stderr,
-                    "read_from_directory: failed removing the ReadDir session client %s:%d:%d and directory %s\n",
-                    client_authsysparams->machinename, client_authsysparams->uid, client_authsysparams->gid,
-                    directory_absolute_path);
+        pthread_mutex_unlock(&readdir_sessions_mutex);
+
+        return error_code;
+    }
+
+    pthread_mutex_unlock(&readdir_sessions_mutex);
+
+    return 0;
+}
+
+/*
+ * Gives the NFS filehandle and the attributes of the given entry of the directory open in the given directory
+ * stream, placing them in 'file' and 'attributes'.
+ *
+ * The NFS filehandle is taken from the given inode cache, and created in it if the file is seen for the first time.
+ *
+ * Returns 0 on success and > 0 on failure.
+ */
+static int get_directory_entry_plus(DIR *directory_stream, char *directory_absolute_path, char *file_name,
+                                    InodeCache *inode_cache, Nfs__FHandle **file, Nfs__FAttr **attributes) {
+    // stat the entry relative to the open directory, saving the lookup of the whole path
+    struct stat file_stat;
+    if (fstatat(dirfd(directory_stream), file_name, &file_stat, AT_SYMLINK_NOFOLLOW) < 0) {
+        perror_msg("Failed retrieving file stats for entry '%s' of directory at absolute path %s", file_name,
+                   directory_absolute_path);
+        return 1;
+    }
+
+    NfsFh__NfsFileHandle *nfs_filehandle = get_nfs_filehandle_from_inode_number(file_stat.st_ino, *inode_cache);
+    if (nfs_filehandle == NULL) {
+        // file is visited for the first time, so create a NFS filehandle for it - do not free it later, it's freed when
+        // the entire inode cache is deallocated
+        char *file_absolute_path = get_file_absolute_path(directory_absolute_path, file_name);
+        nfs_filehandle = get_or_create_nfs_filehandle(file_absolute_path, file_stat.st_ino, inode_cache);
+        free(file_absolute_path);
+        if (nfs_filehandle == NULL) {
+            return 2;
+        }
+    }
+
+    Nfs__FAttr *fattr = rpc_arena_alloc(sizeof(Nfs__FAttr));
+    nfs__fattr__init(fattr);
+    if (get_attributes_from_stat(&file_stat, fattr) > 0) {
+        rpc_arena_free(fattr);
+        return 3;
+    }
+
+    Nfs__FHandle *fhandle = rpc_arena_alloc(sizeof(Nfs__FHandle));
+    nfs__fhandle__init(fhandle);
+    fhandle->nfs_filehandle = nfs_filehandle;
+
+    *file = fhandle;
+    *attributes = fattr;
+
+    return 0;
+}
+
+/*
+ * Reads directory entries for NFSPROC_READDIRPLUS the same way 'read_from_directory' does for NFSPROC_READDIR, and
+ * also gives the NFS filehandle and the attributes of every entry apart from '.' and '..', if 'with_filehandles' is
+ * set. The filehandles are taken from and added to the given inode cache.
+ *
+ * The first entry read is always returned, even if it's larger than 'byte_count', so that the client can make
+ * progress through the directory.
+ *
+ * This function executes atomically, using the 'readdir_sessions_mutex'.
+ *
+ * Returns 0 on success and > 0 on failure.
+ *
+ * In case of successful execution, the user of this function takes the responsibility to free the directory
+ * entries using the clean_up_directory_entries_plus_list() function. They are all allocated with 'rpc_arena_alloc'.
+ */
+int read_from_directory_plus(Rpc__AuthSysParams *client_authsysparams, char *directory_absolute_path,
+                             ino_t directory_inode_number, ReadDirSessionsList **active_readdir_sessions,
+                             long offset_cookie, size_t byte_count, bool with_filehandles, InodeCache *inode_cache,
+                             Nfs__DirectoryEntriesPlusList **head, int *end_of_stream) {
+    if (active_readdir_sessions == NULL) {
+        fprintf(stderr, "read_from_directory_plus: readdir_sessions is NULL\n");
+        return 1;
+    }
+
+    if (client_authsysparams == NULL) {
+        fprintf(stderr, "read_from_directory_plus: client AuthSysParams is NULL\n");
+        return 2;
+    }
+
+    pthread_mutex_lock(&readdir_sessions_mutex);
+
+    ReadDirSession *readdir_session;
+    int error_code = seek_readdir_session(client_authsysparams, directory_absolute_path, directory_inode_number,
+                                          active_readdir_sessions, offset_cookie, &readdir_session);
+    if (error_code > 0) {
+        pthread_mutex_unlock(&readdir_sessions_mutex);
+
+        return error_code;
+    }
+
+    size_t total_size = 0;
+    Nfs__DirectoryEntriesPlusList *directory_entries_list_head = NULL, *directory_entries_list_tail = NULL;
+    do {
+        errno = 0;
+        struct dirent *directory_entry = readdir(readdir_session->directory_stream);
+        if (directory_entry == NULL) {
+            if (errno == 0) {
+                // end of the directory stream reached
+                *end_of_stream = 1;
+                break;
+            }
+
+            perror_msg("Error occured while reading entries of directory at absolute path %s",
+                       directory_absolute_path);
+
+            clean_up_directory_entries_plus_list(directory_entries_list_head);
+
+            pthread_mutex_unlock(&readdir_sessions_mutex);
+
+            return 5;
+        }
+
+        long posix_cookie = telldir(readdir_session->directory_stream);
+        if (posix_cookie < 0) {
+            perror_msg("Failed getting current location in directory stream of directory at absolute path %s",
+                       directory_absolute_path);
+
+            clean_up_directory_entries_plus_list(directory_entries_list_head);
+
+            pthread_mutex_unlock(&readdir_sessions_mutex);
+
+            return 6;
+        }
+
+        // construct a new directory entry
+        Nfs__DirectoryEntriesPlusList *new_directory_entry = rpc_arena_alloc(sizeof(Nfs__DirectoryEntriesPlusList));
+        nfs__directory_entries_plus_list__init(new_directory_entry);
+        new_directory_entry->fileid = directory_entry->d_ino;
+
+        Nfs__FileName *file_name = rpc_arena_alloc(sizeof(Nfs__FileName));
+        nfs__file_name__init(file_name);
+        file_name->filename = rpc_arena_strdup(directory_entry->d_name);
+        new_directory_entry->name = file_name;
+
+        Nfs__NfsCookie *nfs_cookie = rpc_arena_alloc(sizeof(Nfs__NfsCookie));
+        nfs__nfs_cookie__init(nfs_cookie);
+        nfs_cookie->value = posix_cookie;
+        new_directory_entry->cookie = nfs_cookie;
+
+        // '..' of the exported directory is outside of the export, so neither '.' nor '..' get a filehandle
+        if (with_filehandles && strcmp(file_name->filename, ".") != 0 && strcmp(file_name->filename, "..") != 0) {
+            // an entry removed since it was read is still listed, just without a filehandle and attributes
+            if (get_directory_entry_plus(readdir_session->directory_stream, directory_absolute_path,
+                                         file_name->filename, inode_cache, &new_directory_entry->file,
+                                         &new_directory_entry->attributes) == 0) {
+                new_directory_entry->fileid = new_directory_entry->attributes->fileid;
+            }
+        }
+
+        // check we're not exceeding limit on bytes read, using the packed size in the codec of the RPC call
+        size_t directory_entry_packed_size =
+            get_rpc_payload_packed_size(get_rpc_call_codec(), &new_directory_entry->base);
+        if (directory_entries_list_head != NULL && total_size + directory_entry_packed_size > byte_count) {
+            clean_up_directory_entries_plus_list(new_directory_entry);
+            break;
+        }
+        total_size += directory_entry_packed_size;
+
+        // append the new directory entry to the end of the list
+        if (directory_entries_list_tail == NULL) {
+            directory_entries_list_head = directory_entries_list_tail = new_directory_entry;
+            *head = directory_entries_list_head;
+        } else {
+            directory_entries_list_tail->nextentry = new_directory_entry;
+            directory_entries_list_tail = new_directory_entry;
+        }
+    } while (total_size < byte_count);
+
+    error_code = release_readdir_session(client_authsysparams, directory_absolute_path, directory_inode_number,
+                                         active_readdir_sessions, readdir_session, *end_of_stream);
+    if (error_code > 0) {
+        clean_up_directory_entries_plus_list(directory_entries_list_head);
+
+        pthread_mutex_unlock(&readdir_sessions_mutex);
+
+        return error_code;
+    }
+
+    pthread_mutex_unlock(&readdir_sessions_mutex);
+
+    return 0;
+}
+
+/*
+ * Deallocates the arrays of the given flat list of directory entries, built by 'read_from_directory_2'.
+ */
+void clean_up_read_dir2_ok(Nfs__ReadDir2Ok *readdir2ok) {
+    if (readdir2ok == NULL) {
+        return;
+    }
+
+    rpc_arena_free(readdir2ok->fileids);
+    rpc_arena_free(readdir2ok->cookies);
+    rpc_arena_free(readdir2ok->name_offsets);
+    rpc_arena_free(readdir2ok->names.data);
+}
+
+/*
+ * Makes room for at least one more entry in the arrays of the given ReadDir2Ok, which currently have room for
+ * 'capacity' entries, by doubling their capacity.
+ */
+static void grow_read_dir2_ok_entries(Nfs__ReadDir2Ok *readdir2ok, size_t *capacity) {
+    if (readdir2ok->n_fileids < *capacity) {
+        return;
+    }
+
+    size_t new_capacity = *capacity == 0 ? READDIR2_INITIAL_NUM_ENTRIES : 2 * *capacity;
+
+    uint64_t *fileids = rpc_arena_alloc(new_capacity * sizeof(uint64_t));
+    uint64_t *cookies = rpc_arena_alloc(new_capacity * sizeof(uint64_t));
+    uint32_t *name_offsets = rpc_arena_alloc(new_capacity * sizeof(uint32_t));
+    if (readdir2ok->n_fileids > 0) {
+        memcpy(fileids, readdir2ok->fileids, readdir2ok->n_fileids * sizeof(uint64_t));
+        memcpy(cookies, readdir2ok->cookies, readdir2ok->n_cookies * sizeof(uint64_t));
+        memcpy(name_offsets, readdir2ok->name_offsets, readdir2ok->n_name_offsets * sizeof(uint32_t));
+    }
+    rpc_arena_free(readdir2ok->fileids);
+    rpc_arena_free(readdir2ok->cookies);
+    rpc_arena_free(readdir2ok->name_offsets);
+
+    readdir2ok->fileids = fileids;
+    readdir2ok->cookies = cookies;
+    readdir2ok->name_offsets = name_offsets;
+    *capacity = new_capacity;
+}
+
+/*
+ * Makes room for at least 'name_size' more bytes at the end of the names of the given ReadDir2Ok, which currently
+ * have room for 'capacity' bytes, by doubling their capacity as many times as needed.
+ */
+static void grow_read_dir2_ok_names(Nfs__ReadDir2Ok *readdir2ok, size_t *capacity, size_t name_size) {
+    if (readdir2ok->names.len + name_size <= *capacity) {
+        return;
+    }
+
+    size_t new_capacity = *capacity == 0 ? READDIR2_INITIAL_NAMES_SIZE : 2 * *capacity;
+    while (new_capacity < readdir2ok->names.len + name_size) {
+        new_capacity *= 2;
+    }
+
+    uint8_t *names = rpc_arena_alloc(new_capacity);
+    if (readdir2ok->names.len > 0) {
+        memcpy(names, readdir2ok->names.data, readdir2ok->names.len);
+    }
+    rpc_arena_free(readdir2ok->names.data);
+
+    readdir2ok->names.data = names;
+    *capacity = new_capacity;
+}
+
+/*
+ * Like 'read_from_directory', but places the directory entries flat in the given ReadDir2Ok, as READDIR2 returns them:
+ * their fileids, cookies and name offsets in three arrays, and their NUL-terminated names back to back in 'names'.
+ * 'eof' of the ReadDir2Ok is set if end of directory stream was reached.
+ *
+ * The size of an entry is taken to be the size of its name and NUL byte, plus the largest size its fileid, cookie and
+ * name offset can take in either codec. The first entry is returned even if it is larger than 'byte_count'.
+ *
+ * This function executes atomically, using the 'readdir_sessions_mutex'.
+ *
+ * Returns 0 on success and > 0 on failure. The 'directory_absolute_path' is only used for printing in
+ * case of an error.
+ *
+ * In case of successful execution, the user of this function takes the responsibility to free the arrays in the
+ * ReadDir2Ok using the clean_up_read_dir2_ok() function. They are all allocated with 'rpc_arena_alloc'.
+ */
+int read_from_directory_2(Rpc__AuthSysParams *client_authsysparams, char *directory_absolute_path,
+                          ino_t directory_inode_number, ReadDirSessionsList **active_readdir_sessions,
+                          long offset_cookie, size_t byte_count, Nfs__ReadDir2Ok *readdir2ok) {
+    if (active_readdir_sessions == NULL) {
+        fprintf(stderr, "read_from_directory_2: readdir_sessions is NULL\n");
+        return 1;
+    }
+
+    if (client_authsysparams == NULL) {
+        fprintf(stderr, "read_from_directory_2: client AuthSysParams is NULL\n");
+        return 2;
+    }
+
+    pthread_mutex_lock(&readdir_sessions_mutex);
+
+    ReadDirSession *readdir_session;
+    int error_code = seek_readdir_session(client_authsysparams, directory_absolute_path, directory_inode_number,
+                                          active_readdir_sessions, offset_cookie, &readdir_session);
+    if (error_code > 0) {
+        pthread_mutex_unlock(&readdir_sessions_mutex);
+
+        return error_code;
+    }
+
+    size_t total_size = 0, entries_capacity = 0, names_capacity = 0;
+    while (true) {
+        errno = 0;
+        struct dirent *directory_entry =
+            readdir(readdir_session->directory_stream); // man page of 'readdir' says not to free this
+        if (directory_entry == NULL) {
+            if (errno == 0) {
+                // end of the directory stream reached
+                readdir2ok->eof = 1;
+                break;
+            }
+
+            perror_msg("Error occured while reading entries of directory at absolute path %s",
+                       directory_absolute_path);
 
             // clean up the directory entries allocated so far
-            clean_up_directory_entries_list(directory_entries_list_head);
+            clean_up_read_dir2_ok(readdir2ok);
 
             pthread_mutex_unlock(&readdir_sessions_mutex);
 
-            return 7;
+            return 5;
         }
+
+        long posix_cookie = telldir(readdir_session->directory_stream);
+        if (posix_cookie < 0) {
+            perror_msg("Failed getting current location in directory stream of directory at absolute path %s",
+                       directory_absolute_path);
+
+            // clean up the directory entries allocated so far
+            clean_up_read_dir2_ok(readdir2ok);
+
+            pthread_mutex_unlock(&readdir_sessions_mutex);
+
+            return 6;
+        }
+
+        // check we're not exceeding limit on bytes read, but always return at least one entry so the client makes
+        // progress
+        size_t name_size = strlen(directory_entry->d_name) + 1;
+        if (readdir2ok->n_fileids > 0 && total_size + READDIR2_MAX_ENTRY_OVERHEAD + name_size > byte_count) {
+            break;
+        }
+        total_size += READDIR2_MAX_ENTRY_OVERHEAD + name_size;
+
+        // append the new directory entry to the arrays
+        grow_read_dir2_ok_entries(readdir2ok, &entries_capacity);
+        grow_read_dir2_ok_names(readdir2ok, &names_capacity, name_size);
+
+        readdir2ok->fileids[readdir2ok->n_fileids++] =
+            directory_entry->d_ino; // fileid in FAttr is inode number, so this fileid should also be inode number
+        readdir2ok->cookies[readdir2ok->n_cookies++] = posix_cookie;
+        readdir2ok->name_offsets[readdir2ok->n_name_offsets++] = readdir2ok->names.len;
+        memcpy(readdir2ok->names.data + readdir2ok->names.len, directory_entry->d_name, name_size);
+        readdir2ok->names.len += name_size;
+    }
+
+    error_code = release_readdir_session(client_authsysparams, directory_absolute_path, directory_inode_number,
+                                         active_readdir_sessions, readdir_session, readdir2ok->eof);
+    if (error_code > 0) {
+        // clean up the directory entries allocated so far
+        clean_up_read_dir2_ok(readdir2ok);
+
+        pthread_mutex_unlock(&readdir_sessions_mutex);
+
+        return error_code;
     }
 
     pthread_mutex_unlock(&readdir_sessions_mutex);
 
     return 0;
-}
\ No newline at end of file
+}
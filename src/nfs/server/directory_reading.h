@@ -1,13 +1,19 @@
 #ifndef directory_reading__header__INCLUDED
 #define directory_reading__header__INCLUDED
 
+#include "file_management.h" // first, as it sets the feature test macros for seekdir() and telldir()
+
 #include <dirent.h>
+#include <stdbool.h>
 #include <stdint.h>
 #include <sys/types.h>
 
 #include "src/serialization/nfs/nfs.pb-c.h"
 #include "src/serialization/rpc/rpc.pb-c.h"
 
+#include "src/common_rpc/rpc_arena.h"
+#include "src/common_rpc/rpc_codec.h"
+
 typedef struct ReadDirSession {
     // identification of the client who owns this session
     Rpc__AuthSysParams *client_authsysparams;
@@ -34,4 +40,17 @@ int read_from_directory(Rpc__AuthSysParams *client_authsysparams, char *director
                         ino_t directory_inode_number, ReadDirSessionsList **readdir_sessions, long offset_cookie,
                         size_t byte_count, Nfs__DirectoryEntriesList **head, int *end_of_stream);
 
+void clean_up_directory_entries_plus_list(Nfs__DirectoryEntriesPlusList *directory_entries_list_head);
+
+int read_from_directory_plus(Rpc__AuthSysParams *client_authsysparams, char *directory_absolute_path,
+                             ino_t directory_inode_number, ReadDirSessionsList **readdir_sessions, long offset_cookie,
+                             size_t byte_count, bool with_filehandles, InodeCache *inode_cache,
+                             Nfs__DirectoryEntriesPlusList **head, int *end_of_stream);
+
+void clean_up_read_dir2_ok(Nfs__ReadDir2Ok *readdir2ok);
+
+int read_from_directory_2(Rpc__AuthSysParams *client_authsysparams, char *directory_absolute_path,
+                          ino_t directory_inode_number, ReadDirSessionsList **readdir_sessions, long offset_cookie,
+                          size_t byte_count, Nfs__ReadDir2Ok *readdir2ok);
+
 #endif /* directory_reading__header__INCLUDED */
\ No newline at end of file
@@ -1,5 +1,13 @@
 #include "file_management.h"
 
+#include <pthread.h>
+
+/*
+ * Serializes additions to the inode cache - procedures that add to it only share the 'server_state_lock', so two of
+ * them could otherwise prepend to the inode cache at the same time, or both add a mapping for the same inode number.
+ */
+static pthread_mutex_t inode_cache_insertion_mutex = PTHREAD_MUTEX_INITIALIZER;
+
 /*
  * Given the absolute path of a directory or a file, places its inode number in
  * 'inode_number' argument.
@@ -19,17 +27,10 @@ int get_inode_number(char *absolute_path, ino_t *inode_number) {
 }
 
 /*
- * Creates a NFS filehandle for the file at the given absolute path. On successful exection,
- * it adds a mapping to the inode cache given in 'inode_number_cache' argument, to remember
- * what absolute path this file's inode number corresponds to.
- *
- * Returns 0 on success and > 0 on failure.
- *
- * The user of this function is responsible for deallocating the created NFS filehandle. This is
- * done either by having it removed from the InodeCache at some point, or by the InodeCache clean up
- * on server shutdown.
+ * Creates a NFS filehandle for the file at the given absolute path, as 'create_nfs_filehandle', but with the
+ * 'inode_cache_insertion_mutex' already held by the caller.
  */
-NfsFh__NfsFileHandle *create_nfs_filehandle(char *absolute_path, InodeCache *inode_number_cache) {
+static NfsFh__NfsFileHandle *create_nfs_filehandle_unlocked(char *absolute_path, InodeCache *inode_number_cache) {
     ino_t inode_number;
     int error_code = get_inode_number(absolute_path, &inode_number);
     if (error_code > 0) {
@@ -57,6 +58,54 @@ NfsFh__NfsFileHandle *create_nfs_filehandle(char *absolute_path, InodeCache *ino
     return nfs_filehandle;
 }
 
+/*
+ * Creates a NFS filehandle for the file at the given absolute path. On successful exection,
+ * it adds a mapping to the inode cache given in 'inode_number_cache' argument, to remember
+ * what absolute path this file's inode number corresponds to.
+ *
+ * Returns 0 on success and > 0 on failure.
+ *
+ * The user of this function is responsible for deallocating the created NFS filehandle. This is
+ * done either by having it removed from the InodeCache at some point, or by the InodeCache clean up
+ * on server shutdown.
+ */
+NfsFh__NfsFileHandle *create_nfs_filehandle(char *absolute_path, InodeCache *inode_number_cache) {
+    pthread_mutex_lock(&inode_cache_insertion_mutex);
+    NfsFh__NfsFileHandle *nfs_filehandle = create_nfs_filehandle_unlocked(absolute_path, inode_number_cache);
+    pthread_mutex_unlock(&inode_cache_insertion_mutex);
+
+    return nfs_filehandle;
+}
+
+/*
+ * Returns the NFS filehandle from the inode cache given in 'inode_number_cache' for the file with the given inode
+ * number at the given absolute path, creating one as with 'create_nfs_filehandle' if the file is visited for the first
+ * time. The lookup and the creation are done at once, so concurrent callers never add two mappings for the same file.
+ *
+ * Returns NULL on failure.
+ *
+ * The returned NFS filehandle is owned by the inode cache, so the user of this function must not free it.
+ */
+NfsFh__NfsFileHandle *get_or_create_nfs_filehandle(char *absolute_path, ino_t inode_number,
+                                                   InodeCache *inode_number_cache) {
+    NfsFh__NfsFileHandle *nfs_filehandle = get_nfs_filehandle_from_inode_number(inode_number, *inode_number_cache);
+    if (nfs_filehandle != NULL) {
+        return nfs_filehandle;
+    }
+
+    pthread_mutex_lock(&inode_cache_insertion_mutex);
+
+    // another procedure may have added it since we last looked
+    nfs_filehandle = get_nfs_filehandle_from_inode_number(inode_number, *inode_number_cache);
+    if (nfs_filehandle == NULL) {
+        nfs_filehandle = create_nfs_filehandle_unlocked(absolute_path, inode_number_cache);
+    }
+
+    pthread_mutex_unlock(&inode_cache_insertion_mutex);
+
+    return nfs_filehandle;
+}
+
 /*
  * Reads out the file type from the mode.
  */
@@ -84,7 +133,8 @@ Nfs__FType decode_file_type(mode_t st_mode) {
  * Given an absolute path of a file or a directory, gives the corresponding file's attributes in 'fattr'.
  * Returns 0 on succes and > 0 on failure.
  *
- * The user of this function takes the responsibility to free the heap-allocated NfsFType and TimeVal structures.
+ * The user of this function takes the responsibility to free the NfsFType and TimeVal structures, allocated with
+ * 'rpc_arena_alloc', using 'clean_up_fattr'.
  */
 int get_attributes(char *absolute_path, Nfs__FAttr *fattr) {
     struct stat file_stat;
@@ -93,65 +143,76 @@ int get_attributes(char *absolute_path, Nfs__FAttr *fattr) {
         return 1;
     }
 
-    Nfs__NfsFType *nfs_ftype = malloc(sizeof(Nfs__NfsFType));
+    return get_attributes_from_stat(&file_stat, fattr);
+}
+
+/*
+ * Gives the file attributes corresponding to the given file stats in 'fattr'.
+ * Returns 0 on succes and > 0 on failure.
+ *
+ * The user of this function takes the responsibility to free the NfsFType and TimeVal structures, allocated with
+ * 'rpc_arena_alloc', using 'clean_up_fattr'.
+ */
+int get_attributes_from_stat(const struct stat *file_stat, Nfs__FAttr *fattr) {
+    Nfs__NfsFType *nfs_ftype = rpc_arena_alloc(sizeof(Nfs__NfsFType));
     if (nfs_ftype == NULL) {
         perror("Failed to allocate 'NfsFType'");
         return 2;
     }
     nfs__nfs_ftype__init(nfs_ftype);
-    nfs_ftype->ftype = decode_file_type(file_stat.st_mode);
+    nfs_ftype->ftype = decode_file_type(file_stat->st_mode);
     fattr->nfs_ftype = nfs_ftype;
 
-    fattr->mode = file_stat.st_mode;
-    fattr->nlink = file_stat.st_nlink;
-    fattr->uid = file_stat.st_uid;
-    fattr->gid = file_stat.st_gid;
-    fattr->size = file_stat.st_size;
-    fattr->blocksize = file_stat.st_blksize;
+    fattr->mode = file_stat->st_mode;
+    fattr->nlink = file_stat->st_nlink;
+    fattr->uid = file_stat->st_uid;
+    fattr->gid = file_stat->st_gid;
+    fattr->size = file_stat->st_size;
+    fattr->blocksize = file_stat->st_blksize;
 
-    fattr->rdev = file_stat.st_rdev;
-    fattr->blocks = file_stat.st_blocks;
-    fattr->fsid = file_stat.st_dev;
-    fattr->fileid = file_stat.st_ino; // we use file's inode number as fileid (unique identifier on this device)
+    fattr->rdev = file_stat->st_rdev;
+    fattr->blocks = file_stat->st_blocks;
+    fattr->fsid = file_stat->st_dev;
+    fattr->fileid = file_stat->st_ino; // we use file's inode number as fileid (unique identifier on this device)
 
-    Nfs__TimeVal *atime = malloc(sizeof(Nfs__TimeVal));
+    Nfs__TimeVal *atime = rpc_arena_alloc(sizeof(Nfs__TimeVal));
     if (atime == NULL) {
         perror("Failed to allocate 'TimeVal'");
 
-        free(nfs_ftype);
+        rpc_arena_free(nfs_ftype);
 
         return 3;
     }
     nfs__time_val__init(atime);
-    atime->seconds = file_stat.st_atim.tv_sec;
-    atime->useconds = file_stat.st_atim.tv_nsec;
+    atime->seconds = file_stat->st_atim.tv_sec;
+    atime->useconds = file_stat->st_atim.tv_nsec;
 
-    Nfs__TimeVal *mtime = malloc(sizeof(Nfs__TimeVal));
+    Nfs__TimeVal *mtime = rpc_arena_alloc(sizeof(Nfs__TimeVal));
     if (mtime == NULL) {
         perror("Failed to allocate 'TimeVal'");
 
-        free(nfs_ftype);
-        free(atime);
+        rpc_arena_free(nfs_ftype);
+        rpc_arena_free(atime);
 
         return 3;
     }
     nfs__time_val__init(mtime);
-    mtime->seconds = file_stat.st_mtim.tv_sec;
-    mtime->useconds = file_stat.st_mtim.tv_nsec;
+    mtime->seconds = file_stat->st_mtim.tv_sec;
+    mtime->useconds = file_stat->st_mtim.tv_nsec;
 
-    Nfs__TimeVal *ctime = malloc(sizeof(Nfs__TimeVal));
+    Nfs__TimeVal *ctime = rpc_arena_alloc(sizeof(Nfs__TimeVal));
     if (ctime == NULL) {
         perror("Failed to allocate 'TimeVal'");
 
-        free(nfs_ftype);
-        free(atime);
-        free(mtime);
+        rpc_arena_free(nfs_ftype);
+        rpc_arena_free(atime);
+        rpc_arena_free(mtime);
 
         return 3;
     }
     nfs__time_val__init(ctime);
-    ctime->seconds = file_stat.st_ctim.tv_sec;
-    ctime->useconds = file_stat.st_ctim.tv_nsec;
+    ctime->seconds = file_stat->st_ctim.tv_sec;
+    ctime->useconds = file_stat->st_ctim.tv_nsec;
 
     fattr->atime = atime;
     fattr->mtime = mtime;
@@ -168,10 +229,10 @@ void clean_up_fattr(Nfs__FAttr *fattr) {
         return;
     }
 
-    free(fattr->nfs_ftype);
-    free(fattr->atime);
-    free(fattr->mtime);
-    free(fattr->ctime);
+    rpc_arena_free(fattr->nfs_ftype);
+    rpc_arena_free(fattr->atime);
+    rpc_arena_free(fattr->mtime);
+    rpc_arena_free(fattr->ctime);
 }
 
 /*
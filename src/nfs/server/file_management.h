@@ -24,14 +24,21 @@
 
 #include "inode_cache.h"
 
+#include "src/common_rpc/rpc_arena.h"
+
 /*
  * General file management functions used by many Nfs procedures
  */
 
 NfsFh__NfsFileHandle *create_nfs_filehandle(char *absolute_path, InodeCache *inode_number_cache);
 
+NfsFh__NfsFileHandle *get_or_create_nfs_filehandle(char *absolute_path, ino_t inode_number,
+                                                   InodeCache *inode_number_cache);
+
 int get_attributes(char *absolute_path, Nfs__FAttr *fattr);
 
+int get_attributes_from_stat(const struct stat *file_stat, Nfs__FAttr *fattr);
+
 void clean_up_fattr(Nfs__FAttr *fattr);
 
 /*
@@ -50,7 +50,8 @@ int add_inode_mapping(NfsFh__NfsFileHandle *nfs_filehandle, char *absolute_path,
 
     new_mapping->next = *head;
 
-    *head = new_mapping;
+    // published only once filled in, as procedures may be traversing the inode cache while it's added to
+    __atomic_store_n(head, new_mapping, __ATOMIC_RELEASE);
 
     return 0;
 }
@@ -7,6 +7,8 @@
 #include "src/serialization/rpc/rpc.pb-c.h"
 #include <protobuf-c/protobuf-c.h>
 
+#include "src/common_rpc/rpc_arena.h"
+
 Mount__FhStatus *create_default_case_fh_status(Mount__Stat non_mnt_ok_status);
 
 #endif /* mount_messages__header__INCLUDED */
\ No newline at end of file
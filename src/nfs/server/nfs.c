@@ -57,6 +57,15 @@ Rpc__AcceptedReply *call_nfs(Rpc__OpaqueAuth *credential, Rpc__OpaqueAuth *verif
         return serve_nfs_procedure_16_read_from_directory(credential, verifier, parameters);
     case 17:
         return serve_nfs_procedure_17_get_filesystem_attributes(credential, verifier, parameters);
+    case 18:
+        // procedure 18 (NFSPROC_COMPOUND) is an extension to RFC 1094
+        return serve_nfs_procedure_18_compound(credential, verifier, parameters);
+    case 19:
+        // procedure 19 (NFSPROC_READDIRPLUS) is an extension to RFC 1094
+        return serve_nfs_procedure_19_read_from_directory_plus(credential, verifier, parameters);
+    case 20:
+        // procedure 20 (NFSPROC_READDIR2) is an extension to RFC 1094
+        return serve_nfs_procedure_20_read_from_directory_2(credential, verifier, parameters);
     default:
     }
 
@@ -1,13 +1,36 @@
 #include "nfs_messages.h"
 
+#include <pthread.h>
+
+#define NUM_RPC_CODECS (RPC_CODEC_XDR + 1)
+
+// one past the largest Nfs__Stat value
+#define NFS_STAT_LIMIT (NFS__STAT__NFSERR_WFLUSH + 1)
+
+/*
+ * Procedure results with an error status, packed once in each codec and copied into every reply that carries them.
+ */
+typedef struct PackedNfsResults {
+    uint8_t *buffer; // NULL if these results aren't prebuilt
+    size_t size;
+} PackedNfsResults;
+
+static PackedNfsResults packed_nfs_error_results[NUM_NFS_RESULTS_TYPES][NFS_STAT_LIMIT][NUM_RPC_CODECS];
+
+static pthread_once_t packed_nfs_error_results_once = PTHREAD_ONCE_INIT;
+
+static char *nfs_results_type_urls[NUM_NFS_RESULTS_TYPES] = {
+    "nfs/NfsStat",    "nfs/AttrStat",  "nfs/DirOpRes",       "nfs/ReadLinkRes", "nfs/ReadRes",
+    "nfs/ReadDirRes", "nfs/StatFsRes", "nfs/ReadDirPlusRes", "nfs/ReadDir2Res"};
+
 /*
  * Creates a NfsStat structure with the given status.
  *
  * The user of this fuction takes the responsibility to free the NfsStat allocated
- * in this function.
+ * in this function, using 'rpc_arena_free'.
  */
 Nfs__NfsStat *create_nfs_stat(Nfs__Stat stat) {
-    Nfs__NfsStat *nfs_status = malloc(sizeof(Nfs__NfsStat));
+    Nfs__NfsStat *nfs_status = rpc_arena_alloc(sizeof(Nfs__NfsStat));
     nfs__nfs_stat__init(nfs_status);
     nfs_status->stat = stat;
 
@@ -21,20 +44,20 @@ Nfs__NfsStat *create_nfs_stat(Nfs__Stat stat) {
  * If the given Nfs__Stat is NFS__STAT__NFS_OK, NULL is returned.
  *
  * The user of this fuction takes the responsibility to free the AttrStat, NfsStat,
- * and Empty allocated in this function.
+ * and Empty allocated in this function, using 'rpc_arena_free'.
  */
 Nfs__AttrStat *create_default_case_attr_stat(Nfs__Stat non_nfs_ok_status) {
     if (non_nfs_ok_status == NFS__STAT__NFS_OK) {
         return NULL;
     }
 
-    Nfs__AttrStat *attr_stat = malloc(sizeof(Nfs__AttrStat));
+    Nfs__AttrStat *attr_stat = rpc_arena_alloc(sizeof(Nfs__AttrStat));
     nfs__attr_stat__init(attr_stat);
 
     attr_stat->nfs_status = create_nfs_stat(non_nfs_ok_status);
     attr_stat->body_case = NFS__ATTR_STAT__BODY_DEFAULT_CASE;
 
-    Google__Protobuf__Empty *empty = malloc(sizeof(Google__Protobuf__Empty));
+    Google__Protobuf__Empty *empty = rpc_arena_alloc(sizeof(Google__Protobuf__Empty));
     google__protobuf__empty__init(empty);
     attr_stat->default_case = empty;
 
@@ -48,20 +71,20 @@ Nfs__AttrStat *create_default_case_attr_stat(Nfs__Stat non_nfs_ok_status) {
  * If the given Nfs__Stat is NFS__STAT__NFS_OK, NULL is returned.
  *
  * The user of this fuction takes the responsibility to free the DirOpRes, NfsStat,
- * and Empty allocated in this function.
+ * and Empty allocated in this function, using 'rpc_arena_free'.
  */
 Nfs__DirOpRes *create_default_case_dir_op_res(Nfs__Stat non_nfs_ok_status) {
     if (non_nfs_ok_status == NFS__STAT__NFS_OK) {
         return NULL;
     }
 
-    Nfs__DirOpRes *diropres = malloc(sizeof(Nfs__DirOpRes));
+    Nfs__DirOpRes *diropres = rpc_arena_alloc(sizeof(Nfs__DirOpRes));
     nfs__dir_op_res__init(diropres);
 
     diropres->nfs_status = create_nfs_stat(non_nfs_ok_status);
     diropres->body_case = NFS__DIR_OP_RES__BODY_DEFAULT_CASE;
 
-    Google__Protobuf__Empty *empty = malloc(sizeof(Google__Protobuf__Empty));
+    Google__Protobuf__Empty *empty = rpc_arena_alloc(sizeof(Google__Protobuf__Empty));
     google__protobuf__empty__init(empty);
     diropres->default_case = empty;
 
@@ -75,20 +98,20 @@ Nfs__DirOpRes *create_default_case_dir_op_res(Nfs__Stat non_nfs_ok_status) {
  * If the given Nfs__Stat is NFS__STAT__NFS_OK, NULL is returned.
  *
  * The user of this fuction takes the responsibility to free the ReadLinkRes, NfsStat,
- * and Empty allocated in this function.
+ * and Empty allocated in this function, using 'rpc_arena_free'.
  */
 Nfs__ReadLinkRes *create_default_case_read_link_res(Nfs__Stat non_nfs_ok_status) {
     if (non_nfs_ok_status == NFS__STAT__NFS_OK) {
         return NULL;
     }
 
-    Nfs__ReadLinkRes *readlinkres = malloc(sizeof(Nfs__ReadLinkRes));
+    Nfs__ReadLinkRes *readlinkres = rpc_arena_alloc(sizeof(Nfs__ReadLinkRes));
     nfs__read_link_res__init(readlinkres);
 
     readlinkres->nfs_status = create_nfs_stat(non_nfs_ok_status);
     readlinkres->body_case = NFS__READ_LINK_RES__BODY_DEFAULT_CASE;
 
-    Google__Protobuf__Empty *empty = malloc(sizeof(Google__Protobuf__Empty));
+    Google__Protobuf__Empty *empty = rpc_arena_alloc(sizeof(Google__Protobuf__Empty));
     google__protobuf__empty__init(empty);
     readlinkres->default_case = empty;
 
@@ -102,20 +125,20 @@ Nfs__ReadLinkRes *create_default_case_read_link_res(Nfs__Stat non_nfs_ok_status)
  * If the given Nfs__Stat is NFS__STAT__NFS_OK, NULL is returned.
  *
  * The user of this fuction takes the responsibility to free the ReadRes, NfsStat,
- * and Empty allocated in this function.
+ * and Empty allocated in this function, using 'rpc_arena_free'.
  */
 Nfs__ReadRes *create_default_case_read_res(Nfs__Stat non_nfs_ok_status) {
     if (non_nfs_ok_status == NFS__STAT__NFS_OK) {
         return NULL;
     }
 
-    Nfs__ReadRes *readres = malloc(sizeof(Nfs__ReadRes));
+    Nfs__ReadRes *readres = rpc_arena_alloc(sizeof(Nfs__ReadRes));
     nfs__read_res__init(readres);
 
     readres->nfs_status = create_nfs_stat(non_nfs_ok_status);
     readres->body_case = NFS__READ_RES__BODY_DEFAULT_CASE;
 
-    Google__Protobuf__Empty *empty = malloc(sizeof(Google__Protobuf__Empty));
+    Google__Protobuf__Empty *empty = rpc_arena_alloc(sizeof(Google__Protobuf__Empty));
     google__protobuf__empty__init(empty);
     readres->default_case = empty;
 
@@ -129,20 +152,20 @@ Nfs__ReadRes *create_default_case_read_res(Nfs__Stat non_nfs_ok_status) {
  * If the given Nfs__Stat is NFS__STAT__NFS_OK, NULL is returned.
  *
  * The user of this fuction takes the responsibility to free the ReadDirRes, NfsStat,
- * and Empty allocated in this function.
+ * and Empty allocated in this function, using 'rpc_arena_free'.
  */
 Nfs__ReadDirRes *create_default_case_read_dir_res(Nfs__Stat non_nfs_ok_status) {
     if (non_nfs_ok_status == NFS__STAT__NFS_OK) {
         return NULL;
     }
 
-    Nfs__ReadDirRes *readdirres = malloc(sizeof(Nfs__ReadDirRes));
+    Nfs__ReadDirRes *readdirres = rpc_arena_alloc(sizeof(Nfs__ReadDirRes));
     nfs__read_dir_res__init(readdirres);
 
     readdirres->nfs_status = create_nfs_stat(non_nfs_ok_status);
     readdirres->body_case = NFS__READ_DIR_RES__BODY_DEFAULT_CASE;
 
-    Google__Protobuf__Empty *empty = malloc(sizeof(Google__Protobuf__Empty));
+    Google__Protobuf__Empty *empty = rpc_arena_alloc(sizeof(Google__Protobuf__Empty));
     google__protobuf__empty__init(empty);
     readdirres->default_case = empty;
 
@@ -156,22 +179,189 @@ Nfs__ReadDirRes *create_default_case_read_dir_res(Nfs__Stat non_nfs_ok_status) {
  * If the given Nfs__Stat is NFS__STAT__NFS_OK, NULL is returned.
  *
  * The user of this fuction takes the responsibility to free the StatFsRes, NfsStat,
- * and Empty allocated in this function.
+ * and Empty allocated in this function, using 'rpc_arena_free'.
  */
 Nfs__StatFsRes *create_default_case_stat_fs_res(Nfs__Stat non_nfs_ok_status) {
     if (non_nfs_ok_status == NFS__STAT__NFS_OK) {
         return NULL;
     }
 
-    Nfs__StatFsRes *statfsres = malloc(sizeof(Nfs__StatFsRes));
+    Nfs__StatFsRes *statfsres = rpc_arena_alloc(sizeof(Nfs__StatFsRes));
     nfs__stat_fs_res__init(statfsres);
 
     statfsres->nfs_status = create_nfs_stat(non_nfs_ok_status);
     statfsres->body_case = NFS__STAT_FS_RES__BODY_DEFAULT_CASE;
 
-    Google__Protobuf__Empty *empty = malloc(sizeof(Google__Protobuf__Empty));
+    Google__Protobuf__Empty *empty = rpc_arena_alloc(sizeof(Google__Protobuf__Empty));
     google__protobuf__empty__init(empty);
     statfsres->default_case = empty;
 
     return statfsres;
+}
+
+/*
+ * Takes a Nfs__Stat and if it's not NFS__STAT__NFS_OK, creates an ReadDirPlusRes message
+ * with default case and that status.
+ *
+ * If the given Nfs__Stat is NFS__STAT__NFS_OK, NULL is returned.
+ *
+ * The user of this fuction takes the responsibility to free the ReadDirPlusRes, NfsStat,
+ * and Empty allocated in this function, using 'rpc_arena_free'.
+ */
+Nfs__ReadDirPlusRes *create_default_case_read_dir_plus_res(Nfs__Stat non_nfs_ok_status) {
+    if (non_nfs_ok_status == NFS__STAT__NFS_OK) {
+        return NULL;
+    }
+
+    Nfs__ReadDirPlusRes *readdirplusres = rpc_arena_alloc(sizeof(Nfs__ReadDirPlusRes));
+    nfs__read_dir_plus_res__init(readdirplusres);
+
+    readdirplusres->nfs_status = create_nfs_stat(non_nfs_ok_status);
+    readdirplusres->body_case = NFS__READ_DIR_PLUS_RES__BODY_DEFAULT_CASE;
+
+    Google__Protobuf__Empty *empty = rpc_arena_alloc(sizeof(Google__Protobuf__Empty));
+    google__protobuf__empty__init(empty);
+    readdirplusres->default_case = empty;
+
+    return readdirplusres;
+}
+
+/*
+ * Takes a Nfs__Stat and if it's not NFS__STAT__NFS_OK, creates an ReadDir2Res message
+ * with default case and that status.
+ *
+ * If the given Nfs__Stat is NFS__STAT__NFS_OK, NULL is returned.
+ *
+ * The user of this fuction takes the responsibility to free the ReadDir2Res, NfsStat,
+ * and Empty allocated in this function, using 'rpc_arena_free'.
+ */
+Nfs__ReadDir2Res *create_default_case_read_dir2_res(Nfs__Stat non_nfs_ok_status) {
+    if (non_nfs_ok_status == NFS__STAT__NFS_OK) {
+        return NULL;
+    }
+
+    Nfs__ReadDir2Res *readdir2res = rpc_arena_alloc(sizeof(Nfs__ReadDir2Res));
+    nfs__read_dir2_res__init(readdir2res);
+
+    readdir2res->nfs_status = create_nfs_stat(non_nfs_ok_status);
+    readdir2res->body_case = NFS__READ_DIR2_RES__BODY_DEFAULT_CASE;
+
+    Google__Protobuf__Empty *empty = rpc_arena_alloc(sizeof(Google__Protobuf__Empty));
+    google__protobuf__empty__init(empty);
+    readdir2res->default_case = empty;
+
+    return readdir2res;
+}
+
+/*
+ * Creates procedure results of the given type with the given status, and no body.
+ *
+ * Returns NULL if results of this type can't carry the given status without a body.
+ *
+ * The user of this function takes the responsibility to free the results, using
+ * 'protobuf_c_message_free_unpacked' with the 'rpc_arena_allocator'.
+ */
+static ProtobufCMessage *create_nfs_error_results(NfsResultsType results_type, Nfs__Stat nfs_stat) {
+    void *results = NULL;
+    switch (results_type) {
+    case NFS_RESULTS_NFS_STAT:
+        results = create_nfs_stat(nfs_stat);
+        break;
+    case NFS_RESULTS_ATTR_STAT:
+        results = create_default_case_attr_stat(nfs_stat);
+        break;
+    case NFS_RESULTS_DIR_OP_RES:
+        results = create_default_case_dir_op_res(nfs_stat);
+        break;
+    case NFS_RESULTS_READ_LINK_RES:
+        results = create_default_case_read_link_res(nfs_stat);
+        break;
+    case NFS_RESULTS_READ_RES:
+        results = create_default_case_read_res(nfs_stat);
+        break;
+    case NFS_RESULTS_READ_DIR_RES:
+        results = create_default_case_read_dir_res(nfs_stat);
+        break;
+    case NFS_RESULTS_STAT_FS_RES:
+        results = create_default_case_stat_fs_res(nfs_stat);
+        break;
+    case NFS_RESULTS_READ_DIR_PLUS_RES:
+        results = create_default_case_read_dir_plus_res(nfs_stat);
+        break;
+    case NFS_RESULTS_READ_DIR2_RES:
+        results = create_default_case_read_dir2_res(nfs_stat);
+        break;
+    default:
+        break;
+    }
+
+    return (ProtobufCMessage *)results;
+}
+
+/*
+ * Packs the results of every type with every status they can carry without a body, in every codec.
+ */
+static void build_packed_nfs_error_results(void) {
+    for (int results_type = 0; results_type < NUM_NFS_RESULTS_TYPES; results_type++) {
+        for (unsigned int i = 0; i < nfs__stat__descriptor.n_values; i++) {
+            int nfs_stat = nfs__stat__descriptor.values[i].value;
+            if (nfs_stat < 0 || nfs_stat >= NFS_STAT_LIMIT) {
+                continue;
+            }
+
+            ProtobufCMessage *results = create_nfs_error_results(results_type, nfs_stat);
+            if (results == NULL) {
+                continue;
+            }
+
+            for (int codec = 0; codec < NUM_RPC_CODECS; codec++) {
+                size_t size = get_rpc_payload_packed_size(codec, results);
+                uint8_t *buffer = malloc(size > 0 ? size : 1);
+                if (buffer == NULL) {
+                    continue;
+                }
+                pack_rpc_payload(codec, results, buffer);
+
+                packed_nfs_error_results[results_type][nfs_stat][codec].buffer = buffer;
+                packed_nfs_error_results[results_type][nfs_stat][codec].size = size;
+            }
+
+            protobuf_c_message_free_unpacked(results, &rpc_arena_allocator);
+        }
+    }
+}
+
+/*
+ * Builds and returns an AcceptedReply to the RPC call being served by the calling thread, carrying procedure
+ * results of the given type with the given status and no body - the reply of every procedure that fails with an
+ * NFS error.
+ *
+ * These results are the same every time, so they are packed once, in each codec, when the first of them is asked
+ * for, and every reply gets a copy of them.
+ *
+ * The user of this function takes the responsibility to deallocate the received AcceptedReply
+ * using the 'free_accepted_reply()' function.
+ */
+Rpc__AcceptedReply *create_nfs_error_accepted_reply(NfsResultsType results_type, Nfs__Stat nfs_stat) {
+    RpcCodec codec = get_rpc_call_codec();
+
+    pthread_once(&packed_nfs_error_results_once, build_packed_nfs_error_results);
+
+    if (results_type >= NUM_NFS_RESULTS_TYPES || nfs_stat < 0 || nfs_stat >= NFS_STAT_LIMIT ||
+        packed_nfs_error_results[results_type][nfs_stat][codec].buffer == NULL) {
+        fprintf(stderr, "create_nfs_error_accepted_reply: no results of type %d with status %d\n", results_type,
+                nfs_stat);
+
+        return create_system_error_accepted_reply();
+    }
+    PackedNfsResults *packed_results = &packed_nfs_error_results[results_type][nfs_stat][codec];
+
+    uint8_t *results_buffer = allocate_rpc_payload_buffer(packed_results->size);
+    if (results_buffer == NULL) {
+        return create_system_error_accepted_reply();
+    }
+    memcpy(results_buffer, packed_results->buffer, packed_results->size);
+
+    return wrap_procedure_results_in_successful_accepted_reply(packed_results->size, results_buffer,
+                                                               nfs_results_type_urls[results_type]);
 }
\ No newline at end of file
@@ -7,6 +7,27 @@
 #include "src/serialization/rpc/rpc.pb-c.h"
 #include <protobuf-c/protobuf-c.h>
 
+#include "src/common_rpc/common_rpc.h"
+#include "src/common_rpc/rpc_arena.h"
+#include "src/common_rpc/server_common_rpc.h"
+
+/*
+ * Types of procedure results that can carry an error status, each with its error replies prebuilt by
+ * 'create_nfs_error_accepted_reply'.
+ */
+typedef enum NfsResultsType {
+    NFS_RESULTS_NFS_STAT = 0,
+    NFS_RESULTS_ATTR_STAT = 1,
+    NFS_RESULTS_DIR_OP_RES = 2,
+    NFS_RESULTS_READ_LINK_RES = 3,
+    NFS_RESULTS_READ_RES = 4,
+    NFS_RESULTS_READ_DIR_RES = 5,
+    NFS_RESULTS_STAT_FS_RES = 6,
+    NFS_RESULTS_READ_DIR_PLUS_RES = 7,
+    NFS_RESULTS_READ_DIR2_RES = 8,
+    NUM_NFS_RESULTS_TYPES = 9
+} NfsResultsType;
+
 Nfs__NfsStat *create_nfs_stat(Nfs__Stat stat);
 
 Nfs__AttrStat *create_default_case_attr_stat(Nfs__Stat non_nfs_ok_status);
@@ -21,4 +42,10 @@ Nfs__ReadDirRes *create_default_case_read_dir_res(Nfs__Stat non_nfs_ok_status);
 
 Nfs__StatFsRes *create_default_case_stat_fs_res(Nfs__Stat non_nfs_ok_status);
 
+Nfs__ReadDirPlusRes *create_default_case_read_dir_plus_res(Nfs__Stat non_nfs_ok_status);
+
+Nfs__ReadDir2Res *create_default_case_read_dir2_res(Nfs__Stat non_nfs_ok_status);
+
+Rpc__AcceptedReply *create_nfs_error_accepted_reply(NfsResultsType results_type, Nfs__Stat nfs_stat);
+
 #endif /* nfs_messages__header__INCLUDED */
\ No newline at end of file
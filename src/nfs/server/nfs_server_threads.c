@@ -8,8 +8,9 @@ pthread_mutex_t nfs_server_threads_list_mutex = PTHREAD_MUTEX_INITIALIZER;
 
 /*
  * Frees the given NfsServerThreadsList entry.
- * In case of a TCP transport connection, closes and frees the rpc_client_socket_fd
- * inside the given nfs server threads list entry.
+ * In case of a TCP (or TLS) transport connection, closes and frees the rpc_client_socket_fd
+ * inside the given nfs server threads list entry, and in case of a shared-memory transport
+ * connection, closes the client's Unix domain socket and unmaps the memory shared with it.
  *
  * Does nothing if the given NfsServerThreadsList is null.
  */
@@ -20,6 +21,7 @@ void clean_up_nfs_server_threads_list_entry(NfsServerThreadsList *server_threads
 
     switch (server_threads_list_entry->transport_protocol) {
     case TRANSPORT_PROTOCOL_TCP:
+    case TRANSPORT_PROTOCOL_TLS:
         if (server_threads_list_entry->transport_connection.tcp_client->tcp_rpc_client_socket_fd == NULL) {
             break;
         }
@@ -27,6 +29,16 @@ void clean_up_nfs_server_threads_list_entry(NfsServerThreadsList *server_threads
         close(*server_threads_list_entry->transport_connection.tcp_client->tcp_rpc_client_socket_fd);
         free(server_threads_list_entry->transport_connection.tcp_client->tcp_rpc_client_socket_fd);
 
+        break;
+    case TRANSPORT_PROTOCOL_SHM:
+        if (server_threads_list_entry->transport_connection.shm_client == NULL) {
+            break;
+        }
+
+        close(server_threads_list_entry->transport_connection.shm_client->unix_socket_fd);
+        unmap_shm_region(server_threads_list_entry->transport_connection.shm_client->shm_region);
+        free(server_threads_list_entry->transport_connection.shm_client);
+
         break;
     case TRANSPORT_PROTOCOL_QUIC:
         // QUIC
@@ -59,9 +71,8 @@ int add_server_thread(pthread_t server_thread, TransportProtocol transport_proto
     new_entry->transport_protocol = transport_protocol;
     new_entry->transport_connection = transport_connection;
 
-    new_entry->next = *head;
-
     pthread_mutex_lock(&nfs_server_threads_list_mutex);
+    new_entry->next = *head;
     *head = new_entry;
     pthread_mutex_unlock(&nfs_server_threads_list_mutex);
 
@@ -84,6 +95,11 @@ int remove_server_thread(pthread_t server_thread, NfsServerThreadsList **head) {
 
     pthread_mutex_lock(&nfs_server_threads_list_mutex);
 
+    if (*head == NULL) {
+        pthread_mutex_unlock(&nfs_server_threads_list_mutex);
+        return 1;
+    }
+
     // the entry we want to remove is the first in the list
     if ((*head)->server_thread == server_thread) {
         NfsServerThreadsList *new_head = (*head)->next;
@@ -92,6 +108,8 @@ int remove_server_thread(pthread_t server_thread, NfsServerThreadsList **head) {
 
         *head = new_head;
 
+        pthread_mutex_unlock(&nfs_server_threads_list_mutex);
+
         return 0;
     }
 
@@ -50,6 +50,8 @@ int is_directory_exported(const char *absolute_path) {
  */
 Rpc__AcceptedReply *serve_mnt_procedure_1_add_mount_entry(Rpc__OpaqueAuth *credential, Rpc__OpaqueAuth *verifier,
                                                           Google__Protobuf__Any *parameters) {
+    RpcCodec codec = get_rpc_call_codec();
+
     // check parameters are of expected type for this procedure
     if (parameters->type_url == NULL || strcmp(parameters->type_url, "mount/DirPath") != 0) {
         fprintf(stderr, "serve_mnt_procedure_1_add_mount_entry: Expected mount/DirPath but received %s\n",
@@ -59,7 +61,8 @@ Rpc__AcceptedReply *serve_mnt_procedure_1_add_mount_entry(Rpc__OpaqueAuth *crede
     }
 
     // deserialize parameters
-    Mount__DirPath *dirpath = mount__dir_path__unpack(NULL, parameters->value.len, parameters->value.data);
+    Mount__DirPath *dirpath = unpack_rpc_payload(codec, &mount__dir_path__descriptor, &rpc_arena_allocator,
+                                                 parameters->value.len, parameters->value.data);
     if (dirpath == NULL) {
         fprintf(stderr, "serve_mnt_procedure_1_add_mount_entry: Failed to unpack DirPath\n");
 
@@ -68,7 +71,7 @@ Rpc__AcceptedReply *serve_mnt_procedure_1_add_mount_entry(Rpc__OpaqueAuth *crede
     if (dirpath->path == NULL) {
         fprintf(stderr, "serve_mnt_procedure_1_add_mount_entry: DirPath->path is null\n");
 
-        mount__dir_path__free_unpacked(dirpath, NULL);
+        mount__dir_path__free_unpacked(dirpath, &rpc_arena_allocator);
 
         return create_garbage_args_accepted_reply();
     }
@@ -94,14 +97,14 @@ Rpc__AcceptedReply *serve_mnt_procedure_1_add_mount_entry(Rpc__OpaqueAuth *crede
             Mount__FhStatus *fh_status = create_default_case_fh_status(mount_stat);
 
             // serialize the procedure results
-            size_t fh_status_size = mount__fh_status__get_packed_size(fh_status);
-            uint8_t *fh_status_buffer = malloc(fh_status_size);
-            mount__fh_status__pack(fh_status, fh_status_buffer);
+            size_t fh_status_size = get_rpc_payload_packed_size(codec, &fh_status->base);
+            uint8_t *fh_status_buffer = allocate_rpc_payload_buffer(fh_status_size);
+            pack_rpc_payload(codec, &fh_status->base, fh_status_buffer);
 
-            mount__dir_path__free_unpacked(dirpath, NULL);
-            free(fh_status->mnt_status);
-            free(fh_status->default_case);
-            free(fh_status);
+            mount__dir_path__free_unpacked(dirpath, &rpc_arena_allocator);
+            rpc_arena_free(fh_status->mnt_status);
+            rpc_arena_free(fh_status->default_case);
+            rpc_arena_free(fh_status);
 
             return wrap_procedure_results_in_successful_accepted_reply(fh_status_size, fh_status_buffer,
                                                                        "mount/FhStatus");
@@ -110,7 +113,7 @@ Rpc__AcceptedReply *serve_mnt_procedure_1_add_mount_entry(Rpc__OpaqueAuth *crede
                        "path '%s' exists",
                        directory_absolute_path);
 
-            mount__dir_path__free_unpacked(dirpath, NULL);
+            mount__dir_path__free_unpacked(dirpath, &rpc_arena_allocator);
 
             return create_system_error_accepted_reply();
         }
@@ -125,7 +128,7 @@ Rpc__AcceptedReply *serve_mnt_procedure_1_add_mount_entry(Rpc__OpaqueAuth *crede
                 "with error code %d\n",
                 directory_absolute_path, error_code);
 
-        mount__dir_path__free_unpacked(dirpath, NULL);
+        mount__dir_path__free_unpacked(dirpath, &rpc_arena_allocator);
 
         // return AcceptedReply with SYSTEM_ERR, as this shouldn't happen once we've checked this file/directory exists
         return create_system_error_accepted_reply();
@@ -139,15 +142,15 @@ Rpc__AcceptedReply *serve_mnt_procedure_1_add_mount_entry(Rpc__OpaqueAuth *crede
         Mount__FhStatus *fh_status = create_default_case_fh_status(MOUNT__STAT__MNTERR_NOTDIR);
 
         // serialize the procedure results
-        size_t fh_status_size = mount__fh_status__get_packed_size(fh_status);
-        uint8_t *fh_status_buffer = malloc(fh_status_size);
-        mount__fh_status__pack(fh_status, fh_status_buffer);
+        size_t fh_status_size = get_rpc_payload_packed_size(codec, &fh_status->base);
+        uint8_t *fh_status_buffer = allocate_rpc_payload_buffer(fh_status_size);
+        pack_rpc_payload(codec, &fh_status->base, fh_status_buffer);
 
         clean_up_fattr(&directory_fattr);
-        mount__dir_path__free_unpacked(dirpath, NULL);
-        free(fh_status->mnt_status);
-        free(fh_status->default_case);
-        free(fh_status);
+        mount__dir_path__free_unpacked(dirpath, &rpc_arena_allocator);
+        rpc_arena_free(fh_status->mnt_status);
+        rpc_arena_free(fh_status->default_case);
+        rpc_arena_free(fh_status);
 
         return wrap_procedure_results_in_successful_accepted_reply(fh_status_size, fh_status_buffer, "mount/FhStatus");
     }
@@ -160,14 +163,14 @@ Rpc__AcceptedReply *serve_mnt_procedure_1_add_mount_entry(Rpc__OpaqueAuth *crede
         Mount__FhStatus *fh_status = create_default_case_fh_status(MOUNT__STAT__MNTERR_NOTEXP);
 
         // serialize the procedure results
-        size_t fh_status_size = mount__fh_status__get_packed_size(fh_status);
-        uint8_t *fh_status_buffer = malloc(fh_status_size);
-        mount__fh_status__pack(fh_status, fh_status_buffer);
+        size_t fh_status_size = get_rpc_payload_packed_size(codec, &fh_status->base);
+        uint8_t *fh_status_buffer = allocate_rpc_payload_buffer(fh_status_size);
+        pack_rpc_payload(codec, &fh_status->base, fh_status_buffer);
 
-        mount__dir_path__free_unpacked(dirpath, NULL);
-        free(fh_status->mnt_status);
-        free(fh_status->default_case);
-        free(fh_status);
+        mount__dir_path__free_unpacked(dirpath, &rpc_arena_allocator);
+        rpc_arena_free(fh_status->mnt_status);
+        rpc_arena_free(fh_status->default_case);
+        rpc_arena_free(fh_status);
 
         return wrap_procedure_results_in_successful_accepted_reply(fh_status_size, fh_status_buffer, "mount/FhStatus");
     }
@@ -182,7 +185,7 @@ Rpc__AcceptedReply *serve_mnt_procedure_1_add_mount_entry(Rpc__OpaqueAuth *crede
                     "path '%s' with error code %d\n",
                     directory_absolute_path, stat);
 
-            mount__dir_path__free_unpacked(dirpath, NULL);
+            mount__dir_path__free_unpacked(dirpath, &rpc_arena_allocator);
 
             return create_system_error_accepted_reply();
         }
@@ -192,14 +195,14 @@ Rpc__AcceptedReply *serve_mnt_procedure_1_add_mount_entry(Rpc__OpaqueAuth *crede
             Mount__FhStatus *fh_status = create_default_case_fh_status(MOUNT__STAT__MNTERR_ACCES);
 
             // serialize the procedure results
-            size_t fh_status_size = mount__fh_status__get_packed_size(fh_status);
-            uint8_t *fh_status_buffer = malloc(fh_status_size);
-            mount__fh_status__pack(fh_status, fh_status_buffer);
+            size_t fh_status_size = get_rpc_payload_packed_size(codec, &fh_status->base);
+            uint8_t *fh_status_buffer = allocate_rpc_payload_buffer(fh_status_size);
+            pack_rpc_payload(codec, &fh_status->base, fh_status_buffer);
 
-            mount__dir_path__free_unpacked(dirpath, NULL);
-            free(fh_status->mnt_status);
-            free(fh_status->default_case);
-            free(fh_status);
+            mount__dir_path__free_unpacked(dirpath, &rpc_arena_allocator);
+            rpc_arena_free(fh_status->mnt_status);
+            rpc_arena_free(fh_status->default_case);
+            rpc_arena_free(fh_status);
 
             return wrap_procedure_results_in_successful_accepted_reply(fh_status_size, fh_status_buffer,
                                                                        "mount/FhStatus");
@@ -216,7 +219,7 @@ Rpc__AcceptedReply *serve_mnt_procedure_1_add_mount_entry(Rpc__OpaqueAuth *crede
                 "path '%s' with error code %d\n",
                 directory_absolute_path, error_code);
 
-        mount__dir_path__free_unpacked(dirpath, NULL);
+        mount__dir_path__free_unpacked(dirpath, &rpc_arena_allocator);
 
         // return AcceptedReply with SYSTEM_ERR, as this shouldn't happen once we've checked that the looked up file
         // exists
@@ -242,11 +245,11 @@ Rpc__AcceptedReply *serve_mnt_procedure_1_add_mount_entry(Rpc__OpaqueAuth *crede
     fh_status.directory = &fhandle;
 
     // serialize the procedure results
-    size_t fh_status_size = mount__fh_status__get_packed_size(&fh_status);
-    uint8_t *fh_status_buffer = malloc(fh_status_size);
-    mount__fh_status__pack(&fh_status, fh_status_buffer);
+    size_t fh_status_size = get_rpc_payload_packed_size(codec, &fh_status.base);
+    uint8_t *fh_status_buffer = allocate_rpc_payload_buffer(fh_status_size);
+    pack_rpc_payload(codec, &fh_status.base, fh_status_buffer);
 
-    mount__dir_path__free_unpacked(dirpath, NULL);
+    mount__dir_path__free_unpacked(dirpath, &rpc_arena_allocator);
 
     return wrap_procedure_results_in_successful_accepted_reply(fh_status_size, fh_status_buffer, "mount/FhStatus");
 }
\ No newline at end of file
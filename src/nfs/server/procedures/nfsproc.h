@@ -60,4 +60,14 @@ Rpc__AcceptedReply *serve_nfs_procedure_17_get_filesystem_attributes(Rpc__Opaque
                                                                      Rpc__OpaqueAuth *verifier,
                                                                      Google__Protobuf__Any *parameters);
 
+Rpc__AcceptedReply *serve_nfs_procedure_18_compound(Rpc__OpaqueAuth *credential, Rpc__OpaqueAuth *verifier,
+                                                    Google__Protobuf__Any *parameters);
+
+Rpc__AcceptedReply *serve_nfs_procedure_19_read_from_directory_plus(Rpc__OpaqueAuth *credential,
+                                                                    Rpc__OpaqueAuth *verifier,
+                                                                    Google__Protobuf__Any *parameters);
+
+Rpc__AcceptedReply *serve_nfs_procedure_20_read_from_directory_2(Rpc__OpaqueAuth *credential, Rpc__OpaqueAuth *verifier,
+                                                                 Google__Protobuf__Any *parameters);
+
 #endif /* nfsproc__header__INCLUDED */
\ No newline at end of file
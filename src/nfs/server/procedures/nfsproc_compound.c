@@ -0,0 +1,366 @@
+#include "nfsproc.h"
+
+/*
+ * Parameters of an Nfs procedure that can be run as an operation of a COMPOUND procedure.
+ */
+typedef struct CompoundOperationType {
+    uint32_t procedure_number;
+    const ProtobufCMessageDescriptor *parameters_descriptor;
+    const char *parameters_type_url; // the type URL the procedure expects its parameters to be sent with
+} CompoundOperationType;
+
+/*
+ * COMPOUND runs metadata procedures only - the chains of LOOKUPs, GETATTRs and the like that it saves round trips
+ * for. Each of their results is small, whereas up to NFS_MAX_COMPOUND_OPERATIONS READs, WRITEs or READDIRs could
+ * make a reply of hundreds of MiB, that wouldn't fit in a shared memory ring nor be worth building in the arena.
+ */
+static const CompoundOperationType compound_operation_types[] = {
+    {NFSPROC_GETATTR, &nfs__fhandle__descriptor, "nfs/FHandle"},
+    {NFSPROC_SETATTR, &nfs__sattr_args__descriptor, "nfs/SAttrArgs"},
+    {NFSPROC_LOOKUP, &nfs__dir_op_args__descriptor, "nfs/DirOpArgs"},
+    {NFSPROC_READLINK, &nfs__fhandle__descriptor, "nfs/FHandle"},
+    {NFSPROC_CREATE, &nfs__create_args__descriptor, "nfs/CreateArgs"},
+    {NFSPROC_REMOVE, &nfs__dir_op_args__descriptor, "nfs/DirOpArgs"},
+    {NFSPROC_RENAME, &nfs__rename_args__descriptor, "nfs/RenameArgs"},
+    {NFSPROC_LINK, &nfs__link_args__descriptor, "nfs/LinkArgs"},
+    {NFSPROC_SYMLINK, &nfs__sym_link_args__descriptor, "nfs/SymLinkArgs"},
+    {NFSPROC_MKDIR, &nfs__create_args__descriptor, "nfs/CreateArgs"},
+    {NFSPROC_RMDIR, &nfs__dir_op_args__descriptor, "nfs/DirOpArgs"},
+    {NFSPROC_STATFS, &nfs__fhandle__descriptor, "nfs/FHandle"},
+};
+
+/*
+ * Returns the parameters of the given Nfs procedure, or NULL if the procedure can't be run as an operation of a
+ * COMPOUND procedure.
+ */
+static const CompoundOperationType *get_compound_operation_type(uint32_t procedure_number) {
+    for (size_t i = 0; i < sizeof(compound_operation_types) / sizeof(compound_operation_types[0]); i++) {
+        if (compound_operation_types[i].procedure_number == procedure_number) {
+            return &compound_operation_types[i];
+        }
+    }
+
+    return NULL;
+}
+
+/*
+ * Returns the FHandle in the given procedure parameters that the procedure runs on (the directory for directory
+ * operations, the source for RENAME and LINK, and the file otherwise), or NULL if the parameters don't have it.
+ */
+static Nfs__FHandle *get_operation_fhandle(ProtobufCMessage *parameters) {
+    const ProtobufCMessageDescriptor *descriptor = parameters->descriptor;
+
+    if (descriptor == &nfs__fhandle__descriptor) {
+        return (Nfs__FHandle *)parameters;
+    } else if (descriptor == &nfs__sattr_args__descriptor) {
+        return ((Nfs__SAttrArgs *)parameters)->file;
+    } else if (descriptor == &nfs__dir_op_args__descriptor) {
+        return ((Nfs__DirOpArgs *)parameters)->dir;
+    } else if (descriptor == &nfs__create_args__descriptor) {
+        Nfs__DirOpArgs *where = ((Nfs__CreateArgs *)parameters)->where;
+        return where == NULL ? NULL : where->dir;
+    } else if (descriptor == &nfs__rename_args__descriptor) {
+        Nfs__DirOpArgs *from = ((Nfs__RenameArgs *)parameters)->from;
+        return from == NULL ? NULL : from->dir;
+    } else if (descriptor == &nfs__link_args__descriptor) {
+        return ((Nfs__LinkArgs *)parameters)->from;
+    } else if (descriptor == &nfs__sym_link_args__descriptor) {
+        Nfs__DirOpArgs *from = ((Nfs__SymLinkArgs *)parameters)->from;
+        return from == NULL ? NULL : from->dir;
+    }
+
+    return NULL;
+}
+
+/*
+ * Re-encodes the parameters of the given operation with the current filehandle in place of the FHandle the
+ * procedure runs on, and places their size in 'parameters_size'.
+ *
+ * Returns NULL if the parameters can't be decoded or don't have such an FHandle.
+ *
+ * The user of this function takes the responsibility to free the returned buffer with 'free_rpc_payload_buffer'.
+ */
+static uint8_t *substitute_current_fhandle(RpcCodec codec, Nfs__CompoundOp *operation,
+                                           NfsFh__NfsFileHandle *current_nfs_filehandle, size_t *parameters_size) {
+    const ProtobufCMessageDescriptor *descriptor =
+        get_compound_operation_type(operation->procedure)->parameters_descriptor;
+
+    ProtobufCMessage *parameters = unpack_rpc_payload(codec, descriptor, &rpc_arena_allocator,
+                                                      operation->parameters.len, operation->parameters.data);
+    if (parameters == NULL) {
+        return NULL;
+    }
+    Nfs__FHandle *fhandle = get_operation_fhandle(parameters);
+    if (fhandle == NULL) {
+        protobuf_c_message_free_unpacked(parameters, &rpc_arena_allocator);
+
+        return NULL;
+    }
+
+    NfsFh__NfsFileHandle *operation_nfs_filehandle = fhandle->nfs_filehandle;
+    fhandle->nfs_filehandle = current_nfs_filehandle;
+
+    *parameters_size = get_rpc_payload_packed_size(codec, parameters);
+    uint8_t *parameters_buffer = allocate_rpc_payload_buffer(*parameters_size);
+    if (parameters_buffer != NULL) {
+        pack_rpc_payload(codec, parameters, parameters_buffer);
+    }
+
+    // the current filehandle doesn't belong to the unpacked parameters
+    fhandle->nfs_filehandle = operation_nfs_filehandle;
+    protobuf_c_message_free_unpacked(parameters, &rpc_arena_allocator);
+
+    return parameters_buffer;
+}
+
+/*
+ * Returns the status in the given procedure results of an operation.
+ *
+ * If the operation was a successful LOOKUP, CREATE or MKDIR, the file it returned becomes the current filehandle.
+ */
+static Nfs__Stat get_operation_status(RpcCodec codec, Google__Protobuf__Any *results,
+                                      NfsFh__NfsFileHandle *current_nfs_filehandle) {
+    if (results->type_url == NULL) {
+        return NFS__STAT__NFSERR_IO;
+    }
+
+    const ProtobufCMessageDescriptor *descriptor;
+    if (strcmp(results->type_url, "nfs/NfsStat") == 0) {
+        descriptor = &nfs__nfs_stat__descriptor;
+    } else if (strcmp(results->type_url, "nfs/AttrStat") == 0) {
+        descriptor = &nfs__attr_stat__descriptor;
+    } else if (strcmp(results->type_url, "nfs/DirOpRes") == 0) {
+        descriptor = &nfs__dir_op_res__descriptor;
+    } else if (strcmp(results->type_url, "nfs/ReadLinkRes") == 0) {
+        descriptor = &nfs__read_link_res__descriptor;
+    } else if (strcmp(results->type_url, "nfs/StatFsRes") == 0) {
+        descriptor = &nfs__stat_fs_res__descriptor;
+    } else {
+        return NFS__STAT__NFSERR_IO;
+    }
+
+    ProtobufCMessage *results_message = unpack_rpc_payload(codec, descriptor, &rpc_arena_allocator,
+                                                           results->value.len, results->value.data);
+    if (results_message == NULL) {
+        return NFS__STAT__NFSERR_IO;
+    }
+
+    // every procedure results message starts with its status, apart from NfsStat which is the status itself
+    Nfs__NfsStat *nfs_status;
+    if (descriptor == &nfs__nfs_stat__descriptor) {
+        nfs_status = (Nfs__NfsStat *)results_message;
+    } else if (descriptor == &nfs__attr_stat__descriptor) {
+        nfs_status = ((Nfs__AttrStat *)results_message)->nfs_status;
+    } else if (descriptor == &nfs__dir_op_res__descriptor) {
+        nfs_status = ((Nfs__DirOpRes *)results_message)->nfs_status;
+    } else if (descriptor == &nfs__read_link_res__descriptor) {
+        nfs_status = ((Nfs__ReadLinkRes *)results_message)->nfs_status;
+    } else {
+        nfs_status = ((Nfs__StatFsRes *)results_message)->nfs_status;
+    }
+    Nfs__Stat stat = nfs_status == NULL ? NFS__STAT__NFSERR_IO : nfs_status->stat;
+
+    if (stat == NFS__STAT__NFS_OK && descriptor == &nfs__dir_op_res__descriptor) {
+        Nfs__DirOpRes *diropres = (Nfs__DirOpRes *)results_message;
+        if (diropres->body_case == NFS__DIR_OP_RES__BODY_DIROPOK && diropres->diropok->file != NULL &&
+            diropres->diropok->file->nfs_filehandle != NULL) {
+            current_nfs_filehandle->inode_number = diropres->diropok->file->nfs_filehandle->inode_number;
+            current_nfs_filehandle->timestamp = diropres->diropok->file->nfs_filehandle->timestamp;
+        }
+    }
+
+    protobuf_c_message_free_unpacked(results_message, &rpc_arena_allocator);
+
+    return stat;
+}
+
+/*
+ * Runs a single operation of a COMPOUND procedure by calling its Nfs procedure, and returns its result.
+ *
+ * An operation whose procedure doesn't reply with SUCCESS (e.g. because its parameters were garbage) fails with
+ * NFSERR_IO.
+ *
+ * The user of this function takes the responsibility to free the returned CompoundOpRes, its NfsStat, and its
+ * results, using 'rpc_arena_free'.
+ */
+static Nfs__CompoundOpRes *run_compound_operation(RpcCodec codec, Rpc__OpaqueAuth *credential,
+                                                  Rpc__OpaqueAuth *verifier, Nfs__CompoundOp *operation,
+                                                  NfsFh__NfsFileHandle *current_nfs_filehandle) {
+    Nfs__CompoundOpRes *operation_result = rpc_arena_alloc(sizeof(Nfs__CompoundOpRes));
+    nfs__compound_op_res__init(operation_result);
+    operation_result->procedure = operation->procedure;
+
+    Google__Protobuf__Any parameters = GOOGLE__PROTOBUF__ANY__INIT;
+    parameters.type_url = (char *)get_compound_operation_type(operation->procedure)->parameters_type_url;
+    parameters.value = operation->parameters;
+
+    uint8_t *substituted_parameters_buffer = NULL;
+    if (operation->use_current_fhandle) {
+        substituted_parameters_buffer =
+            substitute_current_fhandle(codec, operation, current_nfs_filehandle, &parameters.value.len);
+        if (substituted_parameters_buffer == NULL) {
+            fprintf(stderr, "run_compound_operation: failed to place the current filehandle in the parameters of "
+                            "procedure %u\n",
+                    operation->procedure);
+
+            operation_result->nfs_status = create_nfs_stat(NFS__STAT__NFSERR_IO);
+
+            return operation_result;
+        }
+        parameters.value.data = substituted_parameters_buffer;
+    }
+
+    Rpc__AcceptedReply *accepted_reply =
+        call_nfs(credential, verifier, NFS_VERSION_LOW, operation->procedure, &parameters);
+    free_rpc_payload_buffer(substituted_parameters_buffer);
+    if (accepted_reply->stat != RPC__ACCEPT_STAT__SUCCESS || accepted_reply->results == NULL) {
+        fprintf(stderr, "run_compound_operation: procedure %u did not reply with SUCCESS\n", operation->procedure);
+
+        free_accepted_reply(accepted_reply);
+
+        operation_result->nfs_status = create_nfs_stat(NFS__STAT__NFSERR_IO);
+
+        return operation_result;
+    }
+
+    Google__Protobuf__Any *results = accepted_reply->results;
+    operation_result->nfs_status = create_nfs_stat(get_operation_status(codec, results, current_nfs_filehandle));
+    if (results->value.len > 0) {
+        operation_result->results.data = rpc_arena_alloc(results->value.len);
+        memcpy(operation_result->results.data, results->value.data, results->value.len);
+        operation_result->results.len = results->value.len;
+    }
+
+    free_accepted_reply(accepted_reply);
+
+    return operation_result;
+}
+
+/*
+ * Runs the NFSPROC_COMPOUND procedure (18), an extension to RFC 1094 in the spirit of the NFSv4 COMPOUND procedure.
+ *
+ * Runs the given operations in order, each one by calling its Nfs procedure, and stops at the first one that fails.
+ * A current filehandle is carried from one operation to the next - it starts out as the FHandle in CompoundArgs, and
+ * becomes the file returned by every successful LOOKUP, CREATE or MKDIR. An operation with 'use_current_fhandle' set
+ * runs on the current filehandle instead of the FHandle in its own parameters. This lets a client resolve a pathname
+ * and run a procedure on the file it finds in a single round trip.
+ *
+ * The results have one entry for every operation that was run, and the status of the last one.
+ *
+ * Unlike other procedures, this one is called without the 'server_state_lock' held, and takes it itself once it knows
+ * which procedures its operations run.
+ *
+ * Takes a RPC credential+verifier pair corresponding to a supported authentication flavor. The provided
+ * credential and verifier must be structurally validated (i.e. no NULL fields and correspond to a supported
+ * authentication flavor) before being passed here. This procedure must not be given AUTH_NONE credential+verifier pair.
+ *
+ * The user of this function takes the responsibility to deallocate the received AcceptedReply
+ * using the 'free_accepted_reply()' function.
+ */
+Rpc__AcceptedReply *serve_nfs_procedure_18_compound(Rpc__OpaqueAuth *credential, Rpc__OpaqueAuth *verifier,
+                                                    Google__Protobuf__Any *parameters) {
+    RpcCodec codec = get_rpc_call_codec();
+
+    // check parameters are of expected type for this procedure
+    if (parameters->type_url == NULL || strcmp(parameters->type_url, "nfs/CompoundArgs") != 0) {
+        fprintf(stderr, "serve_nfs_procedure_18_compound: expected nfs/CompoundArgs but received %s\n",
+                parameters->type_url);
+
+        return create_garbage_args_accepted_reply();
+    }
+
+    // deserialize parameters
+    Nfs__CompoundArgs *compoundargs = unpack_rpc_payload(codec, &nfs__compound_args__descriptor,
+                                                         &rpc_arena_allocator, parameters->value.len,
+                                                         parameters->value.data);
+    if (compoundargs == NULL) {
+        fprintf(stderr, "serve_nfs_procedure_18_compound: failed to unpack CompoundArgs\n");
+
+        return create_garbage_args_accepted_reply();
+    }
+    if (compoundargs->fhandle == NULL) {
+        fprintf(stderr, "serve_nfs_procedure_18_compound: 'fhandle' in CompoundArgs is null\n");
+
+        nfs__compound_args__free_unpacked(compoundargs, &rpc_arena_allocator);
+
+        return create_garbage_args_accepted_reply();
+    }
+    if (compoundargs->fhandle->nfs_filehandle == NULL) {
+        fprintf(stderr, "serve_nfs_procedure_18_compound: FHandle->nfs_filehandle is null\n");
+
+        nfs__compound_args__free_unpacked(compoundargs, &rpc_arena_allocator);
+
+        return create_garbage_args_accepted_reply();
+    }
+    if (compoundargs->n_operations > NFS_MAX_COMPOUND_OPERATIONS) {
+        fprintf(stderr, "serve_nfs_procedure_18_compound: CompoundArgs has %zu operations, more than the maximum %d\n",
+                compoundargs->n_operations, NFS_MAX_COMPOUND_OPERATIONS);
+
+        nfs__compound_args__free_unpacked(compoundargs, &rpc_arena_allocator);
+
+        return create_garbage_args_accepted_reply();
+    }
+    // check all operations before running any, so that garbage arguments never leave the operations half done
+    bool modifies_server_state = false;
+    for (size_t i = 0; i < compoundargs->n_operations; i++) {
+        if (get_compound_operation_type(compoundargs->operations[i]->procedure) == NULL) {
+            fprintf(stderr, "serve_nfs_procedure_18_compound: operation %zu has unsupported procedure %u\n", i,
+                    compoundargs->operations[i]->procedure);
+
+            nfs__compound_args__free_unpacked(compoundargs, &rpc_arena_allocator);
+
+            return create_garbage_args_accepted_reply();
+        }
+
+        modifies_server_state |=
+            procedure_modifies_server_state(NFS_RPC_PROGRAM_NUMBER, compoundargs->operations[i]->procedure);
+    }
+
+    // the operations run under a single hold of the 'server_state_lock', shared unless one of them needs it exclusively
+    if (modifies_server_state) {
+        pthread_rwlock_wrlock(&server_state_lock);
+    } else {
+        pthread_rwlock_rdlock(&server_state_lock);
+    }
+
+    NfsFh__NfsFileHandle current_nfs_filehandle = NFS_FH__NFS_FILE_HANDLE__INIT;
+    current_nfs_filehandle.inode_number = compoundargs->fhandle->nfs_filehandle->inode_number;
+    current_nfs_filehandle.timestamp = compoundargs->fhandle->nfs_filehandle->timestamp;
+
+    // build the procedure results
+    Nfs__CompoundRes compoundres = NFS__COMPOUND_RES__INIT;
+    compoundres.results = rpc_arena_alloc(sizeof(Nfs__CompoundOpRes *) * (compoundargs->n_operations + 1));
+
+    Nfs__Stat stat = NFS__STAT__NFS_OK;
+    for (size_t i = 0; i < compoundargs->n_operations && stat == NFS__STAT__NFS_OK; i++) {
+        Nfs__CompoundOpRes *operation_result =
+            run_compound_operation(codec, credential, verifier, compoundargs->operations[i], &current_nfs_filehandle);
+        compoundres.results[compoundres.n_results++] = operation_result;
+
+        stat = operation_result->nfs_status->stat;
+    }
+
+    pthread_rwlock_unlock(&server_state_lock);
+
+    Nfs__NfsStat nfs_status = NFS__NFS_STAT__INIT;
+    nfs_status.stat = stat;
+    compoundres.nfs_status = &nfs_status;
+
+    // serialize the procedure results
+    size_t compoundres_size = get_rpc_payload_packed_size(codec, &compoundres.base);
+    uint8_t *compoundres_buffer = allocate_rpc_payload_buffer(compoundres_size);
+    pack_rpc_payload(codec, &compoundres.base, compoundres_buffer);
+
+    Rpc__AcceptedReply *accepted_reply =
+        wrap_procedure_results_in_successful_accepted_reply(compoundres_size, compoundres_buffer, "nfs/CompoundRes");
+
+    nfs__compound_args__free_unpacked(compoundargs, &rpc_arena_allocator);
+    for (size_t i = 0; i < compoundres.n_results; i++) {
+        rpc_arena_free(compoundres.results[i]->nfs_status);
+        rpc_arena_free(compoundres.results[i]->results.data);
+        rpc_arena_free(compoundres.results[i]);
+    }
+    rpc_arena_free(compoundres.results);
+
+    return accepted_reply;
+}
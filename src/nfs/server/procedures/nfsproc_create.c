@@ -12,6 +12,8 @@
  */
 Rpc__AcceptedReply *serve_nfs_procedure_9_create_file(Rpc__OpaqueAuth *credential, Rpc__OpaqueAuth *verifier,
                                                       Google__Protobuf__Any *parameters) {
+    RpcCodec codec = get_rpc_call_codec();
+
     // check parameters are of expected type for this procedure
     if (parameters->type_url == NULL || strcmp(parameters->type_url, "nfs/CreateArgs") != 0) {
         fprintf(stderr, "serve_nfs_procedure_9_create_file: expected nfs/CreateArgs but received %s\n",
@@ -21,7 +23,8 @@ Rpc__AcceptedReply *serve_nfs_procedure_9_create_file(Rpc__OpaqueAuth *credentia
     }
 
     // deserialize parameters
-    Nfs__CreateArgs *createargs = nfs__create_args__unpack(NULL, parameters->value.len, parameters->value.data);
+    Nfs__CreateArgs *createargs = unpack_rpc_payload(codec, &nfs__create_args__descriptor, &rpc_arena_allocator,
+                                                     parameters->value.len, parameters->value.data);
     if (createargs == NULL) {
         fprintf(stderr, "serve_nfs_procedure_9_create_file: failed to unpack CreateArgs\n");
 
@@ -30,7 +33,7 @@ Rpc__AcceptedReply *serve_nfs_procedure_9_create_file(Rpc__OpaqueAuth *credentia
     if (createargs->where == NULL) {
         fprintf(stderr, "serve_nfs_procedure_9_create_file: 'where' in CreateArgs is null\n");
 
-        nfs__create_args__free_unpacked(createargs, NULL);
+        nfs__create_args__free_unpacked(createargs, &rpc_arena_allocator);
 
         return create_garbage_args_accepted_reply();
     }
@@ -38,7 +41,7 @@ Rpc__AcceptedReply *serve_nfs_procedure_9_create_file(Rpc__OpaqueAuth *credentia
     if (diropargs->dir == NULL) {
         fprintf(stderr, "serve_nfs_procedure_9_create_file: DirOpArgs->dir is null\n");
 
-        nfs__create_args__free_unpacked(createargs, NULL);
+        nfs__create_args__free_unpacked(createargs, &rpc_arena_allocator);
 
         return create_garbage_args_accepted_reply();
     }
@@ -46,14 +49,14 @@ Rpc__AcceptedReply *serve_nfs_procedure_9_create_file(Rpc__OpaqueAuth *credentia
     if (directory_fhandle->nfs_filehandle == NULL) {
         fprintf(stderr, "serve_nfs_procedure_9_create_file: FHandle->nfs_filehandle is null\n");
 
-        nfs__create_args__free_unpacked(createargs, NULL);
+        nfs__create_args__free_unpacked(createargs, &rpc_arena_allocator);
 
         return create_garbage_args_accepted_reply();
     }
     if (diropargs->name == NULL) {
         fprintf(stderr, "serve_nfs_procedure_9_create_file: DirOpArgs->name is null\n");
 
-        nfs__create_args__free_unpacked(createargs, NULL);
+        nfs__create_args__free_unpacked(createargs, &rpc_arena_allocator);
 
         return create_garbage_args_accepted_reply();
     }
@@ -61,14 +64,14 @@ Rpc__AcceptedReply *serve_nfs_procedure_9_create_file(Rpc__OpaqueAuth *credentia
     if (file_name->filename == NULL) {
         fprintf(stderr, "serve_nfs_procedure_9_create_file: DirOpArgs->name->filename is null\n");
 
-        nfs__create_args__free_unpacked(createargs, NULL);
+        nfs__create_args__free_unpacked(createargs, &rpc_arena_allocator);
 
         return create_garbage_args_accepted_reply();
     }
     if (createargs->attributes == NULL) {
         fprintf(stderr, "serve_nfs_procedure_9_create_file: 'attributes' in CreateArgs is null\n");
 
-        nfs__create_args__free_unpacked(createargs, NULL);
+        nfs__create_args__free_unpacked(createargs, &rpc_arena_allocator);
 
         return create_garbage_args_accepted_reply();
     }
@@ -76,14 +79,14 @@ Rpc__AcceptedReply *serve_nfs_procedure_9_create_file(Rpc__OpaqueAuth *credentia
     if (sattr->atime == NULL) {
         fprintf(stderr, "serve_nfs_procedure_9_create_file: SAttr->atime is null\n");
 
-        nfs__create_args__free_unpacked(createargs, NULL);
+        nfs__create_args__free_unpacked(createargs, &rpc_arena_allocator);
 
         return create_garbage_args_accepted_reply();
     }
     if (sattr->mtime == NULL) {
         fprintf(stderr, "serve_nfs_procedure_9_create_file: SAttr->mtime is null\n");
 
-        nfs__create_args__free_unpacked(createargs, NULL);
+        nfs__create_args__free_unpacked(createargs, &rpc_arena_allocator);
 
         return create_garbage_args_accepted_reply();
     }
@@ -98,20 +101,9 @@ Rpc__AcceptedReply *serve_nfs_procedure_9_create_file(Rpc__OpaqueAuth *credentia
         fprintf(stderr, "serve_nfs_procedure_9_create_file: failed to decode inode number %ld back to a directory\n",
                 inode_number);
 
-        // build the procedure results
-        Nfs__DirOpRes *diropres = create_default_case_dir_op_res(NFS__STAT__NFSERR_NOENT);
-
-        // serialize the procedure results
-        size_t diropres_size = nfs__dir_op_res__get_packed_size(diropres);
-        uint8_t *diropres_buffer = malloc(diropres_size);
-        nfs__dir_op_res__pack(diropres, diropres_buffer);
+        nfs__create_args__free_unpacked(createargs, &rpc_arena_allocator);
 
-        nfs__create_args__free_unpacked(createargs, NULL);
-        free(diropres->nfs_status);
-        free(diropres->default_case);
-        free(diropres);
-
-        return wrap_procedure_results_in_successful_accepted_reply(diropres_size, diropres_buffer, "nfs/DirOpRes");
+        return create_nfs_error_accepted_reply(NFS_RESULTS_DIR_OP_RES, NFS__STAT__NFSERR_NOENT);
     }
 
     // get the attributes of this directory, to check that it is actually a directory
@@ -124,7 +116,7 @@ Rpc__AcceptedReply *serve_nfs_procedure_9_create_file(Rpc__OpaqueAuth *credentia
                 "absolute path '%s' with error code %d\n",
                 directory_absolute_path, error_code);
 
-        nfs__create_args__free_unpacked(createargs, NULL);
+        nfs__create_args__free_unpacked(createargs, &rpc_arena_allocator);
 
         // return AcceptedReply with SYSTEM_ERR, as this shouldn't happen once we've decoded the NFS filehandle for this
         // directory back to its absolute path
@@ -136,21 +128,10 @@ Rpc__AcceptedReply *serve_nfs_procedure_9_create_file(Rpc__OpaqueAuth *credentia
         fprintf(stderr, "serve_nfs_procedure_9_create_file: 'create' procedure called on a non-directory '%s'\n",
                 directory_absolute_path);
 
-        // build the procedure results
-        Nfs__DirOpRes *diropres = create_default_case_dir_op_res(NFS__STAT__NFSERR_NOTDIR);
-
-        // serialize the procedure results
-        size_t diropres_size = nfs__dir_op_res__get_packed_size(diropres);
-        uint8_t *diropres_buffer = malloc(diropres_size);
-        nfs__dir_op_res__pack(diropres, diropres_buffer);
-
         clean_up_fattr(&directory_fattr);
-        nfs__create_args__free_unpacked(createargs, NULL);
-        free(diropres->nfs_status);
-        free(diropres->default_case);
-        free(diropres);
+        nfs__create_args__free_unpacked(createargs, &rpc_arena_allocator);
 
-        return wrap_procedure_results_in_successful_accepted_reply(diropres_size, diropres_buffer, "nfs/DirOpRes");
+        return create_nfs_error_accepted_reply(NFS_RESULTS_DIR_OP_RES, NFS__STAT__NFSERR_NOTDIR);
     }
     clean_up_fattr(&directory_fattr);
 
@@ -161,20 +142,9 @@ Rpc__AcceptedReply *serve_nfs_procedure_9_create_file(Rpc__OpaqueAuth *credentia
                 "than NFS limit\n",
                 directory_absolute_path);
 
-        // build the procedure results
-        Nfs__DirOpRes *diropres = create_default_case_dir_op_res(NFS__STAT__NFSERR_NAMETOOLONG);
-
-        // serialize the procedure results
-        size_t diropres_size = nfs__dir_op_res__get_packed_size(diropres);
-        uint8_t *diropres_buffer = malloc(diropres_size);
-        nfs__dir_op_res__pack(diropres, diropres_buffer);
-
-        nfs__create_args__free_unpacked(createargs, NULL);
-        free(diropres->nfs_status);
-        free(diropres->default_case);
-        free(diropres);
+        nfs__create_args__free_unpacked(createargs, &rpc_arena_allocator);
 
-        return wrap_procedure_results_in_successful_accepted_reply(diropres_size, diropres_buffer, "nfs/DirOpRes");
+        return create_nfs_error_accepted_reply(NFS_RESULTS_DIR_OP_RES, NFS__STAT__NFSERR_NAMETOOLONG);
     }
 
     // check if the file client wants to create already exists
@@ -185,21 +155,10 @@ Rpc__AcceptedReply *serve_nfs_procedure_9_create_file(Rpc__OpaqueAuth *credentia
         fprintf(stderr, "serve_nfs_procedure_9_create_file: attempted to create a file '%s' that already exists\n",
                 file_absolute_path);
 
-        // build the procedure results
-        Nfs__DirOpRes *diropres = create_default_case_dir_op_res(NFS__STAT__NFSERR_EXIST);
-
-        // serialize the procedure results
-        size_t diropres_size = nfs__dir_op_res__get_packed_size(diropres);
-        uint8_t *diropres_buffer = malloc(diropres_size);
-        nfs__dir_op_res__pack(diropres, diropres_buffer);
-
         free(file_absolute_path);
-        nfs__create_args__free_unpacked(createargs, NULL);
-        free(diropres->nfs_status);
-        free(diropres->default_case);
-        free(diropres);
+        nfs__create_args__free_unpacked(createargs, &rpc_arena_allocator);
 
-        return wrap_procedure_results_in_successful_accepted_reply(diropres_size, diropres_buffer, "nfs/DirOpRes");
+        return create_nfs_error_accepted_reply(NFS_RESULTS_DIR_OP_RES, NFS__STAT__NFSERR_EXIST);
     } else if (errno != ENOENT) {
         // we got an error different from 'ENOENT = No such file or directory'
         perror_msg("serve_nfs_procedure_9_create_file: failed checking if file to be created at absolute path '%s' "
@@ -207,7 +166,7 @@ Rpc__AcceptedReply *serve_nfs_procedure_9_create_file(Rpc__OpaqueAuth *credentia
                    file_absolute_path);
 
         free(file_absolute_path);
-        nfs__create_args__free_unpacked(createargs, NULL);
+        nfs__create_args__free_unpacked(createargs, &rpc_arena_allocator);
 
         return create_system_error_accepted_reply();
     }
@@ -224,33 +183,25 @@ Rpc__AcceptedReply *serve_nfs_procedure_9_create_file(Rpc__OpaqueAuth *credentia
                     file_absolute_path, stat);
 
             free(file_absolute_path);
-            nfs__create_args__free_unpacked(createargs, NULL);
+            nfs__create_args__free_unpacked(createargs, &rpc_arena_allocator);
 
             return create_system_error_accepted_reply();
         }
 
         // client does not have correct permission to create a file
         if (stat == 1) {
-            // build the procedure results
-            Nfs__DirOpRes *diropres = create_default_case_dir_op_res(NFS__STAT__NFSERR_ACCES);
-
-            // serialize the procedure results
-            size_t diropres_size = nfs__dir_op_res__get_packed_size(diropres);
-            uint8_t *diropres_buffer = malloc(diropres_size);
-            nfs__dir_op_res__pack(diropres, diropres_buffer);
-
             free(file_absolute_path);
-            nfs__create_args__free_unpacked(createargs, NULL);
-            free(diropres->nfs_status);
-            free(diropres->default_case);
-            free(diropres);
+            nfs__create_args__free_unpacked(createargs, &rpc_arena_allocator);
 
-            return wrap_procedure_results_in_successful_accepted_reply(diropres_size, diropres_buffer, "nfs/DirOpRes");
+            return create_nfs_error_accepted_reply(NFS_RESULTS_DIR_OP_RES, NFS__STAT__NFSERR_ACCES);
         }
     }
     // there's no other supported authentication flavor yet (this function only receives credential+verifier pairs with
     // supported authentication flavor)
 
+    // the cached GETATTR results of the directory are stale once a file is created in it
+    invalidate_cached_attr_stat(&attributes_cache, inode_number);
+
     // create the file
     int fd;
     if (sattr->mode != -1) {
@@ -292,27 +243,16 @@ Rpc__AcceptedReply *serve_nfs_procedure_9_create_file(Rpc__OpaqueAuth *credentia
                 break;
             }
 
-            // build the procedure results
-            Nfs__DirOpRes *diropres = create_default_case_dir_op_res(nfs_stat);
-
-            // serialize the procedure results
-            size_t diropres_size = nfs__dir_op_res__get_packed_size(diropres);
-            uint8_t *diropres_buffer = malloc(diropres_size);
-            nfs__dir_op_res__pack(diropres, diropres_buffer);
-
             free(file_absolute_path);
-            nfs__create_args__free_unpacked(createargs, NULL);
-            free(diropres->nfs_status);
-            free(diropres->default_case);
-            free(diropres);
+            nfs__create_args__free_unpacked(createargs, &rpc_arena_allocator);
 
-            return wrap_procedure_results_in_successful_accepted_reply(diropres_size, diropres_buffer, "nfs/DirOpRes");
+            return create_nfs_error_accepted_reply(NFS_RESULTS_DIR_OP_RES, nfs_stat);
         } else {
             perror_msg("serve_nfs_procedure_9_create_file: failed creating file at absolute path '%s'\n",
                        file_absolute_path);
 
             free(file_absolute_path);
-            nfs__create_args__free_unpacked(createargs, NULL);
+            nfs__create_args__free_unpacked(createargs, &rpc_arena_allocator);
 
             return create_system_error_accepted_reply();
         }
@@ -327,7 +267,7 @@ Rpc__AcceptedReply *serve_nfs_procedure_9_create_file(Rpc__OpaqueAuth *credentia
                    file_absolute_path);
 
         free(file_absolute_path);
-        nfs__create_args__free_unpacked(createargs, NULL);
+        nfs__create_args__free_unpacked(createargs, &rpc_arena_allocator);
 
         return create_system_error_accepted_reply();
     }
@@ -337,7 +277,7 @@ Rpc__AcceptedReply *serve_nfs_procedure_9_create_file(Rpc__OpaqueAuth *credentia
                    file_absolute_path);
 
         free(file_absolute_path);
-        nfs__create_args__free_unpacked(createargs, NULL);
+        nfs__create_args__free_unpacked(createargs, &rpc_arena_allocator);
 
         return create_system_error_accepted_reply();
     }
@@ -355,7 +295,7 @@ Rpc__AcceptedReply *serve_nfs_procedure_9_create_file(Rpc__OpaqueAuth *credentia
                        file_absolute_path);
 
             free(file_absolute_path);
-            nfs__create_args__free_unpacked(createargs, NULL);
+            nfs__create_args__free_unpacked(createargs, &rpc_arena_allocator);
 
             return create_system_error_accepted_reply();
         }
@@ -370,7 +310,7 @@ Rpc__AcceptedReply *serve_nfs_procedure_9_create_file(Rpc__OpaqueAuth *credentia
                 file_absolute_path, error_code);
 
         free(file_absolute_path);
-        nfs__create_args__free_unpacked(createargs, NULL);
+        nfs__create_args__free_unpacked(createargs, &rpc_arena_allocator);
 
         // return AcceptedReply with SYSTEM_ERR, as once we've created the file we have to be able to create a NFS
         // filehandle for it
@@ -387,11 +327,10 @@ Rpc__AcceptedReply *serve_nfs_procedure_9_create_file(Rpc__OpaqueAuth *credentia
                 "with error code %d\n",
                 file_absolute_path, error_code);
 
-        nfs__create_args__free_unpacked(createargs, NULL);
+        nfs__create_args__free_unpacked(createargs, &rpc_arena_allocator);
         free(file_absolute_path);
-        // remove the inode cache mapping for the created file that we created when creating the NFS filehandle, as
-        // CREATE was unsuccessful
-        remove_inode_mapping_by_inode_number(file_nfs_filehandle->inode_number, &inode_cache);
+        // the inode cache mapping for the created file is kept, as the file exists and other procedures sharing the
+        // 'server_state_lock' may already be using its NFS filehandle
 
         // return AcceptedReply with SYSTEM_ERR, as this shouldn't happen once we've decoded the NFS filehandle for this
         // file back to its absolute path
@@ -417,14 +356,14 @@ Rpc__AcceptedReply *serve_nfs_procedure_9_create_file(Rpc__OpaqueAuth *credentia
     diropres.diropok = &diropok;
 
     // serialize the procedure results
-    size_t diropres_size = nfs__dir_op_res__get_packed_size(&diropres);
-    uint8_t *diropres_buffer = malloc(diropres_size);
-    nfs__dir_op_res__pack(&diropres, diropres_buffer);
+    size_t diropres_size = get_rpc_payload_packed_size(codec, &diropres.base);
+    uint8_t *diropres_buffer = allocate_rpc_payload_buffer(diropres_size);
+    pack_rpc_payload(codec, &diropres.base, diropres_buffer);
 
     Rpc__AcceptedReply *accepted_reply =
         wrap_procedure_results_in_successful_accepted_reply(diropres_size, diropres_buffer, "nfs/DirOpRes");
 
-    nfs__create_args__free_unpacked(createargs, NULL);
+    nfs__create_args__free_unpacked(createargs, &rpc_arena_allocator);
 
     clean_up_fattr(&fattr);
 
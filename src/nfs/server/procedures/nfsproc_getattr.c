@@ -12,6 +12,8 @@
  */
 Rpc__AcceptedReply *serve_nfs_procedure_1_get_file_attributes(Rpc__OpaqueAuth *credential, Rpc__OpaqueAuth *verifier,
                                                               Google__Protobuf__Any *parameters) {
+    RpcCodec codec = get_rpc_call_codec();
+
     // check parameters are of expected type for this procedure
     if (parameters->type_url == NULL || strcmp(parameters->type_url, "nfs/FHandle") != 0) {
         fprintf(stderr, "serve_nfs_procedure_1_get_file_attributes: expected nfs/FHandle but received %s\n",
@@ -21,7 +23,8 @@ Rpc__AcceptedReply *serve_nfs_procedure_1_get_file_attributes(Rpc__OpaqueAuth *c
     }
 
     // deserialize parameters
-    Nfs__FHandle *fhandle = nfs__fhandle__unpack(NULL, parameters->value.len, parameters->value.data);
+    Nfs__FHandle *fhandle = unpack_rpc_payload(codec, &nfs__fhandle__descriptor, &rpc_arena_allocator,
+                                               parameters->value.len, parameters->value.data);
     if (fhandle == NULL) {
         fprintf(stderr, "serve_nfs_procedure_1_get_file_attributes: failed to unpack FHandle\n");
 
@@ -30,7 +33,7 @@ Rpc__AcceptedReply *serve_nfs_procedure_1_get_file_attributes(Rpc__OpaqueAuth *c
     if (fhandle->nfs_filehandle == NULL) {
         fprintf(stderr, "serve_nfs_procedure_1_get_file_attributes: FHandle->nfs_filehandle is null\n");
 
-        nfs__fhandle__free_unpacked(fhandle, NULL);
+        nfs__fhandle__free_unpacked(fhandle, &rpc_arena_allocator);
 
         return create_garbage_args_accepted_reply();
     }
@@ -47,20 +50,9 @@ Rpc__AcceptedReply *serve_nfs_procedure_1_get_file_attributes(Rpc__OpaqueAuth *c
             "serve_nfs_procedure_1_get_file_attributes: failed to decode inode number %ld back to a file/directory\n",
             inode_number);
 
-        // build the procedure results
-        Nfs__AttrStat *attr_stat = create_default_case_attr_stat(NFS__STAT__NFSERR_NOENT);
-
-        // serialize the procedure results
-        size_t attr_stat_size = nfs__attr_stat__get_packed_size(attr_stat);
-        uint8_t *attr_stat_buffer = malloc(attr_stat_size);
-        nfs__attr_stat__pack(attr_stat, attr_stat_buffer);
-
-        nfs__fhandle__free_unpacked(fhandle, NULL);
-        free(attr_stat->nfs_status);
-        free(attr_stat->default_case);
-        free(attr_stat);
+        nfs__fhandle__free_unpacked(fhandle, &rpc_arena_allocator);
 
-        return wrap_procedure_results_in_successful_accepted_reply(attr_stat_size, attr_stat_buffer, "nfs/AttrStat");
+        return create_nfs_error_accepted_reply(NFS_RESULTS_ATTR_STAT, NFS__STAT__NFSERR_NOENT);
     }
 
     // check permissions
@@ -73,42 +65,51 @@ Rpc__AcceptedReply *serve_nfs_procedure_1_get_file_attributes(Rpc__OpaqueAuth *c
                     "at absolute path '%s' with error code %d\n",
                     file_absolute_path, stat);
 
-            nfs__fhandle__free_unpacked(fhandle, NULL);
+            nfs__fhandle__free_unpacked(fhandle, &rpc_arena_allocator);
 
             return create_system_error_accepted_reply();
         }
 
         // client does not have correct permission to get attributes of this file/directory
         if (stat == 1) {
-            // build the procedure results
-            Nfs__AttrStat *attr_stat = create_default_case_attr_stat(NFS__STAT__NFSERR_ACCES);
-
-            // serialize the procedure results
-            size_t attr_stat_size = nfs__attr_stat__get_packed_size(attr_stat);
-            uint8_t *attr_stat_buffer = malloc(attr_stat_size);
-            nfs__attr_stat__pack(attr_stat, attr_stat_buffer);
+            nfs__fhandle__free_unpacked(fhandle, &rpc_arena_allocator);
 
-            nfs__fhandle__free_unpacked(fhandle, NULL);
-            free(attr_stat->nfs_status);
-            free(attr_stat->default_case);
-            free(attr_stat);
-
-            return wrap_procedure_results_in_successful_accepted_reply(attr_stat_size, attr_stat_buffer,
-                                                                       "nfs/AttrStat");
+            return create_nfs_error_accepted_reply(NFS_RESULTS_ATTR_STAT, NFS__STAT__NFSERR_ACCES);
         }
     }
     // there's no other supported authentication flavor yet (this function only receives credential+verifier pairs with
     // supported authentication flavor)
 
+    struct stat file_stat;
+    if (lstat(file_absolute_path, &file_stat) < 0) {
+        perror_msg("serve_nfs_procedure_1_get_file_attributes: failed retrieving file stats for file/directory at "
+                   "absolute path '%s'",
+                   file_absolute_path);
+
+        nfs__fhandle__free_unpacked(fhandle, &rpc_arena_allocator);
+
+        // we return AcceptedReply with SYSTEM_ERR, as this shouldn't happen once we've decoded inode number to a file
+        return create_system_error_accepted_reply();
+    }
+
+    // the results are the same for as long as the stats of the file are, so they're reused while it stays unchanged
+    uint8_t *attr_stat_buffer;
+    size_t attr_stat_size;
+    if (get_cached_attr_stat(&attributes_cache, codec, &file_stat, &attr_stat_buffer, &attr_stat_size) == 0) {
+        nfs__fhandle__free_unpacked(fhandle, &rpc_arena_allocator);
+
+        return wrap_procedure_results_in_successful_accepted_reply(attr_stat_size, attr_stat_buffer, "nfs/AttrStat");
+    }
+
     Nfs__FAttr fattr = NFS__FATTR__INIT;
-    int error_code = get_attributes(file_absolute_path, &fattr);
+    int error_code = get_attributes_from_stat(&file_stat, &fattr);
     if (error_code > 0) {
         fprintf(stderr,
                 "serve_nfs_procedure_1_get_file_attributes: failed getting attributes for file/directory at absolute "
                 "path '%s' with error code %d\n",
                 file_absolute_path, error_code);
 
-        nfs__fhandle__free_unpacked(fhandle, NULL);
+        nfs__fhandle__free_unpacked(fhandle, &rpc_arena_allocator);
 
         // we return AcceptedReply with SYSTEM_ERR, as this shouldn't happen once we've decoded inode number to a file
         return create_system_error_accepted_reply();
@@ -125,14 +126,16 @@ Rpc__AcceptedReply *serve_nfs_procedure_1_get_file_attributes(Rpc__OpaqueAuth *c
     attr_stat.attributes = &fattr;
 
     // serialize the procedure results
-    size_t attr_stat_size = nfs__attr_stat__get_packed_size(&attr_stat);
-    uint8_t *attr_stat_buffer = malloc(attr_stat_size);
-    nfs__attr_stat__pack(&attr_stat, attr_stat_buffer);
+    attr_stat_size = get_rpc_payload_packed_size(codec, &attr_stat.base);
+    attr_stat_buffer = allocate_rpc_payload_buffer(attr_stat_size);
+    pack_rpc_payload(codec, &attr_stat.base, attr_stat_buffer);
+
+    add_cached_attr_stat(&attributes_cache, codec, &file_stat, attr_stat_buffer, attr_stat_size);
 
     Rpc__AcceptedReply *accepted_reply =
         wrap_procedure_results_in_successful_accepted_reply(attr_stat_size, attr_stat_buffer, "nfs/AttrStat");
 
-    nfs__fhandle__free_unpacked(fhandle, NULL);
+    nfs__fhandle__free_unpacked(fhandle, &rpc_arena_allocator);
 
     clean_up_fattr(&fattr);
 
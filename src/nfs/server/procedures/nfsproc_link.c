@@ -12,6 +12,8 @@
  */
 Rpc__AcceptedReply *serve_nfs_procedure_12_create_link_to_file(Rpc__OpaqueAuth *credential, Rpc__OpaqueAuth *verifier,
                                                                Google__Protobuf__Any *parameters) {
+    RpcCodec codec = get_rpc_call_codec();
+
     // check parameters are of expected type for this procedure
     if (parameters->type_url == NULL || strcmp(parameters->type_url, "nfs/LinkArgs") != 0) {
         fprintf(stderr, "serve_nfs_procedure_12_create_link_to_file: expected nfs/LinkArgs but received %s\n",
@@ -21,7 +23,8 @@ Rpc__AcceptedReply *serve_nfs_procedure_12_create_link_to_file(Rpc__OpaqueAuth *
     }
 
     // deserialize parameters
-    Nfs__LinkArgs *linkargs = nfs__link_args__unpack(NULL, parameters->value.len, parameters->value.data);
+    Nfs__LinkArgs *linkargs = unpack_rpc_payload(codec, &nfs__link_args__descriptor, &rpc_arena_allocator,
+                                                 parameters->value.len, parameters->value.data);
     if (linkargs == NULL) {
         fprintf(stderr, "serve_nfs_procedure_12_create_link_to_file: failed to unpack LinkArgs\n");
 
@@ -30,7 +33,7 @@ Rpc__AcceptedReply *serve_nfs_procedure_12_create_link_to_file(Rpc__OpaqueAuth *
     if (linkargs->from == NULL) {
         fprintf(stderr, "serve_nfs_procedure_12_create_link_to_file: 'from' in LinkArgs is null\n");
 
-        nfs__link_args__free_unpacked(linkargs, NULL);
+        nfs__link_args__free_unpacked(linkargs, &rpc_arena_allocator);
 
         return create_garbage_args_accepted_reply();
     }
@@ -38,14 +41,14 @@ Rpc__AcceptedReply *serve_nfs_procedure_12_create_link_to_file(Rpc__OpaqueAuth *
     if (target_file_fhandle->nfs_filehandle == NULL) {
         fprintf(stderr, "serve_nfs_procedure_12_create_link_to_file: FHandle->nfs_filehandle is null\n");
 
-        nfs__link_args__free_unpacked(linkargs, NULL);
+        nfs__link_args__free_unpacked(linkargs, &rpc_arena_allocator);
 
         return create_garbage_args_accepted_reply();
     }
     if (linkargs->to == NULL) {
         fprintf(stderr, "serve_nfs_procedure_12_create_link_to_file: 'to' in LinkArgs is null\n");
 
-        nfs__link_args__free_unpacked(linkargs, NULL);
+        nfs__link_args__free_unpacked(linkargs, &rpc_arena_allocator);
 
         return create_garbage_args_accepted_reply();
     }
@@ -53,7 +56,7 @@ Rpc__AcceptedReply *serve_nfs_procedure_12_create_link_to_file(Rpc__OpaqueAuth *
     if (to->dir == NULL) {
         fprintf(stderr, "serve_nfs_procedure_12_create_link_to_file: DirOpArgs->dir is null\n");
 
-        nfs__link_args__free_unpacked(linkargs, NULL);
+        nfs__link_args__free_unpacked(linkargs, &rpc_arena_allocator);
 
         return create_garbage_args_accepted_reply();
     }
@@ -61,14 +64,14 @@ Rpc__AcceptedReply *serve_nfs_procedure_12_create_link_to_file(Rpc__OpaqueAuth *
     if (directory_fhandle->nfs_filehandle == NULL) {
         fprintf(stderr, "serve_nfs_procedure_12_create_link_to_file: FHandle->nfs_filehandle is null\n");
 
-        nfs__link_args__free_unpacked(linkargs, NULL);
+        nfs__link_args__free_unpacked(linkargs, &rpc_arena_allocator);
 
         return create_garbage_args_accepted_reply();
     }
     if (to->name == NULL) {
         fprintf(stderr, "serve_nfs_procedure_12_create_link_to_file: DirOpArgs->name is null\n");
 
-        nfs__link_args__free_unpacked(linkargs, NULL);
+        nfs__link_args__free_unpacked(linkargs, &rpc_arena_allocator);
 
         return create_garbage_args_accepted_reply();
     }
@@ -76,7 +79,7 @@ Rpc__AcceptedReply *serve_nfs_procedure_12_create_link_to_file(Rpc__OpaqueAuth *
     if (file_name->filename == NULL) {
         fprintf(stderr, "serve_nfs_procedure_12_create_link_to_file: DirOpArgs->name->filename is null\n");
 
-        nfs__link_args__free_unpacked(linkargs, NULL);
+        nfs__link_args__free_unpacked(linkargs, &rpc_arena_allocator);
 
         return create_garbage_args_accepted_reply();
     }
@@ -92,18 +95,9 @@ Rpc__AcceptedReply *serve_nfs_procedure_12_create_link_to_file(Rpc__OpaqueAuth *
                 "serve_nfs_procedure_12_create_link_to_file: failed to decode inode number %ld back to a file\n",
                 target_file_inode_number);
 
-        // build the procedure results
-        Nfs__NfsStat *nfs_status = create_nfs_stat(NFS__STAT__NFSERR_NOENT);
-
-        // serialize the procedure results
-        size_t nfsstat_size = nfs__nfs_stat__get_packed_size(nfs_status);
-        uint8_t *nfsstat_buffer = malloc(nfsstat_size);
-        nfs__nfs_stat__pack(nfs_status, nfsstat_buffer);
-
-        nfs__link_args__free_unpacked(linkargs, NULL);
-        free(nfs_status);
+        nfs__link_args__free_unpacked(linkargs, &rpc_arena_allocator);
 
-        return wrap_procedure_results_in_successful_accepted_reply(nfsstat_size, nfsstat_buffer, "nfs/NfsStat");
+        return create_nfs_error_accepted_reply(NFS_RESULTS_NFS_STAT, NFS__STAT__NFSERR_NOENT);
     }
 
     // get the attributes of the looked up file before creating a hard link to it, to check that the file is a regular
@@ -117,7 +111,7 @@ Rpc__AcceptedReply *serve_nfs_procedure_12_create_link_to_file(Rpc__OpaqueAuth *
                 "path '%s' with error code %d\n",
                 target_file_absolute_path, error_code);
 
-        nfs__link_args__free_unpacked(linkargs, NULL);
+        nfs__link_args__free_unpacked(linkargs, &rpc_arena_allocator);
 
         // return AcceptedReply with SYSTEM_ERR, as this shouldn't happen once we've decoded the NFS filehandle for this
         // file back to its absolute path
@@ -131,19 +125,10 @@ Rpc__AcceptedReply *serve_nfs_procedure_12_create_link_to_file(Rpc__OpaqueAuth *
                 "'link' which is only possible for regular files\n",
                 target_file_absolute_path);
 
-        // build the procedure results
-        Nfs__NfsStat *nfs_status = create_nfs_stat(NFS__STAT__NFSERR_ISDIR);
-
-        // serialize the procedure results
-        size_t nfsstat_size = nfs__nfs_stat__get_packed_size(nfs_status);
-        uint8_t *nfsstat_buffer = malloc(nfsstat_size);
-        nfs__nfs_stat__pack(nfs_status, nfsstat_buffer);
-
         clean_up_fattr(&target_file_fattr);
-        nfs__link_args__free_unpacked(linkargs, NULL);
-        free(nfs_status);
+        nfs__link_args__free_unpacked(linkargs, &rpc_arena_allocator);
 
-        return wrap_procedure_results_in_successful_accepted_reply(nfsstat_size, nfsstat_buffer, "nfs/NfsStat");
+        return create_nfs_error_accepted_reply(NFS_RESULTS_NFS_STAT, NFS__STAT__NFSERR_ISDIR);
     }
     clean_up_fattr(&target_file_fattr);
 
@@ -158,18 +143,9 @@ Rpc__AcceptedReply *serve_nfs_procedure_12_create_link_to_file(Rpc__OpaqueAuth *
                 "serve_nfs_procedure_12_create_link_to_file: failed to decode inode number %ld back to a directory\n",
                 inode_number);
 
-        // build the procedure results
-        Nfs__NfsStat *nfs_status = create_nfs_stat(NFS__STAT__NFSERR_NOENT);
+        nfs__link_args__free_unpacked(linkargs, &rpc_arena_allocator);
 
-        // serialize the procedure results
-        size_t nfsstat_size = nfs__nfs_stat__get_packed_size(nfs_status);
-        uint8_t *nfsstat_buffer = malloc(nfsstat_size);
-        nfs__nfs_stat__pack(nfs_status, nfsstat_buffer);
-
-        nfs__link_args__free_unpacked(linkargs, NULL);
-        free(nfs_status);
-
-        return wrap_procedure_results_in_successful_accepted_reply(nfsstat_size, nfsstat_buffer, "nfs/NfsStat");
+        return create_nfs_error_accepted_reply(NFS_RESULTS_NFS_STAT, NFS__STAT__NFSERR_NOENT);
     }
 
     // get the attributes of this directory, to check that it is actually a directory
@@ -182,7 +158,7 @@ Rpc__AcceptedReply *serve_nfs_procedure_12_create_link_to_file(Rpc__OpaqueAuth *
                 "file/directory at absolute path '%s' with error code %d\n",
                 directory_absolute_path, error_code);
 
-        nfs__link_args__free_unpacked(linkargs, NULL);
+        nfs__link_args__free_unpacked(linkargs, &rpc_arena_allocator);
 
         // return AcceptedReply with SYSTEM_ERR, as this shouldn't happen once we've decoded the NFS filehandle for this
         // directory back to its absolute path
@@ -193,19 +169,10 @@ Rpc__AcceptedReply *serve_nfs_procedure_12_create_link_to_file(Rpc__OpaqueAuth *
         fprintf(stderr, "serve_nfs_procedure_12_create_link_to_file: 'link' procedure called on a non-directory '%s'\n",
                 directory_absolute_path);
 
-        // build the procedure results
-        Nfs__NfsStat *nfs_status = create_nfs_stat(NFS__STAT__NFSERR_NOTDIR);
-
-        // serialize the procedure results
-        size_t nfsstat_size = nfs__nfs_stat__get_packed_size(nfs_status);
-        uint8_t *nfsstat_buffer = malloc(nfsstat_size);
-        nfs__nfs_stat__pack(nfs_status, nfsstat_buffer);
-
         clean_up_fattr(&directory_fattr);
-        nfs__link_args__free_unpacked(linkargs, NULL);
-        free(nfs_status);
+        nfs__link_args__free_unpacked(linkargs, &rpc_arena_allocator);
 
-        return wrap_procedure_results_in_successful_accepted_reply(nfsstat_size, nfsstat_buffer, "nfs/NfsStat");
+        return create_nfs_error_accepted_reply(NFS_RESULTS_NFS_STAT, NFS__STAT__NFSERR_NOTDIR);
     }
     clean_up_fattr(&directory_fattr);
 
@@ -216,18 +183,9 @@ Rpc__AcceptedReply *serve_nfs_procedure_12_create_link_to_file(Rpc__OpaqueAuth *
                 "file name longer than NFS limit\n",
                 directory_absolute_path);
 
-        // build the procedure results
-        Nfs__NfsStat *nfs_status = create_nfs_stat(NFS__STAT__NFSERR_NAMETOOLONG);
+        nfs__link_args__free_unpacked(linkargs, &rpc_arena_allocator);
 
-        // serialize the procedure results
-        size_t nfsstat_size = nfs__nfs_stat__get_packed_size(nfs_status);
-        uint8_t *nfsstat_buffer = malloc(nfsstat_size);
-        nfs__nfs_stat__pack(nfs_status, nfsstat_buffer);
-
-        nfs__link_args__free_unpacked(linkargs, NULL);
-        free(nfs_status);
-
-        return wrap_procedure_results_in_successful_accepted_reply(nfsstat_size, nfsstat_buffer, "nfs/NfsStat");
+        return create_nfs_error_accepted_reply(NFS_RESULTS_NFS_STAT, NFS__STAT__NFSERR_NAMETOOLONG);
     }
 
     // check if the file client wants to create already exists
@@ -240,19 +198,10 @@ Rpc__AcceptedReply *serve_nfs_procedure_12_create_link_to_file(Rpc__OpaqueAuth *
                 "that absolute path already exists\n",
                 file_absolute_path);
 
-        // build the procedure results
-        Nfs__NfsStat *nfs_status = create_nfs_stat(NFS__STAT__NFSERR_EXIST);
-
-        // serialize the procedure results
-        size_t nfsstat_size = nfs__nfs_stat__get_packed_size(nfs_status);
-        uint8_t *nfsstat_buffer = malloc(nfsstat_size);
-        nfs__nfs_stat__pack(nfs_status, nfsstat_buffer);
-
         free(file_absolute_path);
-        nfs__link_args__free_unpacked(linkargs, NULL);
-        free(nfs_status);
+        nfs__link_args__free_unpacked(linkargs, &rpc_arena_allocator);
 
-        return wrap_procedure_results_in_successful_accepted_reply(nfsstat_size, nfsstat_buffer, "nfs/NfsStat");
+        return create_nfs_error_accepted_reply(NFS_RESULTS_NFS_STAT, NFS__STAT__NFSERR_EXIST);
     } else if (errno != ENOENT) {
         // we got an error different from 'ENOENT = No such file or directory'
         perror_msg("serve_nfs_procedure_12_create_link_to_file: failed checking if hard link to be created at absolute "
@@ -260,7 +209,7 @@ Rpc__AcceptedReply *serve_nfs_procedure_12_create_link_to_file(Rpc__OpaqueAuth *
                    file_absolute_path);
 
         free(file_absolute_path);
-        nfs__link_args__free_unpacked(linkargs, NULL);
+        nfs__link_args__free_unpacked(linkargs, &rpc_arena_allocator);
 
         return create_system_error_accepted_reply();
     }
@@ -277,31 +226,27 @@ Rpc__AcceptedReply *serve_nfs_procedure_12_create_link_to_file(Rpc__OpaqueAuth *
                     file_absolute_path, target_file_absolute_path, stat);
 
             free(file_absolute_path);
-            nfs__link_args__free_unpacked(linkargs, NULL);
+            nfs__link_args__free_unpacked(linkargs, &rpc_arena_allocator);
 
             return create_system_error_accepted_reply();
         }
 
         // client does not have correct permission to create this hard link
         if (stat == 1) {
-            // build the procedure results
-            Nfs__NfsStat *nfs_status = create_nfs_stat(NFS__STAT__NFSERR_ACCES);
-
-            // serialize the procedure results
-            size_t nfsstat_size = nfs__nfs_stat__get_packed_size(nfs_status);
-            uint8_t *nfsstat_buffer = malloc(nfsstat_size);
-            nfs__nfs_stat__pack(nfs_status, nfsstat_buffer);
-
             free(file_absolute_path);
-            nfs__link_args__free_unpacked(linkargs, NULL);
-            free(nfs_status);
+            nfs__link_args__free_unpacked(linkargs, &rpc_arena_allocator);
 
-            return wrap_procedure_results_in_successful_accepted_reply(nfsstat_size, nfsstat_buffer, "nfs/NfsStat");
+            return create_nfs_error_accepted_reply(NFS_RESULTS_NFS_STAT, NFS__STAT__NFSERR_ACCES);
         }
     }
     // there's no other supported authentication flavor yet (this function only receives credential+verifier pairs with
     // supported authentication flavor)
 
+    // the cached GETATTR results of the directory and of the target file (whose link count grows) are stale once the
+    // link is created
+    invalidate_cached_attr_stat(&attributes_cache, inode_number);
+    invalidate_cached_attr_stat(&attributes_cache, target_file_inode_number);
+
     // create the hard link
     error_code = link(target_file_absolute_path, file_absolute_path);
     if (error_code < 0) {
@@ -354,26 +299,17 @@ Rpc__AcceptedReply *serve_nfs_procedure_12_create_link_to_file(Rpc__OpaqueAuth *
                 break;
             }
 
-            // build the procedure results
-            Nfs__NfsStat *nfs_status = create_nfs_stat(nfs_stat);
-
-            // serialize the procedure results
-            size_t nfsstat_size = nfs__nfs_stat__get_packed_size(nfs_status);
-            uint8_t *nfsstat_buffer = malloc(nfsstat_size);
-            nfs__nfs_stat__pack(nfs_status, nfsstat_buffer);
-
             free(file_absolute_path);
-            nfs__link_args__free_unpacked(linkargs, NULL);
-            free(nfs_status);
+            nfs__link_args__free_unpacked(linkargs, &rpc_arena_allocator);
 
-            return wrap_procedure_results_in_successful_accepted_reply(nfsstat_size, nfsstat_buffer, "nfs/NfsStat");
+            return create_nfs_error_accepted_reply(NFS_RESULTS_NFS_STAT, nfs_stat);
         } else {
             perror_msg("serve_nfs_procedure_12_create_link_to_file: failed creating hard link at absolute path '%s' to "
                        "target '%s'\n",
                        file_absolute_path, target_file_absolute_path);
 
             free(file_absolute_path);
-            nfs__link_args__free_unpacked(linkargs, NULL);
+            nfs__link_args__free_unpacked(linkargs, &rpc_arena_allocator);
 
             return create_system_error_accepted_reply();
         }
@@ -384,15 +320,15 @@ Rpc__AcceptedReply *serve_nfs_procedure_12_create_link_to_file(Rpc__OpaqueAuth *
     nfsstat.stat = NFS__STAT__NFS_OK;
 
     // serialize the procedure results
-    size_t nfsstat_size = nfs__nfs_stat__get_packed_size(&nfsstat);
-    uint8_t *nfsstat_buffer = malloc(nfsstat_size);
-    nfs__nfs_stat__pack(&nfsstat, nfsstat_buffer);
+    size_t nfsstat_size = get_rpc_payload_packed_size(codec, &nfsstat.base);
+    uint8_t *nfsstat_buffer = allocate_rpc_payload_buffer(nfsstat_size);
+    pack_rpc_payload(codec, &nfsstat.base, nfsstat_buffer);
 
     Rpc__AcceptedReply *accepted_reply =
         wrap_procedure_results_in_successful_accepted_reply(nfsstat_size, nfsstat_buffer, "nfs/NfsStat");
 
     free(file_absolute_path);
-    nfs__link_args__free_unpacked(linkargs, NULL);
+    nfs__link_args__free_unpacked(linkargs, &rpc_arena_allocator);
 
     return accepted_reply;
 }
\ No newline at end of file
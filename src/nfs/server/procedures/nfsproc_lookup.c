@@ -12,6 +12,8 @@
  */
 Rpc__AcceptedReply *serve_nfs_procedure_4_look_up_file_name(Rpc__OpaqueAuth *credential, Rpc__OpaqueAuth *verifier,
                                                             Google__Protobuf__Any *parameters) {
+    RpcCodec codec = get_rpc_call_codec();
+
     // check parameters are of expected type for this procedure
     if (parameters->type_url == NULL || strcmp(parameters->type_url, "nfs/DirOpArgs") != 0) {
         fprintf(stderr, "serve_nfs_procedure_4_look_up_file_name: expected nfs/DirOpArgs but received %s\n",
@@ -21,7 +23,8 @@ Rpc__AcceptedReply *serve_nfs_procedure_4_look_up_file_name(Rpc__OpaqueAuth *cre
     }
 
     // deserialize parameters
-    Nfs__DirOpArgs *diropargs = nfs__dir_op_args__unpack(NULL, parameters->value.len, parameters->value.data);
+    Nfs__DirOpArgs *diropargs = unpack_rpc_payload(codec, &nfs__dir_op_args__descriptor, &rpc_arena_allocator,
+                                                   parameters->value.len, parameters->value.data);
     if (diropargs == NULL) {
         fprintf(stderr, "serve_nfs_procedure_4_look_up_file_name: failed to unpack DirOpArgs\n");
 
@@ -30,7 +33,7 @@ Rpc__AcceptedReply *serve_nfs_procedure_4_look_up_file_name(Rpc__OpaqueAuth *cre
     if (diropargs->dir == NULL) {
         fprintf(stderr, "serve_nfs_procedure_4_look_up_file_name: 'dir' in DirOpArgs is null\n");
 
-        nfs__dir_op_args__free_unpacked(diropargs, NULL);
+        nfs__dir_op_args__free_unpacked(diropargs, &rpc_arena_allocator);
 
         return create_garbage_args_accepted_reply();
     }
@@ -38,14 +41,14 @@ Rpc__AcceptedReply *serve_nfs_procedure_4_look_up_file_name(Rpc__OpaqueAuth *cre
     if (directory_fhandle->nfs_filehandle == NULL) {
         fprintf(stderr, "serve_nfs_procedure_4_look_up_file_name: FHandle->nfs_filehandle is null\n");
 
-        nfs__dir_op_args__free_unpacked(diropargs, NULL);
+        nfs__dir_op_args__free_unpacked(diropargs, &rpc_arena_allocator);
 
         return create_garbage_args_accepted_reply();
     }
     if (diropargs->name == NULL) {
         fprintf(stderr, "serve_nfs_procedure_4_look_up_file_name: 'name' in DirOpArgs is null\n");
 
-        nfs__dir_op_args__free_unpacked(diropargs, NULL);
+        nfs__dir_op_args__free_unpacked(diropargs, &rpc_arena_allocator);
 
         return create_garbage_args_accepted_reply();
     }
@@ -53,7 +56,7 @@ Rpc__AcceptedReply *serve_nfs_procedure_4_look_up_file_name(Rpc__OpaqueAuth *cre
     if (file_name->filename == NULL) {
         fprintf(stderr, "serve_nfs_procedure_4_look_up_file_name: 'filename' in DirOpArgs is null\n");
 
-        nfs__dir_op_args__free_unpacked(diropargs, NULL);
+        nfs__dir_op_args__free_unpacked(diropargs, &rpc_arena_allocator);
 
         return create_garbage_args_accepted_reply();
     }
@@ -69,20 +72,9 @@ Rpc__AcceptedReply *serve_nfs_procedure_4_look_up_file_name(Rpc__OpaqueAuth *cre
                 "serve_nfs_procedure_4_look_up_file_name: failed to decode inode number %ld back to a directory\n",
                 inode_number);
 
-        // build the procedure results
-        Nfs__DirOpRes *diropres = create_default_case_dir_op_res(NFS__STAT__NFSERR_NOENT);
-
-        // serialize the procedure results
-        size_t diropres_size = nfs__dir_op_res__get_packed_size(diropres);
-        uint8_t *diropres_buffer = malloc(diropres_size);
-        nfs__dir_op_res__pack(diropres, diropres_buffer);
-
-        nfs__dir_op_args__free_unpacked(diropargs, NULL);
-        free(diropres->nfs_status);
-        free(diropres->default_case);
-        free(diropres);
+        nfs__dir_op_args__free_unpacked(diropargs, &rpc_arena_allocator);
 
-        return wrap_procedure_results_in_successful_accepted_reply(diropres_size, diropres_buffer, "nfs/DirOpRes");
+        return create_nfs_error_accepted_reply(NFS_RESULTS_DIR_OP_RES, NFS__STAT__NFSERR_NOENT);
     }
 
     // get the attributes of this directory before the lookup, to check that it is actually a directory
@@ -94,7 +86,7 @@ Rpc__AcceptedReply *serve_nfs_procedure_4_look_up_file_name(Rpc__OpaqueAuth *cre
                 "'%s' with error code %d\n",
                 directory_absolute_path, error_code);
 
-        nfs__dir_op_args__free_unpacked(diropargs, NULL);
+        nfs__dir_op_args__free_unpacked(diropargs, &rpc_arena_allocator);
 
         // return AcceptedReply with SYSTEM_ERR, as this shouldn't happen once we've decoded the NFS filehandle for this
         // directory back to its absolute path
@@ -105,21 +97,10 @@ Rpc__AcceptedReply *serve_nfs_procedure_4_look_up_file_name(Rpc__OpaqueAuth *cre
         fprintf(stderr, "serve_nfs_procedure_4_look_up_file_name: 'lookup' procedure called on a non-directory '%s'\n",
                 directory_absolute_path);
 
-        // build the procedure results
-        Nfs__DirOpRes *diropres = create_default_case_dir_op_res(NFS__STAT__NFSERR_NOTDIR);
-
-        // serialize the procedure results
-        size_t diropres_size = nfs__dir_op_res__get_packed_size(diropres);
-        uint8_t *diropres_buffer = malloc(diropres_size);
-        nfs__dir_op_res__pack(diropres, diropres_buffer);
-
         clean_up_fattr(&directory_fattr);
-        nfs__dir_op_args__free_unpacked(diropargs, NULL);
-        free(diropres->nfs_status);
-        free(diropres->default_case);
-        free(diropres);
+        nfs__dir_op_args__free_unpacked(diropargs, &rpc_arena_allocator);
 
-        return wrap_procedure_results_in_successful_accepted_reply(diropres_size, diropres_buffer, "nfs/DirOpRes");
+        return create_nfs_error_accepted_reply(NFS_RESULTS_DIR_OP_RES, NFS__STAT__NFSERR_NOTDIR);
     }
     clean_up_fattr(&directory_fattr);
 
@@ -140,28 +121,17 @@ Rpc__AcceptedReply *serve_nfs_procedure_4_look_up_file_name(Rpc__OpaqueAuth *cre
                 break;
             }
 
-            // build the procedure results
-            Nfs__DirOpRes *diropres = create_default_case_dir_op_res(nfs_stat);
-
-            // serialize the procedure results
-            size_t diropres_size = nfs__dir_op_res__get_packed_size(diropres);
-            uint8_t *diropres_buffer = malloc(diropres_size);
-            nfs__dir_op_res__pack(diropres, diropres_buffer);
-
             free(file_absolute_path);
-            nfs__dir_op_args__free_unpacked(diropargs, NULL);
-            free(diropres->nfs_status);
-            free(diropres->default_case);
-            free(diropres);
+            nfs__dir_op_args__free_unpacked(diropargs, &rpc_arena_allocator);
 
-            return wrap_procedure_results_in_successful_accepted_reply(diropres_size, diropres_buffer, "nfs/DirOpRes");
+            return create_nfs_error_accepted_reply(NFS_RESULTS_DIR_OP_RES, nfs_stat);
         } else {
             perror_msg("serve_nfs_procedure_4_look_up_file_name: failed checking if file to be created at absolute "
                        "path '%s' already exists",
                        file_absolute_path);
 
             free(file_absolute_path);
-            nfs__dir_op_args__free_unpacked(diropargs, NULL);
+            nfs__dir_op_args__free_unpacked(diropargs, &rpc_arena_allocator);
 
             return create_system_error_accepted_reply();
         }
@@ -178,51 +148,38 @@ Rpc__AcceptedReply *serve_nfs_procedure_4_look_up_file_name(Rpc__OpaqueAuth *cre
                     file_absolute_path, stat);
 
             free(file_absolute_path);
-            nfs__dir_op_args__free_unpacked(diropargs, NULL);
+            nfs__dir_op_args__free_unpacked(diropargs, &rpc_arena_allocator);
 
             return create_system_error_accepted_reply();
         }
 
         // client does not have correct permission to set attributes of this file/directory
         if (stat == 1) {
-            // build the procedure results
-            Nfs__DirOpRes *diropres = create_default_case_dir_op_res(NFS__STAT__NFSERR_ACCES);
-
-            // serialize the procedure results
-            size_t diropres_size = nfs__dir_op_res__get_packed_size(diropres);
-            uint8_t *diropres_buffer = malloc(diropres_size);
-            nfs__dir_op_res__pack(diropres, diropres_buffer);
-
             free(file_absolute_path);
-            nfs__dir_op_args__free_unpacked(diropargs, NULL);
-            free(diropres->nfs_status);
-            free(diropres->default_case);
-            free(diropres);
+            nfs__dir_op_args__free_unpacked(diropargs, &rpc_arena_allocator);
 
-            return wrap_procedure_results_in_successful_accepted_reply(diropres_size, diropres_buffer, "nfs/DirOpRes");
+            return create_nfs_error_accepted_reply(NFS_RESULTS_DIR_OP_RES, NFS__STAT__NFSERR_ACCES);
         }
     }
     // there's no other supported authentication flavor yet (this function only receives credential+verifier pairs with
     // supported authentication flavor)
 
-    NfsFh__NfsFileHandle *file_nfs_filehandle = get_nfs_filehandle_from_inode_number(file_stat.st_ino, inode_cache);
+    // if the file is visited for the first time, this creates a NFS filehandle for it - do not free it later, it's
+    // freed when the entire inode cache is deallocated
+    NfsFh__NfsFileHandle *file_nfs_filehandle =
+        get_or_create_nfs_filehandle(file_absolute_path, file_stat.st_ino, &inode_cache);
     if (file_nfs_filehandle == NULL) {
-        // file is visited for the first time, so create a NFS filehandle for the looked up file - do not free it later,
-        // it's freed when the entire inode cache is deallocated
-        file_nfs_filehandle = create_nfs_filehandle(file_absolute_path, &inode_cache);
-        if (file_nfs_filehandle == NULL) {
-            fprintf(stderr,
-                    "serve_nfs_procedure_4_look_up_file_name: failed creating a NFS filehandle for file at absolute "
-                    "path '%s' with error code %d\n",
-                    directory_absolute_path, error_code);
+        fprintf(stderr,
+                "serve_nfs_procedure_4_look_up_file_name: failed creating a NFS filehandle for file at absolute "
+                "path '%s' with error code %d\n",
+                directory_absolute_path, error_code);
 
-            free(file_absolute_path);
-            nfs__dir_op_args__free_unpacked(diropargs, NULL);
+        free(file_absolute_path);
+        nfs__dir_op_args__free_unpacked(diropargs, &rpc_arena_allocator);
 
-            // return AcceptedReply with SYSTEM_ERR, as this shouldn't happen once we've checked that the looked up file
-            // exists
-            return create_system_error_accepted_reply();
-        }
+        // return AcceptedReply with SYSTEM_ERR, as this shouldn't happen once we've checked that the looked up file
+        // exists
+        return create_system_error_accepted_reply();
     }
 
     // get the attributes of the looked up file
@@ -235,11 +192,10 @@ Rpc__AcceptedReply *serve_nfs_procedure_4_look_up_file_name(Rpc__OpaqueAuth *cre
                 "path '%s' with error code %d \n",
                 file_absolute_path, error_code);
 
-        nfs__dir_op_args__free_unpacked(diropargs, NULL);
+        nfs__dir_op_args__free_unpacked(diropargs, &rpc_arena_allocator);
         free(file_absolute_path);
-        // remove the inode cache mapping for this file/directory that we added when creating the NFS filehandle, as
-        // LOOKUP was unsuccessful
-        remove_inode_mapping_by_inode_number(file_nfs_filehandle->inode_number, &inode_cache);
+        // the inode cache mapping for this file/directory is kept, as the file exists and other procedures sharing the
+        // 'server_state_lock' may already be using its NFS filehandle
 
         // return AcceptedReply with SYSTEM_ERR, as this shouldn't happen once we've created a NFS filehandle for this
         // file (we successfully read stat.st_ino)
@@ -264,14 +220,14 @@ Rpc__AcceptedReply *serve_nfs_procedure_4_look_up_file_name(Rpc__OpaqueAuth *cre
     diropres.diropok = &diropok;
 
     // serialize the procedure results
-    size_t diropres_size = nfs__dir_op_res__get_packed_size(&diropres);
-    uint8_t *diropres_buffer = malloc(diropres_size);
-    nfs__dir_op_res__pack(&diropres, diropres_buffer);
+    size_t diropres_size = get_rpc_payload_packed_size(codec, &diropres.base);
+    uint8_t *diropres_buffer = allocate_rpc_payload_buffer(diropres_size);
+    pack_rpc_payload(codec, &diropres.base, diropres_buffer);
 
     Rpc__AcceptedReply *accepted_reply =
         wrap_procedure_results_in_successful_accepted_reply(diropres_size, diropres_buffer, "nfs/DirOpRes");
 
-    nfs__dir_op_args__free_unpacked(diropargs, NULL);
+    nfs__dir_op_args__free_unpacked(diropargs, &rpc_arena_allocator);
 
     clean_up_fattr(&fattr);
 
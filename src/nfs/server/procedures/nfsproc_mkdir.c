@@ -12,6 +12,8 @@
  */
 Rpc__AcceptedReply *serve_nfs_procedure_14_create_directory(Rpc__OpaqueAuth *credential, Rpc__OpaqueAuth *verifier,
                                                             Google__Protobuf__Any *parameters) {
+    RpcCodec codec = get_rpc_call_codec();
+
     // check parameters are of expected type for this procedure
     if (parameters->type_url == NULL || strcmp(parameters->type_url, "nfs/CreateArgs") != 0) {
         fprintf(stderr, "serve_nfs_procedure_14_create_directory: expected nfs/CreateArgs but received %s\n",
@@ -21,7 +23,8 @@ Rpc__AcceptedReply *serve_nfs_procedure_14_create_directory(Rpc__OpaqueAuth *cre
     }
 
     // deserialize parameters
-    Nfs__CreateArgs *createargs = nfs__create_args__unpack(NULL, parameters->value.len, parameters->value.data);
+    Nfs__CreateArgs *createargs = unpack_rpc_payload(codec, &nfs__create_args__descriptor, &rpc_arena_allocator,
+                                                     parameters->value.len, parameters->value.data);
     if (createargs == NULL) {
         fprintf(stderr, "serve_nfs_procedure_14_create_directory: failed to unpack CreateArgs\n");
 
@@ -30,7 +33,7 @@ Rpc__AcceptedReply *serve_nfs_procedure_14_create_directory(Rpc__OpaqueAuth *cre
     if (createargs->where == NULL) {
         fprintf(stderr, "serve_nfs_procedure_14_create_directory: 'where' in CreateArgs is null\n");
 
-        nfs__create_args__free_unpacked(createargs, NULL);
+        nfs__create_args__free_unpacked(createargs, &rpc_arena_allocator);
 
         return create_garbage_args_accepted_reply();
     }
@@ -38,7 +41,7 @@ Rpc__AcceptedReply *serve_nfs_procedure_14_create_directory(Rpc__OpaqueAuth *cre
     if (diropargs->dir == NULL) {
         fprintf(stderr, "serve_nfs_procedure_14_create_directory: DirOpArgs->dir is null\n");
 
-        nfs__create_args__free_unpacked(createargs, NULL);
+        nfs__create_args__free_unpacked(createargs, &rpc_arena_allocator);
 
         return create_garbage_args_accepted_reply();
     }
@@ -46,14 +49,14 @@ Rpc__AcceptedReply *serve_nfs_procedure_14_create_directory(Rpc__OpaqueAuth *cre
     if (directory_fhandle->nfs_filehandle == NULL) {
         fprintf(stderr, "serve_nfs_procedure_14_create_directory: FHandle->nfs_filehandle is null\n");
 
-        nfs__create_args__free_unpacked(createargs, NULL);
+        nfs__create_args__free_unpacked(createargs, &rpc_arena_allocator);
 
         return create_garbage_args_accepted_reply();
     }
     if (diropargs->name == NULL) {
         fprintf(stderr, "serve_nfs_procedure_14_create_directory: DirOpArgs->name is null\n");
 
-        nfs__create_args__free_unpacked(createargs, NULL);
+        nfs__create_args__free_unpacked(createargs, &rpc_arena_allocator);
 
         return create_garbage_args_accepted_reply();
     }
@@ -61,14 +64,14 @@ Rpc__AcceptedReply *serve_nfs_procedure_14_create_directory(Rpc__OpaqueAuth *cre
     if (file_name->filename == NULL) {
         fprintf(stderr, "serve_nfs_procedure_14_create_directory: DirOpArgs->name->filename is null\n");
 
-        nfs__create_args__free_unpacked(createargs, NULL);
+        nfs__create_args__free_unpacked(createargs, &rpc_arena_allocator);
 
         return create_garbage_args_accepted_reply();
     }
     if (createargs->attributes == NULL) {
         fprintf(stderr, "serve_nfs_procedure_14_create_directory: 'attributes' in CreateArgs is null\n");
 
-        nfs__create_args__free_unpacked(createargs, NULL);
+        nfs__create_args__free_unpacked(createargs, &rpc_arena_allocator);
 
         return create_garbage_args_accepted_reply();
     }
@@ -76,14 +79,14 @@ Rpc__AcceptedReply *serve_nfs_procedure_14_create_directory(Rpc__OpaqueAuth *cre
     if (sattr->atime == NULL) {
         fprintf(stderr, "serve_nfs_procedure_14_create_directory: SAttr->atime is null\n");
 
-        nfs__create_args__free_unpacked(createargs, NULL);
+        nfs__create_args__free_unpacked(createargs, &rpc_arena_allocator);
 
         return create_garbage_args_accepted_reply();
     }
     if (sattr->mtime == NULL) {
         fprintf(stderr, "serve_nfs_procedure_14_create_directory: SAttr->mtime is null\n");
 
-        nfs__create_args__free_unpacked(createargs, NULL);
+        nfs__create_args__free_unpacked(createargs, &rpc_arena_allocator);
 
         return create_garbage_args_accepted_reply();
     }
@@ -99,20 +102,9 @@ Rpc__AcceptedReply *serve_nfs_procedure_14_create_directory(Rpc__OpaqueAuth *cre
                 "serve_nfs_procedure_14_create_directory: failed to decode inode number %ld back to a directory\n",
                 inode_number);
 
-        // build the procedure results
-        Nfs__DirOpRes *diropres = create_default_case_dir_op_res(NFS__STAT__NFSERR_NOENT);
-
-        // serialize the procedure results
-        size_t diropres_size = nfs__dir_op_res__get_packed_size(diropres);
-        uint8_t *diropres_buffer = malloc(diropres_size);
-        nfs__dir_op_res__pack(diropres, diropres_buffer);
+        nfs__create_args__free_unpacked(createargs, &rpc_arena_allocator);
 
-        nfs__create_args__free_unpacked(createargs, NULL);
-        free(diropres->nfs_status);
-        free(diropres->default_case);
-        free(diropres);
-
-        return wrap_procedure_results_in_successful_accepted_reply(diropres_size, diropres_buffer, "nfs/DirOpRes");
+        return create_nfs_error_accepted_reply(NFS_RESULTS_DIR_OP_RES, NFS__STAT__NFSERR_NOENT);
     }
 
     // get the attributes of this directory, to check that it is actually a directory
@@ -125,7 +117,7 @@ Rpc__AcceptedReply *serve_nfs_procedure_14_create_directory(Rpc__OpaqueAuth *cre
                 "at absolute path '%s' with error code %d\n",
                 directory_absolute_path, error_code);
 
-        nfs__create_args__free_unpacked(createargs, NULL);
+        nfs__create_args__free_unpacked(createargs, &rpc_arena_allocator);
 
         // return AcceptedReply with SYSTEM_ERR, as this shouldn't happen once we've decoded the NFS filehandle for this
         // directory back to its absolute path
@@ -137,21 +129,10 @@ Rpc__AcceptedReply *serve_nfs_procedure_14_create_directory(Rpc__OpaqueAuth *cre
         fprintf(stderr, "serve_nfs_procedure_14_create_directory: 'mkdir' procedure called on a non-directory '%s'\n",
                 directory_absolute_path);
 
-        // build the procedure results
-        Nfs__DirOpRes *diropres = create_default_case_dir_op_res(NFS__STAT__NFSERR_NOTDIR);
-
-        // serialize the procedure results
-        size_t diropres_size = nfs__dir_op_res__get_packed_size(diropres);
-        uint8_t *diropres_buffer = malloc(diropres_size);
-        nfs__dir_op_res__pack(diropres, diropres_buffer);
-
         clean_up_fattr(&directory_fattr);
-        nfs__create_args__free_unpacked(createargs, NULL);
-        free(diropres->nfs_status);
-        free(diropres->default_case);
-        free(diropres);
+        nfs__create_args__free_unpacked(createargs, &rpc_arena_allocator);
 
-        return wrap_procedure_results_in_successful_accepted_reply(diropres_size, diropres_buffer, "nfs/DirOpRes");
+        return create_nfs_error_accepted_reply(NFS_RESULTS_DIR_OP_RES, NFS__STAT__NFSERR_NOTDIR);
     }
     clean_up_fattr(&directory_fattr);
 
@@ -162,20 +143,9 @@ Rpc__AcceptedReply *serve_nfs_procedure_14_create_directory(Rpc__OpaqueAuth *cre
                 "name longer than NFS limit\n",
                 directory_absolute_path);
 
-        // build the procedure results
-        Nfs__DirOpRes *diropres = create_default_case_dir_op_res(NFS__STAT__NFSERR_NAMETOOLONG);
-
-        // serialize the procedure results
-        size_t diropres_size = nfs__dir_op_res__get_packed_size(diropres);
-        uint8_t *diropres_buffer = malloc(diropres_size);
-        nfs__dir_op_res__pack(diropres, diropres_buffer);
+        nfs__create_args__free_unpacked(createargs, &rpc_arena_allocator);
 
-        nfs__create_args__free_unpacked(createargs, NULL);
-        free(diropres->nfs_status);
-        free(diropres->default_case);
-        free(diropres);
-
-        return wrap_procedure_results_in_successful_accepted_reply(diropres_size, diropres_buffer, "nfs/DirOpRes");
+        return create_nfs_error_accepted_reply(NFS_RESULTS_DIR_OP_RES, NFS__STAT__NFSERR_NAMETOOLONG);
     }
 
     // check if the directory client wants to create already exists
@@ -187,21 +157,10 @@ Rpc__AcceptedReply *serve_nfs_procedure_14_create_directory(Rpc__OpaqueAuth *cre
                 "serve_nfs_procedure_14_create_directory: attempted to create a directory '%s' that already exists\n",
                 child_directory_absolute_path);
 
-        // build the procedure results
-        Nfs__DirOpRes *diropres = create_default_case_dir_op_res(NFS__STAT__NFSERR_EXIST);
-
-        // serialize the procedure results
-        size_t diropres_size = nfs__dir_op_res__get_packed_size(diropres);
-        uint8_t *diropres_buffer = malloc(diropres_size);
-        nfs__dir_op_res__pack(diropres, diropres_buffer);
-
         free(child_directory_absolute_path);
-        nfs__create_args__free_unpacked(createargs, NULL);
-        free(diropres->nfs_status);
-        free(diropres->default_case);
-        free(diropres);
+        nfs__create_args__free_unpacked(createargs, &rpc_arena_allocator);
 
-        return wrap_procedure_results_in_successful_accepted_reply(diropres_size, diropres_buffer, "nfs/DirOpRes");
+        return create_nfs_error_accepted_reply(NFS_RESULTS_DIR_OP_RES, NFS__STAT__NFSERR_EXIST);
     } else if (errno != ENOENT) {
         // we got an error different from 'ENOENT = No such file or directory'
         perror_msg("serve_nfs_procedure_14_create_directory: failed checking if directory to be created at absolute "
@@ -209,7 +168,7 @@ Rpc__AcceptedReply *serve_nfs_procedure_14_create_directory(Rpc__OpaqueAuth *cre
                    child_directory_absolute_path);
 
         free(child_directory_absolute_path);
-        nfs__create_args__free_unpacked(createargs, NULL);
+        nfs__create_args__free_unpacked(createargs, &rpc_arena_allocator);
 
         return create_system_error_accepted_reply();
     }
@@ -226,33 +185,25 @@ Rpc__AcceptedReply *serve_nfs_procedure_14_create_directory(Rpc__OpaqueAuth *cre
                     child_directory_absolute_path, stat);
 
             free(child_directory_absolute_path);
-            nfs__create_args__free_unpacked(createargs, NULL);
+            nfs__create_args__free_unpacked(createargs, &rpc_arena_allocator);
 
             return create_system_error_accepted_reply();
         }
 
         // client does not have correct permission to create a directory here
         if (stat == 1) {
-            // build the procedure results
-            Nfs__DirOpRes *diropres = create_default_case_dir_op_res(NFS__STAT__NFSERR_ACCES);
-
-            // serialize the procedure results
-            size_t diropres_size = nfs__dir_op_res__get_packed_size(diropres);
-            uint8_t *diropres_buffer = malloc(diropres_size);
-            nfs__dir_op_res__pack(diropres, diropres_buffer);
-
             free(child_directory_absolute_path);
-            nfs__create_args__free_unpacked(createargs, NULL);
-            free(diropres->nfs_status);
-            free(diropres->default_case);
-            free(diropres);
+            nfs__create_args__free_unpacked(createargs, &rpc_arena_allocator);
 
-            return wrap_procedure_results_in_successful_accepted_reply(diropres_size, diropres_buffer, "nfs/DirOpRes");
+            return create_nfs_error_accepted_reply(NFS_RESULTS_DIR_OP_RES, NFS__STAT__NFSERR_ACCES);
         }
     }
     // there's no other supported authentication flavor yet (this function only receives credential+verifier pairs with
     // supported authentication flavor)
 
+    // the cached GETATTR results of the parent directory are stale once a directory is created in it
+    invalidate_cached_attr_stat(&attributes_cache, inode_number);
+
     // create the directory
     if (sattr->mode != -1) {
         error_code = mkdir(child_directory_absolute_path, sattr->mode);
@@ -293,27 +244,16 @@ Rpc__AcceptedReply *serve_nfs_procedure_14_create_directory(Rpc__OpaqueAuth *cre
                 break;
             }
 
-            // build the procedure results
-            Nfs__DirOpRes *diropres = create_default_case_dir_op_res(nfs_stat);
-
-            // serialize the procedure results
-            size_t diropres_size = nfs__dir_op_res__get_packed_size(diropres);
-            uint8_t *diropres_buffer = malloc(diropres_size);
-            nfs__dir_op_res__pack(diropres, diropres_buffer);
-
             free(child_directory_absolute_path);
-            nfs__create_args__free_unpacked(createargs, NULL);
-            free(diropres->nfs_status);
-            free(diropres->default_case);
-            free(diropres);
+            nfs__create_args__free_unpacked(createargs, &rpc_arena_allocator);
 
-            return wrap_procedure_results_in_successful_accepted_reply(diropres_size, diropres_buffer, "nfs/DirOpRes");
+            return create_nfs_error_accepted_reply(NFS_RESULTS_DIR_OP_RES, nfs_stat);
         } else {
             perror_msg("serve_nfs_procedure_14_create_directory: failed creating directory at absolute path '%s'\n",
                        child_directory_absolute_path);
 
             free(child_directory_absolute_path);
-            nfs__create_args__free_unpacked(createargs, NULL);
+            nfs__create_args__free_unpacked(createargs, &rpc_arena_allocator);
 
             return create_system_error_accepted_reply();
         }
@@ -327,28 +267,17 @@ Rpc__AcceptedReply *serve_nfs_procedure_14_create_directory(Rpc__OpaqueAuth *cre
                    child_directory_absolute_path);
 
         free(child_directory_absolute_path);
-        nfs__create_args__free_unpacked(createargs, NULL);
+        nfs__create_args__free_unpacked(createargs, &rpc_arena_allocator);
 
         return create_system_error_accepted_reply();
     }
     if (sattr->size != -1) {
         fprintf(stderr, "serve_nfs_procedure_14_create_directory: can not set 'size' attribute of a directory\n");
 
-        // build the procedure results
-        Nfs__DirOpRes *diropres = create_default_case_dir_op_res(NFS__STAT__NFSERR_ISDIR);
-
-        // serialize the procedure results
-        size_t diropres_size = nfs__dir_op_res__get_packed_size(diropres);
-        uint8_t *diropres_buffer = malloc(diropres_size);
-        nfs__dir_op_res__pack(diropres, diropres_buffer);
-
         free(child_directory_absolute_path);
-        nfs__create_args__free_unpacked(createargs, NULL);
-        free(diropres->nfs_status);
-        free(diropres->default_case);
-        free(diropres);
+        nfs__create_args__free_unpacked(createargs, &rpc_arena_allocator);
 
-        return wrap_procedure_results_in_successful_accepted_reply(diropres_size, diropres_buffer, "nfs/DirOpRes");
+        return create_nfs_error_accepted_reply(NFS_RESULTS_DIR_OP_RES, NFS__STAT__NFSERR_ISDIR);
     }
     if (sattr->atime->seconds != -1 && sattr->atime->useconds != -1 && sattr->mtime->seconds != -1 &&
         sattr->mtime->useconds != -1) { // API only allows changing of both atime and mtime at once
@@ -364,7 +293,7 @@ Rpc__AcceptedReply *serve_nfs_procedure_14_create_directory(Rpc__OpaqueAuth *cre
                        child_directory_absolute_path);
 
             free(child_directory_absolute_path);
-            nfs__create_args__free_unpacked(createargs, NULL);
+            nfs__create_args__free_unpacked(createargs, &rpc_arena_allocator);
 
             return create_system_error_accepted_reply();
         }
@@ -380,7 +309,7 @@ Rpc__AcceptedReply *serve_nfs_procedure_14_create_directory(Rpc__OpaqueAuth *cre
                 child_directory_absolute_path, error_code);
 
         free(child_directory_absolute_path);
-        nfs__create_args__free_unpacked(createargs, NULL);
+        nfs__create_args__free_unpacked(createargs, &rpc_arena_allocator);
 
         // return AcceptedReply with SYSTEM_ERR, as once we've created the directory we have to be able to create a NFS
         // filehandle for it
@@ -398,10 +327,9 @@ Rpc__AcceptedReply *serve_nfs_procedure_14_create_directory(Rpc__OpaqueAuth *cre
                 child_directory_absolute_path, error_code);
 
         free(child_directory_absolute_path);
-        nfs__create_args__free_unpacked(createargs, NULL);
-        // remove the inode cache mapping for the created directory that we created when creating the NFS filehandle, as
-        // MKDIR was unsuccessful
-        remove_inode_mapping_by_inode_number(child_directory_nfs_filehandle->inode_number, &inode_cache);
+        nfs__create_args__free_unpacked(createargs, &rpc_arena_allocator);
+        // the inode cache mapping for the created directory is kept, as the directory exists and other procedures
+        // sharing the 'server_state_lock' may already be using its NFS filehandle
 
         // return AcceptedReply with SYSTEM_ERR, as this shouldn't happen once we've decoded the NFS filehandle for this
         // directory back to its absolute path
@@ -427,14 +355,14 @@ Rpc__AcceptedReply *serve_nfs_procedure_14_create_directory(Rpc__OpaqueAuth *cre
     diropres.diropok = &diropok;
 
     // serialize the procedure results
-    size_t diropres_size = nfs__dir_op_res__get_packed_size(&diropres);
-    uint8_t *diropres_buffer = malloc(diropres_size);
-    nfs__dir_op_res__pack(&diropres, diropres_buffer);
+    size_t diropres_size = get_rpc_payload_packed_size(codec, &diropres.base);
+    uint8_t *diropres_buffer = allocate_rpc_payload_buffer(diropres_size);
+    pack_rpc_payload(codec, &diropres.base, diropres_buffer);
 
     Rpc__AcceptedReply *accepted_reply =
         wrap_procedure_results_in_successful_accepted_reply(diropres_size, diropres_buffer, "nfs/DirOpRes");
 
-    nfs__create_args__free_unpacked(createargs, NULL);
+    nfs__create_args__free_unpacked(createargs, &rpc_arena_allocator);
 
     clean_up_fattr(&fattr);
 
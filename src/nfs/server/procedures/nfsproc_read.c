@@ -12,6 +12,8 @@
  */
 Rpc__AcceptedReply *serve_nfs_procedure_6_read_from_file(Rpc__OpaqueAuth *credential, Rpc__OpaqueAuth *verifier,
                                                          Google__Protobuf__Any *parameters) {
+    RpcCodec codec = get_rpc_call_codec();
+
     // check parameters are of expected type for this procedure
     if (parameters->type_url == NULL || strcmp(parameters->type_url, "nfs/ReadArgs") != 0) {
         fprintf(stderr, "serve_nfs_procedure_6_read_from_file: expected nfs/ReadArgs but received %s\n",
@@ -21,7 +23,8 @@ Rpc__AcceptedReply *serve_nfs_procedure_6_read_from_file(Rpc__OpaqueAuth *creden
     }
 
     // deserialize parameters
-    Nfs__ReadArgs *readargs = nfs__read_args__unpack(NULL, parameters->value.len, parameters->value.data);
+    Nfs__ReadArgs *readargs = unpack_rpc_payload(codec, &nfs__read_args__descriptor, &rpc_arena_allocator,
+                                                 parameters->value.len, parameters->value.data);
     if (readargs == NULL) {
         fprintf(stderr, "serve_nfs_procedure_6_read_from_file: failed to unpack ReadArgs\n");
 
@@ -30,7 +33,7 @@ Rpc__AcceptedReply *serve_nfs_procedure_6_read_from_file(Rpc__OpaqueAuth *creden
     if (readargs->file == NULL) {
         fprintf(stderr, "serve_nfs_procedure_6_read_from_file: 'file' in ReadArgs is null\n");
 
-        nfs__read_args__free_unpacked(readargs, NULL);
+        nfs__read_args__free_unpacked(readargs, &rpc_arena_allocator);
 
         return create_garbage_args_accepted_reply();
     }
@@ -38,7 +41,7 @@ Rpc__AcceptedReply *serve_nfs_procedure_6_read_from_file(Rpc__OpaqueAuth *creden
     if (file_fhandle->nfs_filehandle == NULL) {
         fprintf(stderr, "serve_nfs_procedure_6_read_from_file: FHandle->nfs_filehandle is null\n");
 
-        nfs__read_args__free_unpacked(readargs, NULL);
+        nfs__read_args__free_unpacked(readargs, &rpc_arena_allocator);
 
         return create_garbage_args_accepted_reply();
     }
@@ -53,20 +56,9 @@ Rpc__AcceptedReply *serve_nfs_procedure_6_read_from_file(Rpc__OpaqueAuth *creden
         fprintf(stderr, "serve_nfs_procedure_6_read_from_file: failed to decode inode number %ld back to a file\n",
                 inode_number);
 
-        // build the procedure results
-        Nfs__ReadRes *readres = create_default_case_read_res(NFS__STAT__NFSERR_NOENT);
-
-        // serialize the procedure results
-        size_t readres_size = nfs__read_res__get_packed_size(readres);
-        uint8_t *readres_buffer = malloc(readres_size);
-        nfs__read_res__pack(readres, readres_buffer);
-
-        nfs__read_args__free_unpacked(readargs, NULL);
-        free(readres->nfs_status);
-        free(readres->default_case);
-        free(readres);
+        nfs__read_args__free_unpacked(readargs, &rpc_arena_allocator);
 
-        return wrap_procedure_results_in_successful_accepted_reply(readres_size, readres_buffer, "nfs/ReadRes");
+        return create_nfs_error_accepted_reply(NFS_RESULTS_READ_RES, NFS__STAT__NFSERR_NOENT);
     }
 
     // get the attributes of the looked up file before the read, to check that the file is not a directory
@@ -79,7 +71,7 @@ Rpc__AcceptedReply *serve_nfs_procedure_6_read_from_file(Rpc__OpaqueAuth *creden
                 "'%s' with error code %d\n",
                 file_absolute_path, error_code);
 
-        nfs__read_args__free_unpacked(readargs, NULL);
+        nfs__read_args__free_unpacked(readargs, &rpc_arena_allocator);
 
         // return AcceptedReply with SYSTEM_ERR, as this shouldn't happen once we've decoded the NFS filehandle for this
         // file back to its absolute path
@@ -94,20 +86,10 @@ Rpc__AcceptedReply *serve_nfs_procedure_6_read_from_file(Rpc__OpaqueAuth *creden
                 "non-directory operation\n",
                 file_absolute_path);
 
-        // build the procedure results
-        Nfs__ReadRes *readres = create_default_case_read_res(NFS__STAT__NFSERR_ISDIR);
-
-        // serialize the procedure results
-        size_t readres_size = nfs__read_res__get_packed_size(readres);
-        uint8_t *readres_buffer = malloc(readres_size);
-        nfs__read_res__pack(readres, readres_buffer);
-
         clean_up_fattr(&fattr);
-        nfs__read_args__free_unpacked(readargs, NULL);
-        free(readres->default_case);
-        free(readres);
+        nfs__read_args__free_unpacked(readargs, &rpc_arena_allocator);
 
-        return wrap_procedure_results_in_successful_accepted_reply(readres_size, readres_buffer, "nfs/ReadRes");
+        return create_nfs_error_accepted_reply(NFS_RESULTS_READ_RES, NFS__STAT__NFSERR_ISDIR);
     }
     clean_up_fattr(&fattr);
 
@@ -121,38 +103,29 @@ Rpc__AcceptedReply *serve_nfs_procedure_6_read_from_file(Rpc__OpaqueAuth *creden
                     "'%s' with error code %d\n",
                     file_absolute_path, stat);
 
-            nfs__read_args__free_unpacked(readargs, NULL);
+            nfs__read_args__free_unpacked(readargs, &rpc_arena_allocator);
 
             return create_system_error_accepted_reply();
         }
 
         // client does not have correct permission to read this file
         if (stat == 1) {
-            // build the procedure results
-            Nfs__ReadRes *readres = create_default_case_read_res(NFS__STAT__NFSERR_ACCES);
+            nfs__read_args__free_unpacked(readargs, &rpc_arena_allocator);
 
-            // serialize the procedure results
-            size_t readres_size = nfs__read_res__get_packed_size(readres);
-            uint8_t *readres_buffer = malloc(readres_size);
-            nfs__read_res__pack(readres, readres_buffer);
-
-            nfs__read_args__free_unpacked(readargs, NULL);
-            free(readres->default_case);
-            free(readres);
-
-            return wrap_procedure_results_in_successful_accepted_reply(readres_size, readres_buffer, "nfs/ReadRes");
+            return create_nfs_error_accepted_reply(NFS_RESULTS_READ_RES, NFS__STAT__NFSERR_ACCES);
         }
     }
     // there's no other supported authentication flavor yet (this function only receives credential+verifier pairs with
     // supported authentication flavor)
 
-    // if client requested to read too much data in a single RPC, truncate the read down to NFS_MAXDATA bytes
-    if (readargs->count > NFS_MAXDATA) {
-        readargs->count = NFS_MAXDATA;
+    // if client requested to read too much data in a single RPC, truncate the read down to NFS_MAX_TRANSFER_SIZE
+    // bytes
+    if (readargs->count > NFS_MAX_TRANSFER_SIZE) {
+        readargs->count = NFS_MAX_TRANSFER_SIZE;
     }
 
     // read from the file
-    uint8_t *read_data = malloc(sizeof(uint8_t) * readargs->count);
+    uint8_t *read_data = rpc_arena_alloc(sizeof(uint8_t) * readargs->count);
     size_t bytes_read;
     error_code = read_from_file(file_absolute_path, readargs->offset, readargs->count, read_data, &bytes_read);
     if (error_code > 0) {
@@ -162,7 +135,8 @@ Rpc__AcceptedReply *serve_nfs_procedure_6_read_from_file(Rpc__OpaqueAuth *creden
             "serve_nfs_procedure_6_read_from_file: failed to read from file at absolute path '%s' with error code %d\n",
             file_absolute_path, error_code);
 
-        nfs__read_args__free_unpacked(readargs, NULL);
+        nfs__read_args__free_unpacked(readargs, &rpc_arena_allocator);
+        rpc_arena_free(read_data);
 
         // return AcceptedReply with SYSTEM_ERR, as this shouldn't happen once we've decoded the NFS filehandle for this
         // file back to its absolute path
@@ -179,7 +153,8 @@ Rpc__AcceptedReply *serve_nfs_procedure_6_read_from_file(Rpc__OpaqueAuth *creden
                 "'%s' with error code %d\n",
                 file_absolute_path, error_code);
 
-        nfs__read_args__free_unpacked(readargs, NULL);
+        nfs__read_args__free_unpacked(readargs, &rpc_arena_allocator);
+        rpc_arena_free(read_data);
 
         // return AcceptedReply with SYSTEM_ERR, as this shouldn't happen once we've decoded the NFS filehandle for this
         // file back to its absolute path
@@ -199,17 +174,37 @@ Rpc__AcceptedReply *serve_nfs_procedure_6_read_from_file(Rpc__OpaqueAuth *creden
     readresbody.nfsdata.data = read_data;
     readresbody.nfsdata.len = bytes_read;
 
+    // send the data compressed if the client accepts a compression we support, and the data is expected to compress
+    // well - otherwise send it as it is
+    uint8_t *compressed_data = NULL;
+    RpcCompression compression = readargs->accepted_compression;
+    if (compression != RPC_COMPRESSION_NONE && is_rpc_compression_supported(compression) &&
+        should_compress_rpc_payload_data(&rpc_compression_policy, inode_number, read_data, bytes_read)) {
+        compressed_data = rpc_arena_alloc(get_rpc_compression_bound(compression, bytes_read));
+        size_t compressed_size;
+        if (compressed_data != NULL &&
+            compress_rpc_payload_data(&rpc_compression_policy, compression, inode_number, read_data, bytes_read,
+                                      compressed_data, &compressed_size) == 0) {
+            readresbody.nfsdata.data = compressed_data;
+            readresbody.nfsdata.len = compressed_size;
+            readresbody.compression = compression;
+            readresbody.uncompressed_size = bytes_read;
+        }
+    }
+
     readres.readresbody = &readresbody;
 
     // serialize the procedure results
-    size_t readres_size = nfs__read_res__get_packed_size(&readres);
-    uint8_t *readres_buffer = malloc(readres_size);
-    nfs__read_res__pack(&readres, readres_buffer);
+    size_t readres_size = get_rpc_payload_packed_size(codec, &readres.base);
+    uint8_t *readres_buffer = allocate_rpc_payload_buffer(readres_size);
+    pack_rpc_payload(codec, &readres.base, readres_buffer);
 
     Rpc__AcceptedReply *accepted_reply =
         wrap_procedure_results_in_successful_accepted_reply(readres_size, readres_buffer, "nfs/ReadRes");
 
-    nfs__read_args__free_unpacked(readargs, NULL);
+    nfs__read_args__free_unpacked(readargs, &rpc_arena_allocator);
+    rpc_arena_free(read_data);
+    rpc_arena_free(compressed_data);
 
     clean_up_fattr(&fattr_after_read);
 
@@ -12,6 +12,8 @@
  */
 Rpc__AcceptedReply *serve_nfs_procedure_16_read_from_directory(Rpc__OpaqueAuth *credential, Rpc__OpaqueAuth *verifier,
                                                                Google__Protobuf__Any *parameters) {
+    RpcCodec codec = get_rpc_call_codec();
+
     // check parameters are of expected type for this procedure
     if (parameters->type_url == NULL || strcmp(parameters->type_url, "nfs/ReadDirArgs") != 0) {
         fprintf(stderr, "serve_nfs_procedure_16_read_from_directory: Expected nfs/ReadDirArgs but received %s\n",
@@ -21,7 +23,8 @@ Rpc__AcceptedReply *serve_nfs_procedure_16_read_from_directory(Rpc__OpaqueAuth *
     }
 
     // deserialize parameters
-    Nfs__ReadDirArgs *readdirargs = nfs__read_dir_args__unpack(NULL, parameters->value.len, parameters->value.data);
+    Nfs__ReadDirArgs *readdirargs = unpack_rpc_payload(codec, &nfs__read_dir_args__descriptor, &rpc_arena_allocator,
+                                                       parameters->value.len, parameters->value.data);
     if (readdirargs == NULL) {
         fprintf(stderr, "serve_nfs_procedure_16_read_from_directory: Failed to unpack ReadDirArgs\n");
 
@@ -30,14 +33,14 @@ Rpc__AcceptedReply *serve_nfs_procedure_16_read_from_directory(Rpc__OpaqueAuth *
     if (readdirargs->dir == NULL) {
         fprintf(stderr, "serve_nfs_procedure_16_read_from_directory: 'dir' in ReadDirArgs is null\n");
 
-        nfs__read_dir_args__free_unpacked(readdirargs, NULL);
+        nfs__read_dir_args__free_unpacked(readdirargs, &rpc_arena_allocator);
 
         return create_garbage_args_accepted_reply();
     }
     if (readdirargs->cookie == NULL) {
         fprintf(stderr, "serve_nfs_procedure_16_read_from_directory: 'cookie' in ReadDirArgs is null\n");
 
-        nfs__read_dir_args__free_unpacked(readdirargs, NULL);
+        nfs__read_dir_args__free_unpacked(readdirargs, &rpc_arena_allocator);
 
         return create_garbage_args_accepted_reply();
     }
@@ -45,7 +48,7 @@ Rpc__AcceptedReply *serve_nfs_procedure_16_read_from_directory(Rpc__OpaqueAuth *
     if (directory_fhandle->nfs_filehandle == NULL) {
         fprintf(stderr, "serve_nfs_procedure_16_read_from_directory: FHandle->nfs_filehandle is null\n");
 
-        nfs__read_dir_args__free_unpacked(readdirargs, NULL);
+        nfs__read_dir_args__free_unpacked(readdirargs, &rpc_arena_allocator);
 
         return create_garbage_args_accepted_reply();
     }
@@ -61,21 +64,9 @@ Rpc__AcceptedReply *serve_nfs_procedure_16_read_from_directory(Rpc__OpaqueAuth *
                 "serve_nfs_procedure_16_read_from_directory: failed to decode inode number %ld back to a directory\n",
                 directory_inode_number);
 
-        // build the procedure results
-        Nfs__ReadDirRes *readdirres = create_default_case_read_dir_res(NFS__STAT__NFSERR_NOENT);
-
-        // serialize the procedure results
-        size_t readdirres_size = nfs__read_dir_res__get_packed_size(readdirres);
-        uint8_t *readdirres_buffer = malloc(readdirres_size);
-        nfs__read_dir_res__pack(readdirres, readdirres_buffer);
-
-        nfs__read_dir_args__free_unpacked(readdirargs, NULL);
-        free(readdirres->nfs_status);
-        free(readdirres->default_case);
-        free(readdirres);
+        nfs__read_dir_args__free_unpacked(readdirargs, &rpc_arena_allocator);
 
-        return wrap_procedure_results_in_successful_accepted_reply(readdirres_size, readdirres_buffer,
-                                                                   "nfs/ReadDirRes");
+        return create_nfs_error_accepted_reply(NFS_RESULTS_READ_DIR_RES, NFS__STAT__NFSERR_NOENT);
     }
 
     // get the attributes of this directory before the read, to check that it is actually a directory
@@ -88,7 +79,7 @@ Rpc__AcceptedReply *serve_nfs_procedure_16_read_from_directory(Rpc__OpaqueAuth *
                 "'%s' with error code %d\n",
                 directory_absolute_path, error_code);
 
-        nfs__read_dir_args__free_unpacked(readdirargs, NULL);
+        nfs__read_dir_args__free_unpacked(readdirargs, &rpc_arena_allocator);
 
         // return AcceptedReply with SYSTEM_ERR, as this shouldn't happen once we've decoded the NFS filehandle for this
         // directory back to its absolute path
@@ -103,22 +94,10 @@ Rpc__AcceptedReply *serve_nfs_procedure_16_read_from_directory(Rpc__OpaqueAuth *
                 "a directory operation\n",
                 directory_absolute_path);
 
-        // build the procedure results
-        Nfs__ReadDirRes *readdirres = create_default_case_read_dir_res(NFS__STAT__NFSERR_NOTDIR);
-
-        // serialize the procedure results
-        size_t readdirres_size = nfs__read_dir_res__get_packed_size(readdirres);
-        uint8_t *readdirres_buffer = malloc(readdirres_size);
-        nfs__read_dir_res__pack(readdirres, readdirres_buffer);
-
         clean_up_fattr(&fattr);
-        nfs__read_dir_args__free_unpacked(readdirargs, NULL);
-        free(readdirres->nfs_status);
-        free(readdirres->default_case);
-        free(readdirres);
+        nfs__read_dir_args__free_unpacked(readdirargs, &rpc_arena_allocator);
 
-        return wrap_procedure_results_in_successful_accepted_reply(readdirres_size, readdirres_buffer,
-                                                                   "nfs/ReadDirRes");
+        return create_nfs_error_accepted_reply(NFS_RESULTS_READ_DIR_RES, NFS__STAT__NFSERR_NOTDIR);
     }
     clean_up_fattr(&fattr);
 
@@ -132,33 +111,27 @@ Rpc__AcceptedReply *serve_nfs_procedure_16_read_from_directory(Rpc__OpaqueAuth *
                     "entries in the directory at absolute path '%s' with error code %d\n",
                     directory_absolute_path, stat);
 
-            nfs__read_dir_args__free_unpacked(readdirargs, NULL);
+            nfs__read_dir_args__free_unpacked(readdirargs, &rpc_arena_allocator);
 
             return create_system_error_accepted_reply();
         }
 
         // client does not have correct permission to read entries in this directory
         if (stat == 1) {
-            // build the procedure results
-            Nfs__ReadDirRes *readdirres = create_default_case_read_dir_res(NFS__STAT__NFSERR_ACCES);
+            nfs__read_dir_args__free_unpacked(readdirargs, &rpc_arena_allocator);
 
-            // serialize the procedure results
-            size_t readdirres_size = nfs__read_dir_res__get_packed_size(readdirres);
-            uint8_t *readdirres_buffer = malloc(readdirres_size);
-            nfs__read_dir_res__pack(readdirres, readdirres_buffer);
-
-            nfs__read_dir_args__free_unpacked(readdirargs, NULL);
-            free(readdirres->nfs_status);
-            free(readdirres->default_case);
-            free(readdirres);
-
-            return wrap_procedure_results_in_successful_accepted_reply(readdirres_size, readdirres_buffer,
-                                                                       "nfs/ReadDirRes");
+            return create_nfs_error_accepted_reply(NFS_RESULTS_READ_DIR_RES, NFS__STAT__NFSERR_ACCES);
         }
     }
     // there's no other supported authentication flavor yet (this function only receives credential+verifier pairs with
     // supported authentication flavor)
 
+    // the entries are returned as a list of nested messages, which takes time quadratic in their number to serialize,
+    // so don't read more than NFS_MAXDATA bytes of them however many the client asks for
+    if (readdirargs->count > NFS_MAXDATA) {
+        readdirargs->count = NFS_MAXDATA;
+    }
+
     // read entries from the directory
     Nfs__DirectoryEntriesList *directory_entries = NULL;
     int end_of_stream = 0;
@@ -172,7 +145,7 @@ Rpc__AcceptedReply *serve_nfs_procedure_16_read_from_directory(Rpc__OpaqueAuth *
                 "absolute path '%s' with error code %d\n",
                 directory_absolute_path, error_code);
 
-        nfs__read_dir_args__free_unpacked(readdirargs, NULL);
+        nfs__read_dir_args__free_unpacked(readdirargs, &rpc_arena_allocator);
 
         // return AcceptedReply with SYSTEM_ERR, as this shouldn't happen once we've decoded the NFS filehandle for this
         // directory back to its absolute path
@@ -195,14 +168,14 @@ Rpc__AcceptedReply *serve_nfs_procedure_16_read_from_directory(Rpc__OpaqueAuth *
     readdirres.readdirok = &readdirok;
 
     // serialize the procedure results
-    size_t readdirres_size = nfs__read_dir_res__get_packed_size(&readdirres);
-    uint8_t *readdirres_buffer = malloc(readdirres_size);
-    nfs__read_dir_res__pack(&readdirres, readdirres_buffer);
+    size_t readdirres_size = get_rpc_payload_packed_size(codec, &readdirres.base);
+    uint8_t *readdirres_buffer = allocate_rpc_payload_buffer(readdirres_size);
+    pack_rpc_payload(codec, &readdirres.base, readdirres_buffer);
 
     Rpc__AcceptedReply *accepted_reply =
         wrap_procedure_results_in_successful_accepted_reply(readdirres_size, readdirres_buffer, "nfs/ReadDirRes");
 
-    nfs__read_dir_args__free_unpacked(readdirargs, NULL);
+    nfs__read_dir_args__free_unpacked(readdirargs, &rpc_arena_allocator);
 
     clean_up_directory_entries_list(directory_entries);
 
@@ -0,0 +1,171 @@
+#include "nfsproc.h"
+
+/*
+ * Runs the NFSPROC_READDIR2 procedure (20), an extension to RFC 1094. It reads the same directory entries as
+ * NFSPROC_READDIR does, but returns them flat - their fileids, cookies and name offsets in three arrays, and their
+ * names back to back in a single byte string - rather than as a list of nested messages.
+ *
+ * Takes a RPC credential+verifier pair corresponding to a supported authentication flavor. The provided
+ * credential and verifier must be structurally validated (i.e. no NULL fields and correspond to a supported
+ * authentication flavor) before being passed here. This procedure must not be given AUTH_NONE credential+verifier pair.
+ *
+ * The user of this function takes the responsibility to deallocate the received AcceptedReply
+ * using the 'free_accepted_reply()' function.
+ */
+Rpc__AcceptedReply *serve_nfs_procedure_20_read_from_directory_2(Rpc__OpaqueAuth *credential, Rpc__OpaqueAuth *verifier,
+                                                                 Google__Protobuf__Any *parameters) {
+    RpcCodec codec = get_rpc_call_codec();
+
+    // check parameters are of expected type for this procedure
+    if (parameters->type_url == NULL || strcmp(parameters->type_url, "nfs/ReadDirArgs") != 0) {
+        fprintf(stderr, "serve_nfs_procedure_20_read_from_directory_2: Expected nfs/ReadDirArgs but received %s\n",
+                parameters->type_url);
+
+        return create_garbage_args_accepted_reply();
+    }
+
+    // deserialize parameters
+    Nfs__ReadDirArgs *readdirargs = unpack_rpc_payload(codec, &nfs__read_dir_args__descriptor, &rpc_arena_allocator,
+                                                       parameters->value.len, parameters->value.data);
+    if (readdirargs == NULL) {
+        fprintf(stderr, "serve_nfs_procedure_20_read_from_directory_2: Failed to unpack ReadDirArgs\n");
+
+        return create_garbage_args_accepted_reply();
+    }
+    if (readdirargs->dir == NULL) {
+        fprintf(stderr, "serve_nfs_procedure_20_read_from_directory_2: 'dir' in ReadDirArgs is null\n");
+
+        nfs__read_dir_args__free_unpacked(readdirargs, &rpc_arena_allocator);
+
+        return create_garbage_args_accepted_reply();
+    }
+    if (readdirargs->cookie == NULL) {
+        fprintf(stderr, "serve_nfs_procedure_20_read_from_directory_2: 'cookie' in ReadDirArgs is null\n");
+
+        nfs__read_dir_args__free_unpacked(readdirargs, &rpc_arena_allocator);
+
+        return create_garbage_args_accepted_reply();
+    }
+    Nfs__FHandle *directory_fhandle = readdirargs->dir;
+    if (directory_fhandle->nfs_filehandle == NULL) {
+        fprintf(stderr, "serve_nfs_procedure_20_read_from_directory_2: FHandle->nfs_filehandle is null\n");
+
+        nfs__read_dir_args__free_unpacked(readdirargs, &rpc_arena_allocator);
+
+        return create_garbage_args_accepted_reply();
+    }
+
+    NfsFh__NfsFileHandle *directory_nfs_filehandle = directory_fhandle->nfs_filehandle;
+    ino_t directory_inode_number = directory_nfs_filehandle->inode_number;
+
+    Nfs__Stat nfs_stat = NFS__STAT__NFS_OK;
+    Nfs__FAttr fattr = NFS__FATTR__INIT;
+    char *directory_absolute_path = get_absolute_path_from_inode_number(directory_inode_number, inode_cache);
+    if (directory_absolute_path == NULL) {
+        // we couldn't decode inode number back to a file/directory - we assume the client gave us a wrong NFS
+        // filehandle, i.e. no such directory
+        fprintf(stderr,
+                "serve_nfs_procedure_20_read_from_directory_2: failed to decode inode number %ld back to a "
+                "directory\n",
+                directory_inode_number);
+
+        nfs_stat = NFS__STAT__NFSERR_NOENT;
+    } else if (get_attributes(directory_absolute_path, &fattr) > 0) {
+        fprintf(stderr,
+                "serve_nfs_procedure_20_read_from_directory_2: failed getting file attributes for file at absolute "
+                "path '%s'\n",
+                directory_absolute_path);
+
+        nfs__read_dir_args__free_unpacked(readdirargs, &rpc_arena_allocator);
+
+        // return AcceptedReply with SYSTEM_ERR, as this shouldn't happen once we've decoded the NFS filehandle for this
+        // directory back to its absolute path
+        return create_system_error_accepted_reply();
+    } else if (fattr.nfs_ftype->ftype != NFS__FTYPE__NFDIR) {
+        // only directories can be read using READDIR2
+        fprintf(stderr,
+                "serve_nfs_procedure_20_read_from_directory_2: a non-directory '%s' was specified for 'readdir2' "
+                "which is a directory operation\n",
+                directory_absolute_path);
+
+        nfs_stat = NFS__STAT__NFSERR_NOTDIR;
+    }
+    clean_up_fattr(&fattr);
+
+    // check permissions
+    if (nfs_stat == NFS__STAT__NFS_OK && credential->flavor == RPC__AUTH_FLAVOR__AUTH_SYS) {
+        int stat = check_readdir_proc_permissions(directory_absolute_path, credential->auth_sys->uid,
+                                                  credential->auth_sys->gid);
+        if (stat < 0) {
+            fprintf(stderr,
+                    "serve_nfs_procedure_20_read_from_directory_2: failed checking READDIR permissions for reading "
+                    "entries in the directory at absolute path '%s' with error code %d\n",
+                    directory_absolute_path, stat);
+
+            nfs__read_dir_args__free_unpacked(readdirargs, &rpc_arena_allocator);
+
+            return create_system_error_accepted_reply();
+        }
+        if (stat == 1) {
+            // client does not have correct permission to read entries in this directory
+            nfs_stat = NFS__STAT__NFSERR_ACCES;
+        }
+    }
+    // there's no other supported authentication flavor yet (this function only receives credential+verifier pairs with
+    // supported authentication flavor)
+
+    if (nfs_stat != NFS__STAT__NFS_OK) {
+        nfs__read_dir_args__free_unpacked(readdirargs, &rpc_arena_allocator);
+
+        return create_nfs_error_accepted_reply(NFS_RESULTS_READ_DIR2_RES, nfs_stat);
+    }
+
+    // if client requested to read too many entries in a single RPC, truncate the read down to NFS_MAX_TRANSFER_SIZE
+    // bytes
+    if (readdirargs->count > NFS_MAX_TRANSFER_SIZE) {
+        readdirargs->count = NFS_MAX_TRANSFER_SIZE;
+    }
+
+    // read entries from the directory
+    Nfs__ReadDir2Ok readdir2ok = NFS__READ_DIR2_OK__INIT;
+    int error_code = read_from_directory_2(credential->auth_sys, directory_absolute_path, directory_inode_number,
+                                           &readdir_sessions_list, readdirargs->cookie->value, readdirargs->count,
+                                           &readdir2ok);
+    if (error_code > 0) {
+        // we failed reading directory entries
+        fprintf(stderr,
+                "serve_nfs_procedure_20_read_from_directory_2: failed reading directory entries for directory at "
+                "absolute path '%s' with error code %d\n",
+                directory_absolute_path, error_code);
+
+        nfs__read_dir_args__free_unpacked(readdirargs, &rpc_arena_allocator);
+
+        // return AcceptedReply with SYSTEM_ERR, as this shouldn't happen once we've decoded the NFS filehandle for this
+        // directory back to its absolute path
+        return create_system_error_accepted_reply();
+    }
+
+    // build the procedure results
+    Nfs__ReadDir2Res readdir2res = NFS__READ_DIR2_RES__INIT;
+
+    Nfs__NfsStat nfs_status = NFS__NFS_STAT__INIT;
+    nfs_status.stat = NFS__STAT__NFS_OK;
+
+    readdir2res.nfs_status = &nfs_status;
+    readdir2res.body_case = NFS__READ_DIR2_RES__BODY_READDIR2OK;
+    readdir2res.readdir2ok = &readdir2ok;
+
+    // serialize the procedure results
+    size_t readdir2res_size = get_rpc_payload_packed_size(codec, &readdir2res.base);
+    uint8_t *readdir2res_buffer = allocate_rpc_payload_buffer(readdir2res_size);
+    pack_rpc_payload(codec, &readdir2res.base, readdir2res_buffer);
+
+    Rpc__AcceptedReply *accepted_reply =
+        wrap_procedure_results_in_successful_accepted_reply(readdir2res_size, readdir2res_buffer, "nfs/ReadDir2Res");
+
+    nfs__read_dir_args__free_unpacked(readdirargs, &rpc_arena_allocator);
+
+    clean_up_read_dir2_ok(&readdir2ok);
+
+    return accepted_reply;
+}
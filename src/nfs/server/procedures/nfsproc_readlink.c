@@ -13,6 +13,8 @@
 Rpc__AcceptedReply *serve_nfs_procedure_5_read_from_symbolic_link(Rpc__OpaqueAuth *credential,
                                                                   Rpc__OpaqueAuth *verifier,
                                                                   Google__Protobuf__Any *parameters) {
+    RpcCodec codec = get_rpc_call_codec();
+
     // check parameters are of expected type for this procedure
     if (parameters->type_url == NULL || strcmp(parameters->type_url, "nfs/FHandle") != 0) {
         fprintf(stderr, "serve_nfs_procedure_5_read_from_symbolic_link: expected nfs/FHandle but received %s\n",
@@ -22,7 +24,8 @@ Rpc__AcceptedReply *serve_nfs_procedure_5_read_from_symbolic_link(Rpc__OpaqueAut
     }
 
     // deserialize parameters
-    Nfs__FHandle *symlink_fhandle = nfs__fhandle__unpack(NULL, parameters->value.len, parameters->value.data);
+    Nfs__FHandle *symlink_fhandle = unpack_rpc_payload(codec, &nfs__fhandle__descriptor, &rpc_arena_allocator,
+                                                       parameters->value.len, parameters->value.data);
     if (symlink_fhandle == NULL) {
         fprintf(stderr, "serve_nfs_procedure_5_read_from_symbolic_link: failed to unpack FHandle\n");
 
@@ -31,7 +34,7 @@ Rpc__AcceptedReply *serve_nfs_procedure_5_read_from_symbolic_link(Rpc__OpaqueAut
     if (symlink_fhandle->nfs_filehandle == NULL) {
         fprintf(stderr, "serve_nfs_procedure_5_read_from_symbolic_link: 'nfs_filehandle' in FHandle is null\n");
 
-        nfs__fhandle__free_unpacked(symlink_fhandle, NULL);
+        nfs__fhandle__free_unpacked(symlink_fhandle, &rpc_arena_allocator);
 
         return create_garbage_args_accepted_reply();
     }
@@ -48,21 +51,9 @@ Rpc__AcceptedReply *serve_nfs_procedure_5_read_from_symbolic_link(Rpc__OpaqueAut
             "serve_nfs_procedure_5_read_from_symbolic_link: failed to decode inode number %ld back to a directory\n",
             inode_number);
 
-        // build the procedure results
-        Nfs__ReadLinkRes *readlinkres = create_default_case_read_link_res(NFS__STAT__NFSERR_NOENT);
-
-        // serialize the procedure results
-        size_t readlinkres_size = nfs__read_link_res__get_packed_size(readlinkres);
-        uint8_t *readlinkres_buffer = malloc(readlinkres_size);
-        nfs__read_link_res__pack(readlinkres, readlinkres_buffer);
-
-        nfs__fhandle__free_unpacked(symlink_fhandle, NULL);
-        free(readlinkres->nfs_status);
-        free(readlinkres->default_case);
-        free(readlinkres);
+        nfs__fhandle__free_unpacked(symlink_fhandle, &rpc_arena_allocator);
 
-        return wrap_procedure_results_in_successful_accepted_reply(readlinkres_size, readlinkres_buffer,
-                                                                   "nfs/ReadLinkRes");
+        return create_nfs_error_accepted_reply(NFS_RESULTS_READ_LINK_RES, NFS__STAT__NFSERR_NOENT);
     }
 
     // get the attributes of this directory, to check that it is actually a symbolic link
@@ -75,7 +66,7 @@ Rpc__AcceptedReply *serve_nfs_procedure_5_read_from_symbolic_link(Rpc__OpaqueAut
                 "file/directory at absolute path '%s' with error code %d\n",
                 symlink_absolute_path, error_code);
 
-        nfs__fhandle__free_unpacked(symlink_fhandle, NULL);
+        nfs__fhandle__free_unpacked(symlink_fhandle, &rpc_arena_allocator);
 
         // return AcceptedReply with SYSTEM_ERR, as this shouldn't happen once we've decoded the NFS filehandle for this
         // directory back to its absolute path
@@ -88,22 +79,10 @@ Rpc__AcceptedReply *serve_nfs_procedure_5_read_from_symbolic_link(Rpc__OpaqueAut
                 "not a symbolic link\n",
                 symlink_absolute_path);
 
-        // build the procedure results
-        Nfs__ReadLinkRes *readlinkres = create_default_case_read_link_res(NFS__STAT__NFSERR_STALE);
-
-        // serialize the procedure results
-        size_t readlinkres_size = nfs__read_link_res__get_packed_size(readlinkres);
-        uint8_t *readlinkres_buffer = malloc(readlinkres_size);
-        nfs__read_link_res__pack(readlinkres, readlinkres_buffer);
-
         clean_up_fattr(&fattr);
-        nfs__fhandle__free_unpacked(symlink_fhandle, NULL);
-        free(readlinkres->nfs_status);
-        free(readlinkres->default_case);
-        free(readlinkres);
+        nfs__fhandle__free_unpacked(symlink_fhandle, &rpc_arena_allocator);
 
-        return wrap_procedure_results_in_successful_accepted_reply(readlinkres_size, readlinkres_buffer,
-                                                                   "nfs/ReadLinkRes");
+        return create_nfs_error_accepted_reply(NFS_RESULTS_READ_LINK_RES, NFS__STAT__NFSERR_STALE);
     }
     clean_up_fattr(&fattr);
 
@@ -117,28 +96,16 @@ Rpc__AcceptedReply *serve_nfs_procedure_5_read_from_symbolic_link(Rpc__OpaqueAut
                     "the path inside the symbolic link at absolute path '%s' with error code %d\n",
                     symlink_absolute_path, stat);
 
-            nfs__fhandle__free_unpacked(symlink_fhandle, NULL);
+            nfs__fhandle__free_unpacked(symlink_fhandle, &rpc_arena_allocator);
 
             return create_system_error_accepted_reply();
         }
 
         // client does not have correct permission to read from this symbolic link
         if (stat == 1) {
-            // build the procedure results
-            Nfs__ReadLinkRes *readlinkres = create_default_case_read_link_res(NFS__STAT__NFSERR_ACCES);
+            nfs__fhandle__free_unpacked(symlink_fhandle, &rpc_arena_allocator);
 
-            // serialize the procedure results
-            size_t readlinkres_size = nfs__read_link_res__get_packed_size(readlinkres);
-            uint8_t *readlinkres_buffer = malloc(readlinkres_size);
-            nfs__read_link_res__pack(readlinkres, readlinkres_buffer);
-
-            nfs__fhandle__free_unpacked(symlink_fhandle, NULL);
-            free(readlinkres->nfs_status);
-            free(readlinkres->default_case);
-            free(readlinkres);
-
-            return wrap_procedure_results_in_successful_accepted_reply(readlinkres_size, readlinkres_buffer,
-                                                                       "nfs/ReadLinkRes");
+            return create_nfs_error_accepted_reply(NFS_RESULTS_READ_LINK_RES, NFS__STAT__NFSERR_ACCES);
         }
     }
     // there's no other supported authentication flavor yet (this function only receives credential+verifier pairs with
@@ -149,27 +116,15 @@ Rpc__AcceptedReply *serve_nfs_procedure_5_read_from_symbolic_link(Rpc__OpaqueAut
     int bytes_read = readlink(symlink_absolute_path, target_path, NFS_MAXPATHLEN);
     if (bytes_read < 0) {
         if (errno == EIO) {
-            // build the procedure results
-            Nfs__ReadLinkRes *readlinkres = create_default_case_read_link_res(NFS__STAT__NFSERR_IO);
-
-            // serialize the procedure results
-            size_t readlinkres_size = nfs__read_link_res__get_packed_size(readlinkres);
-            uint8_t *readlinkres_buffer = malloc(readlinkres_size);
-            nfs__read_link_res__pack(readlinkres, readlinkres_buffer);
-
-            nfs__fhandle__free_unpacked(symlink_fhandle, NULL);
-            free(readlinkres->nfs_status);
-            free(readlinkres->default_case);
-            free(readlinkres);
+            nfs__fhandle__free_unpacked(symlink_fhandle, &rpc_arena_allocator);
 
-            return wrap_procedure_results_in_successful_accepted_reply(readlinkres_size, readlinkres_buffer,
-                                                                       "nfs/ReadLinkRes");
+            return create_nfs_error_accepted_reply(NFS_RESULTS_READ_LINK_RES, NFS__STAT__NFSERR_IO);
         } else {
             perror_msg("serve_nfs_procedure_5_read_from_symbolic_link: failed reading the path inside the symbolic "
                        "link at absolute path '%s'\n",
                        symlink_absolute_path);
 
-            nfs__fhandle__free_unpacked(symlink_fhandle, NULL);
+            nfs__fhandle__free_unpacked(symlink_fhandle, &rpc_arena_allocator);
 
             return create_system_error_accepted_reply();
         }
@@ -191,14 +146,14 @@ Rpc__AcceptedReply *serve_nfs_procedure_5_read_from_symbolic_link(Rpc__OpaqueAut
     readlinkres.data = &path;
 
     // serialize the procedure results
-    size_t readlinkres_size = nfs__read_link_res__get_packed_size(&readlinkres);
-    uint8_t *readlinkres_buffer = malloc(readlinkres_size);
-    nfs__read_link_res__pack(&readlinkres, readlinkres_buffer);
+    size_t readlinkres_size = get_rpc_payload_packed_size(codec, &readlinkres.base);
+    uint8_t *readlinkres_buffer = allocate_rpc_payload_buffer(readlinkres_size);
+    pack_rpc_payload(codec, &readlinkres.base, readlinkres_buffer);
 
     Rpc__AcceptedReply *accepted_reply =
         wrap_procedure_results_in_successful_accepted_reply(readlinkres_size, readlinkres_buffer, "nfs/ReadLinkRes");
 
-    nfs__fhandle__free_unpacked(symlink_fhandle, NULL);
+    nfs__fhandle__free_unpacked(symlink_fhandle, &rpc_arena_allocator);
 
     return accepted_reply;
 }
\ No newline at end of file
@@ -12,6 +12,8 @@
  */
 Rpc__AcceptedReply *serve_nfs_procedure_10_remove_file(Rpc__OpaqueAuth *credential, Rpc__OpaqueAuth *verifier,
                                                        Google__Protobuf__Any *parameters) {
+    RpcCodec codec = get_rpc_call_codec();
+
     // check parameters are of expected type for this procedure
     if (parameters->type_url == NULL || strcmp(parameters->type_url, "nfs/DirOpArgs") != 0) {
         fprintf(stderr, "serve_nfs_procedure_10_remove_file: expected nfs/DirOpArgs but received %s\n",
@@ -21,7 +23,8 @@ Rpc__AcceptedReply *serve_nfs_procedure_10_remove_file(Rpc__OpaqueAuth *credenti
     }
 
     // deserialize parameters
-    Nfs__DirOpArgs *diropargs = nfs__dir_op_args__unpack(NULL, parameters->value.len, parameters->value.data);
+    Nfs__DirOpArgs *diropargs = unpack_rpc_payload(codec, &nfs__dir_op_args__descriptor, &rpc_arena_allocator,
+                                                   parameters->value.len, parameters->value.data);
     if (diropargs == NULL) {
         fprintf(stderr, "serve_nfs_procedure_10_remove_file: failed to unpack DirOpArgs\n");
 
@@ -30,7 +33,7 @@ Rpc__AcceptedReply *serve_nfs_procedure_10_remove_file(Rpc__OpaqueAuth *credenti
     if (diropargs->dir == NULL) {
         fprintf(stderr, "serve_nfs_procedure_10_remove_file: 'dir' in DirOpArgs is null\n");
 
-        nfs__dir_op_args__free_unpacked(diropargs, NULL);
+        nfs__dir_op_args__free_unpacked(diropargs, &rpc_arena_allocator);
 
         return create_garbage_args_accepted_reply();
     }
@@ -38,14 +41,14 @@ Rpc__AcceptedReply *serve_nfs_procedure_10_remove_file(Rpc__OpaqueAuth *credenti
     if (directory_fhandle->nfs_filehandle == NULL) {
         fprintf(stderr, "serve_nfs_procedure_10_remove_file: FHandle->nfs_filehandle is null\n");
 
-        nfs__dir_op_args__free_unpacked(diropargs, NULL);
+        nfs__dir_op_args__free_unpacked(diropargs, &rpc_arena_allocator);
 
         return create_garbage_args_accepted_reply();
     }
     if (diropargs->name == NULL) {
         fprintf(stderr, "serve_nfs_procedure_10_remove_file: 'name' in DirOpArgs is null\n");
 
-        nfs__dir_op_args__free_unpacked(diropargs, NULL);
+        nfs__dir_op_args__free_unpacked(diropargs, &rpc_arena_allocator);
 
         return create_garbage_args_accepted_reply();
     }
@@ -53,7 +56,7 @@ Rpc__AcceptedReply *serve_nfs_procedure_10_remove_file(Rpc__OpaqueAuth *credenti
     if (file_name->filename == NULL) {
         fprintf(stderr, "serve_nfs_procedure_10_remove_file: FileName->filename is null\n");
 
-        nfs__dir_op_args__free_unpacked(diropargs, NULL);
+        nfs__dir_op_args__free_unpacked(diropargs, &rpc_arena_allocator);
 
         return create_garbage_args_accepted_reply();
     }
@@ -68,18 +71,9 @@ Rpc__AcceptedReply *serve_nfs_procedure_10_remove_file(Rpc__OpaqueAuth *credenti
         fprintf(stderr, "serve_nfs_procedure_10_remove_file: failed to decode inode number %ld back to a directory\n",
                 inode_number);
 
-        // build the procedure results
-        Nfs__NfsStat *nfs_status = create_nfs_stat(NFS__STAT__NFSERR_NOENT);
-
-        // serialize the procedure results
-        size_t nfsstat_size = nfs__nfs_stat__get_packed_size(nfs_status);
-        uint8_t *nfsstat_buffer = malloc(nfsstat_size);
-        nfs__nfs_stat__pack(nfs_status, nfsstat_buffer);
+        nfs__dir_op_args__free_unpacked(diropargs, &rpc_arena_allocator);
 
-        nfs__dir_op_args__free_unpacked(diropargs, NULL);
-        free(nfs_status);
-
-        return wrap_procedure_results_in_successful_accepted_reply(nfsstat_size, nfsstat_buffer, "nfs/NfsStat");
+        return create_nfs_error_accepted_reply(NFS_RESULTS_NFS_STAT, NFS__STAT__NFSERR_NOENT);
     }
 
     // get the attributes of this directory, to check that it is actually a directory
@@ -92,7 +86,7 @@ Rpc__AcceptedReply *serve_nfs_procedure_10_remove_file(Rpc__OpaqueAuth *credenti
                 "absolute path '%s' with error code %d\n",
                 directory_absolute_path, error_code);
 
-        nfs__dir_op_args__free_unpacked(diropargs, NULL);
+        nfs__dir_op_args__free_unpacked(diropargs, &rpc_arena_allocator);
 
         // return AcceptedReply with SYSTEM_ERR, as this shouldn't happen once we've decoded the NFS filehandle for this
         // directory back to its absolute path
@@ -103,19 +97,10 @@ Rpc__AcceptedReply *serve_nfs_procedure_10_remove_file(Rpc__OpaqueAuth *credenti
         fprintf(stderr, "serve_nfs_procedure_10_remove_file: 'remove' procedure called on a non-directory '%s'\n",
                 directory_absolute_path);
 
-        // build the procedure results
-        Nfs__NfsStat *nfs_status = create_nfs_stat(NFS__STAT__NFSERR_NOTDIR);
-
-        // serialize the procedure results
-        size_t nfsstat_size = nfs__nfs_stat__get_packed_size(nfs_status);
-        uint8_t *nfsstat_buffer = malloc(nfsstat_size);
-        nfs__nfs_stat__pack(nfs_status, nfsstat_buffer);
-
         clean_up_fattr(&directory_fattr);
-        nfs__dir_op_args__free_unpacked(diropargs, NULL);
-        free(nfs_status);
+        nfs__dir_op_args__free_unpacked(diropargs, &rpc_arena_allocator);
 
-        return wrap_procedure_results_in_successful_accepted_reply(nfsstat_size, nfsstat_buffer, "nfs/NfsStat");
+        return create_nfs_error_accepted_reply(NFS_RESULTS_NFS_STAT, NFS__STAT__NFSERR_NOTDIR);
     }
     clean_up_fattr(&directory_fattr);
 
@@ -135,26 +120,17 @@ Rpc__AcceptedReply *serve_nfs_procedure_10_remove_file(Rpc__OpaqueAuth *credenti
                 break;
             }
 
-            // build the procedure results
-            Nfs__NfsStat *nfs_status = create_nfs_stat(nfs_stat);
-
-            // serialize the procedure results
-            size_t nfsstat_size = nfs__nfs_stat__get_packed_size(nfs_status);
-            uint8_t *nfsstat_buffer = malloc(nfsstat_size);
-            nfs__nfs_stat__pack(nfs_status, nfsstat_buffer);
-
             free(file_absolute_path);
-            nfs__dir_op_args__free_unpacked(diropargs, NULL);
-            free(nfs_status);
+            nfs__dir_op_args__free_unpacked(diropargs, &rpc_arena_allocator);
 
-            return wrap_procedure_results_in_successful_accepted_reply(nfsstat_size, nfsstat_buffer, "nfs/NfsStat");
+            return create_nfs_error_accepted_reply(NFS_RESULTS_NFS_STAT, nfs_stat);
         } else {
             perror_msg("serve_nfs_procedure_10_remove_file: failed checking if file to be deleted at absolute path "
                        "'%s' already exists",
                        file_absolute_path);
 
             free(file_absolute_path);
-            nfs__dir_op_args__free_unpacked(diropargs, NULL);
+            nfs__dir_op_args__free_unpacked(diropargs, &rpc_arena_allocator);
 
             return create_system_error_accepted_reply();
         }
@@ -171,7 +147,7 @@ Rpc__AcceptedReply *serve_nfs_procedure_10_remove_file(Rpc__OpaqueAuth *credenti
                 file_absolute_path, error_code);
 
         free(file_absolute_path);
-        nfs__dir_op_args__free_unpacked(diropargs, NULL);
+        nfs__dir_op_args__free_unpacked(diropargs, &rpc_arena_allocator);
 
         // return AcceptedReply with SYSTEM_ERR, as this shouldn't happen once we've decoded the NFS filehandle for this
         // file back to its absolute path
@@ -186,20 +162,11 @@ Rpc__AcceptedReply *serve_nfs_procedure_10_remove_file(Rpc__OpaqueAuth *credenti
                 "non-directory operation\n",
                 file_absolute_path);
 
-        // build the procedure results
-        Nfs__NfsStat *nfs_status = create_nfs_stat(NFS__STAT__NFSERR_ISDIR);
-
-        // serialize the procedure results
-        size_t nfsstat_size = nfs__nfs_stat__get_packed_size(nfs_status);
-        uint8_t *nfsstat_buffer = malloc(nfsstat_size);
-        nfs__nfs_stat__pack(nfs_status, nfsstat_buffer);
-
         clean_up_fattr(&fattr);
         free(file_absolute_path);
-        nfs__dir_op_args__free_unpacked(diropargs, NULL);
-        free(nfs_status);
+        nfs__dir_op_args__free_unpacked(diropargs, &rpc_arena_allocator);
 
-        return wrap_procedure_results_in_successful_accepted_reply(nfsstat_size, nfsstat_buffer, "nfs/NfsStat");
+        return create_nfs_error_accepted_reply(NFS_RESULTS_NFS_STAT, NFS__STAT__NFSERR_ISDIR);
     }
     clean_up_fattr(&fattr);
 
@@ -214,31 +181,26 @@ Rpc__AcceptedReply *serve_nfs_procedure_10_remove_file(Rpc__OpaqueAuth *credenti
                     file_absolute_path, stat);
 
             free(file_absolute_path);
-            nfs__dir_op_args__free_unpacked(diropargs, NULL);
+            nfs__dir_op_args__free_unpacked(diropargs, &rpc_arena_allocator);
 
             return create_system_error_accepted_reply();
         }
 
         // client does not have correct permission to remove this file
         if (stat == 1) {
-            // build the procedure results
-            Nfs__NfsStat *nfs_status = create_nfs_stat(NFS__STAT__NFSERR_ACCES);
-
-            // serialize the procedure results
-            size_t nfsstat_size = nfs__nfs_stat__get_packed_size(nfs_status);
-            uint8_t *nfsstat_buffer = malloc(nfsstat_size);
-            nfs__nfs_stat__pack(nfs_status, nfsstat_buffer);
-
             free(file_absolute_path);
-            nfs__dir_op_args__free_unpacked(diropargs, NULL);
-            free(nfs_status);
+            nfs__dir_op_args__free_unpacked(diropargs, &rpc_arena_allocator);
 
-            return wrap_procedure_results_in_successful_accepted_reply(nfsstat_size, nfsstat_buffer, "nfs/NfsStat");
+            return create_nfs_error_accepted_reply(NFS_RESULTS_NFS_STAT, NFS__STAT__NFSERR_ACCES);
         }
     }
     // there's no other supported authentication flavor yet (this function only receives credential+verifier pairs with
     // supported authentication flavor)
 
+    // the cached GETATTR results of the directory and of the file (whose link count drops) are stale once it's deleted
+    invalidate_cached_attr_stat(&attributes_cache, inode_number);
+    invalidate_cached_attr_stat(&attributes_cache, file_stat.st_ino);
+
     // delete the file name
     error_code = unlink(file_absolute_path);
     if (error_code < 0) {
@@ -268,25 +230,16 @@ Rpc__AcceptedReply *serve_nfs_procedure_10_remove_file(Rpc__OpaqueAuth *credenti
                 break;
             }
 
-            // build the procedure results
-            Nfs__NfsStat *nfs_status = create_nfs_stat(nfs_stat);
-
-            // serialize the procedure results
-            size_t nfsstat_size = nfs__nfs_stat__get_packed_size(nfs_status);
-            uint8_t *nfsstat_buffer = malloc(nfsstat_size);
-            nfs__nfs_stat__pack(nfs_status, nfsstat_buffer);
-
             free(file_absolute_path);
-            nfs__dir_op_args__free_unpacked(diropargs, NULL);
-            free(nfs_status);
+            nfs__dir_op_args__free_unpacked(diropargs, &rpc_arena_allocator);
 
-            return wrap_procedure_results_in_successful_accepted_reply(nfsstat_size, nfsstat_buffer, "nfs/NfsStat");
+            return create_nfs_error_accepted_reply(NFS_RESULTS_NFS_STAT, nfs_stat);
         } else {
             perror_msg("serve_nfs_procedure_10_remove_file: failed to 'unlink' the file at absolute path '%s'\n",
                        file_absolute_path);
 
             free(file_absolute_path);
-            nfs__dir_op_args__free_unpacked(diropargs, NULL);
+            nfs__dir_op_args__free_unpacked(diropargs, &rpc_arena_allocator);
 
             return create_system_error_accepted_reply();
         }
@@ -300,7 +253,7 @@ Rpc__AcceptedReply *serve_nfs_procedure_10_remove_file(Rpc__OpaqueAuth *credenti
             file_absolute_path);
 
         free(file_absolute_path);
-        nfs__dir_op_args__free_unpacked(diropargs, NULL);
+        nfs__dir_op_args__free_unpacked(diropargs, &rpc_arena_allocator);
 
         return create_system_error_accepted_reply();
     }
@@ -311,15 +264,15 @@ Rpc__AcceptedReply *serve_nfs_procedure_10_remove_file(Rpc__OpaqueAuth *credenti
     nfsstat.stat = NFS__STAT__NFS_OK;
 
     // serialize the procedure results
-    size_t nfsstat_size = nfs__nfs_stat__get_packed_size(&nfsstat);
-    uint8_t *nfsstat_buffer = malloc(nfsstat_size);
-    nfs__nfs_stat__pack(&nfsstat, nfsstat_buffer);
+    size_t nfsstat_size = get_rpc_payload_packed_size(codec, &nfsstat.base);
+    uint8_t *nfsstat_buffer = allocate_rpc_payload_buffer(nfsstat_size);
+    pack_rpc_payload(codec, &nfsstat.base, nfsstat_buffer);
 
     Rpc__AcceptedReply *accepted_reply =
         wrap_procedure_results_in_successful_accepted_reply(nfsstat_size, nfsstat_buffer, "nfs/NfsStat");
 
     free(file_absolute_path);
-    nfs__dir_op_args__free_unpacked(diropargs, NULL);
+    nfs__dir_op_args__free_unpacked(diropargs, &rpc_arena_allocator);
 
     return accepted_reply;
 }
\ No newline at end of file
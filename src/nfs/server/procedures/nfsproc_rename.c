@@ -14,6 +14,8 @@
  */
 Rpc__AcceptedReply *serve_nfs_procedure_11_rename_file(Rpc__OpaqueAuth *credential, Rpc__OpaqueAuth *verifier,
                                                        Google__Protobuf__Any *parameters) {
+    RpcCodec codec = get_rpc_call_codec();
+
     // check parameters are of expected type for this procedure
     if (parameters->type_url == NULL || strcmp(parameters->type_url, "nfs/RenameArgs") != 0) {
         fprintf(stderr, "serve_nfs_procedure_11_rename_file: expected nfs/RenameArgs but received %s\n",
@@ -23,7 +25,8 @@ Rpc__AcceptedReply *serve_nfs_procedure_11_rename_file(Rpc__OpaqueAuth *credenti
     }
 
     // deserialize parameters
-    Nfs__RenameArgs *renameargs = nfs__rename_args__unpack(NULL, parameters->value.len, parameters->value.data);
+    Nfs__RenameArgs *renameargs = unpack_rpc_payload(codec, &nfs__rename_args__descriptor, &rpc_arena_allocator,
+                                                     parameters->value.len, parameters->value.data);
     if (renameargs == NULL) {
         fprintf(stderr, "serve_nfs_procedure_11_rename_file: failed to unpack RenameArgs\n");
 
@@ -32,7 +35,7 @@ Rpc__AcceptedReply *serve_nfs_procedure_11_rename_file(Rpc__OpaqueAuth *credenti
     if (renameargs->from == NULL) {
         fprintf(stderr, "serve_nfs_procedure_11_rename_file: 'from' in RenameArgs is null\n");
 
-        nfs__rename_args__free_unpacked(renameargs, NULL);
+        nfs__rename_args__free_unpacked(renameargs, &rpc_arena_allocator);
 
         return create_garbage_args_accepted_reply();
     }
@@ -40,7 +43,7 @@ Rpc__AcceptedReply *serve_nfs_procedure_11_rename_file(Rpc__OpaqueAuth *credenti
     if (from->dir == NULL) {
         fprintf(stderr, "serve_nfs_procedure_11_rename_file: from->dir is null\n");
 
-        nfs__rename_args__free_unpacked(renameargs, NULL);
+        nfs__rename_args__free_unpacked(renameargs, &rpc_arena_allocator);
 
         return create_garbage_args_accepted_reply();
     }
@@ -48,14 +51,14 @@ Rpc__AcceptedReply *serve_nfs_procedure_11_rename_file(Rpc__OpaqueAuth *credenti
     if (from_directory_fhandle->nfs_filehandle == NULL) {
         fprintf(stderr, "serve_nfs_procedure_11_rename_file: FHandle->nfs_filehandle is null\n");
 
-        nfs__rename_args__free_unpacked(renameargs, NULL);
+        nfs__rename_args__free_unpacked(renameargs, &rpc_arena_allocator);
 
         return create_garbage_args_accepted_reply();
     }
     if (from->name == NULL) {
         fprintf(stderr, "serve_nfs_procedure_11_rename_file: from->name is null\n");
 
-        nfs__rename_args__free_unpacked(renameargs, NULL);
+        nfs__rename_args__free_unpacked(renameargs, &rpc_arena_allocator);
 
         return create_garbage_args_accepted_reply();
     }
@@ -63,14 +66,14 @@ Rpc__AcceptedReply *serve_nfs_procedure_11_rename_file(Rpc__OpaqueAuth *credenti
     if (from_file_name->filename == NULL) {
         fprintf(stderr, "serve_nfs_procedure_11_rename_file: FileName->filename is null\n");
 
-        nfs__rename_args__free_unpacked(renameargs, NULL);
+        nfs__rename_args__free_unpacked(renameargs, &rpc_arena_allocator);
 
         return create_garbage_args_accepted_reply();
     }
     if (renameargs->to == NULL) {
         fprintf(stderr, "serve_nfs_procedure_11_rename_file: 'to' in RenameArgs is null\n");
 
-        nfs__rename_args__free_unpacked(renameargs, NULL);
+        nfs__rename_args__free_unpacked(renameargs, &rpc_arena_allocator);
 
         return create_garbage_args_accepted_reply();
     }
@@ -78,7 +81,7 @@ Rpc__AcceptedReply *serve_nfs_procedure_11_rename_file(Rpc__OpaqueAuth *credenti
     if (to->dir == NULL) {
         fprintf(stderr, "serve_nfs_procedure_11_rename_file: to->dir is null\n");
 
-        nfs__rename_args__free_unpacked(renameargs, NULL);
+        nfs__rename_args__free_unpacked(renameargs, &rpc_arena_allocator);
 
         return create_garbage_args_accepted_reply();
     }
@@ -86,14 +89,14 @@ Rpc__AcceptedReply *serve_nfs_procedure_11_rename_file(Rpc__OpaqueAuth *credenti
     if (to_directory_fhandle->nfs_filehandle == NULL) {
         fprintf(stderr, "serve_nfs_procedure_11_rename_file: FHandle->nfs_filehandle is null\n");
 
-        nfs__rename_args__free_unpacked(renameargs, NULL);
+        nfs__rename_args__free_unpacked(renameargs, &rpc_arena_allocator);
 
         return create_garbage_args_accepted_reply();
     }
     if (to->name == NULL) {
         fprintf(stderr, "serve_nfs_procedure_11_rename_file: to->name is null\n");
 
-        nfs__rename_args__free_unpacked(renameargs, NULL);
+        nfs__rename_args__free_unpacked(renameargs, &rpc_arena_allocator);
 
         return create_garbage_args_accepted_reply();
     }
@@ -101,7 +104,7 @@ Rpc__AcceptedReply *serve_nfs_procedure_11_rename_file(Rpc__OpaqueAuth *credenti
     if (to_file_name->filename == NULL) {
         fprintf(stderr, "serve_nfs_procedure_11_rename_file: FileName->filename is null\n");
 
-        nfs__rename_args__free_unpacked(renameargs, NULL);
+        nfs__rename_args__free_unpacked(renameargs, &rpc_arena_allocator);
 
         return create_garbage_args_accepted_reply();
     }
@@ -116,18 +119,9 @@ Rpc__AcceptedReply *serve_nfs_procedure_11_rename_file(Rpc__OpaqueAuth *credenti
         fprintf(stderr, "serve_nfs_procedure_11_rename_file: failed to decode inode number %ld back to a directory\n",
                 from_dir_inode_number);
 
-        // build the procedure results
-        Nfs__NfsStat *nfs_status = create_nfs_stat(NFS__STAT__NFSERR_NOENT);
-
-        // serialize the procedure results
-        size_t nfsstat_size = nfs__nfs_stat__get_packed_size(nfs_status);
-        uint8_t *nfsstat_buffer = malloc(nfsstat_size);
-        nfs__nfs_stat__pack(nfs_status, nfsstat_buffer);
-
-        nfs__rename_args__free_unpacked(renameargs, NULL);
-        free(nfs_status);
+        nfs__rename_args__free_unpacked(renameargs, &rpc_arena_allocator);
 
-        return wrap_procedure_results_in_successful_accepted_reply(nfsstat_size, nfsstat_buffer, "nfs/NfsStat");
+        return create_nfs_error_accepted_reply(NFS_RESULTS_NFS_STAT, NFS__STAT__NFSERR_NOENT);
     }
 
     // get the attributes of the 'from' directory, to check that it is actually a directory
@@ -140,7 +134,7 @@ Rpc__AcceptedReply *serve_nfs_procedure_11_rename_file(Rpc__OpaqueAuth *credenti
                 "absolute path '%s' with error code %d\n",
                 from_directory_absolute_path, error_code);
 
-        nfs__rename_args__free_unpacked(renameargs, NULL);
+        nfs__rename_args__free_unpacked(renameargs, &rpc_arena_allocator);
 
         // return AcceptedReply with SYSTEM_ERR, as this shouldn't happen once we've decoded the NFS filehandle for this
         // directory back to its absolute path
@@ -153,19 +147,10 @@ Rpc__AcceptedReply *serve_nfs_procedure_11_rename_file(Rpc__OpaqueAuth *credenti
             "serve_nfs_procedure_11_rename_file: 'rename' procedure called with 'from' being a non-directory '%s'\n",
             from_directory_absolute_path);
 
-        // build the procedure results
-        Nfs__NfsStat *nfs_status = create_nfs_stat(NFS__STAT__NFSERR_NOTDIR);
-
-        // serialize the procedure results
-        size_t nfsstat_size = nfs__nfs_stat__get_packed_size(nfs_status);
-        uint8_t *nfsstat_buffer = malloc(nfsstat_size);
-        nfs__nfs_stat__pack(nfs_status, nfsstat_buffer);
-
         clean_up_fattr(&from_directory_fattr);
-        nfs__rename_args__free_unpacked(renameargs, NULL);
-        free(nfs_status);
+        nfs__rename_args__free_unpacked(renameargs, &rpc_arena_allocator);
 
-        return wrap_procedure_results_in_successful_accepted_reply(nfsstat_size, nfsstat_buffer, "nfs/NfsStat");
+        return create_nfs_error_accepted_reply(NFS_RESULTS_NFS_STAT, NFS__STAT__NFSERR_NOTDIR);
     }
     clean_up_fattr(&from_directory_fattr);
 
@@ -185,26 +170,17 @@ Rpc__AcceptedReply *serve_nfs_procedure_11_rename_file(Rpc__OpaqueAuth *credenti
                 break;
             }
 
-            // build the procedure results
-            Nfs__NfsStat *nfs_status = create_nfs_stat(nfs_stat);
-
-            // serialize the procedure results
-            size_t nfsstat_size = nfs__nfs_stat__get_packed_size(nfs_status);
-            uint8_t *nfsstat_buffer = malloc(nfsstat_size);
-            nfs__nfs_stat__pack(nfs_status, nfsstat_buffer);
-
             free(old_file_absolute_path);
-            nfs__rename_args__free_unpacked(renameargs, NULL);
-            free(nfs_status);
+            nfs__rename_args__free_unpacked(renameargs, &rpc_arena_allocator);
 
-            return wrap_procedure_results_in_successful_accepted_reply(nfsstat_size, nfsstat_buffer, "nfs/NfsStat");
+            return create_nfs_error_accepted_reply(NFS_RESULTS_NFS_STAT, nfs_stat);
         } else {
             perror_msg("serve_nfs_procedure_11_rename_file: failed checking if file to be renamed at absolute path "
                        "'%s' already exists",
                        old_file_absolute_path);
 
             free(old_file_absolute_path);
-            nfs__rename_args__free_unpacked(renameargs, NULL);
+            nfs__rename_args__free_unpacked(renameargs, &rpc_arena_allocator);
 
             return create_system_error_accepted_reply();
         }
@@ -220,19 +196,10 @@ Rpc__AcceptedReply *serve_nfs_procedure_11_rename_file(Rpc__OpaqueAuth *credenti
         fprintf(stderr, "serve_nfs_procedure_11_rename_file: failed to decode inode number %ld back to a directory\n",
                 to_dir_inode_number);
 
-        // build the procedure results
-        Nfs__NfsStat *nfs_status = create_nfs_stat(NFS__STAT__NFSERR_NOENT);
-
-        // serialize the procedure results
-        size_t nfsstat_size = nfs__nfs_stat__get_packed_size(nfs_status);
-        uint8_t *nfsstat_buffer = malloc(nfsstat_size);
-        nfs__nfs_stat__pack(nfs_status, nfsstat_buffer);
-
         free(old_file_absolute_path);
-        nfs__rename_args__free_unpacked(renameargs, NULL);
-        free(nfs_status);
+        nfs__rename_args__free_unpacked(renameargs, &rpc_arena_allocator);
 
-        return wrap_procedure_results_in_successful_accepted_reply(nfsstat_size, nfsstat_buffer, "nfs/NfsStat");
+        return create_nfs_error_accepted_reply(NFS_RESULTS_NFS_STAT, NFS__STAT__NFSERR_NOENT);
     }
 
     // get the attributes of the 'to' directory, to check that it is actually a directory
@@ -246,7 +213,7 @@ Rpc__AcceptedReply *serve_nfs_procedure_11_rename_file(Rpc__OpaqueAuth *credenti
                 to_directory_absolute_path, error_code);
 
         free(old_file_absolute_path);
-        nfs__rename_args__free_unpacked(renameargs, NULL);
+        nfs__rename_args__free_unpacked(renameargs, &rpc_arena_allocator);
 
         // return AcceptedReply with SYSTEM_ERR, as this shouldn't happen once we've decoded the NFS filehandle for this
         // directory back to its absolute path
@@ -258,20 +225,11 @@ Rpc__AcceptedReply *serve_nfs_procedure_11_rename_file(Rpc__OpaqueAuth *credenti
                 "serve_nfs_procedure_11_rename_file: 'rename' procedure called with 'to' being a non-directory '%s'\n",
                 to_directory_absolute_path);
 
-        // build the procedure results
-        Nfs__NfsStat *nfs_status = create_nfs_stat(NFS__STAT__NFSERR_NOTDIR);
-
-        // serialize the procedure results
-        size_t nfsstat_size = nfs__nfs_stat__get_packed_size(nfs_status);
-        uint8_t *nfsstat_buffer = malloc(nfsstat_size);
-        nfs__nfs_stat__pack(nfs_status, nfsstat_buffer);
-
         clean_up_fattr(&to_directory_fattr);
         free(old_file_absolute_path);
-        nfs__rename_args__free_unpacked(renameargs, NULL);
-        free(nfs_status);
+        nfs__rename_args__free_unpacked(renameargs, &rpc_arena_allocator);
 
-        return wrap_procedure_results_in_successful_accepted_reply(nfsstat_size, nfsstat_buffer, "nfs/NfsStat");
+        return create_nfs_error_accepted_reply(NFS_RESULTS_NFS_STAT, NFS__STAT__NFSERR_NOTDIR);
     }
     clean_up_fattr(&to_directory_fattr);
 
@@ -286,26 +244,17 @@ Rpc__AcceptedReply *serve_nfs_procedure_11_rename_file(Rpc__OpaqueAuth *credenti
                     old_file_absolute_path, to_directory_absolute_path, to_file_name->filename, stat);
 
             free(old_file_absolute_path);
-            nfs__rename_args__free_unpacked(renameargs, NULL);
+            nfs__rename_args__free_unpacked(renameargs, &rpc_arena_allocator);
 
             return create_system_error_accepted_reply();
         }
 
         // client does not have correct permission to move file
         if (stat == 1) {
-            // build the procedure results
-            Nfs__NfsStat *nfs_status = create_nfs_stat(NFS__STAT__NFSERR_ACCES);
-
-            // serialize the procedure results
-            size_t nfsstat_size = nfs__nfs_stat__get_packed_size(nfs_status);
-            uint8_t *nfsstat_buffer = malloc(nfsstat_size);
-            nfs__nfs_stat__pack(nfs_status, nfsstat_buffer);
-
             free(old_file_absolute_path);
-            nfs__rename_args__free_unpacked(renameargs, NULL);
-            free(nfs_status);
+            nfs__rename_args__free_unpacked(renameargs, &rpc_arena_allocator);
 
-            return wrap_procedure_results_in_successful_accepted_reply(nfsstat_size, nfsstat_buffer, "nfs/NfsStat");
+            return create_nfs_error_accepted_reply(NFS_RESULTS_NFS_STAT, NFS__STAT__NFSERR_ACCES);
         }
     }
     // there's no other supported authentication flavor yet (this function only receives credential+verifier pairs with
@@ -313,6 +262,17 @@ Rpc__AcceptedReply *serve_nfs_procedure_11_rename_file(Rpc__OpaqueAuth *credenti
 
     // rename the file/directory
     char *new_file_absolute_path = get_file_absolute_path(to_directory_absolute_path, to_file_name->filename);
+
+    // the cached GETATTR results of both directories, of the renamed file, and of any file it replaces are stale once
+    // it's renamed
+    invalidate_cached_attr_stat(&attributes_cache, from_dir_inode_number);
+    invalidate_cached_attr_stat(&attributes_cache, to_dir_inode_number);
+    invalidate_cached_attr_stat(&attributes_cache, file_stat.st_ino);
+    struct stat replaced_file_stat;
+    if (lstat(new_file_absolute_path, &replaced_file_stat) == 0) {
+        invalidate_cached_attr_stat(&attributes_cache, replaced_file_stat.st_ino);
+    }
+
     error_code = rename(old_file_absolute_path, new_file_absolute_path);
     if (error_code < 0) {
         if (errno == EDQUOT || errno == EINVAL || errno == ENAMETOOLONG || errno == ENOENT || errno == ENOSPC ||
@@ -369,20 +329,11 @@ Rpc__AcceptedReply *serve_nfs_procedure_11_rename_file(Rpc__OpaqueAuth *credenti
                 break;
             }
 
-            // build the procedure results
-            Nfs__NfsStat *nfs_status = create_nfs_stat(nfs_stat);
-
-            // serialize the procedure results
-            size_t nfsstat_size = nfs__nfs_stat__get_packed_size(nfs_status);
-            uint8_t *nfsstat_buffer = malloc(nfsstat_size);
-            nfs__nfs_stat__pack(nfs_status, nfsstat_buffer);
-
             free(old_file_absolute_path);
             free(new_file_absolute_path);
-            nfs__rename_args__free_unpacked(renameargs, NULL);
-            free(nfs_status);
+            nfs__rename_args__free_unpacked(renameargs, &rpc_arena_allocator);
 
-            return wrap_procedure_results_in_successful_accepted_reply(nfsstat_size, nfsstat_buffer, "nfs/NfsStat");
+            return create_nfs_error_accepted_reply(NFS_RESULTS_NFS_STAT, nfs_stat);
         } else {
             perror_msg("serve_nfs_procedure_11_rename_file: failed to 'rename' the file at absolute path '%s' to "
                        "absolute path '%s'\n",
@@ -390,7 +341,7 @@ Rpc__AcceptedReply *serve_nfs_procedure_11_rename_file(Rpc__OpaqueAuth *credenti
 
             free(old_file_absolute_path);
             free(new_file_absolute_path);
-            nfs__rename_args__free_unpacked(renameargs, NULL);
+            nfs__rename_args__free_unpacked(renameargs, &rpc_arena_allocator);
 
             return create_system_error_accepted_reply();
         }
@@ -406,7 +357,7 @@ Rpc__AcceptedReply *serve_nfs_procedure_11_rename_file(Rpc__OpaqueAuth *credenti
 
         free(old_file_absolute_path);
         free(new_file_absolute_path);
-        nfs__rename_args__free_unpacked(renameargs, NULL);
+        nfs__rename_args__free_unpacked(renameargs, &rpc_arena_allocator);
 
         return create_system_error_accepted_reply();
     }
@@ -417,16 +368,16 @@ Rpc__AcceptedReply *serve_nfs_procedure_11_rename_file(Rpc__OpaqueAuth *credenti
     nfsstat.stat = NFS__STAT__NFS_OK;
 
     // serialize the procedure results
-    size_t nfsstat_size = nfs__nfs_stat__get_packed_size(&nfsstat);
-    uint8_t *nfsstat_buffer = malloc(nfsstat_size);
-    nfs__nfs_stat__pack(&nfsstat, nfsstat_buffer);
+    size_t nfsstat_size = get_rpc_payload_packed_size(codec, &nfsstat.base);
+    uint8_t *nfsstat_buffer = allocate_rpc_payload_buffer(nfsstat_size);
+    pack_rpc_payload(codec, &nfsstat.base, nfsstat_buffer);
 
     Rpc__AcceptedReply *accepted_reply =
         wrap_procedure_results_in_successful_accepted_reply(nfsstat_size, nfsstat_buffer, "nfs/NfsStat");
 
     free(old_file_absolute_path);
     free(new_file_absolute_path);
-    nfs__rename_args__free_unpacked(renameargs, NULL);
+    nfs__rename_args__free_unpacked(renameargs, &rpc_arena_allocator);
 
     return accepted_reply;
 }
\ No newline at end of file
@@ -12,6 +12,8 @@
  */
 Rpc__AcceptedReply *serve_nfs_procedure_2_set_file_attributes(Rpc__OpaqueAuth *credential, Rpc__OpaqueAuth *verifier,
                                                               Google__Protobuf__Any *parameters) {
+    RpcCodec codec = get_rpc_call_codec();
+
     // check parameters are of expected type for this procedure
     if (parameters->type_url == NULL || strcmp(parameters->type_url, "nfs/SAttrArgs") != 0) {
         fprintf(stderr, "serve_nfs_procedure_2_set_file_attributes: expected nfs/SAttrArgs but received %s\n",
@@ -21,7 +23,8 @@ Rpc__AcceptedReply *serve_nfs_procedure_2_set_file_attributes(Rpc__OpaqueAuth *c
     }
 
     // deserialize parameters
-    Nfs__SAttrArgs *sattrargs = nfs__sattr_args__unpack(NULL, parameters->value.len, parameters->value.data);
+    Nfs__SAttrArgs *sattrargs = unpack_rpc_payload(codec, &nfs__sattr_args__descriptor, &rpc_arena_allocator,
+                                                   parameters->value.len, parameters->value.data);
     if (sattrargs == NULL) {
         fprintf(stderr, "serve_nfs_procedure_2_set_file_attributes: failed to unpack SAttrArgs\n");
 
@@ -30,7 +33,7 @@ Rpc__AcceptedReply *serve_nfs_procedure_2_set_file_attributes(Rpc__OpaqueAuth *c
     if (sattrargs->file == NULL) {
         fprintf(stderr, "serve_nfs_procedure_2_set_file_attributes: 'file' in SAttrArgs is null\n");
 
-        nfs__sattr_args__free_unpacked(sattrargs, NULL);
+        nfs__sattr_args__free_unpacked(sattrargs, &rpc_arena_allocator);
 
         return create_garbage_args_accepted_reply();
     }
@@ -38,14 +41,14 @@ Rpc__AcceptedReply *serve_nfs_procedure_2_set_file_attributes(Rpc__OpaqueAuth *c
     if (fhandle->nfs_filehandle == NULL) {
         fprintf(stderr, "serve_nfs_procedure_2_set_file_attributes: FHandle->nfs_filehandle is null\n");
 
-        nfs__sattr_args__free_unpacked(sattrargs, NULL);
+        nfs__sattr_args__free_unpacked(sattrargs, &rpc_arena_allocator);
 
         return create_garbage_args_accepted_reply();
     }
     if (sattrargs->attributes == NULL) {
         fprintf(stderr, "serve_nfs_procedure_2_set_file_attributes: 'attributes' in SAttrArgs is null\n");
 
-        nfs__sattr_args__free_unpacked(sattrargs, NULL);
+        nfs__sattr_args__free_unpacked(sattrargs, &rpc_arena_allocator);
 
         return create_garbage_args_accepted_reply();
     }
@@ -53,14 +56,14 @@ Rpc__AcceptedReply *serve_nfs_procedure_2_set_file_attributes(Rpc__OpaqueAuth *c
     if (sattr->atime == NULL) {
         fprintf(stderr, "serve_nfs_procedure_2_set_file_attributes: 'atime' in SAttrArgs is null\n");
 
-        nfs__sattr_args__free_unpacked(sattrargs, NULL);
+        nfs__sattr_args__free_unpacked(sattrargs, &rpc_arena_allocator);
 
         return create_garbage_args_accepted_reply();
     }
     if (sattr->mtime == NULL) {
         fprintf(stderr, "serve_nfs_procedure_2_set_file_attributes: 'mtime' in SAttrArgs is null\n");
 
-        nfs__sattr_args__free_unpacked(sattrargs, NULL);
+        nfs__sattr_args__free_unpacked(sattrargs, &rpc_arena_allocator);
 
         return create_garbage_args_accepted_reply();
     }
@@ -77,20 +80,9 @@ Rpc__AcceptedReply *serve_nfs_procedure_2_set_file_attributes(Rpc__OpaqueAuth *c
             "serve_nfs_procedure_2_set_file_attributes: failed to decode inode number %ld back to a file/directory\n",
             inode_number);
 
-        // build the procedure results
-        Nfs__AttrStat *attr_stat = create_default_case_attr_stat(NFS__STAT__NFSERR_NOENT);
-
-        // serialize the procedure results
-        size_t attr_stat_size = nfs__attr_stat__get_packed_size(attr_stat);
-        uint8_t *attr_stat_buffer = malloc(attr_stat_size);
-        nfs__attr_stat__pack(attr_stat, attr_stat_buffer);
-
-        nfs__sattr_args__free_unpacked(sattrargs, NULL);
-        free(attr_stat->nfs_status);
-        free(attr_stat->default_case);
-        free(attr_stat);
+        nfs__sattr_args__free_unpacked(sattrargs, &rpc_arena_allocator);
 
-        return wrap_procedure_results_in_successful_accepted_reply(attr_stat_size, attr_stat_buffer, "nfs/AttrStat");
+        return create_nfs_error_accepted_reply(NFS_RESULTS_ATTR_STAT, NFS__STAT__NFSERR_NOENT);
     }
 
     // check permissions
@@ -103,33 +95,24 @@ Rpc__AcceptedReply *serve_nfs_procedure_2_set_file_attributes(Rpc__OpaqueAuth *c
                     "at absolute path '%s' with error code %d\n",
                     file_absolute_path, stat);
 
-            nfs__fhandle__free_unpacked(fhandle, NULL);
+            nfs__fhandle__free_unpacked(fhandle, &rpc_arena_allocator);
 
             return create_system_error_accepted_reply();
         }
 
         // client does not have correct permission to set attributes of this file/directory
         if (stat == 1) {
-            // build the procedure results
-            Nfs__AttrStat *attr_stat = create_default_case_attr_stat(NFS__STAT__NFSERR_ACCES);
+            nfs__sattr_args__free_unpacked(sattrargs, &rpc_arena_allocator);
 
-            // serialize the procedure results
-            size_t attr_stat_size = nfs__attr_stat__get_packed_size(attr_stat);
-            uint8_t *attr_stat_buffer = malloc(attr_stat_size);
-            nfs__attr_stat__pack(attr_stat, attr_stat_buffer);
-
-            nfs__sattr_args__free_unpacked(sattrargs, NULL);
-            free(attr_stat->nfs_status);
-            free(attr_stat->default_case);
-            free(attr_stat);
-
-            return wrap_procedure_results_in_successful_accepted_reply(attr_stat_size, attr_stat_buffer,
-                                                                       "nfs/AttrStat");
+            return create_nfs_error_accepted_reply(NFS_RESULTS_ATTR_STAT, NFS__STAT__NFSERR_ACCES);
         }
     }
     // there's no other supported authentication flavor yet (this function only receives credential+verifier pairs with
     // supported authentication flavor)
 
+    // the cached GETATTR results of this file are stale once any of its attributes is updated
+    invalidate_cached_attr_stat(&attributes_cache, inode_number);
+
     // update file attributes - -1 means don't update this attribute
     // TODO (QNFS-21) - change this to either update all arguments or none (don't want a partial update)
     if (sattr->mode != -1 && chmod(file_absolute_path, sattr->mode) < 0) {
@@ -137,7 +120,7 @@ Rpc__AcceptedReply *serve_nfs_procedure_2_set_file_attributes(Rpc__OpaqueAuth *c
                    "absolute path '%s'\n",
                    file_absolute_path);
 
-        nfs__sattr_args__free_unpacked(sattrargs, NULL);
+        nfs__sattr_args__free_unpacked(sattrargs, &rpc_arena_allocator);
 
         return create_system_error_accepted_reply();
     }
@@ -147,7 +130,7 @@ Rpc__AcceptedReply *serve_nfs_procedure_2_set_file_attributes(Rpc__OpaqueAuth *c
                    "file/directory at absolute path '%s'\n",
                    file_absolute_path);
 
-        nfs__sattr_args__free_unpacked(sattrargs, NULL);
+        nfs__sattr_args__free_unpacked(sattrargs, &rpc_arena_allocator);
 
         return create_system_error_accepted_reply();
     }
@@ -156,7 +139,7 @@ Rpc__AcceptedReply *serve_nfs_procedure_2_set_file_attributes(Rpc__OpaqueAuth *c
                    "absolute path '%s'\n",
                    file_absolute_path);
 
-        nfs__sattr_args__free_unpacked(sattrargs, NULL);
+        nfs__sattr_args__free_unpacked(sattrargs, &rpc_arena_allocator);
 
         return create_system_error_accepted_reply();
     }
@@ -173,7 +156,7 @@ Rpc__AcceptedReply *serve_nfs_procedure_2_set_file_attributes(Rpc__OpaqueAuth *c
                        "file/directory at absolute path '%s'\n",
                        file_absolute_path);
 
-            nfs__sattr_args__free_unpacked(sattrargs, NULL);
+            nfs__sattr_args__free_unpacked(sattrargs, &rpc_arena_allocator);
 
             return create_system_error_accepted_reply();
         }
@@ -187,7 +170,7 @@ Rpc__AcceptedReply *serve_nfs_procedure_2_set_file_attributes(Rpc__OpaqueAuth *c
                 "'%s' with error code %d \n",
                 file_absolute_path, error_code);
 
-        nfs__sattr_args__free_unpacked(sattrargs, NULL);
+        nfs__sattr_args__free_unpacked(sattrargs, &rpc_arena_allocator);
 
         // we return AcceptedReply with SYSTEM_ERR, as this shouldn't happen once we've decoded inode number to a file
         return create_system_error_accepted_reply();
@@ -204,14 +187,14 @@ Rpc__AcceptedReply *serve_nfs_procedure_2_set_file_attributes(Rpc__OpaqueAuth *c
     attr_stat.attributes = &fattr;
 
     // serialize the procedure results
-    size_t attr_stat_size = nfs__attr_stat__get_packed_size(&attr_stat);
-    uint8_t *attr_stat_buffer = malloc(attr_stat_size);
-    nfs__attr_stat__pack(&attr_stat, attr_stat_buffer);
+    size_t attr_stat_size = get_rpc_payload_packed_size(codec, &attr_stat.base);
+    uint8_t *attr_stat_buffer = allocate_rpc_payload_buffer(attr_stat_size);
+    pack_rpc_payload(codec, &attr_stat.base, attr_stat_buffer);
 
     Rpc__AcceptedReply *accepted_reply =
         wrap_procedure_results_in_successful_accepted_reply(attr_stat_size, attr_stat_buffer, "nfs/AttrStat");
 
-    nfs__sattr_args__free_unpacked(sattrargs, NULL);
+    nfs__sattr_args__free_unpacked(sattrargs, &rpc_arena_allocator);
     clean_up_fattr(&fattr);
 
     return accepted_reply;
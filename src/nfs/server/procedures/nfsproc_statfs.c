@@ -15,6 +15,8 @@
 Rpc__AcceptedReply *serve_nfs_procedure_17_get_filesystem_attributes(Rpc__OpaqueAuth *credential,
                                                                      Rpc__OpaqueAuth *verifier,
                                                                      Google__Protobuf__Any *parameters) {
+    RpcCodec codec = get_rpc_call_codec();
+
     // check parameters are of expected type for this procedure
     if (parameters->type_url == NULL || strcmp(parameters->type_url, "nfs/FHandle") != 0) {
         fprintf(stderr, "serve_nfs_procedure_17_get_filesystem_attributes: expected nfs/FHandle but received %s\n",
@@ -24,7 +26,8 @@ Rpc__AcceptedReply *serve_nfs_procedure_17_get_filesystem_attributes(Rpc__Opaque
     }
 
     // deserialize parameters
-    Nfs__FHandle *fhandle = nfs__fhandle__unpack(NULL, parameters->value.len, parameters->value.data);
+    Nfs__FHandle *fhandle = unpack_rpc_payload(codec, &nfs__fhandle__descriptor, &rpc_arena_allocator,
+                                               parameters->value.len, parameters->value.data);
     if (fhandle == NULL) {
         fprintf(stderr, "serve_nfs_procedure_17_get_filesystem_attributes: failed to unpack FHandle\n");
 
@@ -33,7 +36,7 @@ Rpc__AcceptedReply *serve_nfs_procedure_17_get_filesystem_attributes(Rpc__Opaque
     if (fhandle->nfs_filehandle == NULL) {
         fprintf(stderr, "serve_nfs_procedure_17_get_filesystem_attributes: FHandle->nfs_filehandle is null\n");
 
-        nfs__fhandle__free_unpacked(fhandle, NULL);
+        nfs__fhandle__free_unpacked(fhandle, &rpc_arena_allocator);
 
         return create_garbage_args_accepted_reply();
     }
@@ -50,20 +53,9 @@ Rpc__AcceptedReply *serve_nfs_procedure_17_get_filesystem_attributes(Rpc__Opaque
                 "file/directory\n",
                 inode_number);
 
-        // build the procedure results
-        Nfs__StatFsRes *statfsres = create_default_case_stat_fs_res(NFS__STAT__NFSERR_NOENT);
-
-        // serialize the procedure results
-        size_t statfsres_size = nfs__stat_fs_res__get_packed_size(statfsres);
-        uint8_t *statfsres_buffer = malloc(statfsres_size);
-        nfs__stat_fs_res__pack(statfsres, statfsres_buffer);
+        nfs__fhandle__free_unpacked(fhandle, &rpc_arena_allocator);
 
-        nfs__fhandle__free_unpacked(fhandle, NULL);
-        free(statfsres->nfs_status);
-        free(statfsres->default_case);
-        free(statfsres);
-
-        return wrap_procedure_results_in_successful_accepted_reply(statfsres_size, statfsres_buffer, "nfs/StatFsRes");
+        return create_nfs_error_accepted_reply(NFS_RESULTS_STAT_FS_RES, NFS__STAT__NFSERR_NOENT);
     }
 
     // check permissions
@@ -76,28 +68,16 @@ Rpc__AcceptedReply *serve_nfs_procedure_17_get_filesystem_attributes(Rpc__Opaque
                     "attributes of the file system which contains the file '%s' with error code %d\n",
                     file_absolute_path, stat);
 
-            nfs__fhandle__free_unpacked(fhandle, NULL);
+            nfs__fhandle__free_unpacked(fhandle, &rpc_arena_allocator);
 
             return create_system_error_accepted_reply();
         }
 
         // client does not have correct permission to get attributes of this file system
         if (stat == 1) {
-            // build the procedure results
-            Nfs__StatFsRes *statfsres = create_default_case_stat_fs_res(NFS__STAT__NFSERR_ACCES);
-
-            // serialize the procedure results
-            size_t statfsres_size = nfs__stat_fs_res__get_packed_size(statfsres);
-            uint8_t *statfsres_buffer = malloc(statfsres_size);
-            nfs__stat_fs_res__pack(statfsres, statfsres_buffer);
+            nfs__fhandle__free_unpacked(fhandle, &rpc_arena_allocator);
 
-            nfs__fhandle__free_unpacked(fhandle, NULL);
-            free(statfsres->nfs_status);
-            free(statfsres->default_case);
-            free(statfsres);
-
-            return wrap_procedure_results_in_successful_accepted_reply(statfsres_size, statfsres_buffer,
-                                                                       "nfs/StatFsRes");
+            return create_nfs_error_accepted_reply(NFS_RESULTS_STAT_FS_RES, NFS__STAT__NFSERR_ACCES);
         }
     }
     // there's no other supported authentication flavor yet (this function only receives credential+verifier pairs with
@@ -108,26 +88,14 @@ Rpc__AcceptedReply *serve_nfs_procedure_17_get_filesystem_attributes(Rpc__Opaque
     int error_code = statvfs(file_absolute_path, &fs_stat);
     if (error_code < 0) {
         if (errno == EIO) {
-            // build the procedure results
-            Nfs__StatFsRes *statfsres = create_default_case_stat_fs_res(NFS__STAT__NFSERR_IO);
-
-            // serialize the procedure results
-            size_t statfsres_size = nfs__stat_fs_res__get_packed_size(statfsres);
-            uint8_t *statfsres_buffer = malloc(statfsres_size);
-            nfs__stat_fs_res__pack(statfsres, statfsres_buffer);
-
-            nfs__fhandle__free_unpacked(fhandle, NULL);
-            free(statfsres->nfs_status);
-            free(statfsres->default_case);
-            free(statfsres);
+            nfs__fhandle__free_unpacked(fhandle, &rpc_arena_allocator);
 
-            return wrap_procedure_results_in_successful_accepted_reply(statfsres_size, statfsres_buffer,
-                                                                       "nfs/StatFsRes");
+            return create_nfs_error_accepted_reply(NFS_RESULTS_STAT_FS_RES, NFS__STAT__NFSERR_IO);
         } else {
             perror_msg(
                 "serve_nfs_procedure_17_get_filesystem_attributes: failed getting attributes of the filesystem\n");
 
-            nfs__fhandle__free_unpacked(fhandle, NULL);
+            nfs__fhandle__free_unpacked(fhandle, &rpc_arena_allocator);
 
             // we return AcceptedReply with SYSTEM_ERR, as this shouldn't happen once we've decoded inode number to a
             // file
@@ -145,23 +113,24 @@ Rpc__AcceptedReply *serve_nfs_procedure_17_get_filesystem_attributes(Rpc__Opaque
     statfsres.body_case = NFS__STAT_FS_RES__BODY_FS_INFO;
 
     Nfs__FsInfo fsinfo = NFS__FS_INFO__INIT;
-    fsinfo.tsize = fs_stat.f_bsize;
+    fsinfo.tsize = NFS_MAX_TRANSFER_SIZE; // clients size their READs, WRITEs and READDIR2s from this
     fsinfo.bsize = fs_stat.f_frsize;
     fsinfo.blocks = fs_stat.f_blocks;
     fsinfo.bfree = fs_stat.f_bfree;
     fsinfo.bavail = fs_stat.f_bavail;
+    fsinfo.compression_algorithms = get_supported_rpc_compressions(); // clients pick their compression from these
 
     statfsres.fs_info = &fsinfo;
 
     // serialize the procedure results
-    size_t statfsres_size = nfs__stat_fs_res__get_packed_size(&statfsres);
-    uint8_t *statfsres_buffer = malloc(statfsres_size);
-    nfs__stat_fs_res__pack(&statfsres, statfsres_buffer);
+    size_t statfsres_size = get_rpc_payload_packed_size(codec, &statfsres.base);
+    uint8_t *statfsres_buffer = allocate_rpc_payload_buffer(statfsres_size);
+    pack_rpc_payload(codec, &statfsres.base, statfsres_buffer);
 
     Rpc__AcceptedReply *accepted_reply =
         wrap_procedure_results_in_successful_accepted_reply(statfsres_size, statfsres_buffer, "nfs/StatFsRes");
 
-    nfs__fhandle__free_unpacked(fhandle, NULL);
+    nfs__fhandle__free_unpacked(fhandle, &rpc_arena_allocator);
 
     return accepted_reply;
 }
\ No newline at end of file
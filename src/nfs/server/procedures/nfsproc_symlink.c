@@ -12,6 +12,8 @@
  */
 Rpc__AcceptedReply *serve_nfs_procedure_13_create_symbolic_link(Rpc__OpaqueAuth *credential, Rpc__OpaqueAuth *verifier,
                                                                 Google__Protobuf__Any *parameters) {
+    RpcCodec codec = get_rpc_call_codec();
+
     // check parameters are of expected type for this procedure
     if (parameters->type_url == NULL || strcmp(parameters->type_url, "nfs/SymLinkArgs") != 0) {
         fprintf(stderr, "serve_nfs_procedure_13_create_symbolic_link: expected nfs/SymLinkArgs but received %s\n",
@@ -21,7 +23,8 @@ Rpc__AcceptedReply *serve_nfs_procedure_13_create_symbolic_link(Rpc__OpaqueAuth
     }
 
     // deserialize parameters
-    Nfs__SymLinkArgs *symlinkargs = nfs__sym_link_args__unpack(NULL, parameters->value.len, parameters->value.data);
+    Nfs__SymLinkArgs *symlinkargs = unpack_rpc_payload(codec, &nfs__sym_link_args__descriptor, &rpc_arena_allocator,
+                                                       parameters->value.len, parameters->value.data);
     if (symlinkargs == NULL) {
         fprintf(stderr, "serve_nfs_procedure_13_create_symbolic_link: failed to unpack SymLinkArgs\n");
 
@@ -30,7 +33,7 @@ Rpc__AcceptedReply *serve_nfs_procedure_13_create_symbolic_link(Rpc__OpaqueAuth
     if (symlinkargs->from == NULL) {
         fprintf(stderr, "serve_nfs_procedure_13_create_symbolic_link: 'from' in SymLinkArgs is null\n");
 
-        nfs__sym_link_args__free_unpacked(symlinkargs, NULL);
+        nfs__sym_link_args__free_unpacked(symlinkargs, &rpc_arena_allocator);
 
         return create_garbage_args_accepted_reply();
     }
@@ -38,7 +41,7 @@ Rpc__AcceptedReply *serve_nfs_procedure_13_create_symbolic_link(Rpc__OpaqueAuth
     if (from->dir == NULL) {
         fprintf(stderr, "serve_nfs_procedure_13_create_symbolic_link: DirOpArgs->dir is null\n");
 
-        nfs__sym_link_args__free_unpacked(symlinkargs, NULL);
+        nfs__sym_link_args__free_unpacked(symlinkargs, &rpc_arena_allocator);
 
         return create_garbage_args_accepted_reply();
     }
@@ -46,14 +49,14 @@ Rpc__AcceptedReply *serve_nfs_procedure_13_create_symbolic_link(Rpc__OpaqueAuth
     if (directory_fhandle->nfs_filehandle == NULL) {
         fprintf(stderr, "serve_nfs_procedure_13_create_symbolic_link: FHandle->nfs_filehandle is null\n");
 
-        nfs__sym_link_args__free_unpacked(symlinkargs, NULL);
+        nfs__sym_link_args__free_unpacked(symlinkargs, &rpc_arena_allocator);
 
         return create_garbage_args_accepted_reply();
     }
     if (from->name == NULL) {
         fprintf(stderr, "serve_nfs_procedure_13_create_symbolic_link: DirOpArgs->name is null\n");
 
-        nfs__sym_link_args__free_unpacked(symlinkargs, NULL);
+        nfs__sym_link_args__free_unpacked(symlinkargs, &rpc_arena_allocator);
 
         return create_garbage_args_accepted_reply();
     }
@@ -61,14 +64,14 @@ Rpc__AcceptedReply *serve_nfs_procedure_13_create_symbolic_link(Rpc__OpaqueAuth
     if (file_name->filename == NULL) {
         fprintf(stderr, "serve_nfs_procedure_13_create_symbolic_link: DirOpArgs->name->filename is null\n");
 
-        nfs__sym_link_args__free_unpacked(symlinkargs, NULL);
+        nfs__sym_link_args__free_unpacked(symlinkargs, &rpc_arena_allocator);
 
         return create_garbage_args_accepted_reply();
     }
     if (symlinkargs->to == NULL) {
         fprintf(stderr, "serve_nfs_procedure_13_create_symbolic_link: 'to' in SymLinkArgs is null\n");
 
-        nfs__sym_link_args__free_unpacked(symlinkargs, NULL);
+        nfs__sym_link_args__free_unpacked(symlinkargs, &rpc_arena_allocator);
 
         return create_garbage_args_accepted_reply();
     }
@@ -76,14 +79,14 @@ Rpc__AcceptedReply *serve_nfs_procedure_13_create_symbolic_link(Rpc__OpaqueAuth
     if (to->path == NULL) {
         fprintf(stderr, "serve_nfs_procedure_13_create_symbolic_link: Path->path is null\n");
 
-        nfs__sym_link_args__free_unpacked(symlinkargs, NULL);
+        nfs__sym_link_args__free_unpacked(symlinkargs, &rpc_arena_allocator);
 
         return create_garbage_args_accepted_reply();
     }
     if (symlinkargs->attributes == NULL) {
         fprintf(stderr, "serve_nfs_procedure_13_create_symbolic_link: 'attributes' in SymLinkArgs is null\n");
 
-        nfs__sym_link_args__free_unpacked(symlinkargs, NULL);
+        nfs__sym_link_args__free_unpacked(symlinkargs, &rpc_arena_allocator);
 
         return create_garbage_args_accepted_reply();
     }
@@ -91,14 +94,14 @@ Rpc__AcceptedReply *serve_nfs_procedure_13_create_symbolic_link(Rpc__OpaqueAuth
     if (sattr->atime == NULL) {
         fprintf(stderr, "serve_nfs_procedure_13_create_symbolic_link: SAttr->atime is null\n");
 
-        nfs__sym_link_args__free_unpacked(symlinkargs, NULL);
+        nfs__sym_link_args__free_unpacked(symlinkargs, &rpc_arena_allocator);
 
         return create_garbage_args_accepted_reply();
     }
     if (sattr->mtime == NULL) {
         fprintf(stderr, "serve_nfs_procedure_13_create_symbolic_link: SAttr->mtime is null\n");
 
-        nfs__sym_link_args__free_unpacked(symlinkargs, NULL);
+        nfs__sym_link_args__free_unpacked(symlinkargs, &rpc_arena_allocator);
 
         return create_garbage_args_accepted_reply();
     }
@@ -114,18 +117,9 @@ Rpc__AcceptedReply *serve_nfs_procedure_13_create_symbolic_link(Rpc__OpaqueAuth
                 "serve_nfs_procedure_13_create_symbolic_link: failed to decode inode number %ld back to a directory\n",
                 inode_number);
 
-        // build the procedure results
-        Nfs__NfsStat *nfs_status = create_nfs_stat(NFS__STAT__NFSERR_NOENT);
-
-        // serialize the procedure results
-        size_t nfsstat_size = nfs__nfs_stat__get_packed_size(nfs_status);
-        uint8_t *nfsstat_buffer = malloc(nfsstat_size);
-        nfs__nfs_stat__pack(nfs_status, nfsstat_buffer);
+        nfs__sym_link_args__free_unpacked(symlinkargs, &rpc_arena_allocator);
 
-        nfs__sym_link_args__free_unpacked(symlinkargs, NULL);
-        free(nfs_status);
-
-        return wrap_procedure_results_in_successful_accepted_reply(nfsstat_size, nfsstat_buffer, "nfs/NfsStat");
+        return create_nfs_error_accepted_reply(NFS_RESULTS_NFS_STAT, NFS__STAT__NFSERR_NOENT);
     }
 
     // get the attributes of this directory, to check that it is actually a directory
@@ -138,7 +132,7 @@ Rpc__AcceptedReply *serve_nfs_procedure_13_create_symbolic_link(Rpc__OpaqueAuth
                 "file/directory at absolute path '%s' with error code %d\n",
                 directory_absolute_path, error_code);
 
-        nfs__sym_link_args__free_unpacked(symlinkargs, NULL);
+        nfs__sym_link_args__free_unpacked(symlinkargs, &rpc_arena_allocator);
 
         // return AcceptedReply with SYSTEM_ERR, as this shouldn't happen once we've decoded the NFS filehandle for this
         // directory back to its absolute path
@@ -150,19 +144,10 @@ Rpc__AcceptedReply *serve_nfs_procedure_13_create_symbolic_link(Rpc__OpaqueAuth
                 "serve_nfs_procedure_13_create_symbolic_link: 'symlink' procedure called on a non-directory '%s'\n",
                 directory_absolute_path);
 
-        // build the procedure results
-        Nfs__NfsStat *nfs_status = create_nfs_stat(NFS__STAT__NFSERR_NOTDIR);
-
-        // serialize the procedure results
-        size_t nfsstat_size = nfs__nfs_stat__get_packed_size(nfs_status);
-        uint8_t *nfsstat_buffer = malloc(nfsstat_size);
-        nfs__nfs_stat__pack(nfs_status, nfsstat_buffer);
-
         clean_up_fattr(&directory_fattr);
-        nfs__sym_link_args__free_unpacked(symlinkargs, NULL);
-        free(nfs_status);
+        nfs__sym_link_args__free_unpacked(symlinkargs, &rpc_arena_allocator);
 
-        return wrap_procedure_results_in_successful_accepted_reply(nfsstat_size, nfsstat_buffer, "nfs/NfsStat");
+        return create_nfs_error_accepted_reply(NFS_RESULTS_NFS_STAT, NFS__STAT__NFSERR_NOTDIR);
     }
     clean_up_fattr(&directory_fattr);
 
@@ -173,18 +158,9 @@ Rpc__AcceptedReply *serve_nfs_procedure_13_create_symbolic_link(Rpc__OpaqueAuth
                 "with file name longer than NFS limit\n",
                 directory_absolute_path);
 
-        // build the procedure results
-        Nfs__NfsStat *nfs_status = create_nfs_stat(NFS__STAT__NFSERR_NAMETOOLONG);
-
-        // serialize the procedure results
-        size_t nfsstat_size = nfs__nfs_stat__get_packed_size(nfs_status);
-        uint8_t *nfsstat_buffer = malloc(nfsstat_size);
-        nfs__nfs_stat__pack(nfs_status, nfsstat_buffer);
-
-        nfs__sym_link_args__free_unpacked(symlinkargs, NULL);
-        free(nfs_status);
+        nfs__sym_link_args__free_unpacked(symlinkargs, &rpc_arena_allocator);
 
-        return wrap_procedure_results_in_successful_accepted_reply(nfsstat_size, nfsstat_buffer, "nfs/NfsStat");
+        return create_nfs_error_accepted_reply(NFS_RESULTS_NFS_STAT, NFS__STAT__NFSERR_NAMETOOLONG);
     }
 
     // check if the file client wants to create already exists
@@ -197,19 +173,10 @@ Rpc__AcceptedReply *serve_nfs_procedure_13_create_symbolic_link(Rpc__OpaqueAuth
                 "that absolute path already exists\n",
                 file_absolute_path);
 
-        // build the procedure results
-        Nfs__NfsStat *nfs_status = create_nfs_stat(NFS__STAT__NFSERR_EXIST);
-
-        // serialize the procedure results
-        size_t nfsstat_size = nfs__nfs_stat__get_packed_size(nfs_status);
-        uint8_t *nfsstat_buffer = malloc(nfsstat_size);
-        nfs__nfs_stat__pack(nfs_status, nfsstat_buffer);
-
         free(file_absolute_path);
-        nfs__sym_link_args__free_unpacked(symlinkargs, NULL);
-        free(nfs_status);
+        nfs__sym_link_args__free_unpacked(symlinkargs, &rpc_arena_allocator);
 
-        return wrap_procedure_results_in_successful_accepted_reply(nfsstat_size, nfsstat_buffer, "nfs/NfsStat");
+        return create_nfs_error_accepted_reply(NFS_RESULTS_NFS_STAT, NFS__STAT__NFSERR_EXIST);
     } else if (errno != ENOENT) {
         // we got an error different from 'ENOENT = No such file or directory'
         perror_msg("serve_nfs_procedure_13_create_symbolic_link: failed checking if symbolic link to be created at "
@@ -217,7 +184,7 @@ Rpc__AcceptedReply *serve_nfs_procedure_13_create_symbolic_link(Rpc__OpaqueAuth
                    file_absolute_path);
 
         free(file_absolute_path);
-        nfs__sym_link_args__free_unpacked(symlinkargs, NULL);
+        nfs__sym_link_args__free_unpacked(symlinkargs, &rpc_arena_allocator);
 
         return create_system_error_accepted_reply();
     }
@@ -234,31 +201,25 @@ Rpc__AcceptedReply *serve_nfs_procedure_13_create_symbolic_link(Rpc__OpaqueAuth
                     file_absolute_path, to->path, stat);
 
             free(file_absolute_path);
-            nfs__sym_link_args__free_unpacked(symlinkargs, NULL);
+            nfs__sym_link_args__free_unpacked(symlinkargs, &rpc_arena_allocator);
 
             return create_system_error_accepted_reply();
         }
 
         // client does not have correct permission to create this symbolic link
         if (stat == 1) {
-            // build the procedure results
-            Nfs__NfsStat *nfs_status = create_nfs_stat(NFS__STAT__NFSERR_ACCES);
-
-            // serialize the procedure results
-            size_t nfsstat_size = nfs__nfs_stat__get_packed_size(nfs_status);
-            uint8_t *nfsstat_buffer = malloc(nfsstat_size);
-            nfs__nfs_stat__pack(nfs_status, nfsstat_buffer);
-
             free(file_absolute_path);
-            nfs__sym_link_args__free_unpacked(symlinkargs, NULL);
-            free(nfs_status);
+            nfs__sym_link_args__free_unpacked(symlinkargs, &rpc_arena_allocator);
 
-            return wrap_procedure_results_in_successful_accepted_reply(nfsstat_size, nfsstat_buffer, "nfs/NfsStat");
+            return create_nfs_error_accepted_reply(NFS_RESULTS_NFS_STAT, NFS__STAT__NFSERR_ACCES);
         }
     }
     // there's no other supported authentication flavor yet (this function only receives credential+verifier pairs with
     // supported authentication flavor)
 
+    // the cached GETATTR results of the directory are stale once a symbolic link is created in it
+    invalidate_cached_attr_stat(&attributes_cache, inode_number);
+
     // create the symbolic link
     error_code = symlink(to->path, file_absolute_path);
     if (error_code < 0) {
@@ -304,26 +265,17 @@ Rpc__AcceptedReply *serve_nfs_procedure_13_create_symbolic_link(Rpc__OpaqueAuth
                 break;
             }
 
-            // build the procedure results
-            Nfs__NfsStat *nfs_status = create_nfs_stat(nfs_stat);
-
-            // serialize the procedure results
-            size_t nfsstat_size = nfs__nfs_stat__get_packed_size(nfs_status);
-            uint8_t *nfsstat_buffer = malloc(nfsstat_size);
-            nfs__nfs_stat__pack(nfs_status, nfsstat_buffer);
-
             free(file_absolute_path);
-            nfs__sym_link_args__free_unpacked(symlinkargs, NULL);
-            free(nfs_status);
+            nfs__sym_link_args__free_unpacked(symlinkargs, &rpc_arena_allocator);
 
-            return wrap_procedure_results_in_successful_accepted_reply(nfsstat_size, nfsstat_buffer, "nfs/NfsStat");
+            return create_nfs_error_accepted_reply(NFS_RESULTS_NFS_STAT, nfs_stat);
         } else {
             perror_msg("serve_nfs_procedure_13_create_symbolic_link: failed creating symbolic link at absolute path "
                        "'%s' to target '%s'\n",
                        file_absolute_path, to->path);
 
             free(file_absolute_path);
-            nfs__sym_link_args__free_unpacked(symlinkargs, NULL);
+            nfs__sym_link_args__free_unpacked(symlinkargs, &rpc_arena_allocator);
 
             return create_system_error_accepted_reply();
         }
@@ -334,15 +286,15 @@ Rpc__AcceptedReply *serve_nfs_procedure_13_create_symbolic_link(Rpc__OpaqueAuth
     nfsstat.stat = NFS__STAT__NFS_OK;
 
     // serialize the procedure results
-    size_t nfsstat_size = nfs__nfs_stat__get_packed_size(&nfsstat);
-    uint8_t *nfsstat_buffer = malloc(nfsstat_size);
-    nfs__nfs_stat__pack(&nfsstat, nfsstat_buffer);
+    size_t nfsstat_size = get_rpc_payload_packed_size(codec, &nfsstat.base);
+    uint8_t *nfsstat_buffer = allocate_rpc_payload_buffer(nfsstat_size);
+    pack_rpc_payload(codec, &nfsstat.base, nfsstat_buffer);
 
     Rpc__AcceptedReply *accepted_reply =
         wrap_procedure_results_in_successful_accepted_reply(nfsstat_size, nfsstat_buffer, "nfs/NfsStat");
 
     free(file_absolute_path);
-    nfs__sym_link_args__free_unpacked(symlinkargs, NULL);
+    nfs__sym_link_args__free_unpacked(symlinkargs, &rpc_arena_allocator);
 
     return accepted_reply;
 }
\ No newline at end of file
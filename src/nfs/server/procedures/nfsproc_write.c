@@ -12,6 +12,8 @@
  */
 Rpc__AcceptedReply *serve_nfs_procedure_8_write_to_file(Rpc__OpaqueAuth *credential, Rpc__OpaqueAuth *verifier,
                                                         Google__Protobuf__Any *parameters) {
+    RpcCodec codec = get_rpc_call_codec();
+
     // check parameters are of expected type for this procedure
     if (parameters->type_url == NULL || strcmp(parameters->type_url, "nfs/WriteArgs") != 0) {
         fprintf(stderr, "serve_nfs_procedure_8_write_to_file: expected nfs/WriteArgs but received %s\n",
@@ -21,7 +23,8 @@ Rpc__AcceptedReply *serve_nfs_procedure_8_write_to_file(Rpc__OpaqueAuth *credent
     }
 
     // deserialize parameters
-    Nfs__WriteArgs *writeargs = nfs__write_args__unpack(NULL, parameters->value.len, parameters->value.data);
+    Nfs__WriteArgs *writeargs = unpack_rpc_payload(codec, &nfs__write_args__descriptor, &rpc_arena_allocator,
+                                                   parameters->value.len, parameters->value.data);
     if (writeargs == NULL) {
         fprintf(stderr, "serve_nfs_procedure_8_write_to_file: failed to unpack WriteArgs\n");
 
@@ -30,7 +33,7 @@ Rpc__AcceptedReply *serve_nfs_procedure_8_write_to_file(Rpc__OpaqueAuth *credent
     if (writeargs->file == NULL) {
         fprintf(stderr, "serve_nfs_procedure_8_write_to_file: 'file' in WriteArgs is null\n");
 
-        nfs__write_args__free_unpacked(writeargs, NULL);
+        nfs__write_args__free_unpacked(writeargs, &rpc_arena_allocator);
 
         return create_garbage_args_accepted_reply();
     }
@@ -38,17 +41,28 @@ Rpc__AcceptedReply *serve_nfs_procedure_8_write_to_file(Rpc__OpaqueAuth *credent
     if (file_fhandle->nfs_filehandle == NULL) {
         fprintf(stderr, "serve_nfs_procedure_8_write_to_file: FHandle->nfs_filehandle is null\n");
 
-        nfs__write_args__free_unpacked(writeargs, NULL);
+        nfs__write_args__free_unpacked(writeargs, &rpc_arena_allocator);
 
         return create_garbage_args_accepted_reply();
     }
     if (writeargs->nfsdata.data == NULL) {
         fprintf(stderr, "serve_nfs_procedure_8_write_to_file: nfsdata.data is null\n");
 
-        nfs__write_args__free_unpacked(writeargs, NULL);
+        nfs__write_args__free_unpacked(writeargs, &rpc_arena_allocator);
+
+        return create_garbage_args_accepted_reply();
+    }
+    if (!is_rpc_compression_supported(writeargs->compression)) {
+        fprintf(stderr, "serve_nfs_procedure_8_write_to_file: nfsdata is compressed with unsupported compression %u\n",
+                writeargs->compression);
+
+        nfs__write_args__free_unpacked(writeargs, &rpc_arena_allocator);
 
         return create_garbage_args_accepted_reply();
     }
+    // size of the data to write, once decompressed
+    size_t write_size =
+        writeargs->compression == RPC_COMPRESSION_NONE ? writeargs->nfsdata.len : writeargs->uncompressed_size;
 
     NfsFh__NfsFileHandle *file_nfs_filehandle = file_fhandle->nfs_filehandle;
     ino_t inode_number = file_nfs_filehandle->inode_number;
@@ -60,20 +74,9 @@ Rpc__AcceptedReply *serve_nfs_procedure_8_write_to_file(Rpc__OpaqueAuth *credent
         fprintf(stderr, "serve_nfs_procedure_8_write_to_file: failed to decode inode number %ld back to a file\n",
                 inode_number);
 
-        // build the procedure results
-        Nfs__AttrStat *attr_stat = create_default_case_attr_stat(NFS__STAT__NFSERR_NOENT);
-
-        // serialize the procedure results
-        size_t attr_stat_size = nfs__attr_stat__get_packed_size(attr_stat);
-        uint8_t *attr_stat_buffer = malloc(attr_stat_size);
-        nfs__attr_stat__pack(attr_stat, attr_stat_buffer);
+        nfs__write_args__free_unpacked(writeargs, &rpc_arena_allocator);
 
-        nfs__write_args__free_unpacked(writeargs, NULL);
-        free(attr_stat->nfs_status);
-        free(attr_stat->default_case);
-        free(attr_stat);
-
-        return wrap_procedure_results_in_successful_accepted_reply(attr_stat_size, attr_stat_buffer, "nfs/AttrStat");
+        return create_nfs_error_accepted_reply(NFS_RESULTS_ATTR_STAT, NFS__STAT__NFSERR_NOENT);
     }
 
     // get the attributes of the looked up file before the write, to check that the file is not a directory
@@ -85,7 +88,7 @@ Rpc__AcceptedReply *serve_nfs_procedure_8_write_to_file(Rpc__OpaqueAuth *credent
                 "'%s' with error code %d\n",
                 file_absolute_path, error_code);
 
-        nfs__write_args__free_unpacked(writeargs, NULL);
+        nfs__write_args__free_unpacked(writeargs, &rpc_arena_allocator);
 
         // return AcceptedReply with SYSTEM_ERR, as this shouldn't happen once we've decoded the NFS filehandle for this
         // file back to its absolute path
@@ -100,46 +103,24 @@ Rpc__AcceptedReply *serve_nfs_procedure_8_write_to_file(Rpc__OpaqueAuth *credent
                 "non-directory operation\n",
                 file_absolute_path);
 
-        // build the procedure results
-        Nfs__AttrStat *attr_stat = create_default_case_attr_stat(NFS__STAT__NFSERR_ISDIR);
-
-        // serialize the procedure results
-        size_t attr_stat_size = nfs__attr_stat__get_packed_size(attr_stat);
-        uint8_t *attr_stat_buffer = malloc(attr_stat_size);
-        nfs__attr_stat__pack(attr_stat, attr_stat_buffer);
-
         clean_up_fattr(&fattr);
-        nfs__write_args__free_unpacked(writeargs, NULL);
-        free(attr_stat->nfs_status);
-        free(attr_stat->default_case);
-        free(attr_stat);
+        nfs__write_args__free_unpacked(writeargs, &rpc_arena_allocator);
 
-        return wrap_procedure_results_in_successful_accepted_reply(attr_stat_size, attr_stat_buffer, "nfs/AttrStat");
+        return create_nfs_error_accepted_reply(NFS_RESULTS_ATTR_STAT, NFS__STAT__NFSERR_ISDIR);
     }
     clean_up_fattr(&fattr);
 
     // check if client requested to write too much data in a single RPC
-    if (writeargs->nfsdata.len > NFS_MAXDATA) {
+    if (write_size > NFS_MAX_TRANSFER_SIZE) {
         fprintf(stderr,
                 "serve_nfs_procedure_8_write_to_file: attempted 'write' of %ld bytes to file at absolute path '%s', "
                 "but max write allowed in a single RPC is %d bytes\n",
-                writeargs->nfsdata.len, file_absolute_path, NFS_MAXDATA);
-
-        // build the procedure results
-        Nfs__AttrStat *attr_stat = create_default_case_attr_stat(
-            NFS__STAT__NFSERR_FBIG); // FBIG error is not intended for this, but it's the most similar in meaning
-
-        // serialize the procedure results
-        size_t attr_stat_size = nfs__attr_stat__get_packed_size(attr_stat);
-        uint8_t *attr_stat_buffer = malloc(attr_stat_size);
-        nfs__attr_stat__pack(attr_stat, attr_stat_buffer);
+                write_size, file_absolute_path, NFS_MAX_TRANSFER_SIZE);
 
-        nfs__write_args__free_unpacked(writeargs, NULL);
-        free(attr_stat->nfs_status);
-        free(attr_stat->default_case);
-        free(attr_stat);
+        nfs__write_args__free_unpacked(writeargs, &rpc_arena_allocator);
 
-        return wrap_procedure_results_in_successful_accepted_reply(attr_stat_size, attr_stat_buffer, "nfs/AttrStat");
+        // FBIG error is not intended for this, but it's the most similar in meaning
+        return create_nfs_error_accepted_reply(NFS_RESULTS_ATTR_STAT, NFS__STAT__NFSERR_FBIG);
     }
 
     // check permissions
@@ -152,35 +133,48 @@ Rpc__AcceptedReply *serve_nfs_procedure_8_write_to_file(Rpc__OpaqueAuth *credent
                     "'%s' with error code %d\n",
                     file_absolute_path, stat);
 
-            nfs__write_args__free_unpacked(writeargs, NULL);
+            nfs__write_args__free_unpacked(writeargs, &rpc_arena_allocator);
 
             return create_system_error_accepted_reply();
         }
 
         // client does not have correct permission to write to this file
         if (stat == 1) {
-            // build the procedure results
-            Nfs__AttrStat *attr_stat = create_default_case_attr_stat(NFS__STAT__NFSERR_ACCES);
+            nfs__write_args__free_unpacked(writeargs, &rpc_arena_allocator);
 
-            // serialize the procedure results
-            size_t attr_stat_size = nfs__attr_stat__get_packed_size(attr_stat);
-            uint8_t *attr_stat_buffer = malloc(attr_stat_size);
-            nfs__attr_stat__pack(attr_stat, attr_stat_buffer);
-
-            nfs__write_args__free_unpacked(writeargs, NULL);
-            free(attr_stat->nfs_status);
-            free(attr_stat->default_case);
-            free(attr_stat);
-
-            return wrap_procedure_results_in_successful_accepted_reply(attr_stat_size, attr_stat_buffer,
-                                                                       "nfs/AttrStat");
+            return create_nfs_error_accepted_reply(NFS_RESULTS_ATTR_STAT, NFS__STAT__NFSERR_ACCES);
         }
     }
     // there's no other supported authentication flavor yet (this function only receives credential+verifier pairs with
     // supported authentication flavor)
 
+    // decompress the data to write, if the client sent it compressed
+    uint8_t *write_data = writeargs->nfsdata.data;
+    uint8_t *decompressed_data = NULL;
+    if (writeargs->compression != RPC_COMPRESSION_NONE) {
+        decompressed_data = rpc_arena_alloc(write_size);
+        if (decompressed_data == NULL ||
+            decompress_rpc_payload_data(writeargs->compression, writeargs->nfsdata.data, writeargs->nfsdata.len,
+                                        decompressed_data, write_size) > 0) {
+            fprintf(stderr,
+                    "serve_nfs_procedure_8_write_to_file: failed to decompress %ld bytes of nfsdata into %ld bytes "
+                    "with compression %u\n",
+                    writeargs->nfsdata.len, write_size, writeargs->compression);
+
+            nfs__write_args__free_unpacked(writeargs, &rpc_arena_allocator);
+            rpc_arena_free(decompressed_data);
+
+            return create_garbage_args_accepted_reply();
+        }
+        write_data = decompressed_data;
+    }
+
+    // the cached GETATTR results of this file are stale once its size and mtime change
+    invalidate_cached_attr_stat(&attributes_cache, inode_number);
+
     // write to the file
-    error_code = write_to_file(file_absolute_path, writeargs->offset, writeargs->nfsdata.len, writeargs->nfsdata.data);
+    error_code = write_to_file(file_absolute_path, writeargs->offset, write_size, write_data);
+    rpc_arena_free(decompressed_data);
     if (error_code == 4 || error_code == 5 || error_code == 6) {
         Nfs__Stat nfs_stat;
         switch (error_code) {
@@ -207,20 +201,9 @@ Rpc__AcceptedReply *serve_nfs_procedure_8_write_to_file(Rpc__OpaqueAuth *credent
             break;
         }
 
-        // build the procedure results
-        Nfs__AttrStat *attr_stat = create_default_case_attr_stat(nfs_stat);
-
-        // serialize the procedure results
-        size_t attr_stat_size = nfs__attr_stat__get_packed_size(attr_stat);
-        uint8_t *attr_stat_buffer = malloc(attr_stat_size);
-        nfs__attr_stat__pack(attr_stat, attr_stat_buffer);
-
-        nfs__write_args__free_unpacked(writeargs, NULL);
-        free(attr_stat->nfs_status);
-        free(attr_stat->default_case);
-        free(attr_stat);
+        nfs__write_args__free_unpacked(writeargs, &rpc_arena_allocator);
 
-        return wrap_procedure_results_in_successful_accepted_reply(attr_stat_size, attr_stat_buffer, "nfs/AttrStat");
+        return create_nfs_error_accepted_reply(NFS_RESULTS_ATTR_STAT, nfs_stat);
     } else if (error_code > 0) {
         // we failed writing to this file
         fprintf(stderr,
@@ -228,7 +211,7 @@ Rpc__AcceptedReply *serve_nfs_procedure_8_write_to_file(Rpc__OpaqueAuth *credent
                 "error code %d\n",
                 file_absolute_path, error_code);
 
-        nfs__write_args__free_unpacked(writeargs, NULL);
+        nfs__write_args__free_unpacked(writeargs, &rpc_arena_allocator);
 
         return create_system_error_accepted_reply();
     }
@@ -243,7 +226,7 @@ Rpc__AcceptedReply *serve_nfs_procedure_8_write_to_file(Rpc__OpaqueAuth *credent
                 "'%s' with error code %d\n",
                 file_absolute_path, error_code);
 
-        nfs__write_args__free_unpacked(writeargs, NULL);
+        nfs__write_args__free_unpacked(writeargs, &rpc_arena_allocator);
 
         // return AcceptedReply with SYSTEM_ERR, as this shouldn't happen once we've decoded the NFS filehandle for this
         // file back to its absolute path
@@ -261,14 +244,14 @@ Rpc__AcceptedReply *serve_nfs_procedure_8_write_to_file(Rpc__OpaqueAuth *credent
     attr_stat.attributes = &fattr_after_write;
 
     // serialize the procedure results
-    size_t attr_stat_size = nfs__attr_stat__get_packed_size(&attr_stat);
-    uint8_t *attr_stat_buffer = malloc(attr_stat_size);
-    nfs__attr_stat__pack(&attr_stat, attr_stat_buffer);
+    size_t attr_stat_size = get_rpc_payload_packed_size(codec, &attr_stat.base);
+    uint8_t *attr_stat_buffer = allocate_rpc_payload_buffer(attr_stat_size);
+    pack_rpc_payload(codec, &attr_stat.base, attr_stat_buffer);
 
     Rpc__AcceptedReply *accepted_reply =
         wrap_procedure_results_in_successful_accepted_reply(attr_stat_size, attr_stat_buffer, "nfs/AttrStat");
 
-    nfs__write_args__free_unpacked(writeargs, NULL);
+    nfs__write_args__free_unpacked(writeargs, &rpc_arena_allocator);
 
     clean_up_fattr(&fattr_after_write);
 
@@ -13,10 +13,39 @@ InodeCache inode_cache;
 ReadDirSessionsList *readdir_sessions_list;
 pthread_t periodic_cleanup_thread;
 
+RpcCompressionPolicy rpc_compression_policy; // decides which READ results are worth compressing
+
+AttributesCache attributes_cache; // packed GETATTR results of recently looked at files
+
+pthread_rwlock_t server_state_lock = PTHREAD_RWLOCK_INITIALIZER;
+
 /*
  * Functions from server_common_rpc.h that each RPC program's server must implement.
  */
 
+/*
+ * Returns true if the given procedure of the given RPC program may remove or update entries in the shared server state
+ * (the inode cache and the mount list), and false if it only reads that state or adds to the inode cache.
+ *
+ * Procedures that add filehandles to the inode cache (LOOKUP, CREATE, MKDIR, READDIRPLUS) share the
+ * 'server_state_lock' with the procedures that only read it - the inode cache is never shrunk while it is shared, and
+ * 'create_nfs_filehandle' and 'get_or_create_nfs_filehandle' add to it under a lock of their own.
+ */
+bool procedure_modifies_server_state(uint32_t program_number, uint32_t procedure_number) {
+    if (program_number == MOUNT_RPC_PROGRAM_NUMBER) {
+        return procedure_number == MOUNTPROC_MNT;
+    }
+
+    switch (procedure_number) {
+    case NFSPROC_REMOVE:
+    case NFSPROC_RENAME:
+    case NFSPROC_RMDIR:
+        return true;
+    default:
+        return false;
+    }
+}
+
 /*
  * Forwards the RPC call to the specific RPC program, and returns the AcceptedReply.
  *
@@ -24,21 +53,43 @@ pthread_t periodic_cleanup_thread;
  * credential and verifier must be structurally validated (i.e. no NULL fields and correspond to a supported
  * authentication flavor) before being passed here.
  *
+ * RPCs are served concurrently by several server threads (one per client over TCP, one per event loop over QUIC),
+ * so procedures hold the 'server_state_lock' while they run - procedures that modify the shared server state hold
+ * it exclusively, and all others share it. NFSPROC_COMPOUND takes the lock itself, once it knows which procedures
+ * its operations run.
+ *
  * The user of this function takes the responsibility to deallocate the returned AcceptedReply
  * and any heap-allocated fields in it (this is done by the 'clean_up_accepted_reply' function after the RPC is sent).
  */
 Rpc__AcceptedReply *forward_rpc_call_to_program(Rpc__OpaqueAuth *credential, Rpc__OpaqueAuth *verifier,
                                                 uint32_t program_number, uint32_t program_version,
                                                 uint32_t procedure_number, Google__Protobuf__Any *parameters) {
+    if (program_number != MOUNT_RPC_PROGRAM_NUMBER && program_number != NFS_RPC_PROGRAM_NUMBER) {
+        fprintf(stderr, "Unknown program number");
+        return create_default_case_accepted_reply(RPC__ACCEPT_STAT__PROG_UNAVAIL);
+    }
+
+    bool is_compound = program_number == NFS_RPC_PROGRAM_NUMBER && procedure_number == NFSPROC_COMPOUND;
+    if (!is_compound) {
+        if (procedure_modifies_server_state(program_number, procedure_number)) {
+            pthread_rwlock_wrlock(&server_state_lock);
+        } else {
+            pthread_rwlock_rdlock(&server_state_lock);
+        }
+    }
+
+    Rpc__AcceptedReply *accepted_reply;
     if (program_number == MOUNT_RPC_PROGRAM_NUMBER) {
-        return call_mount(credential, verifier, program_version, procedure_number, parameters);
+        accepted_reply = call_mount(credential, verifier, program_version, procedure_number, parameters);
+    } else {
+        accepted_reply = call_nfs(credential, verifier, program_version, procedure_number, parameters);
     }
-    if (program_number == NFS_RPC_PROGRAM_NUMBER) {
-        return call_nfs(credential, verifier, program_version, procedure_number, parameters);
+
+    if (!is_compound) {
+        pthread_rwlock_unlock(&server_state_lock);
     }
 
-    fprintf(stderr, "Unknown program number");
-    return create_default_case_accepted_reply(RPC__ACCEPT_STAT__PROG_UNAVAIL);
+    return accepted_reply;
 }
 
 /*
@@ -58,16 +109,21 @@ void handle_signal(int signal) {
 
         switch (transport_protocol) {
         case TRANSPORT_PROTOCOL_TCP:
+        case TRANSPORT_PROTOCOL_TLS:
             clean_up_tcp_server_state();
             break;
         case TRANSPORT_PROTOCOL_QUIC:
             clean_up_quic_server_state();
             break;
+        case TRANSPORT_PROTOCOL_SHM:
+            clean_up_shm_server_state();
+            break;
         default:
         }
 
         clean_up_inode_cache(inode_cache);
         clean_up_mount_list(mount_list);
+        clean_up_auth_short_cache();
 
         // wait for the periodic cleanup thread to terminate
         pthread_cancel(periodic_cleanup_thread);
@@ -99,7 +155,8 @@ void *readdir_periodic_cleanup_thread(void *arg) {
 int main(int argc, char *argv[]) {
     // parse command line arguments
     if (argc != 3) {
-        fprintf(stderr, "Error: Incorrect usage. Correct usage: %s (<port number> or --test) (--proto=tcp or quic)\n",
+        fprintf(stderr,
+                "Error: Incorrect usage. Correct usage: %s (<port number> or --test) (--proto=tcp, tls, quic or shm)\n",
                 argv[0]);
         return 1;
     }
@@ -124,8 +181,12 @@ int main(int argc, char *argv[]) {
         char *protocol = argv[2] + strlen(proto_flag);
         if (strcmp(protocol, "tcp") == 0) {
             transport_protocol = TRANSPORT_PROTOCOL_TCP;
+        } else if (strcmp(protocol, "tls") == 0) {
+            transport_protocol = TRANSPORT_PROTOCOL_TLS;
         } else if (strcmp(protocol, "quic") == 0) {
             transport_protocol = TRANSPORT_PROTOCOL_QUIC;
+        } else if (strcmp(protocol, "shm") == 0) {
+            transport_protocol = TRANSPORT_PROTOCOL_SHM;
         } else {
             fprintf(stderr, "Error: Invalid transport protocol: %s\n", protocol);
             return 1;
@@ -148,6 +209,8 @@ int main(int argc, char *argv[]) {
     mount_list = NULL;
     inode_cache = NULL;
     readdir_sessions_list = NULL;
+    init_rpc_compression_policy(&rpc_compression_policy);
+    init_attributes_cache(&attributes_cache);
 
     // start the periodic cleanup thread
     if (pthread_create(&periodic_cleanup_thread, NULL, readdir_periodic_cleanup_thread, NULL) != 0) {
@@ -159,8 +222,12 @@ int main(int argc, char *argv[]) {
     switch (transport_protocol) {
     case TRANSPORT_PROTOCOL_TCP:
         return run_server_tcp(port_number);
+    case TRANSPORT_PROTOCOL_TLS:
+        return run_server_tls(port_number);
     case TRANSPORT_PROTOCOL_QUIC:
         return run_server_quic(port_number);
+    case TRANSPORT_PROTOCOL_SHM:
+        return run_server_shm(port_number);
     default:
         return run_server_tcp(port_number);
     }
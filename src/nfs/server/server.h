@@ -16,8 +16,10 @@
 #include <unistd.h> // read(), write(), close()
 #include <utime.h>  // changing atime, ctime
 
+#include "src/common_rpc/rpc_compression.h"
 #include "src/common_rpc/server_common_rpc.h"
 #include "src/transport/quic/quic_rpc_server.h"
+#include "src/transport/shm/shm_rpc_server.h"
 #include "src/transport/tcp/tcp_rpc_server.h"
 #include "src/transport/transport_common.h"
 
@@ -26,6 +28,7 @@
 
 #include "src/nfs/nfs_common.h"
 
+#include "attributes_cache.h"
 #include "directory_reading.h"
 #include "inode_cache.h"
 #include "mount_list.h"
@@ -59,4 +62,12 @@ extern InodeCache inode_cache;
 extern ReadDirSessionsList *readdir_sessions_list;
 extern pthread_t periodic_cleanup_thread;
 
+extern RpcCompressionPolicy rpc_compression_policy;
+
+extern AttributesCache attributes_cache;
+
+extern pthread_rwlock_t server_state_lock;
+
+bool procedure_modifies_server_state(uint32_t program_number, uint32_t procedure_number);
+
 #endif /* server__header__INCLUDED */
\ No newline at end of file
@@ -4,8 +4,6 @@
 
 #include "src/repl/soft_links/soft_links.h"
 
-#define READ_BYTES_PER_RPC 5000
-
 /*
  * Given a NFS FHandle of a file, performs a series of READ procedures
  * to read out the entire file and prints it out.
@@ -17,14 +15,16 @@ int print_file(Nfs__FHandle *file_fhandle) {
         return 1;
     }
 
+    size_t read_bytes_per_rpc = rpc_connection_context->transfer_size;
+
     uint64_t bytes_read = 0;
     uint8_t *read_data = NULL;
-    uint64_t file_size = READ_BYTES_PER_RPC; // we will know the file size after the first READ RPC
+    uint64_t file_size = read_bytes_per_rpc; // we will know the file size after the first READ RPC
     while (bytes_read < file_size) {
         Nfs__ReadArgs readargs = NFS__READ_ARGS__INIT;
         readargs.file = file_fhandle;
         readargs.offset = bytes_read;
-        readargs.count = READ_BYTES_PER_RPC;
+        readargs.count = read_bytes_per_rpc;
 
         readargs.totalcount = 0; // unused field
 
@@ -4,8 +4,6 @@
 
 #include "src/repl/soft_links/soft_links.h"
 
-#define WRITE_BYTES_PER_RPC 5000
-
 /*
  * Given a NFS FHandle of a file, performs a series of WRITE procedures
  * to append the given text to the end of the file in a new line.
@@ -64,6 +62,8 @@ int append_to_file(Nfs__FHandle *file_fhandle, char *text) {
     text_with_newline[text_length + 1] = '\0';
     text_length = text_length + 1;
 
+    size_t write_bytes_per_rpc = rpc_connection_context->transfer_size;
+
     uint64_t bytes_written = 0;
     while (bytes_written < text_length) {
         Nfs__WriteArgs writeargs = NFS__WRITE_ARGS__INIT;
@@ -72,10 +72,10 @@ int append_to_file(Nfs__FHandle *file_fhandle, char *text) {
 
         writeargs.nfsdata.data = text_with_newline + bytes_written;
         size_t bytes_left = text_length - bytes_written;
-        if (bytes_left < WRITE_BYTES_PER_RPC) {
+        if (bytes_left < write_bytes_per_rpc) {
             writeargs.nfsdata.len = bytes_left;
         } else {
-            writeargs.nfsdata.len = WRITE_BYTES_PER_RPC;
+            writeargs.nfsdata.len = write_bytes_per_rpc;
         }
 
         writeargs.beginoffset = writeargs.totalcount = 0; // unused fields
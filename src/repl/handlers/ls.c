@@ -1,15 +1,14 @@
 #include "handlers.h"
 
-#define READDIR_BYTES_PER_RPC 50
-
 typedef struct FileNamesList {
     char *filename;
+    int is_directory;
     struct FileNamesList *next;
 } FileNamesList;
 
 /*
  * If there is a directory that is currently mounted, prints out all directory entries in the current
- * working directory.
+ * working directory, with a '/' after the names of directories.
  *
  * Returns 0 on success and > 0 on failure.
  */
@@ -31,48 +30,55 @@ int handle_ls() {
         Nfs__ReadDirArgs readdirargs = NFS__READ_DIR_ARGS__INIT;
         readdirargs.dir = cwd_node->fhandle;
         readdirargs.cookie = &nfs_cookie;
-        readdirargs.count = READDIR_BYTES_PER_RPC;
+        readdirargs.count = rpc_connection_context->transfer_size;
 
-        Nfs__ReadDirRes *readdirres = malloc(sizeof(Nfs__ReadDirRes));
-        int status = nfs_procedure_16_read_from_directory(rpc_connection_context, readdirargs, readdirres);
+        Nfs__ReadDirPlusRes *readdirplusres = malloc(sizeof(Nfs__ReadDirPlusRes));
+        int status = nfs_procedure_19_read_from_directory_plus(rpc_connection_context, readdirargs, readdirplusres);
         if (status != 0) {
             printf("Error: Invalid RPC reply received from the server with status %d\n", status);
 
-            free(readdirres);
+            free(readdirplusres);
 
             return 1;
         }
 
-        if (validate_nfs_read_dir_res(readdirres) > 0) {
+        if (validate_nfs_read_dir_plus_res(readdirplusres) > 0) {
             printf("Error: Invalid NFS procedure result received from the server\n");
 
-            nfs__read_dir_res__free_unpacked(readdirres, NULL);
+            nfs__read_dir_plus_res__free_unpacked(readdirplusres, NULL);
 
             return 1;
         }
 
-        if (readdirres->nfs_status->stat == NFS__STAT__NFSERR_ACCES) {
+        if (readdirplusres->nfs_status->stat == NFS__STAT__NFSERR_ACCES) {
             printf("ls: Permission denied\n");
 
-            nfs__read_dir_res__free_unpacked(readdirres, NULL);
+            nfs__read_dir_plus_res__free_unpacked(readdirplusres, NULL);
 
             return 1;
-        } else if (readdirres->nfs_status->stat != NFS__STAT__NFS_OK) {
-            char *string_status = nfs_stat_to_string(readdirres->nfs_status->stat);
+        } else if (readdirplusres->nfs_status->stat != NFS__STAT__NFS_OK) {
+            char *string_status = nfs_stat_to_string(readdirplusres->nfs_status->stat);
             printf("Error: Failed to read entries in cwd with status %s\n", string_status);
             free(string_status);
 
-            nfs__read_dir_res__free_unpacked(readdirres, NULL);
+            nfs__read_dir_plus_res__free_unpacked(readdirplusres, NULL);
 
             return 1;
         }
 
         // remember all found directory entries
-        Nfs__DirectoryEntriesList *entries = readdirres->readdirok->entries;
+        Nfs__DirectoryEntriesPlusList *entries = readdirplusres->readdirplusok->entries;
         while (entries != NULL) {
             // add the filename to the end of the list
             FileNamesList *new_filenames_list_entry = malloc(sizeof(FileNamesList));
             new_filenames_list_entry->filename = strdup(entries->name->filename);
+            if (entries->attributes != NULL) {
+                new_filenames_list_entry->is_directory = entries->attributes->nfs_ftype->ftype == NFS__FTYPE__NFDIR;
+            } else {
+                // '.' and '..' come without attributes
+                new_filenames_list_entry->is_directory =
+                    strcmp(entries->name->filename, ".") == 0 || strcmp(entries->name->filename, "..") == 0;
+            }
             new_filenames_list_entry->next = NULL;
             if (filenames_list_tail == NULL) {
                 filenames_list_head = filenames_list_tail = new_filenames_list_entry;
@@ -87,17 +93,17 @@ int handle_ls() {
             entries = entries->nextentry;
         }
 
-        if (readdirres->readdirok->eof) {
+        if (readdirplusres->readdirplusok->eof) {
             read_all_directory_entries = 1;
         }
 
-        nfs__read_dir_res__free_unpacked(readdirres, NULL);
+        nfs__read_dir_plus_res__free_unpacked(readdirplusres, NULL);
     }
 
     // print all file names in this directory
     FileNamesList *filenames_list = filenames_list_head;
     while (filenames_list != NULL) {
-        printf("%s", filenames_list->filename);
+        printf("%s%s", filenames_list->filename, filenames_list->is_directory ? "/" : "");
 
         filenames_list = filenames_list->next;
         if (filenames_list != NULL) {
@@ -94,6 +94,12 @@ int handle_mount(char *server_ip, uint16_t server_port, char *remote_absolute_pa
 
     cwd_node = filesystem_dag_root;
 
+    // find out how much data the server moves in a single RPC and how it can be compressed - if it can't tell us, we
+    // stay with NFS_MAXDATA and no compression
+    if (negotiate_transfer_parameters(new_rpc_connection_context, *fhandle) > 0) {
+        printf("Failed to get the transfer parameters of the server, using %d bytes\n", NFS_MAXDATA);
+    }
+
     // set the new Rpc connection context
     rpc_connection_context = new_rpc_connection_context;
 
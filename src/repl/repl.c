@@ -96,14 +96,17 @@ void clear_transport_protocol_menu(int num_choices, int highlighted_choice) {
 }
 
 /*
- * Allows the user select between TCP and QUIC as transport protocols.
+ * Allows the user select between TCP, TLS over TCP, QUIC, and shared memory (for a server on the same host) as
+ * transport protocols.
  */
 int display_transport_protocol_menu() {
     struct termios oldt, newt;
     int highlighted_choice = 0;
 
-    int num_choices = 2;
-    const char *choices[] = {"TCP", "QUIC"};
+    int num_choices = 4;
+    const char *choices[] = {"TCP", "TLS over TCP", "QUIC", "Shared memory"};
+    const TransportProtocol choice_transport_protocols[] = {TRANSPORT_PROTOCOL_TCP, TRANSPORT_PROTOCOL_TLS,
+                                                            TRANSPORT_PROTOCOL_QUIC, TRANSPORT_PROTOCOL_SHM};
 
     // save old terminal settings and configure new settings for raw mode
     tcgetattr(STDIN_FILENO, &oldt);
@@ -129,7 +132,7 @@ int display_transport_protocol_menu() {
                 break;
             }
         } else if (ch == ENTER_KEY) {
-            chosen_transport_protocol = (highlighted_choice == 0 ? TRANSPORT_PROTOCOL_TCP : TRANSPORT_PROTOCOL_QUIC);
+            chosen_transport_protocol = choice_transport_protocols[highlighted_choice];
             break;
         }
 
@@ -146,7 +149,20 @@ int display_transport_protocol_menu() {
  * Displays the CWD and '>' at the start of the line in the REPL.
  */
 void display_prompt(void) {
-    char *transport_protocol = chosen_transport_protocol == TRANSPORT_PROTOCOL_TCP ? "TCP" : "QUIC";
+    char *transport_protocol;
+    switch (chosen_transport_protocol) {
+    case TRANSPORT_PROTOCOL_TLS:
+        transport_protocol = "TLS";
+        break;
+    case TRANSPORT_PROTOCOL_QUIC:
+        transport_protocol = "QUIC";
+        break;
+    case TRANSPORT_PROTOCOL_SHM:
+        transport_protocol = "SHM";
+        break;
+    default:
+        transport_protocol = "TCP";
+    }
     printf(KYLW "{%s}" KNRM " ", transport_protocol);
 
     // CWD information
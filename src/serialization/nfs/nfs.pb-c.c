@@ -734,6 +734,235 @@ void nfs__stat_fs_res__free_unpacked(Nfs__StatFsRes *message, ProtobufCAllocator
     assert(message->base.descriptor == &nfs__stat_fs_res__descriptor);
     protobuf_c_message_free_unpacked((ProtobufCMessage *)message, allocator);
 }
+void nfs__compound_op__init(Nfs__CompoundOp *message) {
+    static const Nfs__CompoundOp init_value = NFS__COMPOUND_OP__INIT;
+    *message = init_value;
+}
+size_t nfs__compound_op__get_packed_size(const Nfs__CompoundOp *message) {
+    assert(message->base.descriptor == &nfs__compound_op__descriptor);
+    return protobuf_c_message_get_packed_size((const ProtobufCMessage *)(message));
+}
+size_t nfs__compound_op__pack(const Nfs__CompoundOp *message, uint8_t *out) {
+    assert(message->base.descriptor == &nfs__compound_op__descriptor);
+    return protobuf_c_message_pack((const ProtobufCMessage *)message, out);
+}
+size_t nfs__compound_op__pack_to_buffer(const Nfs__CompoundOp *message, ProtobufCBuffer *buffer) {
+    assert(message->base.descriptor == &nfs__compound_op__descriptor);
+    return protobuf_c_message_pack_to_buffer((const ProtobufCMessage *)message, buffer);
+}
+Nfs__CompoundOp *nfs__compound_op__unpack(ProtobufCAllocator *allocator, size_t len, const uint8_t *data) {
+    return (Nfs__CompoundOp *)protobuf_c_message_unpack(&nfs__compound_op__descriptor, allocator, len, data);
+}
+void nfs__compound_op__free_unpacked(Nfs__CompoundOp *message, ProtobufCAllocator *allocator) {
+    if (!message)
+        return;
+    assert(message->base.descriptor == &nfs__compound_op__descriptor);
+    protobuf_c_message_free_unpacked((ProtobufCMessage *)message, allocator);
+}
+void nfs__compound_args__init(Nfs__CompoundArgs *message) {
+    static const Nfs__CompoundArgs init_value = NFS__COMPOUND_ARGS__INIT;
+    *message = init_value;
+}
+size_t nfs__compound_args__get_packed_size(const Nfs__CompoundArgs *message) {
+    assert(message->base.descriptor == &nfs__compound_args__descriptor);
+    return protobuf_c_message_get_packed_size((const ProtobufCMessage *)(message));
+}
+size_t nfs__compound_args__pack(const Nfs__CompoundArgs *message, uint8_t *out) {
+    assert(message->base.descriptor == &nfs__compound_args__descriptor);
+    return protobuf_c_message_pack((const ProtobufCMessage *)message, out);
+}
+size_t nfs__compound_args__pack_to_buffer(const Nfs__CompoundArgs *message, ProtobufCBuffer *buffer) {
+    assert(message->base.descriptor == &nfs__compound_args__descriptor);
+    return protobuf_c_message_pack_to_buffer((const ProtobufCMessage *)message, buffer);
+}
+Nfs__CompoundArgs *nfs__compound_args__unpack(ProtobufCAllocator *allocator, size_t len, const uint8_t *data) {
+    return (Nfs__CompoundArgs *)protobuf_c_message_unpack(&nfs__compound_args__descriptor, allocator, len, data);
+}
+void nfs__compound_args__free_unpacked(Nfs__CompoundArgs *message, ProtobufCAllocator *allocator) {
+    if (!message)
+        return;
+    assert(message->base.descriptor == &nfs__compound_args__descriptor);
+    protobuf_c_message_free_unpacked((ProtobufCMessage *)message, allocator);
+}
+void nfs__compound_op_res__init(Nfs__CompoundOpRes *message) {
+    static const Nfs__CompoundOpRes init_value = NFS__COMPOUND_OP_RES__INIT;
+    *message = init_value;
+}
+size_t nfs__compound_op_res__get_packed_size(const Nfs__CompoundOpRes *message) {
+    assert(message->base.descriptor == &nfs__compound_op_res__descriptor);
+    return protobuf_c_message_get_packed_size((const ProtobufCMessage *)(message));
+}
+size_t nfs__compound_op_res__pack(const Nfs__CompoundOpRes *message, uint8_t *out) {
+    assert(message->base.descriptor == &nfs__compound_op_res__descriptor);
+    return protobuf_c_message_pack((const ProtobufCMessage *)message, out);
+}
+size_t nfs__compound_op_res__pack_to_buffer(const Nfs__CompoundOpRes *message, ProtobufCBuffer *buffer) {
+    assert(message->base.descriptor == &nfs__compound_op_res__descriptor);
+    return protobuf_c_message_pack_to_buffer((const ProtobufCMessage *)message, buffer);
+}
+Nfs__CompoundOpRes *nfs__compound_op_res__unpack(ProtobufCAllocator *allocator, size_t len, const uint8_t *data) {
+    return (Nfs__CompoundOpRes *)protobuf_c_message_unpack(&nfs__compound_op_res__descriptor, allocator, len, data);
+}
+void nfs__compound_op_res__free_unpacked(Nfs__CompoundOpRes *message, ProtobufCAllocator *allocator) {
+    if (!message)
+        return;
+    assert(message->base.descriptor == &nfs__compound_op_res__descriptor);
+    protobuf_c_message_free_unpacked((ProtobufCMessage *)message, allocator);
+}
+void nfs__compound_res__init(Nfs__CompoundRes *message) {
+    static const Nfs__CompoundRes init_value = NFS__COMPOUND_RES__INIT;
+    *message = init_value;
+}
+size_t nfs__compound_res__get_packed_size(const Nfs__CompoundRes *message) {
+    assert(message->base.descriptor == &nfs__compound_res__descriptor);
+    return protobuf_c_message_get_packed_size((const ProtobufCMessage *)(message));
+}
+size_t nfs__compound_res__pack(const Nfs__CompoundRes *message, uint8_t *out) {
+    assert(message->base.descriptor == &nfs__compound_res__descriptor);
+    return protobuf_c_message_pack((const ProtobufCMessage *)message, out);
+}
+size_t nfs__compound_res__pack_to_buffer(const Nfs__CompoundRes *message, ProtobufCBuffer *buffer) {
+    assert(message->base.descriptor == &nfs__compound_res__descriptor);
+    return protobuf_c_message_pack_to_buffer((const ProtobufCMessage *)message, buffer);
+}
+Nfs__CompoundRes *nfs__compound_res__unpack(ProtobufCAllocator *allocator, size_t len, const uint8_t *data) {
+    return (Nfs__CompoundRes *)protobuf_c_message_unpack(&nfs__compound_res__descriptor, allocator, len, data);
+}
+void nfs__compound_res__free_unpacked(Nfs__CompoundRes *message, ProtobufCAllocator *allocator) {
+    if (!message)
+        return;
+    assert(message->base.descriptor == &nfs__compound_res__descriptor);
+    protobuf_c_message_free_unpacked((ProtobufCMessage *)message, allocator);
+}
+void nfs__directory_entries_plus_list__init(Nfs__DirectoryEntriesPlusList *message) {
+    static const Nfs__DirectoryEntriesPlusList init_value = NFS__DIRECTORY_ENTRIES_PLUS_LIST__INIT;
+    *message = init_value;
+}
+size_t nfs__directory_entries_plus_list__get_packed_size(const Nfs__DirectoryEntriesPlusList *message) {
+    assert(message->base.descriptor == &nfs__directory_entries_plus_list__descriptor);
+    return protobuf_c_message_get_packed_size((const ProtobufCMessage *)(message));
+}
+size_t nfs__directory_entries_plus_list__pack(const Nfs__DirectoryEntriesPlusList *message, uint8_t *out) {
+    assert(message->base.descriptor == &nfs__directory_entries_plus_list__descriptor);
+    return protobuf_c_message_pack((const ProtobufCMessage *)message, out);
+}
+size_t nfs__directory_entries_plus_list__pack_to_buffer(const Nfs__DirectoryEntriesPlusList *message,
+                                                        ProtobufCBuffer *buffer) {
+    assert(message->base.descriptor == &nfs__directory_entries_plus_list__descriptor);
+    return protobuf_c_message_pack_to_buffer((const ProtobufCMessage *)message, buffer);
+}
+Nfs__DirectoryEntriesPlusList *nfs__directory_entries_plus_list__unpack(ProtobufCAllocator *allocator, size_t len,
+                                                                       const uint8_t *data) {
+    return (Nfs__DirectoryEntriesPlusList *)protobuf_c_message_unpack(&nfs__directory_entries_plus_list__descriptor,
+                                                                      allocator, len, data);
+}
+void nfs__directory_entries_plus_list__free_unpacked(Nfs__DirectoryEntriesPlusList *message,
+                                                     ProtobufCAllocator *allocator) {
+    if (!message)
+        return;
+    assert(message->base.descriptor == &nfs__directory_entries_plus_list__descriptor);
+    protobuf_c_message_free_unpacked((ProtobufCMessage *)message, allocator);
+}
+void nfs__read_dir_plus_ok__init(Nfs__ReadDirPlusOk *message) {
+    static const Nfs__ReadDirPlusOk init_value = NFS__READ_DIR_PLUS_OK__INIT;
+    *message = init_value;
+}
+size_t nfs__read_dir_plus_ok__get_packed_size(const Nfs__ReadDirPlusOk *message) {
+    assert(message->base.descriptor == &nfs__read_dir_plus_ok__descriptor);
+    return protobuf_c_message_get_packed_size((const ProtobufCMessage *)(message));
+}
+size_t nfs__read_dir_plus_ok__pack(const Nfs__ReadDirPlusOk *message, uint8_t *out) {
+    assert(message->base.descriptor == &nfs__read_dir_plus_ok__descriptor);
+    return protobuf_c_message_pack((const ProtobufCMessage *)message, out);
+}
+size_t nfs__read_dir_plus_ok__pack_to_buffer(const Nfs__ReadDirPlusOk *message, ProtobufCBuffer *buffer) {
+    assert(message->base.descriptor == &nfs__read_dir_plus_ok__descriptor);
+    return protobuf_c_message_pack_to_buffer((const ProtobufCMessage *)message, buffer);
+}
+Nfs__ReadDirPlusOk *nfs__read_dir_plus_ok__unpack(ProtobufCAllocator *allocator, size_t len, const uint8_t *data) {
+    return (Nfs__ReadDirPlusOk *)protobuf_c_message_unpack(&nfs__read_dir_plus_ok__descriptor, allocator, len, data);
+}
+void nfs__read_dir_plus_ok__free_unpacked(Nfs__ReadDirPlusOk *message, ProtobufCAllocator *allocator) {
+    if (!message)
+        return;
+    assert(message->base.descriptor == &nfs__read_dir_plus_ok__descriptor);
+    protobuf_c_message_free_unpacked((ProtobufCMessage *)message, allocator);
+}
+void nfs__read_dir_plus_res__init(Nfs__ReadDirPlusRes *message) {
+    static const Nfs__ReadDirPlusRes init_value = NFS__READ_DIR_PLUS_RES__INIT;
+    *message = init_value;
+}
+size_t nfs__read_dir_plus_res__get_packed_size(const Nfs__ReadDirPlusRes *message) {
+    assert(message->base.descriptor == &nfs__read_dir_plus_res__descriptor);
+    return protobuf_c_message_get_packed_size((const ProtobufCMessage *)(message));
+}
+size_t nfs__read_dir_plus_res__pack(const Nfs__ReadDirPlusRes *message, uint8_t *out) {
+    assert(message->base.descriptor == &nfs__read_dir_plus_res__descriptor);
+    return protobuf_c_message_pack((const ProtobufCMessage *)message, out);
+}
+size_t nfs__read_dir_plus_res__pack_to_buffer(const Nfs__ReadDirPlusRes *message, ProtobufCBuffer *buffer) {
+    assert(message->base.descriptor == &nfs__read_dir_plus_res__descriptor);
+    return protobuf_c_message_pack_to_buffer((const ProtobufCMessage *)message, buffer);
+}
+Nfs__ReadDirPlusRes *nfs__read_dir_plus_res__unpack(ProtobufCAllocator *allocator, size_t len, const uint8_t *data) {
+    return (Nfs__ReadDirPlusRes *)protobuf_c_message_unpack(&nfs__read_dir_plus_res__descriptor, allocator, len, data);
+}
+void nfs__read_dir_plus_res__free_unpacked(Nfs__ReadDirPlusRes *message, ProtobufCAllocator *allocator) {
+    if (!message)
+        return;
+    assert(message->base.descriptor == &nfs__read_dir_plus_res__descriptor);
+    protobuf_c_message_free_unpacked((ProtobufCMessage *)message, allocator);
+}
+void nfs__read_dir2_ok__init(Nfs__ReadDir2Ok *message) {
+    static const Nfs__ReadDir2Ok init_value = NFS__READ_DIR2_OK__INIT;
+    *message = init_value;
+}
+size_t nfs__read_dir2_ok__get_packed_size(const Nfs__ReadDir2Ok *message) {
+    assert(message->base.descriptor == &nfs__read_dir2_ok__descriptor);
+    return protobuf_c_message_get_packed_size((const ProtobufCMessage *)(message));
+}
+size_t nfs__read_dir2_ok__pack(const Nfs__ReadDir2Ok *message, uint8_t *out) {
+    assert(message->base.descriptor == &nfs__read_dir2_ok__descriptor);
+    return protobuf_c_message_pack((const ProtobufCMessage *)message, out);
+}
+size_t nfs__read_dir2_ok__pack_to_buffer(const Nfs__ReadDir2Ok *message, ProtobufCBuffer *buffer) {
+    assert(message->base.descriptor == &nfs__read_dir2_ok__descriptor);
+    return protobuf_c_message_pack_to_buffer((const ProtobufCMessage *)message, buffer);
+}
+Nfs__ReadDir2Ok *nfs__read_dir2_ok__unpack(ProtobufCAllocator *allocator, size_t len, const uint8_t *data) {
+    return (Nfs__ReadDir2Ok *)protobuf_c_message_unpack(&nfs__read_dir2_ok__descriptor, allocator, len, data);
+}
+void nfs__read_dir2_ok__free_unpacked(Nfs__ReadDir2Ok *message, ProtobufCAllocator *allocator) {
+    if (!message)
+        return;
+    assert(message->base.descriptor == &nfs__read_dir2_ok__descriptor);
+    protobuf_c_message_free_unpacked((ProtobufCMessage *)message, allocator);
+}
+void nfs__read_dir2_res__init(Nfs__ReadDir2Res *message) {
+    static const Nfs__ReadDir2Res init_value = NFS__READ_DIR2_RES__INIT;
+    *message = init_value;
+}
+size_t nfs__read_dir2_res__get_packed_size(const Nfs__ReadDir2Res *message) {
+    assert(message->base.descriptor == &nfs__read_dir2_res__descriptor);
+    return protobuf_c_message_get_packed_size((const ProtobufCMessage *)(message));
+}
+size_t nfs__read_dir2_res__pack(const Nfs__ReadDir2Res *message, uint8_t *out) {
+    assert(message->base.descriptor == &nfs__read_dir2_res__descriptor);
+    return protobuf_c_message_pack((const ProtobufCMessage *)message, out);
+}
+size_t nfs__read_dir2_res__pack_to_buffer(const Nfs__ReadDir2Res *message, ProtobufCBuffer *buffer) {
+    assert(message->base.descriptor == &nfs__read_dir2_res__descriptor);
+    return protobuf_c_message_pack_to_buffer((const ProtobufCMessage *)message, buffer);
+}
+Nfs__ReadDir2Res *nfs__read_dir2_res__unpack(ProtobufCAllocator *allocator, size_t len, const uint8_t *data) {
+    return (Nfs__ReadDir2Res *)protobuf_c_message_unpack(&nfs__read_dir2_res__descriptor, allocator, len, data);
+}
+void nfs__read_dir2_res__free_unpacked(Nfs__ReadDir2Res *message, ProtobufCAllocator *allocator) {
+    if (!message)
+        return;
+    assert(message->base.descriptor == &nfs__read_dir2_res__descriptor);
+    protobuf_c_message_free_unpacked((ProtobufCMessage *)message, allocator);
+}
 static const ProtobufCFieldDescriptor nfs__nfs_stat__field_descriptors[1] = {
     {
         "stat", 1, PROTOBUF_C_LABEL_NONE, PROTOBUF_C_TYPE_ENUM, 0,     /* quantifier_offset */
@@ -1298,7 +1527,7 @@ const ProtobufCMessageDescriptor nfs__read_link_res__descriptor = {
     NULL,
     NULL /* reserved[123] */
 };
-static const ProtobufCFieldDescriptor nfs__read_args__field_descriptors[4] = {
+static const ProtobufCFieldDescriptor nfs__read_args__field_descriptors[5] = {
     {
         "file", 1, PROTOBUF_C_LABEL_NONE, PROTOBUF_C_TYPE_MESSAGE, 0,      /* quantifier_offset */
         offsetof(Nfs__ReadArgs, file), &nfs__fhandle__descriptor, NULL, 0, /* flags */
@@ -1319,14 +1548,20 @@ static const ProtobufCFieldDescriptor nfs__read_args__field_descriptors[4] = {
         offsetof(Nfs__ReadArgs, totalcount), NULL, NULL, 0,                /* flags */
         0, NULL, NULL                                                      /* reserved1,reserved2, etc */
     },
+    {
+        "accepted_compression", 5, PROTOBUF_C_LABEL_NONE, PROTOBUF_C_TYPE_UINT32, 0, /* quantifier_offset */
+        offsetof(Nfs__ReadArgs, accepted_compression), NULL, NULL, 0,                /* flags */
+        0, NULL, NULL                                                                /* reserved1,reserved2, etc */
+    },
 };
 static const unsigned nfs__read_args__field_indices_by_name[] = {
+    4, /* field[4] = accepted_compression */
     2, /* field[2] = count */
     0, /* field[0] = file */
     1, /* field[1] = offset */
     3, /* field[3] = totalcount */
 };
-static const ProtobufCIntRange nfs__read_args__number_ranges[1 + 1] = {{1, 0}, {0, 4}};
+static const ProtobufCIntRange nfs__read_args__number_ranges[1 + 1] = {{1, 0}, {0, 5}};
 const ProtobufCMessageDescriptor nfs__read_args__descriptor = {
     PROTOBUF_C__MESSAGE_DESCRIPTOR_MAGIC,
     "nfs.ReadArgs",
@@ -1334,7 +1569,7 @@ const ProtobufCMessageDescriptor nfs__read_args__descriptor = {
     "Nfs__ReadArgs",
     "nfs",
     sizeof(Nfs__ReadArgs),
-    4,
+    5,
     nfs__read_args__field_descriptors,
     nfs__read_args__field_indices_by_name,
     1,
@@ -1344,7 +1579,7 @@ const ProtobufCMessageDescriptor nfs__read_args__descriptor = {
     NULL,
     NULL /* reserved[123] */
 };
-static const ProtobufCFieldDescriptor nfs__read_res_body__field_descriptors[2] = {
+static const ProtobufCFieldDescriptor nfs__read_res_body__field_descriptors[4] = {
     {
         "attributes", 1, PROTOBUF_C_LABEL_NONE, PROTOBUF_C_TYPE_MESSAGE, 0,       /* quantifier_offset */
         offsetof(Nfs__ReadResBody, attributes), &nfs__fattr__descriptor, NULL, 0, /* flags */
@@ -1355,12 +1590,24 @@ static const ProtobufCFieldDescriptor nfs__read_res_body__field_descriptors[2] =
         offsetof(Nfs__ReadResBody, nfsdata), NULL, NULL, 0,            /* flags */
         0, NULL, NULL                                                  /* reserved1,reserved2, etc */
     },
+    {
+        "compression", 3, PROTOBUF_C_LABEL_NONE, PROTOBUF_C_TYPE_UINT32, 0, /* quantifier_offset */
+        offsetof(Nfs__ReadResBody, compression), NULL, NULL, 0,             /* flags */
+        0, NULL, NULL                                                       /* reserved1,reserved2, etc */
+    },
+    {
+        "uncompressed_size", 4, PROTOBUF_C_LABEL_NONE, PROTOBUF_C_TYPE_UINT32, 0, /* quantifier_offset */
+        offsetof(Nfs__ReadResBody, uncompressed_size), NULL, NULL, 0,             /* flags */
+        0, NULL, NULL                                                             /* reserved1,reserved2, etc */
+    },
 };
 static const unsigned nfs__read_res_body__field_indices_by_name[] = {
     0, /* field[0] = attributes */
+    2, /* field[2] = compression */
     1, /* field[1] = nfsdata */
+    3, /* field[3] = uncompressed_size */
 };
-static const ProtobufCIntRange nfs__read_res_body__number_ranges[1 + 1] = {{1, 0}, {0, 2}};
+static const ProtobufCIntRange nfs__read_res_body__number_ranges[1 + 1] = {{1, 0}, {0, 4}};
 const ProtobufCMessageDescriptor nfs__read_res_body__descriptor = {
     PROTOBUF_C__MESSAGE_DESCRIPTOR_MAGIC,
     "nfs.ReadResBody",
@@ -1368,7 +1615,7 @@ const ProtobufCMessageDescriptor nfs__read_res_body__descriptor = {
     "Nfs__ReadResBody",
     "nfs",
     sizeof(Nfs__ReadResBody),
-    2,
+    4,
     nfs__read_res_body__field_descriptors,
     nfs__read_res_body__field_indices_by_name,
     1,
@@ -1420,7 +1667,7 @@ const ProtobufCMessageDescriptor nfs__read_res__descriptor = {
     NULL,
     NULL /* reserved[123] */
 };
-static const ProtobufCFieldDescriptor nfs__write_args__field_descriptors[5] = {
+static const ProtobufCFieldDescriptor nfs__write_args__field_descriptors[7] = {
     {
         "file", 1, PROTOBUF_C_LABEL_NONE, PROTOBUF_C_TYPE_MESSAGE, 0,       /* quantifier_offset */
         offsetof(Nfs__WriteArgs, file), &nfs__fhandle__descriptor, NULL, 0, /* flags */
@@ -1446,15 +1693,27 @@ static const ProtobufCFieldDescriptor nfs__write_args__field_descriptors[5] = {
         offsetof(Nfs__WriteArgs, nfsdata), NULL, NULL, 0,              /* flags */
         0, NULL, NULL                                                  /* reserved1,reserved2, etc */
     },
+    {
+        "compression", 6, PROTOBUF_C_LABEL_NONE, PROTOBUF_C_TYPE_UINT32, 0, /* quantifier_offset */
+        offsetof(Nfs__WriteArgs, compression), NULL, NULL, 0,               /* flags */
+        0, NULL, NULL                                                       /* reserved1,reserved2, etc */
+    },
+    {
+        "uncompressed_size", 7, PROTOBUF_C_LABEL_NONE, PROTOBUF_C_TYPE_UINT32, 0, /* quantifier_offset */
+        offsetof(Nfs__WriteArgs, uncompressed_size), NULL, NULL, 0,               /* flags */
+        0, NULL, NULL                                                             /* reserved1,reserved2, etc */
+    },
 };
 static const unsigned nfs__write_args__field_indices_by_name[] = {
     1, /* field[1] = beginoffset */
+    5, /* field[5] = compression */
     0, /* field[0] = file */
     4, /* field[4] = nfsdata */
     2, /* field[2] = offset */
     3, /* field[3] = totalcount */
+    6, /* field[6] = uncompressed_size */
 };
-static const ProtobufCIntRange nfs__write_args__number_ranges[1 + 1] = {{1, 0}, {0, 5}};
+static const ProtobufCIntRange nfs__write_args__number_ranges[1 + 1] = {{1, 0}, {0, 7}};
 const ProtobufCMessageDescriptor nfs__write_args__descriptor = {
     PROTOBUF_C__MESSAGE_DESCRIPTOR_MAGIC,
     "nfs.WriteArgs",
@@ -1462,7 +1721,7 @@ const ProtobufCMessageDescriptor nfs__write_args__descriptor = {
     "Nfs__WriteArgs",
     "nfs",
     sizeof(Nfs__WriteArgs),
-    5,
+    7,
     nfs__write_args__field_descriptors,
     nfs__write_args__field_indices_by_name,
     1,
@@ -1804,7 +2063,7 @@ const ProtobufCMessageDescriptor nfs__read_dir_res__descriptor = {
     NULL,
     NULL /* reserved[123] */
 };
-static const ProtobufCFieldDescriptor nfs__fs_info__field_descriptors[5] = {
+static const ProtobufCFieldDescriptor nfs__fs_info__field_descriptors[6] = {
     {
         "tsize", 1, PROTOBUF_C_LABEL_NONE, PROTOBUF_C_TYPE_UINT32, 0, /* quantifier_offset */
         offsetof(Nfs__FsInfo, tsize), NULL, NULL, 0,                  /* flags */
@@ -1830,15 +2089,21 @@ static const ProtobufCFieldDescriptor nfs__fs_info__field_descriptors[5] = {
         offsetof(Nfs__FsInfo, bavail), NULL, NULL, 0,                  /* flags */
         0, NULL, NULL                                                  /* reserved1,reserved2, etc */
     },
+    {
+        "compression_algorithms", 6, PROTOBUF_C_LABEL_NONE, PROTOBUF_C_TYPE_UINT32, 0, /* quantifier_offset */
+        offsetof(Nfs__FsInfo, compression_algorithms), NULL, NULL, 0,                  /* flags */
+        0, NULL, NULL                                                                  /* reserved1,reserved2, etc */
+    },
 };
 static const unsigned nfs__fs_info__field_indices_by_name[] = {
     4, /* field[4] = bavail */
     3, /* field[3] = bfree */
     2, /* field[2] = blocks */
     1, /* field[1] = bsize */
+    5, /* field[5] = compression_algorithms */
     0, /* field[0] = tsize */
 };
-static const ProtobufCIntRange nfs__fs_info__number_ranges[1 + 1] = {{1, 0}, {0, 5}};
+static const ProtobufCIntRange nfs__fs_info__number_ranges[1 + 1] = {{1, 0}, {0, 6}};
 const ProtobufCMessageDescriptor nfs__fs_info__descriptor = {
     PROTOBUF_C__MESSAGE_DESCRIPTOR_MAGIC,
     "nfs.FsInfo",
@@ -1846,7 +2111,7 @@ const ProtobufCMessageDescriptor nfs__fs_info__descriptor = {
     "Nfs__FsInfo",
     "nfs",
     sizeof(Nfs__FsInfo),
-    5,
+    6,
     nfs__fs_info__field_descriptors,
     nfs__fs_info__field_indices_by_name,
     1,
@@ -1897,6 +2162,383 @@ const ProtobufCMessageDescriptor nfs__stat_fs_res__descriptor = {
     NULL,
     NULL /* reserved[123] */
 };
+static const ProtobufCFieldDescriptor nfs__compound_op__field_descriptors[3] = {
+    {
+        "procedure", 1, PROTOBUF_C_LABEL_NONE, PROTOBUF_C_TYPE_UINT32, 0, /* quantifier_offset */
+        offsetof(Nfs__CompoundOp, procedure), NULL, NULL, 0,              /* flags */
+        0, NULL, NULL                                                     /* reserved1,reserved2, etc */
+    },
+    {
+        "use_current_fhandle", 2, PROTOBUF_C_LABEL_NONE, PROTOBUF_C_TYPE_BOOL, 0, /* quantifier_offset */
+        offsetof(Nfs__CompoundOp, use_current_fhandle), NULL, NULL, 0,            /* flags */
+        0, NULL, NULL                                                             /* reserved1,reserved2, etc */
+    },
+    {
+        "parameters", 3, PROTOBUF_C_LABEL_NONE, PROTOBUF_C_TYPE_BYTES, 0, /* quantifier_offset */
+        offsetof(Nfs__CompoundOp, parameters), NULL, NULL, 0,             /* flags */
+        0, NULL, NULL                                                     /* reserved1,reserved2, etc */
+    },
+};
+static const unsigned nfs__compound_op__field_indices_by_name[] = {
+    2, /* field[2] = parameters */
+    0, /* field[0] = procedure */
+    1, /* field[1] = use_current_fhandle */
+};
+static const ProtobufCIntRange nfs__compound_op__number_ranges[1 + 1] = {{1, 0}, {0, 3}};
+const ProtobufCMessageDescriptor nfs__compound_op__descriptor = {
+    PROTOBUF_C__MESSAGE_DESCRIPTOR_MAGIC,
+    "nfs.CompoundOp",
+    "CompoundOp",
+    "Nfs__CompoundOp",
+    "nfs",
+    sizeof(Nfs__CompoundOp),
+    3,
+    nfs__compound_op__field_descriptors,
+    nfs__compound_op__field_indices_by_name,
+    1,
+    nfs__compound_op__number_ranges,
+    (ProtobufCMessageInit)nfs__compound_op__init,
+    NULL,
+    NULL,
+    NULL /* reserved[123] */
+};
+static const ProtobufCFieldDescriptor nfs__compound_args__field_descriptors[2] = {
+    {
+        "fhandle", 1, PROTOBUF_C_LABEL_NONE, PROTOBUF_C_TYPE_MESSAGE, 0,          /* quantifier_offset */
+        offsetof(Nfs__CompoundArgs, fhandle), &nfs__fhandle__descriptor, NULL, 0, /* flags */
+        0, NULL, NULL                                                             /* reserved1,reserved2, etc */
+    },
+    {
+        "operations", 2, PROTOBUF_C_LABEL_REPEATED, PROTOBUF_C_TYPE_MESSAGE, offsetof(Nfs__CompoundArgs, n_operations),
+        offsetof(Nfs__CompoundArgs, operations), &nfs__compound_op__descriptor, NULL, 0, /* flags */
+        0, NULL, NULL                                                                    /* reserved1,reserved2, etc */
+    },
+};
+static const unsigned nfs__compound_args__field_indices_by_name[] = {
+    0, /* field[0] = fhandle */
+    1, /* field[1] = operations */
+};
+static const ProtobufCIntRange nfs__compound_args__number_ranges[1 + 1] = {{1, 0}, {0, 2}};
+const ProtobufCMessageDescriptor nfs__compound_args__descriptor = {
+    PROTOBUF_C__MESSAGE_DESCRIPTOR_MAGIC,
+    "nfs.CompoundArgs",
+    "CompoundArgs",
+    "Nfs__CompoundArgs",
+    "nfs",
+    sizeof(Nfs__CompoundArgs),
+    2,
+    nfs__compound_args__field_descriptors,
+    nfs__compound_args__field_indices_by_name,
+    1,
+    nfs__compound_args__number_ranges,
+    (ProtobufCMessageInit)nfs__compound_args__init,
+    NULL,
+    NULL,
+    NULL /* reserved[123] */
+};
+static const ProtobufCFieldDescriptor nfs__compound_op_res__field_descriptors[3] = {
+    {
+        "procedure", 1, PROTOBUF_C_LABEL_NONE, PROTOBUF_C_TYPE_UINT32, 0, /* quantifier_offset */
+        offsetof(Nfs__CompoundOpRes, procedure), NULL, NULL, 0,           /* flags */
+        0, NULL, NULL                                                     /* reserved1,reserved2, etc */
+    },
+    {
+        "nfs_status", 2, PROTOBUF_C_LABEL_NONE, PROTOBUF_C_TYPE_MESSAGE, 0,            /* quantifier_offset */
+        offsetof(Nfs__CompoundOpRes, nfs_status), &nfs__nfs_stat__descriptor, NULL, 0, /* flags */
+        0, NULL, NULL                                                                  /* reserved1,reserved2, etc */
+    },
+    {
+        "results", 3, PROTOBUF_C_LABEL_NONE, PROTOBUF_C_TYPE_BYTES, 0, /* quantifier_offset */
+        offsetof(Nfs__CompoundOpRes, results), NULL, NULL, 0,          /* flags */
+        0, NULL, NULL                                                  /* reserved1,reserved2, etc */
+    },
+};
+static const unsigned nfs__compound_op_res__field_indices_by_name[] = {
+    1, /* field[1] = nfs_status */
+    0, /* field[0] = procedure */
+    2, /* field[2] = results */
+};
+static const ProtobufCIntRange nfs__compound_op_res__number_ranges[1 + 1] = {{1, 0}, {0, 3}};
+const ProtobufCMessageDescriptor nfs__compound_op_res__descriptor = {
+    PROTOBUF_C__MESSAGE_DESCRIPTOR_MAGIC,
+    "nfs.CompoundOpRes",
+    "CompoundOpRes",
+    "Nfs__CompoundOpRes",
+    "nfs",
+    sizeof(Nfs__CompoundOpRes),
+    3,
+    nfs__compound_op_res__field_descriptors,
+    nfs__compound_op_res__field_indices_by_name,
+    1,
+    nfs__compound_op_res__number_ranges,
+    (ProtobufCMessageInit)nfs__compound_op_res__init,
+    NULL,
+    NULL,
+    NULL /* reserved[123] */
+};
+static const ProtobufCFieldDescriptor nfs__compound_res__field_descriptors[2] = {
+    {
+        "nfs_status", 1, PROTOBUF_C_LABEL_NONE, PROTOBUF_C_TYPE_MESSAGE, 0,          /* quantifier_offset */
+        offsetof(Nfs__CompoundRes, nfs_status), &nfs__nfs_stat__descriptor, NULL, 0, /* flags */
+        0, NULL, NULL                                                                /* reserved1,reserved2, etc */
+    },
+    {
+        "results", 2, PROTOBUF_C_LABEL_REPEATED, PROTOBUF_C_TYPE_MESSAGE, offsetof(Nfs__CompoundRes, n_results),
+        offsetof(Nfs__CompoundRes, results), &nfs__compound_op_res__descriptor, NULL, 0, /* flags */
+        0, NULL, NULL                                                                    /* reserved1,reserved2, etc */
+    },
+};
+static const unsigned nfs__compound_res__field_indices_by_name[] = {
+    0, /* field[0] = nfs_status */
+    1, /* field[1] = results */
+};
+static const ProtobufCIntRange nfs__compound_res__number_ranges[1 + 1] = {{1, 0}, {0, 2}};
+const ProtobufCMessageDescriptor nfs__compound_res__descriptor = {
+    PROTOBUF_C__MESSAGE_DESCRIPTOR_MAGIC,
+    "nfs.CompoundRes",
+    "CompoundRes",
+    "Nfs__CompoundRes",
+    "nfs",
+    sizeof(Nfs__CompoundRes),
+    2,
+    nfs__compound_res__field_descriptors,
+    nfs__compound_res__field_indices_by_name,
+    1,
+    nfs__compound_res__number_ranges,
+    (ProtobufCMessageInit)nfs__compound_res__init,
+    NULL,
+    NULL,
+    NULL /* reserved[123] */
+};
+static const ProtobufCFieldDescriptor nfs__directory_entries_plus_list__field_descriptors[6] = {
+    {
+        "fileid", 1, PROTOBUF_C_LABEL_NONE, PROTOBUF_C_TYPE_UINT64, 0, /* quantifier_offset */
+        offsetof(Nfs__DirectoryEntriesPlusList, fileid), NULL, NULL, 0, /* flags */
+        0, NULL, NULL /* reserved1,reserved2, etc */
+    },
+    {
+        "name", 2, PROTOBUF_C_LABEL_NONE, PROTOBUF_C_TYPE_MESSAGE, 0, /* quantifier_offset */
+        offsetof(Nfs__DirectoryEntriesPlusList, name), &nfs__file_name__descriptor, NULL, 0, /* flags */
+        0, NULL, NULL /* reserved1,reserved2, etc */
+    },
+    {
+        "cookie", 3, PROTOBUF_C_LABEL_NONE, PROTOBUF_C_TYPE_MESSAGE, 0, /* quantifier_offset */
+        offsetof(Nfs__DirectoryEntriesPlusList, cookie), &nfs__nfs_cookie__descriptor, NULL, 0, /* flags */
+        0, NULL, NULL /* reserved1,reserved2, etc */
+    },
+    {
+        "file", 4, PROTOBUF_C_LABEL_NONE, PROTOBUF_C_TYPE_MESSAGE, 0, /* quantifier_offset */
+        offsetof(Nfs__DirectoryEntriesPlusList, file), &nfs__fhandle__descriptor, NULL, 0, /* flags */
+        0, NULL, NULL /* reserved1,reserved2, etc */
+    },
+    {
+        "attributes", 5, PROTOBUF_C_LABEL_NONE, PROTOBUF_C_TYPE_MESSAGE, 0, /* quantifier_offset */
+        offsetof(Nfs__DirectoryEntriesPlusList, attributes), &nfs__fattr__descriptor, NULL, 0, /* flags */
+        0, NULL, NULL /* reserved1,reserved2, etc */
+    },
+    {
+        "nextentry", 6, PROTOBUF_C_LABEL_NONE, PROTOBUF_C_TYPE_MESSAGE, 0, /* quantifier_offset */
+        offsetof(Nfs__DirectoryEntriesPlusList, nextentry), &nfs__directory_entries_plus_list__descriptor, NULL,
+        0,            /* flags */
+        0, NULL, NULL /* reserved1,reserved2, etc */
+    },
+};
+static const unsigned nfs__directory_entries_plus_list__field_indices_by_name[] = {
+    4, /* field[4] = attributes */
+    2, /* field[2] = cookie */
+    3, /* field[3] = file */
+    0, /* field[0] = fileid */
+    1, /* field[1] = name */
+    5, /* field[5] = nextentry */
+};
+static const ProtobufCIntRange nfs__directory_entries_plus_list__number_ranges[1 + 1] = {{1, 0}, {0, 6}};
+const ProtobufCMessageDescriptor nfs__directory_entries_plus_list__descriptor = {
+    PROTOBUF_C__MESSAGE_DESCRIPTOR_MAGIC,
+    "nfs.DirectoryEntriesPlusList",
+    "DirectoryEntriesPlusList",
+    "Nfs__DirectoryEntriesPlusList",
+    "nfs",
+    sizeof(Nfs__DirectoryEntriesPlusList),
+    6,
+    nfs__directory_entries_plus_list__field_descriptors,
+    nfs__directory_entries_plus_list__field_indices_by_name,
+    1,
+    nfs__directory_entries_plus_list__number_ranges,
+    (ProtobufCMessageInit)nfs__directory_entries_plus_list__init,
+    NULL,
+    NULL,
+    NULL /* reserved[123] */
+};
+static const ProtobufCFieldDescriptor nfs__read_dir_plus_ok__field_descriptors[2] = {
+    {
+        "entries", 1, PROTOBUF_C_LABEL_NONE, PROTOBUF_C_TYPE_MESSAGE, 0, /* quantifier_offset */
+        offsetof(Nfs__ReadDirPlusOk, entries), &nfs__directory_entries_plus_list__descriptor, NULL, 0, /* flags */
+        0, NULL, NULL /* reserved1,reserved2, etc */
+    },
+    {
+        "eof", 2, PROTOBUF_C_LABEL_NONE, PROTOBUF_C_TYPE_BOOL, 0, /* quantifier_offset */
+        offsetof(Nfs__ReadDirPlusOk, eof), NULL, NULL, 0, /* flags */
+        0, NULL, NULL /* reserved1,reserved2, etc */
+    },
+};
+static const unsigned nfs__read_dir_plus_ok__field_indices_by_name[] = {
+    0, /* field[0] = entries */
+    1, /* field[1] = eof */
+};
+static const ProtobufCIntRange nfs__read_dir_plus_ok__number_ranges[1 + 1] = {{1, 0}, {0, 2}};
+const ProtobufCMessageDescriptor nfs__read_dir_plus_ok__descriptor = {
+    PROTOBUF_C__MESSAGE_DESCRIPTOR_MAGIC,
+    "nfs.ReadDirPlusOk",
+    "ReadDirPlusOk",
+    "Nfs__ReadDirPlusOk",
+    "nfs",
+    sizeof(Nfs__ReadDirPlusOk),
+    2,
+    nfs__read_dir_plus_ok__field_descriptors,
+    nfs__read_dir_plus_ok__field_indices_by_name,
+    1,
+    nfs__read_dir_plus_ok__number_ranges,
+    (ProtobufCMessageInit)nfs__read_dir_plus_ok__init,
+    NULL,
+    NULL,
+    NULL /* reserved[123] */
+};
+static const ProtobufCFieldDescriptor nfs__read_dir_plus_res__field_descriptors[3] = {
+    {
+        "nfs_status", 1, PROTOBUF_C_LABEL_NONE, PROTOBUF_C_TYPE_MESSAGE, 0, /* quantifier_offset */
+        offsetof(Nfs__ReadDirPlusRes, nfs_status), &nfs__nfs_stat__descriptor, NULL, 0, /* flags */
+        0, NULL, NULL /* reserved1,reserved2, etc */
+    },
+    {
+        "readdirplusok", 2, PROTOBUF_C_LABEL_NONE, PROTOBUF_C_TYPE_MESSAGE, offsetof(Nfs__ReadDirPlusRes, body_case),
+        offsetof(Nfs__ReadDirPlusRes, readdirplusok), &nfs__read_dir_plus_ok__descriptor, NULL,
+        0 | PROTOBUF_C_FIELD_FLAG_ONEOF, /* flags */
+        0, NULL, NULL                    /* reserved1,reserved2, etc */
+    },
+    {
+        "default_case", 3, PROTOBUF_C_LABEL_NONE, PROTOBUF_C_TYPE_MESSAGE, offsetof(Nfs__ReadDirPlusRes, body_case),
+        offsetof(Nfs__ReadDirPlusRes, default_case), &google__protobuf__empty__descriptor, NULL,
+        0 | PROTOBUF_C_FIELD_FLAG_ONEOF, /* flags */
+        0, NULL, NULL                    /* reserved1,reserved2, etc */
+    },
+};
+static const unsigned nfs__read_dir_plus_res__field_indices_by_name[] = {
+    2, /* field[2] = default_case */
+    0, /* field[0] = nfs_status */
+    1, /* field[1] = readdirplusok */
+};
+static const ProtobufCIntRange nfs__read_dir_plus_res__number_ranges[1 + 1] = {{1, 0}, {0, 3}};
+const ProtobufCMessageDescriptor nfs__read_dir_plus_res__descriptor = {
+    PROTOBUF_C__MESSAGE_DESCRIPTOR_MAGIC,
+    "nfs.ReadDirPlusRes",
+    "ReadDirPlusRes",
+    "Nfs__ReadDirPlusRes",
+    "nfs",
+    sizeof(Nfs__ReadDirPlusRes),
+    3,
+    nfs__read_dir_plus_res__field_descriptors,
+    nfs__read_dir_plus_res__field_indices_by_name,
+    1,
+    nfs__read_dir_plus_res__number_ranges,
+    (ProtobufCMessageInit)nfs__read_dir_plus_res__init,
+    NULL,
+    NULL,
+    NULL /* reserved[123] */
+};
+static const ProtobufCFieldDescriptor nfs__read_dir2_ok__field_descriptors[5] = {
+    {
+        "fileids", 1, PROTOBUF_C_LABEL_REPEATED, PROTOBUF_C_TYPE_UINT64, offsetof(Nfs__ReadDir2Ok, n_fileids),
+        offsetof(Nfs__ReadDir2Ok, fileids), NULL, NULL, 0 | PROTOBUF_C_FIELD_FLAG_PACKED, /* flags */
+        0, NULL, NULL                                                                     /* reserved1,reserved2, etc */
+    },
+    {
+        "cookies", 2, PROTOBUF_C_LABEL_REPEATED, PROTOBUF_C_TYPE_UINT64, offsetof(Nfs__ReadDir2Ok, n_cookies),
+        offsetof(Nfs__ReadDir2Ok, cookies), NULL, NULL, 0 | PROTOBUF_C_FIELD_FLAG_PACKED, /* flags */
+        0, NULL, NULL                                                                     /* reserved1,reserved2, etc */
+    },
+    {
+        "name_offsets", 3, PROTOBUF_C_LABEL_REPEATED, PROTOBUF_C_TYPE_UINT32, offsetof(Nfs__ReadDir2Ok, n_name_offsets),
+        offsetof(Nfs__ReadDir2Ok, name_offsets), NULL, NULL, 0 | PROTOBUF_C_FIELD_FLAG_PACKED, /* flags */
+        0, NULL, NULL /* reserved1,reserved2, etc */
+    },
+    {
+        "names", 4, PROTOBUF_C_LABEL_NONE, PROTOBUF_C_TYPE_BYTES, 0, /* quantifier_offset */
+        offsetof(Nfs__ReadDir2Ok, names), NULL, NULL, 0,             /* flags */
+        0, NULL, NULL                                                /* reserved1,reserved2, etc */
+    },
+    {
+        "eof", 5, PROTOBUF_C_LABEL_NONE, PROTOBUF_C_TYPE_BOOL, 0, /* quantifier_offset */
+        offsetof(Nfs__ReadDir2Ok, eof), NULL, NULL, 0,            /* flags */
+        0, NULL, NULL                                             /* reserved1,reserved2, etc */
+    },
+};
+static const unsigned nfs__read_dir2_ok__field_indices_by_name[] = {
+    1, /* field[1] = cookies */
+    4, /* field[4] = eof */
+    0, /* field[0] = fileids */
+    2, /* field[2] = name_offsets */
+    3, /* field[3] = names */
+};
+static const ProtobufCIntRange nfs__read_dir2_ok__number_ranges[1 + 1] = {{1, 0}, {0, 5}};
+const ProtobufCMessageDescriptor nfs__read_dir2_ok__descriptor = {
+    PROTOBUF_C__MESSAGE_DESCRIPTOR_MAGIC,
+    "nfs.ReadDir2Ok",
+    "ReadDir2Ok",
+    "Nfs__ReadDir2Ok",
+    "nfs",
+    sizeof(Nfs__ReadDir2Ok),
+    5,
+    nfs__read_dir2_ok__field_descriptors,
+    nfs__read_dir2_ok__field_indices_by_name,
+    1,
+    nfs__read_dir2_ok__number_ranges,
+    (ProtobufCMessageInit)nfs__read_dir2_ok__init,
+    NULL,
+    NULL,
+    NULL /* reserved[123] */
+};
+static const ProtobufCFieldDescriptor nfs__read_dir2_res__field_descriptors[3] = {
+    {
+        "nfs_status", 1, PROTOBUF_C_LABEL_NONE, PROTOBUF_C_TYPE_MESSAGE, 0, /* quantifier_offset */
+        offsetof(Nfs__ReadDir2Res, nfs_status), &nfs__nfs_stat__descriptor, NULL, 0, /* flags */
+        0, NULL, NULL /* reserved1,reserved2, etc */
+    },
+    {
+        "readdir2ok", 2, PROTOBUF_C_LABEL_NONE, PROTOBUF_C_TYPE_MESSAGE, offsetof(Nfs__ReadDir2Res, body_case),
+        offsetof(Nfs__ReadDir2Res, readdir2ok), &nfs__read_dir2_ok__descriptor, NULL,
+        0 | PROTOBUF_C_FIELD_FLAG_ONEOF, /* flags */
+        0, NULL, NULL                    /* reserved1,reserved2, etc */
+    },
+    {
+        "default_case", 3, PROTOBUF_C_LABEL_NONE, PROTOBUF_C_TYPE_MESSAGE, offsetof(Nfs__ReadDir2Res, body_case),
+        offsetof(Nfs__ReadDir2Res, default_case), &google__protobuf__empty__descriptor, NULL,
+        0 | PROTOBUF_C_FIELD_FLAG_ONEOF, /* flags */
+        0, NULL, NULL                    /* reserved1,reserved2, etc */
+    },
+};
+static const unsigned nfs__read_dir2_res__field_indices_by_name[] = {
+    2, /* field[2] = default_case */
+    0, /* field[0] = nfs_status */
+    1, /* field[1] = readdir2ok */
+};
+static const ProtobufCIntRange nfs__read_dir2_res__number_ranges[1 + 1] = {{1, 0}, {0, 3}};
+const ProtobufCMessageDescriptor nfs__read_dir2_res__descriptor = {
+    PROTOBUF_C__MESSAGE_DESCRIPTOR_MAGIC,
+    "nfs.ReadDir2Res",
+    "ReadDir2Res",
+    "Nfs__ReadDir2Res",
+    "nfs",
+    sizeof(Nfs__ReadDir2Res),
+    3,
+    nfs__read_dir2_res__field_descriptors,
+    nfs__read_dir2_res__field_indices_by_name,
+    1,
+    nfs__read_dir2_res__number_ranges,
+    (ProtobufCMessageInit)nfs__read_dir2_res__init,
+    NULL,
+    NULL,
+    NULL /* reserved[123] */
+};
 static const ProtobufCEnumValue nfs__stat__enum_values_by_number[18] = {
     {"NFS_OK", "NFS__STAT__NFS_OK", 0},
     {"NFSERR_PERM", "NFS__STAT__NFSERR_PERM", 1},
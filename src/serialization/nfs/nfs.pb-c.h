@@ -46,6 +46,15 @@ typedef struct Nfs__ReadDirOk Nfs__ReadDirOk;
 typedef struct Nfs__ReadDirRes Nfs__ReadDirRes;
 typedef struct Nfs__FsInfo Nfs__FsInfo;
 typedef struct Nfs__StatFsRes Nfs__StatFsRes;
+typedef struct Nfs__CompoundOp Nfs__CompoundOp;
+typedef struct Nfs__CompoundArgs Nfs__CompoundArgs;
+typedef struct Nfs__CompoundOpRes Nfs__CompoundOpRes;
+typedef struct Nfs__CompoundRes Nfs__CompoundRes;
+typedef struct Nfs__DirectoryEntriesPlusList Nfs__DirectoryEntriesPlusList;
+typedef struct Nfs__ReadDirPlusOk Nfs__ReadDirPlusOk;
+typedef struct Nfs__ReadDirPlusRes Nfs__ReadDirPlusRes;
+typedef struct Nfs__ReadDir2Ok Nfs__ReadDir2Ok;
+typedef struct Nfs__ReadDir2Res Nfs__ReadDir2Res;
 
 /* --- enums --- */
 
@@ -471,11 +480,15 @@ struct Nfs__ReadArgs {
      * unused
      */
     uint32_t totalcount;
+    /*
+     * extension: compression (RpcCompression) the read data may be sent with
+     */
+    uint32_t accepted_compression;
 };
 #define NFS__READ_ARGS__INIT                                                                                           \
     {                                                                                                                  \
         PROTOBUF_C_MESSAGE_INIT(&nfs__read_args__descriptor)                                                           \
-        , NULL, 0, 0, 0                                                                                                \
+        , NULL, 0, 0, 0, 0                                                                                             \
     }
 
 /*
@@ -485,13 +498,19 @@ struct Nfs__ReadResBody {
     ProtobufCMessage base;
     Nfs__FAttr *attributes;
     ProtobufCBinaryData nfsdata;
+    /*
+     * extension: compression (RpcCompression) of nfsdata
+     */
+    uint32_t compression;
+    /*
+     * extension: size in bytes of nfsdata once decompressed
+     */
+    uint32_t uncompressed_size;
 };
 #define NFS__READ_RES_BODY__INIT                                                                                       \
     {                                                                                                                  \
         PROTOBUF_C_MESSAGE_INIT(&nfs__read_res_body__descriptor)                                                       \
-        , NULL, {                                                                                                      \
-            0, NULL                                                                                                    \
-        }                                                                                                              \
+        , NULL, {0, NULL}, 0, 0                                                                                        \
     }
 
 typedef enum {
@@ -539,13 +558,19 @@ struct Nfs__WriteArgs {
      */
     uint32_t totalcount;
     ProtobufCBinaryData nfsdata;
+    /*
+     * extension: compression (RpcCompression) of nfsdata
+     */
+    uint32_t compression;
+    /*
+     * extension: size in bytes of nfsdata once decompressed
+     */
+    uint32_t uncompressed_size;
 };
 #define NFS__WRITE_ARGS__INIT                                                                                          \
     {                                                                                                                  \
         PROTOBUF_C_MESSAGE_INIT(&nfs__write_args__descriptor)                                                          \
-        , NULL, 0, 0, 0, {                                                                                             \
-            0, NULL                                                                                                    \
-        }                                                                                                              \
+        , NULL, 0, 0, 0, {0, NULL}, 0, 0                                                                               \
     }
 
 struct Nfs__CreateArgs {
@@ -702,11 +727,15 @@ struct Nfs__FsInfo {
      * number of 'bsize' blocks available to non-privileged users
      */
     uint64_t bavail;
+    /*
+     * extension: bitmask of the compressions (1 << RpcCompression) supported
+     */
+    uint32_t compression_algorithms;
 };
 #define NFS__FS_INFO__INIT                                                                                             \
     {                                                                                                                  \
         PROTOBUF_C_MESSAGE_INIT(&nfs__fs_info__descriptor)                                                             \
-        , 0, 0, 0, 0, 0                                                                                                \
+        , 0, 0, 0, 0, 0, 0                                                                                             \
     }
 
 typedef enum {
@@ -741,6 +770,214 @@ struct Nfs__StatFsRes {
         }                                                                                                              \
     }
 
+/*
+ * A single operation of a COMPOUND procedure
+ */
+struct Nfs__CompoundOp {
+    ProtobufCMessage base;
+    /*
+     * number of the Nfs procedure to run
+     */
+    uint32_t procedure;
+    /*
+     * run the procedure on the current filehandle instead of the one in 'parameters'
+     */
+    protobuf_c_boolean use_current_fhandle;
+    /*
+     * procedure parameters, encoded as in a standalone call of that procedure
+     */
+    ProtobufCBinaryData parameters;
+};
+#define NFS__COMPOUND_OP__INIT                                                                                         \
+    {                                                                                                                  \
+        PROTOBUF_C_MESSAGE_INIT(&nfs__compound_op__descriptor)                                                         \
+        , 0, 0, {                                                                                                      \
+            0, NULL                                                                                                    \
+        }                                                                                                              \
+    }
+
+/*
+ * Used for NFSPROC_COMPOUND arguments
+ */
+struct Nfs__CompoundArgs {
+    ProtobufCMessage base;
+    /*
+     * initial current filehandle
+     */
+    Nfs__FHandle *fhandle;
+    /*
+     * run in order, up to the first one that fails
+     */
+    size_t n_operations;
+    Nfs__CompoundOp **operations;
+};
+#define NFS__COMPOUND_ARGS__INIT                                                                                       \
+    {                                                                                                                  \
+        PROTOBUF_C_MESSAGE_INIT(&nfs__compound_args__descriptor)                                                       \
+        , NULL, 0, NULL                                                                                                \
+    }
+
+/*
+ * Result of a single operation of a COMPOUND procedure
+ */
+struct Nfs__CompoundOpRes {
+    ProtobufCMessage base;
+    uint32_t procedure;
+    Nfs__NfsStat *nfs_status;
+    /*
+     * procedure results, encoded as in a standalone call of that procedure
+     */
+    ProtobufCBinaryData results;
+};
+#define NFS__COMPOUND_OP_RES__INIT                                                                                     \
+    {                                                                                                                  \
+        PROTOBUF_C_MESSAGE_INIT(&nfs__compound_op_res__descriptor)                                                     \
+        , 0, NULL, {                                                                                                   \
+            0, NULL                                                                                                    \
+        }                                                                                                              \
+    }
+
+/*
+ * Used for NFSPROC_COMPOUND results
+ */
+struct Nfs__CompoundRes {
+    ProtobufCMessage base;
+    /*
+     * status of the last operation that was run
+     */
+    Nfs__NfsStat *nfs_status;
+    /*
+     * one for every operation that was run
+     */
+    size_t n_results;
+    Nfs__CompoundOpRes **results;
+};
+#define NFS__COMPOUND_RES__INIT                                                                                        \
+    {                                                                                                                  \
+        PROTOBUF_C_MESSAGE_INIT(&nfs__compound_res__descriptor)                                                        \
+        , NULL, 0, NULL                                                                                                \
+    }
+
+struct Nfs__DirectoryEntriesPlusList {
+    ProtobufCMessage base;
+    /*
+     * fileid here should be same as fileid in FAttr
+     */
+    uint64_t fileid;
+    Nfs__FileName *name;
+    Nfs__NfsCookie *cookie;
+    /*
+     * not set for '.' and '..', and if the client may not look up files in this directory
+     */
+    Nfs__FHandle *file;
+    /*
+     * set whenever 'file' is set
+     */
+    Nfs__FAttr *attributes;
+    Nfs__DirectoryEntriesPlusList *nextentry;
+};
+#define NFS__DIRECTORY_ENTRIES_PLUS_LIST__INIT                                                                         \
+    {                                                                                                                  \
+        PROTOBUF_C_MESSAGE_INIT(&nfs__directory_entries_plus_list__descriptor)                                         \
+        , 0, NULL, NULL, NULL, NULL, NULL                                                                              \
+    }
+
+struct Nfs__ReadDirPlusOk {
+    ProtobufCMessage base;
+    Nfs__DirectoryEntriesPlusList *entries;
+    protobuf_c_boolean eof;
+};
+#define NFS__READ_DIR_PLUS_OK__INIT                                                                                    \
+    {                                                                                                                  \
+        PROTOBUF_C_MESSAGE_INIT(&nfs__read_dir_plus_ok__descriptor)                                                    \
+        , NULL, 0                                                                                                      \
+    }
+
+typedef enum {
+    NFS__READ_DIR_PLUS_RES__BODY__NOT_SET = 0,
+    NFS__READ_DIR_PLUS_RES__BODY_READDIRPLUSOK = 2,
+    NFS__READ_DIR_PLUS_RES__BODY_DEFAULT_CASE =
+        3 PROTOBUF_C__FORCE_ENUM_TO_BE_INT_SIZE(NFS__READ_DIR_PLUS_RES__BODY__CASE)
+} Nfs__ReadDirPlusRes__BodyCase;
+
+/*
+ * Used for NFSPROC_READDIRPLUS results
+ */
+struct Nfs__ReadDirPlusRes {
+    ProtobufCMessage base;
+    Nfs__NfsStat *nfs_status;
+    Nfs__ReadDirPlusRes__BodyCase body_case;
+    union {
+        /*
+         * case NFS_OK
+         */
+        Nfs__ReadDirPlusOk *readdirplusok;
+        /*
+         * default case
+         */
+        Google__Protobuf__Empty *default_case;
+    };
+};
+#define NFS__READ_DIR_PLUS_RES__INIT                                                                                   \
+    {                                                                                                                  \
+        PROTOBUF_C_MESSAGE_INIT(&nfs__read_dir_plus_res__descriptor)                                                   \
+        , NULL, NFS__READ_DIR_PLUS_RES__BODY__NOT_SET, {                                                               \
+            0                                                                                                          \
+        }                                                                                                              \
+    }
+
+struct Nfs__ReadDir2Ok {
+    ProtobufCMessage base;
+    /*
+     * fileids here should be same as fileid in FAttr
+     */
+    size_t n_fileids;
+    uint64_t *fileids;
+    size_t n_cookies;
+    uint64_t *cookies;
+    size_t n_name_offsets;
+    uint32_t *name_offsets;
+    ProtobufCBinaryData names;
+    protobuf_c_boolean eof;
+};
+#define NFS__READ_DIR2_OK__INIT                                                                                        \
+    {                                                                                                                  \
+        PROTOBUF_C_MESSAGE_INIT(&nfs__read_dir2_ok__descriptor)                                                        \
+        , 0, NULL, 0, NULL, 0, NULL, {0, NULL}, 0                                                                      \
+    }
+
+typedef enum {
+    NFS__READ_DIR2_RES__BODY__NOT_SET = 0,
+    NFS__READ_DIR2_RES__BODY_READDIR2OK = 2,
+    NFS__READ_DIR2_RES__BODY_DEFAULT_CASE = 3 PROTOBUF_C__FORCE_ENUM_TO_BE_INT_SIZE(NFS__READ_DIR2_RES__BODY__CASE)
+} Nfs__ReadDir2Res__BodyCase;
+
+/*
+ * Used for NFSPROC_READDIR2 results
+ */
+struct Nfs__ReadDir2Res {
+    ProtobufCMessage base;
+    Nfs__NfsStat *nfs_status;
+    Nfs__ReadDir2Res__BodyCase body_case;
+    union {
+        /*
+         * case NFS_OK
+         */
+        Nfs__ReadDir2Ok *readdir2ok;
+        /*
+         * default case
+         */
+        Google__Protobuf__Empty *default_case;
+    };
+};
+#define NFS__READ_DIR2_RES__INIT                                                                                       \
+    {                                                                                                                  \
+        PROTOBUF_C_MESSAGE_INIT(&nfs__read_dir2_res__descriptor)                                                       \
+        , NULL, NFS__READ_DIR2_RES__BODY__NOT_SET, {                                                                   \
+            0                                                                                                          \
+        }                                                                                                              \
+    }
+
 /* Nfs__NfsStat methods */
 void nfs__nfs_stat__init(Nfs__NfsStat *message);
 size_t nfs__nfs_stat__get_packed_size(const Nfs__NfsStat *message);
@@ -945,6 +1182,72 @@ size_t nfs__stat_fs_res__pack(const Nfs__StatFsRes *message, uint8_t *out);
 size_t nfs__stat_fs_res__pack_to_buffer(const Nfs__StatFsRes *message, ProtobufCBuffer *buffer);
 Nfs__StatFsRes *nfs__stat_fs_res__unpack(ProtobufCAllocator *allocator, size_t len, const uint8_t *data);
 void nfs__stat_fs_res__free_unpacked(Nfs__StatFsRes *message, ProtobufCAllocator *allocator);
+/* Nfs__CompoundOp methods */
+void nfs__compound_op__init(Nfs__CompoundOp *message);
+size_t nfs__compound_op__get_packed_size(const Nfs__CompoundOp *message);
+size_t nfs__compound_op__pack(const Nfs__CompoundOp *message, uint8_t *out);
+size_t nfs__compound_op__pack_to_buffer(const Nfs__CompoundOp *message, ProtobufCBuffer *buffer);
+Nfs__CompoundOp *nfs__compound_op__unpack(ProtobufCAllocator *allocator, size_t len, const uint8_t *data);
+void nfs__compound_op__free_unpacked(Nfs__CompoundOp *message, ProtobufCAllocator *allocator);
+/* Nfs__CompoundArgs methods */
+void nfs__compound_args__init(Nfs__CompoundArgs *message);
+size_t nfs__compound_args__get_packed_size(const Nfs__CompoundArgs *message);
+size_t nfs__compound_args__pack(const Nfs__CompoundArgs *message, uint8_t *out);
+size_t nfs__compound_args__pack_to_buffer(const Nfs__CompoundArgs *message, ProtobufCBuffer *buffer);
+Nfs__CompoundArgs *nfs__compound_args__unpack(ProtobufCAllocator *allocator, size_t len, const uint8_t *data);
+void nfs__compound_args__free_unpacked(Nfs__CompoundArgs *message, ProtobufCAllocator *allocator);
+/* Nfs__CompoundOpRes methods */
+void nfs__compound_op_res__init(Nfs__CompoundOpRes *message);
+size_t nfs__compound_op_res__get_packed_size(const Nfs__CompoundOpRes *message);
+size_t nfs__compound_op_res__pack(const Nfs__CompoundOpRes *message, uint8_t *out);
+size_t nfs__compound_op_res__pack_to_buffer(const Nfs__CompoundOpRes *message, ProtobufCBuffer *buffer);
+Nfs__CompoundOpRes *nfs__compound_op_res__unpack(ProtobufCAllocator *allocator, size_t len, const uint8_t *data);
+void nfs__compound_op_res__free_unpacked(Nfs__CompoundOpRes *message, ProtobufCAllocator *allocator);
+/* Nfs__CompoundRes methods */
+void nfs__compound_res__init(Nfs__CompoundRes *message);
+size_t nfs__compound_res__get_packed_size(const Nfs__CompoundRes *message);
+size_t nfs__compound_res__pack(const Nfs__CompoundRes *message, uint8_t *out);
+size_t nfs__compound_res__pack_to_buffer(const Nfs__CompoundRes *message, ProtobufCBuffer *buffer);
+Nfs__CompoundRes *nfs__compound_res__unpack(ProtobufCAllocator *allocator, size_t len, const uint8_t *data);
+void nfs__compound_res__free_unpacked(Nfs__CompoundRes *message, ProtobufCAllocator *allocator);
+/* Nfs__DirectoryEntriesPlusList methods */
+void nfs__directory_entries_plus_list__init(Nfs__DirectoryEntriesPlusList *message);
+size_t nfs__directory_entries_plus_list__get_packed_size(const Nfs__DirectoryEntriesPlusList *message);
+size_t nfs__directory_entries_plus_list__pack(const Nfs__DirectoryEntriesPlusList *message, uint8_t *out);
+size_t nfs__directory_entries_plus_list__pack_to_buffer(const Nfs__DirectoryEntriesPlusList *message,
+                                                        ProtobufCBuffer *buffer);
+Nfs__DirectoryEntriesPlusList *nfs__directory_entries_plus_list__unpack(ProtobufCAllocator *allocator, size_t len,
+                                                                       const uint8_t *data);
+void nfs__directory_entries_plus_list__free_unpacked(Nfs__DirectoryEntriesPlusList *message,
+                                                     ProtobufCAllocator *allocator);
+/* Nfs__ReadDirPlusOk methods */
+void nfs__read_dir_plus_ok__init(Nfs__ReadDirPlusOk *message);
+size_t nfs__read_dir_plus_ok__get_packed_size(const Nfs__ReadDirPlusOk *message);
+size_t nfs__read_dir_plus_ok__pack(const Nfs__ReadDirPlusOk *message, uint8_t *out);
+size_t nfs__read_dir_plus_ok__pack_to_buffer(const Nfs__ReadDirPlusOk *message, ProtobufCBuffer *buffer);
+Nfs__ReadDirPlusOk *nfs__read_dir_plus_ok__unpack(ProtobufCAllocator *allocator, size_t len, const uint8_t *data);
+void nfs__read_dir_plus_ok__free_unpacked(Nfs__ReadDirPlusOk *message, ProtobufCAllocator *allocator);
+/* Nfs__ReadDirPlusRes methods */
+void nfs__read_dir_plus_res__init(Nfs__ReadDirPlusRes *message);
+size_t nfs__read_dir_plus_res__get_packed_size(const Nfs__ReadDirPlusRes *message);
+size_t nfs__read_dir_plus_res__pack(const Nfs__ReadDirPlusRes *message, uint8_t *out);
+size_t nfs__read_dir_plus_res__pack_to_buffer(const Nfs__ReadDirPlusRes *message, ProtobufCBuffer *buffer);
+Nfs__ReadDirPlusRes *nfs__read_dir_plus_res__unpack(ProtobufCAllocator *allocator, size_t len, const uint8_t *data);
+void nfs__read_dir_plus_res__free_unpacked(Nfs__ReadDirPlusRes *message, ProtobufCAllocator *allocator);
+/* Nfs__ReadDir2Ok methods */
+void nfs__read_dir2_ok__init(Nfs__ReadDir2Ok *message);
+size_t nfs__read_dir2_ok__get_packed_size(const Nfs__ReadDir2Ok *message);
+size_t nfs__read_dir2_ok__pack(const Nfs__ReadDir2Ok *message, uint8_t *out);
+size_t nfs__read_dir2_ok__pack_to_buffer(const Nfs__ReadDir2Ok *message, ProtobufCBuffer *buffer);
+Nfs__ReadDir2Ok *nfs__read_dir2_ok__unpack(ProtobufCAllocator *allocator, size_t len, const uint8_t *data);
+void nfs__read_dir2_ok__free_unpacked(Nfs__ReadDir2Ok *message, ProtobufCAllocator *allocator);
+/* Nfs__ReadDir2Res methods */
+void nfs__read_dir2_res__init(Nfs__ReadDir2Res *message);
+size_t nfs__read_dir2_res__get_packed_size(const Nfs__ReadDir2Res *message);
+size_t nfs__read_dir2_res__pack(const Nfs__ReadDir2Res *message, uint8_t *out);
+size_t nfs__read_dir2_res__pack_to_buffer(const Nfs__ReadDir2Res *message, ProtobufCBuffer *buffer);
+Nfs__ReadDir2Res *nfs__read_dir2_res__unpack(ProtobufCAllocator *allocator, size_t len, const uint8_t *data);
+void nfs__read_dir2_res__free_unpacked(Nfs__ReadDir2Res *message, ProtobufCAllocator *allocator);
 /* --- per-message closures --- */
 
 typedef void (*Nfs__NfsStat_Closure)(const Nfs__NfsStat *message, void *closure_data);
@@ -976,6 +1279,16 @@ typedef void (*Nfs__ReadDirOk_Closure)(const Nfs__ReadDirOk *message, void *clos
 typedef void (*Nfs__ReadDirRes_Closure)(const Nfs__ReadDirRes *message, void *closure_data);
 typedef void (*Nfs__FsInfo_Closure)(const Nfs__FsInfo *message, void *closure_data);
 typedef void (*Nfs__StatFsRes_Closure)(const Nfs__StatFsRes *message, void *closure_data);
+typedef void (*Nfs__CompoundOp_Closure)(const Nfs__CompoundOp *message, void *closure_data);
+typedef void (*Nfs__CompoundArgs_Closure)(const Nfs__CompoundArgs *message, void *closure_data);
+typedef void (*Nfs__CompoundOpRes_Closure)(const Nfs__CompoundOpRes *message, void *closure_data);
+typedef void (*Nfs__CompoundRes_Closure)(const Nfs__CompoundRes *message, void *closure_data);
+typedef void (*Nfs__DirectoryEntriesPlusList_Closure)(const Nfs__DirectoryEntriesPlusList *message,
+                                                     void *closure_data);
+typedef void (*Nfs__ReadDirPlusOk_Closure)(const Nfs__ReadDirPlusOk *message, void *closure_data);
+typedef void (*Nfs__ReadDirPlusRes_Closure)(const Nfs__ReadDirPlusRes *message, void *closure_data);
+typedef void (*Nfs__ReadDir2Ok_Closure)(const Nfs__ReadDir2Ok *message, void *closure_data);
+typedef void (*Nfs__ReadDir2Res_Closure)(const Nfs__ReadDir2Res *message, void *closure_data);
 
 /* --- services --- */
 
@@ -1012,6 +1325,15 @@ extern const ProtobufCMessageDescriptor nfs__read_dir_ok__descriptor;
 extern const ProtobufCMessageDescriptor nfs__read_dir_res__descriptor;
 extern const ProtobufCMessageDescriptor nfs__fs_info__descriptor;
 extern const ProtobufCMessageDescriptor nfs__stat_fs_res__descriptor;
+extern const ProtobufCMessageDescriptor nfs__compound_op__descriptor;
+extern const ProtobufCMessageDescriptor nfs__compound_args__descriptor;
+extern const ProtobufCMessageDescriptor nfs__compound_op_res__descriptor;
+extern const ProtobufCMessageDescriptor nfs__compound_res__descriptor;
+extern const ProtobufCMessageDescriptor nfs__directory_entries_plus_list__descriptor;
+extern const ProtobufCMessageDescriptor nfs__read_dir_plus_ok__descriptor;
+extern const ProtobufCMessageDescriptor nfs__read_dir_plus_res__descriptor;
+extern const ProtobufCMessageDescriptor nfs__read_dir2_ok__descriptor;
+extern const ProtobufCMessageDescriptor nfs__read_dir2_res__descriptor;
 
 PROTOBUF_C__END_DECLS
 
@@ -259,7 +259,7 @@ const ProtobufCMessageDescriptor rpc__auth_sys_params__descriptor = {
     NULL,
     NULL /* reserved[123] */
 };
-static const ProtobufCFieldDescriptor rpc__opaque_auth__field_descriptors[3] = {
+static const ProtobufCFieldDescriptor rpc__opaque_auth__field_descriptors[4] = {
     {
         "flavor", 1, PROTOBUF_C_LABEL_NONE, PROTOBUF_C_TYPE_ENUM, 0,               /* quantifier_offset */
         offsetof(Rpc__OpaqueAuth, flavor), &rpc__auth_flavor__descriptor, NULL, 0, /* flags */
@@ -277,13 +277,20 @@ static const ProtobufCFieldDescriptor rpc__opaque_auth__field_descriptors[3] = {
         0 | PROTOBUF_C_FIELD_FLAG_ONEOF, /* flags */
         0, NULL, NULL                    /* reserved1,reserved2, etc */
     },
+    {
+        "auth_short", 4, PROTOBUF_C_LABEL_NONE, PROTOBUF_C_TYPE_BYTES, offsetof(Rpc__OpaqueAuth, body_case),
+        offsetof(Rpc__OpaqueAuth, auth_short), NULL, NULL,
+        0 | PROTOBUF_C_FIELD_FLAG_ONEOF, /* flags */
+        0, NULL, NULL                    /* reserved1,reserved2, etc */
+    },
 };
 static const unsigned rpc__opaque_auth__field_indices_by_name[] = {
+    3, /* field[3] = auth_short */
     2, /* field[2] = auth_sys */
     1, /* field[1] = empty */
     0, /* field[0] = flavor */
 };
-static const ProtobufCIntRange rpc__opaque_auth__number_ranges[1 + 1] = {{1, 0}, {0, 3}};
+static const ProtobufCIntRange rpc__opaque_auth__number_ranges[1 + 1] = {{1, 0}, {0, 4}};
 const ProtobufCMessageDescriptor rpc__opaque_auth__descriptor = {
     PROTOBUF_C__MESSAGE_DESCRIPTOR_MAGIC,
     "rpc.OpaqueAuth",
@@ -291,7 +298,7 @@ const ProtobufCMessageDescriptor rpc__opaque_auth__descriptor = {
     "Rpc__OpaqueAuth",
     "rpc",
     sizeof(Rpc__OpaqueAuth),
-    3,
+    4,
     rpc__opaque_auth__field_descriptors,
     rpc__opaque_auth__field_indices_by_name,
     1,
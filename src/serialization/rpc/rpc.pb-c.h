@@ -184,7 +184,8 @@ struct Rpc__AuthSysParams {
 typedef enum {
     RPC__OPAQUE_AUTH__BODY__NOT_SET = 0,
     RPC__OPAQUE_AUTH__BODY_EMPTY = 2,
-    RPC__OPAQUE_AUTH__BODY_AUTH_SYS = 3 PROTOBUF_C__FORCE_ENUM_TO_BE_INT_SIZE(RPC__OPAQUE_AUTH__BODY__CASE)
+    RPC__OPAQUE_AUTH__BODY_AUTH_SYS = 3,
+    RPC__OPAQUE_AUTH__BODY_AUTH_SHORT = 4 PROTOBUF_C__FORCE_ENUM_TO_BE_INT_SIZE(RPC__OPAQUE_AUTH__BODY__CASE)
 } Rpc__OpaqueAuth__BodyCase;
 
 struct Rpc__OpaqueAuth {
@@ -200,6 +201,10 @@ struct Rpc__OpaqueAuth {
          * case AUTH_SYS
          */
         Rpc__AuthSysParams *auth_sys;
+        /*
+         * case AUTH_SHORT (max 400 bytes)
+         */
+        ProtobufCBinaryData auth_short;
     };
 };
 #define RPC__OPAQUE_AUTH__INIT                                                                                         \
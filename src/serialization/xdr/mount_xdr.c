@@ -0,0 +1,110 @@
+#include "xdr.h"
+
+#include "src/nfs/nfs_common.h"
+
+/*
+ * XDR encoding of the Mount procedure parameters and results (RFC 1094, appendix A).
+ */
+
+#define XDR_MNT_STAT_SIZE 4
+
+/*
+ * FHandle
+ */
+
+static size_t get_fhandle_size(const Mount__FHandle *fhandle) {
+    return XDR_FHANDLE_SIZE;
+}
+
+static uint8_t *pack_fhandle(const Mount__FHandle *fhandle, uint8_t *out) {
+    return xdr_pack_nfs_filehandle(fhandle == NULL ? NULL : fhandle->nfs_filehandle, out);
+}
+
+static Mount__FHandle *unpack_fhandle(XdrDecoder *decoder) {
+    Mount__FHandle *fhandle = xdr_alloc(decoder, sizeof(Mount__FHandle));
+    if (fhandle == NULL) {
+        return NULL;
+    }
+    mount__fhandle__init(fhandle);
+
+    fhandle->nfs_filehandle = xdr_unpack_nfs_filehandle(decoder);
+
+    return fhandle;
+}
+
+/*
+ * FhStatus
+ */
+
+static bool is_mnt_ok(const Mount__MntStat *mnt_status) {
+    return mnt_status == NULL || mnt_status->stat == MOUNT__STAT__MNT_OK;
+}
+
+static size_t get_fh_status_size(const Mount__FhStatus *fh_status) {
+    return XDR_MNT_STAT_SIZE + (is_mnt_ok(fh_status->mnt_status) ? XDR_FHANDLE_SIZE : 0);
+}
+
+static uint8_t *pack_fh_status(const Mount__FhStatus *fh_status, uint8_t *out) {
+    out = xdr_pack_uint32(fh_status->mnt_status == NULL ? MOUNT__STAT__MNT_OK : fh_status->mnt_status->stat, out);
+    if (!is_mnt_ok(fh_status->mnt_status)) {
+        return out;
+    }
+
+    return pack_fhandle(
+        fh_status->fhstatus_body_case == MOUNT__FH_STATUS__FHSTATUS_BODY_DIRECTORY ? fh_status->directory : NULL, out);
+}
+
+static Mount__FhStatus *unpack_fh_status(XdrDecoder *decoder) {
+    Mount__FhStatus *fh_status = xdr_alloc(decoder, sizeof(Mount__FhStatus));
+    if (fh_status == NULL) {
+        return NULL;
+    }
+    mount__fh_status__init(fh_status);
+
+    fh_status->mnt_status = xdr_alloc(decoder, sizeof(Mount__MntStat));
+    if (fh_status->mnt_status != NULL) {
+        mount__mnt_stat__init(fh_status->mnt_status);
+        fh_status->mnt_status->stat = xdr_unpack_uint32(decoder);
+    }
+
+    if (fh_status->mnt_status != NULL && is_mnt_ok(fh_status->mnt_status)) {
+        fh_status->fhstatus_body_case = MOUNT__FH_STATUS__FHSTATUS_BODY_DIRECTORY;
+        fh_status->directory = unpack_fhandle(decoder);
+    } else {
+        fh_status->fhstatus_body_case = MOUNT__FH_STATUS__FHSTATUS_BODY_DEFAULT_CASE;
+        fh_status->default_case = xdr_unpack_empty(decoder);
+    }
+
+    return fh_status;
+}
+
+/*
+ * DirPath
+ */
+
+static size_t get_dir_path_size(const Mount__DirPath *dir_path) {
+    return xdr_string_size(dir_path->path);
+}
+
+static uint8_t *pack_dir_path(const Mount__DirPath *dir_path, uint8_t *out) {
+    return xdr_pack_string(dir_path->path, out);
+}
+
+static Mount__DirPath *unpack_dir_path(XdrDecoder *decoder) {
+    Mount__DirPath *dir_path = xdr_alloc(decoder, sizeof(Mount__DirPath));
+    if (dir_path == NULL) {
+        return NULL;
+    }
+    mount__dir_path__init(dir_path);
+
+    dir_path->path = xdr_unpack_string(decoder, NFS_MAXPATHLEN);
+
+    return dir_path;
+}
+
+DEFINE_XDR_MESSAGE_CODEC(dir_path_codec, dir_path, Mount__DirPath, mount__dir_path__descriptor);
+DEFINE_XDR_MESSAGE_CODEC(fh_status_codec, fh_status, Mount__FhStatus, mount__fh_status__descriptor);
+DEFINE_XDR_MESSAGE_CODEC(fhandle_codec, fhandle, Mount__FHandle, mount__fhandle__descriptor);
+
+const XdrMessageCodec *const mount_xdr_message_codecs[] = {&dir_path_codec, &fh_status_codec, &fhandle_codec};
+const size_t num_mount_xdr_message_codecs = sizeof(mount_xdr_message_codecs) / sizeof(mount_xdr_message_codecs[0]);
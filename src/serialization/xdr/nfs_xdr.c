@@ -0,0 +1,1269 @@
+#include "xdr.h"
+
+#include "src/nfs/nfs_common.h"
+
+/*
+ * XDR encoding of the Nfs procedure parameters and results (RFC 1094, section 2.3).
+ */
+
+#define XDR_NFS_STAT_SIZE 4
+#define XDR_TIME_VAL_SIZE 16
+#define XDR_FATTR_SIZE (4 + 4 + 8 + 4 + 4 + 6 * 8 + 3 * XDR_TIME_VAL_SIZE)
+#define XDR_SATTR_SIZE (3 * 4 + 8 + 2 * XDR_TIME_VAL_SIZE)
+#define XDR_NFS_COOKIE_SIZE 8
+#define XDR_FS_INFO_SIZE (4 + 4 * 8)
+
+/*
+ * NfsStat
+ */
+
+static bool is_nfs_ok(const Nfs__NfsStat *nfs_status) {
+    return nfs_status == NULL || nfs_status->stat == NFS__STAT__NFS_OK;
+}
+
+static size_t get_nfs_stat_size(const Nfs__NfsStat *nfs_status) {
+    return XDR_NFS_STAT_SIZE;
+}
+
+static uint8_t *pack_nfs_stat(const Nfs__NfsStat *nfs_status, uint8_t *out) {
+    return xdr_pack_uint32(nfs_status == NULL ? NFS__STAT__NFS_OK : nfs_status->stat, out);
+}
+
+static Nfs__NfsStat *unpack_nfs_stat(XdrDecoder *decoder) {
+    Nfs__NfsStat *nfs_status = xdr_alloc(decoder, sizeof(Nfs__NfsStat));
+    if (nfs_status == NULL) {
+        return NULL;
+    }
+    nfs__nfs_stat__init(nfs_status);
+
+    nfs_status->stat = xdr_unpack_uint32(decoder);
+
+    return nfs_status;
+}
+
+/*
+ * FHandle
+ */
+
+static size_t get_fhandle_size(const Nfs__FHandle *fhandle) {
+    return XDR_FHANDLE_SIZE;
+}
+
+static uint8_t *pack_fhandle(const Nfs__FHandle *fhandle, uint8_t *out) {
+    return xdr_pack_nfs_filehandle(fhandle == NULL ? NULL : fhandle->nfs_filehandle, out);
+}
+
+static Nfs__FHandle *unpack_fhandle(XdrDecoder *decoder) {
+    Nfs__FHandle *fhandle = xdr_alloc(decoder, sizeof(Nfs__FHandle));
+    if (fhandle == NULL) {
+        return NULL;
+    }
+    nfs__fhandle__init(fhandle);
+
+    fhandle->nfs_filehandle = xdr_unpack_nfs_filehandle(decoder);
+
+    return fhandle;
+}
+
+/*
+ * TimeVal
+ */
+
+static uint8_t *pack_time_val(const Nfs__TimeVal *time_val, uint8_t *out) {
+    out = xdr_pack_uint64(time_val == NULL ? 0 : time_val->seconds, out);
+
+    return xdr_pack_uint64(time_val == NULL ? 0 : time_val->useconds, out);
+}
+
+static Nfs__TimeVal *unpack_time_val(XdrDecoder *decoder) {
+    Nfs__TimeVal *time_val = xdr_alloc(decoder, sizeof(Nfs__TimeVal));
+    if (time_val == NULL) {
+        return NULL;
+    }
+    nfs__time_val__init(time_val);
+
+    time_val->seconds = xdr_unpack_uint64(decoder);
+    time_val->useconds = xdr_unpack_uint64(decoder);
+
+    return time_val;
+}
+
+/*
+ * FAttr
+ */
+
+static uint8_t *pack_fattr(const Nfs__FAttr *fattr, uint8_t *out) {
+    if (fattr == NULL) {
+        memset(out, 0, XDR_FATTR_SIZE);
+        return out + XDR_FATTR_SIZE;
+    }
+
+    out = xdr_pack_uint32(fattr->nfs_ftype == NULL ? NFS__FTYPE__NFNON : fattr->nfs_ftype->ftype, out);
+    out = xdr_pack_uint32(fattr->mode, out);
+    out = xdr_pack_uint64(fattr->nlink, out);
+    out = xdr_pack_uint32(fattr->uid, out);
+    out = xdr_pack_uint32(fattr->gid, out);
+    out = xdr_pack_uint64(fattr->size, out);
+    out = xdr_pack_uint64(fattr->blocksize, out);
+    out = xdr_pack_uint64(fattr->rdev, out);
+    out = xdr_pack_uint64(fattr->blocks, out);
+    out = xdr_pack_uint64(fattr->fsid, out);
+    out = xdr_pack_uint64(fattr->fileid, out);
+    out = pack_time_val(fattr->atime, out);
+    out = pack_time_val(fattr->mtime, out);
+
+    return pack_time_val(fattr->ctime, out);
+}
+
+static Nfs__FAttr *unpack_fattr(XdrDecoder *decoder) {
+    Nfs__FAttr *fattr = xdr_alloc(decoder, sizeof(Nfs__FAttr));
+    if (fattr == NULL) {
+        return NULL;
+    }
+    nfs__fattr__init(fattr);
+
+    fattr->nfs_ftype = xdr_alloc(decoder, sizeof(Nfs__NfsFType));
+    if (fattr->nfs_ftype != NULL) {
+        nfs__nfs_ftype__init(fattr->nfs_ftype);
+        fattr->nfs_ftype->ftype = xdr_unpack_uint32(decoder);
+    }
+    fattr->mode = xdr_unpack_uint32(decoder);
+    fattr->nlink = xdr_unpack_uint64(decoder);
+    fattr->uid = xdr_unpack_uint32(decoder);
+    fattr->gid = xdr_unpack_uint32(decoder);
+    fattr->size = xdr_unpack_uint64(decoder);
+    fattr->blocksize = xdr_unpack_uint64(decoder);
+    fattr->rdev = xdr_unpack_uint64(decoder);
+    fattr->blocks = xdr_unpack_uint64(decoder);
+    fattr->fsid = xdr_unpack_uint64(decoder);
+    fattr->fileid = xdr_unpack_uint64(decoder);
+    fattr->atime = unpack_time_val(decoder);
+    fattr->mtime = unpack_time_val(decoder);
+    fattr->ctime = unpack_time_val(decoder);
+
+    return fattr;
+}
+
+/*
+ * SAttr
+ */
+
+static uint8_t *pack_sattr(const Nfs__SAttr *sattr, uint8_t *out) {
+    if (sattr == NULL) {
+        memset(out, 0, XDR_SATTR_SIZE);
+        return out + XDR_SATTR_SIZE;
+    }
+
+    out = xdr_pack_uint32(sattr->mode, out);
+    out = xdr_pack_uint32(sattr->uid, out);
+    out = xdr_pack_uint32(sattr->gid, out);
+    out = xdr_pack_uint64(sattr->size, out);
+    out = pack_time_val(sattr->atime, out);
+
+    return pack_time_val(sattr->mtime, out);
+}
+
+static Nfs__SAttr *unpack_sattr(XdrDecoder *decoder) {
+    Nfs__SAttr *sattr = xdr_alloc(decoder, sizeof(Nfs__SAttr));
+    if (sattr == NULL) {
+        return NULL;
+    }
+    nfs__sattr__init(sattr);
+
+    sattr->mode = xdr_unpack_uint32(decoder);
+    sattr->uid = xdr_unpack_uint32(decoder);
+    sattr->gid = xdr_unpack_uint32(decoder);
+    sattr->size = xdr_unpack_uint64(decoder);
+    sattr->atime = unpack_time_val(decoder);
+    sattr->mtime = unpack_time_val(decoder);
+
+    return sattr;
+}
+
+/*
+ * FileName and Path
+ */
+
+static size_t get_file_name_size(const Nfs__FileName *file_name) {
+    return xdr_string_size(file_name == NULL ? NULL : file_name->filename);
+}
+
+static uint8_t *pack_file_name(const Nfs__FileName *file_name, uint8_t *out) {
+    return xdr_pack_string(file_name == NULL ? NULL : file_name->filename, out);
+}
+
+static Nfs__FileName *unpack_file_name(XdrDecoder *decoder) {
+    Nfs__FileName *file_name = xdr_alloc(decoder, sizeof(Nfs__FileName));
+    if (file_name == NULL) {
+        return NULL;
+    }
+    nfs__file_name__init(file_name);
+
+    file_name->filename = xdr_unpack_string(decoder, NFS_MAXNAMLEN);
+
+    return file_name;
+}
+
+static size_t get_path_size(const Nfs__Path *path) {
+    return xdr_string_size(path == NULL ? NULL : path->path);
+}
+
+static uint8_t *pack_path(const Nfs__Path *path, uint8_t *out) {
+    return xdr_pack_string(path == NULL ? NULL : path->path, out);
+}
+
+static Nfs__Path *unpack_path(XdrDecoder *decoder) {
+    Nfs__Path *path = xdr_alloc(decoder, sizeof(Nfs__Path));
+    if (path == NULL) {
+        return NULL;
+    }
+    nfs__path__init(path);
+
+    path->path = xdr_unpack_string(decoder, NFS_MAXPATHLEN);
+
+    return path;
+}
+
+/*
+ * AttrStat
+ */
+
+static size_t get_attr_stat_size(const Nfs__AttrStat *attr_stat) {
+    return XDR_NFS_STAT_SIZE + (is_nfs_ok(attr_stat->nfs_status) ? XDR_FATTR_SIZE : 0);
+}
+
+static uint8_t *pack_attr_stat(const Nfs__AttrStat *attr_stat, uint8_t *out) {
+    out = pack_nfs_stat(attr_stat->nfs_status, out);
+    if (!is_nfs_ok(attr_stat->nfs_status)) {
+        return out;
+    }
+
+    return pack_fattr(attr_stat->body_case == NFS__ATTR_STAT__BODY_ATTRIBUTES ? attr_stat->attributes : NULL, out);
+}
+
+static Nfs__AttrStat *unpack_attr_stat(XdrDecoder *decoder) {
+    Nfs__AttrStat *attr_stat = xdr_alloc(decoder, sizeof(Nfs__AttrStat));
+    if (attr_stat == NULL) {
+        return NULL;
+    }
+    nfs__attr_stat__init(attr_stat);
+
+    attr_stat->nfs_status = unpack_nfs_stat(decoder);
+    if (attr_stat->nfs_status != NULL && is_nfs_ok(attr_stat->nfs_status)) {
+        attr_stat->body_case = NFS__ATTR_STAT__BODY_ATTRIBUTES;
+        attr_stat->attributes = unpack_fattr(decoder);
+    } else {
+        attr_stat->body_case = NFS__ATTR_STAT__BODY_DEFAULT_CASE;
+        attr_stat->default_case = xdr_unpack_empty(decoder);
+    }
+
+    return attr_stat;
+}
+
+/*
+ * DirOpArgs
+ */
+
+static size_t get_dir_op_args_size(const Nfs__DirOpArgs *diropargs) {
+    return XDR_FHANDLE_SIZE + get_file_name_size(diropargs == NULL ? NULL : diropargs->name);
+}
+
+static uint8_t *pack_dir_op_args(const Nfs__DirOpArgs *diropargs, uint8_t *out) {
+    out = pack_fhandle(diropargs == NULL ? NULL : diropargs->dir, out);
+
+    return pack_file_name(diropargs == NULL ? NULL : diropargs->name, out);
+}
+
+static Nfs__DirOpArgs *unpack_dir_op_args(XdrDecoder *decoder) {
+    Nfs__DirOpArgs *diropargs = xdr_alloc(decoder, sizeof(Nfs__DirOpArgs));
+    if (diropargs == NULL) {
+        return NULL;
+    }
+    nfs__dir_op_args__init(diropargs);
+
+    diropargs->dir = unpack_fhandle(decoder);
+    diropargs->name = unpack_file_name(decoder);
+
+    return diropargs;
+}
+
+/*
+ * DirOpRes
+ */
+
+static size_t get_dir_op_res_size(const Nfs__DirOpRes *diropres) {
+    return XDR_NFS_STAT_SIZE + (is_nfs_ok(diropres->nfs_status) ? XDR_FHANDLE_SIZE + XDR_FATTR_SIZE : 0);
+}
+
+static uint8_t *pack_dir_op_res(const Nfs__DirOpRes *diropres, uint8_t *out) {
+    out = pack_nfs_stat(diropres->nfs_status, out);
+    if (!is_nfs_ok(diropres->nfs_status)) {
+        return out;
+    }
+
+    const Nfs__DirOpOk *diropok = diropres->body_case == NFS__DIR_OP_RES__BODY_DIROPOK ? diropres->diropok : NULL;
+    out = pack_fhandle(diropok == NULL ? NULL : diropok->file, out);
+
+    return pack_fattr(diropok == NULL ? NULL : diropok->attributes, out);
+}
+
+static Nfs__DirOpRes *unpack_dir_op_res(XdrDecoder *decoder) {
+    Nfs__DirOpRes *diropres = xdr_alloc(decoder, sizeof(Nfs__DirOpRes));
+    if (diropres == NULL) {
+        return NULL;
+    }
+    nfs__dir_op_res__init(diropres);
+
+    diropres->nfs_status = unpack_nfs_stat(decoder);
+    if (diropres->nfs_status == NULL || !is_nfs_ok(diropres->nfs_status)) {
+        diropres->body_case = NFS__DIR_OP_RES__BODY_DEFAULT_CASE;
+        diropres->default_case = xdr_unpack_empty(decoder);
+
+        return diropres;
+    }
+
+    diropres->body_case = NFS__DIR_OP_RES__BODY_DIROPOK;
+    diropres->diropok = xdr_alloc(decoder, sizeof(Nfs__DirOpOk));
+    if (diropres->diropok != NULL) {
+        nfs__dir_op_ok__init(diropres->diropok);
+        diropres->diropok->file = unpack_fhandle(decoder);
+        diropres->diropok->attributes = unpack_fattr(decoder);
+    }
+
+    return diropres;
+}
+
+/*
+ * SAttrArgs
+ */
+
+static size_t get_sattr_args_size(const Nfs__SAttrArgs *sattrargs) {
+    return XDR_FHANDLE_SIZE + XDR_SATTR_SIZE;
+}
+
+static uint8_t *pack_sattr_args(const Nfs__SAttrArgs *sattrargs, uint8_t *out) {
+    out = pack_fhandle(sattrargs->file, out);
+
+    return pack_sattr(sattrargs->attributes, out);
+}
+
+static Nfs__SAttrArgs *unpack_sattr_args(XdrDecoder *decoder) {
+    Nfs__SAttrArgs *sattrargs = xdr_alloc(decoder, sizeof(Nfs__SAttrArgs));
+    if (sattrargs == NULL) {
+        return NULL;
+    }
+    nfs__sattr_args__init(sattrargs);
+
+    sattrargs->file = unpack_fhandle(decoder);
+    sattrargs->attributes = unpack_sattr(decoder);
+
+    return sattrargs;
+}
+
+/*
+ * ReadLinkRes
+ */
+
+static size_t get_read_link_res_size(const Nfs__ReadLinkRes *readlinkres) {
+    if (!is_nfs_ok(readlinkres->nfs_status)) {
+        return XDR_NFS_STAT_SIZE;
+    }
+
+    return XDR_NFS_STAT_SIZE +
+           get_path_size(readlinkres->body_case == NFS__READ_LINK_RES__BODY_DATA ? readlinkres->data : NULL);
+}
+
+static uint8_t *pack_read_link_res(const Nfs__ReadLinkRes *readlinkres, uint8_t *out) {
+    out = pack_nfs_stat(readlinkres->nfs_status, out);
+    if (!is_nfs_ok(readlinkres->nfs_status)) {
+        return out;
+    }
+
+    return pack_path(readlinkres->body_case == NFS__READ_LINK_RES__BODY_DATA ? readlinkres->data : NULL, out);
+}
+
+static Nfs__ReadLinkRes *unpack_read_link_res(XdrDecoder *decoder) {
+    Nfs__ReadLinkRes *readlinkres = xdr_alloc(decoder, sizeof(Nfs__ReadLinkRes));
+    if (readlinkres == NULL) {
+        return NULL;
+    }
+    nfs__read_link_res__init(readlinkres);
+
+    readlinkres->nfs_status = unpack_nfs_stat(decoder);
+    if (readlinkres->nfs_status != NULL && is_nfs_ok(readlinkres->nfs_status)) {
+        readlinkres->body_case = NFS__READ_LINK_RES__BODY_DATA;
+        readlinkres->data = unpack_path(decoder);
+    } else {
+        readlinkres->body_case = NFS__READ_LINK_RES__BODY_DEFAULT_CASE;
+        readlinkres->default_case = xdr_unpack_empty(decoder);
+    }
+
+    return readlinkres;
+}
+
+/*
+ * ReadArgs
+ */
+
+static size_t get_read_args_size(const Nfs__ReadArgs *readargs) {
+    return XDR_FHANDLE_SIZE + 3 * 4;
+}
+
+static uint8_t *pack_read_args(const Nfs__ReadArgs *readargs, uint8_t *out) {
+    out = pack_fhandle(readargs->file, out);
+    out = xdr_pack_uint32(readargs->offset, out);
+    out = xdr_pack_uint32(readargs->count, out);
+
+    return xdr_pack_uint32(readargs->totalcount, out);
+}
+
+static Nfs__ReadArgs *unpack_read_args(XdrDecoder *decoder) {
+    Nfs__ReadArgs *readargs = xdr_alloc(decoder, sizeof(Nfs__ReadArgs));
+    if (readargs == NULL) {
+        return NULL;
+    }
+    nfs__read_args__init(readargs);
+
+    readargs->file = unpack_fhandle(decoder);
+    readargs->offset = xdr_unpack_uint32(decoder);
+    readargs->count = xdr_unpack_uint32(decoder);
+    readargs->totalcount = xdr_unpack_uint32(decoder);
+
+    return readargs;
+}
+
+/*
+ * ReadRes
+ */
+
+static size_t get_read_res_size(const Nfs__ReadRes *readres) {
+    if (!is_nfs_ok(readres->nfs_status)) {
+        return XDR_NFS_STAT_SIZE;
+    }
+
+    const Nfs__ReadResBody *readresbody =
+        readres->body_case == NFS__READ_RES__BODY_READRESBODY ? readres->readresbody : NULL;
+
+    return XDR_NFS_STAT_SIZE + XDR_FATTR_SIZE + xdr_opaque_size(readresbody == NULL ? 0 : readresbody->nfsdata.len);
+}
+
+static uint8_t *pack_read_res(const Nfs__ReadRes *readres, uint8_t *out) {
+    out = pack_nfs_stat(readres->nfs_status, out);
+    if (!is_nfs_ok(readres->nfs_status)) {
+        return out;
+    }
+
+    const Nfs__ReadResBody *readresbody =
+        readres->body_case == NFS__READ_RES__BODY_READRESBODY ? readres->readresbody : NULL;
+    if (readresbody == NULL) {
+        out = pack_fattr(NULL, out);
+        return xdr_pack_opaque(NULL, 0, out);
+    }
+
+    out = pack_fattr(readresbody->attributes, out);
+
+    return xdr_pack_opaque(readresbody->nfsdata.data, readresbody->nfsdata.len, out);
+}
+
+static Nfs__ReadRes *unpack_read_res(XdrDecoder *decoder) {
+    Nfs__ReadRes *readres = xdr_alloc(decoder, sizeof(Nfs__ReadRes));
+    if (readres == NULL) {
+        return NULL;
+    }
+    nfs__read_res__init(readres);
+
+    readres->nfs_status = unpack_nfs_stat(decoder);
+    if (readres->nfs_status == NULL || !is_nfs_ok(readres->nfs_status)) {
+        readres->body_case = NFS__READ_RES__BODY_DEFAULT_CASE;
+        readres->default_case = xdr_unpack_empty(decoder);
+
+        return readres;
+    }
+
+    readres->body_case = NFS__READ_RES__BODY_READRESBODY;
+    readres->readresbody = xdr_alloc(decoder, sizeof(Nfs__ReadResBody));
+    if (readres->readresbody != NULL) {
+        nfs__read_res_body__init(readres->readresbody);
+        readres->readresbody->attributes = unpack_fattr(decoder);
+        readres->readresbody->nfsdata = xdr_unpack_opaque(decoder, UINT32_MAX); // bounded by the record
+    }
+
+    return readres;
+}
+
+/*
+ * WriteArgs
+ */
+
+static size_t get_write_args_size(const Nfs__WriteArgs *writeargs) {
+    return XDR_FHANDLE_SIZE + 3 * 4 + xdr_opaque_size(writeargs->nfsdata.len);
+}
+
+static uint8_t *pack_write_args(const Nfs__WriteArgs *writeargs, uint8_t *out) {
+    out = pack_fhandle(writeargs->file, out);
+    out = xdr_pack_uint32(writeargs->beginoffset, out);
+    out = xdr_pack_uint32(writeargs->offset, out);
+    out = xdr_pack_uint32(writeargs->totalcount, out);
+
+    return xdr_pack_opaque(writeargs->nfsdata.data, writeargs->nfsdata.len, out);
+}
+
+static Nfs__WriteArgs *unpack_write_args(XdrDecoder *decoder) {
+    Nfs__WriteArgs *writeargs = xdr_alloc(decoder, sizeof(Nfs__WriteArgs));
+    if (writeargs == NULL) {
+        return NULL;
+    }
+    nfs__write_args__init(writeargs);
+
+    writeargs->file = unpack_fhandle(decoder);
+    writeargs->beginoffset = xdr_unpack_uint32(decoder);
+    writeargs->offset = xdr_unpack_uint32(decoder);
+    writeargs->totalcount = xdr_unpack_uint32(decoder);
+    writeargs->nfsdata = xdr_unpack_opaque(decoder, UINT32_MAX); // bounded by the record
+
+    return writeargs;
+}
+
+/*
+ * CreateArgs
+ */
+
+static size_t get_create_args_size(const Nfs__CreateArgs *createargs) {
+    return get_dir_op_args_size(createargs->where) + XDR_SATTR_SIZE;
+}
+
+static uint8_t *pack_create_args(const Nfs__CreateArgs *createargs, uint8_t *out) {
+    out = pack_dir_op_args(createargs->where, out);
+
+    return pack_sattr(createargs->attributes, out);
+}
+
+static Nfs__CreateArgs *unpack_create_args(XdrDecoder *decoder) {
+    Nfs__CreateArgs *createargs = xdr_alloc(decoder, sizeof(Nfs__CreateArgs));
+    if (createargs == NULL) {
+        return NULL;
+    }
+    nfs__create_args__init(createargs);
+
+    createargs->where = unpack_dir_op_args(decoder);
+    createargs->attributes = unpack_sattr(decoder);
+
+    return createargs;
+}
+
+/*
+ * RenameArgs
+ */
+
+static size_t get_rename_args_size(const Nfs__RenameArgs *renameargs) {
+    return get_dir_op_args_size(renameargs->from) + get_dir_op_args_size(renameargs->to);
+}
+
+static uint8_t *pack_rename_args(const Nfs__RenameArgs *renameargs, uint8_t *out) {
+    out = pack_dir_op_args(renameargs->from, out);
+
+    return pack_dir_op_args(renameargs->to, out);
+}
+
+static Nfs__RenameArgs *unpack_rename_args(XdrDecoder *decoder) {
+    Nfs__RenameArgs *renameargs = xdr_alloc(decoder, sizeof(Nfs__RenameArgs));
+    if (renameargs == NULL) {
+        return NULL;
+    }
+    nfs__rename_args__init(renameargs);
+
+    renameargs->from = unpack_dir_op_args(decoder);
+    renameargs->to = unpack_dir_op_args(decoder);
+
+    return renameargs;
+}
+
+/*
+ * LinkArgs
+ */
+
+static size_t get_link_args_size(const Nfs__LinkArgs *linkargs) {
+    return XDR_FHANDLE_SIZE + get_dir_op_args_size(linkargs->to);
+}
+
+static uint8_t *pack_link_args(const Nfs__LinkArgs *linkargs, uint8_t *out) {
+    out = pack_fhandle(linkargs->from, out);
+
+    return pack_dir_op_args(linkargs->to, out);
+}
+
+static Nfs__LinkArgs *unpack_link_args(XdrDecoder *decoder) {
+    Nfs__LinkArgs *linkargs = xdr_alloc(decoder, sizeof(Nfs__LinkArgs));
+    if (linkargs == NULL) {
+        return NULL;
+    }
+    nfs__link_args__init(linkargs);
+
+    linkargs->from = unpack_fhandle(decoder);
+    linkargs->to = unpack_dir_op_args(decoder);
+
+    return linkargs;
+}
+
+/*
+ * SymLinkArgs
+ */
+
+static size_t get_sym_link_args_size(const Nfs__SymLinkArgs *symlinkargs) {
+    return get_dir_op_args_size(symlinkargs->from) + get_path_size(symlinkargs->to) + XDR_SATTR_SIZE;
+}
+
+static uint8_t *pack_sym_link_args(const Nfs__SymLinkArgs *symlinkargs, uint8_t *out) {
+    out = pack_dir_op_args(symlinkargs->from, out);
+    out = pack_path(symlinkargs->to, out);
+
+    return pack_sattr(symlinkargs->attributes, out);
+}
+
+static Nfs__SymLinkArgs *unpack_sym_link_args(XdrDecoder *decoder) {
+    Nfs__SymLinkArgs *symlinkargs = xdr_alloc(decoder, sizeof(Nfs__SymLinkArgs));
+    if (symlinkargs == NULL) {
+        return NULL;
+    }
+    nfs__sym_link_args__init(symlinkargs);
+
+    symlinkargs->from = unpack_dir_op_args(decoder);
+    symlinkargs->to = unpack_path(decoder);
+    symlinkargs->attributes = unpack_sattr(decoder);
+
+    return symlinkargs;
+}
+
+/*
+ * NfsCookie
+ */
+
+static Nfs__NfsCookie *unpack_nfs_cookie(XdrDecoder *decoder) {
+    Nfs__NfsCookie *nfs_cookie = xdr_alloc(decoder, sizeof(Nfs__NfsCookie));
+    if (nfs_cookie == NULL) {
+        return NULL;
+    }
+    nfs__nfs_cookie__init(nfs_cookie);
+
+    nfs_cookie->value = xdr_unpack_uint64(decoder);
+
+    return nfs_cookie;
+}
+
+/*
+ * ReadDirArgs
+ */
+
+static size_t get_read_dir_args_size(const Nfs__ReadDirArgs *readdirargs) {
+    return XDR_FHANDLE_SIZE + XDR_NFS_COOKIE_SIZE + 4;
+}
+
+static uint8_t *pack_read_dir_args(const Nfs__ReadDirArgs *readdirargs, uint8_t *out) {
+    out = pack_fhandle(readdirargs->dir, out);
+    out = xdr_pack_uint64(readdirargs->cookie == NULL ? 0 : readdirargs->cookie->value, out);
+
+    return xdr_pack_uint32(readdirargs->count, out);
+}
+
+static Nfs__ReadDirArgs *unpack_read_dir_args(XdrDecoder *decoder) {
+    Nfs__ReadDirArgs *readdirargs = xdr_alloc(decoder, sizeof(Nfs__ReadDirArgs));
+    if (readdirargs == NULL) {
+        return NULL;
+    }
+    nfs__read_dir_args__init(readdirargs);
+
+    readdirargs->dir = unpack_fhandle(decoder);
+    readdirargs->cookie = unpack_nfs_cookie(decoder);
+    readdirargs->count = xdr_unpack_uint32(decoder);
+
+    return readdirargs;
+}
+
+/*
+ * DirectoryEntriesList - each entry is preceded by TRUE, and the list is terminated by FALSE.
+ */
+
+static size_t get_directory_entries_list_size(const Nfs__DirectoryEntriesList *entry) {
+    size_t size = 4;
+    for (; entry != NULL; entry = entry->nextentry) {
+        size += 4 + 8 + get_file_name_size(entry->name) + XDR_NFS_COOKIE_SIZE;
+    }
+
+    return size;
+}
+
+static uint8_t *pack_directory_entries_list(const Nfs__DirectoryEntriesList *entry, uint8_t *out) {
+    for (; entry != NULL; entry = entry->nextentry) {
+        out = xdr_pack_bool(true, out);
+        out = xdr_pack_uint64(entry->fileid, out);
+        out = pack_file_name(entry->name, out);
+        out = xdr_pack_uint64(entry->cookie == NULL ? 0 : entry->cookie->value, out);
+    }
+
+    return xdr_pack_bool(false, out);
+}
+
+/*
+ * Returns NULL for an empty list, as well as on failure.
+ */
+static Nfs__DirectoryEntriesList *unpack_directory_entries_list(XdrDecoder *decoder) {
+    Nfs__DirectoryEntriesList *head = NULL;
+    Nfs__DirectoryEntriesList **next_entry = &head;
+    while (xdr_unpack_bool(decoder)) {
+        Nfs__DirectoryEntriesList *entry = xdr_alloc(decoder, sizeof(Nfs__DirectoryEntriesList));
+        if (entry == NULL) {
+            break;
+        }
+        nfs__directory_entries_list__init(entry);
+
+        entry->fileid = xdr_unpack_uint64(decoder);
+        entry->name = unpack_file_name(decoder);
+        entry->cookie = unpack_nfs_cookie(decoder);
+
+        // linked in right away, so that the entries decoded so far are freed with the list if decoding fails
+        *next_entry = entry;
+        next_entry = &entry->nextentry;
+    }
+
+    return head;
+}
+
+/*
+ * ReadDirRes
+ */
+
+static size_t get_read_dir_res_size(const Nfs__ReadDirRes *readdirres) {
+    if (!is_nfs_ok(readdirres->nfs_status)) {
+        return XDR_NFS_STAT_SIZE;
+    }
+
+    const Nfs__ReadDirOk *readdirok =
+        readdirres->body_case == NFS__READ_DIR_RES__BODY_READDIROK ? readdirres->readdirok : NULL;
+
+    return XDR_NFS_STAT_SIZE + get_directory_entries_list_size(readdirok == NULL ? NULL : readdirok->entries) + 4;
+}
+
+static uint8_t *pack_read_dir_res(const Nfs__ReadDirRes *readdirres, uint8_t *out) {
+    out = pack_nfs_stat(readdirres->nfs_status, out);
+    if (!is_nfs_ok(readdirres->nfs_status)) {
+        return out;
+    }
+
+    const Nfs__ReadDirOk *readdirok =
+        readdirres->body_case == NFS__READ_DIR_RES__BODY_READDIROK ? readdirres->readdirok : NULL;
+    out = pack_directory_entries_list(readdirok == NULL ? NULL : readdirok->entries, out);
+
+    return xdr_pack_bool(readdirok == NULL ? true : readdirok->eof, out);
+}
+
+static Nfs__ReadDirRes *unpack_read_dir_res(XdrDecoder *decoder) {
+    Nfs__ReadDirRes *readdirres = xdr_alloc(decoder, sizeof(Nfs__ReadDirRes));
+    if (readdirres == NULL) {
+        return NULL;
+    }
+    nfs__read_dir_res__init(readdirres);
+
+    readdirres->nfs_status = unpack_nfs_stat(decoder);
+    if (readdirres->nfs_status == NULL || !is_nfs_ok(readdirres->nfs_status)) {
+        readdirres->body_case = NFS__READ_DIR_RES__BODY_DEFAULT_CASE;
+        readdirres->default_case = xdr_unpack_empty(decoder);
+
+        return readdirres;
+    }
+
+    readdirres->body_case = NFS__READ_DIR_RES__BODY_READDIROK;
+    readdirres->readdirok = xdr_alloc(decoder, sizeof(Nfs__ReadDirOk));
+    if (readdirres->readdirok != NULL) {
+        nfs__read_dir_ok__init(readdirres->readdirok);
+        readdirres->readdirok->entries = unpack_directory_entries_list(decoder);
+        readdirres->readdirok->eof = xdr_unpack_bool(decoder);
+    }
+
+    return readdirres;
+}
+
+/*
+ * StatFsRes
+ */
+
+static size_t get_stat_fs_res_size(const Nfs__StatFsRes *statfsres) {
+    return XDR_NFS_STAT_SIZE + (is_nfs_ok(statfsres->nfs_status) ? XDR_FS_INFO_SIZE : 0);
+}
+
+static uint8_t *pack_stat_fs_res(const Nfs__StatFsRes *statfsres, uint8_t *out) {
+    out = pack_nfs_stat(statfsres->nfs_status, out);
+    if (!is_nfs_ok(statfsres->nfs_status)) {
+        return out;
+    }
+
+    const Nfs__FsInfo *fs_info = statfsres->body_case == NFS__STAT_FS_RES__BODY_FS_INFO ? statfsres->fs_info : NULL;
+    if (fs_info == NULL) {
+        memset(out, 0, XDR_FS_INFO_SIZE);
+        return out + XDR_FS_INFO_SIZE;
+    }
+
+    out = xdr_pack_uint32(fs_info->tsize, out);
+    out = xdr_pack_uint64(fs_info->bsize, out);
+    out = xdr_pack_uint64(fs_info->blocks, out);
+    out = xdr_pack_uint64(fs_info->bfree, out);
+
+    return xdr_pack_uint64(fs_info->bavail, out);
+}
+
+static Nfs__StatFsRes *unpack_stat_fs_res(XdrDecoder *decoder) {
+    Nfs__StatFsRes *statfsres = xdr_alloc(decoder, sizeof(Nfs__StatFsRes));
+    if (statfsres == NULL) {
+        return NULL;
+    }
+    nfs__stat_fs_res__init(statfsres);
+
+    statfsres->nfs_status = unpack_nfs_stat(decoder);
+    if (statfsres->nfs_status == NULL || !is_nfs_ok(statfsres->nfs_status)) {
+        statfsres->body_case = NFS__STAT_FS_RES__BODY_DEFAULT_CASE;
+        statfsres->default_case = xdr_unpack_empty(decoder);
+
+        return statfsres;
+    }
+
+    statfsres->body_case = NFS__STAT_FS_RES__BODY_FS_INFO;
+    statfsres->fs_info = xdr_alloc(decoder, sizeof(Nfs__FsInfo));
+    if (statfsres->fs_info != NULL) {
+        nfs__fs_info__init(statfsres->fs_info);
+        statfsres->fs_info->tsize = xdr_unpack_uint32(decoder);
+        statfsres->fs_info->bsize = xdr_unpack_uint64(decoder);
+        statfsres->fs_info->blocks = xdr_unpack_uint64(decoder);
+        statfsres->fs_info->bfree = xdr_unpack_uint64(decoder);
+        statfsres->fs_info->bavail = xdr_unpack_uint64(decoder);
+    }
+
+    return statfsres;
+}
+
+/*
+ * CompoundArgs - the operations are a variable-length array, each one's parameters an opaque encoded with XDR.
+ */
+
+static size_t get_compound_op_size(const Nfs__CompoundOp *operation) {
+    return 4 + 4 + xdr_opaque_size(operation->parameters.len);
+}
+
+static size_t get_compound_args_size(const Nfs__CompoundArgs *compoundargs) {
+    size_t size = XDR_FHANDLE_SIZE + 4;
+    for (size_t i = 0; i < compoundargs->n_operations; i++) {
+        size += get_compound_op_size(compoundargs->operations[i]);
+    }
+
+    return size;
+}
+
+static uint8_t *pack_compound_args(const Nfs__CompoundArgs *compoundargs, uint8_t *out) {
+    out = pack_fhandle(compoundargs->fhandle, out);
+
+    out = xdr_pack_uint32(compoundargs->n_operations, out);
+    for (size_t i = 0; i < compoundargs->n_operations; i++) {
+        const Nfs__CompoundOp *operation = compoundargs->operations[i];
+        out = xdr_pack_uint32(operation->procedure, out);
+        out = xdr_pack_bool(operation->use_current_fhandle, out);
+        out = xdr_pack_opaque(operation->parameters.data, operation->parameters.len, out);
+    }
+
+    return out;
+}
+
+static Nfs__CompoundArgs *unpack_compound_args(XdrDecoder *decoder) {
+    Nfs__CompoundArgs *compoundargs = xdr_alloc(decoder, sizeof(Nfs__CompoundArgs));
+    if (compoundargs == NULL) {
+        return NULL;
+    }
+    nfs__compound_args__init(compoundargs);
+
+    compoundargs->fhandle = unpack_fhandle(decoder);
+
+    uint32_t num_operations = xdr_unpack_uint32(decoder);
+    if (num_operations > NFS_MAX_COMPOUND_OPERATIONS) {
+        decoder->failed = true;
+    }
+    if (num_operations == 0) {
+        return compoundargs;
+    }
+    compoundargs->operations = xdr_alloc(decoder, num_operations * sizeof(Nfs__CompoundOp *));
+    if (compoundargs->operations == NULL) {
+        return compoundargs;
+    }
+
+    for (uint32_t i = 0; i < num_operations; i++) {
+        Nfs__CompoundOp *operation = xdr_alloc(decoder, sizeof(Nfs__CompoundOp));
+        if (operation == NULL) {
+            break;
+        }
+        nfs__compound_op__init(operation);
+
+        // counted in right away, so that the operations decoded so far are freed with the array if decoding fails
+        compoundargs->operations[compoundargs->n_operations++] = operation;
+
+        operation->procedure = xdr_unpack_uint32(decoder);
+        operation->use_current_fhandle = xdr_unpack_bool(decoder);
+        operation->parameters = xdr_unpack_opaque(decoder, UINT32_MAX); // bounded by the record
+    }
+
+    return compoundargs;
+}
+
+/*
+ * CompoundRes - the results are a variable-length array, each one's procedure results an opaque encoded with XDR.
+ */
+
+static size_t get_compound_op_res_size(const Nfs__CompoundOpRes *operation_result) {
+    return 4 + XDR_NFS_STAT_SIZE + xdr_opaque_size(operation_result->results.len);
+}
+
+static size_t get_compound_res_size(const Nfs__CompoundRes *compoundres) {
+    size_t size = XDR_NFS_STAT_SIZE + 4;
+    for (size_t i = 0; i < compoundres->n_results; i++) {
+        size += get_compound_op_res_size(compoundres->results[i]);
+    }
+
+    return size;
+}
+
+static uint8_t *pack_compound_res(const Nfs__CompoundRes *compoundres, uint8_t *out) {
+    out = pack_nfs_stat(compoundres->nfs_status, out);
+
+    out = xdr_pack_uint32(compoundres->n_results, out);
+    for (size_t i = 0; i < compoundres->n_results; i++) {
+        const Nfs__CompoundOpRes *operation_result = compoundres->results[i];
+        out = xdr_pack_uint32(operation_result->procedure, out);
+        out = pack_nfs_stat(operation_result->nfs_status, out);
+        out = xdr_pack_opaque(operation_result->results.data, operation_result->results.len, out);
+    }
+
+    return out;
+}
+
+static Nfs__CompoundRes *unpack_compound_res(XdrDecoder *decoder) {
+    Nfs__CompoundRes *compoundres = xdr_alloc(decoder, sizeof(Nfs__CompoundRes));
+    if (compoundres == NULL) {
+        return NULL;
+    }
+    nfs__compound_res__init(compoundres);
+
+    compoundres->nfs_status = unpack_nfs_stat(decoder);
+
+    uint32_t num_results = xdr_unpack_uint32(decoder);
+    if (num_results > NFS_MAX_COMPOUND_OPERATIONS) {
+        decoder->failed = true;
+    }
+    if (num_results == 0) {
+        return compoundres;
+    }
+    compoundres->results = xdr_alloc(decoder, num_results * sizeof(Nfs__CompoundOpRes *));
+    if (compoundres->results == NULL) {
+        return compoundres;
+    }
+
+    for (uint32_t i = 0; i < num_results; i++) {
+        Nfs__CompoundOpRes *operation_result = xdr_alloc(decoder, sizeof(Nfs__CompoundOpRes));
+        if (operation_result == NULL) {
+            break;
+        }
+        nfs__compound_op_res__init(operation_result);
+
+        // counted in right away, so that the results decoded so far are freed with the array if decoding fails
+        compoundres->results[compoundres->n_results++] = operation_result;
+
+        operation_result->procedure = xdr_unpack_uint32(decoder);
+        operation_result->nfs_status = unpack_nfs_stat(decoder);
+        operation_result->results = xdr_unpack_opaque(decoder, UINT32_MAX); // bounded by the record
+    }
+
+    return compoundres;
+}
+
+/*
+ * DirectoryEntriesPlusList - as DirectoryEntriesList, with the filehandle and the attributes of each entry following
+ * its cookie, each of them preceded by TRUE if present and replaced by FALSE if not.
+ */
+
+static size_t get_directory_entries_plus_list_size(const Nfs__DirectoryEntriesPlusList *entry) {
+    size_t size = 4;
+    for (; entry != NULL; entry = entry->nextentry) {
+        size += 4 + 8 + get_file_name_size(entry->name) + XDR_NFS_COOKIE_SIZE;
+        size += 4 + (entry->file == NULL ? 0 : XDR_FHANDLE_SIZE);
+        size += 4 + (entry->attributes == NULL ? 0 : XDR_FATTR_SIZE);
+    }
+
+    return size;
+}
+
+static uint8_t *pack_directory_entries_plus_list(const Nfs__DirectoryEntriesPlusList *entry, uint8_t *out) {
+    for (; entry != NULL; entry = entry->nextentry) {
+        out = xdr_pack_bool(true, out);
+        out = xdr_pack_uint64(entry->fileid, out);
+        out = pack_file_name(entry->name, out);
+        out = xdr_pack_uint64(entry->cookie == NULL ? 0 : entry->cookie->value, out);
+
+        out = xdr_pack_bool(entry->file != NULL, out);
+        if (entry->file != NULL) {
+            out = pack_fhandle(entry->file, out);
+        }
+        out = xdr_pack_bool(entry->attributes != NULL, out);
+        if (entry->attributes != NULL) {
+            out = pack_fattr(entry->attributes, out);
+        }
+    }
+
+    return xdr_pack_bool(false, out);
+}
+
+/*
+ * Returns NULL for an empty list, as well as on failure.
+ */
+static Nfs__DirectoryEntriesPlusList *unpack_directory_entries_plus_list(XdrDecoder *decoder) {
+    Nfs__DirectoryEntriesPlusList *head = NULL;
+    Nfs__DirectoryEntriesPlusList **next_entry = &head;
+    while (xdr_unpack_bool(decoder)) {
+        Nfs__DirectoryEntriesPlusList *entry = xdr_alloc(decoder, sizeof(Nfs__DirectoryEntriesPlusList));
+        if (entry == NULL) {
+            break;
+        }
+        nfs__directory_entries_plus_list__init(entry);
+
+        // linked in right away, so that the entries decoded so far are freed with the list if decoding fails
+        *next_entry = entry;
+        next_entry = &entry->nextentry;
+
+        entry->fileid = xdr_unpack_uint64(decoder);
+        entry->name = unpack_file_name(decoder);
+        entry->cookie = unpack_nfs_cookie(decoder);
+        if (xdr_unpack_bool(decoder)) {
+            entry->file = unpack_fhandle(decoder);
+        }
+        if (xdr_unpack_bool(decoder)) {
+            entry->attributes = unpack_fattr(decoder);
+        }
+    }
+
+    return head;
+}
+
+/*
+ * ReadDirPlusRes
+ */
+
+static size_t get_read_dir_plus_res_size(const Nfs__ReadDirPlusRes *readdirplusres) {
+    if (!is_nfs_ok(readdirplusres->nfs_status)) {
+        return XDR_NFS_STAT_SIZE;
+    }
+
+    const Nfs__ReadDirPlusOk *readdirplusok = readdirplusres->body_case == NFS__READ_DIR_PLUS_RES__BODY_READDIRPLUSOK
+                                                  ? readdirplusres->readdirplusok
+                                                  : NULL;
+
+    return XDR_NFS_STAT_SIZE +
+           get_directory_entries_plus_list_size(readdirplusok == NULL ? NULL : readdirplusok->entries) + 4;
+}
+
+static uint8_t *pack_read_dir_plus_res(const Nfs__ReadDirPlusRes *readdirplusres, uint8_t *out) {
+    out = pack_nfs_stat(readdirplusres->nfs_status, out);
+    if (!is_nfs_ok(readdirplusres->nfs_status)) {
+        return out;
+    }
+
+    const Nfs__ReadDirPlusOk *readdirplusok = readdirplusres->body_case == NFS__READ_DIR_PLUS_RES__BODY_READDIRPLUSOK
+                                                  ? readdirplusres->readdirplusok
+                                                  : NULL;
+    out = pack_directory_entries_plus_list(readdirplusok == NULL ? NULL : readdirplusok->entries, out);
+
+    return xdr_pack_bool(readdirplusok == NULL ? true : readdirplusok->eof, out);
+}
+
+static Nfs__ReadDirPlusRes *unpack_read_dir_plus_res(XdrDecoder *decoder) {
+    Nfs__ReadDirPlusRes *readdirplusres = xdr_alloc(decoder, sizeof(Nfs__ReadDirPlusRes));
+    if (readdirplusres == NULL) {
+        return NULL;
+    }
+    nfs__read_dir_plus_res__init(readdirplusres);
+
+    readdirplusres->nfs_status = unpack_nfs_stat(decoder);
+    if (readdirplusres->nfs_status == NULL || !is_nfs_ok(readdirplusres->nfs_status)) {
+        readdirplusres->body_case = NFS__READ_DIR_PLUS_RES__BODY_DEFAULT_CASE;
+        readdirplusres->default_case = xdr_unpack_empty(decoder);
+
+        return readdirplusres;
+    }
+
+    readdirplusres->body_case = NFS__READ_DIR_PLUS_RES__BODY_READDIRPLUSOK;
+    readdirplusres->readdirplusok = xdr_alloc(decoder, sizeof(Nfs__ReadDirPlusOk));
+    if (readdirplusres->readdirplusok != NULL) {
+        nfs__read_dir_plus_ok__init(readdirplusres->readdirplusok);
+        readdirplusres->readdirplusok->entries = unpack_directory_entries_plus_list(decoder);
+        readdirplusres->readdirplusok->eof = xdr_unpack_bool(decoder);
+    }
+
+    return readdirplusres;
+}
+
+/*
+ * ReadDir2Res - the arrays of the flat ReadDir2Ok are sent as XDR variable-length arrays, and the names as an opaque.
+ */
+
+// number of elements of the given size a variable-length array read from the decoder can hold - anything larger than
+// the rest of the record makes the decoder fail before the array is allocated
+static uint32_t unpack_array_length(XdrDecoder *decoder, size_t element_size) {
+    uint32_t length = xdr_unpack_uint32(decoder);
+    if (decoder->failed || length > (decoder->size - decoder->offset) / element_size) {
+        decoder->failed = true;
+        return 0;
+    }
+
+    return length;
+}
+
+static size_t get_read_dir2_ok_size(const Nfs__ReadDir2Ok *readdir2ok) {
+    return 4 + 8 * readdir2ok->n_fileids + 4 + 8 * readdir2ok->n_cookies + 4 + 4 * readdir2ok->n_name_offsets +
+           xdr_opaque_size(readdir2ok->names.len) + 4;
+}
+
+static size_t get_read_dir2_res_size(const Nfs__ReadDir2Res *readdir2res) {
+    if (!is_nfs_ok(readdir2res->nfs_status)) {
+        return XDR_NFS_STAT_SIZE;
+    }
+
+    const Nfs__ReadDir2Ok *readdir2ok =
+        readdir2res->body_case == NFS__READ_DIR2_RES__BODY_READDIR2OK ? readdir2res->readdir2ok : NULL;
+    if (readdir2ok == NULL) {
+        return XDR_NFS_STAT_SIZE + 4 + 4 + 4 + xdr_opaque_size(0) + 4;
+    }
+
+    return XDR_NFS_STAT_SIZE + get_read_dir2_ok_size(readdir2ok);
+}
+
+static uint8_t *pack_read_dir2_res(const Nfs__ReadDir2Res *readdir2res, uint8_t *out) {
+    out = pack_nfs_stat(readdir2res->nfs_status, out);
+    if (!is_nfs_ok(readdir2res->nfs_status)) {
+        return out;
+    }
+
+    const Nfs__ReadDir2Ok *readdir2ok =
+        readdir2res->body_case == NFS__READ_DIR2_RES__BODY_READDIR2OK ? readdir2res->readdir2ok : NULL;
+    if (readdir2ok == NULL) {
+        out = xdr_pack_uint32(0, out);
+        out = xdr_pack_uint32(0, out);
+        out = xdr_pack_uint32(0, out);
+        out = xdr_pack_opaque(NULL, 0, out);
+        return xdr_pack_bool(true, out);
+    }
+
+    out = xdr_pack_uint32(readdir2ok->n_fileids, out);
+    for (size_t i = 0; i < readdir2ok->n_fileids; i++) {
+        out = xdr_pack_uint64(readdir2ok->fileids[i], out);
+    }
+    out = xdr_pack_uint32(readdir2ok->n_cookies, out);
+    for (size_t i = 0; i < readdir2ok->n_cookies; i++) {
+        out = xdr_pack_uint64(readdir2ok->cookies[i], out);
+    }
+    out = xdr_pack_uint32(readdir2ok->n_name_offsets, out);
+    for (size_t i = 0; i < readdir2ok->n_name_offsets; i++) {
+        out = xdr_pack_uint32(readdir2ok->name_offsets[i], out);
+    }
+    out = xdr_pack_opaque(readdir2ok->names.data, readdir2ok->names.len, out);
+
+    return xdr_pack_bool(readdir2ok->eof, out);
+}
+
+static Nfs__ReadDir2Ok *unpack_read_dir2_ok(XdrDecoder *decoder) {
+    Nfs__ReadDir2Ok *readdir2ok = xdr_alloc(decoder, sizeof(Nfs__ReadDir2Ok));
+    if (readdir2ok == NULL) {
+        return NULL;
+    }
+    nfs__read_dir2_ok__init(readdir2ok);
+
+    uint32_t n_fileids = unpack_array_length(decoder, 8);
+    if (n_fileids > 0 && (readdir2ok->fileids = xdr_alloc(decoder, n_fileids * sizeof(uint64_t))) != NULL) {
+        readdir2ok->n_fileids = n_fileids;
+        for (size_t i = 0; i < n_fileids; i++) {
+            readdir2ok->fileids[i] = xdr_unpack_uint64(decoder);
+        }
+    }
+
+    uint32_t n_cookies = unpack_array_length(decoder, 8);
+    if (n_cookies > 0 && (readdir2ok->cookies = xdr_alloc(decoder, n_cookies * sizeof(uint64_t))) != NULL) {
+        readdir2ok->n_cookies = n_cookies;
+        for (size_t i = 0; i < n_cookies; i++) {
+            readdir2ok->cookies[i] = xdr_unpack_uint64(decoder);
+        }
+    }
+
+    uint32_t n_name_offsets = unpack_array_length(decoder, 4);
+    if (n_name_offsets > 0 &&
+        (readdir2ok->name_offsets = xdr_alloc(decoder, n_name_offsets * sizeof(uint32_t))) != NULL) {
+        readdir2ok->n_name_offsets = n_name_offsets;
+        for (size_t i = 0; i < n_name_offsets; i++) {
+            readdir2ok->name_offsets[i] = xdr_unpack_uint32(decoder);
+        }
+    }
+
+    readdir2ok->names = xdr_unpack_opaque(decoder, UINT32_MAX); // bounded by the record
+    readdir2ok->eof = xdr_unpack_bool(decoder);
+
+    return readdir2ok;
+}
+
+static Nfs__ReadDir2Res *unpack_read_dir2_res(XdrDecoder *decoder) {
+    Nfs__ReadDir2Res *readdir2res = xdr_alloc(decoder, sizeof(Nfs__ReadDir2Res));
+    if (readdir2res == NULL) {
+        return NULL;
+    }
+    nfs__read_dir2_res__init(readdir2res);
+
+    readdir2res->nfs_status = unpack_nfs_stat(decoder);
+    if (readdir2res->nfs_status == NULL || !is_nfs_ok(readdir2res->nfs_status)) {
+        readdir2res->body_case = NFS__READ_DIR2_RES__BODY_DEFAULT_CASE;
+        readdir2res->default_case = xdr_unpack_empty(decoder);
+
+        return readdir2res;
+    }
+
+    readdir2res->body_case = NFS__READ_DIR2_RES__BODY_READDIR2OK;
+    readdir2res->readdir2ok = unpack_read_dir2_ok(decoder);
+
+    return readdir2res;
+}
+
+DEFINE_XDR_MESSAGE_CODEC(fhandle_codec, fhandle, Nfs__FHandle, nfs__fhandle__descriptor);
+DEFINE_XDR_MESSAGE_CODEC(attr_stat_codec, attr_stat, Nfs__AttrStat, nfs__attr_stat__descriptor);
+DEFINE_XDR_MESSAGE_CODEC(dir_op_args_codec, dir_op_args, Nfs__DirOpArgs, nfs__dir_op_args__descriptor);
+DEFINE_XDR_MESSAGE_CODEC(dir_op_res_codec, dir_op_res, Nfs__DirOpRes, nfs__dir_op_res__descriptor);
+DEFINE_XDR_MESSAGE_CODEC(nfs_stat_codec, nfs_stat, Nfs__NfsStat, nfs__nfs_stat__descriptor);
+DEFINE_XDR_MESSAGE_CODEC(read_args_codec, read_args, Nfs__ReadArgs, nfs__read_args__descriptor);
+DEFINE_XDR_MESSAGE_CODEC(read_res_codec, read_res, Nfs__ReadRes, nfs__read_res__descriptor);
+DEFINE_XDR_MESSAGE_CODEC(write_args_codec, write_args, Nfs__WriteArgs, nfs__write_args__descriptor);
+DEFINE_XDR_MESSAGE_CODEC(create_args_codec, create_args, Nfs__CreateArgs, nfs__create_args__descriptor);
+DEFINE_XDR_MESSAGE_CODEC(sattr_args_codec, sattr_args, Nfs__SAttrArgs, nfs__sattr_args__descriptor);
+DEFINE_XDR_MESSAGE_CODEC(read_link_res_codec, read_link_res, Nfs__ReadLinkRes, nfs__read_link_res__descriptor);
+DEFINE_XDR_MESSAGE_CODEC(rename_args_codec, rename_args, Nfs__RenameArgs, nfs__rename_args__descriptor);
+DEFINE_XDR_MESSAGE_CODEC(link_args_codec, link_args, Nfs__LinkArgs, nfs__link_args__descriptor);
+DEFINE_XDR_MESSAGE_CODEC(sym_link_args_codec, sym_link_args, Nfs__SymLinkArgs, nfs__sym_link_args__descriptor);
+DEFINE_XDR_MESSAGE_CODEC(read_dir_args_codec, read_dir_args, Nfs__ReadDirArgs, nfs__read_dir_args__descriptor);
+DEFINE_XDR_MESSAGE_CODEC(read_dir_res_codec, read_dir_res, Nfs__ReadDirRes, nfs__read_dir_res__descriptor);
+DEFINE_XDR_MESSAGE_CODEC(directory_entries_list_codec, directory_entries_list, Nfs__DirectoryEntriesList,
+                         nfs__directory_entries_list__descriptor);
+DEFINE_XDR_MESSAGE_CODEC(stat_fs_res_codec, stat_fs_res, Nfs__StatFsRes, nfs__stat_fs_res__descriptor);
+DEFINE_XDR_MESSAGE_CODEC(compound_args_codec, compound_args, Nfs__CompoundArgs, nfs__compound_args__descriptor);
+DEFINE_XDR_MESSAGE_CODEC(compound_res_codec, compound_res, Nfs__CompoundRes, nfs__compound_res__descriptor);
+DEFINE_XDR_MESSAGE_CODEC(read_dir_plus_res_codec, read_dir_plus_res, Nfs__ReadDirPlusRes,
+                         nfs__read_dir_plus_res__descriptor);
+DEFINE_XDR_MESSAGE_CODEC(directory_entries_plus_list_codec, directory_entries_plus_list, Nfs__DirectoryEntriesPlusList,
+                         nfs__directory_entries_plus_list__descriptor);
+DEFINE_XDR_MESSAGE_CODEC(read_dir2_res_codec, read_dir2_res, Nfs__ReadDir2Res, nfs__read_dir2_res__descriptor);
+
+// the most frequently sent types first, as codecs are looked up by a linear search
+const XdrMessageCodec *const nfs_xdr_message_codecs[] = {
+    &fhandle_codec,       &attr_stat_codec,     &dir_op_args_codec,   &dir_op_res_codec,
+    &nfs_stat_codec,      &read_args_codec,     &read_res_codec,      &write_args_codec,
+    &create_args_codec,   &sattr_args_codec,    &read_link_res_codec, &rename_args_codec,
+    &link_args_codec,     &sym_link_args_codec, &read_dir_args_codec, &read_dir_res_codec,
+    &directory_entries_list_codec, &stat_fs_res_codec, &compound_args_codec, &compound_res_codec,
+    &read_dir_plus_res_codec, &directory_entries_plus_list_codec, &read_dir2_res_codec,
+};
+const size_t num_nfs_xdr_message_codecs = sizeof(nfs_xdr_message_codecs) / sizeof(nfs_xdr_message_codecs[0]);
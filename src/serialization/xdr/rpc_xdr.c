@@ -0,0 +1,534 @@
+#include "xdr.h"
+
+/*
+ * XDR encoding of the RPC call and reply (RFC 5531, section 9).
+ *
+ * The procedure parameters of a call and the procedure results of a successful reply always come last, so
+ * everything in front of them (the header) can be encoded into the free bytes in front of an already encoded
+ * payload, and the payload of a received message can be used where it lies.
+ */
+
+#define XDR_MAX_MACHINE_NAME_LENGTH 255
+#define XDR_MAX_AUTH_SYS_GIDS 16
+
+/*
+ * Returns the already encoded procedure parameters or results carried by the given RpcMsg, or NULL if it carries
+ * none.
+ */
+static const ProtobufCBinaryData *get_xdr_rpc_msg_payload(const Rpc__RpcMsg *rpc_msg) {
+    if (rpc_msg->body_case == RPC__RPC_MSG__BODY_CBODY && rpc_msg->cbody != NULL) {
+        return rpc_msg->cbody->params == NULL ? NULL : &rpc_msg->cbody->params->value;
+    }
+
+    if (rpc_msg->body_case != RPC__RPC_MSG__BODY_RBODY || rpc_msg->rbody == NULL ||
+        rpc_msg->rbody->reply_case != RPC__REPLY_BODY__REPLY_AREPLY || rpc_msg->rbody->areply == NULL) {
+        return NULL;
+    }
+
+    const Rpc__AcceptedReply *accepted_reply = rpc_msg->rbody->areply;
+    if (accepted_reply->stat != RPC__ACCEPT_STAT__SUCCESS ||
+        accepted_reply->reply_data_case != RPC__ACCEPTED_REPLY__REPLY_DATA_RESULTS ||
+        accepted_reply->results == NULL) {
+        return NULL;
+    }
+
+    return &accepted_reply->results->value;
+}
+
+/*
+ * OpaqueAuth - the body of an AUTH_NONE is empty, the body of an AUTH_SHORT is the short handle itself, and the body
+ * of any other flavor than AUTH_SYS is not encoded.
+ */
+
+static size_t get_auth_sys_params_size(const Rpc__AuthSysParams *auth_sys) {
+    return 8 + xdr_string_size(auth_sys->machinename) + 4 + 4 + 4 + 4 * auth_sys->n_gids;
+}
+
+static size_t get_opaque_auth_size(const Rpc__OpaqueAuth *opaque_auth) {
+    size_t size = 4 + 4;
+    if (opaque_auth != NULL && opaque_auth->body_case == RPC__OPAQUE_AUTH__BODY_AUTH_SYS &&
+        opaque_auth->auth_sys != NULL) {
+        size += get_auth_sys_params_size(opaque_auth->auth_sys);
+    }
+    if (opaque_auth != NULL && opaque_auth->body_case == RPC__OPAQUE_AUTH__BODY_AUTH_SHORT) {
+        size += XDR_PADDED_SIZE(opaque_auth->auth_short.len);
+    }
+
+    return size;
+}
+
+static uint8_t *pack_opaque_auth(const Rpc__OpaqueAuth *opaque_auth, uint8_t *out) {
+    if (opaque_auth == NULL) {
+        out = xdr_pack_uint32(RPC__AUTH_FLAVOR__AUTH_NONE, out);
+        return xdr_pack_uint32(0, out);
+    }
+
+    out = xdr_pack_uint32(opaque_auth->flavor, out);
+    if (opaque_auth->body_case == RPC__OPAQUE_AUTH__BODY_AUTH_SHORT) {
+        return xdr_pack_opaque(opaque_auth->auth_short.data, opaque_auth->auth_short.len, out);
+    }
+    if (opaque_auth->body_case != RPC__OPAQUE_AUTH__BODY_AUTH_SYS || opaque_auth->auth_sys == NULL) {
+        return xdr_pack_uint32(0, out);
+    }
+
+    const Rpc__AuthSysParams *auth_sys = opaque_auth->auth_sys;
+    out = xdr_pack_uint32(get_auth_sys_params_size(auth_sys), out);
+    out = xdr_pack_uint64(auth_sys->timestamp, out);
+    out = xdr_pack_string(auth_sys->machinename, out);
+    out = xdr_pack_uint32(auth_sys->uid, out);
+    out = xdr_pack_uint32(auth_sys->gid, out);
+    out = xdr_pack_uint32(auth_sys->n_gids, out);
+    for (size_t i = 0; i < auth_sys->n_gids; i++) {
+        out = xdr_pack_uint32(auth_sys->gids[i], out);
+    }
+
+    return out;
+}
+
+static Rpc__AuthSysParams *unpack_auth_sys_params(XdrDecoder *decoder) {
+    Rpc__AuthSysParams *auth_sys = xdr_alloc(decoder, sizeof(Rpc__AuthSysParams));
+    if (auth_sys == NULL) {
+        return NULL;
+    }
+    rpc__auth_sys_params__init(auth_sys);
+
+    auth_sys->timestamp = xdr_unpack_uint64(decoder);
+    auth_sys->machinename = xdr_unpack_string(decoder, XDR_MAX_MACHINE_NAME_LENGTH);
+    auth_sys->uid = xdr_unpack_uint32(decoder);
+    auth_sys->gid = xdr_unpack_uint32(decoder);
+
+    uint32_t n_gids = xdr_unpack_uint32(decoder);
+    if (n_gids > XDR_MAX_AUTH_SYS_GIDS) {
+        decoder->failed = true;
+    }
+    if (n_gids == 0 || decoder->failed) {
+        return auth_sys;
+    }
+
+    auth_sys->gids = xdr_alloc(decoder, n_gids * sizeof(uint32_t));
+    if (auth_sys->gids == NULL) {
+        return auth_sys;
+    }
+    auth_sys->n_gids = n_gids;
+    for (size_t i = 0; i < n_gids; i++) {
+        auth_sys->gids[i] = xdr_unpack_uint32(decoder);
+    }
+
+    return auth_sys;
+}
+
+static ProtobufCBinaryData unpack_auth_short_body(XdrDecoder *decoder, uint32_t body_size) {
+    ProtobufCBinaryData auth_short = {0, NULL};
+
+    const uint8_t *bytes = xdr_read_bytes(decoder, XDR_PADDED_SIZE((size_t)body_size));
+    if (bytes == NULL || body_size == 0) {
+        return auth_short;
+    }
+
+    auth_short.data = xdr_alloc(decoder, body_size);
+    if (auth_short.data == NULL) {
+        return auth_short;
+    }
+    memcpy(auth_short.data, bytes, body_size);
+    auth_short.len = body_size;
+
+    return auth_short;
+}
+
+static Rpc__OpaqueAuth *unpack_opaque_auth(XdrDecoder *decoder) {
+    Rpc__OpaqueAuth *opaque_auth = xdr_alloc(decoder, sizeof(Rpc__OpaqueAuth));
+    if (opaque_auth == NULL) {
+        return NULL;
+    }
+    rpc__opaque_auth__init(opaque_auth);
+
+    opaque_auth->flavor = xdr_unpack_uint32(decoder);
+    uint32_t body_size = xdr_unpack_uint32(decoder);
+    if (body_size > XDR_MAX_AUTH_BYTES || decoder->failed) {
+        decoder->failed = true;
+        return opaque_auth;
+    }
+    size_t body_end = decoder->offset + XDR_PADDED_SIZE((size_t)body_size);
+
+    switch (opaque_auth->flavor) {
+    case RPC__AUTH_FLAVOR__AUTH_NONE:
+        opaque_auth->body_case = RPC__OPAQUE_AUTH__BODY_EMPTY;
+        opaque_auth->empty = xdr_unpack_empty(decoder);
+        break;
+    case RPC__AUTH_FLAVOR__AUTH_SYS:
+        opaque_auth->body_case = RPC__OPAQUE_AUTH__BODY_AUTH_SYS;
+        opaque_auth->auth_sys = unpack_auth_sys_params(decoder);
+        break;
+    case RPC__AUTH_FLAVOR__AUTH_SHORT:
+        opaque_auth->body_case = RPC__OPAQUE_AUTH__BODY_AUTH_SHORT;
+        opaque_auth->auth_short = unpack_auth_short_body(decoder, body_size);
+        break;
+    default:
+        break;
+    }
+
+    // the body must hold exactly what was decoded from it, and the rest of it is skipped
+    if (decoder->failed || decoder->offset > body_end) {
+        decoder->failed = true;
+        return opaque_auth;
+    }
+    xdr_read_bytes(decoder, body_end - decoder->offset);
+
+    return opaque_auth;
+}
+
+/*
+ * MismatchInfo
+ */
+
+static uint8_t *pack_mismatch_info(const Rpc__MismatchInfo *mismatch_info, uint8_t *out) {
+    out = xdr_pack_uint32(mismatch_info == NULL ? 0 : mismatch_info->low, out);
+
+    return xdr_pack_uint32(mismatch_info == NULL ? 0 : mismatch_info->high, out);
+}
+
+static Rpc__MismatchInfo *unpack_mismatch_info(XdrDecoder *decoder) {
+    Rpc__MismatchInfo *mismatch_info = xdr_alloc(decoder, sizeof(Rpc__MismatchInfo));
+    if (mismatch_info == NULL) {
+        return NULL;
+    }
+    rpc__mismatch_info__init(mismatch_info);
+
+    mismatch_info->low = xdr_unpack_uint32(decoder);
+    mismatch_info->high = xdr_unpack_uint32(decoder);
+
+    return mismatch_info;
+}
+
+/*
+ * Payload - the procedure parameters or results take up the rest of the message. Their type is not on the wire, so
+ * the type URL of the Any is filled in from the procedure being called.
+ */
+
+static Google__Protobuf__Any *unpack_payload(XdrDecoder *decoder, const char *type_url, bool copy_payload) {
+    Google__Protobuf__Any *payload = xdr_alloc(decoder, sizeof(Google__Protobuf__Any));
+    if (payload == NULL) {
+        return NULL;
+    }
+    google__protobuf__any__init(payload);
+
+    if (type_url != NULL) {
+        size_t type_url_length = strlen(type_url);
+        char *type_url_copy = xdr_alloc(decoder, type_url_length + 1);
+        if (type_url_copy != NULL) {
+            memcpy(type_url_copy, type_url, type_url_length + 1);
+            payload->type_url = type_url_copy;
+        }
+    }
+
+    size_t payload_size = decoder->size - decoder->offset;
+    const uint8_t *payload_data = xdr_read_bytes(decoder, payload_size);
+    if (payload_data == NULL || payload_size == 0) {
+        return payload;
+    }
+
+    if (!copy_payload) {
+        payload->value.data = (uint8_t *)payload_data;
+        payload->value.len = payload_size;
+
+        return payload;
+    }
+
+    payload->value.data = xdr_alloc(decoder, payload_size);
+    if (payload->value.data != NULL) {
+        memcpy(payload->value.data, payload_data, payload_size);
+        payload->value.len = payload_size;
+    }
+
+    return payload;
+}
+
+/*
+ * CallBody
+ */
+
+static size_t get_call_body_header_size(const Rpc__CallBody *call_body) {
+    return 4 * 4 + get_opaque_auth_size(call_body->credential) + get_opaque_auth_size(call_body->verifier);
+}
+
+static uint8_t *pack_call_body_header(const Rpc__CallBody *call_body, uint8_t *out) {
+    out = xdr_pack_uint32(call_body->rpcvers, out);
+    out = xdr_pack_uint32(call_body->prog, out);
+    out = xdr_pack_uint32(call_body->vers, out);
+    out = xdr_pack_uint32(call_body->proc, out);
+    out = pack_opaque_auth(call_body->credential, out);
+
+    return pack_opaque_auth(call_body->verifier, out);
+}
+
+static Rpc__CallBody *unpack_call_body(XdrDecoder *decoder, bool copy_payload) {
+    Rpc__CallBody *call_body = xdr_alloc(decoder, sizeof(Rpc__CallBody));
+    if (call_body == NULL) {
+        return NULL;
+    }
+    rpc__call_body__init(call_body);
+
+    call_body->rpcvers = xdr_unpack_uint32(decoder);
+    call_body->prog = xdr_unpack_uint32(decoder);
+    call_body->vers = xdr_unpack_uint32(decoder);
+    call_body->proc = xdr_unpack_uint32(decoder);
+    call_body->credential = unpack_opaque_auth(decoder);
+    call_body->verifier = unpack_opaque_auth(decoder);
+
+    const char *parameters_type = get_xdr_procedure_parameters_type(call_body->prog, call_body->vers, call_body->proc);
+    call_body->params = unpack_payload(decoder, parameters_type, copy_payload);
+
+    return call_body;
+}
+
+/*
+ * ReplyBody
+ */
+
+static size_t get_reply_body_header_size(const Rpc__ReplyBody *reply_body) {
+    if (reply_body->reply_case == RPC__REPLY_BODY__REPLY_AREPLY && reply_body->areply != NULL) {
+        const Rpc__AcceptedReply *accepted_reply = reply_body->areply;
+
+        size_t size = 4 + get_opaque_auth_size(accepted_reply->verifier) + 4;
+        return accepted_reply->stat == RPC__ACCEPT_STAT__PROG_MISMATCH ? size + 2 * 4 : size;
+    }
+
+    if (reply_body->reply_case == RPC__REPLY_BODY__REPLY_RREPLY && reply_body->rreply != NULL) {
+        return reply_body->rreply->stat == RPC__REJECT_STAT__RPC_MISMATCH ? 4 + 4 + 2 * 4 : 4 + 4 + 4;
+    }
+
+    return 4;
+}
+
+static uint8_t *pack_reply_body_header(const Rpc__ReplyBody *reply_body, uint8_t *out) {
+    if (reply_body->reply_case == RPC__REPLY_BODY__REPLY_AREPLY && reply_body->areply != NULL) {
+        const Rpc__AcceptedReply *accepted_reply = reply_body->areply;
+
+        out = xdr_pack_uint32(RPC__REPLY_STAT__MSG_ACCEPTED, out);
+        out = pack_opaque_auth(accepted_reply->verifier, out);
+        out = xdr_pack_uint32(accepted_reply->stat, out);
+        if (accepted_reply->stat != RPC__ACCEPT_STAT__PROG_MISMATCH) {
+            return out;
+        }
+
+        return pack_mismatch_info(accepted_reply->reply_data_case == RPC__ACCEPTED_REPLY__REPLY_DATA_MISMATCH_INFO
+                                      ? accepted_reply->mismatch_info
+                                      : NULL,
+                                  out);
+    }
+
+    if (reply_body->reply_case == RPC__REPLY_BODY__REPLY_RREPLY && reply_body->rreply != NULL) {
+        const Rpc__RejectedReply *rejected_reply = reply_body->rreply;
+
+        out = xdr_pack_uint32(RPC__REPLY_STAT__MSG_DENIED, out);
+        out = xdr_pack_uint32(rejected_reply->stat, out);
+        if (rejected_reply->stat != RPC__REJECT_STAT__RPC_MISMATCH) {
+            return xdr_pack_uint32(rejected_reply->reply_data_case == RPC__REJECTED_REPLY__REPLY_DATA_AUTH_STAT
+                                       ? rejected_reply->auth_stat
+                                       : RPC__AUTH_STAT__AUTH_FAILED,
+                                   out);
+        }
+
+        return pack_mismatch_info(rejected_reply->reply_data_case == RPC__REJECTED_REPLY__REPLY_DATA_MISMATCH_INFO
+                                      ? rejected_reply->mismatch_info
+                                      : NULL,
+                                  out);
+    }
+
+    return xdr_pack_uint32(reply_body->stat, out);
+}
+
+static Rpc__AcceptedReply *unpack_accepted_reply(XdrDecoder *decoder, const Rpc__CallBody *replied_call_body,
+                                                 bool copy_payload) {
+    Rpc__AcceptedReply *accepted_reply = xdr_alloc(decoder, sizeof(Rpc__AcceptedReply));
+    if (accepted_reply == NULL) {
+        return NULL;
+    }
+    rpc__accepted_reply__init(accepted_reply);
+
+    accepted_reply->verifier = unpack_opaque_auth(decoder);
+    accepted_reply->stat = xdr_unpack_uint32(decoder);
+
+    switch (accepted_reply->stat) {
+    case RPC__ACCEPT_STAT__SUCCESS:
+        accepted_reply->reply_data_case = RPC__ACCEPTED_REPLY__REPLY_DATA_RESULTS;
+        accepted_reply->results = unpack_payload(
+            decoder,
+            replied_call_body == NULL ? NULL
+                                      : get_xdr_procedure_results_type(replied_call_body->prog, replied_call_body->vers,
+                                                                       replied_call_body->proc),
+            copy_payload);
+        break;
+    case RPC__ACCEPT_STAT__PROG_MISMATCH:
+        accepted_reply->reply_data_case = RPC__ACCEPTED_REPLY__REPLY_DATA_MISMATCH_INFO;
+        accepted_reply->mismatch_info = unpack_mismatch_info(decoder);
+        break;
+    default:
+        accepted_reply->reply_data_case = RPC__ACCEPTED_REPLY__REPLY_DATA_DEFAULT_CASE;
+        accepted_reply->default_case = xdr_unpack_empty(decoder);
+    }
+
+    return accepted_reply;
+}
+
+static Rpc__RejectedReply *unpack_rejected_reply(XdrDecoder *decoder) {
+    Rpc__RejectedReply *rejected_reply = xdr_alloc(decoder, sizeof(Rpc__RejectedReply));
+    if (rejected_reply == NULL) {
+        return NULL;
+    }
+    rpc__rejected_reply__init(rejected_reply);
+
+    rejected_reply->stat = xdr_unpack_uint32(decoder);
+
+    switch (rejected_reply->stat) {
+    case RPC__REJECT_STAT__RPC_MISMATCH:
+        rejected_reply->reply_data_case = RPC__REJECTED_REPLY__REPLY_DATA_MISMATCH_INFO;
+        rejected_reply->mismatch_info = unpack_mismatch_info(decoder);
+        break;
+    case RPC__REJECT_STAT__AUTH_ERROR:
+        rejected_reply->reply_data_case = RPC__REJECTED_REPLY__REPLY_DATA_AUTH_STAT;
+        rejected_reply->auth_stat = xdr_unpack_uint32(decoder);
+        break;
+    default:
+        decoder->failed = true;
+    }
+
+    return rejected_reply;
+}
+
+static Rpc__ReplyBody *unpack_reply_body(XdrDecoder *decoder, const Rpc__CallBody *replied_call_body,
+                                         bool copy_payload) {
+    Rpc__ReplyBody *reply_body = xdr_alloc(decoder, sizeof(Rpc__ReplyBody));
+    if (reply_body == NULL) {
+        return NULL;
+    }
+    rpc__reply_body__init(reply_body);
+
+    reply_body->stat = xdr_unpack_uint32(decoder);
+
+    switch (reply_body->stat) {
+    case RPC__REPLY_STAT__MSG_ACCEPTED:
+        reply_body->reply_case = RPC__REPLY_BODY__REPLY_AREPLY;
+        reply_body->areply = unpack_accepted_reply(decoder, replied_call_body, copy_payload);
+        break;
+    case RPC__REPLY_STAT__MSG_DENIED:
+        reply_body->reply_case = RPC__REPLY_BODY__REPLY_RREPLY;
+        reply_body->rreply = unpack_rejected_reply(decoder);
+        break;
+    default:
+        decoder->failed = true;
+    }
+
+    return reply_body;
+}
+
+/*
+ * RpcMsg
+ */
+
+/*
+ * Returns the size of the given RpcMsg once XDR encoded, leaving out the procedure parameters or results it carries.
+ */
+size_t get_xdr_rpc_msg_header_size(const Rpc__RpcMsg *rpc_msg) {
+    size_t size = 4 + 4;
+    if (rpc_msg->body_case == RPC__RPC_MSG__BODY_CBODY && rpc_msg->cbody != NULL) {
+        size += get_call_body_header_size(rpc_msg->cbody);
+    } else if (rpc_msg->body_case == RPC__RPC_MSG__BODY_RBODY && rpc_msg->rbody != NULL) {
+        size += get_reply_body_header_size(rpc_msg->rbody);
+    }
+
+    return size;
+}
+
+/*
+ * XDR encodes the given RpcMsg into 'out', leaving out the procedure parameters or results it carries, which are
+ * to follow right after it. 'out' must have room for 'get_xdr_rpc_msg_header_size' bytes.
+ *
+ * Returns the position right after the encoded header.
+ */
+uint8_t *pack_xdr_rpc_msg_header(const Rpc__RpcMsg *rpc_msg, uint8_t *out) {
+    out = xdr_pack_uint32(rpc_msg->xid, out);
+
+    if (rpc_msg->body_case == RPC__RPC_MSG__BODY_CBODY && rpc_msg->cbody != NULL) {
+        out = xdr_pack_uint32(RPC__MSG_TYPE__CALL, out);
+        return pack_call_body_header(rpc_msg->cbody, out);
+    }
+
+    if (rpc_msg->body_case == RPC__RPC_MSG__BODY_RBODY && rpc_msg->rbody != NULL) {
+        out = xdr_pack_uint32(RPC__MSG_TYPE__REPLY, out);
+        return pack_reply_body_header(rpc_msg->rbody, out);
+    }
+
+    return xdr_pack_uint32(rpc_msg->mtype, out);
+}
+
+/*
+ * Returns the size of the given RpcMsg once XDR encoded.
+ */
+size_t get_xdr_rpc_msg_packed_size(const Rpc__RpcMsg *rpc_msg) {
+    const ProtobufCBinaryData *payload = get_xdr_rpc_msg_payload(rpc_msg);
+
+    return get_xdr_rpc_msg_header_size(rpc_msg) + (payload == NULL ? 0 : payload->len);
+}
+
+/*
+ * XDR encodes the given RpcMsg into 'out', which must have room for 'get_xdr_rpc_msg_packed_size' bytes.
+ *
+ * Returns the number of bytes written.
+ */
+size_t pack_xdr_rpc_msg(const Rpc__RpcMsg *rpc_msg, uint8_t *out) {
+    uint8_t *end = pack_xdr_rpc_msg_header(rpc_msg, out);
+
+    const ProtobufCBinaryData *payload = get_xdr_rpc_msg_payload(rpc_msg);
+    if (payload != NULL && payload->len > 0) {
+        memcpy(end, payload->data, payload->len);
+        end += payload->len;
+    }
+
+    return end - out;
+}
+
+/*
+ * Decodes the XDR encoded RpcMsg in data[0, len). The type URL of the procedure results in a reply is taken from
+ * the given call it replies to, and is left empty if that's NULL. If 'copy_payload' is false, the value of the Any
+ * carrying the procedure parameters or results is left pointing into the given data.
+ *
+ * Returns NULL if decoding was unsuccessful.
+ *
+ * The user of this function takes the responsibility to free the RpcMsg with 'rpc__rpc_msg__free_unpacked', given
+ * the same allocator, after clearing the value of the Any if it points into the given data.
+ */
+Rpc__RpcMsg *unpack_xdr_rpc_msg(ProtobufCAllocator *allocator, size_t len, const uint8_t *data,
+                                const Rpc__CallBody *replied_call_body, bool copy_payload) {
+    XdrDecoder decoder = {.data = data, .size = len, .offset = 0, .allocator = allocator, .failed = false};
+
+    Rpc__RpcMsg *rpc_msg = xdr_alloc(&decoder, sizeof(Rpc__RpcMsg));
+    if (rpc_msg == NULL) {
+        return NULL;
+    }
+    rpc__rpc_msg__init(rpc_msg);
+
+    rpc_msg->xid = xdr_unpack_uint32(&decoder);
+    rpc_msg->mtype = xdr_unpack_uint32(&decoder);
+
+    switch (rpc_msg->mtype) {
+    case RPC__MSG_TYPE__CALL:
+        rpc_msg->body_case = RPC__RPC_MSG__BODY_CBODY;
+        rpc_msg->cbody = unpack_call_body(&decoder, copy_payload);
+        break;
+    case RPC__MSG_TYPE__REPLY:
+        rpc_msg->body_case = RPC__RPC_MSG__BODY_RBODY;
+        rpc_msg->rbody = unpack_reply_body(&decoder, replied_call_body, copy_payload);
+        break;
+    default:
+        decoder.failed = true;
+    }
+
+    // the payload is decoded last and never fails in place, so a failed RpcMsg never points into the given data
+    if (decoder.failed || decoder.offset != decoder.size) {
+        rpc__rpc_msg__free_unpacked(rpc_msg, allocator);
+        return NULL;
+    }
+
+    return rpc_msg;
+}
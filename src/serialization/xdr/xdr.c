@@ -0,0 +1,266 @@
+#include "xdr.h"
+
+#include "src/nfs/nfs_common.h"
+
+/*
+ * Allocates 'size' bytes with the allocator of the given decoder.
+ *
+ * Returns NULL, and marks the decoder as failed, on failure or if the decoder has already failed.
+ */
+void *xdr_alloc(XdrDecoder *decoder, size_t size) {
+    if (decoder->failed) {
+        return NULL;
+    }
+
+    void *pointer = decoder->allocator == NULL ? malloc(size)
+                                               : decoder->allocator->alloc(decoder->allocator->allocator_data, size);
+    if (pointer == NULL) {
+        fprintf(stderr, "xdr_alloc: failed to allocate memory\n");
+        decoder->failed = true;
+    }
+
+    return pointer;
+}
+
+/*
+ * Decodes a string of at most 'max_length' bytes into a new null-terminated copy.
+ *
+ * Returns the protobuf-c empty string (which '*__free_unpacked' leaves alone) if decoding fails.
+ */
+char *xdr_unpack_string(XdrDecoder *decoder, size_t max_length) {
+    uint32_t length = xdr_unpack_uint32(decoder);
+    if (length > max_length) {
+        decoder->failed = true;
+    }
+
+    const uint8_t *bytes = xdr_read_bytes(decoder, XDR_PADDED_SIZE((size_t)length));
+    char *string = xdr_alloc(decoder, (size_t)length + 1);
+    if (bytes == NULL || string == NULL) {
+        return (char *)protobuf_c_empty_string;
+    }
+    memcpy(string, bytes, length);
+    string[length] = '\0';
+
+    return string;
+}
+
+/*
+ * Decodes a variable-length opaque of at most 'max_size' bytes into a new copy.
+ *
+ * Returns an empty ProtobufCBinaryData if the opaque is empty or decoding fails.
+ */
+ProtobufCBinaryData xdr_unpack_opaque(XdrDecoder *decoder, size_t max_size) {
+    ProtobufCBinaryData opaque = {0, NULL};
+
+    uint32_t size = xdr_unpack_uint32(decoder);
+    if (size > max_size) {
+        decoder->failed = true;
+    }
+
+    const uint8_t *bytes = xdr_read_bytes(decoder, XDR_PADDED_SIZE((size_t)size));
+    if (bytes == NULL || size == 0) {
+        return opaque;
+    }
+
+    opaque.data = xdr_alloc(decoder, size);
+    if (opaque.data == NULL) {
+        return opaque;
+    }
+    memcpy(opaque.data, bytes, size);
+    opaque.len = size;
+
+    return opaque;
+}
+
+/*
+ * Allocates the Empty message that the protobuf codec places in the void arms of unions - nothing is read.
+ */
+Google__Protobuf__Empty *xdr_unpack_empty(XdrDecoder *decoder) {
+    Google__Protobuf__Empty *empty = xdr_alloc(decoder, sizeof(Google__Protobuf__Empty));
+    if (empty == NULL) {
+        return NULL;
+    }
+    google__protobuf__empty__init(empty);
+
+    return empty;
+}
+
+/*
+ * Encodes the given NfsFileHandle as the fixed size opaque filehandle of RFC 1094 - the inode number and the
+ * timestamp, followed by zeros. A NULL NfsFileHandle is encoded as all zeros.
+ */
+uint8_t *xdr_pack_nfs_filehandle(const NfsFh__NfsFileHandle *nfs_filehandle, uint8_t *out) {
+    uint8_t *end = out + XDR_FHANDLE_SIZE;
+
+    out = xdr_pack_uint64(nfs_filehandle == NULL ? 0 : nfs_filehandle->inode_number, out);
+    out = xdr_pack_uint64(nfs_filehandle == NULL ? 0 : nfs_filehandle->timestamp, out);
+    memset(out, 0, end - out);
+
+    return end;
+}
+
+NfsFh__NfsFileHandle *xdr_unpack_nfs_filehandle(XdrDecoder *decoder) {
+    NfsFh__NfsFileHandle *nfs_filehandle = xdr_alloc(decoder, sizeof(NfsFh__NfsFileHandle));
+    if (nfs_filehandle == NULL) {
+        return NULL;
+    }
+    nfs_fh__nfs_file_handle__init(nfs_filehandle);
+
+    nfs_filehandle->inode_number = xdr_unpack_uint64(decoder);
+    nfs_filehandle->timestamp = xdr_unpack_uint64(decoder);
+    xdr_read_bytes(decoder, XDR_FHANDLE_SIZE - 2 * sizeof(uint64_t)); // unused
+
+    return nfs_filehandle;
+}
+
+/*
+ * Types of the parameters and results of every procedure, which an XDR message does not carry.
+ */
+typedef struct XdrProcedureTypes {
+    uint32_t program_number;
+    uint32_t program_version;
+    uint32_t procedure_number;
+
+    const char *parameters_type;
+    const char *results_type;
+} XdrProcedureTypes;
+
+static const XdrProcedureTypes xdr_procedure_types[] = {
+    {NFS_RPC_PROGRAM_NUMBER, 2, 0, "nfs/None", "nfs/None"},
+    {NFS_RPC_PROGRAM_NUMBER, 2, 1, "nfs/FHandle", "nfs/AttrStat"},
+    {NFS_RPC_PROGRAM_NUMBER, 2, 2, "nfs/SAttrArgs", "nfs/AttrStat"},
+    {NFS_RPC_PROGRAM_NUMBER, 2, 4, "nfs/DirOpArgs", "nfs/DirOpRes"},
+    {NFS_RPC_PROGRAM_NUMBER, 2, 5, "nfs/FHandle", "nfs/ReadLinkRes"},
+    {NFS_RPC_PROGRAM_NUMBER, 2, 6, "nfs/ReadArgs", "nfs/ReadRes"},
+    {NFS_RPC_PROGRAM_NUMBER, 2, 8, "nfs/WriteArgs", "nfs/AttrStat"},
+    {NFS_RPC_PROGRAM_NUMBER, 2, 9, "nfs/CreateArgs", "nfs/DirOpRes"},
+    {NFS_RPC_PROGRAM_NUMBER, 2, 10, "nfs/DirOpArgs", "nfs/NfsStat"},
+    {NFS_RPC_PROGRAM_NUMBER, 2, 11, "nfs/RenameArgs", "nfs/NfsStat"},
+    {NFS_RPC_PROGRAM_NUMBER, 2, 12, "nfs/LinkArgs", "nfs/NfsStat"},
+    {NFS_RPC_PROGRAM_NUMBER, 2, 13, "nfs/SymLinkArgs", "nfs/NfsStat"},
+    {NFS_RPC_PROGRAM_NUMBER, 2, 14, "nfs/CreateArgs", "nfs/DirOpRes"},
+    {NFS_RPC_PROGRAM_NUMBER, 2, 15, "nfs/DirOpArgs", "nfs/NfsStat"},
+    {NFS_RPC_PROGRAM_NUMBER, 2, 16, "nfs/ReadDirArgs", "nfs/ReadDirRes"},
+    {NFS_RPC_PROGRAM_NUMBER, 2, 17, "nfs/FHandle", "nfs/StatFsRes"},
+    {NFS_RPC_PROGRAM_NUMBER, 2, 18, "nfs/CompoundArgs", "nfs/CompoundRes"},
+    {NFS_RPC_PROGRAM_NUMBER, 2, 19, "nfs/ReadDirArgs", "nfs/ReadDirPlusRes"},
+    {NFS_RPC_PROGRAM_NUMBER, 2, 20, "nfs/ReadDirArgs", "nfs/ReadDir2Res"},
+    {MOUNT_RPC_PROGRAM_NUMBER, 2, 0, "mount/None", "mount/None"},
+    {MOUNT_RPC_PROGRAM_NUMBER, 2, 1, "mount/DirPath", "mount/FhStatus"},
+};
+
+static const XdrProcedureTypes *find_xdr_procedure_types(uint32_t program_number, uint32_t program_version,
+                                                         uint32_t procedure_number) {
+    for (size_t i = 0; i < sizeof(xdr_procedure_types) / sizeof(xdr_procedure_types[0]); i++) {
+        const XdrProcedureTypes *procedure_types = &xdr_procedure_types[i];
+        if (procedure_types->program_number == program_number &&
+            procedure_types->program_version == program_version &&
+            procedure_types->procedure_number == procedure_number) {
+            return procedure_types;
+        }
+    }
+
+    return NULL;
+}
+
+/*
+ * Returns the type URL of the parameters of the given procedure, or NULL if the procedure is unknown.
+ */
+const char *get_xdr_procedure_parameters_type(uint32_t program_number, uint32_t program_version,
+                                              uint32_t procedure_number) {
+    const XdrProcedureTypes *procedure_types =
+        find_xdr_procedure_types(program_number, program_version, procedure_number);
+
+    return procedure_types == NULL ? NULL : procedure_types->parameters_type;
+}
+
+/*
+ * Returns the type URL of the results of the given procedure, or NULL if the procedure is unknown.
+ */
+const char *get_xdr_procedure_results_type(uint32_t program_number, uint32_t program_version,
+                                           uint32_t procedure_number) {
+    const XdrProcedureTypes *procedure_types =
+        find_xdr_procedure_types(program_number, program_version, procedure_number);
+
+    return procedure_types == NULL ? NULL : procedure_types->results_type;
+}
+
+/*
+ * Returns the XDR encoding of messages with the given descriptor, or NULL if they are never sent as procedure
+ * parameters or results.
+ */
+static const XdrMessageCodec *find_xdr_message_codec(const ProtobufCMessageDescriptor *descriptor) {
+    for (size_t i = 0; i < num_nfs_xdr_message_codecs; i++) {
+        if (nfs_xdr_message_codecs[i]->descriptor == descriptor) {
+            return nfs_xdr_message_codecs[i];
+        }
+    }
+
+    for (size_t i = 0; i < num_mount_xdr_message_codecs; i++) {
+        if (mount_xdr_message_codecs[i]->descriptor == descriptor) {
+            return mount_xdr_message_codecs[i];
+        }
+    }
+
+    return NULL;
+}
+
+/*
+ * Returns the size of the given procedure parameters or results once XDR encoded, or 0 if their type has no XDR
+ * encoding.
+ */
+size_t get_xdr_message_packed_size(const ProtobufCMessage *message) {
+    const XdrMessageCodec *codec = find_xdr_message_codec(message->descriptor);
+    if (codec == NULL) {
+        fprintf(stderr, "get_xdr_message_packed_size: no XDR encoding for %s\n", message->descriptor->name);
+        return 0;
+    }
+
+    return codec->get_packed_size(message);
+}
+
+/*
+ * XDR encodes the given procedure parameters or results into 'out', which must have room for
+ * 'get_xdr_message_packed_size' bytes.
+ *
+ * Returns the number of bytes written, or 0 if their type has no XDR encoding.
+ */
+size_t pack_xdr_message(const ProtobufCMessage *message, uint8_t *out) {
+    const XdrMessageCodec *codec = find_xdr_message_codec(message->descriptor);
+    if (codec == NULL) {
+        fprintf(stderr, "pack_xdr_message: no XDR encoding for %s\n", message->descriptor->name);
+        return 0;
+    }
+
+    return codec->pack(message, out) - out;
+}
+
+/*
+ * Decodes the XDR encoded procedure parameters or results of the given type in data[0, len).
+ *
+ * Returns NULL if decoding was unsuccessful, or if not all of the given bytes belong to the message.
+ *
+ * The user of this function takes the responsibility to free the message with the '*__free_unpacked' function of
+ * its type, given the same allocator.
+ */
+ProtobufCMessage *unpack_xdr_message(const ProtobufCMessageDescriptor *descriptor, ProtobufCAllocator *allocator,
+                                     size_t len, const uint8_t *data) {
+    const XdrMessageCodec *codec = find_xdr_message_codec(descriptor);
+    if (codec == NULL) {
+        fprintf(stderr, "unpack_xdr_message: no XDR encoding for %s\n", descriptor->name);
+        return NULL;
+    }
+
+    XdrDecoder decoder = {.data = data, .size = len, .offset = 0, .allocator = allocator, .failed = false};
+
+    ProtobufCMessage *message = codec->unpack(&decoder);
+    if (decoder.failed || decoder.offset != decoder.size) {
+        if (message != NULL) {
+            protobuf_c_message_free_unpacked(message, allocator);
+        }
+
+        return NULL;
+    }
+
+    return message;
+}
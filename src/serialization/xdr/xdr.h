@@ -0,0 +1,242 @@
+#ifndef xdr__header__INCLUDED
+#define xdr__header__INCLUDED
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <protobuf-c/protobuf-c.h>
+
+#include "src/serialization/google_protos/any.pb-c.h"
+#include "src/serialization/google_protos/empty.pb-c.h"
+#include "src/serialization/mount/mount.pb-c.h"
+#include "src/serialization/nfs/nfs.pb-c.h"
+#include "src/serialization/nfs_fh/nfs_fh.pb-c.h"
+#include "src/serialization/rpc/rpc.pb-c.h"
+
+/*
+ * Hand-written XDR (RFC 4506) encoding of the RPC, Nfs and Mount messages, an alternative wire format to protobuf.
+ *
+ * Messages are laid out as in RFC 5531 (the RPC call and reply) and RFC 1094 (the Nfs and Mount procedure
+ * parameters and results): every field is big-endian and takes a multiple of 4 bytes, unions are discriminated by
+ * the status field in front of them, and linked lists are chains of optional entries. Fields that the .proto files
+ * widen to 64 bits (file sizes, fileids, timestamps, cookies) are sent as XDR hypers rather than cut down to the 32
+ * bits of RFC 1094. Nothing on the wire names the type of the procedure parameters or results - it is implied by the
+ * program and procedure of the call.
+ *
+ * Messages are decoded into the same protobuf-c structures the protobuf codec produces, allocating every nested
+ * message, string and byte array separately through the given ProtobufCAllocator, so that they are freed with the
+ * usual '*__free_unpacked' functions whichever codec decoded them. Encoding never allocates.
+ */
+
+#define XDR_UNIT_SIZE 4
+
+// size of a field of the given size once padded to a multiple of XDR_UNIT_SIZE
+#define XDR_PADDED_SIZE(size) (((size) + XDR_UNIT_SIZE - 1) & ~(size_t)(XDR_UNIT_SIZE - 1))
+
+#define XDR_FHANDLE_SIZE 32   // fixed size of the opaque Nfs and Mount filehandles
+#define XDR_MAX_AUTH_BYTES 400 // max size of the body of an opaque_auth
+
+/*
+ * Cursor over a buffer being decoded.
+ *
+ * Reading past the end of the buffer, or failing to allocate, marks the decoder as failed, after which every read
+ * returns zeros and no more memory is allocated, so messages can be decoded field by field and checked once at the
+ * end.
+ */
+typedef struct XdrDecoder {
+    const uint8_t *data;
+    size_t size;
+    size_t offset;
+
+    ProtobufCAllocator *allocator; // NULL for malloc() and free(), as with protobuf-c
+
+    bool failed;
+} XdrDecoder;
+
+/*
+ * XDR encoding of a message type that is sent as procedure parameters or results.
+ */
+typedef struct XdrMessageCodec {
+    const ProtobufCMessageDescriptor *descriptor;
+
+    size_t (*get_packed_size)(const ProtobufCMessage *message);
+    uint8_t *(*pack)(const ProtobufCMessage *message, uint8_t *out);
+    ProtobufCMessage *(*unpack)(XdrDecoder *decoder);
+} XdrMessageCodec;
+
+/*
+ * Defines the XdrMessageCodec 'codec_name' for messages of the given type, from the typed
+ * 'get_<name>_size', 'pack_<name>' and 'unpack_<name>' functions.
+ */
+#define DEFINE_XDR_MESSAGE_CODEC(codec_name, name, type, type_descriptor)                                          \
+    static size_t get_##name##_size_of_message(const ProtobufCMessage *message) {                                  \
+        return get_##name##_size((const type *)message);                                                           \
+    }                                                                                                              \
+    static uint8_t *pack_##name##_message(const ProtobufCMessage *message, uint8_t *out) {                         \
+        return pack_##name((const type *)message, out);                                                            \
+    }                                                                                                              \
+    static ProtobufCMessage *unpack_##name##_message(XdrDecoder *decoder) {                                        \
+        return (ProtobufCMessage *)unpack_##name(decoder);                                                         \
+    }                                                                                                              \
+    static const XdrMessageCodec codec_name = {&(type_descriptor), get_##name##_size_of_message,                   \
+                                               pack_##name##_message, unpack_##name##_message}
+
+/*
+ * Encoding - every function writes a field at 'out' and returns the position right after it.
+ */
+
+static inline uint8_t *xdr_pack_uint32(uint32_t value, uint8_t *out) {
+    out[0] = value >> 24;
+    out[1] = value >> 16;
+    out[2] = value >> 8;
+    out[3] = value;
+
+    return out + 4;
+}
+
+static inline uint8_t *xdr_pack_uint64(uint64_t value, uint8_t *out) {
+    out = xdr_pack_uint32(value >> 32, out);
+
+    return xdr_pack_uint32(value, out);
+}
+
+static inline uint8_t *xdr_pack_bool(bool value, uint8_t *out) {
+    return xdr_pack_uint32(value ? 1 : 0, out);
+}
+
+/*
+ * Writes the given bytes followed by zeros up to the next multiple of XDR_UNIT_SIZE.
+ */
+static inline uint8_t *xdr_pack_fixed_opaque(const uint8_t *data, size_t size, uint8_t *out) {
+    if (size > 0) {
+        memcpy(out, data, size);
+    }
+    memset(out + size, 0, XDR_PADDED_SIZE(size) - size);
+
+    return out + XDR_PADDED_SIZE(size);
+}
+
+static inline size_t xdr_opaque_size(size_t size) {
+    return XDR_UNIT_SIZE + XDR_PADDED_SIZE(size);
+}
+
+static inline uint8_t *xdr_pack_opaque(const uint8_t *data, size_t size, uint8_t *out) {
+    out = xdr_pack_uint32(size, out);
+
+    return xdr_pack_fixed_opaque(data, size, out);
+}
+
+/*
+ * A NULL string is encoded as an empty one.
+ */
+static inline size_t xdr_string_size(const char *string) {
+    return xdr_opaque_size(string == NULL ? 0 : strlen(string));
+}
+
+static inline uint8_t *xdr_pack_string(const char *string, uint8_t *out) {
+    return xdr_pack_opaque((const uint8_t *)string, string == NULL ? 0 : strlen(string), out);
+}
+
+/*
+ * Decoding - every function reads a field at the position of the decoder and moves the decoder past it.
+ */
+
+static inline const uint8_t *xdr_read_bytes(XdrDecoder *decoder, size_t size) {
+    if (decoder->failed || size > decoder->size - decoder->offset) {
+        decoder->failed = true;
+        return NULL;
+    }
+
+    const uint8_t *bytes = decoder->data + decoder->offset;
+    decoder->offset += size;
+
+    return bytes;
+}
+
+static inline uint32_t xdr_unpack_uint32(XdrDecoder *decoder) {
+    const uint8_t *bytes = xdr_read_bytes(decoder, 4);
+    if (bytes == NULL) {
+        return 0;
+    }
+
+    return (uint32_t)bytes[0] << 24 | (uint32_t)bytes[1] << 16 | (uint32_t)bytes[2] << 8 | bytes[3];
+}
+
+static inline uint64_t xdr_unpack_uint64(XdrDecoder *decoder) {
+    uint64_t high = xdr_unpack_uint32(decoder);
+
+    return high << 32 | xdr_unpack_uint32(decoder);
+}
+
+/*
+ * Anything other than 0 or 1 makes the decoder fail.
+ */
+static inline bool xdr_unpack_bool(XdrDecoder *decoder) {
+    uint32_t value = xdr_unpack_uint32(decoder);
+    if (value > 1) {
+        decoder->failed = true;
+        return false;
+    }
+
+    return value == 1;
+}
+
+/*
+ * Functions implemented in xdr.c file.
+ */
+
+void *xdr_alloc(XdrDecoder *decoder, size_t size);
+
+char *xdr_unpack_string(XdrDecoder *decoder, size_t max_length);
+
+ProtobufCBinaryData xdr_unpack_opaque(XdrDecoder *decoder, size_t max_size);
+
+Google__Protobuf__Empty *xdr_unpack_empty(XdrDecoder *decoder);
+
+uint8_t *xdr_pack_nfs_filehandle(const NfsFh__NfsFileHandle *nfs_filehandle, uint8_t *out);
+
+NfsFh__NfsFileHandle *xdr_unpack_nfs_filehandle(XdrDecoder *decoder);
+
+const char *get_xdr_procedure_parameters_type(uint32_t program_number, uint32_t program_version,
+                                              uint32_t procedure_number);
+
+const char *get_xdr_procedure_results_type(uint32_t program_number, uint32_t program_version,
+                                           uint32_t procedure_number);
+
+size_t get_xdr_message_packed_size(const ProtobufCMessage *message);
+
+size_t pack_xdr_message(const ProtobufCMessage *message, uint8_t *out);
+
+ProtobufCMessage *unpack_xdr_message(const ProtobufCMessageDescriptor *descriptor, ProtobufCAllocator *allocator,
+                                     size_t len, const uint8_t *data);
+
+/*
+ * Functions implemented in nfs_xdr.c and mount_xdr.c files - the message types each of them encodes.
+ */
+
+extern const XdrMessageCodec *const nfs_xdr_message_codecs[];
+extern const size_t num_nfs_xdr_message_codecs;
+
+extern const XdrMessageCodec *const mount_xdr_message_codecs[];
+extern const size_t num_mount_xdr_message_codecs;
+
+/*
+ * Functions implemented in rpc_xdr.c file.
+ */
+
+size_t get_xdr_rpc_msg_header_size(const Rpc__RpcMsg *rpc_msg);
+
+uint8_t *pack_xdr_rpc_msg_header(const Rpc__RpcMsg *rpc_msg, uint8_t *out);
+
+size_t get_xdr_rpc_msg_packed_size(const Rpc__RpcMsg *rpc_msg);
+
+size_t pack_xdr_rpc_msg(const Rpc__RpcMsg *rpc_msg, uint8_t *out);
+
+Rpc__RpcMsg *unpack_xdr_rpc_msg(ProtobufCAllocator *allocator, size_t len, const uint8_t *data,
+                                const Rpc__CallBody *replied_call_body, bool copy_payload);
+
+#endif /* xdr__header__INCLUDED */
@@ -2,14 +2,15 @@
 
 /*
  * Creates an empty QUIC client stream context for the given QUIC client with the given RPC
- * call message, and returns it.
+ * call message of the given priority class, and returns it.
  *
  * Returns NULL on failure.
  *
  * The user of this function takes the responsibility to deallocated the created stream context.
  */
 QuicClientStreamContext *create_client_stream_context(QuicClient *quic_client, uint8_t *rpc_msg_buffer,
-                                                      size_t rpc_msg_size, bool use_auxiliary_stream) {
+                                                      size_t rpc_msg_size, bool use_auxiliary_stream,
+                                                      RpcPriorityClass priority_class) {
     QuicClientStreamContext *stream_context = malloc(sizeof(QuicClientStreamContext));
     if (stream_context == NULL) {
         return NULL;
@@ -19,20 +20,22 @@ QuicClientStreamContext *create_client_stream_context(QuicClient *quic_client, u
 
     stream_context->use_auxiliary_stream = use_auxiliary_stream;
     stream_context->allocated_stream = NULL;
-    stream_context->successfully_allocated_stream = stream_context->stream_allocation_finished = false;
-    pthread_mutex_init(&stream_context->stream_allocator_lock, NULL);
-    pthread_cond_init(&stream_context->stream_allocator_condition_variable, NULL);
+    stream_context->successfully_allocated_stream = false;
+    stream_context->next_deferred_stream_context = NULL;
+    stream_context->pipelinable = stream_context->pipelined = false;
+    stream_context->next_pipelined_stream_context = NULL;
+    stream_context->priority_class = priority_class;
 
     stream_context->rm_receiving_context = NULL;
 
     stream_context->attempted_call_rpc_msg_send = stream_context->call_rpc_msg_successfully_sent = false;
     stream_context->reply_rpc_msg_successfully_received = false;
     stream_context->finished = false;
-    pthread_mutex_init(&stream_context->reply_lock, NULL);
-    pthread_cond_init(&stream_context->reply_cond, NULL);
+    init_rpc_completion(&stream_context->completion);
 
     stream_context->call_rpc_msg_size = rpc_msg_size;
     stream_context->call_rpc_msg_buffer = rpc_msg_buffer;
+    stream_context->num_call_bytes_written = 0;
 
     return stream_context;
 }
@@ -47,12 +50,6 @@ void free_stream_context(QuicClientStreamContext *stream_context) {
         return;
     }
 
-    pthread_mutex_destroy(&stream_context->stream_allocator_lock);
-    pthread_cond_destroy(&stream_context->stream_allocator_condition_variable);
-
-    pthread_mutex_destroy(&stream_context->reply_lock);
-    pthread_cond_destroy(&stream_context->reply_cond);
-
     if (stream_context->call_rpc_msg_buffer != NULL) {
         free(stream_context->call_rpc_msg_buffer);
     }
@@ -62,137 +59,142 @@ void free_stream_context(QuicClientStreamContext *stream_context) {
 }
 
 /*
- * Adds the given stream context to the given list of stream contexts.
+ * Initializes the given stream context table to an empty table. Its slots are allocated when the first
+ * stream context is added.
+ */
+void init_stream_context_table(QuicClientStreamContextTable *stream_context_table) {
+    stream_context_table->slots = NULL;
+    stream_context_table->num_slots = 0;
+    stream_context_table->num_stream_contexts = 0;
+}
+
+/*
+ * Grows the given stream context table so that it has a slot at the given index.
  *
- * Returns > 0 on failure and 0 on success.
+ * Returns 0 on success and > 0 on failure.
+ */
+static int grow_stream_context_table(QuicClientStreamContextTable *stream_context_table, size_t slot_index) {
+    size_t num_slots =
+        stream_context_table->num_slots == 0 ? STREAM_CONTEXT_TABLE_INITIAL_SLOTS : stream_context_table->num_slots;
+    while (num_slots <= slot_index) {
+        num_slots *= 2;
+    }
+
+    QuicClientStreamContext **slots =
+        realloc(stream_context_table->slots, sizeof(QuicClientStreamContext *) * num_slots);
+    if (slots == NULL) {
+        return 1;
+    }
+    for (size_t i = stream_context_table->num_slots; i < num_slots; i++) {
+        slots[i] = NULL;
+    }
+
+    stream_context_table->slots = slots;
+    stream_context_table->num_slots = num_slots;
+
+    return 0;
+}
+
+/*
+ * Adds the given stream context, which has a stream allocated, to the given stream context table.
  *
- * The user of this function takes the responsibility to free the added list entry.
+ * Returns > 0 on failure and 0 on success. Fails if the table already holds a stream context for the same
+ * stream.
  */
-int add_stream_context(QuicClientStreamContext *stream_context, QuicClientStreamContextsList **head) {
+int add_stream_context(QuicClientStreamContext *stream_context, QuicClientStreamContextTable *stream_context_table) {
     if (stream_context == NULL) {
         return 1;
     }
 
-    if (head == NULL) {
+    if (stream_context_table == NULL) {
         return 2;
     }
 
-    QuicClientStreamContextsList *new_head = malloc(sizeof(QuicClientStreamContextsList));
-    if (new_head == NULL) {
+    if (stream_context->allocated_stream == NULL) {
+        fprintf(stderr, "add_stream_context: stream context with no allocated stream encountered\n");
         return 3;
     }
 
-    new_head->stream_context = stream_context;
-    new_head->next = *head;
-    *head = new_head;
+    uint64_t stream_id = stream_context->allocated_stream->id;
+    if (!IS_CLIENT_BIDI_STREAM_ID(stream_id)) {
+        fprintf(stderr, "add_stream_context: stream %lu is not a client-initiated bidirectional stream\n", stream_id);
+        return 4;
+    }
+
+    size_t slot_index = STREAM_ID_TO_SLOT_INDEX(stream_id);
+    if (slot_index >= stream_context_table->num_slots &&
+        grow_stream_context_table(stream_context_table, slot_index) > 0) {
+        return 5;
+    }
+
+    if (stream_context_table->slots[slot_index] != NULL) {
+        fprintf(stderr, "add_stream_context: stream %lu already has a stream context\n", stream_id);
+        return 6;
+    }
+
+    stream_context_table->slots[slot_index] = stream_context;
+    stream_context_table->num_stream_contexts++;
 
     return 0;
 }
 
 /*
- * Searches the given list of stream contexts for the client context of the stream with the given ID.
+ * Looks up the client context of the stream with the given ID in the given stream context table.
  *
- * Returns the found stream context or NULL if the context is not present in the list.
+ * Returns the found stream context or NULL if the table holds no context for that stream.
  */
-QuicClientStreamContext *find_stream_context(QuicClientStreamContextsList *head, uint64_t stream_id) {
-    QuicClientStreamContextsList *curr = head;
-    while (curr != NULL) {
-        QuicClientStreamContext *stream_context = curr->stream_context;
-        if (stream_context == NULL) {
-            fprintf(stderr, "find_stream_context: NULL stream context encountered\n");
-            return NULL;
-        }
-
-        if (stream_context->allocated_stream == NULL) {
-            fprintf(stderr, "find_stream_context: stream context with no allocated stream encountered\n");
-            return NULL;
-        }
-
-        if (stream_context->allocated_stream->id == stream_id) {
-            return stream_context;
-        }
+QuicClientStreamContext *find_stream_context(QuicClientStreamContextTable *stream_context_table, uint64_t stream_id) {
+    if (stream_context_table == NULL || !IS_CLIENT_BIDI_STREAM_ID(stream_id)) {
+        return NULL;
+    }
 
-        curr = curr->next;
+    size_t slot_index = STREAM_ID_TO_SLOT_INDEX(stream_id);
+    if (slot_index >= stream_context_table->num_slots) {
+        return NULL;
     }
 
-    return NULL;
+    return stream_context_table->slots[slot_index];
 }
 
 /*
- * Removes the entry with the given stream ID from the given list of stream contexts, if it exists,
- * and deallocates that list entry (the QuicClientStreamContextsList) and the stream context itself
- * (the QuicClientStreamContext).
+ * Removes the stream context of the stream with the given ID from the given stream context table, if it
+ * exists, and deallocates the stream context itself (the QuicClientStreamContext).
  *
  * Returns 0 on success and > 0 on failure.
  */
-int remove_stream_context(QuicClientStreamContextsList **head, uint64_t stream_id) {
-    if (head == NULL) {
+int remove_stream_context(QuicClientStreamContextTable *stream_context_table, uint64_t stream_id) {
+    if (stream_context_table == NULL) {
         return 1;
     }
 
-    if (*head == NULL) {
-        // empty list of stream contexts
-        return 0;
-    }
-
-    QuicClientStreamContextsList *first_entry = *head;
-    QuicClientStreamContext *first_stream_context = first_entry->stream_context;
-    if (first_stream_context == NULL) {
-        fprintf(stderr, "remove_stream_context: NULL stream context encountered\n");
-        return 2;
-    }
-    if (first_stream_context->allocated_stream == NULL) {
-        fprintf(stderr, "remove_stream_context: stream context with no allocated stream encountered\n");
-        return 3;
-    }
-    if (first_stream_context->allocated_stream->id == stream_id) {
-        *head = (*head)->next;
-
-        free_stream_context(first_stream_context);
-        free(first_entry);
-
+    QuicClientStreamContext *stream_context = find_stream_context(stream_context_table, stream_id);
+    if (stream_context == NULL) {
         return 0;
     }
 
-    QuicClientStreamContextsList *curr = *head, *prev = NULL;
-    while (curr != NULL) {
-        QuicClientStreamContext *stream_context = curr->stream_context;
-        if (stream_context == NULL) {
-            fprintf(stderr, "find_stream_context: NULL stream context encountered\n");
-            return 4;
-        }
-        if (stream_context->allocated_stream == NULL) {
-            fprintf(stderr, "find_stream_context: stream context with no allocated stream encountered\n");
-            return 5;
-        }
-
-        if (stream_context->allocated_stream->id == stream_id) {
-            prev->next = curr->next;
-
-            free_stream_context(curr->stream_context);
-            free(curr);
+    stream_context_table->slots[STREAM_ID_TO_SLOT_INDEX(stream_id)] = NULL;
+    stream_context_table->num_stream_contexts--;
 
-            return 0;
-        }
-
-        prev = curr;
-        curr = curr->next;
-    }
+    free_stream_context(stream_context);
 
     return 0;
 }
 
 /*
- * Deallocates the given list of stream contexts and the entries inside it.
+ * Deallocates the given stream context table and the stream contexts inside it.
+ *
+ * The table belongs to the event loop thread, so this must only be called after that thread has exited.
+ * Stream contexts of RPCs that are still in the table are deallocated too.
  */
-void free_stream_contexts_list(QuicClientStreamContextsList *head, pthread_mutex_t *list_lock,
-                               pthread_cond_t *list_cond) {
-    pthread_mutex_lock(list_lock);
+void free_stream_context_table(QuicClientStreamContextTable *stream_context_table) {
+    if (stream_context_table == NULL) {
+        return;
+    }
 
-    // wait for all stream contexts to remove themselves from the list (when their RPCs are done)
-    while (head != NULL) {
-        pthread_cond_wait(list_cond, list_lock);
+    for (size_t i = 0; i < stream_context_table->num_slots; i++) {
+        free_stream_context(stream_context_table->slots[i]);
     }
+    free(stream_context_table->slots);
 
-    pthread_mutex_unlock(list_lock);
-}
\ No newline at end of file
+    init_stream_context_table(stream_context_table);
+}
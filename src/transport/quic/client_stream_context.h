@@ -2,7 +2,9 @@
 #define client_stream_context__HEADER__INCLUDED
 
 #include "quic_record_marking.h"
+#include "rpc_priority.h"
 #include "streams.h"
+#include "submission_ring.h"
 
 #include "pthread.h"
 
@@ -14,14 +16,26 @@ typedef struct QuicClientStreamContext {
 
     bool use_auxiliary_stream;
     Stream *allocated_stream;
-    bool stream_allocation_finished;
     bool successfully_allocated_stream;
-    pthread_mutex_t stream_allocator_lock;
-    pthread_cond_t stream_allocator_condition_variable;
 
-    // the RPC message to be sent by the client
+    // the next stream context waiting for an auxiliary stream to be released, used only by the event loop thread
+    struct QuicClientStreamContext *next_deferred_stream_context;
+
+    // a small idempotent RPC may be sent on the pipelined stream, if the connection has one
+    bool pipelinable;
+    // set by the event loop thread once the RPC is sent on the pipelined stream
+    bool pipelined;
+    // the next stream context on the pipelined stream, used only by the event loop thread
+    struct QuicClientStreamContext *next_pipelined_stream_context;
+
+    // the allocated stream takes the priority of the RPC's procedure class
+    RpcPriorityClass priority_class;
+
+    // the RPC message to be sent by the client, encoded as a Record Marking record once its stream is writable
     size_t call_rpc_msg_size;
     uint8_t *call_rpc_msg_buffer;
+    // bytes of the encoded record written so far - the rest is written on the next writable event of the stream
+    size_t num_call_bytes_written;
 
     // the RPC message being received as a Record Marking record
     RecordMarkingReceivingContext *rm_receiving_context;
@@ -29,28 +43,41 @@ typedef struct QuicClientStreamContext {
     bool attempted_call_rpc_msg_send, call_rpc_msg_successfully_sent;
     bool reply_rpc_msg_successfully_received;
     bool finished;
-    pthread_mutex_t reply_lock;
-    pthread_cond_t reply_cond;
+    // completed by the event loop thread once 'finished' is set, to wake up the RPC caller thread
+    RpcCompletion completion;
 } QuicClientStreamContext;
 
-typedef struct QuicClientStreamContextsList {
-    QuicClientStreamContext *stream_context;
+/*
+ * Stream contexts of a QUIC client, indexed by the ID of their stream. The client only opens bidirectional
+ * streams, whose IDs are 0, 4, 8, ... (the two low bits of a stream ID are its type), so the stream with ID
+ * 'id' gets the slot 'id >> 2' and the table stays dense.
+ */
+typedef struct QuicClientStreamContextTable {
+    QuicClientStreamContext **slots;
+    size_t num_slots;
+    size_t num_stream_contexts;
+} QuicClientStreamContextTable;
 
-    struct QuicClientStreamContextsList *next;
-} QuicClientStreamContextsList;
+// the main stream and all auxiliary streams fit in the table without growing it
+#define STREAM_CONTEXT_TABLE_INITIAL_SLOTS (MAX_STREAMS_PER_CONNECTION + 1)
+
+#define IS_CLIENT_BIDI_STREAM_ID(stream_id) (((stream_id) & 0x3) == 0)
+#define STREAM_ID_TO_SLOT_INDEX(stream_id) ((size_t)((stream_id) >> 2))
 
 QuicClientStreamContext *create_client_stream_context(QuicClient *quic_client, uint8_t *rpc_msg_buffer,
-                                                      size_t rpc_msg_size, bool use_auxiliary_stream);
+                                                      size_t rpc_msg_size, bool use_auxiliary_stream,
+                                                      RpcPriorityClass priority_class);
 
 void free_stream_context(QuicClientStreamContext *stream_context);
 
-int add_stream_context(QuicClientStreamContext *stream_context, QuicClientStreamContextsList **head);
+void init_stream_context_table(QuicClientStreamContextTable *stream_context_table);
+
+int add_stream_context(QuicClientStreamContext *stream_context, QuicClientStreamContextTable *stream_context_table);
 
-QuicClientStreamContext *find_stream_context(QuicClientStreamContextsList *head, uint64_t stream_id);
+QuicClientStreamContext *find_stream_context(QuicClientStreamContextTable *stream_context_table, uint64_t stream_id);
 
-int remove_stream_context(QuicClientStreamContextsList **head, uint64_t stream_id);
+int remove_stream_context(QuicClientStreamContextTable *stream_context_table, uint64_t stream_id);
 
-void free_stream_contexts_list(QuicClientStreamContextsList *head, pthread_mutex_t *list_lock,
-                               pthread_cond_t *list_cond);
+void free_stream_context_table(QuicClientStreamContextTable *stream_context_table);
 
 #endif /* client_stream_context__HEADER__INCLUDED */
\ No newline at end of file
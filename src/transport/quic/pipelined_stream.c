@@ -0,0 +1,223 @@
+#include "pipelined_stream.h"
+
+#include "rpc_priority.h"
+
+#include "src/nfs/nfs_common.h"
+
+/*
+ * Returns true if an RPC to the given procedure of the given RPC program, with a call message of the given
+ * size, may be pipelined - NULL procedures and the small NFS procedures that only read metadata.
+ */
+bool is_pipelinable_rpc(uint32_t program_number, uint32_t procedure_number, size_t call_rpc_msg_size) {
+    if (call_rpc_msg_size > PIPELINED_RPC_MAX_CALL_SIZE) {
+        return false;
+    }
+
+    if (procedure_number == 0) {
+        return true;
+    }
+
+    return program_number == NFS_RPC_PROGRAM_NUMBER &&
+           (procedure_number == NFSPROC_GETATTR || procedure_number == NFSPROC_LOOKUP ||
+            procedure_number == NFSPROC_READLINK || procedure_number == NFSPROC_STATFS);
+}
+
+/*
+ * Initializes the given pipelined stream with no stream opened yet.
+ */
+void init_pipelined_stream(PipelinedStream *pipelined_stream) {
+    pipelined_stream->stream = NULL;
+
+    pipelined_stream->front = pipelined_stream->back = NULL;
+    pipelined_stream->next_call_to_write = NULL;
+    pipelined_stream->num_call_bytes_written = 0;
+
+    pipelined_stream->rm_receiving_context = NULL;
+}
+
+/*
+ * Opens the stream of the given pipelined stream in the given QUIC connection, with the priority of
+ * metadata RPCs.
+ *
+ * Returns 0 on success and > 0 on failure.
+ */
+int open_pipelined_stream(PipelinedStream *pipelined_stream, struct quic_conn_t *quic_connection) {
+    Stream *stream = create_new_stream(quic_connection);
+    if (stream == NULL) {
+        fprintf(stderr, "open_pipelined_stream: failed to create the pipelined stream\n");
+        return 1;
+    }
+    stream->stream_in_use = true;
+
+    quic_stream_set_priority(quic_connection, stream->id, get_rpc_priority_urgency(RPC_PRIORITY_CLASS_METADATA),
+                             is_rpc_priority_incremental(RPC_PRIORITY_CLASS_METADATA));
+    quic_stream_wantwrite(quic_connection, stream->id, false);
+
+    pipelined_stream->stream = stream;
+
+    return 0;
+}
+
+/*
+ * Returns true if the stream with the given ID is the stream of the given pipelined stream.
+ */
+bool is_pipelined_stream(PipelinedStream *pipelined_stream, uint64_t stream_id) {
+    return pipelined_stream->stream != NULL && pipelined_stream->stream->id == stream_id;
+}
+
+/*
+ * Adds the RPC of the given stream context to the back of the given pipelined stream, and writes as much of
+ * the pipelined calls to the stream as it accepts. The call message in the stream context is replaced with
+ * the Record Marking record that carries it.
+ *
+ * Returns 0 on success and > 0 on failure.
+ */
+int add_to_pipelined_stream(PipelinedStream *pipelined_stream, struct quic_conn_t *quic_connection,
+                            QuicClientStreamContext *stream_context) {
+    if (pipelined_stream->stream == NULL) {
+        return 1;
+    }
+
+    size_t rm_record_size;
+    uint8_t *rm_record =
+        encode_rm_record_quic(stream_context->call_rpc_msg_buffer, stream_context->call_rpc_msg_size, &rm_record_size);
+    if (rm_record == NULL) {
+        return 2;
+    }
+    free(stream_context->call_rpc_msg_buffer);
+    stream_context->call_rpc_msg_buffer = rm_record;
+    stream_context->call_rpc_msg_size = rm_record_size;
+
+    stream_context->allocated_stream = pipelined_stream->stream;
+    stream_context->successfully_allocated_stream = true;
+    stream_context->pipelined = true;
+    stream_context->next_pipelined_stream_context = NULL;
+
+    if (pipelined_stream->back == NULL) {
+        pipelined_stream->front = stream_context;
+    } else {
+        pipelined_stream->back->next_pipelined_stream_context = stream_context;
+    }
+    pipelined_stream->back = stream_context;
+
+    if (pipelined_stream->next_call_to_write == NULL) {
+        pipelined_stream->next_call_to_write = stream_context;
+        pipelined_stream->num_call_bytes_written = 0;
+    }
+
+    write_pipelined_calls(pipelined_stream, quic_connection);
+
+    return 0;
+}
+
+/*
+ * Writes the calls of the given pipelined stream that haven't been written yet to its stream, in order, until
+ * the stream stops accepting data - then the stream asks to be written to again once it has flow control
+ * credit.
+ */
+void write_pipelined_calls(PipelinedStream *pipelined_stream, struct quic_conn_t *quic_connection) {
+    uint64_t stream_id = pipelined_stream->stream->id;
+
+    while (pipelined_stream->next_call_to_write != NULL) {
+        QuicClientStreamContext *stream_context = pipelined_stream->next_call_to_write;
+        stream_context->attempted_call_rpc_msg_send = true;
+
+        ssize_t bytes_written = quic_stream_write(
+            quic_connection, stream_id, stream_context->call_rpc_msg_buffer + pipelined_stream->num_call_bytes_written,
+            stream_context->call_rpc_msg_size - pipelined_stream->num_call_bytes_written, false);
+        if (bytes_written <= 0) {
+            quic_stream_wantwrite(quic_connection, stream_id, true);
+            return;
+        }
+
+        pipelined_stream->num_call_bytes_written += bytes_written;
+        if (pipelined_stream->num_call_bytes_written == stream_context->call_rpc_msg_size) {
+            stream_context->call_rpc_msg_successfully_sent = true;
+
+            pipelined_stream->next_call_to_write = stream_context->next_pipelined_stream_context;
+            pipelined_stream->num_call_bytes_written = 0;
+        }
+    }
+
+    quic_stream_wantwrite(quic_connection, stream_id, false);
+}
+
+/*
+ * Reads all available data from the stream of the given pipelined stream, and hands every complete reply to
+ * the oldest stream context still waiting for one, waking up its RPC caller thread.
+ *
+ * Returns 0 on success and > 0 on failure, after which the stream can't be used anymore.
+ */
+int receive_pipelined_replies(PipelinedStream *pipelined_stream, struct quic_conn_t *quic_connection) {
+    while (true) {
+        if (pipelined_stream->rm_receiving_context == NULL) {
+            pipelined_stream->rm_receiving_context =
+                create_rm_receiving_context(quic_connection, pipelined_stream->stream->id);
+            if (pipelined_stream->rm_receiving_context == NULL) {
+                fprintf(stderr, "receive_pipelined_replies: failed to create an RM receiving context\n");
+                return 1;
+            }
+        }
+
+        int error_code = receive_available_bytes_quic(pipelined_stream->rm_receiving_context);
+        if (error_code > 0) {
+            fprintf(stderr, "receive_pipelined_replies: failed to read available data from the pipelined stream\n");
+            return 2;
+        }
+
+        if (!pipelined_stream->rm_receiving_context->record_fully_received) {
+            return 0;
+        }
+
+        QuicClientStreamContext *stream_context = pipelined_stream->front;
+        if (stream_context == NULL || !stream_context->call_rpc_msg_successfully_sent) {
+            fprintf(stderr, "receive_pipelined_replies: received a reply with no RPC waiting for it\n");
+            return 3;
+        }
+
+        pipelined_stream->front = stream_context->next_pipelined_stream_context;
+        if (pipelined_stream->front == NULL) {
+            pipelined_stream->back = NULL;
+        }
+
+        // the RPC caller thread owns the received reply until it retires the stream context
+        stream_context->rm_receiving_context = pipelined_stream->rm_receiving_context;
+        pipelined_stream->rm_receiving_context = NULL;
+
+        stream_context->reply_rpc_msg_successfully_received = true;
+        stream_context->finished = true;
+        complete_rpc(&stream_context->completion);
+    }
+}
+
+/*
+ * Finishes the RPCs of all stream contexts in the given pipelined stream as failed, waking up their RPC
+ * caller threads, and removes them from the pipelined stream.
+ */
+void fail_pipelined_stream_contexts(PipelinedStream *pipelined_stream) {
+    QuicClientStreamContext *stream_context = pipelined_stream->front;
+    while (stream_context != NULL) {
+        QuicClientStreamContext *next_stream_context = stream_context->next_pipelined_stream_context;
+
+        stream_context->reply_rpc_msg_successfully_received = false;
+        stream_context->finished = true;
+        complete_rpc(&stream_context->completion);
+
+        stream_context = next_stream_context;
+    }
+
+    pipelined_stream->front = pipelined_stream->back = NULL;
+    pipelined_stream->next_call_to_write = NULL;
+    pipelined_stream->num_call_bytes_written = 0;
+}
+
+/*
+ * Deallocates the stream and the partially received reply of the given pipelined stream. Stream contexts
+ * still in it are not deallocated.
+ */
+void free_pipelined_stream(PipelinedStream *pipelined_stream) {
+    free(pipelined_stream->stream);
+    free_rm_receiving_context(pipelined_stream->rm_receiving_context);
+
+    init_pipelined_stream(pipelined_stream);
+}
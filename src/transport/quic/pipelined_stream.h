@@ -0,0 +1,59 @@
+#ifndef pipelined_stream__HEADER__INCLUDED
+#define pipelined_stream__HEADER__INCLUDED
+
+#include "client_stream_context.h"
+#include "quic_record_marking.h"
+#include "streams.h"
+
+/*
+ * If enabled, small idempotent RPCs (NULL, GETATTR, LOOKUP, READLINK and STATFS) are pipelined on a single
+ * long-lived stream per connection, instead of each claiming an auxiliary stream of its own.
+ */
+#ifndef QUIC_PIPELINED_SMALL_RPCS
+#define QUIC_PIPELINED_SMALL_RPCS 0
+#endif
+
+// calls larger than this (about what fits in a single QUIC packet) are sent on their own stream
+#define PIPELINED_RPC_MAX_CALL_SIZE 1200
+
+/*
+ * A client-opened stream carrying many RPCs at once. Calls are written to the stream back to back as Record
+ * Marking records, and the server handles them and writes their replies in the same order, so each reply
+ * belongs to the oldest RPC still waiting for one. Owned by the event loop thread.
+ */
+typedef struct PipelinedStream {
+    // NULL until the connection is established
+    Stream *stream;
+
+    // stream contexts whose calls have been added to the stream, oldest first, linked through
+    // 'next_pipelined_stream_context'
+    QuicClientStreamContext *front, *back;
+
+    // the oldest stream context whose call hasn't been fully written yet, and how much of it has been written
+    QuicClientStreamContext *next_call_to_write;
+    size_t num_call_bytes_written;
+
+    // the reply currently being received
+    RecordMarkingReceivingContext *rm_receiving_context;
+} PipelinedStream;
+
+bool is_pipelinable_rpc(uint32_t program_number, uint32_t procedure_number, size_t call_rpc_msg_size);
+
+void init_pipelined_stream(PipelinedStream *pipelined_stream);
+
+int open_pipelined_stream(PipelinedStream *pipelined_stream, struct quic_conn_t *quic_connection);
+
+bool is_pipelined_stream(PipelinedStream *pipelined_stream, uint64_t stream_id);
+
+int add_to_pipelined_stream(PipelinedStream *pipelined_stream, struct quic_conn_t *quic_connection,
+                            QuicClientStreamContext *stream_context);
+
+void write_pipelined_calls(PipelinedStream *pipelined_stream, struct quic_conn_t *quic_connection);
+
+int receive_pipelined_replies(PipelinedStream *pipelined_stream, struct quic_conn_t *quic_connection);
+
+void fail_pipelined_stream_contexts(PipelinedStream *pipelined_stream);
+
+void free_pipelined_stream(PipelinedStream *pipelined_stream);
+
+#endif /* pipelined_stream__HEADER__INCLUDED */
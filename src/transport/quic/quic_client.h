@@ -2,10 +2,17 @@
 #define quic_client__HEADER__INCLUDED
 
 #include "quic_record_marking.h"
+#include "udp_batching.h"
+
+#include "src/transport/transport_stats.h"
 
 #include "client_stream_context.h"
+#include "pipelined_stream.h"
 #include "stream_allocation.h"
+#include "session_resumption.h"
 #include "streams.h"
+#include "submission_ring.h"
+#include "transport_tuning.h"
 
 typedef struct QuicClient {
     struct quic_endpoint_t *quic_endpoint;
@@ -14,6 +21,7 @@ typedef struct QuicClient {
     int socket_fd;
     struct sockaddr_storage local_addr;
     socklen_t local_addr_len;
+    UdpBatchingContext udp_batching_context;
 
     struct quic_config_t *quic_config;
     struct quic_tls_config_t *tls_config;
@@ -27,13 +35,23 @@ typedef struct QuicClient {
     pthread_mutex_t connection_established_lock;
     pthread_cond_t connection_established_condition_variable;
     bool connection_established;
+    // set once a resumed connection can carry 0-RTT data, before the handshake completes
+    bool early_data_available;
+
+    // where the TLS session and token of this connection are saved, to resume the next connection with 0-RTT
+    char *session_cache_path;
+    QuicResumptionState resumption_state;
+
+    // congestion control and flow control parameters of this connection, and where the BDP measured on it is saved
+    QuicTransportTuning transport_tuning;
+    char *bdp_cache_path;
 
     ev_async process_connections_async_watcher;
 
-    ev_async stream_allocator_async_watcher;
-    StreamAllocationQueue *stream_allocation_queue_back;
-    StreamAllocationQueue *stream_allocation_queue_front;
-    pthread_mutex_t stream_allocation_queue_lock;
+    // stream contexts submitted by RPC caller threads, and those whose RPCs have finished
+    ev_async submission_async_watcher;
+    SubmissionRing submission_ring;
+    SubmissionRing retirement_ring;
 
     ev_async connection_closing_async_watcher;
     pthread_mutex_t connection_closed_lock;
@@ -43,12 +61,22 @@ typedef struct QuicClient {
     ev_async event_loop_shutdown_async_watcher;
 
     Stream *main_stream;
-    StreamsList *auxiliary_streams_list_head;
-    pthread_mutex_t auxiliary_streams_list_lock;
+    StreamPool auxiliary_stream_pool;
+    // carries small idempotent RPCs back to back, if QUIC_PIPELINED_SMALL_RPCS is enabled
+    PipelinedStream pipelined_stream;
+
+    // bytes of RPCs in flight on this connection, used to spread RPCs across the connections of a pool
+    size_t outstanding_bytes;
+
+    // the transport statistics of this connection are reported on every expiry of the timer
+    ev_timer stats_timer;
+    // owned by the event loop thread
+    uint64_t num_rpcs_submitted;
 
-    QuicClientStreamContextsList *stream_contexts;
-    pthread_mutex_t stream_contexts_list_lock;
-    pthread_cond_t stream_contexts_condition_variable;
+    // owned by the event loop thread
+    QuicClientStreamContextTable stream_contexts;
+    QuicClientStreamContext *deferred_stream_contexts_front;
+    QuicClientStreamContext *deferred_stream_contexts_back;
 } QuicClient;
 
 #endif
\ No newline at end of file
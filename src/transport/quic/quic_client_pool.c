@@ -0,0 +1,97 @@
+#include "quic_client_pool.h"
+
+#include "rpc_priority.h"
+
+#include "src/nfs/nfs_common.h"
+
+/*
+ * Returns the number of QUIC connections a client should open to the server, QUIC_CLIENT_POOL_SIZE limited
+ * to QUIC_CLIENT_POOL_MAX_SIZE.
+ */
+int get_quic_client_pool_size(void) {
+    int pool_size = QUIC_CLIENT_POOL_SIZE;
+    if (pool_size < 1) {
+        return 1;
+    }
+    if (pool_size > QUIC_CLIENT_POOL_MAX_SIZE) {
+        return QUIC_CLIENT_POOL_MAX_SIZE;
+    }
+
+    return pool_size;
+}
+
+/*
+ * Returns true if the given procedure of the given RPC program moves file data in bulk (NFSPROC_READ and
+ * NFSPROC_WRITE).
+ */
+bool is_bulk_rpc(uint32_t program_number, uint32_t procedure_number) {
+    return get_rpc_priority_class(program_number, procedure_number) == RPC_PRIORITY_CLASS_BULK;
+}
+
+/*
+ * Estimates the number of bytes an RPC keeps outstanding on its connection until its reply arrives - the
+ * size of its call message, plus the given transfer size of the connection for NFSPROC_READ whose reply
+ * carries the data.
+ */
+size_t get_rpc_cost(uint32_t program_number, uint32_t procedure_number, size_t call_rpc_msg_size,
+                    size_t transfer_size) {
+    if (program_number == NFS_RPC_PROGRAM_NUMBER && procedure_number == NFSPROC_READ) {
+        return call_rpc_msg_size + transfer_size;
+    }
+
+    return call_rpc_msg_size;
+}
+
+/*
+ * Picks the connection with the fewest outstanding bytes, among the connections of the given pool that an RPC
+ * of the given kind may use, and adds the given RPC cost to its outstanding bytes.
+ *
+ * Returns the picked QUIC client, or NULL if the pool is empty.
+ *
+ * The user of this function takes the responsibility to call 'release_quic_client' with the same RPC cost
+ * once the RPC is finished.
+ */
+QuicClient *acquire_quic_client(QuicClientPool *quic_client_pool, bool bulk_rpc, size_t rpc_cost) {
+    if (quic_client_pool == NULL || quic_client_pool->num_quic_clients == 0) {
+        return NULL;
+    }
+
+    int first = 0, num_candidates = quic_client_pool->num_quic_clients;
+    if (quic_client_pool->num_bulk_quic_clients > 0) {
+        if (bulk_rpc) {
+            num_candidates = quic_client_pool->num_bulk_quic_clients;
+        } else {
+            first = quic_client_pool->num_bulk_quic_clients;
+            num_candidates -= quic_client_pool->num_bulk_quic_clients;
+        }
+    }
+
+    unsigned int start = __atomic_fetch_add(&quic_client_pool->next_quic_client, 1, __ATOMIC_RELAXED);
+
+    QuicClient *least_loaded_quic_client = NULL;
+    size_t least_outstanding_bytes = 0;
+    for (int i = 0; i < num_candidates; i++) {
+        QuicClient *quic_client = quic_client_pool->quic_clients[first + (start + i) % num_candidates];
+
+        size_t outstanding_bytes = __atomic_load_n(&quic_client->outstanding_bytes, __ATOMIC_RELAXED);
+        if (least_loaded_quic_client == NULL || outstanding_bytes < least_outstanding_bytes) {
+            least_loaded_quic_client = quic_client;
+            least_outstanding_bytes = outstanding_bytes;
+        }
+    }
+
+    __atomic_fetch_add(&least_loaded_quic_client->outstanding_bytes, rpc_cost, __ATOMIC_RELAXED);
+
+    return least_loaded_quic_client;
+}
+
+/*
+ * Takes the cost of a finished RPC off the outstanding bytes of the given QUIC client.
+ */
+void release_quic_client(QuicClient *quic_client, size_t rpc_cost) {
+    if (quic_client == NULL) {
+        return;
+    }
+
+    __atomic_fetch_sub(&quic_client->outstanding_bytes, rpc_cost, __ATOMIC_RELAXED);
+}
@@ -0,0 +1,47 @@
+#ifndef quic_client_pool__HEADER__INCLUDED
+#define quic_client_pool__HEADER__INCLUDED
+
+#include "quic_client.h"
+
+#include "stdbool.h"
+#include "stddef.h"
+
+#define QUIC_CLIENT_POOL_MAX_SIZE 16
+
+// number of QUIC connections (each with its own event loop thread) a client opens to the server
+#ifndef QUIC_CLIENT_POOL_SIZE
+#define QUIC_CLIENT_POOL_SIZE 2
+#endif
+
+// number of connections of the pool reserved for bulk RPCs (READ and WRITE), 0 lets every RPC use every connection
+#ifndef QUIC_CLIENT_POOL_NUM_BULK_CONNECTIONS
+#define QUIC_CLIENT_POOL_NUM_BULK_CONNECTIONS 0
+#endif
+
+/*
+ * The QUIC connections of a single RPC connection context. Each RPC goes to the connection with the fewest
+ * outstanding bytes among those it may use. If some connections are reserved for bulk RPCs, bulk RPCs use
+ * only the first 'num_bulk_quic_clients' connections and all other RPCs use only the remaining ones, so that
+ * large reads and writes don't fill the congestion windows metadata RPCs are sent in.
+ */
+typedef struct QuicClientPool {
+    QuicClient *quic_clients[QUIC_CLIENT_POOL_MAX_SIZE];
+    int num_quic_clients;
+    int num_bulk_quic_clients;
+
+    // rotates the connection the search for the least loaded one starts at, to break ties
+    unsigned int next_quic_client;
+} QuicClientPool;
+
+int get_quic_client_pool_size(void);
+
+bool is_bulk_rpc(uint32_t program_number, uint32_t procedure_number);
+
+size_t get_rpc_cost(uint32_t program_number, uint32_t procedure_number, size_t call_rpc_msg_size,
+                    size_t transfer_size);
+
+QuicClient *acquire_quic_client(QuicClientPool *quic_client_pool, bool bulk_rpc, size_t rpc_cost);
+
+void release_quic_client(QuicClient *quic_client, size_t rpc_cost);
+
+#endif /* quic_client_pool__HEADER__INCLUDED */
@@ -3,75 +3,45 @@
 #include "src/transport/transport_common.h"
 
 /*
- * Sends the buffer of the given number of bytes to the stream with the given ID in the
- * given QUIC connection.
+ * Given a buffer of Record Marking record data 'rm_record_data' of given size 'rm_record_data_size', creates
+ * a buffer holding the whole RM record - the data split into RM fragments, each preceded by its header - for
+ * sending later, and places its size in 'rm_record_size'.
  *
- * Returns 0 on success and > 0 on failure.
+ * Returns NULL on failure.
+ *
+ * The user of this function takes the responsibility to free the created buffer.
  */
-int send_bytes_quic(struct quic_conn_t *conn, uint64_t stream_id, const uint8_t *source_buffer, size_t buffer_size) {
-    size_t total_bytes_sent = 0;
-    while (total_bytes_sent < buffer_size) {
-        size_t bytes_sent =
-            quic_stream_write(conn, stream_id, source_buffer + total_bytes_sent, buffer_size - total_bytes_sent, false);
-        if (bytes_sent < 0) {
-            fprintf(stderr, "send_bytes_quic: failed to send from the buffer, error code %ld\n", bytes_sent);
-            return 1;
-        }
-        if (bytes_sent == 0) { // to avoid infinite loops
-            fprintf(stderr, "send_bytes_quic: sent zero bytes from the buffer\n");
-            return 2;
-        }
+uint8_t *encode_rm_record_quic(const uint8_t *rm_record_data, size_t rm_record_data_size, size_t *rm_record_size) {
+    size_t num_fragments = (rm_record_data_size + RM_MAX_FRAGMENT_DATA_SIZE - 1) / RM_MAX_FRAGMENT_DATA_SIZE;
 
-        total_bytes_sent += bytes_sent;
+    *rm_record_size = num_fragments * sizeof(uint32_t) + rm_record_data_size;
+    uint8_t *rm_record = malloc(*rm_record_size);
+    if (rm_record == NULL) {
+        fprintf(stderr, "encode_rm_record_quic: failed to allocate memory\n");
+        return NULL;
     }
 
-    return 0;
-}
-
-/*
- * Given a QUIC connection and an ID of a stream inside it, and a buffer of Record Marking record data
- * 'rm_record_data' of given size 'rm_record_data_size', sends the RM record data as a series of RM fragments to the
- * specified QUIC stream.
- *
- * Returns 0 on success, and > 0 on failure.
- */
-int send_rm_record_quic(struct quic_conn_t *conn, uint64_t stream_id, const uint8_t *rm_record_data,
-                        size_t rm_record_data_size) {
-    size_t rm_record_data_bytes_sent = 0;
-
-    while (rm_record_data_bytes_sent < rm_record_data_size) {
-        size_t bytes_left = rm_record_data_size - rm_record_data_bytes_sent;
+    size_t rm_record_data_bytes_encoded = 0, rm_record_offset = 0;
+    while (rm_record_data_bytes_encoded < rm_record_data_size) {
+        size_t bytes_left = rm_record_data_size - rm_record_data_bytes_encoded;
         size_t fragment_size = (bytes_left < RM_MAX_FRAGMENT_DATA_SIZE) ? bytes_left : RM_MAX_FRAGMENT_DATA_SIZE;
 
-        // create the RM fragment header
-        uint32_t fragment_header =
-            (bytes_left == fragment_size ? 0x80000000 : 0) | fragment_size; // set the MSB if this is the last fragment
-        fragment_header = htonl(fragment_header);                           // convert to network byte order
-
-        // send the fragment header
-        uint8_t header_buffer[sizeof(fragment_header)];
-        memcpy(header_buffer, &fragment_header, sizeof(fragment_header));
-        int error_code = send_bytes_quic(conn, stream_id, header_buffer, sizeof(fragment_header));
-        if (error_code > 0) {
-            fprintf(stderr, "send_rm_record_quic: failed to send the Record Marking fragment header\n");
-            return 1;
-        }
+        // set the MSB of the fragment header if this is the last fragment
+        uint32_t fragment_header = htonl((bytes_left == fragment_size ? 0x80000000 : 0) | fragment_size);
+        memcpy(rm_record + rm_record_offset, &fragment_header, sizeof(fragment_header));
+        rm_record_offset += sizeof(fragment_header);
 
-        // send the fragment data
-        error_code = send_bytes_quic(conn, stream_id, rm_record_data + rm_record_data_bytes_sent, fragment_size);
-        if (error_code > 0) {
-            fprintf(stderr, "send_rm_record_quic: failed to send the Record Marking fragment data\n");
-            return 2;
-        }
+        memcpy(rm_record + rm_record_offset, rm_record_data + rm_record_data_bytes_encoded, fragment_size);
+        rm_record_offset += fragment_size;
 
-        rm_record_data_bytes_sent += fragment_size;
+        rm_record_data_bytes_encoded += fragment_size;
     }
 
-    return 0;
+    return rm_record;
 }
 
 /*
- * Creates a fresh RM receiving context (with buffer size 0, and buffer being NULL) for the given stream in the
+ * Creates a fresh RM receiving context (with an empty buffer) for the given stream in the
  * given QUIC connection.
  *
  * Returns NULL on failure.
@@ -89,17 +59,15 @@ RecordMarkingReceivingContext *create_rm_receiving_context(struct quic_conn_t *q
     rm_receiving_context->quic_connection = quic_connection;
     rm_receiving_context->stream_id = stream_id;
 
-    rm_receiving_context->accumulated_payloads_size = 0;
-    rm_receiving_context->accumulated_payloads = NULL;
+    RecordBuffer empty_record_buffer = RECORD_BUFFER_INIT;
+    rm_receiving_context->accumulated_payloads = empty_record_buffer;
 
     rm_receiving_context->current_rm_fragment_num_received_header_bytes = 0;
-    rm_receiving_context->current_rm_fragment_received_header_bytes = NULL;
 
     rm_receiving_context->is_last_fragment = false;
 
     rm_receiving_context->current_rm_fragment_expected_size = 0;
     rm_receiving_context->current_rm_fragment_num_received_payload_bytes = 0;
-    rm_receiving_context->current_rm_fragment_received_payload_bytes = NULL;
 
     rm_receiving_context->record_fully_received = false;
 
@@ -118,17 +86,31 @@ void reset_rm_receiving_context_for_next_rm_fragment(RecordMarkingReceivingConte
     }
 
     rm_receiving_context->current_rm_fragment_num_received_header_bytes = 0;
-    rm_receiving_context->current_rm_fragment_received_header_bytes = NULL;
 
     rm_receiving_context->is_last_fragment = false;
 
     rm_receiving_context->current_rm_fragment_expected_size = 0;
     rm_receiving_context->current_rm_fragment_num_received_payload_bytes = 0;
-    rm_receiving_context->current_rm_fragment_received_payload_bytes = NULL;
 
     rm_receiving_context->record_fully_received = false;
 }
 
+/*
+ * Resets the state in the given RM receiving context to prepare it to receive the next RM record
+ * on the same stream, keeping its buffer (unless it grew too large) so that it can be reused.
+ *
+ * Does nothing if the given RM receiving context is NULL.
+ */
+void reset_rm_receiving_context_for_next_rm_record(RecordMarkingReceivingContext *rm_receiving_context) {
+    if (rm_receiving_context == NULL) {
+        return;
+    }
+
+    clear_record_buffer(&rm_receiving_context->accumulated_payloads);
+
+    reset_rm_receiving_context_for_next_rm_fragment(rm_receiving_context);
+}
+
 /*
  * Deallocates all heap allocated memory in the given RM receiving context, including
  * the context itself.
@@ -140,11 +122,25 @@ void free_rm_receiving_context(RecordMarkingReceivingContext *rm_receiving_conte
         return;
     }
 
-    free(rm_receiving_context->accumulated_payloads);
+    release_record_buffer(&rm_receiving_context->accumulated_payloads);
 
     free(rm_receiving_context);
 }
 
+/*
+ * Returns the number of bytes of heap memory currently held by the given RM receiving context, including
+ * the context itself.
+ *
+ * Returns 0 if the given RM receiving context is NULL.
+ */
+size_t get_rm_receiving_context_buffered_bytes(RecordMarkingReceivingContext *rm_receiving_context) {
+    if (rm_receiving_context == NULL) {
+        return 0;
+    }
+
+    return sizeof(RecordMarkingReceivingContext) + rm_receiving_context->accumulated_payloads.capacity;
+}
+
 /*
  * Creates a fresh RM receiving context (with buffer size 0) for the given stream in the
  * given QUIC connection, and adds it to the head of the given list of RM receiving contexts.
@@ -241,7 +237,7 @@ RecordMarkingReceivingContext *get_rm_receiving_context(struct quic_conn_t *quic
  */
 int remove_rm_receiving_context(struct quic_conn_t *quic_connection, uint64_t stream_id,
                                 RecordMarkingReceivingContextsList **rm_receiving_contexts) {
-    if (rm_receiving_contexts == NULL) {
+    if (rm_receiving_contexts == NULL || *rm_receiving_contexts == NULL) {
         fprintf(stderr, "remove_rm_receiving_context: RM receiving context not found\n");
         return 1;
     }
@@ -306,8 +302,14 @@ void clean_up_rm_receiving_contexts_list(RecordMarkingReceivingContextsList *rm_
  * Given a RM receiving context, reads all available data from this context's stream, updating
  * the state of the given RM receiving context to contain the newly received data.
  *
- * When it receives a complete Record Marking record, if there is more data to be read from this stream
- * then this function fails.
+ * Fragment headers are read into the context itself and fragment payloads are read straight into the
+ * context's record buffer, so received data is never copied. When a fragment header marks the last
+ * fragment of the record, the record buffer is sized exactly for the whole record, otherwise it grows
+ * geometrically.
+ *
+ * It stops reading as soon as it receives a complete Record Marking record, so any data following it on the
+ * stream (the next RPC pipelined on the same stream) is left to be read once the context is reset for the next
+ * record.
  *
  * Returns 0 on success and > 0 on failure.
  */
@@ -316,140 +318,93 @@ int receive_available_bytes_quic(RecordMarkingReceivingContext *rm_receiving_con
         return 1;
     }
 
+    RecordBuffer *accumulated_payloads = &rm_receiving_context->accumulated_payloads;
+
     // read all newly available data
-    uint8_t read_buffer[READ_BUF_SIZE];
     bool fin = false;
-    while (1) {
-        ssize_t bytes_read = quic_stream_read(rm_receiving_context->quic_connection, rm_receiving_context->stream_id,
-                                              read_buffer, sizeof(read_buffer), &fin);
-        if (bytes_read < 0) {
-            // all currently available data has been read from this stream
-            break;
-        }
-        if (bytes_read == 0) { // to prevent infinite loops
-            fprintf(stderr, "receive_available_bytes_quic: read 0 bytes from stream %ld\n",
-                    rm_receiving_context->stream_id);
-            return 2;
-        }
+    while (!rm_receiving_context->record_fully_received) {
+        ssize_t bytes_read;
 
-        size_t bytes_processed = 0;
-        while (bytes_processed < bytes_read) {
+        if (rm_receiving_context->current_rm_fragment_num_received_header_bytes < RM_FRAGMENT_HEADER_SIZE) {
             // if not fully received, read the RM fragment header
-            if (rm_receiving_context->current_rm_fragment_num_received_header_bytes < RM_FRAGMENT_HEADER_SIZE) {
-                if (rm_receiving_context->current_rm_fragment_received_header_bytes == NULL) {
-                    rm_receiving_context->current_rm_fragment_received_header_bytes =
-                        malloc(sizeof(uint8_t) * RM_FRAGMENT_HEADER_SIZE);
-                }
-                if (rm_receiving_context->current_rm_fragment_received_header_bytes == NULL) {
-                    fprintf(stderr, "receive_available_bytes_quic: failed to allocate memory\n");
-                    return 3;
-                }
-
-                size_t bytes_to_process = bytes_read - bytes_processed;
-                size_t header_bytes_left =
-                    RM_FRAGMENT_HEADER_SIZE - rm_receiving_context->current_rm_fragment_num_received_header_bytes;
-                size_t header_bytes_to_process =
-                    header_bytes_left < bytes_to_process ? header_bytes_left : bytes_to_process;
-                memcpy(rm_receiving_context->current_rm_fragment_received_header_bytes +
-                           rm_receiving_context->current_rm_fragment_num_received_header_bytes,
-                       read_buffer + bytes_processed, header_bytes_to_process);
-
-                rm_receiving_context->current_rm_fragment_num_received_header_bytes += header_bytes_to_process;
-                bytes_processed += header_bytes_to_process;
-
-                // parse the fragment header if fully received
-                if (rm_receiving_context->current_rm_fragment_num_received_header_bytes == RM_FRAGMENT_HEADER_SIZE) {
-                    uint32_t fragment_header = 0;
-                    memcpy(&fragment_header, rm_receiving_context->current_rm_fragment_received_header_bytes,
-                           sizeof(fragment_header));
-
-                    // decode the fragment header
-                    fragment_header = ntohl(fragment_header); // convert to host byte order
-                    rm_receiving_context->is_last_fragment =
-                        (fragment_header & 0x80000000) !=
-                        0; // if most significant bit is set, this is the last fragment
-                    rm_receiving_context->current_rm_fragment_expected_size =
-                        fragment_header & 0x7FFFFFFF; // lower 31 bits specify fragment size in bytes
-                }
+            bytes_read = quic_stream_read(
+                rm_receiving_context->quic_connection, rm_receiving_context->stream_id,
+                rm_receiving_context->current_rm_fragment_received_header_bytes +
+                    rm_receiving_context->current_rm_fragment_num_received_header_bytes,
+                RM_FRAGMENT_HEADER_SIZE - rm_receiving_context->current_rm_fragment_num_received_header_bytes, &fin);
+            if (bytes_read < 0) {
+                // all currently available data has been read from this stream
+                break;
+            }
+            if (bytes_read == 0) { // to prevent infinite loops
+                fprintf(stderr, "receive_available_bytes_quic: read 0 bytes from stream %ld\n",
+                        rm_receiving_context->stream_id);
+                return 2;
+            }
 
+            rm_receiving_context->current_rm_fragment_num_received_header_bytes += bytes_read;
+            if (rm_receiving_context->current_rm_fragment_num_received_header_bytes < RM_FRAGMENT_HEADER_SIZE) {
                 continue;
             }
 
-            // if not fully received, read the RM fragment payload
-            if (rm_receiving_context->current_rm_fragment_num_received_payload_bytes <
-                rm_receiving_context->current_rm_fragment_expected_size) {
-                if (rm_receiving_context->current_rm_fragment_received_payload_bytes == NULL) {
-                    rm_receiving_context->current_rm_fragment_received_payload_bytes =
-                        malloc(sizeof(uint8_t) * rm_receiving_context->current_rm_fragment_expected_size);
-                }
-                if (rm_receiving_context->current_rm_fragment_received_header_bytes == NULL) {
-                    fprintf(stderr, "receive_available_bytes_quic: failed to allocate memory\n");
-                    return 3;
-                }
-
-                size_t bytes_to_process = bytes_read - bytes_processed;
-                size_t payload_bytes_left = rm_receiving_context->current_rm_fragment_expected_size -
-                                            rm_receiving_context->current_rm_fragment_num_received_payload_bytes;
-                size_t payload_bytes_to_process =
-                    payload_bytes_left < bytes_to_process ? payload_bytes_left : bytes_to_process;
-                memcpy(rm_receiving_context->current_rm_fragment_received_payload_bytes +
-                           rm_receiving_context->current_rm_fragment_num_received_payload_bytes,
-                       read_buffer + bytes_processed, payload_bytes_to_process);
-
-                rm_receiving_context->current_rm_fragment_num_received_payload_bytes += payload_bytes_to_process;
-                bytes_processed += payload_bytes_to_process;
+            // parse the fragment header once fully received
+            uint32_t fragment_header = 0;
+            memcpy(&fragment_header, rm_receiving_context->current_rm_fragment_received_header_bytes,
+                   sizeof(fragment_header));
+
+            // decode the fragment header
+            fragment_header = ntohl(fragment_header); // convert to host byte order
+            rm_receiving_context->is_last_fragment =
+                (fragment_header & 0x80000000) != 0; // if most significant bit is set, this is the last fragment
+            rm_receiving_context->current_rm_fragment_expected_size =
+                fragment_header & 0x7FFFFFFF; // lower 31 bits specify fragment size in bytes
+
+            // make room for this fragment's payload - the size of the whole record is known on its last fragment
+            int error_code = reserve_record_buffer(
+                accumulated_payloads,
+                accumulated_payloads->size + rm_receiving_context->current_rm_fragment_expected_size,
+                rm_receiving_context->is_last_fragment);
+            if (error_code > 0) {
+                fprintf(stderr, "receive_available_bytes_quic: failed to allocate memory\n");
+                return 3;
             }
-
-            // the RM fragment was fully received
-            if (rm_receiving_context->current_rm_fragment_num_received_payload_bytes ==
-                rm_receiving_context->current_rm_fragment_expected_size) {
-                // allocate more memory for storing all RM fragment payloads
-                if (rm_receiving_context->accumulated_payloads == NULL) {
-                    rm_receiving_context->accumulated_payloads =
-                        malloc(sizeof(uint8_t) * rm_receiving_context->current_rm_fragment_num_received_payload_bytes);
-                } else {
-                    rm_receiving_context->accumulated_payloads = realloc(
-                        rm_receiving_context->accumulated_payloads,
-                        sizeof(uint8_t) * (rm_receiving_context->accumulated_payloads_size +
-                                           rm_receiving_context->current_rm_fragment_num_received_payload_bytes));
-                }
-                if (rm_receiving_context->accumulated_payloads == NULL) {
-                    fprintf(stderr, "receive_available_bytes_quic: failed to allocate memory\n");
-                    return 3;
-                }
-
-                // save the payload
-                memcpy(rm_receiving_context->accumulated_payloads + rm_receiving_context->accumulated_payloads_size,
-                       rm_receiving_context->current_rm_fragment_received_payload_bytes,
-                       rm_receiving_context->current_rm_fragment_num_received_payload_bytes);
-                rm_receiving_context->accumulated_payloads_size +=
-                    rm_receiving_context->current_rm_fragment_num_received_payload_bytes;
-
-                // free the buffers used for RM fragment header and payload
-                free(rm_receiving_context->current_rm_fragment_received_header_bytes);
-                free(rm_receiving_context->current_rm_fragment_received_payload_bytes);
-
-                // this was the last fragment of the RM record
-                if (rm_receiving_context->is_last_fragment) {
-                    rm_receiving_context->record_fully_received = true;
-                    break;
-                }
-
-                // reset the context for receiving the next RM fragment
-                reset_rm_receiving_context_for_next_rm_fragment(rm_receiving_context);
+        } else {
+            // if not fully received, read the RM fragment payload straight into the record buffer
+            bytes_read = quic_stream_read(
+                rm_receiving_context->quic_connection, rm_receiving_context->stream_id,
+                accumulated_payloads->data + accumulated_payloads->size +
+                    rm_receiving_context->current_rm_fragment_num_received_payload_bytes,
+                rm_receiving_context->current_rm_fragment_expected_size -
+                    rm_receiving_context->current_rm_fragment_num_received_payload_bytes,
+                &fin);
+            if (bytes_read < 0) {
+                // all currently available data has been read from this stream
+                break;
             }
+            if (bytes_read == 0) { // to prevent infinite loops
+                fprintf(stderr, "receive_available_bytes_quic: read 0 bytes from stream %ld\n",
+                        rm_receiving_context->stream_id);
+                return 2;
+            }
+
+            rm_receiving_context->current_rm_fragment_num_received_payload_bytes += bytes_read;
         }
 
-        if (rm_receiving_context->record_fully_received) {
-            if (bytes_processed < bytes_read) {
-                fprintf(stderr, "receive_available_bytes_quic: received more data following the RPC on stream %ld\n",
-                        rm_receiving_context->stream_id);
-                return 4;
+        // the RM fragment was fully received
+        if (rm_receiving_context->current_rm_fragment_num_received_payload_bytes ==
+            rm_receiving_context->current_rm_fragment_expected_size) {
+            accumulated_payloads->size += rm_receiving_context->current_rm_fragment_expected_size;
+
+            // this was the last fragment of the RM record
+            if (rm_receiving_context->is_last_fragment) {
+                rm_receiving_context->record_fully_received = true;
+                break;
             }
 
-            break;
+            // reset the context for receiving the next RM fragment
+            reset_rm_receiving_context_for_next_rm_fragment(rm_receiving_context);
         }
     }
 
     return 0;
-}
\ No newline at end of file
+}
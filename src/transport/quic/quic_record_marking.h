@@ -16,14 +16,13 @@
 
 #include "tquic.h"
 
-#define READ_BUF_SIZE 10000
+#include "src/transport/record_buffer_pool.h"
 
 /*
 Sending Record Marking records
 */
 
-int send_rm_record_quic(struct quic_conn_t *conn, uint64_t stream_id, const uint8_t *rm_record_data,
-                        size_t rm_record_data_size);
+uint8_t *encode_rm_record_quic(const uint8_t *rm_record_data, size_t rm_record_data_size, size_t *rm_record_size);
 
 /*
  * Receiving Record Marking records
@@ -38,13 +37,13 @@ typedef struct RecordMarkingReceivingContext {
     struct quic_conn_t *quic_connection;
     uint64_t stream_id;
 
-    // concatenated payloads from the RM fragments that have been fully received so far
-    size_t accumulated_payloads_size;
-    uint8_t *accumulated_payloads;
+    // concatenated payloads from the RM fragments received so far - fragment payloads are read from the stream
+    // straight into this buffer, which is kept for the next RM record on the same stream
+    RecordBuffer accumulated_payloads;
 
     // bytes received so far in the header of the RM fragment currently being received
     size_t current_rm_fragment_num_received_header_bytes;
-    uint8_t *current_rm_fragment_received_header_bytes;
+    uint8_t current_rm_fragment_received_header_bytes[sizeof(uint32_t)];
 
     // is the last fragment currently being received
     bool is_last_fragment;
@@ -52,15 +51,18 @@ typedef struct RecordMarkingReceivingContext {
     // bytes received so far in the payload of the RM fragment currently being received
     size_t current_rm_fragment_expected_size;
     size_t current_rm_fragment_num_received_payload_bytes;
-    uint8_t *current_rm_fragment_received_payload_bytes;
 
     bool record_fully_received;
 } RecordMarkingReceivingContext;
 
 RecordMarkingReceivingContext *create_rm_receiving_context(struct quic_conn_t *quic_connection, uint64_t stream_id);
 
+void reset_rm_receiving_context_for_next_rm_record(RecordMarkingReceivingContext *rm_receiving_context);
+
 void free_rm_receiving_context(RecordMarkingReceivingContext *rm_receiving_context);
 
+size_t get_rm_receiving_context_buffered_bytes(RecordMarkingReceivingContext *rm_receiving_context);
+
 /*
  * Lists of RM Receiving Contexts
  */
@@ -1,5 +1,6 @@
 #include "quic_rpc_client.h"
 
+#include "pipelined_stream.h"
 #include "stream_allocation.h"
 #include "streams.h"
 
@@ -7,13 +8,50 @@ void timeout_callback(EV_P_ ev_timer *w, int revents);
 void process_connections(QuicClient *client);
 void read_callback(EV_P_ ev_io *w, int revents);
 void async_process_connections_callback(EV_P_ ev_async *w, int revents);
-void async_stream_allocator_callback(EV_P_ ev_async *w, int revents);
 void async_shutdown_loop_callback(EV_P_ ev_async *w, int revents);
 
+/*
+ * Writes the name of the QUIC connection of the given client, unique within the client process, to the given
+ * buffer of the given size.
+ */
+static void get_client_connection_name(QuicClient *client, char *name, size_t name_size) {
+    struct sockaddr_in *local_addr = (struct sockaddr_in *)&client->local_addr;
+    snprintf(name, name_size, "client_%d_port_%u", getpid(), ntohs(local_addr->sin_port));
+}
+
+/*
+ * Reports the transport statistics of the QUIC connection of the given client.
+ */
+static void report_client_connection_stats(QuicClient *client) {
+    if (client->quic_connection == NULL) {
+        return;
+    }
+
+    TransportConnectionStats stats = {0};
+    collect_quic_connection_stats(client->quic_connection, &stats);
+    stats.num_rpcs = client->num_rpcs_submitted;
+
+    char connection_name[64];
+    get_client_connection_name(client, connection_name, sizeof(connection_name));
+    report_transport_connection_stats("quic", connection_name, &stats);
+    report_rpc_compression_stats();
+}
+
+static void stats_timeout_callback(EV_P_ ev_timer *w, int revents) {
+    report_client_connection_stats(w->data);
+}
+
 // Callback handlers for QUIC events
 void client_on_conn_created(void *tctx, struct quic_conn_t *conn) {
     QuicClient *client = tctx;
     client->quic_connection = conn;
+
+    char connection_name[64];
+    get_client_connection_name(client, connection_name, sizeof(connection_name));
+    if (enable_quic_qlog(conn, connection_name) > 0) {
+        fprintf(stderr, "client_on_conn_created: failed to enable qlog for the connection\n");
+    }
+    report_quic_transport_tuning(connection_name, &client->transport_tuning);
 }
 
 /*
@@ -29,10 +67,10 @@ void *event_loop_runner(void *arg) {
     client->process_connections_async_watcher.data = client;
     ev_async_start(client->event_loop, &client->process_connections_async_watcher);
 
-    // initialize the stream allocator callback
-    ev_async_init(&client->stream_allocator_async_watcher, async_stream_allocator_callback);
-    client->stream_allocator_async_watcher.data = client;
-    ev_async_start(client->event_loop, &client->stream_allocator_async_watcher);
+    // initialize the submission callback
+    ev_async_init(&client->submission_async_watcher, async_submission_callback);
+    client->submission_async_watcher.data = client;
+    ev_async_start(client->event_loop, &client->submission_async_watcher);
 
     // initialize the connection closing callback
     ev_async_init(&client->connection_closing_async_watcher, async_connection_closing_callback);
@@ -48,6 +86,14 @@ void *event_loop_runner(void *arg) {
     ev_init(&client->timer, timeout_callback);
     client->timer.data = client;
 
+    // initialize the transport statistics timer
+    if (are_transport_stats_enabled()) {
+        ev_timer_init(&client->stats_timer, stats_timeout_callback, TRANSPORT_STATS_INTERVAL,
+                      TRANSPORT_STATS_INTERVAL);
+        client->stats_timer.data = client;
+        ev_timer_start(client->event_loop, &client->stats_timer);
+    }
+
     // process_connections(client);
     ev_async_send(client->event_loop, &client->process_connections_async_watcher);
 
@@ -84,8 +130,10 @@ void client_on_conn_established(void *tctx, struct quic_conn_t *conn) {
     if (main_stream == NULL) {
         fprintf(stderr, "client_on_conn_established: failed to allocate memory for the main stream\n");
 
+        pthread_mutex_lock(&client->connection_established_lock);
         client->connection_established = true;
-        pthread_cond_signal(&client->connection_established_condition_variable);
+        pthread_cond_broadcast(&client->connection_established_condition_variable);
+        pthread_mutex_unlock(&client->connection_established_lock);
 
         return;
     }
@@ -93,13 +141,42 @@ void client_on_conn_established(void *tctx, struct quic_conn_t *conn) {
 
     quic_stream_wantwrite(conn, main_stream->id, false);
 
+    // without a pipelined stream, small RPCs are sent on auxiliary streams as any other RPC
+    if (QUIC_PIPELINED_SMALL_RPCS && open_pipelined_stream(&client->pipelined_stream, conn) > 0) {
+        fprintf(stderr, "client_on_conn_established: failed to open the pipelined stream\n");
+    }
+
+    // several RPC threads may be waiting for this connection of the pool
+    pthread_mutex_lock(&client->connection_established_lock);
     client->connection_established = true;
-    pthread_cond_signal(&client->connection_established_condition_variable);
+    pthread_cond_broadcast(&client->connection_established_condition_variable);
+    pthread_mutex_unlock(&client->connection_established_lock);
 }
 
 void client_on_conn_closed(void *tctx, struct quic_conn_t *conn) {
     QuicClient *client = tctx;
 
+    // save the TLS session so that the next connection to this server can be resumed with 0-RTT
+    const uint8_t *session = NULL;
+    size_t session_len = 0;
+    quic_conn_session(conn, &session, &session_len);
+    if (session_len > 0 && save_quic_resumption_state(client->session_cache_path, session, session_len,
+                                                      client->resumption_state.token,
+                                                      client->resumption_state.token_len) > 0) {
+        fprintf(stderr, "client_on_conn_closed: failed to save the TLS session\n");
+    }
+
+    // final statistics of the connection
+    report_client_connection_stats(client);
+
+    // the next connection to this server starts with windows sized for what this one measured
+    if (save_quic_bdp(client->bdp_cache_path, measure_quic_connection_bdp(conn)) > 0) {
+        fprintf(stderr, "client_on_conn_closed: failed to save the measured BDP\n");
+    }
+
+    // RPCs waiting for their replies on the pipelined stream won't get them anymore
+    fail_pipelined_stream_contexts(&client->pipelined_stream);
+
     client->connection_closed = true;
 
     ev_async_send(client->event_loop, &client->event_loop_shutdown_async_watcher);
@@ -107,19 +184,42 @@ void client_on_conn_closed(void *tctx, struct quic_conn_t *conn) {
     pthread_cond_signal(&client->connection_closed_condition_variable);
 }
 
+void client_on_new_token(void *tctx, struct quic_conn_t *conn, const uint8_t *token, size_t token_len) {
+    QuicClient *client = tctx;
+
+    // the server sends a token for validating our address on the next connection, which is saved with the session
+    if (set_quic_resumption_token(&client->resumption_state, token, token_len) > 0) {
+        fprintf(stderr, "client_on_new_token: failed to store the new token\n");
+    }
+}
+
 void client_on_stream_created(void *tctx, struct quic_conn_t *conn, uint64_t stream_id) {
 }
 
 void client_on_stream_readable(void *tctx, struct quic_conn_t *conn, uint64_t stream_id) {
     QuicClient *client = tctx;
 
-    pthread_mutex_lock(&client->stream_contexts_list_lock);
+    if (is_pipelined_stream(&client->pipelined_stream, stream_id)) {
+        if (receive_pipelined_replies(&client->pipelined_stream, conn) > 0) {
+            fprintf(stderr, "client_on_stream_readable: failed to receive replies on the pipelined stream\n");
 
-    QuicClientStreamContext *stream_context = find_stream_context(client->stream_contexts, stream_id);
+            fail_pipelined_stream_contexts(&client->pipelined_stream);
+
+            kill_event_loop_thread(client);
+        }
+
+        return;
+    }
+
+    QuicClientStreamContext *stream_context = find_stream_context(&client->stream_contexts, stream_id);
     if (stream_context == NULL) {
         fprintf(stderr,
                 "client_on_stream_readable: client stream is readable but no response expected on this stream\n");
-        pthread_mutex_unlock(&client->stream_contexts_list_lock);
+        return;
+    }
+
+    // the RPC caller thread owns the received reply until it retires the stream context
+    if (stream_context->finished) {
         return;
     }
 
@@ -132,11 +232,9 @@ void client_on_stream_readable(void *tctx, struct quic_conn_t *conn, uint64_t st
             stream_context->reply_rpc_msg_successfully_received = false;
 
             stream_context->finished = true;
-            kill_event_loop_thread(client);
-
-            pthread_cond_signal(&stream_context->reply_cond);
+            complete_rpc(&stream_context->completion);
 
-            pthread_mutex_unlock(&client->stream_contexts_list_lock);
+            kill_event_loop_thread(client);
 
             return;
         }
@@ -150,11 +248,9 @@ void client_on_stream_readable(void *tctx, struct quic_conn_t *conn, uint64_t st
         stream_context->reply_rpc_msg_successfully_received = false;
 
         stream_context->finished = true;
-        kill_event_loop_thread(client);
-
-        pthread_cond_signal(&stream_context->reply_cond);
+        complete_rpc(&stream_context->completion);
 
-        pthread_mutex_unlock(&client->stream_contexts_list_lock);
+        kill_event_loop_thread(client);
 
         return;
     }
@@ -164,20 +260,20 @@ void client_on_stream_readable(void *tctx, struct quic_conn_t *conn, uint64_t st
         stream_context->reply_rpc_msg_successfully_received = true;
         stream_context->finished = true;
 
-        pthread_cond_signal(&stream_context->reply_cond);
+        complete_rpc(&stream_context->completion);
     }
-
-    pthread_mutex_unlock(&client->stream_contexts_list_lock);
 }
 
 void client_on_stream_writable(void *tctx, struct quic_conn_t *conn, uint64_t stream_id) {
     QuicClient *client = tctx;
 
-    pthread_mutex_lock(&client->stream_contexts_list_lock);
+    if (is_pipelined_stream(&client->pipelined_stream, stream_id)) {
+        write_pipelined_calls(&client->pipelined_stream, conn);
+        return;
+    }
 
-    QuicClientStreamContext *stream_context = find_stream_context(client->stream_contexts, stream_id);
+    QuicClientStreamContext *stream_context = find_stream_context(&client->stream_contexts, stream_id);
     if (stream_context == NULL) {
-        pthread_mutex_unlock(&client->stream_contexts_list_lock);
         return;
     }
 
@@ -187,31 +283,55 @@ void client_on_stream_writable(void *tctx, struct quic_conn_t *conn, uint64_t st
 
         stream_context->finished = true;
         stream_context->call_rpc_msg_successfully_sent = false;
-        kill_event_loop_thread(client);
+        complete_rpc(&stream_context->completion);
 
-        pthread_mutex_unlock(&client->stream_contexts_list_lock);
+        kill_event_loop_thread(client);
 
         return;
     }
 
-    if (stream_context->attempted_call_rpc_msg_send) {
-        pthread_mutex_unlock(&client->stream_contexts_list_lock);
+    if (stream_context->call_rpc_msg_successfully_sent || stream_context->finished) {
+        quic_stream_wantwrite(conn, stream_id, false);
         return;
     }
 
-    // send the serialized RpcMsg to the server as a single Record Marking record on stream 0
+    // the serialized RpcMsg is sent to the server as a single Record Marking record
     // TODO: (QNFS-37) implement time-outs + reconnections
-    int error_code =
-        send_rm_record_quic(conn, stream_id, stream_context->call_rpc_msg_buffer, stream_context->call_rpc_msg_size);
-    stream_context->attempted_call_rpc_msg_send = true;
-    stream_context->call_rpc_msg_successfully_sent = (error_code == 0);
+    if (!stream_context->attempted_call_rpc_msg_send) {
+        stream_context->attempted_call_rpc_msg_send = true;
 
-    quic_stream_wantwrite(conn, stream_id, false);
-    if (!stream_context->call_rpc_msg_successfully_sent) {
-        kill_event_loop_thread(client);
+        size_t rm_record_size;
+        uint8_t *rm_record = encode_rm_record_quic(stream_context->call_rpc_msg_buffer,
+                                                   stream_context->call_rpc_msg_size, &rm_record_size);
+        if (rm_record == NULL) {
+            quic_stream_wantwrite(conn, stream_id, false);
+
+            stream_context->finished = true;
+            complete_rpc(&stream_context->completion);
+
+            return;
+        }
+        free(stream_context->call_rpc_msg_buffer);
+        stream_context->call_rpc_msg_buffer = rm_record;
+        stream_context->call_rpc_msg_size = rm_record_size;
+        stream_context->num_call_bytes_written = 0;
+    }
+
+    // write as much of the record as the stream's flow control allows, and the rest on the next writable event
+    while (stream_context->num_call_bytes_written < stream_context->call_rpc_msg_size) {
+        ssize_t bytes_written = quic_stream_write(
+            conn, stream_id, stream_context->call_rpc_msg_buffer + stream_context->num_call_bytes_written,
+            stream_context->call_rpc_msg_size - stream_context->num_call_bytes_written, false);
+        if (bytes_written <= 0) {
+            quic_stream_wantwrite(conn, stream_id, true);
+            return;
+        }
+
+        stream_context->num_call_bytes_written += bytes_written;
     }
 
-    pthread_mutex_unlock(&client->stream_contexts_list_lock);
+    stream_context->call_rpc_msg_successfully_sent = true;
+    quic_stream_wantwrite(conn, stream_id, false);
 }
 
 void client_on_stream_closed(void *tctx, struct quic_conn_t *conn, uint64_t stream_id) {
@@ -223,33 +343,14 @@ void client_on_stream_closed(void *tctx, struct quic_conn_t *conn, uint64_t stre
 int client_on_packets_send(void *psctx, struct quic_packet_out_spec_t *pkts, unsigned int count) {
     QuicClient *client = psctx;
 
-    unsigned int sent_count = 0;
-    for (int i = 0; i < count; i++) {
-        struct quic_packet_out_spec_t *pkt = pkts + i;
-        for (int j = 0; j < (*pkt).iovlen; j++) {
-            const struct iovec *iov = pkt->iov + j;
-            ssize_t sent = sendto(client->socket_fd, iov->iov_base, iov->iov_len, 0, (struct sockaddr *)pkt->dst_addr,
-                                  pkt->dst_addr_len);
-            // we've sent a packet of 'sent' bytes
-
-            if (sent != iov->iov_len) {
-                if ((errno == EWOULDBLOCK) || (errno == EAGAIN)) {
-                    fprintf(stderr, "send would block, already sent: %d\n", sent_count);
-                    return sent_count;
-                }
-                return -1;
-            }
-            sent_count++;
-        }
-    }
-
-    return sent_count;
+    return send_quic_packets_batched(&client->udp_batching_context, pkts, count);
 }
 
 struct quic_transport_methods_t quic_transport_methods = {
     .on_conn_created = client_on_conn_created,
     .on_conn_established = client_on_conn_established,
     .on_conn_closed = client_on_conn_closed,
+    .on_new_token = client_on_new_token,
     .on_stream_created = client_on_stream_created,
     .on_stream_readable = client_on_stream_readable,
     .on_stream_writable = client_on_stream_writable,
@@ -267,6 +368,15 @@ struct quic_packet_send_methods_t quic_packet_send_methods = {
 void process_connections(QuicClient *client) {
     quic_endpoint_process_connections(client->quic_endpoint);
 
+    // a resumed connection can carry RPCs as 0-RTT data as soon as the first flight is sent
+    if (!client->early_data_available && !client->connection_established && client->quic_connection != NULL &&
+        quic_conn_is_in_early_data(client->quic_connection)) {
+        pthread_mutex_lock(&client->connection_established_lock);
+        client->early_data_available = true;
+        pthread_cond_broadcast(&client->connection_established_condition_variable);
+        pthread_mutex_unlock(&client->connection_established_lock);
+    }
+
     double timeout = quic_endpoint_timeout(client->quic_endpoint) / 1e3f;
     if (timeout < 0.0001) {
         timeout = 0.0001;
@@ -275,41 +385,35 @@ void process_connections(QuicClient *client) {
     ev_timer_again(client->event_loop, &client->timer);
 }
 
+/*
+ * Forwards a single datagram received via the underlying UDP socket to the client's QUIC endpoint.
+ */
+static void forward_datagram_to_endpoint(uint8_t *datagram, size_t datagram_size, struct sockaddr *peer_addr,
+                                         socklen_t peer_addr_len, void *handler_context) {
+    QuicClient *client = handler_context;
+
+    quic_packet_info_t quic_packet_info = {
+        .src = peer_addr,
+        .src_len = peer_addr_len,
+        .dst = (struct sockaddr *)&client->local_addr,
+        .dst_len = client->local_addr_len,
+    };
+
+    int error_code = quic_endpoint_recv(client->quic_endpoint, datagram, datagram_size, &quic_packet_info);
+    if (error_code != 0) {
+        fprintf(stderr, "forward_datagram_to_endpoint: recv failed with error %d\n", error_code);
+    }
+}
+
 /*
  * Forwards packets received (via the underlying UDP socket) to the client's QUIC endpoint.
  */
 void read_callback(EV_P_ ev_io *w, int revents) {
     QuicClient *client = w->data;
-    static uint8_t buf[READ_BUF_SIZE];
-
-    while (true) {
-        struct sockaddr_storage peer_addr;
-        socklen_t peer_addr_len = sizeof(peer_addr);
-        memset(&peer_addr, 0, peer_addr_len);
-
-        ssize_t read = recvfrom(client->socket_fd, buf, sizeof(buf), 0, (struct sockaddr *)&peer_addr, &peer_addr_len);
-        if (read < 0) {
-            if ((errno == EWOULDBLOCK) || (errno == EAGAIN)) {
-                // read would block, i.e. all data available now has been forwarded to QUIC
-                break;
-            }
 
-            fprintf(stderr, "read_callback: failed to read\n");
-            return;
-        }
-
-        quic_packet_info_t quic_packet_info = {
-            .src = (struct sockaddr *)&peer_addr,
-            .src_len = peer_addr_len,
-            .dst = (struct sockaddr *)&client->local_addr,
-            .dst_len = client->local_addr_len,
-        };
-
-        int error_code = quic_endpoint_recv(client->quic_endpoint, buf, read, &quic_packet_info);
-        if (error_code != 0) {
-            fprintf(stderr, "read_callback: recv failed with error %d\n", error_code);
-            continue;
-        }
+    if (receive_udp_datagrams_batched(&client->udp_batching_context, forward_datagram_to_endpoint, client) > 0) {
+        fprintf(stderr, "read_callback: failed to read\n");
+        return;
     }
 
     ev_async_send(client->event_loop, &client->process_connections_async_watcher);
@@ -352,36 +456,42 @@ void async_shutdown_loop_callback(EV_P_ ev_async *w, int revents) {
 }
 
 /*
- * Progresses the event loop until the QUIC connection has been established.
+ * Progresses the event loop until the QUIC connection has been established. If 'allow_early_data' is true,
+ * also returns as soon as a resumed connection can send 0-RTT data, before the handshake completes.
  *
  * Returns 0 on success and > 0 on failure.
  */
-int wait_for_connection_establishment(QuicClient *quic_client) {
+int wait_for_connection_establishment(QuicClient *quic_client, bool allow_early_data) {
     if (quic_client == NULL) {
         return 1;
     }
 
-    if (quic_client->connection_established) {
-        return 0;
-    }
+    pthread_mutex_lock(&quic_client->connection_established_lock);
 
-    // spawn the event loop thread
-    if (pthread_create(&quic_client->event_loop_thread, NULL, event_loop_runner, quic_client) != 0) {
-        fprintf(stderr, "wait_for_connection_establishment: failed to create the event loop thread\n");
+    // spawn the event loop thread, only once even if RPCs are sent from several threads
+    if (!quic_client->successfully_created_event_loop_thread) {
+        if (pthread_create(&quic_client->event_loop_thread, NULL, event_loop_runner, quic_client) != 0) {
+            fprintf(stderr, "wait_for_connection_establishment: failed to create the event loop thread\n");
 
-        quic_client->successfully_created_event_loop_thread = false;
+            pthread_mutex_unlock(&quic_client->connection_established_lock);
 
-        return 2;
+            return 2;
+        }
+        quic_client->successfully_created_event_loop_thread = true;
     }
-    quic_client->successfully_created_event_loop_thread = true;
 
-    pthread_mutex_lock(&quic_client->connection_established_lock);
-    while (!quic_client->connection_established) {
+    while (!quic_client->connection_established && !(allow_early_data && quic_client->early_data_available)) {
         pthread_cond_wait(&quic_client->connection_established_condition_variable,
                           &quic_client->connection_established_lock);
     }
+    bool connection_established = quic_client->connection_established;
     pthread_mutex_unlock(&quic_client->connection_established_lock);
 
+    // RPCs sent as 0-RTT data use auxiliary streams, the main stream is only created once the handshake completes
+    if (!connection_established) {
+        return 0;
+    }
+
     if (quic_client->main_stream == NULL) {
         return 3;
     }
@@ -390,9 +500,9 @@ int wait_for_connection_establishment(QuicClient *quic_client) {
 }
 
 /*
- * Given a stream context, uses its condition variable to wait for the
- * RPC reply to to be received for the RPC call that is being or has been
- * sent on this stream.
+ * Given a submitted stream context, sleeps on its completion until a stream has been allocated for it,
+ * its RPC call has been sent on that stream and the RPC reply has been received, or one of these steps
+ * has failed.
  *
  * Returns 0 on success and > 0 on failure.
  */
@@ -401,11 +511,12 @@ int wait_for_rpc_reply(QuicClientStreamContext *stream_context) {
         return 1;
     }
 
-    pthread_mutex_lock(&stream_context->reply_lock);
-    while (!stream_context->finished) {
-        pthread_cond_wait(&stream_context->reply_cond, &stream_context->reply_lock);
+    wait_for_rpc_completion(&stream_context->completion);
+
+    if (!stream_context->successfully_allocated_stream) {
+        fprintf(stderr, "wait_for_rpc_reply: failed to allocate a stream\n");
+        return 4;
     }
-    pthread_mutex_unlock(&stream_context->reply_lock);
 
     if (!stream_context->call_rpc_msg_successfully_sent) {
         fprintf(stderr, "wait_for_rpc_reply: failed to send RPC call message\n");
@@ -442,92 +553,89 @@ Rpc__RpcMsg *execute_rpc_call_quic(RpcConnectionContext *rpc_connection_context,
         return NULL;
     }
 
-    QuicClient *client = rpc_connection_context->transport_connection->quic_client;
-    if (client == NULL) {
-        return NULL;
-    }
-
-    if (call_rpc_msg == NULL) {
+    QuicClientPool *quic_client_pool = rpc_connection_context->transport_connection->quic_client_pool;
+    if (quic_client_pool == NULL) {
         return NULL;
     }
 
-    int error_code = wait_for_connection_establishment(client);
-    if (error_code != 0) {
-        fprintf(stderr, "execute_rpc_call_quic: failed to wait for connection establishment\n");
+    if (call_rpc_msg == NULL || call_rpc_msg->cbody == NULL) {
         return NULL;
     }
 
     // serialize the RpcMsg to be sent
-    size_t rpc_msg_size = rpc__rpc_msg__get_packed_size(call_rpc_msg);
+    size_t rpc_msg_size = get_rpc_msg_packed_size(rpc_connection_context->rpc_codec, call_rpc_msg);
     uint8_t *rpc_msg_buffer = malloc(sizeof(uint8_t) * rpc_msg_size);
-    rpc__rpc_msg__pack(call_rpc_msg, rpc_msg_buffer);
-
-    QuicClientStreamContext *stream_context =
-        create_client_stream_context(client, rpc_msg_buffer, rpc_msg_size, use_auxiliary_stream);
-    if (stream_context == NULL) {
-        fprintf(stderr, "client_on_conn_established: failed to create a stream context\n");
+    pack_rpc_msg(rpc_connection_context->rpc_codec, call_rpc_msg, rpc_msg_buffer);
+
+    // send the RPC over the least loaded connection of the pool it may use
+    uint32_t program_number = call_rpc_msg->cbody->prog, procedure_number = call_rpc_msg->cbody->proc;
+    size_t rpc_cost =
+        get_rpc_cost(program_number, procedure_number, rpc_msg_size, rpc_connection_context->transfer_size);
+    QuicClient *client =
+        acquire_quic_client(quic_client_pool, is_bulk_rpc(program_number, procedure_number), rpc_cost);
+    if (client == NULL) {
+        free(rpc_msg_buffer);
         return NULL;
     }
 
-    pthread_mutex_lock(&client->stream_allocation_queue_lock);
-    error_code = push_to_stream_allocation_queue(stream_context, &client->stream_allocation_queue_back,
-                                                 &client->stream_allocation_queue_front);
-    pthread_mutex_unlock(&client->stream_allocation_queue_lock);
+    bool allow_early_data = use_auxiliary_stream && is_early_data_rpc(program_number, procedure_number);
+    int error_code = wait_for_connection_establishment(client, allow_early_data);
+    if (error_code != 0) {
+        fprintf(stderr, "execute_rpc_call_quic: failed to wait for connection establishment\n");
 
-    // make the event loop thread execute the stream allocator callback, and wait for it to finish
-    ev_async_send(client->event_loop, &client->stream_allocator_async_watcher);
+        free(rpc_msg_buffer);
+        release_quic_client(client, rpc_cost);
 
-    pthread_mutex_lock(&stream_context->stream_allocator_lock);
-    while (!stream_context->stream_allocation_finished) {
-        pthread_cond_wait(&stream_context->stream_allocator_condition_variable, &stream_context->stream_allocator_lock);
+        return NULL;
     }
-    pthread_mutex_unlock(&stream_context->stream_allocator_lock);
 
-    if (!stream_context->successfully_allocated_stream) {
-        fprintf(stderr, "client_on_conn_established: failed to allocate a stream\n");
+    QuicClientStreamContext *stream_context =
+        create_client_stream_context(client, rpc_msg_buffer, rpc_msg_size, use_auxiliary_stream,
+                                     get_rpc_priority_class(program_number, procedure_number));
+    if (stream_context == NULL) {
+        fprintf(stderr, "execute_rpc_call_quic: failed to create a stream context\n");
 
-        free_stream_context(stream_context);
+        free(rpc_msg_buffer);
+        release_quic_client(client, rpc_cost);
 
         return NULL;
     }
+    stream_context->pipelinable = QUIC_PIPELINED_SMALL_RPCS && use_auxiliary_stream &&
+                                  is_pipelinable_rpc(program_number, procedure_number, rpc_msg_size);
 
-    pthread_mutex_lock(&client->stream_contexts_list_lock);
-    error_code = add_stream_context(stream_context, &client->stream_contexts);
-    pthread_mutex_unlock(&client->stream_contexts_list_lock);
-    if (error_code != 0) {
-        fprintf(stderr, "client_on_conn_established: failed to add stream context to collection of stream contexts\n");
+    // hand the RPC over to the event loop thread, which allocates a stream for it and sends it
+    error_code = submit_stream_context(client, stream_context);
+    if (error_code > 0) {
+        fprintf(stderr, "execute_rpc_call_quic: failed to submit the stream context\n");
 
         free_stream_context(stream_context);
+        release_quic_client(client, rpc_cost);
 
         return NULL;
     }
 
-    Rpc__RpcMsg *ret;
-
-    // make the event loop thread execute the process connections callback
-    ev_async_send(client->event_loop, &client->process_connections_async_watcher);
+    Rpc__RpcMsg *ret = NULL;
 
     error_code = wait_for_rpc_reply(stream_context);
-    if (error_code != 0) {
-        ret = NULL;
-        goto cleanup;
+    if (error_code == 0) {
+        ret = deserialize_rpc_msg(rpc_connection_context->rpc_codec,
+                                  stream_context->rm_receiving_context->accumulated_payloads.data,
+                                  stream_context->rm_receiving_context->accumulated_payloads.size, call_rpc_msg->cbody);
     }
 
-    Rpc__RpcMsg *reply_rpc_msg = deserialize_rpc_msg(stream_context->rm_receiving_context->accumulated_payloads,
-                                                     stream_context->rm_receiving_context->accumulated_payloads_size);
-
-    ret = reply_rpc_msg;
+    // replies on the pipelined stream are matched to calls by their order, which the xid confirms
+    if (ret != NULL && ret->xid != call_rpc_msg->xid) {
+        fprintf(stderr, "execute_rpc_call_quic: received a reply with xid %u to the call with xid %u\n", ret->xid,
+                call_rpc_msg->xid);
 
-cleanup:
-    Stream *allocated_stream = stream_context->allocated_stream;
-    pthread_mutex_lock(&client->stream_contexts_list_lock);
-    remove_stream_context(&client->stream_contexts, stream_context->allocated_stream->id);
-    if (client->stream_contexts == NULL) {
-        pthread_cond_signal(&client->stream_contexts_condition_variable);
+        rpc__rpc_msg__free_unpacked(ret, NULL);
+        ret = NULL;
     }
-    pthread_mutex_unlock(&client->stream_contexts_list_lock);
 
-    allocated_stream->stream_in_use = false;
+    // let the event loop thread release the stream and deallocate the stream context
+    retire_stream_context(client, stream_context);
+
+    release_quic_client(client, rpc_cost);
 
     return ret;
 }
@@ -555,7 +663,10 @@ Rpc__RpcMsg *invoke_rpc_remote_quic(RpcConnectionContext *rpc_connection_context
     call_body.vers = program_version;
     call_body.proc = procedure_number;
 
-    call_body.credential = rpc_connection_context->credential;
+    // once the server has handed out a short handle for the credential, the handle is sent in its place
+    Rpc__OpaqueAuth short_credential;
+    uint8_t short_handle[MAX_AUTH_SHORT_SIZE];
+    call_body.credential = get_rpc_call_credential(rpc_connection_context, &short_credential, short_handle);
     call_body.verifier = rpc_connection_context->verifier;
 
     call_body.params = &parameters;
@@ -567,6 +678,15 @@ Rpc__RpcMsg *invoke_rpc_remote_quic(RpcConnectionContext *rpc_connection_context
     call_rpc_msg.cbody = &call_body;
 
     Rpc__RpcMsg *reply_rpc_msg = execute_rpc_call_quic(rpc_connection_context, &call_rpc_msg, use_auxiliary_stream);
+    if (update_auth_short_handle(rpc_connection_context, reply_rpc_msg, call_body.credential == &short_credential)) {
+        // the server does not know the short handle (anymore), so the call is sent again with the full credential
+        rpc__rpc_msg__free_unpacked(reply_rpc_msg, NULL);
+
+        call_body.credential = rpc_connection_context->credential;
+        call_rpc_msg.xid = generate_rpc_xid();
+        reply_rpc_msg = execute_rpc_call_quic(rpc_connection_context, &call_rpc_msg, use_auxiliary_stream);
+        update_auth_short_handle(rpc_connection_context, reply_rpc_msg, false);
+    }
 
     return reply_rpc_msg;
 }
\ No newline at end of file
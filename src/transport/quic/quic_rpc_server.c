@@ -4,214 +4,92 @@
  *  Define QUIC Nfs+Mount server state.
  */
 
-struct QuicServer quic_server;
+struct QuicServer quic_server_workers[QUIC_SERVER_MAX_WORKERS];
+int num_quic_server_workers = 0;
 
 pthread_mutex_t quic_server_cleanup_mutex = PTHREAD_MUTEX_INITIALIZER;
 bool quic_server_resources_released = false;
 
+// shared by all workers, so that a session ticket issued by one worker can be used to resume with any other
+static uint8_t session_ticket_key[QUIC_SESSION_TICKET_KEY_SIZE];
+
 /*
- * Sends the given ReplyBody back to the RPC client in a RpcMsg, over the stream with the given ID in the
- * given QUIC connection.
+ * Where the replies to an RPC call received over QUIC go - the stream in the QUIC connection the call arrived on, the
+ * xid of the call, and the priority class of its procedure.
+ */
+typedef struct QuicReplyDestination {
+    struct quic_conn_t *conn;
+    uint64_t stream_id;
+    uint32_t xid;
+    RpcPriorityClass priority_class;
+} QuicReplyDestination;
+
+/*
+ * Sends the given ReplyBody back to the RPC client in a RpcMsg with the xid of the call it replies to, over
+ * the stream of the given QuicReplyDestination. The reply is handed to the connection's reply scheduler, which
+ * writes it to the stream with the priority of the call's procedure class - except for rejected replies, which are
+ * small, and without which the client can't make progress, so they are written with the priority of metadata.
  *
  * Returns 0 on success, and > 0 on failure.
  */
-int send_rpc_reply_body_quic(struct quic_conn_t *conn, uint64_t stream_id, Rpc__ReplyBody *reply_body) {
+static int send_rpc_reply_body_quic(void *reply_destination, Rpc__ReplyBody *reply_body) {
+    QuicReplyDestination *quic_reply_destination = reply_destination;
+    struct quic_conn_t *conn = quic_reply_destination->conn;
+    uint64_t stream_id = quic_reply_destination->stream_id;
+
+    QuicServerConnectionContext *connection_context = quic_conn_context(conn);
+    if (connection_context == NULL) {
+        fprintf(stderr, "send_rpc_reply_body_quic: no connection context for the stream %ld\n", stream_id);
+        return 1;
+    }
+
     Rpc__RpcMsg rpc_msg = RPC__RPC_MSG__INIT;
-    rpc_msg.xid = generate_rpc_xid();
+    rpc_msg.xid = quic_reply_destination->xid; // the client matches the reply to its call by the xid
     rpc_msg.mtype = RPC__MSG_TYPE__REPLY;
     rpc_msg.body_case = RPC__RPC_MSG__BODY_RBODY; // this body_case enum is not actually sent over the network
     rpc_msg.rbody = reply_body;
 
-    // serialize the RpcMsg
-    size_t rpc_msg_size = rpc__rpc_msg__get_packed_size(&rpc_msg);
-    uint8_t *rpc_msg_buffer = malloc(rpc_msg_size);
-    rpc__rpc_msg__pack(&rpc_msg, rpc_msg_buffer);
-
-    // send the serialized RpcMsg back to the client as a single Record Marking record
-    int error_code = send_rm_record_quic(conn, stream_id, rpc_msg_buffer, rpc_msg_size);
-    free(rpc_msg_buffer);
+    // serialize the RpcMsg around the procedure results, if it has any
+    EncodedRpcMsg encoded_rpc_msg;
+    int error_code = encode_rpc_msg(get_rpc_call_codec(), &rpc_msg, &encoded_rpc_msg);
     if (error_code > 0) {
-        return 1;
+        return 2;
     }
 
-    return 0;
-}
-
-/*
- * Sends the given AcceptedReply back to the RPC client, over the stream with the given ID in the
- * given QUIC connection.
- *
- * Returns 0 on success, and > 0 on failure.
- */
-int send_rpc_accepted_reply_message_quic(struct quic_conn_t *conn, uint64_t stream_id,
-                                         Rpc__AcceptedReply *accepted_reply) {
-    Rpc__ReplyBody reply_body = RPC__REPLY_BODY__INIT;
-    reply_body.stat = RPC__REPLY_STAT__MSG_ACCEPTED;
-    reply_body.reply_case = RPC__REPLY_BODY__REPLY_AREPLY; // reply_case is not actually transfered over network
-    reply_body.areply = accepted_reply;
-
-    return send_rpc_reply_body_quic(conn, stream_id, &reply_body);
-}
-
-/*
- * Sends the given RejectedReply back to the RPC client, over the stream with the given ID in the
- * given QUIC connection.
- *
- * Returns 0 on success, and > 0 on failure.
- */
-int send_rpc_rejected_reply_message_quic(struct quic_conn_t *conn, uint64_t stream_id,
-                                         Rpc__RejectedReply *rejected_reply) {
-    Rpc__ReplyBody reply_body = RPC__REPLY_BODY__INIT;
-    reply_body.stat = RPC__REPLY_STAT__MSG_DENIED;
-    reply_body.reply_case = RPC__REPLY_BODY__REPLY_RREPLY; // reply_case is not actually transfered over network
-    reply_body.rreply = rejected_reply;
-
-    return send_rpc_reply_body_quic(conn, stream_id, &reply_body);
-}
-
-/*
- * Prints out the given error message, and sends an AUTH_ERROR RejectedReply over the stream with the
- * given ID in the given QUIC connection.
- *
- * Returns 0 on success and > 0 on failure.
- */
-int send_auth_error_rejected_reply_quic(struct quic_conn_t *conn, uint64_t stream_id, char *error_msg,
-                                        Rpc__AuthStat auth_stat) {
-    fprintf(stdout, "%s", error_msg);
-
-    Rpc__RejectedReply *rejected_reply = create_auth_error_rejected_reply(auth_stat);
+    // send the serialized RpcMsg back to the client as a single Record Marking record - the reply scheduler owns
+    // the record until it is written out, so this is the one copy the reply goes through
+    size_t rm_record_size;
+    uint8_t *rm_record = encode_rm_record_quic(encoded_rpc_msg.data, encoded_rpc_msg.size, &rm_record_size);
+    free_encoded_rpc_msg(&encoded_rpc_msg);
+    if (rm_record == NULL) {
+        return 2;
+    }
 
-    int error_code = send_rpc_rejected_reply_message_quic(conn, stream_id, rejected_reply);
-    free_rejected_reply(rejected_reply);
+    RpcPriorityClass priority_class = reply_body->stat == RPC__REPLY_STAT__MSG_DENIED
+                                          ? RPC_PRIORITY_CLASS_METADATA
+                                          : quic_reply_destination->priority_class;
+    error_code = schedule_reply(&connection_context->reply_scheduler, conn, stream_id, priority_class, rm_record,
+                                rm_record_size);
     if (error_code > 0) {
-        fprintf(stdout, "Server failed to send AUTH_ERROR RejectedReply\n");
-        return 1;
+        return 3;
     }
 
     return 0;
 }
 
 /*
- * Validates the 'credential' and 'verifier' OpaqueAuth pair from some RPC CallBody, to check that they have the correct
- * structure (no NULL fields) and correspond to a supported authentication flavor.
- *
- * Returns < 0 on failure.
- * On success, returns 0 if the credential and verifier pair are correct, and if the credential and verifier pair are
- * incorrect, returns > 0 and sends an appropriate RejectedReply over the stream with the given ID in the given QUIC
+ * Decodes the given serialized RPC call, runs it, and sends an RPC reply on the given stream in the given QUIC
  * connection.
- */
-int validate_credential_and_verifier_quic(struct quic_conn_t *conn, uint64_t stream_id, Rpc__OpaqueAuth *credential,
-                                          Rpc__OpaqueAuth *verifier) {
-    int error_code;
-
-    if (credential == NULL) {
-        error_code = send_auth_error_rejected_reply_quic(conn, stream_id,
-                                                         "Server received an RPC call with 'credential' being NULL.\n",
-                                                         RPC__AUTH_STAT__AUTH_BADCRED);
-        return error_code > 0 ? -1 : 1;
-    }
-    if (credential->flavor == RPC__AUTH_FLAVOR__AUTH_NONE) {
-        if (credential->body_case != RPC__OPAQUE_AUTH__BODY_EMPTY) {
-            error_code =
-                send_auth_error_rejected_reply_quic(conn, stream_id,
-                                                    "Server received an RPC call with AUTH_NONE credential, with "
-                                                    "inconsistent credential->flavor and credential->body_case.\n",
-                                                    RPC__AUTH_STAT__AUTH_BADCRED);
-            return error_code > 0 ? -1 : 1;
-        }
-        if (credential->empty == NULL) {
-            error_code = send_auth_error_rejected_reply_quic(
-                conn, stream_id,
-                "Server received an RPC call with AUTH_NONE credential, with credential->empty being NULL.\n",
-                RPC__AUTH_STAT__AUTH_BADCRED);
-            return error_code > 0 ? -1 : 1;
-        }
-    } else if (credential->flavor == RPC__AUTH_FLAVOR__AUTH_SYS) {
-        if (credential->body_case != RPC__OPAQUE_AUTH__BODY_AUTH_SYS) {
-            error_code =
-                send_auth_error_rejected_reply_quic(conn, stream_id,
-                                                    "Server received an RPC call with AUTH_SYS credential, with "
-                                                    "inconsistent credential->flavor and credential->body_case.\n",
-                                                    RPC__AUTH_STAT__AUTH_BADCRED);
-            return error_code > 0 ? -1 : 1;
-        }
-
-        if (credential->auth_sys == NULL) {
-            error_code = send_auth_error_rejected_reply_quic(
-                conn, stream_id,
-                "Server received an RPC call with AUTH_SYS credential, with credential->auth_sys being NULL.\n",
-                RPC__AUTH_STAT__AUTH_BADCRED);
-            return error_code > 0 ? -1 : 1;
-        }
-        Rpc__AuthSysParams *authsysparams = credential->auth_sys;
-
-        if (authsysparams->machinename == NULL) {
-            error_code = send_auth_error_rejected_reply_quic(conn, stream_id,
-                                                             "Server received an RPC call with AUTH_SYS credential, "
-                                                             "with credential->auth_sys->machinename being NULL.\n",
-                                                             RPC__AUTH_STAT__AUTH_BADCRED);
-            return error_code > 0 ? -1 : 1;
-        }
-        if (authsysparams->gids == NULL) {
-            error_code = send_auth_error_rejected_reply_quic(
-                conn, stream_id,
-                "Server received an RPC call with AUTH_SYS credential, with credential->auth_sys->gids being NULL.\n",
-                RPC__AUTH_STAT__AUTH_BADCRED);
-            return error_code > 0 ? -1 : 1;
-        }
-    } else {
-        // TODO (QNFS-52): Implement AUTH_SHORT
-        error_code = send_auth_error_rejected_reply_quic(
-            conn, stream_id, "Server received an RPC call with unsupported authentication flavor %d.\n",
-            RPC__AUTH_STAT__AUTH_BADCRED);
-        return error_code > 0 ? -1 : 1;
-    }
-
-    if (verifier == NULL) {
-        error_code = send_auth_error_rejected_reply_quic(
-            conn, stream_id, "Server received an RPC call with 'verifier' being NULL.\n", RPC__AUTH_STAT__AUTH_BADVERF);
-        return error_code > 0 ? -1 : 1;
-    }
-    if (verifier->flavor == RPC__AUTH_FLAVOR__AUTH_NONE) {
-        if (verifier->body_case != RPC__OPAQUE_AUTH__BODY_EMPTY) {
-            error_code =
-                send_auth_error_rejected_reply_quic(conn, stream_id,
-                                                    "Server received an RPC call with AUTH_NONE verifier, with "
-                                                    "inconsistent verifier->flavor and verifier->body_case.\n",
-                                                    RPC__AUTH_STAT__AUTH_BADVERF);
-            return error_code > 0 ? -1 : 1;
-        }
-        if (verifier->empty == NULL) {
-            error_code = send_auth_error_rejected_reply_quic(
-                conn, stream_id,
-                "Server received an RPC call with AUTH_NONE verifier, with verifier->empty being NULL.\n",
-                RPC__AUTH_STAT__AUTH_BADVERF);
-            return error_code > 0 ? -1 : 1;
-        }
-    } else {
-        // in AUTH_NONE, AUTH_SYS, and AUTH_SHORT, verifier in CallBody always has AUTH_NONE flavor
-        error_code = send_auth_error_rejected_reply_quic(
-            conn, stream_id, "Server received an RPC call with 'verifier' having unsupported flavor.\n",
-            RPC__AUTH_STAT__AUTH_BADVERF);
-        return error_code > 0 ? -1 : 1;
-    }
-
-    return 0;
-}
-
-/*
- * Given the serialized RPC call received from a client on the given stream in the given QUIC connection,
- * processes that RPC, and sends an RPC reply on the same stream.
  *
  * Returns 0 on success and > 0 on failure.
  */
-int handle_client_quic(uint8_t *rpc_call_buffer, size_t rpc_call_buffer_size, struct quic_conn_t *conn,
-                       uint64_t stream_id) {
-    if (rpc_call_buffer == NULL) {
-        return 1;
-    }
+static int serve_rpc_call_quic(uint8_t *rpc_call_buffer, size_t rpc_call_buffer_size, struct quic_conn_t *conn,
+                               uint64_t stream_id) {
+    // the call is replied to in the codec it arrived in
+    RpcCodec codec = detect_rpc_codec(rpc_call_buffer, rpc_call_buffer_size);
+    set_rpc_call_codec(codec);
 
-    Rpc__RpcMsg *rpc_call = deserialize_rpc_msg(rpc_call_buffer, rpc_call_buffer_size);
+    Rpc__RpcMsg *rpc_call = decode_rpc_msg_in_place(codec, rpc_call_buffer, rpc_call_buffer_size);
     if (rpc_call == NULL) {
         return 2; // invalid RPC received, no reply given
     }
@@ -227,13 +105,21 @@ int handle_client_quic(uint8_t *rpc_call_buffer, size_t rpc_call_buffer_size, st
         return 4; // invalid RPC received, no reply given
     }
 
+    QuicReplyDestination reply_destination = {.conn = conn,
+                                              .stream_id = stream_id,
+                                              .xid = rpc_call->xid,
+                                              .priority_class =
+                                                  get_rpc_priority_class(call_body->prog, call_body->proc)};
+    RpcReplySender reply_sender = {.send_reply_body = send_rpc_reply_body_quic,
+                                   .reply_destination = &reply_destination};
+
     // check RPC version
     if (call_body->rpcvers != 2) {
         fprintf(stdout, "Server received an RPC call with RPC version not equal to 2.\n");
 
         Rpc__RejectedReply *rejected_reply = create_rpc_mismatch_rejected_reply(2, 2);
 
-        int error_code = send_rpc_rejected_reply_message_quic(conn, stream_id, rejected_reply);
+        int error_code = send_rpc_rejected_reply_message(&reply_sender, rejected_reply);
         free_rejected_reply(rejected_reply);
         if (error_code > 0) {
             fprintf(stdout, "Server failed to send RPC mismatch RejectedReply\n");
@@ -244,15 +130,22 @@ int handle_client_quic(uint8_t *rpc_call_buffer, size_t rpc_call_buffer_size, st
     }
 
     // check authentication fields
-    int error_code = validate_credential_and_verifier_quic(conn, stream_id, call_body->credential, call_body->verifier);
+    int error_code = validate_credential_and_verifier(&reply_sender, call_body->credential, call_body->verifier);
     if (error_code != 0) {
         return 6;
     }
     log_rpc_call_body_info(call_body);
-    if (call_body->credential->flavor == RPC__AUTH_FLAVOR__AUTH_NONE && call_body->proc != 0) {
+    // a short credential is replaced by the AUTH_SYS credential it stands for
+    Rpc__OpaqueAuth *credential = resolve_rpc_call_credential(call_body->credential);
+    if (credential == NULL) {
+        return send_auth_error_rejected_reply(
+            &reply_sender, "Server received an RPC call with an AUTH_SHORT credential it does not know.\n",
+            RPC__AUTH_STAT__AUTH_REJECTEDCRED);
+    }
+    if (credential->flavor == RPC__AUTH_FLAVOR__AUTH_NONE && call_body->proc != 0) {
         // only NULL procedure is allowed to use AUTH_NONE flavor
-        return send_auth_error_rejected_reply_quic(
-            conn, stream_id,
+        return send_auth_error_rejected_reply(
+            &reply_sender,
             "Server received an RPC call with authentication flavor AUTH_NONE for a non-NULL procedure.\n",
             RPC__AUTH_STAT__AUTH_TOOWEAK);
     }
@@ -261,10 +154,13 @@ int handle_client_quic(uint8_t *rpc_call_buffer, size_t rpc_call_buffer_size, st
     Google__Protobuf__Any *parameters = call_body->params;
 
     Rpc__AcceptedReply *accepted_reply = forward_rpc_call_to_program(
-        call_body->credential, call_body->verifier, call_body->prog, call_body->vers, call_body->proc, parameters);
-    rpc__rpc_msg__free_unpacked(rpc_call, NULL);
+        credential, call_body->verifier, call_body->prog, call_body->vers, call_body->proc, parameters);
+    if (credential != call_body->credential) {
+        free_opaque_auth(credential);
+    }
+    free_rpc_msg_decoded_in_place(rpc_call, rpc_call_buffer, rpc_call_buffer_size);
 
-    error_code = send_rpc_accepted_reply_message_quic(conn, stream_id, accepted_reply);
+    error_code = send_rpc_accepted_reply_message(&reply_sender, accepted_reply);
     free_accepted_reply(accepted_reply);
     if (error_code > 0) {
         fprintf(stdout, "Server failed to send AcceptedReply\n");
@@ -274,67 +170,175 @@ int handle_client_quic(uint8_t *rpc_call_buffer, size_t rpc_call_buffer_size, st
     return 0;
 }
 
+/*
+ * Given the serialized RPC call received from a client on the given stream in the given QUIC connection,
+ * processes that RPC, and sends an RPC reply on the same stream.
+ *
+ * Returns 0 on success and > 0 on failure.
+ */
+int handle_client_quic(uint8_t *rpc_call_buffer, size_t rpc_call_buffer_size, struct quic_conn_t *conn,
+                       uint64_t stream_id) {
+    if (rpc_call_buffer == NULL) {
+        return 1;
+    }
+
+    // everything built while serving the RPC is taken from the arena of this thread, and released at once afterwards
+    begin_rpc_arena();
+    int error_code = serve_rpc_call_quic(rpc_call_buffer, rpc_call_buffer_size, conn, stream_id);
+    end_rpc_arena();
+
+    return error_code;
+}
+
 /*
  * Server body implementation over QUIC.
  */
 
+/*
+ * Writes the name of the given QUIC connection at the given server worker, unique within the server process,
+ * to the given buffer of the given size.
+ */
+static void get_server_connection_name(struct QuicServer *server, struct quic_conn_t *conn, char *name,
+                                       size_t name_size) {
+    snprintf(name, name_size, "server_%d_worker_%d_conn_%lu", getpid(), server->worker_index, quic_conn_index(conn));
+}
+
+/*
+ * Reports the transport statistics of the given QUIC connection at the given server worker.
+ */
+static void report_server_connection_stats(struct QuicServer *server,
+                                           QuicServerConnectionContext *connection_context) {
+    TransportConnectionStats stats = {0};
+    collect_quic_connection_stats(connection_context->quic_connection, &stats);
+    stats.num_rpcs = connection_context->num_rpcs_received;
+    stats.flow_control_stalls = connection_context->reply_scheduler.num_flow_control_stalls;
+
+    char connection_name[64];
+    get_server_connection_name(server, connection_context->quic_connection, connection_name,
+                               sizeof(connection_name));
+    report_transport_connection_stats("quic", connection_name, &stats);
+}
+
 void server_on_conn_created(void *tctx, struct quic_conn_t *conn) {
+    struct QuicServer *server = tctx;
+
+    QuicServerConnectionContext *connection_context = create_server_connection_context(conn);
+    if (connection_context == NULL) {
+        fprintf(stderr, "server_on_conn_created: failed to create a connection context\n");
+        return;
+    }
+    add_server_connection_context(connection_context, &(server->connection_contexts));
+
+    quic_conn_set_context(conn, connection_context);
+
+    char connection_name[64];
+    get_server_connection_name(server, conn, connection_name, sizeof(connection_name));
+    if (enable_quic_qlog(conn, connection_name) > 0) {
+        fprintf(stderr, "server_on_conn_created: failed to enable qlog for the connection\n");
+    }
+    report_quic_transport_tuning(connection_name, &server->transport_tuning);
 }
 
 void server_on_conn_established(void *tctx, struct quic_conn_t *conn) {
 }
 
 void server_on_conn_closed(void *tctx, struct quic_conn_t *conn) {
+    struct QuicServer *server = tctx;
+
+    QuicServerConnectionContext *connection_context = quic_conn_context(conn);
+    if (connection_context == NULL) {
+        return;
+    }
+
+    // final statistics of the connection
+    report_server_connection_stats(server, connection_context);
+
+    unlink_server_connection_context(connection_context, &(server->connection_contexts));
+    free_server_connection_context(connection_context);
+
+    quic_conn_set_context(conn, NULL);
 }
 
 void server_on_stream_created(void *tctx, struct quic_conn_t *conn, uint64_t stream_id) {
 }
 
 void server_on_stream_readable(void *tctx, struct quic_conn_t *conn, uint64_t stream_id) {
-    struct QuicServer *server = tctx;
-
-    if (find_rm_receiving_context(conn, stream_id, server->rm_receiving_contexts) > 0) {
-        // this is a new stream, so create a RM receiving context for it
-        int error_code = add_new_rm_receiving_context(conn, stream_id, &(server->rm_receiving_contexts));
-        if (error_code > 0) {
-            fprintf(stderr, "server_on_stream_readable: failed to create a RM receiving context\n");
-            return;
-        }
+    QuicServerConnectionContext *connection_context = quic_conn_context(conn);
+    if (connection_context == NULL) {
+        fprintf(stderr, "server_on_stream_readable: no connection context for the readable stream %ld\n", stream_id);
+        return;
     }
 
     RecordMarkingReceivingContext *rm_receiving_context =
-        get_rm_receiving_context(conn, stream_id, server->rm_receiving_contexts);
+        get_or_create_server_rm_receiving_context(connection_context, stream_id);
     if (rm_receiving_context == NULL) {
         fprintf(stderr,
-                "server_on_stream_readable: failed to find the RM receiving context for the readable stream %ld\n",
+                "server_on_stream_readable: failed to get the RM receiving context for the readable stream %ld\n",
                 stream_id);
         return;
     }
 
-    int error_code = receive_available_bytes_quic(rm_receiving_context);
-    if (error_code > 0) {
-        fprintf(stderr, "server_on_stream_readable: failed to read available data from the readable stream %ld\n",
-                stream_id);
-        return;
-    }
+    // a client may pipeline several RPCs on one stream, so keep handling RPCs until no complete one is left
+    while (true) {
+        size_t previously_buffered_bytes = get_rm_receiving_context_buffered_bytes(rm_receiving_context);
+        int error_code = receive_available_bytes_quic(rm_receiving_context);
+        update_server_rm_receiving_bytes_buffered(connection_context, previously_buffered_bytes,
+                                                  get_rm_receiving_context_buffered_bytes(rm_receiving_context));
+        if (error_code > 0) {
+            fprintf(stderr,
+                    "server_on_stream_readable: failed to read available data from the readable stream %ld\n",
+                    stream_id);
+
+            // the state of the RPC being received on this stream can't be recovered
+            remove_server_rm_receiving_context(connection_context, stream_id);
+
+            return;
+        }
+
+        if (!rm_receiving_context->record_fully_received) {
+            return;
+        }
 
-    // we've received a complete RPC on this stream
-    if (rm_receiving_context->record_fully_received) {
-        error_code = handle_client_quic(rm_receiving_context->accumulated_payloads,
-                                        rm_receiving_context->accumulated_payloads_size, conn, stream_id);
+        // we've received a complete RPC on this stream
+        connection_context->num_rpcs_received++;
+
+        error_code = handle_client_quic(rm_receiving_context->accumulated_payloads.data,
+                                        rm_receiving_context->accumulated_payloads.size, conn, stream_id);
         if (error_code > 0) {
             fprintf(stderr, "failed to handle RPC call on stream %ld\n", stream_id);
         }
 
-        remove_rm_receiving_context(conn, stream_id, &(server->rm_receiving_contexts));
+        // keep the receiving context and its buffer for the next RPC the client sends on this stream
+        previously_buffered_bytes = get_rm_receiving_context_buffered_bytes(rm_receiving_context);
+        reset_rm_receiving_context_for_next_rm_record(rm_receiving_context);
+        update_server_rm_receiving_bytes_buffered(connection_context, previously_buffered_bytes,
+                                                  get_rm_receiving_context_buffered_bytes(rm_receiving_context));
     }
 }
 
 void server_on_stream_writable(void *tctx, struct quic_conn_t *conn, uint64_t stream_id) {
     quic_stream_wantwrite(conn, stream_id, false);
+
+    // this stream got flow control credit, write the scheduled replies (streams still blocked ask to write again)
+    QuicServerConnectionContext *connection_context = quic_conn_context(conn);
+    if (connection_context != NULL) {
+        write_scheduled_replies(&connection_context->reply_scheduler, conn);
+    }
 }
 
 void server_on_stream_closed(void *tctx, struct quic_conn_t *conn, uint64_t stream_id) {
+    QuicServerConnectionContext *connection_context = quic_conn_context(conn);
+    if (connection_context == NULL) {
+        return;
+    }
+
+    cancel_scheduled_replies(&connection_context->reply_scheduler, stream_id);
+
+    // release the receiving context of this stream, along with any partially received RPC (streams that never
+    // received any data have none)
+    if (lookup_server_rm_receiving_context(connection_context, stream_id) != NULL) {
+        remove_server_rm_receiving_context(connection_context, stream_id);
+    }
 }
 
 /*
@@ -343,27 +347,7 @@ void server_on_stream_closed(void *tctx, struct quic_conn_t *conn, uint64_t stre
 int server_on_packets_send(void *psctx, struct quic_packet_out_spec_t *pkts, unsigned int count) {
     struct QuicServer *server = psctx;
 
-    unsigned int sent_count = 0;
-    for (int i = 0; i < count; i++) {
-        struct quic_packet_out_spec_t *pkt = pkts + i;
-        for (int j = 0; j < (*pkt).iovlen; j++) {
-            const struct iovec *iov = pkt->iov + j;
-            ssize_t sent = sendto(server->socket_fd, iov->iov_base, iov->iov_len, 0, (struct sockaddr *)pkt->dst_addr,
-                                  pkt->dst_addr_len);
-            // we've sent a packet of 'sent' bytes
-
-            if (sent != iov->iov_len) {
-                if ((errno == EWOULDBLOCK) || (errno == EAGAIN)) {
-                    fprintf(stderr, "send would block, already sent: %d\n", sent_count);
-                    return sent_count;
-                }
-                return -1;
-            }
-            sent_count++;
-        }
-    }
-
-    return sent_count;
+    return send_quic_packets_batched(&server->udp_batching_context, pkts, count);
 }
 
 struct quic_tls_config_t *server_get_default_tls_config(void *ctx) {
@@ -410,41 +394,35 @@ static void process_connections(struct QuicServer *server) {
     ev_timer_again(server->event_loop, &server->timer);
 }
 
+/*
+ * Forwards a single datagram received via the underlying UDP socket to the server's QUIC endpoint.
+ */
+static void forward_datagram_to_endpoint(uint8_t *datagram, size_t datagram_size, struct sockaddr *peer_addr,
+                                         socklen_t peer_addr_len, void *handler_context) {
+    struct QuicServer *server = handler_context;
+
+    quic_packet_info_t quic_packet_info = {
+        .src = peer_addr,
+        .src_len = peer_addr_len,
+        .dst = (struct sockaddr *)&server->local_addr,
+        .dst_len = server->local_addr_len,
+    };
+
+    int error_code = quic_endpoint_recv(server->quic_endpoint, datagram, datagram_size, &quic_packet_info);
+    if (error_code != 0) {
+        fprintf(stderr, "forward_datagram_to_endpoint: recv failed with error %d\n", error_code);
+    }
+}
+
 /*
  * Forwards packets received (via the underlying UDP socket) to the server's QUIC endpoint.
  */
 static void read_callback(EV_P_ ev_io *w, int revents) {
     struct QuicServer *server = w->data;
-    static uint8_t buf[READ_BUF_SIZE];
-
-    while (true) {
-        struct sockaddr_storage peer_addr;
-        socklen_t peer_addr_len = sizeof(peer_addr);
-        memset(&peer_addr, 0, peer_addr_len);
-
-        ssize_t read = recvfrom(server->socket_fd, buf, sizeof(buf), 0, (struct sockaddr *)&peer_addr, &peer_addr_len);
-        if (read < 0) {
-            if ((errno == EWOULDBLOCK) || (errno == EAGAIN)) {
-                // read would block, i.e. all data available now has been forwarded to QUIC
-                break;
-            }
-
-            fprintf(stderr, "read_callback: failed to read\n");
-            return;
-        }
 
-        quic_packet_info_t quic_packet_info = {
-            .src = (struct sockaddr *)&peer_addr,
-            .src_len = peer_addr_len,
-            .dst = (struct sockaddr *)&server->local_addr,
-            .dst_len = server->local_addr_len,
-        };
-
-        int error_code = quic_endpoint_recv(server->quic_endpoint, buf, read, &quic_packet_info);
-        if (error_code != 0) {
-            fprintf(stderr, "read_callback: recv failed with error %d\n", error_code);
-            continue;
-        }
+    if (receive_udp_datagrams_batched(&server->udp_batching_context, forward_datagram_to_endpoint, server) > 0) {
+        fprintf(stderr, "read_callback: failed to read\n");
+        return;
     }
 
     process_connections(server);
@@ -456,6 +434,32 @@ static void timeout_callback(EV_P_ ev_timer *w, int revents) {
     process_connections(server);
 }
 
+/*
+ * Reports the transport statistics of all QUIC connections currently open at a worker, and the first worker also
+ * reports the RPC arena allocation totals.
+ */
+static void stats_timeout_callback(EV_P_ ev_timer *w, int revents) {
+    struct QuicServer *server = w->data;
+
+    for (QuicServerConnectionContext *connection_context = server->connection_contexts; connection_context != NULL;
+         connection_context = connection_context->next) {
+        report_server_connection_stats(server, connection_context);
+    }
+
+    // the arena and compression totals are shared by all workers, so only one of them reports them
+    if (server->worker_index == 0) {
+        report_rpc_arena_stats();
+        report_rpc_compression_stats();
+    }
+}
+
+/*
+ * Breaks the event loop of a worker, so that the worker thread terminates.
+ */
+static void async_shutdown_callback(EV_P_ ev_async *w, int revents) {
+    ev_break(EV_A_ EVBREAK_ALL);
+}
+
 /*
  * Logs all QUIC events.
  *
@@ -467,6 +471,8 @@ static void debug_log(const uint8_t *data, size_t data_len, void *argp) {
 
 /*
  * Creates an underlying UDP socket which can be used for sending QUIC packets.
+ *
+ * The socket is bound with SO_REUSEPORT, so that each server worker can bind its own socket to the same port.
  */
 static int create_socket(const char *host, const char *port, struct addrinfo **local, struct QuicServer *server) {
     const struct addrinfo hints = {.ai_family = PF_UNSPEC, .ai_socktype = SOCK_DGRAM, .ai_protocol = IPPROTO_UDP};
@@ -480,10 +486,17 @@ static int create_socket(const char *host, const char *port, struct addrinfo **l
         fprintf(stderr, "create_socket: failed to create socket\n");
         return 1;
     }
+    server->socket_fd = udp_socket;
+
     if (fcntl(udp_socket, F_SETFL, O_NONBLOCK) != 0) {
         fprintf(stderr, "create_socket: failed to make socket non-blocking\n");
         return 1;
     }
+    int enable = 1;
+    if (setsockopt(udp_socket, SOL_SOCKET, SO_REUSEPORT, &enable, sizeof(enable)) != 0) {
+        fprintf(stderr, "create_socket: failed to set SO_REUSEPORT on socket\n");
+        return 1;
+    }
     if (bind(udp_socket, (*local)->ai_addr, (*local)->ai_addrlen) < 0) {
         fprintf(stderr, "create_socket: failed to bind socket\n");
         return 1;
@@ -494,13 +507,187 @@ static int create_socket(const char *host, const char *port, struct addrinfo **l
         fprintf(stderr, "create_socket: failed to get local address of socket\n");
         return 1;
     };
-    server->socket_fd = udp_socket;
+
+    if (init_udp_batching_context(&server->udp_batching_context, udp_socket) > 0) {
+        fprintf(stderr, "create_socket: failed to set up batched I/O on socket\n");
+        return 1;
+    }
 
     return 0;
 }
 
 /*
- * Frees all resources used by the given QUIC server.
+ * Returns the number of QUIC server workers to run.
+ */
+static int get_num_quic_server_workers(void) {
+    long num_workers = QUIC_SERVER_NUM_WORKERS;
+    if (num_workers <= 0) {
+        num_workers = sysconf(_SC_NPROCESSORS_ONLN);
+    }
+
+    if (num_workers < 1) {
+        return 1;
+    }
+    if (num_workers > QUIC_SERVER_MAX_WORKERS) {
+        return QUIC_SERVER_MAX_WORKERS;
+    }
+
+    return num_workers;
+}
+
+/*
+ * Reads the session ticket key shared by all workers from QUIC_SESSION_TICKET_KEY_FILE, or generates a random one
+ * if the file doesn't exist - then sessions can only be resumed until the server restarts.
+ *
+ * Returns 0 on success and > 0 on failure.
+ */
+static int load_session_ticket_key(void) {
+    FILE *key_file = fopen(QUIC_SESSION_TICKET_KEY_FILE, "rb");
+    if (key_file != NULL) {
+        size_t key_len = fread(session_ticket_key, 1, QUIC_SESSION_TICKET_KEY_SIZE, key_file);
+        fclose(key_file);
+        if (key_len != QUIC_SESSION_TICKET_KEY_SIZE) {
+            fprintf(stderr, "load_session_ticket_key: %s must contain %d bytes\n", QUIC_SESSION_TICKET_KEY_FILE,
+                    QUIC_SESSION_TICKET_KEY_SIZE);
+            return 1;
+        }
+
+        return 0;
+    }
+
+    if (getrandom(session_ticket_key, QUIC_SESSION_TICKET_KEY_SIZE, 0) != QUIC_SESSION_TICKET_KEY_SIZE) {
+        fprintf(stderr, "load_session_ticket_key: failed to generate a session ticket key\n");
+        return 2;
+    }
+
+    return 0;
+}
+
+/*
+ * Sets up the given QUIC server worker - its UDP socket bound to the given port, its QUIC endpoint and its event loop.
+ * The first worker uses the default event loop, and is run by the thread that calls 'run_server_quic'.
+ *
+ * Returns 0 on success and > 0 on failure.
+ */
+static int set_up_quic_server_worker(struct QuicServer *worker, int worker_index, const char *port) {
+    worker->worker_index = worker_index;
+
+    // create a socket
+    struct addrinfo *local = NULL;
+    int error_code = create_socket("0.0.0.0", port, &local, worker);
+    if (local != NULL) {
+        freeaddrinfo(local);
+    }
+    if (error_code > 0) {
+        fprintf(stderr, "set_up_quic_server_worker: failed to create a UDP socket\n");
+        return 1;
+    }
+
+    // create quic config
+    worker->config = quic_config_new();
+    if (worker->config == NULL) {
+        return 2;
+    }
+    quic_config_set_recv_udp_payload_size(worker->config, MAX_DATAGRAM_SIZE);
+    quic_config_set_initial_max_streams_bidi(worker->config, MAX_STREAMS_PER_CONNECTION);
+
+    // the paths to clients aren't known in advance, so windows start from the default BDP and TQUIC auto-tunes them
+    init_quic_transport_tuning(&worker->transport_tuning, 0);
+    apply_quic_transport_tuning(worker->config, &worker->transport_tuning);
+
+    // create and set tls config
+    const char *const protos[1] = {"rpc"};
+    worker->tls_config = quic_tls_config_new_server_config("certificate.cert", "certificate.key", protos, 1, true);
+    if (worker->tls_config == NULL) {
+        fprintf(stderr, "set_up_quic_server_worker: failed to set up TLS config\n");
+        return 3;
+    }
+    error_code = quic_tls_config_set_session_ticket_key(worker->tls_config, session_ticket_key,
+                                                        QUIC_SESSION_TICKET_KEY_SIZE);
+    if (error_code != 0) {
+        fprintf(stderr, "set_up_quic_server_worker: failed to set the session ticket key\n");
+        return 3;
+    }
+    quic_config_set_tls_selector(worker->config, &tls_config_select_method, worker);
+
+    // create quic endpoint
+    worker->quic_endpoint =
+        quic_endpoint_new(worker->config, true, &quic_transport_methods, worker, &quic_packet_send_methods, worker);
+    if (worker->quic_endpoint == NULL) {
+        fprintf(stderr, "set_up_quic_server_worker: failed to create quic endpoint\n");
+        return 4;
+    }
+
+    // create the event loop
+    worker->event_loop = worker_index == 0 ? ev_default_loop(0) : ev_loop_new(EVFLAG_AUTO);
+    if (worker->event_loop == NULL) {
+        fprintf(stderr, "set_up_quic_server_worker: failed to create event loop\n");
+        return 5;
+    }
+
+    ev_init(&worker->timer, timeout_callback);
+    worker->timer.data = worker;
+
+    if (are_transport_stats_enabled()) {
+        ev_timer_init(&worker->stats_timer, stats_timeout_callback, TRANSPORT_STATS_INTERVAL,
+                      TRANSPORT_STATS_INTERVAL);
+        worker->stats_timer.data = worker;
+        ev_timer_start(worker->event_loop, &worker->stats_timer);
+    }
+
+    ev_io_init(&worker->socket_watcher, read_callback, worker->socket_fd, EV_READ);
+    worker->socket_watcher.data = worker;
+    ev_io_start(worker->event_loop, &worker->socket_watcher);
+
+    ev_async_init(&worker->shutdown_async_watcher, async_shutdown_callback);
+    worker->shutdown_async_watcher.data = worker;
+    ev_async_start(worker->event_loop, &worker->shutdown_async_watcher);
+
+    return 0;
+}
+
+/*
+ * The function that each QUIC server worker thread (other than the first worker) runs.
+ */
+static void *quic_server_worker_runner(void *arg) {
+    struct QuicServer *worker = arg;
+
+    // SIGTERM is handled by the main server thread, which stops all workers
+    sigset_t signal_set;
+    sigemptyset(&signal_set);
+    sigaddset(&signal_set, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signal_set, NULL);
+
+    ev_run(worker->event_loop, 0);
+
+    return NULL;
+}
+
+/*
+ * Frees all resources used by the given QUIC server worker. The worker's event loop must not be running.
+ */
+static void release_quic_server_worker_resources(struct QuicServer *worker) {
+    if (worker->tls_config != NULL) {
+        quic_tls_config_free(worker->tls_config);
+    }
+    if (worker->socket_fd > 0) {
+        close(worker->socket_fd);
+    }
+    free_udp_batching_context(&worker->udp_batching_context);
+    if (worker->quic_endpoint != NULL) {
+        quic_endpoint_free(worker->quic_endpoint);
+    }
+    if (worker->event_loop != NULL) {
+        ev_loop_destroy(worker->event_loop);
+    }
+    if (worker->config != NULL) {
+        quic_config_free(worker->config);
+    }
+    clean_up_server_connection_contexts_list(worker->connection_contexts);
+}
+
+/*
+ * Stops all QUIC server worker threads, and frees all resources used by all QUIC server workers.
  *
  * This function executes atomically and checks a flag that says if the resources have already
  * been released. This is so that concurrent cleanups initiated from different places do not
@@ -510,29 +697,24 @@ static int create_socket(const char *host, const char *port, struct addrinfo **l
  *
  * Does nothing if the QUIC server resources have already been released.
  */
-void release_quic_server_resources(struct QuicServer server) {
+void release_quic_server_resources(void) {
     pthread_mutex_lock(&quic_server_cleanup_mutex);
     if (quic_server_resources_released) {
         pthread_mutex_unlock(&quic_server_cleanup_mutex);
         return;
     }
 
-    if (server.tls_config != NULL) {
-        quic_tls_config_free(server.tls_config);
-    }
-    if (server.socket_fd > 0) {
-        close(server.socket_fd);
-    }
-    if (server.quic_endpoint != NULL) {
-        quic_endpoint_free(server.quic_endpoint);
-    }
-    if (server.event_loop != NULL) {
-        ev_loop_destroy(server.event_loop);
+    for (int i = 0; i < num_quic_server_workers; i++) {
+        struct QuicServer *worker = &quic_server_workers[i];
+        if (worker->successfully_created_worker_thread) {
+            ev_async_send(worker->event_loop, &worker->shutdown_async_watcher);
+            pthread_join(worker->worker_thread, NULL);
+        }
     }
-    if (server.config != NULL) {
-        quic_config_free(server.config);
+
+    for (int i = 0; i < num_quic_server_workers; i++) {
+        release_quic_server_worker_resources(&quic_server_workers[i]);
     }
-    clean_up_rm_receiving_contexts_list(server.rm_receiving_contexts);
 
     quic_server_resources_released = true;
     pthread_mutex_unlock(&quic_server_cleanup_mutex);
@@ -544,10 +726,12 @@ void release_quic_server_resources(struct QuicServer server) {
  * Can be called from signal handlers to ensure graceful shutdown.
  */
 void clean_up_quic_server_state(void) {
-    // break the event loop
-    ev_break(quic_server.event_loop, EVBREAK_ALL);
+    // break the event loop of the first worker, run by this thread
+    if (num_quic_server_workers > 0 && quic_server_workers[0].event_loop != NULL) {
+        ev_break(quic_server_workers[0].event_loop, EVBREAK_ALL);
+    }
 
-    release_quic_server_resources(quic_server);
+    release_quic_server_resources();
 }
 
 /*
@@ -556,68 +740,43 @@ void clean_up_quic_server_state(void) {
  * Returns > 0 on failure.
  */
 int run_server_quic(uint16_t port_number) {
-    quic_server.quic_endpoint = NULL;
-    quic_server.config = NULL;
-    quic_server.tls_config = NULL;
-    quic_server.event_loop = NULL;
-    quic_server.rm_receiving_contexts = NULL;
+    memset(quic_server_workers, 0, sizeof(quic_server_workers));
+    num_quic_server_workers = get_num_quic_server_workers();
 
     int ret = 0;
 
-    // create a socket
-    struct addrinfo *local = NULL;
-    char port[10];
-    sprintf(port, "%u", port_number);
-    if (create_socket("0.0.0.0", port, &local, &quic_server) > 0) {
-        fprintf(stderr, "run_server_quic: failed to create a UDP socket\n");
-        ret = 1;
-        goto cleanup;
-    }
-    freeaddrinfo(local);
-
-    // create quic config
-    quic_config_t *config = quic_config_new();
-    if (config == NULL) {
-        ret = 1;
-        goto cleanup;
+    if (load_session_ticket_key() > 0) {
+        fprintf(stderr, "run_server_quic: failed to load the session ticket key\n");
+        return 1;
     }
-    quic_config_set_recv_udp_payload_size(config, MAX_DATAGRAM_SIZE);
-    quic_server.config = config;
 
-    // create and set tls config
-    const char *const protos[1] = {"rpc"};
-    quic_server.tls_config = quic_tls_config_new_server_config("certificate.cert", "certificate.key", protos, 1, true);
-    if (quic_server.tls_config == NULL) {
-        fprintf(stderr, "run_server_quic: failed to set up TLS config\n");
-        ret = 1;
-        goto cleanup;
+    char port[10];
+    sprintf(port, "%u", port_number);
+    for (int i = 0; i < num_quic_server_workers; i++) {
+        if (set_up_quic_server_worker(&quic_server_workers[i], i, port) > 0) {
+            fprintf(stderr, "run_server_quic: failed to set up QUIC server worker %d\n", i);
+            ret = 1;
+            goto cleanup;
+        }
     }
-    quic_config_set_tls_selector(config, &tls_config_select_method, &quic_server);
 
-    // create quic endpoint
-    quic_server.quic_endpoint =
-        quic_endpoint_new(config, true, &quic_transport_methods, &quic_server, &quic_packet_send_methods, &quic_server);
-    if (quic_server.quic_endpoint == NULL) {
-        fprintf(stderr, "run_server_quic: failed to create quic endpoint\n");
-        ret = 1;
-        goto cleanup;
+    // start the workers, and run the first one in this thread
+    for (int i = 1; i < num_quic_server_workers; i++) {
+        struct QuicServer *worker = &quic_server_workers[i];
+        if (pthread_create(&worker->worker_thread, NULL, quic_server_worker_runner, worker) != 0) {
+            fprintf(stderr, "run_server_quic: failed to create thread for QUIC server worker %d\n", i);
+            ret = 1;
+            goto cleanup;
+        }
+        worker->successfully_created_worker_thread = true;
     }
 
-    // start the event loop
-    quic_server.event_loop = ev_default_loop(0);
-    ev_init(&quic_server.timer, timeout_callback);
-    quic_server.timer.data = &quic_server;
+    fprintf(stdout, "Server listening on port %d... (QUIC, %d workers)\n", port_number, num_quic_server_workers);
 
-    fprintf(stdout, "Server listening on port %d... (QUIC)\n", port_number);
-
-    ev_io watcher;
-    ev_io_init(&watcher, read_callback, quic_server.socket_fd, EV_READ);
-    ev_io_start(quic_server.event_loop, &watcher);
-    watcher.data = &quic_server;
-    ev_run(quic_server.event_loop, 0);
+    ev_run(quic_server_workers[0].event_loop, 0);
 
 cleanup:
-    release_quic_server_resources(quic_server);
+    release_quic_server_resources();
 
     return ret;
-}
\ No newline at end of file
+}
@@ -10,11 +10,13 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/random.h>
 #include <sys/socket.h>
 #include <sys/types.h>
 #include <unistd.h>
 
 #include <pthread.h>
+#include <signal.h>
 
 #include "openssl/pem.h"
 #include "openssl/ssl.h"
@@ -27,25 +29,63 @@
 #include "src/common_rpc/server_common_rpc.h"
 
 #include "src/transport/quic/quic_record_marking.h"
+#include "src/transport/quic/server_connection_context.h"
+#include "src/transport/quic/transport_tuning.h"
+#include "src/transport/quic/udp_batching.h"
+#include "src/transport/transport_stats.h"
 
 #define MAX_DATAGRAM_SIZE 10000
+#define MAX_STREAMS_PER_CONNECTION 256 // bidirectional streams each client may open
 
+/*
+ * The QUIC server runs one worker per online CPU (at most QUIC_SERVER_MAX_WORKERS), unless the number of
+ * workers is fixed at build time with QUIC_SERVER_NUM_WORKERS.
+ */
+#define QUIC_SERVER_MAX_WORKERS 16
+#ifndef QUIC_SERVER_NUM_WORKERS
+#define QUIC_SERVER_NUM_WORKERS 0
+#endif
+
+/*
+ * All workers encrypt TLS session tickets with the same key, read from QUIC_SESSION_TICKET_KEY_FILE if it exists,
+ * so that clients can resume their connections with 0-RTT whichever worker they land on, and across restarts.
+ */
+#define QUIC_SESSION_TICKET_KEY_FILE "session_ticket.key"
+#define QUIC_SESSION_TICKET_KEY_SIZE 48
+
+/*
+ * A QUIC server worker - an event loop with its own UDP socket and QUIC endpoint.
+ *
+ * All workers' sockets are bound to the same port with SO_REUSEPORT, and the kernel steers all datagrams
+ * with the same source and destination address and port to the same socket, so all packets of a QUIC
+ * connection are handled by the worker that accepted it.
+ */
 struct QuicServer {
+    int worker_index;
+
     struct quic_endpoint_t *quic_endpoint;
 
     // underlying UDP socket
     int socket_fd;
     struct sockaddr_storage local_addr;
     socklen_t local_addr_len;
+    UdpBatchingContext udp_batching_context;
 
     struct quic_config_t *config;
     struct quic_tls_config_t *tls_config;
+    QuicTransportTuning transport_tuning;
 
     struct ev_loop *event_loop;
     ev_timer timer;
+    ev_timer stats_timer;
+    ev_io socket_watcher;
+    ev_async shutdown_async_watcher;
+
+    pthread_t worker_thread;
+    bool successfully_created_worker_thread;
 
-    // RPC messages being received as Record Marking records
-    RecordMarkingReceivingContextsList *rm_receiving_contexts;
+    // per-connection state of all QUIC connections currently open at this worker
+    QuicServerConnectionContext *connection_contexts;
 };
 
 int run_server_quic(uint16_t port_number);
@@ -54,7 +94,8 @@ int run_server_quic(uint16_t port_number);
  * QUIC Nfs+Mount server state.
  */
 
-extern struct QuicServer quic_server;
+extern struct QuicServer quic_server_workers[QUIC_SERVER_MAX_WORKERS];
+extern int num_quic_server_workers;
 
 extern pthread_mutex_t quic_server_cleanup_mutex;
 extern bool quic_server_resources_released;
@@ -0,0 +1,183 @@
+#include "reply_scheduler.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/*
+ * Initializes the given reply scheduler with no scheduled replies.
+ */
+void init_reply_scheduler(QuicServerReplyScheduler *reply_scheduler) {
+    for (int urgency = 0; urgency < RPC_PRIORITY_NUM_URGENCY_LEVELS; urgency++) {
+        reply_scheduler->queue_fronts[urgency] = reply_scheduler->queue_backs[urgency] = NULL;
+    }
+
+    reply_scheduler->num_scheduled_replies = 0;
+    reply_scheduler->num_scheduled_bytes = 0;
+
+    reply_scheduler->num_flow_control_stalls = 0;
+}
+
+/*
+ * Deallocates the given scheduled reply, along with its RM record.
+ */
+static void free_scheduled_reply(ScheduledReply *scheduled_reply) {
+    free(scheduled_reply->rm_record);
+    free(scheduled_reply);
+}
+
+/*
+ * Writes as much of the given scheduled reply to its stream in the given QUIC connection as the stream
+ * accepts.
+ *
+ * Returns true if the whole reply has been written.
+ */
+static bool write_scheduled_reply(QuicServerReplyScheduler *reply_scheduler, struct quic_conn_t *conn,
+                                  ScheduledReply *scheduled_reply) {
+    while (scheduled_reply->num_bytes_written < scheduled_reply->rm_record_size) {
+        ssize_t bytes_written = quic_stream_write(conn, scheduled_reply->stream_id,
+                                                  scheduled_reply->rm_record + scheduled_reply->num_bytes_written,
+                                                  scheduled_reply->rm_record_size - scheduled_reply->num_bytes_written,
+                                                  false);
+        if (bytes_written <= 0) {
+            // the stream is out of flow control credit, continue once it becomes writable again
+            quic_stream_wantwrite(conn, scheduled_reply->stream_id, true);
+            reply_scheduler->num_flow_control_stalls++;
+            return false;
+        }
+
+        scheduled_reply->num_bytes_written += bytes_written;
+        reply_scheduler->num_scheduled_bytes -= bytes_written;
+    }
+
+    return true;
+}
+
+/*
+ * Writes the scheduled replies of the given QUIC connection to their streams, the most urgent ones first and
+ * in the order they were scheduled within the same urgency, and removes the fully written replies from the
+ * given reply scheduler. Replies whose streams are out of flow control credit stay scheduled until their
+ * streams become writable.
+ */
+void write_scheduled_replies(QuicServerReplyScheduler *reply_scheduler, struct quic_conn_t *conn) {
+    for (int urgency = 0; urgency < RPC_PRIORITY_NUM_URGENCY_LEVELS; urgency++) {
+        ScheduledReply **link = &reply_scheduler->queue_fronts[urgency];
+        ScheduledReply *previous_scheduled_reply = NULL;
+
+        while (*link != NULL) {
+            ScheduledReply *scheduled_reply = *link;
+            if (!write_scheduled_reply(reply_scheduler, conn, scheduled_reply)) {
+                previous_scheduled_reply = scheduled_reply;
+                link = &scheduled_reply->next;
+                continue;
+            }
+
+            *link = scheduled_reply->next;
+            if (reply_scheduler->queue_backs[urgency] == scheduled_reply) {
+                reply_scheduler->queue_backs[urgency] = previous_scheduled_reply;
+            }
+            reply_scheduler->num_scheduled_replies--;
+
+            free_scheduled_reply(scheduled_reply);
+        }
+    }
+}
+
+/*
+ * Schedules the given RPC reply, encoded as a Record Marking record, to be written to the stream with the given
+ * ID in the given QUIC connection, gives that stream the priority of the given procedure class, and writes all
+ * scheduled replies the connection's streams accept right away.
+ *
+ * The reply scheduler takes the ownership of the given RM record, also on failure.
+ *
+ * Returns 0 on success and > 0 on failure.
+ */
+int schedule_reply(QuicServerReplyScheduler *reply_scheduler, struct quic_conn_t *conn, uint64_t stream_id,
+                   RpcPriorityClass priority_class, uint8_t *rm_record, size_t rm_record_size) {
+    if (reply_scheduler == NULL || conn == NULL || rm_record == NULL) {
+        free(rm_record);
+        return 1;
+    }
+
+    ScheduledReply *scheduled_reply = malloc(sizeof(ScheduledReply));
+    if (scheduled_reply == NULL) {
+        fprintf(stderr, "schedule_reply: failed to allocate memory\n");
+        free(rm_record);
+        return 2;
+    }
+    scheduled_reply->stream_id = stream_id;
+    scheduled_reply->rm_record = rm_record;
+    scheduled_reply->rm_record_size = rm_record_size;
+    scheduled_reply->num_bytes_written = 0;
+    scheduled_reply->next = NULL;
+
+    uint8_t urgency = get_rpc_priority_urgency(priority_class);
+    quic_stream_set_priority(conn, stream_id, urgency, is_rpc_priority_incremental(priority_class));
+
+    if (reply_scheduler->queue_backs[urgency] == NULL) {
+        reply_scheduler->queue_fronts[urgency] = scheduled_reply;
+    } else {
+        reply_scheduler->queue_backs[urgency]->next = scheduled_reply;
+    }
+    reply_scheduler->queue_backs[urgency] = scheduled_reply;
+
+    reply_scheduler->num_scheduled_replies++;
+    reply_scheduler->num_scheduled_bytes += rm_record_size;
+
+    write_scheduled_replies(reply_scheduler, conn);
+
+    return 0;
+}
+
+/*
+ * Removes the scheduled replies to the stream with the given ID from the given reply scheduler, without
+ * writing them. Used once the stream is closed.
+ */
+void cancel_scheduled_replies(QuicServerReplyScheduler *reply_scheduler, uint64_t stream_id) {
+    if (reply_scheduler == NULL) {
+        return;
+    }
+
+    for (int urgency = 0; urgency < RPC_PRIORITY_NUM_URGENCY_LEVELS; urgency++) {
+        ScheduledReply **link = &reply_scheduler->queue_fronts[urgency];
+        ScheduledReply *previous_scheduled_reply = NULL;
+
+        while (*link != NULL) {
+            ScheduledReply *scheduled_reply = *link;
+            if (scheduled_reply->stream_id != stream_id) {
+                previous_scheduled_reply = scheduled_reply;
+                link = &scheduled_reply->next;
+                continue;
+            }
+
+            *link = scheduled_reply->next;
+            if (reply_scheduler->queue_backs[urgency] == scheduled_reply) {
+                reply_scheduler->queue_backs[urgency] = previous_scheduled_reply;
+            }
+            reply_scheduler->num_scheduled_replies--;
+            reply_scheduler->num_scheduled_bytes -=
+                scheduled_reply->rm_record_size - scheduled_reply->num_bytes_written;
+
+            free_scheduled_reply(scheduled_reply);
+        }
+    }
+}
+
+/*
+ * Deallocates all replies still scheduled in the given reply scheduler.
+ */
+void free_reply_scheduler(QuicServerReplyScheduler *reply_scheduler) {
+    if (reply_scheduler == NULL) {
+        return;
+    }
+
+    for (int urgency = 0; urgency < RPC_PRIORITY_NUM_URGENCY_LEVELS; urgency++) {
+        ScheduledReply *scheduled_reply = reply_scheduler->queue_fronts[urgency];
+        while (scheduled_reply != NULL) {
+            ScheduledReply *next_scheduled_reply = scheduled_reply->next;
+            free_scheduled_reply(scheduled_reply);
+            scheduled_reply = next_scheduled_reply;
+        }
+    }
+
+    init_reply_scheduler(reply_scheduler);
+}
@@ -0,0 +1,53 @@
+#ifndef reply_scheduler__HEADER__INCLUDED
+#define reply_scheduler__HEADER__INCLUDED
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "tquic.h"
+
+#include "rpc_priority.h"
+
+/*
+ * An RPC reply, encoded as a Record Marking record, waiting to be written to its stream.
+ */
+typedef struct ScheduledReply {
+    uint64_t stream_id;
+
+    uint8_t *rm_record;
+    size_t rm_record_size;
+    size_t num_bytes_written;
+
+    struct ScheduledReply *next;
+} ScheduledReply;
+
+/*
+ * The replies of a QUIC server connection that haven't been fully written to their streams yet, in one queue
+ * per stream urgency. Replies are written in order of urgency, so a small metadata reply produced while bulk
+ * replies are waiting for stream flow control credit is written before them. Once written, TQUIC sends the
+ * data buffered in the streams of a connection in order of urgency as well.
+ */
+typedef struct QuicServerReplyScheduler {
+    ScheduledReply *queue_fronts[RPC_PRIORITY_NUM_URGENCY_LEVELS];
+    ScheduledReply *queue_backs[RPC_PRIORITY_NUM_URGENCY_LEVELS];
+
+    size_t num_scheduled_replies;
+    size_t num_scheduled_bytes;
+
+    // times a reply couldn't be written because its stream was out of flow control credit
+    uint64_t num_flow_control_stalls;
+} QuicServerReplyScheduler;
+
+void init_reply_scheduler(QuicServerReplyScheduler *reply_scheduler);
+
+int schedule_reply(QuicServerReplyScheduler *reply_scheduler, struct quic_conn_t *conn, uint64_t stream_id,
+                   RpcPriorityClass priority_class, uint8_t *rm_record, size_t rm_record_size);
+
+void write_scheduled_replies(QuicServerReplyScheduler *reply_scheduler, struct quic_conn_t *conn);
+
+void cancel_scheduled_replies(QuicServerReplyScheduler *reply_scheduler, uint64_t stream_id);
+
+void free_reply_scheduler(QuicServerReplyScheduler *reply_scheduler);
+
+#endif /* reply_scheduler__HEADER__INCLUDED */
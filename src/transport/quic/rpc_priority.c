@@ -0,0 +1,52 @@
+#include "rpc_priority.h"
+
+#include "src/nfs/nfs_common.h"
+
+/*
+ * Returns the priority class of the given procedure of the given RPC program.
+ */
+RpcPriorityClass get_rpc_priority_class(uint32_t program_number, uint32_t procedure_number) {
+    if (procedure_number == 0 || program_number == MOUNT_RPC_PROGRAM_NUMBER) {
+        return RPC_PRIORITY_CLASS_METADATA;
+    }
+
+    if (program_number != NFS_RPC_PROGRAM_NUMBER) {
+        return RPC_PRIORITY_CLASS_DEFAULT;
+    }
+
+    switch (procedure_number) {
+    case NFSPROC_GETATTR:
+    case NFSPROC_LOOKUP:
+    case NFSPROC_READLINK:
+    case NFSPROC_STATFS:
+        return RPC_PRIORITY_CLASS_METADATA;
+    case NFSPROC_READ:
+    case NFSPROC_WRITE:
+        return RPC_PRIORITY_CLASS_BULK;
+    default:
+        return RPC_PRIORITY_CLASS_DEFAULT;
+    }
+}
+
+/*
+ * Returns the urgency of the QUIC streams RPCs of the given priority class are sent on.
+ */
+uint8_t get_rpc_priority_urgency(RpcPriorityClass priority_class) {
+    switch (priority_class) {
+    case RPC_PRIORITY_CLASS_METADATA:
+        return RPC_PRIORITY_METADATA_URGENCY;
+    case RPC_PRIORITY_CLASS_BULK:
+        return RPC_PRIORITY_BULK_URGENCY;
+    default:
+        return RPC_PRIORITY_DEFAULT_URGENCY;
+    }
+}
+
+/*
+ * Returns true if the data of QUIC streams carrying RPCs of the given priority class may be interleaved with
+ * the data of other streams of the same urgency. Bulk transfers share the bandwidth left over by more urgent
+ * streams, while every other RPC is sent in one piece, as its caller needs all of it anyway.
+ */
+bool is_rpc_priority_incremental(RpcPriorityClass priority_class) {
+    return priority_class == RPC_PRIORITY_CLASS_BULK;
+}
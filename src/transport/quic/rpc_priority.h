@@ -0,0 +1,34 @@
+#ifndef rpc_priority__HEADER__INCLUDED
+#define rpc_priority__HEADER__INCLUDED
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * RPCs are sent on QUIC streams whose priority (RFC 9218 urgency, 0 being the most urgent, and whether the
+ * stream's data may be interleaved with other streams of the same urgency) depends on the class of the RPC's
+ * procedure. Both the client's call streams and the server's reply streams use these priorities, so the
+ * small RPCs that interactive 'ls' and path resolution wait on are not stuck behind large reads and writes.
+ */
+typedef enum RpcPriorityClass {
+    // NULL procedures, MOUNT, GETATTR, LOOKUP, READLINK and STATFS - small RPCs clients wait on interactively
+    RPC_PRIORITY_CLASS_METADATA,
+    // procedures that change the file system, and READDIR
+    RPC_PRIORITY_CLASS_DEFAULT,
+    // READ and WRITE, which move file data in bulk
+    RPC_PRIORITY_CLASS_BULK,
+} RpcPriorityClass;
+
+#define RPC_PRIORITY_NUM_URGENCY_LEVELS 8 // urgencies go from 0 to 7
+
+#define RPC_PRIORITY_METADATA_URGENCY 1
+#define RPC_PRIORITY_DEFAULT_URGENCY 3
+#define RPC_PRIORITY_BULK_URGENCY 5
+
+RpcPriorityClass get_rpc_priority_class(uint32_t program_number, uint32_t procedure_number);
+
+uint8_t get_rpc_priority_urgency(RpcPriorityClass priority_class);
+
+bool is_rpc_priority_incremental(RpcPriorityClass priority_class);
+
+#endif /* rpc_priority__HEADER__INCLUDED */
@@ -0,0 +1,277 @@
+#include "server_connection_context.h"
+
+/*
+ * Maps the given stream ID to a bucket of a hash table with the given (power of 2) number of buckets.
+ *
+ * The two least significant bits of a QUIC stream ID only encode the stream's initiator and directionality,
+ * and all streams our clients open are client-initiated bidirectional streams, so these bits are dropped.
+ */
+static size_t stream_id_to_bucket(uint64_t stream_id, size_t num_buckets) {
+    return (size_t)(stream_id >> 2) & (num_buckets - 1);
+}
+
+/*
+ * Creates a fresh connection context for the given QUIC connection, with an empty hash table of RM receiving
+ * contexts.
+ *
+ * Returns NULL on failure.
+ *
+ * The user of this function takes the responsibility to free the created connection context using the
+ * 'free_server_connection_context' function.
+ */
+QuicServerConnectionContext *create_server_connection_context(struct quic_conn_t *quic_connection) {
+    QuicServerConnectionContext *connection_context = malloc(sizeof(QuicServerConnectionContext));
+    if (connection_context == NULL) {
+        fprintf(stderr, "create_server_connection_context: failed to allocate memory\n");
+        return NULL;
+    }
+
+    connection_context->quic_connection = quic_connection;
+
+    connection_context->rm_receiving_contexts_buckets =
+        calloc(RM_RECEIVING_CONTEXTS_INITIAL_NUM_BUCKETS, sizeof(RecordMarkingReceivingContextsList *));
+    if (connection_context->rm_receiving_contexts_buckets == NULL) {
+        fprintf(stderr, "create_server_connection_context: failed to allocate memory\n");
+        free(connection_context);
+        return NULL;
+    }
+    connection_context->num_buckets = RM_RECEIVING_CONTEXTS_INITIAL_NUM_BUCKETS;
+    connection_context->num_rm_receiving_contexts = 0;
+
+    init_reply_scheduler(&connection_context->reply_scheduler);
+
+    connection_context->rm_receiving_bytes_buffered = 0;
+    connection_context->peak_rm_receiving_bytes_buffered = 0;
+    connection_context->peak_num_rm_receiving_contexts = 0;
+    connection_context->num_rpcs_received = 0;
+
+    connection_context->prev = NULL;
+    connection_context->next = NULL;
+
+    return connection_context;
+}
+
+/*
+ * Deallocates all heap allocated memory in the given connection context, including all RM receiving
+ * contexts still in it, and the connection context itself.
+ *
+ * Does nothing if the given connection context is NULL.
+ */
+void free_server_connection_context(QuicServerConnectionContext *connection_context) {
+    if (connection_context == NULL) {
+        return;
+    }
+
+#ifdef DEBUG
+    fprintf(stdout,
+            "Connection closed - RPCs received: %lu, peak RM receiving contexts: %zu, peak buffered bytes: %zu\n",
+            connection_context->num_rpcs_received, connection_context->peak_num_rm_receiving_contexts,
+            connection_context->peak_rm_receiving_bytes_buffered);
+    fflush(stdout);
+#endif
+
+    for (size_t i = 0; i < connection_context->num_buckets; i++) {
+        clean_up_rm_receiving_contexts_list(connection_context->rm_receiving_contexts_buckets[i]);
+    }
+    free(connection_context->rm_receiving_contexts_buckets);
+
+    free_reply_scheduler(&connection_context->reply_scheduler);
+
+    free(connection_context);
+}
+
+/*
+ * Doubles the number of buckets in the hash table of RM receiving contexts in the given connection context,
+ * moving the existing list nodes to their new buckets.
+ *
+ * Returns 0 on success and > 0 on failure, in which case the hash table is left unchanged.
+ */
+static int grow_rm_receiving_contexts_buckets(QuicServerConnectionContext *connection_context) {
+    size_t new_num_buckets = connection_context->num_buckets * 2;
+    RecordMarkingReceivingContextsList **new_buckets =
+        calloc(new_num_buckets, sizeof(RecordMarkingReceivingContextsList *));
+    if (new_buckets == NULL) {
+        fprintf(stderr, "grow_rm_receiving_contexts_buckets: failed to allocate memory\n");
+        return 1;
+    }
+
+    for (size_t i = 0; i < connection_context->num_buckets; i++) {
+        RecordMarkingReceivingContextsList *curr = connection_context->rm_receiving_contexts_buckets[i];
+        while (curr != NULL) {
+            RecordMarkingReceivingContextsList *next = curr->next;
+
+            size_t bucket = stream_id_to_bucket(curr->rm_receiving_context->stream_id, new_num_buckets);
+            curr->next = new_buckets[bucket];
+            new_buckets[bucket] = curr;
+
+            curr = next;
+        }
+    }
+
+    free(connection_context->rm_receiving_contexts_buckets);
+    connection_context->rm_receiving_contexts_buckets = new_buckets;
+    connection_context->num_buckets = new_num_buckets;
+
+    return 0;
+}
+
+/*
+ * Finds the RM receiving context for the given stream in the given connection context.
+ *
+ * Returns NULL if there is no RM receiving context for this stream.
+ */
+RecordMarkingReceivingContext *lookup_server_rm_receiving_context(QuicServerConnectionContext *connection_context,
+                                                                  uint64_t stream_id) {
+    if (connection_context == NULL) {
+        return NULL;
+    }
+
+    size_t bucket = stream_id_to_bucket(stream_id, connection_context->num_buckets);
+    return get_rm_receiving_context(connection_context->quic_connection, stream_id,
+                                    connection_context->rm_receiving_contexts_buckets[bucket]);
+}
+
+/*
+ * Finds the RM receiving context for the given stream in the given connection context, creating
+ * a fresh one if this is a new stream.
+ *
+ * Returns NULL on failure.
+ */
+RecordMarkingReceivingContext *
+get_or_create_server_rm_receiving_context(QuicServerConnectionContext *connection_context, uint64_t stream_id) {
+    if (connection_context == NULL) {
+        fprintf(stderr, "get_or_create_server_rm_receiving_context: connection context is NULL\n");
+        return NULL;
+    }
+
+    RecordMarkingReceivingContext *rm_receiving_context =
+        lookup_server_rm_receiving_context(connection_context, stream_id);
+    if (rm_receiving_context != NULL) {
+        return rm_receiving_context;
+    }
+
+    // keep the load factor of the hash table at most 1
+    if (connection_context->num_rm_receiving_contexts >= connection_context->num_buckets) {
+        grow_rm_receiving_contexts_buckets(connection_context); // on failure keep using the smaller table
+    }
+
+    size_t bucket = stream_id_to_bucket(stream_id, connection_context->num_buckets);
+    int error_code = add_new_rm_receiving_context(connection_context->quic_connection, stream_id,
+                                                  &(connection_context->rm_receiving_contexts_buckets[bucket]));
+    if (error_code > 0) {
+        return NULL;
+    }
+    rm_receiving_context = connection_context->rm_receiving_contexts_buckets[bucket]->rm_receiving_context;
+
+    connection_context->num_rm_receiving_contexts++;
+    if (connection_context->num_rm_receiving_contexts > connection_context->peak_num_rm_receiving_contexts) {
+        connection_context->peak_num_rm_receiving_contexts = connection_context->num_rm_receiving_contexts;
+    }
+    update_server_rm_receiving_bytes_buffered(connection_context, 0,
+                                              get_rm_receiving_context_buffered_bytes(rm_receiving_context));
+
+    return rm_receiving_context;
+}
+
+/*
+ * Removes the RM receiving context for the given stream from the given connection context, and frees it.
+ *
+ * Returns 0 on success and > 0 on failure (e.g. context for this stream not found).
+ */
+int remove_server_rm_receiving_context(QuicServerConnectionContext *connection_context, uint64_t stream_id) {
+    if (connection_context == NULL) {
+        fprintf(stderr, "remove_server_rm_receiving_context: connection context is NULL\n");
+        return 1;
+    }
+
+    RecordMarkingReceivingContext *rm_receiving_context =
+        lookup_server_rm_receiving_context(connection_context, stream_id);
+    if (rm_receiving_context == NULL) {
+        return 2;
+    }
+    size_t buffered_bytes = get_rm_receiving_context_buffered_bytes(rm_receiving_context);
+
+    size_t bucket = stream_id_to_bucket(stream_id, connection_context->num_buckets);
+    int error_code = remove_rm_receiving_context(connection_context->quic_connection, stream_id,
+                                                 &(connection_context->rm_receiving_contexts_buckets[bucket]));
+    if (error_code > 0) {
+        return 3;
+    }
+
+    connection_context->num_rm_receiving_contexts--;
+    update_server_rm_receiving_bytes_buffered(connection_context, buffered_bytes, 0);
+
+    return 0;
+}
+
+/*
+ * Updates the memory accounting in the given connection context after the number of bytes buffered by one of
+ * its RM receiving contexts changed from 'previously_buffered_bytes' to 'currently_buffered_bytes'.
+ */
+void update_server_rm_receiving_bytes_buffered(QuicServerConnectionContext *connection_context,
+                                               size_t previously_buffered_bytes, size_t currently_buffered_bytes) {
+    if (connection_context == NULL) {
+        return;
+    }
+
+    connection_context->rm_receiving_bytes_buffered -= previously_buffered_bytes;
+    connection_context->rm_receiving_bytes_buffered += currently_buffered_bytes;
+
+    if (connection_context->rm_receiving_bytes_buffered > connection_context->peak_rm_receiving_bytes_buffered) {
+        connection_context->peak_rm_receiving_bytes_buffered = connection_context->rm_receiving_bytes_buffered;
+    }
+}
+
+/*
+ * Adds the given connection context to the head of the given doubly linked list of connection contexts.
+ */
+void add_server_connection_context(QuicServerConnectionContext *connection_context,
+                                   QuicServerConnectionContext **head) {
+    if (connection_context == NULL || head == NULL) {
+        return;
+    }
+
+    connection_context->prev = NULL;
+    connection_context->next = *head;
+    if (*head != NULL) {
+        (*head)->prev = connection_context;
+    }
+
+    *head = connection_context;
+}
+
+/*
+ * Unlinks the given connection context from the given doubly linked list of connection contexts,
+ * without freeing it.
+ */
+void unlink_server_connection_context(QuicServerConnectionContext *connection_context,
+                                      QuicServerConnectionContext **head) {
+    if (connection_context == NULL || head == NULL) {
+        return;
+    }
+
+    if (connection_context->prev != NULL) {
+        connection_context->prev->next = connection_context->next;
+    } else if (*head == connection_context) {
+        *head = connection_context->next;
+    }
+    if (connection_context->next != NULL) {
+        connection_context->next->prev = connection_context->prev;
+    }
+
+    connection_context->prev = NULL;
+    connection_context->next = NULL;
+}
+
+/*
+ * Deallocates all connection contexts in the given list.
+ */
+void clean_up_server_connection_contexts_list(QuicServerConnectionContext *head) {
+    while (head != NULL) {
+        QuicServerConnectionContext *next = head->next;
+
+        free_server_connection_context(head);
+
+        head = next;
+    }
+}
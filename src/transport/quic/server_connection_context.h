@@ -0,0 +1,52 @@
+#ifndef server_connection_context__HEADER__INCLUDED
+#define server_connection_context__HEADER__INCLUDED
+
+#include "quic_record_marking.h"
+#include "reply_scheduler.h"
+
+#define RM_RECEIVING_CONTEXTS_INITIAL_NUM_BUCKETS 16 // must be a power of 2
+
+typedef struct QuicServerConnectionContext {
+    struct quic_conn_t *quic_connection;
+
+    // RPC messages being received as Record Marking records on this connection, in a hash table keyed by stream ID
+    RecordMarkingReceivingContextsList **rm_receiving_contexts_buckets;
+    size_t num_buckets;
+    size_t num_rm_receiving_contexts;
+
+    // RPC replies waiting to be written to their streams on this connection
+    QuicServerReplyScheduler reply_scheduler;
+
+    // memory accounting for this connection
+    size_t rm_receiving_bytes_buffered;
+    size_t peak_rm_receiving_bytes_buffered;
+    size_t peak_num_rm_receiving_contexts;
+    uint64_t num_rpcs_received;
+
+    // all connection contexts of the server are kept in a doubly linked list so they can be released on shutdown
+    struct QuicServerConnectionContext *prev, *next;
+} QuicServerConnectionContext;
+
+QuicServerConnectionContext *create_server_connection_context(struct quic_conn_t *quic_connection);
+
+void free_server_connection_context(QuicServerConnectionContext *connection_context);
+
+RecordMarkingReceivingContext *
+get_or_create_server_rm_receiving_context(QuicServerConnectionContext *connection_context, uint64_t stream_id);
+
+RecordMarkingReceivingContext *lookup_server_rm_receiving_context(QuicServerConnectionContext *connection_context,
+                                                                  uint64_t stream_id);
+
+int remove_server_rm_receiving_context(QuicServerConnectionContext *connection_context, uint64_t stream_id);
+
+void update_server_rm_receiving_bytes_buffered(QuicServerConnectionContext *connection_context,
+                                               size_t previously_buffered_bytes, size_t currently_buffered_bytes);
+
+void add_server_connection_context(QuicServerConnectionContext *connection_context, QuicServerConnectionContext **head);
+
+void unlink_server_connection_context(QuicServerConnectionContext *connection_context,
+                                      QuicServerConnectionContext **head);
+
+void clean_up_server_connection_contexts_list(QuicServerConnectionContext *head);
+
+#endif /* server_connection_context__HEADER__INCLUDED */
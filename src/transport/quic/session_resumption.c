@@ -0,0 +1,249 @@
+#include "session_resumption.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "src/nfs/nfs_common.h"
+
+/*
+ * A session cache file holds the saved TLS session followed by the saved token, each preceded by its
+ * length as a 4-byte unsigned integer.
+ */
+
+/*
+ * Returns the path of the session cache file for the server with the given IPv4 address and port.
+ *
+ * Returns NULL on failure.
+ *
+ * The user of this function takes the responsibility to free the returned path.
+ */
+char *get_quic_session_cache_path(const char *server_ipv4_addr, uint16_t server_port) {
+    if (server_ipv4_addr == NULL) {
+        return NULL;
+    }
+
+    const char *path_format = "%s/quic_nfs_session_%s_%u";
+    int path_len = snprintf(NULL, 0, path_format, QUIC_SESSION_CACHE_DIR, server_ipv4_addr, server_port);
+    char *session_cache_path = malloc(path_len + 1);
+    if (session_cache_path == NULL) {
+        return NULL;
+    }
+    sprintf(session_cache_path, path_format, QUIC_SESSION_CACHE_DIR, server_ipv4_addr, server_port);
+
+    return session_cache_path;
+}
+
+/*
+ * Reads one length-prefixed entry from the given session cache file into a newly allocated buffer.
+ *
+ * Returns 0 on success and > 0 on failure.
+ */
+static int read_session_cache_entry(FILE *session_cache_file, uint8_t **entry, size_t *entry_len) {
+    uint32_t len;
+    if (fread(&len, sizeof(uint32_t), 1, session_cache_file) != 1) {
+        return 1;
+    }
+
+    if (len > QUIC_SESSION_CACHE_MAX_ENTRY_SIZE) {
+        return 2;
+    }
+
+    *entry = NULL;
+    *entry_len = 0;
+    if (len == 0) {
+        return 0;
+    }
+
+    *entry = malloc(len);
+    if (*entry == NULL) {
+        return 3;
+    }
+
+    if (fread(*entry, 1, len, session_cache_file) != len) {
+        free(*entry);
+        *entry = NULL;
+
+        return 4;
+    }
+    *entry_len = len;
+
+    return 0;
+}
+
+/*
+ * Loads the TLS session and the token saved in the session cache file at the given path into the given
+ * resumption state.
+ *
+ * Returns 0 on success and > 0 on failure - also when no session has been saved yet, in which case the
+ * connection simply starts with a full handshake.
+ *
+ * The user of this function takes the responsibility to call 'free_quic_resumption_state' on the loaded state.
+ */
+int load_quic_resumption_state(const char *session_cache_path, QuicResumptionState *resumption_state) {
+    if (session_cache_path == NULL || resumption_state == NULL) {
+        return 1;
+    }
+
+    FILE *session_cache_file = fopen(session_cache_path, "rb");
+    if (session_cache_file == NULL) {
+        return 2;
+    }
+
+    int error_code = read_session_cache_entry(session_cache_file, &resumption_state->session,
+                                              &resumption_state->session_len);
+    if (error_code > 0) {
+        fclose(session_cache_file);
+        return 3;
+    }
+
+    error_code =
+        read_session_cache_entry(session_cache_file, &resumption_state->token, &resumption_state->token_len);
+    if (error_code > 0) {
+        fclose(session_cache_file);
+        free_quic_resumption_state(resumption_state);
+
+        return 4;
+    }
+
+    fclose(session_cache_file);
+
+    return 0;
+}
+
+/*
+ * Writes one length-prefixed entry to the given file descriptor.
+ *
+ * Returns 0 on success and > 0 on failure.
+ */
+static int write_session_cache_entry(int fd, const uint8_t *entry, size_t entry_len) {
+    uint32_t len = entry_len;
+    if (write(fd, &len, sizeof(uint32_t)) != sizeof(uint32_t)) {
+        return 1;
+    }
+
+    if (entry_len > 0 && write(fd, entry, entry_len) != (ssize_t)entry_len) {
+        return 2;
+    }
+
+    return 0;
+}
+
+/*
+ * Saves the given TLS session and token to the session cache file at the given path, replacing the previously
+ * saved ones. The file is readable only by its owner, as a session is enough to resume the connection.
+ *
+ * Returns 0 on success and > 0 on failure.
+ */
+int save_quic_resumption_state(const char *session_cache_path, const uint8_t *session, size_t session_len,
+                               const uint8_t *token, size_t token_len) {
+    if (session_cache_path == NULL) {
+        return 1;
+    }
+
+    if (session == NULL || session_len == 0 || session_len > QUIC_SESSION_CACHE_MAX_ENTRY_SIZE ||
+        token_len > QUIC_SESSION_CACHE_MAX_ENTRY_SIZE) {
+        return 2;
+    }
+
+    // write to a temporary file first, so that concurrently starting clients never read a partial file - the
+    // connections of a pool may be closed at the same time, so each one gets a unique temporary file
+    size_t temporary_path_len = strlen(session_cache_path) + 8;
+    char *temporary_path = malloc(temporary_path_len);
+    if (temporary_path == NULL) {
+        return 3;
+    }
+    snprintf(temporary_path, temporary_path_len, "%s.XXXXXX", session_cache_path);
+
+    // created readable and writable only by its owner
+    int fd = mkstemp(temporary_path);
+    if (fd < 0) {
+        free(temporary_path);
+        return 4;
+    }
+
+    if (write_session_cache_entry(fd, session, session_len) > 0 ||
+        write_session_cache_entry(fd, token, token_len) > 0) {
+        close(fd);
+        unlink(temporary_path);
+        free(temporary_path);
+
+        return 5;
+    }
+    close(fd);
+
+    if (rename(temporary_path, session_cache_path) != 0) {
+        unlink(temporary_path);
+        free(temporary_path);
+
+        return 6;
+    }
+    free(temporary_path);
+
+    return 0;
+}
+
+/*
+ * Replaces the token in the given resumption state with a copy of the given token.
+ *
+ * Returns 0 on success and > 0 on failure.
+ */
+int set_quic_resumption_token(QuicResumptionState *resumption_state, const uint8_t *token, size_t token_len) {
+    if (resumption_state == NULL) {
+        return 1;
+    }
+
+    if (token == NULL || token_len == 0 || token_len > QUIC_SESSION_CACHE_MAX_ENTRY_SIZE) {
+        return 2;
+    }
+
+    uint8_t *token_copy = malloc(token_len);
+    if (token_copy == NULL) {
+        return 3;
+    }
+    memcpy(token_copy, token, token_len);
+
+    free(resumption_state->token);
+    resumption_state->token = token_copy;
+    resumption_state->token_len = token_len;
+
+    return 0;
+}
+
+/*
+ * Deallocates the session and token in the given resumption state, and leaves it empty.
+ */
+void free_quic_resumption_state(QuicResumptionState *resumption_state) {
+    if (resumption_state == NULL) {
+        return;
+    }
+
+    free(resumption_state->session);
+    free(resumption_state->token);
+
+    QuicResumptionState empty_resumption_state = QUIC_RESUMPTION_STATE_INIT;
+    *resumption_state = empty_resumption_state;
+}
+
+/*
+ * Returns true if the given procedure of the given RPC program may be sent in 0-RTT data, before the handshake
+ * of a resumed connection completes. 0-RTT data can be replayed by an attacker, so only NULL procedures and
+ * procedures that don't change the server's file system are allowed - MNT, GETATTR and LOOKUP, which clients
+ * send first when they mount and resolve paths.
+ */
+bool is_early_data_rpc(uint32_t program_number, uint32_t procedure_number) {
+    if (procedure_number == 0) {
+        return true;
+    }
+
+    if (program_number == MOUNT_RPC_PROGRAM_NUMBER) {
+        return procedure_number == MOUNTPROC_MNT;
+    }
+
+    if (program_number == NFS_RPC_PROGRAM_NUMBER) {
+        return procedure_number == NFSPROC_GETATTR || procedure_number == NFSPROC_LOOKUP;
+    }
+
+    return false;
+}
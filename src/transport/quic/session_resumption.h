@@ -0,0 +1,42 @@
+#ifndef session_resumption__HEADER__INCLUDED
+#define session_resumption__HEADER__INCLUDED
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * The QUIC client saves the TLS session (which carries the server's transport parameters) and the address
+ * validation token of its last connection to each server in a file in this directory, and uses them to
+ * resume the next connection to that server with 0-RTT.
+ */
+#ifndef QUIC_SESSION_CACHE_DIR
+#define QUIC_SESSION_CACHE_DIR "/tmp"
+#endif
+
+#define QUIC_SESSION_CACHE_MAX_ENTRY_SIZE 16384 // max size in bytes of a saved session or token
+
+typedef struct QuicResumptionState {
+    uint8_t *session;
+    size_t session_len;
+
+    uint8_t *token;
+    size_t token_len;
+} QuicResumptionState;
+
+#define QUIC_RESUMPTION_STATE_INIT {NULL, 0, NULL, 0}
+
+char *get_quic_session_cache_path(const char *server_ipv4_addr, uint16_t server_port);
+
+int load_quic_resumption_state(const char *session_cache_path, QuicResumptionState *resumption_state);
+
+int save_quic_resumption_state(const char *session_cache_path, const uint8_t *session, size_t session_len,
+                               const uint8_t *token, size_t token_len);
+
+int set_quic_resumption_token(QuicResumptionState *resumption_state, const uint8_t *token, size_t token_len);
+
+void free_quic_resumption_state(QuicResumptionState *resumption_state);
+
+bool is_early_data_rpc(uint32_t program_number, uint32_t procedure_number);
+
+#endif /* session_resumption__HEADER__INCLUDED */
@@ -2,169 +2,273 @@
 
 #include "quic_client.h"
 
+void process_connections(QuicClient *client);
+
 /*
- * Pushes the given QUIC client stream context to the back of the
- * stream allocation queue.
+ * RPC caller threads never touch the QUIC connection or the stream contexts of the QUIC client. They push
+ * their stream contexts to the client's submission ring, and the event loop thread drains it in batches,
+ * allocating a stream for each context inline. Once the RPC is finished, the caller thread pushes the
+ * context to the retirement ring, and the event loop thread gives its stream back and deallocates it.
+ */
+
+/*
+ * Hands the given stream context over to the event loop thread of the given QUIC client, which allocates
+ * a stream for it and starts sending its RPC call message. The calling thread should then wait on the
+ * stream context's completion.
  *
  * Returns 0 on success and > 0 on failure.
- *
- * The memory allocated in this function for the new queue entry should later
- * be freed in the 'pop_from_stream_allocation_queue' function.
  */
-int push_to_stream_allocation_queue(QuicClientStreamContext *stream_context, StreamAllocationQueue **back,
-                                    StreamAllocationQueue **front) {
-    if (back == NULL) {
+int submit_stream_context(QuicClient *client, QuicClientStreamContext *stream_context) {
+    if (client == NULL) {
         return 1;
     }
 
-    if (front == NULL) {
+    if (stream_context == NULL) {
         return 2;
     }
 
-    StreamAllocationQueue *new_entry = malloc(sizeof(StreamAllocationQueue));
-    if (new_entry == NULL) {
-        return 3;
-    }
-
-    new_entry->stream_context = stream_context;
-    new_entry->prev = NULL;
-    new_entry->next = *back;
-    if (*back != NULL) {
-        (*back)->prev = new_entry;
-    }
-
-    *back = new_entry;
-
-    if (*front == NULL) {
-        *front = new_entry;
-    }
+    push_to_submission_ring(&client->submission_ring, stream_context);
+    ev_async_send(client->event_loop, &client->submission_async_watcher);
 
     return 0;
 }
 
 /*
- * Removes one QUIC client stream context from the front of the given stream
- * allocation queue. If the queue is empty, fails.
+ * Hands the given stream context, whose RPC has finished and whose reply the calling thread is done with,
+ * back to the event loop thread of the given QUIC client, which releases its stream and deallocates it.
  *
- * Returns 0 on success and > 0 on failure.
+ * Stream contexts that failed to get a stream were never seen by the QUIC callbacks, and those sent on the
+ * pipelined stream were removed from it once they finished, so both are deallocated right away instead.
  */
-int pop_from_stream_allocation_queue(StreamAllocationQueue **back, StreamAllocationQueue **front) {
-    if (front == NULL) {
-        return 1;
-    }
-
-    if (*front == NULL) {
-        return 2;
+void retire_stream_context(QuicClient *client, QuicClientStreamContext *stream_context) {
+    if (client == NULL || stream_context == NULL) {
+        return;
     }
 
-    StreamAllocationQueue *first = *front;
-    if (first->prev != NULL) {
-        (first->prev)->next = NULL;
-        *front = first->prev;
-    } else {
-        *front = NULL;
-        *back = NULL;
+    if (!stream_context->successfully_allocated_stream || stream_context->pipelined) {
+        free_stream_context(stream_context);
+        return;
     }
 
-    free(first);
-
-    return 0;
+    push_to_submission_ring(&client->retirement_ring, stream_context);
+    ev_async_send(client->event_loop, &client->submission_async_watcher);
 }
 
 /*
- * Deallocates all stream allocation queue entries.
+ * Marks the RPC of the given stream context as failed, and wakes up the RPC caller thread.
  */
-void free_stream_allocation_queue(StreamAllocationQueue *back) {
-    StreamAllocationQueue *curr = back;
-    while (curr != NULL) {
-        StreamAllocationQueue *next = curr->next;
-        free(curr);
+static void fail_stream_allocation(QuicClientStreamContext *stream_context) {
+    stream_context->allocated_stream = NULL;
+    stream_context->successfully_allocated_stream = false;
+    stream_context->finished = true;
 
-        curr = next;
-    }
+    complete_rpc(&stream_context->completion);
 }
 
 /*
- * Allocates a QUIC stream for the given client stream context in the given QUIC client.
+ * Allocates a QUIC stream for the given client stream context in the given QUIC client, adds the stream
+ * context to the client's stream contexts, gives the stream the priority of the context's RPC, and marks
+ * the stream as wanting to write the RPC call message.
+ *
+ * If all auxiliary streams the client may open are in use, or the main stream is requested while another RPC
+ * is using it, the allocation is deferred - 'allocation_deferred' is set to true and the stream context has
+ * to wait until an RPC releases its stream.
+ *
+ * Pipelinable RPCs are added to the client's pipelined stream instead, if it has one, and never wait.
  *
  * Returns 0 on success and > 0 on failure.
  */
-int allocate_stream(QuicClient *client, QuicClientStreamContext *stream_context) {
-    pthread_mutex_lock(&stream_context->stream_allocator_lock);
+static int allocate_stream(QuicClient *client, QuicClientStreamContext *stream_context, bool *allocation_deferred) {
+    *allocation_deferred = false;
+
+    if (stream_context->pipelinable && client->pipelined_stream.stream != NULL) {
+        if (add_to_pipelined_stream(&client->pipelined_stream, client->quic_connection, stream_context) > 0) {
+            fprintf(stderr, "allocate_stream: failed to add the RPC to the pipelined stream\n");
+            fail_stream_allocation(stream_context);
+
+            return 4;
+        }
+
+        return 0;
+    }
 
     Stream *quic_stream = NULL;
     if (stream_context->use_auxiliary_stream) {
+        bool stream_pool_exhausted;
         Stream *allocated_auxiliary_stream = get_available_auxiliary_stream(
-            client->quic_connection, &client->auxiliary_streams_list_head, &client->auxiliary_streams_list_lock);
+            client->quic_connection, &client->auxiliary_stream_pool, &stream_pool_exhausted);
         if (allocated_auxiliary_stream == NULL) {
-            fprintf(stderr, "allocate_stream: failed to allocate an auxiliary stream\n");
+            if (stream_pool_exhausted) {
+                *allocation_deferred = true;
+                return 0;
+            }
 
-            stream_context->successfully_allocated_stream = false;
-            stream_context->stream_allocation_finished = true;
-            pthread_cond_signal(&stream_context->stream_allocator_condition_variable);
+            fprintf(stderr, "allocate_stream: failed to allocate an auxiliary stream\n");
+            fail_stream_allocation(stream_context);
 
             return 1;
         }
 
-        quic_stream_wantwrite(client->quic_connection, allocated_auxiliary_stream->id, true);
-
         quic_stream = allocated_auxiliary_stream;
     } else {
         if (client->main_stream == NULL) {
             fprintf(stderr, "allocate_stream: failed to create the main stream\n");
-
-            stream_context->successfully_allocated_stream = false;
-            stream_context->stream_allocation_finished = true;
-            pthread_cond_signal(&stream_context->stream_allocator_condition_variable);
+            fail_stream_allocation(stream_context);
 
             return 2;
         }
 
-        quic_stream_wantwrite(client->quic_connection, client->main_stream->id, true);
+        if (find_stream_context(&client->stream_contexts, client->main_stream->id) != NULL) {
+            *allocation_deferred = true;
+            return 0;
+        }
 
         quic_stream = client->main_stream;
     }
 
     stream_context->allocated_stream = quic_stream;
     stream_context->successfully_allocated_stream = true;
-    stream_context->stream_allocation_finished = true;
 
-    pthread_mutex_unlock(&stream_context->stream_allocator_lock);
-    pthread_cond_signal(&stream_context->stream_allocator_condition_variable);
+    if (add_stream_context(stream_context, &client->stream_contexts) > 0) {
+        fprintf(stderr, "allocate_stream: failed to add stream context to collection of stream contexts\n");
+
+        if (stream_context->use_auxiliary_stream) {
+            release_auxiliary_stream(quic_stream, &client->auxiliary_stream_pool);
+        }
+        fail_stream_allocation(stream_context);
+
+        return 3;
+    }
+
+    // streams are reused across RPCs, so the priority is set again for every RPC
+    RpcPriorityClass priority_class = stream_context->priority_class;
+    quic_stream_set_priority(client->quic_connection, quic_stream->id, get_rpc_priority_urgency(priority_class),
+                             is_rpc_priority_incremental(priority_class));
+
+    quic_stream_wantwrite(client->quic_connection, quic_stream->id, true);
 
     return 0;
 }
 
 /*
- * Processes all stream allocation queue entries, allocates streams for each QUIC
- * stream context in it, and removes all queue entries.
- *
- * Executes atomically by acquiring the QUIC client's stream allocation mutex.
+ * Appends the given stream context to the back of the given QUIC client's queue of stream contexts waiting
+ * for a stream.
  */
-void async_stream_allocator_callback(EV_P_ ev_async *w, int revents) {
-    QuicClient *client = w->data;
+static void defer_stream_allocation(QuicClient *client, QuicClientStreamContext *stream_context) {
+    stream_context->next_deferred_stream_context = NULL;
 
-    pthread_mutex_lock(&client->stream_allocation_queue_lock);
+    if (client->deferred_stream_contexts_back == NULL) {
+        client->deferred_stream_contexts_front = stream_context;
+    } else {
+        client->deferred_stream_contexts_back->next_deferred_stream_context = stream_context;
+    }
+    client->deferred_stream_contexts_back = stream_context;
+}
 
-    StreamAllocationQueue *curr = client->stream_allocation_queue_front;
-    while (curr != NULL) {
-        int error_code = allocate_stream(client, curr->stream_context);
+/*
+ * Allocates streams for the stream contexts waiting for a stream in the given QUIC client, in order, until
+ * one of them has to keep waiting.
+ *
+ * Returns true if at least one stream was allocated.
+ */
+static bool allocate_deferred_streams(QuicClient *client) {
+    bool allocated_streams = false;
+
+    QuicClientStreamContext *stream_context = client->deferred_stream_contexts_front;
+    while (stream_context != NULL) {
+        bool allocation_deferred;
+        int error_code = allocate_stream(client, stream_context, &allocation_deferred);
+        if (allocation_deferred) {
+            break;
+        }
         if (error_code > 0) {
-            fprintf(stderr, "async_stream_allocator_callback: failed to allocate stream\n");
+            fprintf(stderr, "allocate_deferred_streams: failed to allocate stream\n");
+        } else {
+            allocated_streams = true;
         }
 
-        StreamAllocationQueue *prev = curr->prev;
-        error_code = pop_from_stream_allocation_queue(&client->stream_allocation_queue_back,
-                                                      &client->stream_allocation_queue_front);
-        if (error_code > 0) {
-            fprintf(stderr, "async_stream_allocator_callback: failed to pop stram allocation queue entry\n");
+        stream_context = stream_context->next_deferred_stream_context;
+    }
 
-            pthread_mutex_unlock(&client->stream_allocation_queue_lock);
+    client->deferred_stream_contexts_front = stream_context;
+    if (stream_context == NULL) {
+        client->deferred_stream_contexts_back = NULL;
+    }
+
+    return allocated_streams;
+}
+
+/*
+ * Removes the stream contexts in the given QUIC client's retirement ring from the client's stream contexts,
+ * gives their auxiliary streams back to the pool, and deallocates them.
+ */
+static void release_retired_stream_contexts(QuicClient *client) {
+    void *retired_stream_contexts[SUBMISSION_RING_DRAIN_BATCH_SIZE];
+
+    size_t num_retired_stream_contexts;
+    while ((num_retired_stream_contexts = pop_batch_from_submission_ring(
+                &client->retirement_ring, retired_stream_contexts, SUBMISSION_RING_DRAIN_BATCH_SIZE)) > 0) {
+        for (size_t i = 0; i < num_retired_stream_contexts; i++) {
+            QuicClientStreamContext *stream_context = retired_stream_contexts[i];
+            Stream *allocated_stream = stream_context->allocated_stream;
+            bool use_auxiliary_stream = stream_context->use_auxiliary_stream;
+
+            // deallocates the stream context as well
+            remove_stream_context(&client->stream_contexts, allocated_stream->id);
+
+            if (use_auxiliary_stream) {
+                release_auxiliary_stream(allocated_stream, &client->auxiliary_stream_pool);
+            }
+        }
+    }
+}
+
+/*
+ * Releases the streams of retired stream contexts, hands the released streams to the stream contexts waiting
+ * for one, and allocates streams for the stream contexts submitted since the last run, in batches. Stream
+ * contexts keep their submission order - once one has to wait for an auxiliary stream, all later ones wait
+ * behind it.
+ *
+ * Runs in the event loop thread whenever an RPC caller thread submits or retires a stream context, and
+ * processes the connection once at the end so all newly allocated streams start sending at once.
+ */
+void async_submission_callback(EV_P_ ev_async *w, int revents) {
+    QuicClient *client = w->data;
 
-            return;
+    release_retired_stream_contexts(client);
+
+    bool allocated_streams = allocate_deferred_streams(client);
+
+    void *submitted_stream_contexts[SUBMISSION_RING_DRAIN_BATCH_SIZE];
+    size_t num_submitted_stream_contexts;
+    while ((num_submitted_stream_contexts = pop_batch_from_submission_ring(
+                &client->submission_ring, submitted_stream_contexts, SUBMISSION_RING_DRAIN_BATCH_SIZE)) > 0) {
+        for (size_t i = 0; i < num_submitted_stream_contexts; i++) {
+            QuicClientStreamContext *stream_context = submitted_stream_contexts[i];
+            client->num_rpcs_submitted++;
+
+            bool pipelined = stream_context->pipelinable && client->pipelined_stream.stream != NULL;
+            if (!pipelined && client->deferred_stream_contexts_front != NULL) {
+                defer_stream_allocation(client, stream_context);
+                continue;
+            }
+
+            bool allocation_deferred;
+            int error_code = allocate_stream(client, stream_context, &allocation_deferred);
+            if (error_code > 0) {
+                fprintf(stderr, "async_submission_callback: failed to allocate stream\n");
+                continue;
+            }
+
+            if (allocation_deferred) {
+                defer_stream_allocation(client, stream_context);
+            } else {
+                allocated_streams = true;
+            }
         }
-        curr = prev;
     }
 
-    pthread_mutex_unlock(&client->stream_allocation_queue_lock);
-}
\ No newline at end of file
+    if (allocated_streams) {
+        process_connections(client);
+    }
+}
@@ -3,17 +3,10 @@
 
 #include "client_stream_context.h"
 
-typedef struct StreamAllocationQueue {
-    QuicClientStreamContext *stream_context;
-    struct StreamAllocationQueue *next;
-    struct StreamAllocationQueue *prev;
-} StreamAllocationQueue;
+int submit_stream_context(QuicClient *client, QuicClientStreamContext *stream_context);
 
-int push_to_stream_allocation_queue(QuicClientStreamContext *stream_context, StreamAllocationQueue **back,
-                                    StreamAllocationQueue **front);
+void retire_stream_context(QuicClient *client, QuicClientStreamContext *stream_context);
 
-void free_stream_allocation_queue(StreamAllocationQueue *back);
-
-void async_stream_allocator_callback(EV_P_ ev_async *w, int revents);
+void async_submission_callback(EV_P_ ev_async *w, int revents);
 
 #endif
\ No newline at end of file
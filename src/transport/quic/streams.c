@@ -1,6 +1,6 @@
 #include "streams.h"
 
-#include "pthread.h"
+#include "stdio.h"
 #include "stdlib.h"
 
 /*
@@ -20,7 +20,7 @@ Stream *create_new_stream(struct quic_conn_t *quic_connection) {
     uint64_t stream_id;
     int error_code = quic_stream_bidi_new(quic_connection, 0, true, &stream_id);
     if (error_code != 0) {
-        fprintf(stderr, "create_new_stream: failed to create a new QUIC stream");
+        fprintf(stderr, "create_new_stream: failed to create a new QUIC stream\n");
 
         free(stream);
 
@@ -29,104 +29,155 @@ Stream *create_new_stream(struct quic_conn_t *quic_connection) {
 
     stream->id = stream_id;
     stream->stream_in_use = false;
+    stream->next_free_stream = NULL;
 
     return stream;
 }
 
 /*
- * If the given list of auxiliary streams has a free stream in the pool,
- * returns that stream. If there is no such stream we create a new stream in
- * the given QUIC connection if the limit on the number of streams has not
- * already been reached.
+ * Initializes the given stream pool to an empty pool.
+ */
+void init_stream_pool(StreamPool *stream_pool) {
+    stream_pool->streams = NULL;
+    stream_pool->num_streams = 0;
+
+    stream_pool->free_streams = NULL;
+    stream_pool->num_streams_in_use = 0;
+
+    stream_pool->stream_limit_reached = false;
+
+    pthread_mutex_init(&stream_pool->lock, NULL);
+}
+
+/*
+ * Takes a free stream from the given stream pool and marks it as in use. If the pool has no free
+ * stream, opens a new stream in the given QUIC connection, unless the pool already holds
+ * MAX_STREAMS_PER_CONNECTION streams or the server does not allow any more streams to be opened.
  *
- * Locks the given mutex before accessing the list.
+ * Streams in the pool are never closed, so the server's limit on the number of streams the client may
+ * open does not grow during the connection, and it's enough to learn it once.
  *
- * Returns NULL on failure to allocate an auxiliary stream.
+ * Locks the stream pool's mutex before accessing the pool.
+ *
+ * Returns NULL if no stream could be allocated. In that case 'stream_pool_exhausted' is set to true
+ * if a stream will become free once one of the RPCs using the pool's streams finishes, and to
+ * false if the allocation failed for good.
  */
-Stream *get_available_auxiliary_stream(struct quic_conn_t *quic_connection, StreamsList **auxiliary_streams_list,
-                                       pthread_mutex_t *list_lock) {
-    if (auxiliary_streams_list == NULL) {
+Stream *get_available_auxiliary_stream(struct quic_conn_t *quic_connection, StreamPool *stream_pool,
+                                       bool *stream_pool_exhausted) {
+    *stream_pool_exhausted = false;
+    if (stream_pool == NULL) {
         return NULL;
     }
 
-    pthread_mutex_lock(list_lock);
-
-    StreamsList *head = *auxiliary_streams_list;
-    int number_of_streams = 0;
-    while (head != NULL) {
-        if (head->stream == NULL) {
-            fprintf(stderr, "get_available_stream: NULL stream encountered in the stream pool");
+    pthread_mutex_lock(&stream_pool->lock);
 
-            pthread_mutex_unlock(list_lock);
+    // reuse a free stream
+    Stream *stream = stream_pool->free_streams;
+    if (stream != NULL) {
+        stream_pool->free_streams = stream->next_free_stream;
+        stream->next_free_stream = NULL;
+        stream->stream_in_use = true;
+        stream_pool->num_streams_in_use++;
 
-            return NULL;
-        }
+        pthread_mutex_unlock(&stream_pool->lock);
 
-        if (!head->stream->stream_in_use) {
-            head->stream->stream_in_use = true;
-
-            pthread_mutex_unlock(list_lock);
+        return stream;
+    }
 
-            return head->stream;
-        }
+    if (stream_pool->num_streams >= MAX_STREAMS_PER_CONNECTION || stream_pool->stream_limit_reached) {
+        *stream_pool_exhausted = stream_pool->num_streams_in_use > 0;
 
-        number_of_streams++;
+        pthread_mutex_unlock(&stream_pool->lock);
 
-        head = head->next;
+        return NULL;
     }
 
-    if (number_of_streams == MAX_STREAMS_PER_CONNECTION) {
-        pthread_mutex_unlock(list_lock);
+    // open a new auxiliary stream
+    StreamsList *new_entry = malloc(sizeof(StreamsList));
+    if (new_entry == NULL) {
+        pthread_mutex_unlock(&stream_pool->lock);
 
         return NULL;
     }
+    stream = create_new_stream(quic_connection);
+    if (stream == NULL) {
+        // the server doesn't allow us to open more streams
+        fprintf(stderr,
+                "get_available_auxiliary_stream: failed to open a new stream, keeping the pool at %zu streams\n",
+                stream_pool->num_streams);
 
-    // create a new auxiliary stream
-    Stream *new_auxiliary_stream = create_new_stream(quic_connection);
-    if (new_auxiliary_stream == NULL) {
-        fprintf(stderr, "get_available_stream: failed to create a new auxiliary stream");
+        free(new_entry);
 
-        pthread_mutex_unlock(list_lock);
+        stream_pool->stream_limit_reached = stream_pool->num_streams > 0;
+        *stream_pool_exhausted = stream_pool->num_streams_in_use > 0;
+
+        pthread_mutex_unlock(&stream_pool->lock);
 
         return NULL;
     }
-    new_auxiliary_stream->stream_in_use = true;
-    printf("NOW WE HAVE %d STREAMS\n", number_of_streams + 1);
-    fflush(stdout);
+    stream->stream_in_use = true;
 
-    StreamsList *new_entry = malloc(sizeof(StreamsList));
-    if (new_entry == NULL) {
-        free(new_auxiliary_stream);
+    new_entry->stream = stream;
+    new_entry->next = stream_pool->streams;
+    stream_pool->streams = new_entry;
 
-        pthread_mutex_unlock(list_lock);
+    stream_pool->num_streams++;
+    stream_pool->num_streams_in_use++;
 
-        return NULL;
+    pthread_mutex_unlock(&stream_pool->lock);
+
+    return stream;
+}
+
+/*
+ * Gives the given stream, taken from the given stream pool, back to the pool so it can be reused by another RPC.
+ *
+ * Locks the stream pool's mutex before accessing the pool.
+ */
+void release_auxiliary_stream(Stream *stream, StreamPool *stream_pool) {
+    if (stream == NULL || stream_pool == NULL) {
+        return;
     }
-    new_entry->stream = new_auxiliary_stream;
-    new_entry->next = *auxiliary_streams_list;
-    *auxiliary_streams_list = new_entry;
 
-    pthread_mutex_unlock(list_lock);
+    pthread_mutex_lock(&stream_pool->lock);
 
-    return new_auxiliary_stream;
+    if (stream->stream_in_use) {
+        stream->stream_in_use = false;
+        stream->next_free_stream = stream_pool->free_streams;
+        stream_pool->free_streams = stream;
+        stream_pool->num_streams_in_use--;
+    }
+
+    pthread_mutex_unlock(&stream_pool->lock);
 }
 
 /*
- * Deallocates the given list of streams.
+ * Deallocates all streams in the given stream pool, and destroys the pool's mutex.
  */
-void free_streams_list(StreamsList *head, pthread_mutex_t *list_lock) {
-    pthread_mutex_lock(list_lock);
+void free_stream_pool(StreamPool *stream_pool) {
+    if (stream_pool == NULL) {
+        return;
+    }
+
+    pthread_mutex_lock(&stream_pool->lock);
 
-    StreamsList *curr = head;
+    StreamsList *curr = stream_pool->streams;
     while (curr != NULL) {
-        Stream *stream = curr->stream;
         StreamsList *next = curr->next;
 
-        free(stream);
+        free(curr->stream);
         free(curr);
 
         curr = next;
     }
 
-    pthread_mutex_unlock(list_lock);
-}
\ No newline at end of file
+    stream_pool->streams = NULL;
+    stream_pool->free_streams = NULL;
+    stream_pool->num_streams = 0;
+    stream_pool->num_streams_in_use = 0;
+
+    pthread_mutex_unlock(&stream_pool->lock);
+
+    pthread_mutex_destroy(&stream_pool->lock);
+}
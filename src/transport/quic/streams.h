@@ -1,16 +1,24 @@
 #ifndef streams__HEADER__INCLUDED
 #define streams__HEADER__INCLUDED
 
+#include "pthread.h"
 #include "stdbool.h"
 #include "stdint.h"
 #include "tquic.h"
 
-#define MAX_STREAMS_PER_CONNECTION 10
+/*
+ * Upper bound on the number of auxiliary streams a client opens on a connection. The number of bidirectional
+ * streams the server lets the client open (its initial_max_streams_bidi transport parameter) can lower it.
+ */
+#define MAX_STREAMS_PER_CONNECTION 256
 
 typedef struct Stream {
     uint64_t id;
 
     bool stream_in_use;
+
+    // the next stream in the stack of free streams of the stream pool, if this stream is not in use
+    struct Stream *next_free_stream;
 } Stream;
 
 typedef struct StreamsList {
@@ -19,11 +27,33 @@ typedef struct StreamsList {
     struct StreamsList *next;
 } StreamsList;
 
+/*
+ * The pool of auxiliary streams of a QUIC connection, which are opened on demand and reused across RPCs.
+ */
+typedef struct StreamPool {
+    // all streams in the pool
+    StreamsList *streams;
+    size_t num_streams;
+
+    // stack of streams not currently in use
+    Stream *free_streams;
+    size_t num_streams_in_use;
+
+    // set once the server refuses to let us open another stream
+    bool stream_limit_reached;
+
+    pthread_mutex_t lock;
+} StreamPool;
+
 Stream *create_new_stream(struct quic_conn_t *quic_connection);
 
-Stream *get_available_auxiliary_stream(struct quic_conn_t *quic_connection, StreamsList **auxiliary_streams_list,
-                                       pthread_mutex_t *list_lock);
+void init_stream_pool(StreamPool *stream_pool);
+
+Stream *get_available_auxiliary_stream(struct quic_conn_t *quic_connection, StreamPool *stream_pool,
+                                       bool *stream_pool_exhausted);
+
+void release_auxiliary_stream(Stream *stream, StreamPool *stream_pool);
 
-void free_streams_list(StreamsList *head, pthread_mutex_t *list_lock);
+void free_stream_pool(StreamPool *stream_pool);
 
-#endif /* streams__HEADER__INCLUDED */
\ No newline at end of file
+#endif /* streams__HEADER__INCLUDED */
@@ -0,0 +1,163 @@
+#include "submission_ring.h"
+
+#include <linux/futex.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+/*
+ * The ring is Vyukov's bounded queue. Every slot carries a sequence number - a producer may fill the slot
+ * at position 'p' once its sequence is 'p', and the consumer may empty it once its sequence is 'p + 1'.
+ * Producers claim positions with a compare-and-swap on the enqueue position, and the single consumer
+ * advances the dequeue position without any atomic read-modify-write.
+ */
+
+/*
+ * Initializes the given submission ring to an empty ring with space for 'capacity' entries. The capacity
+ * has to be a power of 2.
+ *
+ * Returns 0 on success and > 0 on failure.
+ *
+ * The user of this function takes the responsibility to call 'free_submission_ring' on the ring.
+ */
+int init_submission_ring(SubmissionRing *submission_ring, size_t capacity) {
+    if (submission_ring == NULL) {
+        return 1;
+    }
+
+    if (capacity < 2 || (capacity & (capacity - 1)) != 0) {
+        fprintf(stderr, "init_submission_ring: ring capacity %zu is not a power of 2\n", capacity);
+        return 2;
+    }
+
+    submission_ring->slots = malloc(sizeof(SubmissionRingSlot) * capacity);
+    if (submission_ring->slots == NULL) {
+        return 3;
+    }
+
+    for (size_t i = 0; i < capacity; i++) {
+        submission_ring->slots[i].sequence = i;
+        submission_ring->slots[i].entry = NULL;
+    }
+    submission_ring->mask = capacity - 1;
+
+    submission_ring->enqueue_position = 0;
+    submission_ring->dequeue_position = 0;
+
+    return 0;
+}
+
+/*
+ * Pushes the given entry to the back of the given submission ring. Safe to call from any number of threads
+ * at once.
+ *
+ * Returns false if the ring is full.
+ */
+bool try_push_to_submission_ring(SubmissionRing *submission_ring, void *entry) {
+    size_t position = __atomic_load_n(&submission_ring->enqueue_position, __ATOMIC_RELAXED);
+
+    SubmissionRingSlot *slot;
+    while (true) {
+        slot = &submission_ring->slots[position & submission_ring->mask];
+        size_t sequence = __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE);
+        intptr_t difference = (intptr_t)sequence - (intptr_t)position;
+
+        if (difference == 0) {
+            // the slot is free, try to claim its position (on failure 'position' is reloaded)
+            if (__atomic_compare_exchange_n(&submission_ring->enqueue_position, &position, position + 1, true,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                break;
+            }
+        } else if (difference < 0) {
+            // the consumer hasn't emptied this slot since the previous lap
+            return false;
+        } else {
+            // another producer claimed this position first
+            position = __atomic_load_n(&submission_ring->enqueue_position, __ATOMIC_RELAXED);
+        }
+    }
+
+    slot->entry = entry;
+    __atomic_store_n(&slot->sequence, position + 1, __ATOMIC_RELEASE);
+
+    return true;
+}
+
+/*
+ * Pushes the given entry to the back of the given submission ring, yielding the CPU until the consumer
+ * makes space if the ring is full. Safe to call from any number of threads at once.
+ */
+void push_to_submission_ring(SubmissionRing *submission_ring, void *entry) {
+    while (!try_push_to_submission_ring(submission_ring, entry)) {
+        sched_yield();
+    }
+}
+
+/*
+ * Takes up to 'max_entries' entries from the front of the given submission ring, in the order they were
+ * pushed, and places them in 'entries'. Must only be called from a single consumer thread.
+ *
+ * Returns the number of entries taken. Stops early at an entry whose producer has claimed its position
+ * but not yet published it - that producer notifies the consumer again after publishing.
+ */
+size_t pop_batch_from_submission_ring(SubmissionRing *submission_ring, void **entries, size_t max_entries) {
+    size_t position = submission_ring->dequeue_position;
+
+    size_t num_entries = 0;
+    while (num_entries < max_entries) {
+        SubmissionRingSlot *slot = &submission_ring->slots[position & submission_ring->mask];
+        if (__atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE) != position + 1) {
+            break;
+        }
+
+        entries[num_entries++] = slot->entry;
+
+        // hand the slot over to the producers for the next lap
+        __atomic_store_n(&slot->sequence, position + submission_ring->mask + 1, __ATOMIC_RELEASE);
+        position++;
+    }
+    submission_ring->dequeue_position = position;
+
+    return num_entries;
+}
+
+/*
+ * Deallocates the slots of the given submission ring. Entries still in the ring are not freed.
+ */
+void free_submission_ring(SubmissionRing *submission_ring) {
+    if (submission_ring == NULL) {
+        return;
+    }
+
+    free(submission_ring->slots);
+    submission_ring->slots = NULL;
+}
+
+/*
+ * Initializes the given RPC completion as not completed.
+ */
+void init_rpc_completion(RpcCompletion *rpc_completion) {
+    rpc_completion->completed = 0;
+}
+
+/*
+ * Marks the given RPC completion as completed, and wakes up the thread waiting on it.
+ */
+void complete_rpc(RpcCompletion *rpc_completion) {
+    __atomic_store_n(&rpc_completion->completed, 1, __ATOMIC_RELEASE);
+
+    syscall(SYS_futex, &rpc_completion->completed, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+}
+
+/*
+ * Puts the calling thread to sleep until the given RPC completion is completed. Returns immediately if it
+ * already is.
+ */
+void wait_for_rpc_completion(RpcCompletion *rpc_completion) {
+    while (__atomic_load_n(&rpc_completion->completed, __ATOMIC_ACQUIRE) == 0) {
+        // sleeps only if the completion is still not completed, spurious wake-ups just repeat the check
+        syscall(SYS_futex, &rpc_completion->completed, FUTEX_WAIT_PRIVATE, 0, NULL, NULL, 0);
+    }
+}
@@ -0,0 +1,62 @@
+#ifndef submission_ring__HEADER__INCLUDED
+#define submission_ring__HEADER__INCLUDED
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Number of entries a submission ring can hold, must be a power of 2. Each RPC caller thread has at most one
+ * entry in a ring at a time, so this bounds the number of concurrent callers that never have to wait for space.
+ */
+#define SUBMISSION_RING_CAPACITY 1024
+
+// maximum number of entries the event loop takes out of a ring at once
+#define SUBMISSION_RING_DRAIN_BATCH_SIZE 64
+
+#define SUBMISSION_RING_CACHE_LINE_SIZE 64
+
+typedef struct SubmissionRingSlot {
+    // tells the producers and the consumer whose turn it is to use this slot
+    size_t sequence;
+    void *entry;
+} SubmissionRingSlot;
+
+/*
+ * A bounded lock-free multi-producer single-consumer ring. RPC caller threads push entries into it,
+ * and the QUIC client's event loop thread takes them out in batches.
+ */
+typedef struct SubmissionRing {
+    SubmissionRingSlot *slots;
+    size_t mask;
+
+    // the producers and the consumer each get their own cache line
+    size_t enqueue_position __attribute__((aligned(SUBMISSION_RING_CACHE_LINE_SIZE)));
+    size_t dequeue_position __attribute__((aligned(SUBMISSION_RING_CACHE_LINE_SIZE)));
+} SubmissionRing;
+
+/*
+ * A one-shot completion an RPC caller thread sleeps on until the event loop thread completes it, implemented
+ * as a single futex word.
+ */
+typedef struct RpcCompletion {
+    uint32_t completed;
+} RpcCompletion;
+
+int init_submission_ring(SubmissionRing *submission_ring, size_t capacity);
+
+bool try_push_to_submission_ring(SubmissionRing *submission_ring, void *entry);
+
+void push_to_submission_ring(SubmissionRing *submission_ring, void *entry);
+
+size_t pop_batch_from_submission_ring(SubmissionRing *submission_ring, void **entries, size_t max_entries);
+
+void free_submission_ring(SubmissionRing *submission_ring);
+
+void init_rpc_completion(RpcCompletion *rpc_completion);
+
+void complete_rpc(RpcCompletion *rpc_completion);
+
+void wait_for_rpc_completion(RpcCompletion *rpc_completion);
+
+#endif /* submission_ring__HEADER__INCLUDED */
@@ -0,0 +1,241 @@
+#include "transport_tuning.h"
+
+#include <fcntl.h> // open()
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/file.h> // flock()
+#include <unistd.h>
+
+#include "src/transport/transport_stats.h"
+
+static uint64_t clamp_uint64(uint64_t value, uint64_t min, uint64_t max) {
+    return value < min ? min : (value > max ? max : value);
+}
+
+/*
+ * Returns the name of the given congestion control algorithm.
+ */
+static const char *get_congestion_control_algorithm_name(enum quic_congestion_control_algorithm algorithm) {
+    switch (algorithm) {
+    case QUIC_CONGESTION_CONTROL_ALGORITHM_CUBIC:
+        return "cubic";
+    case QUIC_CONGESTION_CONTROL_ALGORITHM_BBR:
+        return "bbr";
+    case QUIC_CONGESTION_CONTROL_ALGORITHM_BBR3:
+        return "bbr3";
+    case QUIC_CONGESTION_CONTROL_ALGORITHM_COPA:
+        return "copa";
+    default:
+        return "other";
+    }
+}
+
+/*
+ * Initializes the given transport tuning for a path with the given bandwidth-delay product in bytes, or with
+ * QUIC_TUNING_DEFAULT_BDP if it is 0.
+ *
+ * The initial receive windows are twice the BDP, so that the sender isn't blocked by flow control while the
+ * window updates are in flight, and TQUIC auto-tunes them up to QUIC_TUNING_MAX_WINDOW if the receiving
+ * application keeps up with a faster path. A stream gets the whole connection window, since a single
+ * READ or WRITE stream may carry most of the connection's data.
+ */
+void init_quic_transport_tuning(QuicTransportTuning *transport_tuning, uint64_t bdp) {
+    if (bdp == 0) {
+        bdp = QUIC_TUNING_DEFAULT_BDP;
+    }
+
+    transport_tuning->congestion_control_algorithm = QUIC_CONGESTION_CONTROL_ALGORITHM;
+    transport_tuning->bdp = bdp;
+
+    transport_tuning->initial_congestion_window =
+        clamp_uint64(bdp / QUIC_TUNING_PACKET_SIZE, QUIC_TUNING_MIN_INITIAL_CONGESTION_WINDOW,
+                     QUIC_TUNING_MAX_INITIAL_CONGESTION_WINDOW);
+
+    uint64_t initial_window = clamp_uint64(2 * bdp, QUIC_TUNING_MIN_INITIAL_WINDOW, QUIC_TUNING_MAX_INITIAL_WINDOW);
+    transport_tuning->initial_max_data = initial_window;
+    transport_tuning->initial_max_stream_data = initial_window;
+    transport_tuning->max_connection_window = QUIC_TUNING_MAX_WINDOW;
+    transport_tuning->max_stream_window = QUIC_TUNING_MAX_WINDOW;
+}
+
+/*
+ * Sets the congestion control algorithm, initial congestion window and flow control windows of the given
+ * transport tuning in the given QUIC config.
+ */
+void apply_quic_transport_tuning(struct quic_config_t *quic_config, QuicTransportTuning *transport_tuning) {
+    quic_config_set_congestion_control_algorithm(quic_config, transport_tuning->congestion_control_algorithm);
+    quic_config_set_initial_congestion_window(quic_config, transport_tuning->initial_congestion_window);
+
+    quic_config_set_initial_max_data(quic_config, transport_tuning->initial_max_data);
+    quic_config_set_initial_max_stream_data_bidi_local(quic_config, transport_tuning->initial_max_stream_data);
+    quic_config_set_initial_max_stream_data_bidi_remote(quic_config, transport_tuning->initial_max_stream_data);
+    quic_config_set_max_connection_window(quic_config, transport_tuning->max_connection_window);
+    quic_config_set_max_stream_window(quic_config, transport_tuning->max_stream_window);
+}
+
+/*
+ * Records the given transport tuning of the QUIC connection with the given name in the transport statistics.
+ */
+void report_quic_transport_tuning(const char *connection_name, QuicTransportTuning *transport_tuning) {
+    append_transport_stats_line("quic %s tuning cc=%s bdp=%lu initial_cwnd_packets=%lu initial_max_data=%lu "
+                                "initial_max_stream_data=%lu max_connection_window=%lu max_stream_window=%lu",
+                                connection_name,
+                                get_congestion_control_algorithm_name(transport_tuning->congestion_control_algorithm),
+                                transport_tuning->bdp, transport_tuning->initial_congestion_window,
+                                transport_tuning->initial_max_data, transport_tuning->initial_max_stream_data,
+                                transport_tuning->max_connection_window, transport_tuning->max_stream_window);
+}
+
+/*
+ * Returns the bandwidth-delay product in bytes of the active path of the given QUIC connection, measured as its
+ * pacing rate times its minimum RTT, or its largest congestion window if the connection isn't paced.
+ *
+ * Returns 0 if the connection hasn't got far enough to measure it.
+ */
+uint64_t measure_quic_connection_bdp(struct quic_conn_t *quic_connection) {
+    const struct quic_path_stats_t *path_stats = quic_conn_active_path_stats(quic_connection);
+    if (path_stats == NULL || path_stats->min_rtt == 0) {
+        return 0;
+    }
+
+    if (path_stats->pacing_rate > 0) {
+        // pacing rate in bytes per second, RTT in microseconds
+        return path_stats->pacing_rate * path_stats->min_rtt / 1000000;
+    }
+
+    return path_stats->max_cwnd;
+}
+
+/*
+ * Returns the path of the file in which the BDP measured on connections to a server is saved, next to the given
+ * session cache file of that server.
+ *
+ * Returns NULL on failure.
+ *
+ * The user of this function takes the responsibility to free the returned path.
+ */
+char *get_quic_bdp_cache_path(const char *session_cache_path) {
+    if (session_cache_path == NULL) {
+        return NULL;
+    }
+
+    char *bdp_cache_path = malloc(strlen(session_cache_path) + strlen(".bdp") + 1);
+    if (bdp_cache_path == NULL) {
+        return NULL;
+    }
+    sprintf(bdp_cache_path, "%s.bdp", session_cache_path);
+
+    return bdp_cache_path;
+}
+
+/*
+ * Returns the BDP saved in the given BDP cache file, or 0 if none has been saved.
+ */
+uint64_t load_quic_bdp(const char *bdp_cache_path) {
+    if (bdp_cache_path == NULL) {
+        return 0;
+    }
+
+    FILE *bdp_cache_file = fopen(bdp_cache_path, "r");
+    if (bdp_cache_file == NULL) {
+        return 0;
+    }
+
+    unsigned long long bdp = 0;
+    if (fscanf(bdp_cache_file, "%llu", &bdp) != 1) {
+        bdp = 0;
+    }
+    fclose(bdp_cache_file);
+
+    return bdp;
+}
+
+/*
+ * Writes the given BDP to the given BDP cache file through a temporary file, so that a crash never leaves a partial
+ * file behind.
+ *
+ * Returns 0 on success and > 0 on failure.
+ */
+static int write_quic_bdp(const char *bdp_cache_path, uint64_t bdp) {
+    size_t temporary_path_len = strlen(bdp_cache_path) + 8;
+    char *temporary_path = malloc(temporary_path_len);
+    if (temporary_path == NULL) {
+        return 1;
+    }
+    snprintf(temporary_path, temporary_path_len, "%s.XXXXXX", bdp_cache_path);
+
+    int fd = mkstemp(temporary_path);
+    if (fd < 0) {
+        free(temporary_path);
+        return 2;
+    }
+
+    if (dprintf(fd, "%llu\n", (unsigned long long)bdp) < 0) {
+        close(fd);
+        unlink(temporary_path);
+        free(temporary_path);
+
+        return 3;
+    }
+    close(fd);
+
+    if (rename(temporary_path, bdp_cache_path) != 0) {
+        unlink(temporary_path);
+        free(temporary_path);
+
+        return 4;
+    }
+    free(temporary_path);
+
+    return 0;
+}
+
+/*
+ * Saves the given BDP measured on a connection to the given BDP cache file, averaged with the BDP saved there
+ * before so that a single short connection doesn't undo what longer ones have measured.
+ *
+ * The connections of a pool (and of other clients) may be closed at the same time, so the read-average-write
+ * is done holding an exclusive lock on a lock file next to the cache file - otherwise two closing connections
+ * could both average with the same saved BDP, and one of their measurements would be lost.
+ *
+ * Returns 0 on success and > 0 on failure.
+ */
+int save_quic_bdp(const char *bdp_cache_path, uint64_t bdp) {
+    if (bdp_cache_path == NULL) {
+        return 1;
+    }
+
+    if (bdp == 0) {
+        return 0;
+    }
+
+    char *lock_path = malloc(strlen(bdp_cache_path) + strlen(".lock") + 1);
+    if (lock_path == NULL) {
+        return 2;
+    }
+    sprintf(lock_path, "%s.lock", bdp_cache_path);
+
+    // the lock file itself is never replaced, unlike the cache file, so everyone locks the same inode
+    int lock_fd = open(lock_path, O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    free(lock_path);
+    if (lock_fd < 0) {
+        return 3;
+    }
+    if (flock(lock_fd, LOCK_EX) != 0) {
+        close(lock_fd);
+        return 4;
+    }
+
+    uint64_t previous_bdp = load_quic_bdp(bdp_cache_path);
+    if (previous_bdp > 0) {
+        bdp = (previous_bdp + bdp) / 2;
+    }
+
+    int error_code = write_quic_bdp(bdp_cache_path, bdp);
+
+    // closing the lock file releases the lock
+    close(lock_fd);
+
+    return error_code > 0 ? 5 : 0;
+}
@@ -0,0 +1,76 @@
+#ifndef transport_tuning__HEADER__INCLUDED
+#define transport_tuning__HEADER__INCLUDED
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "tquic.h"
+
+#include "src/nfs/nfs_common.h"
+
+/*
+ * The congestion control algorithm of all QUIC connections, chosen at build time with
+ * -DQUIC_CONGESTION_CONTROL_ALGORITHM=QUIC_CONGESTION_CONTROL_ALGORITHM_<CUBIC|BBR|BBR3|COPA>.
+ */
+#ifndef QUIC_CONGESTION_CONTROL_ALGORITHM
+#define QUIC_CONGESTION_CONTROL_ALGORITHM QUIC_CONGESTION_CONTROL_ALGORITHM_BBR
+#endif
+
+/*
+ * Flow control windows are sized from the bandwidth-delay product (BDP) of the path. Until one has been
+ * measured, the path is assumed to have QUIC_TUNING_DEFAULT_BDP (100 Mbit/s with a 100 ms RTT).
+ */
+#ifndef QUIC_TUNING_DEFAULT_BDP
+#define QUIC_TUNING_DEFAULT_BDP (1250 * 1024)
+#endif
+
+/*
+ * Bounds of the initial receive windows, and the largest windows TQUIC may auto-tune them up to. A stream's initial
+ * window must hold a whole READ or WRITE record of NFS_MAX_TRANSFER_SIZE bytes of data along with its RPC envelope,
+ * the rest of its arguments or results, and its Record Marking headers, or the first bulk transfer on a connection
+ * stalls on flow control however fast the path is. It is rounded up to a whole number of MiB.
+ */
+#define QUIC_TUNING_MAX_RECORD_OVERHEAD (64 * 1024)
+#define QUIC_TUNING_MIN_INITIAL_WINDOW                                                                                 \
+    ((NFS_MAX_TRANSFER_SIZE + QUIC_TUNING_MAX_RECORD_OVERHEAD + 1024 * 1024 - 1) / (1024 * 1024) * (1024 * 1024))
+#define QUIC_TUNING_MAX_INITIAL_WINDOW (64 * 1024 * 1024)
+#define QUIC_TUNING_MAX_WINDOW (256 * 1024 * 1024)
+
+// bounds of the initial congestion window in packets - connections to a known fast path start above the
+// usual 10 packets, but not much more, since the path may have changed since it was measured
+#define QUIC_TUNING_MIN_INITIAL_CONGESTION_WINDOW 10
+#define QUIC_TUNING_MAX_INITIAL_CONGESTION_WINDOW 32
+#define QUIC_TUNING_PACKET_SIZE 1200
+
+/*
+ * Transport parameters of a QUIC connection, derived from the BDP of its path.
+ */
+typedef struct QuicTransportTuning {
+    enum quic_congestion_control_algorithm congestion_control_algorithm;
+    uint64_t bdp;
+
+    // in packets
+    uint64_t initial_congestion_window;
+
+    uint64_t initial_max_data;
+    uint64_t initial_max_stream_data;
+    uint64_t max_connection_window;
+    uint64_t max_stream_window;
+} QuicTransportTuning;
+
+void init_quic_transport_tuning(QuicTransportTuning *transport_tuning, uint64_t bdp);
+
+void apply_quic_transport_tuning(struct quic_config_t *quic_config, QuicTransportTuning *transport_tuning);
+
+void report_quic_transport_tuning(const char *connection_name, QuicTransportTuning *transport_tuning);
+
+uint64_t measure_quic_connection_bdp(struct quic_conn_t *quic_connection);
+
+char *get_quic_bdp_cache_path(const char *session_cache_path);
+
+uint64_t load_quic_bdp(const char *bdp_cache_path);
+
+int save_quic_bdp(const char *bdp_cache_path, uint64_t bdp);
+
+#endif /* transport_tuning__HEADER__INCLUDED */
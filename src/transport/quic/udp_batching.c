@@ -0,0 +1,384 @@
+#define _GNU_SOURCE // to be able to use sendmmsg() and recvmmsg() in sys/socket.h
+
+#include "udp_batching.h"
+
+#include <linux/net_tstamp.h>
+#include <netinet/in.h>
+#include <netinet/udp.h>
+#include <time.h>
+
+/*
+ * Datagrams queued by the QUIC endpoints are sent with a single sendmmsg call per batch. Consecutive
+ * datagrams to the same peer are coalesced into a single UDP GSO message when the kernel supports it,
+ * so that the kernel segments them, and received datagrams are read with a single recvmmsg call per
+ * batch, with UDP GRO letting the kernel hand over several datagrams from the same peer at once.
+ */
+
+#ifndef SOL_UDP
+#define SOL_UDP IPPROTO_UDP
+#endif
+
+#ifndef SO_TXTIME
+#define SO_TXTIME 61
+#define SCM_TXTIME SO_TXTIME
+#endif
+
+/*
+ * Checks which of the UDP GSO, UDP GRO and SO_TXTIME socket offloads the kernel supports on the given
+ * socket, and enables them (SO_TXTIME only if pacing is configured with UDP_PACING_RATE).
+ */
+static void enable_socket_offloads(UdpBatchingContext *udp_batching_context) {
+    int socket_fd = udp_batching_context->socket_fd;
+
+    // a zero segment size leaves GSO off by default, and is only set per message
+    int segment_size = 0;
+    udp_batching_context->gso_enabled =
+        setsockopt(socket_fd, SOL_UDP, UDP_SEGMENT, &segment_size, sizeof(segment_size)) == 0;
+
+    int enable = 1;
+    udp_batching_context->gro_enabled = setsockopt(socket_fd, SOL_UDP, UDP_GRO, &enable, sizeof(enable)) == 0;
+
+    udp_batching_context->txtime_enabled = false;
+    udp_batching_context->pacing_rate = UDP_PACING_RATE;
+    udp_batching_context->next_txtime_ns = 0;
+    if (udp_batching_context->pacing_rate > 0) {
+        struct sock_txtime sock_txtime = {.clockid = CLOCK_MONOTONIC, .flags = 0};
+        udp_batching_context->txtime_enabled =
+            setsockopt(socket_fd, SOL_SOCKET, SO_TXTIME, &sock_txtime, sizeof(sock_txtime)) == 0;
+    }
+}
+
+/*
+ * Initializes the given UDP batching context for batched I/O on the given (non-blocking) UDP socket.
+ *
+ * Returns 0 on success and > 0 on failure.
+ *
+ * The user of this function takes the responsibility to free the memory held by the UDP batching context
+ * using the 'free_udp_batching_context' function.
+ */
+int init_udp_batching_context(UdpBatchingContext *udp_batching_context, int socket_fd) {
+    if (udp_batching_context == NULL) {
+        fprintf(stderr, "init_udp_batching_context: UDP batching context is NULL\n");
+        return 1;
+    }
+
+    memset(udp_batching_context, 0, sizeof(UdpBatchingContext));
+    udp_batching_context->socket_fd = socket_fd;
+
+    enable_socket_offloads(udp_batching_context);
+
+    udp_batching_context->recv_buffer_size =
+        udp_batching_context->gro_enabled ? UDP_RECV_GRO_BUFFER_SIZE : UDP_RECV_DATAGRAM_BUFFER_SIZE;
+    udp_batching_context->recv_buffers =
+        malloc(UDP_RECV_BATCH_MAX_MESSAGES * udp_batching_context->recv_buffer_size);
+    udp_batching_context->send_msgs = calloc(UDP_SEND_BATCH_MAX_DATAGRAMS, sizeof(struct mmsghdr));
+    udp_batching_context->recv_msgs = calloc(UDP_RECV_BATCH_MAX_MESSAGES, sizeof(struct mmsghdr));
+    if (udp_batching_context->recv_buffers == NULL || udp_batching_context->send_msgs == NULL ||
+        udp_batching_context->recv_msgs == NULL) {
+        fprintf(stderr, "init_udp_batching_context: failed to allocate memory\n");
+        free_udp_batching_context(udp_batching_context);
+        return 2;
+    }
+
+    return 0;
+}
+
+/*
+ * Deallocates all heap allocated memory in the given UDP batching context. Does not close the socket.
+ *
+ * Does nothing if the given UDP batching context is NULL.
+ */
+void free_udp_batching_context(UdpBatchingContext *udp_batching_context) {
+    if (udp_batching_context == NULL) {
+        return;
+    }
+
+    free(udp_batching_context->recv_buffers);
+    free(udp_batching_context->send_msgs);
+    free(udp_batching_context->recv_msgs);
+
+    udp_batching_context->recv_buffers = NULL;
+    udp_batching_context->send_msgs = NULL;
+    udp_batching_context->recv_msgs = NULL;
+}
+
+/*
+ * Returns the transmit time (in CLOCK_MONOTONIC nanoseconds) for a message of the given size, spacing
+ * consecutive messages out so that they leave at the configured pacing rate.
+ */
+static uint64_t get_next_txtime(UdpBatchingContext *udp_batching_context, size_t message_size) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    uint64_t now_ns = (uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec;
+
+    // don't let an idle period build up credit for a later burst
+    if (udp_batching_context->next_txtime_ns < now_ns) {
+        udp_batching_context->next_txtime_ns = now_ns;
+    }
+
+    uint64_t txtime = udp_batching_context->next_txtime_ns;
+    udp_batching_context->next_txtime_ns += message_size * 1000000000ULL / udp_batching_context->pacing_rate;
+
+    return txtime;
+}
+
+static bool same_dst_addr(UdpBatchingContext *udp_batching_context, size_t i, size_t j) {
+    return udp_batching_context->send_dst_addr_lens[i] == udp_batching_context->send_dst_addr_lens[j] &&
+           memcmp(udp_batching_context->send_dst_addrs[i], udp_batching_context->send_dst_addrs[j],
+                  udp_batching_context->send_dst_addr_lens[i]) == 0;
+}
+
+/*
+ * Builds sendmmsg messages out of the queued datagrams starting at index 'first_datagram', coalescing
+ * runs of datagrams to the same peer into UDP GSO messages if GSO is enabled. All segments of a GSO
+ * message must have the same size, except for the last one which may be shorter.
+ *
+ * Returns the number of messages built.
+ */
+static size_t build_send_messages(UdpBatchingContext *udp_batching_context, size_t first_datagram,
+                                  size_t num_datagrams) {
+    size_t num_messages = 0;
+
+    size_t i = first_datagram;
+    while (i < num_datagrams) {
+        size_t segment_size = udp_batching_context->send_iovs[i].iov_len;
+        size_t message_size = segment_size;
+        size_t num_segments = 1;
+        while (udp_batching_context->gso_enabled && i + num_segments < num_datagrams &&
+               num_segments < UDP_MAX_GSO_SEGMENTS && same_dst_addr(udp_batching_context, i, i + num_segments)) {
+            size_t next_size = udp_batching_context->send_iovs[i + num_segments].iov_len;
+            if (next_size > segment_size || message_size + next_size > UDP_MAX_GSO_PAYLOAD_SIZE) {
+                break;
+            }
+
+            message_size += next_size;
+            num_segments++;
+            if (next_size < segment_size) {
+                break; // a shorter segment ends the GSO message
+            }
+        }
+
+        struct msghdr *msg = &udp_batching_context->send_msgs[num_messages].msg_hdr;
+        memset(msg, 0, sizeof(struct msghdr));
+        msg->msg_name = (void *)udp_batching_context->send_dst_addrs[i];
+        msg->msg_namelen = udp_batching_context->send_dst_addr_lens[i];
+        msg->msg_iov = &udp_batching_context->send_iovs[i];
+        msg->msg_iovlen = num_segments;
+
+        uint8_t *control = udp_batching_context->send_control[num_messages];
+        memset(control, 0, sizeof(udp_batching_context->send_control[num_messages]));
+        msg->msg_control = control;
+        msg->msg_controllen = sizeof(udp_batching_context->send_control[num_messages]);
+
+        size_t controllen = 0;
+        struct cmsghdr *cmsg = CMSG_FIRSTHDR(msg);
+        if (num_segments > 1) {
+            cmsg->cmsg_level = SOL_UDP;
+            cmsg->cmsg_type = UDP_SEGMENT;
+            cmsg->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+            *(uint16_t *)CMSG_DATA(cmsg) = segment_size;
+            controllen += CMSG_SPACE(sizeof(uint16_t));
+            cmsg = CMSG_NXTHDR(msg, cmsg);
+        }
+        if (udp_batching_context->txtime_enabled) {
+            cmsg->cmsg_level = SOL_SOCKET;
+            cmsg->cmsg_type = SCM_TXTIME;
+            cmsg->cmsg_len = CMSG_LEN(sizeof(uint64_t));
+            *(uint64_t *)CMSG_DATA(cmsg) = get_next_txtime(udp_batching_context, message_size);
+            controllen += CMSG_SPACE(sizeof(uint64_t));
+        }
+
+        msg->msg_controllen = controllen;
+        if (controllen == 0) {
+            msg->msg_control = NULL;
+        }
+
+        udp_batching_context->send_msg_num_datagrams[num_messages] = num_segments;
+        num_messages++;
+        i += num_segments;
+    }
+
+    return num_messages;
+}
+
+/*
+ * Sends the first 'num_datagrams' queued datagrams in the given UDP batching context.
+ *
+ * Returns the number of datagrams sent, which is less than 'num_datagrams' if the socket would block,
+ * or -1 on failure.
+ */
+static int send_queued_datagrams(UdpBatchingContext *udp_batching_context, size_t num_datagrams) {
+    size_t datagrams_sent = 0;
+    while (datagrams_sent < num_datagrams) {
+        size_t num_messages = build_send_messages(udp_batching_context, datagrams_sent, num_datagrams);
+
+        int messages_sent = sendmmsg(udp_batching_context->socket_fd, udp_batching_context->send_msgs, num_messages, 0);
+        if (messages_sent < 0) {
+            if ((errno == EWOULDBLOCK) || (errno == EAGAIN)) {
+                return datagrams_sent;
+            }
+            if (udp_batching_context->gso_enabled && (errno == EIO || errno == EINVAL)) {
+                // the egress device can't do GSO (e.g. checksum offload off), so send these datagrams one by one
+                fprintf(stderr, "send_queued_datagrams: UDP GSO send failed, disabling GSO\n");
+                udp_batching_context->gso_enabled = false;
+                continue;
+            }
+
+            perror("send_queued_datagrams: failed to send datagrams");
+            return -1;
+        }
+        udp_batching_context->stats.send_syscalls++;
+
+        for (int m = 0; m < messages_sent; m++) {
+            const struct iovec *iovs = udp_batching_context->send_msgs[m].msg_hdr.msg_iov;
+            for (size_t d = 0; d < udp_batching_context->send_msg_num_datagrams[m]; d++) {
+                udp_batching_context->stats.bytes_sent += iovs[d].iov_len;
+            }
+            udp_batching_context->stats.datagrams_sent += udp_batching_context->send_msg_num_datagrams[m];
+            datagrams_sent += udp_batching_context->send_msg_num_datagrams[m];
+        }
+    }
+
+    return datagrams_sent;
+}
+
+/*
+ * Sends the given outbound QUIC packets via the UDP socket of the given UDP batching context, using
+ * as few system calls as possible.
+ *
+ * Returns the number of packets sent, which is less than 'count' if the socket would block, or -1 on failure.
+ */
+int send_quic_packets_batched(UdpBatchingContext *udp_batching_context, struct quic_packet_out_spec_t *pkts,
+                              unsigned int count) {
+    if (udp_batching_context == NULL || pkts == NULL) {
+        fprintf(stderr, "send_quic_packets_batched: UDP batching context or packets are NULL\n");
+        return -1;
+    }
+
+    int sent_count = 0;
+
+    unsigned int pkt_index = 0;
+    size_t iov_index = 0;
+    while (pkt_index < count) {
+        // queue the next batch of datagrams
+        size_t num_datagrams = 0;
+        while (pkt_index < count && num_datagrams < UDP_SEND_BATCH_MAX_DATAGRAMS) {
+            struct quic_packet_out_spec_t *pkt = pkts + pkt_index;
+            if (iov_index >= pkt->iovlen) {
+                pkt_index++;
+                iov_index = 0;
+                continue;
+            }
+
+            udp_batching_context->send_iovs[num_datagrams] = pkt->iov[iov_index];
+            udp_batching_context->send_dst_addrs[num_datagrams] = pkt->dst_addr;
+            udp_batching_context->send_dst_addr_lens[num_datagrams] = pkt->dst_addr_len;
+            num_datagrams++;
+            iov_index++;
+        }
+        if (num_datagrams == 0) {
+            break;
+        }
+
+        int datagrams_sent = send_queued_datagrams(udp_batching_context, num_datagrams);
+        if (datagrams_sent < 0) {
+            return -1;
+        }
+        sent_count += datagrams_sent;
+
+        if ((size_t)datagrams_sent < num_datagrams) {
+            fprintf(stderr, "send would block, already sent: %d\n", sent_count);
+            return sent_count;
+        }
+    }
+
+    return sent_count;
+}
+
+/*
+ * Returns the UDP GRO segment size attached to the given received message, or 0 if the message holds
+ * a single datagram.
+ */
+static size_t get_gro_segment_size(struct msghdr *msg) {
+    for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(msg); cmsg != NULL; cmsg = CMSG_NXTHDR(msg, cmsg)) {
+        if (cmsg->cmsg_level == SOL_UDP && cmsg->cmsg_type == UDP_GRO) {
+            int segment_size;
+            memcpy(&segment_size, CMSG_DATA(cmsg), sizeof(segment_size));
+            return segment_size > 0 ? segment_size : 0;
+        }
+    }
+
+    return 0;
+}
+
+/*
+ * Reads all datagrams currently available on the UDP socket of the given UDP batching context, and
+ * calls the given handler on each of them, splitting UDP GRO messages back into datagrams.
+ *
+ * Returns 0 once the socket has no more datagrams available, and > 0 on failure.
+ */
+int receive_udp_datagrams_batched(UdpBatchingContext *udp_batching_context, UdpDatagramHandler handler,
+                                  void *handler_context) {
+    if (udp_batching_context == NULL || handler == NULL) {
+        fprintf(stderr, "receive_udp_datagrams_batched: UDP batching context or handler is NULL\n");
+        return 1;
+    }
+
+    while (true) {
+        for (int m = 0; m < UDP_RECV_BATCH_MAX_MESSAGES; m++) {
+            udp_batching_context->recv_iovs[m].iov_base =
+                udp_batching_context->recv_buffers + m * udp_batching_context->recv_buffer_size;
+            udp_batching_context->recv_iovs[m].iov_len = udp_batching_context->recv_buffer_size;
+
+            struct msghdr *msg = &udp_batching_context->recv_msgs[m].msg_hdr;
+            memset(msg, 0, sizeof(struct msghdr));
+            msg->msg_name = &udp_batching_context->recv_peer_addrs[m];
+            msg->msg_namelen = sizeof(struct sockaddr_storage);
+            msg->msg_iov = &udp_batching_context->recv_iovs[m];
+            msg->msg_iovlen = 1;
+            msg->msg_control = udp_batching_context->recv_control[m];
+            msg->msg_controllen = sizeof(udp_batching_context->recv_control[m]);
+        }
+
+        int messages_received = recvmmsg(udp_batching_context->socket_fd, udp_batching_context->recv_msgs,
+                                         UDP_RECV_BATCH_MAX_MESSAGES, MSG_DONTWAIT, NULL);
+        if (messages_received < 0) {
+            if ((errno == EWOULDBLOCK) || (errno == EAGAIN)) {
+                // all data available now has been handled
+                return 0;
+            }
+
+            perror("receive_udp_datagrams_batched: failed to read");
+            return 2;
+        }
+        udp_batching_context->stats.recv_syscalls++;
+
+        for (int m = 0; m < messages_received; m++) {
+            struct msghdr *msg = &udp_batching_context->recv_msgs[m].msg_hdr;
+            size_t message_size = udp_batching_context->recv_msgs[m].msg_len;
+            if (msg->msg_flags & MSG_TRUNC) {
+                fprintf(stderr, "receive_udp_datagrams_batched: dropping a truncated datagram\n");
+                continue;
+            }
+
+            size_t segment_size = get_gro_segment_size(msg);
+            if (segment_size == 0) {
+                segment_size = message_size;
+            }
+
+            uint8_t *message = udp_batching_context->recv_iovs[m].iov_base;
+            for (size_t offset = 0; offset < message_size; offset += segment_size) {
+                size_t datagram_size = message_size - offset < segment_size ? message_size - offset : segment_size;
+                handler(message + offset, datagram_size, msg->msg_name, msg->msg_namelen, handler_context);
+
+                udp_batching_context->stats.datagrams_received++;
+            }
+            udp_batching_context->stats.bytes_received += message_size;
+        }
+
+        if (messages_received < UDP_RECV_BATCH_MAX_MESSAGES) {
+            // the socket has been drained, so save the system call that would just say so
+            return 0;
+        }
+    }
+}
@@ -0,0 +1,91 @@
+#ifndef udp_batching__header__INCLUDED
+#define udp_batching__header__INCLUDED
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+
+#include "tquic.h"
+
+#define UDP_SEND_BATCH_MAX_DATAGRAMS 64 // datagrams handed to a single sendmmsg call
+#define UDP_MAX_GSO_SEGMENTS 64         // kernel limit on segments in a single UDP GSO send
+#define UDP_MAX_GSO_PAYLOAD_SIZE 65000  // bytes of UDP payload in a single UDP GSO send
+
+#define UDP_RECV_BATCH_MAX_MESSAGES 16      // messages received by a single recvmmsg call
+#define UDP_RECV_DATAGRAM_BUFFER_SIZE 10000 // receive buffer per message, without UDP GRO
+#define UDP_RECV_GRO_BUFFER_SIZE 65535      // receive buffer per message, with UDP GRO
+
+/*
+ * Rate (in bytes/sec) at which batched datagrams are paced using SO_TXTIME, so that large send
+ * batches are not put on the wire as a single burst. Pacing is disabled when this is 0, and it
+ * only takes effect when the egress interface uses a qdisc that honours transmit times (e.g. fq).
+ */
+#ifndef UDP_PACING_RATE
+#define UDP_PACING_RATE 0
+#endif
+
+/*
+ * Counters of the work done on a UDP socket, used to compare batched and unbatched I/O.
+ */
+typedef struct UdpBatchingStats {
+    uint64_t send_syscalls;
+    uint64_t datagrams_sent;
+    uint64_t bytes_sent;
+
+    uint64_t recv_syscalls;
+    uint64_t datagrams_received;
+    uint64_t bytes_received;
+} UdpBatchingStats;
+
+typedef struct UdpBatchingContext {
+    int socket_fd;
+
+    // socket offloads, enabled if supported by the kernel
+    bool gso_enabled;
+    bool gro_enabled;
+    bool txtime_enabled;
+
+    uint64_t pacing_rate;
+    uint64_t next_txtime_ns;
+
+    // send batch
+    struct iovec send_iovs[UDP_SEND_BATCH_MAX_DATAGRAMS];
+    const void *send_dst_addrs[UDP_SEND_BATCH_MAX_DATAGRAMS];
+    socklen_t send_dst_addr_lens[UDP_SEND_BATCH_MAX_DATAGRAMS];
+    struct mmsghdr *send_msgs; // UDP_SEND_BATCH_MAX_DATAGRAMS messages
+    size_t send_msg_num_datagrams[UDP_SEND_BATCH_MAX_DATAGRAMS];
+    uint8_t send_control[UDP_SEND_BATCH_MAX_DATAGRAMS][64] __attribute__((aligned(8)));
+
+    // receive batch
+    size_t recv_buffer_size;
+    uint8_t *recv_buffers;
+    struct iovec recv_iovs[UDP_RECV_BATCH_MAX_MESSAGES];
+    struct sockaddr_storage recv_peer_addrs[UDP_RECV_BATCH_MAX_MESSAGES];
+    struct mmsghdr *recv_msgs; // UDP_RECV_BATCH_MAX_MESSAGES messages
+    uint8_t recv_control[UDP_RECV_BATCH_MAX_MESSAGES][64] __attribute__((aligned(8)));
+
+    UdpBatchingStats stats;
+} UdpBatchingContext;
+
+/*
+ * Called for each datagram received by 'receive_udp_datagrams_batched'.
+ */
+typedef void (*UdpDatagramHandler)(uint8_t *datagram, size_t datagram_size, struct sockaddr *peer_addr,
+                                   socklen_t peer_addr_len, void *handler_context);
+
+int init_udp_batching_context(UdpBatchingContext *udp_batching_context, int socket_fd);
+
+void free_udp_batching_context(UdpBatchingContext *udp_batching_context);
+
+int send_quic_packets_batched(UdpBatchingContext *udp_batching_context, struct quic_packet_out_spec_t *pkts,
+                              unsigned int count);
+
+int receive_udp_datagrams_batched(UdpBatchingContext *udp_batching_context, UdpDatagramHandler handler,
+                                  void *handler_context);
+
+#endif /* udp_batching__header__INCLUDED */
@@ -0,0 +1,193 @@
+#include "record_buffer_pool.h"
+
+/*
+ * Free buffers of each size class are kept in a singly linked list threaded through the
+ * buffers themselves, so the pool needs no memory of its own.
+ */
+typedef struct FreeRecordBuffer {
+    struct FreeRecordBuffer *next;
+} FreeRecordBuffer;
+
+typedef struct RecordBufferSizeClass {
+    pthread_mutex_t lock;
+    FreeRecordBuffer *free_buffers;
+    size_t num_free_buffers;
+} RecordBufferSizeClass;
+
+#define RECORD_BUFFER_SIZE_CLASS_INIT {PTHREAD_MUTEX_INITIALIZER, NULL, 0}
+
+static RecordBufferSizeClass size_classes[RECORD_BUFFER_POOL_NUM_SIZE_CLASSES] = {
+    [0 ... RECORD_BUFFER_POOL_NUM_SIZE_CLASSES - 1] = RECORD_BUFFER_SIZE_CLASS_INIT};
+
+/*
+ * Returns the index of the smallest size class that fits a buffer of the given capacity, or -1 if
+ * the capacity is too big to be pooled.
+ */
+static int capacity_to_size_class(size_t capacity) {
+    int size_class = 0;
+    while ((((size_t)1) << (size_class + RECORD_BUFFER_POOL_MIN_SIZE_CLASS_SHIFT)) < capacity) {
+        size_class++;
+        if (size_class >= RECORD_BUFFER_POOL_NUM_SIZE_CLASSES) {
+            return -1;
+        }
+    }
+
+    return size_class;
+}
+
+/*
+ * Takes a buffer of at least the given capacity from the pool, allocating a new one if the pool
+ * has none free, and places the actual capacity of the buffer in 'capacity'.
+ *
+ * Returns NULL on failure.
+ */
+static uint8_t *acquire_pooled_buffer(size_t min_capacity, size_t *capacity) {
+    int size_class = capacity_to_size_class(min_capacity);
+    if (size_class < 0) {
+        // too big to be pooled, so allocate exactly what was asked for
+        *capacity = min_capacity;
+        return malloc(min_capacity);
+    }
+
+    RecordBufferSizeClass *class = &size_classes[size_class];
+    *capacity = ((size_t)1) << (size_class + RECORD_BUFFER_POOL_MIN_SIZE_CLASS_SHIFT);
+
+    pthread_mutex_lock(&class->lock);
+    FreeRecordBuffer *free_buffer = class->free_buffers;
+    if (free_buffer != NULL) {
+        class->free_buffers = free_buffer->next;
+        class->num_free_buffers--;
+    }
+    pthread_mutex_unlock(&class->lock);
+
+    if (free_buffer != NULL) {
+        return (uint8_t *)free_buffer;
+    }
+
+    return malloc(*capacity);
+}
+
+/*
+ * Gives the given buffer of the given capacity back to the pool, or frees it if it was not
+ * allocated from the pool or the pool already holds enough free buffers of its size class.
+ */
+static void return_pooled_buffer(uint8_t *buffer, size_t capacity) {
+    if (buffer == NULL) {
+        return;
+    }
+
+    int size_class = capacity_to_size_class(capacity);
+    if (size_class < 0 || (((size_t)1) << (size_class + RECORD_BUFFER_POOL_MIN_SIZE_CLASS_SHIFT)) != capacity) {
+        free(buffer);
+        return;
+    }
+
+    RecordBufferSizeClass *class = &size_classes[size_class];
+
+    pthread_mutex_lock(&class->lock);
+    if (class->num_free_buffers >= RECORD_BUFFER_POOL_MAX_FREE_BUFFERS_PER_SIZE_CLASS) {
+        pthread_mutex_unlock(&class->lock);
+        free(buffer);
+        return;
+    }
+    FreeRecordBuffer *free_buffer = (FreeRecordBuffer *)buffer;
+    free_buffer->next = class->free_buffers;
+    class->free_buffers = free_buffer;
+    class->num_free_buffers++;
+    pthread_mutex_unlock(&class->lock);
+}
+
+/*
+ * Makes sure the given record buffer can hold at least 'min_capacity' bytes, keeping its current contents.
+ *
+ * If 'exact_size' is true, the caller knows the final size of the record, so the buffer is grown straight
+ * to 'min_capacity' bytes. Otherwise the capacity is at least doubled, so that receiving a record in many
+ * fragments only takes a logarithmic number of reallocations.
+ *
+ * Returns 0 on success and > 0 on failure, in which case the record buffer is left unchanged.
+ */
+int reserve_record_buffer(RecordBuffer *record_buffer, size_t min_capacity, bool exact_size) {
+    if (record_buffer == NULL) {
+        return 1;
+    }
+
+    if (record_buffer->capacity >= min_capacity) {
+        return 0;
+    }
+
+    size_t requested_capacity = min_capacity;
+    if (!exact_size && record_buffer->capacity * 2 > requested_capacity) {
+        requested_capacity = record_buffer->capacity * 2;
+    }
+
+    size_t new_capacity = 0;
+    uint8_t *new_data = acquire_pooled_buffer(requested_capacity, &new_capacity);
+    if (new_data == NULL) {
+        fprintf(stderr, "reserve_record_buffer: failed to allocate memory\n");
+        return 2;
+    }
+
+    if (record_buffer->size > 0) {
+        memcpy(new_data, record_buffer->data, record_buffer->size);
+    }
+    return_pooled_buffer(record_buffer->data, record_buffer->capacity);
+
+    record_buffer->data = new_data;
+    record_buffer->capacity = new_capacity;
+
+    return 0;
+}
+
+/*
+ * Empties the given record buffer so that the next record can be received into it, keeping its memory
+ * if it is not larger than RECORD_BUFFER_MAX_RETAINED_CAPACITY.
+ */
+void clear_record_buffer(RecordBuffer *record_buffer) {
+    if (record_buffer == NULL) {
+        return;
+    }
+
+    if (record_buffer->capacity > RECORD_BUFFER_MAX_RETAINED_CAPACITY) {
+        release_record_buffer(record_buffer);
+        return;
+    }
+
+    record_buffer->size = 0;
+}
+
+/*
+ * Gives the memory of the given record buffer back to the pool, and resets the record buffer to empty.
+ *
+ * Does nothing if the given record buffer is NULL.
+ */
+void release_record_buffer(RecordBuffer *record_buffer) {
+    if (record_buffer == NULL) {
+        return;
+    }
+
+    return_pooled_buffer(record_buffer->data, record_buffer->capacity);
+
+    record_buffer->data = NULL;
+    record_buffer->size = 0;
+    record_buffer->capacity = 0;
+}
+
+/*
+ * Frees all free buffers held by the record buffer pool.
+ */
+void clean_up_record_buffer_pool(void) {
+    for (int i = 0; i < RECORD_BUFFER_POOL_NUM_SIZE_CLASSES; i++) {
+        RecordBufferSizeClass *class = &size_classes[i];
+
+        pthread_mutex_lock(&class->lock);
+        FreeRecordBuffer *free_buffer = class->free_buffers;
+        while (free_buffer != NULL) {
+            FreeRecordBuffer *next = free_buffer->next;
+            free(free_buffer);
+            free_buffer = next;
+        }
+        class->free_buffers = NULL;
+        class->num_free_buffers = 0;
+        pthread_mutex_unlock(&class->lock);
+    }
+}
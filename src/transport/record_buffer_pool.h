@@ -0,0 +1,44 @@
+#ifndef record_buffer_pool__header__INCLUDED
+#define record_buffer_pool__header__INCLUDED
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Pooled buffers are handed out in power of 2 size classes from 1 KB to 1 MB. Larger buffers
+ * bypass the pool and are allocated with their exact size.
+ */
+#define RECORD_BUFFER_POOL_MIN_SIZE_CLASS_SHIFT 10
+#define RECORD_BUFFER_POOL_MAX_SIZE_CLASS_SHIFT 20
+#define RECORD_BUFFER_POOL_NUM_SIZE_CLASSES                                                                            \
+    (RECORD_BUFFER_POOL_MAX_SIZE_CLASS_SHIFT - RECORD_BUFFER_POOL_MIN_SIZE_CLASS_SHIFT + 1)
+#define RECORD_BUFFER_POOL_MAX_FREE_BUFFERS_PER_SIZE_CLASS 32
+
+// largest buffer capacity kept by a receiving context between two consecutive records - anything
+// larger bypasses the pool and is given back to the system after each record
+#define RECORD_BUFFER_MAX_RETAINED_CAPACITY (((size_t)1) << RECORD_BUFFER_POOL_MAX_SIZE_CLASS_SHIFT)
+
+/*
+ * A growable buffer for receiving Record Marking records, backed by the record buffer pool.
+ */
+typedef struct RecordBuffer {
+    uint8_t *data;
+    size_t size;
+    size_t capacity;
+} RecordBuffer;
+
+#define RECORD_BUFFER_INIT {NULL, 0, 0}
+
+int reserve_record_buffer(RecordBuffer *record_buffer, size_t min_capacity, bool exact_size);
+
+void clear_record_buffer(RecordBuffer *record_buffer);
+
+void release_record_buffer(RecordBuffer *record_buffer);
+
+void clean_up_record_buffer_pool(void);
+
+#endif /* record_buffer_pool__header__INCLUDED */
@@ -0,0 +1,28 @@
+#ifndef shm_client__HEADER__INCLUDED
+#define shm_client__HEADER__INCLUDED
+
+#include <pthread.h>
+#include <stdint.h>
+
+#include "src/transport/record_buffer_pool.h"
+
+#include "shm_region.h"
+
+typedef struct ShmClient {
+    // the Unix domain socket of the handshake stays open for as long as the connection lives, so that each
+    // side notices when the other process goes away
+    int unix_socket_fd;
+    ShmRegion *shm_region;
+
+    // the rings have a single producer and a single consumer on each side, so RPCs over a connection take
+    // turns on this mutex
+    pthread_mutex_t shm_connection_mutex;
+
+    // RPC replies are all received into the same buffer, guarded by the connection mutex
+    RecordBuffer reply_rpc_msg_buffer;
+
+    // guarded by the connection mutex
+    uint64_t num_rpcs;
+} ShmClient;
+
+#endif /* shm_client__HEADER__INCLUDED */
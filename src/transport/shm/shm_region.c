@@ -0,0 +1,197 @@
+#define _GNU_SOURCE // for memfd_create()
+
+#include "shm_region.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/*
+ * Places the path of the Unix domain socket of the shared-memory server running at the given port number in the
+ * given buffer.
+ *
+ * Returns 0 on success and > 0 on failure.
+ */
+int get_shm_socket_path(uint16_t port_number, char *socket_path, size_t socket_path_size) {
+    int socket_path_len =
+        snprintf(socket_path, socket_path_size, "%s/quic_nfs_shm_%u.sock", SHM_SOCKET_DIR, port_number);
+    if (socket_path_len < 0) {
+        fprintf(stderr, "get_shm_socket_path: failed to format socket path\n");
+        return 1;
+    }
+    if ((size_t)socket_path_len >= socket_path_size) {
+        fprintf(stderr, "get_shm_socket_path: socket path too long\n");
+        return 2;
+    }
+
+    return 0;
+}
+
+/*
+ * Creates an anonymous memory file holding a ShmRegion with two empty rings, maps it into this process, and
+ * places its file descriptor in 'shm_region_fd' so that it can be handed to the client.
+ *
+ * Returns the mapped ShmRegion on success, and NULL on failure.
+ *
+ * The user of this function takes the responsibility to close the file descriptor, and unmap the region
+ * with 'unmap_shm_region'.
+ */
+ShmRegion *create_shm_region(int *shm_region_fd) {
+    int fd = memfd_create("quic_nfs_shm", MFD_CLOEXEC);
+    if (fd < 0) {
+        perror("create_shm_region: memfd_create failed");
+        return NULL;
+    }
+
+    if (ftruncate(fd, sizeof(ShmRegion)) < 0) {
+        perror("create_shm_region: ftruncate failed");
+        close(fd);
+        return NULL;
+    }
+
+    ShmRegion *shm_region = map_shm_region(fd);
+    if (shm_region == NULL) {
+        close(fd);
+        return NULL;
+    }
+
+    init_shm_ring(&shm_region->call_ring);
+    init_shm_ring(&shm_region->reply_ring);
+
+    *shm_region_fd = fd;
+
+    return shm_region;
+}
+
+/*
+ * Maps the ShmRegion in the given memory file into this process.
+ *
+ * Returns the mapped ShmRegion on success, and NULL on failure.
+ */
+ShmRegion *map_shm_region(int shm_region_fd) {
+    // touching a mapping past the end of its file would kill this process with SIGBUS
+    struct stat shm_region_stat;
+    if (fstat(shm_region_fd, &shm_region_stat) < 0 || shm_region_stat.st_size < 0 ||
+        (size_t)shm_region_stat.st_size < sizeof(ShmRegion)) {
+        fprintf(stderr, "map_shm_region: shared memory file is too small\n");
+        return NULL;
+    }
+
+    void *shm_region = mmap(NULL, sizeof(ShmRegion), PROT_READ | PROT_WRITE, MAP_SHARED, shm_region_fd, 0);
+    if (shm_region == MAP_FAILED) {
+        perror("map_shm_region: mmap failed");
+        return NULL;
+    }
+
+    return shm_region;
+}
+
+/*
+ * Unmaps the given ShmRegion from this process.
+ *
+ * Does nothing if the 'shm_region' is NULL.
+ */
+void unmap_shm_region(ShmRegion *shm_region) {
+    if (shm_region == NULL) {
+        return;
+    }
+
+    munmap(shm_region, sizeof(ShmRegion));
+}
+
+/*
+ * Sends the given file descriptor of a shared memory file over the given connected Unix domain socket.
+ *
+ * Returns 0 on success and > 0 on failure.
+ */
+int send_shm_region_fd(int unix_socket_fd, int shm_region_fd) {
+    // at least one byte of data has to be sent along with the file descriptor
+    char data = 0;
+    struct iovec iov = {.iov_base = &data, .iov_len = 1};
+
+    union {
+        struct cmsghdr header;
+        char buffer[CMSG_SPACE(sizeof(int))];
+    } control;
+    memset(&control, 0, sizeof(control));
+
+    struct msghdr msg = {0};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.buffer;
+    msg.msg_controllen = sizeof(control.buffer);
+
+    struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+    memcpy(CMSG_DATA(cmsg), &shm_region_fd, sizeof(int));
+
+    if (sendmsg(unix_socket_fd, &msg, 0) < 0) {
+        perror("send_shm_region_fd: sendmsg failed");
+        return 1;
+    }
+
+    return 0;
+}
+
+/*
+ * Receives the file descriptor of a shared memory file over the given connected Unix domain socket, and places
+ * it in 'shm_region_fd'.
+ *
+ * Returns 0 on success and > 0 on failure.
+ */
+int receive_shm_region_fd(int unix_socket_fd, int *shm_region_fd) {
+    char data;
+    struct iovec iov = {.iov_base = &data, .iov_len = 1};
+
+    union {
+        struct cmsghdr header;
+        char buffer[CMSG_SPACE(sizeof(int))];
+    } control;
+
+    struct msghdr msg = {0};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.buffer;
+    msg.msg_controllen = sizeof(control.buffer);
+
+    if (recvmsg(unix_socket_fd, &msg, MSG_CMSG_CLOEXEC) <= 0) {
+        perror("receive_shm_region_fd: recvmsg failed");
+        return 1;
+    }
+
+    struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+    if (cmsg == NULL || cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS ||
+        cmsg->cmsg_len != CMSG_LEN(sizeof(int))) {
+        fprintf(stderr, "receive_shm_region_fd: server did not send a file descriptor\n");
+        return 2;
+    }
+    memcpy(shm_region_fd, CMSG_DATA(cmsg), sizeof(int));
+
+    return 0;
+}
+
+/*
+ * Returns 0 if the process at the other end of the given connected Unix domain socket has closed it (i.e. it
+ * has released its end of the shared-memory connection, or has exited).
+ *
+ * Returns < 0 if an error occurred, and 1 if the connection is still alive. Never blocks.
+ */
+int is_shm_connection_closed(int unix_socket_fd) {
+    char peek_buffer;
+    ssize_t peek_res = recv(unix_socket_fd, &peek_buffer, 1, MSG_PEEK | MSG_DONTWAIT);
+    if (peek_res < 0) {
+        return errno == EAGAIN || errno == EWOULDBLOCK ? 1 : -1;
+    }
+
+    if (peek_res == 0) {
+        return 0;
+    }
+
+    return 1;
+}
@@ -0,0 +1,41 @@
+#ifndef shm_region__HEADER__INCLUDED
+#define shm_region__HEADER__INCLUDED
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "shm_ring.h"
+
+/*
+ * The Unix domain socket a shared-memory server listens on for the handshakes of new clients is
+ * '<SHM_SOCKET_DIR>/quic_nfs_shm_<port number>.sock', so that clients find it by the same port number they
+ * would use for TCP or QUIC.
+ */
+#ifndef SHM_SOCKET_DIR
+#define SHM_SOCKET_DIR "/tmp"
+#endif
+
+/*
+ * The memory shared between a client and the server - RPC calls go from the client to the server through
+ * the call ring, and RPC replies come back through the reply ring.
+ */
+typedef struct ShmRegion {
+    ShmRing call_ring;
+    ShmRing reply_ring;
+} ShmRegion;
+
+int get_shm_socket_path(uint16_t port_number, char *socket_path, size_t socket_path_size);
+
+ShmRegion *create_shm_region(int *shm_region_fd);
+
+ShmRegion *map_shm_region(int shm_region_fd);
+
+void unmap_shm_region(ShmRegion *shm_region);
+
+int send_shm_region_fd(int unix_socket_fd, int shm_region_fd);
+
+int receive_shm_region_fd(int unix_socket_fd, int *shm_region_fd);
+
+int is_shm_connection_closed(int unix_socket_fd);
+
+#endif /* shm_region__HEADER__INCLUDED */
@@ -0,0 +1,188 @@
+#include "shm_ring.h"
+
+#include <linux/futex.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+/*
+ * The producer owns the tail and the consumer owns the head, so neither needs an atomic read-modify-write -
+ * the producer publishes a record with a release store of the tail, and the consumer frees its space with a
+ * release store of the head.
+ *
+ * Going to sleep on an empty ring is a Dekker-style handshake: the consumer sets 'consumer_waiting' and then
+ * checks the tail, while the producer advances the tail and then checks 'consumer_waiting'. Both use
+ * sequentially consistent operations, so at least one of them sees the other's store, and a record is
+ * never left in the ring with the consumer asleep.
+ */
+
+/*
+ * Tells the CPU that the calling thread is spinning, so that it doesn't starve the other hyper-thread.
+ */
+static inline void spin_pause(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+/*
+ * Returns the number of times a consumer should check an empty ring before going to sleep on it. On a single
+ * CPU, spinning only delays the producer it is waiting for, so the consumer goes to sleep straight away.
+ */
+static int get_shm_ring_spin_iterations(void) {
+    static int spin_iterations = -1;
+
+    if (spin_iterations < 0) {
+        spin_iterations = sysconf(_SC_NPROCESSORS_ONLN) > 1 ? SHM_RING_SPIN_ITERATIONS : 0;
+    }
+
+    return spin_iterations;
+}
+
+/*
+ * Initializes the given shared-memory ring to an empty ring.
+ */
+void init_shm_ring(ShmRing *shm_ring) {
+    shm_ring->tail = 0;
+    shm_ring->head = 0;
+
+    shm_ring->wakeup_sequence = 0;
+    shm_ring->consumer_waiting = 0;
+}
+
+/*
+ * Copies the given data into the ring, starting at the given position and wrapping around its end.
+ */
+static void copy_into_shm_ring(ShmRing *shm_ring, uint64_t position, const uint8_t *data, size_t size) {
+    size_t offset = position & (SHM_RING_CAPACITY - 1);
+    size_t first_chunk_size = SHM_RING_CAPACITY - offset < size ? SHM_RING_CAPACITY - offset : size;
+
+    memcpy(shm_ring->data + offset, data, first_chunk_size);
+    memcpy(shm_ring->data, data + first_chunk_size, size - first_chunk_size);
+}
+
+/*
+ * Copies data out of the ring into the given buffer, starting at the given position and wrapping around its end.
+ */
+static void copy_out_of_shm_ring(ShmRing *shm_ring, uint64_t position, uint8_t *data, size_t size) {
+    size_t offset = position & (SHM_RING_CAPACITY - 1);
+    size_t first_chunk_size = SHM_RING_CAPACITY - offset < size ? SHM_RING_CAPACITY - offset : size;
+
+    memcpy(data, shm_ring->data + offset, first_chunk_size);
+    memcpy(data + first_chunk_size, shm_ring->data, size - first_chunk_size);
+}
+
+/*
+ * Appends the given record to the given shared-memory ring, and wakes up the consumer if it is asleep waiting
+ * for a record. Must only be called by the ring's single producer.
+ *
+ * Returns 0 on success and > 0 on failure, if the record doesn't fit in the free space of the ring.
+ */
+int write_to_shm_ring(ShmRing *shm_ring, const uint8_t *record_data, size_t record_size) {
+    uint64_t tail = shm_ring->tail;
+    uint64_t head = __atomic_load_n(&shm_ring->head, __ATOMIC_ACQUIRE);
+
+    size_t free_space = SHM_RING_CAPACITY - (tail - head);
+    if (record_size > UINT32_MAX || SHM_RING_RECORD_HEADER_SIZE + record_size > free_space) {
+        fprintf(stderr, "write_to_shm_ring: record of size %zu does not fit in the ring\n", record_size);
+        return 1;
+    }
+
+    uint32_t record_header = record_size;
+    copy_into_shm_ring(shm_ring, tail, (const uint8_t *)&record_header, SHM_RING_RECORD_HEADER_SIZE);
+    copy_into_shm_ring(shm_ring, tail + SHM_RING_RECORD_HEADER_SIZE, record_data, record_size);
+
+    __atomic_store_n(&shm_ring->tail, tail + SHM_RING_RECORD_HEADER_SIZE + record_size, __ATOMIC_SEQ_CST);
+
+    // the system call is only made if the consumer found the ring empty and is going to sleep
+    if (__atomic_load_n(&shm_ring->consumer_waiting, __ATOMIC_SEQ_CST)) {
+        __atomic_fetch_add(&shm_ring->wakeup_sequence, 1, __ATOMIC_SEQ_CST);
+        syscall(SYS_futex, &shm_ring->wakeup_sequence, FUTEX_WAKE, 1, NULL, NULL, 0);
+    }
+
+    return 0;
+}
+
+/*
+ * Returns true if there are no records in the given shared-memory ring.
+ */
+bool is_shm_ring_empty(ShmRing *shm_ring) {
+    return __atomic_load_n(&shm_ring->tail, __ATOMIC_ACQUIRE) == shm_ring->head;
+}
+
+/*
+ * Waits until there is a record in the given shared-memory ring. Must only be called by the ring's single
+ * consumer.
+ *
+ * The consumer first spins on the ring for a while, since the other process usually answers within a few
+ * microseconds, and then sleeps on it for at most SHM_RING_WAIT_TIMEOUT_MS.
+ *
+ * Returns 0 if there is a record in the ring, and > 0 if the wait timed out.
+ */
+int wait_for_shm_ring_record(ShmRing *shm_ring) {
+    int spin_iterations = get_shm_ring_spin_iterations();
+    for (int i = 0; i < spin_iterations; i++) {
+        if (!is_shm_ring_empty(shm_ring)) {
+            return 0;
+        }
+        spin_pause();
+    }
+
+    uint32_t wakeup_sequence = __atomic_load_n(&shm_ring->wakeup_sequence, __ATOMIC_SEQ_CST);
+    __atomic_store_n(&shm_ring->consumer_waiting, 1, __ATOMIC_SEQ_CST);
+
+    // the producer may have written a record before it could see that the consumer is waiting
+    if (__atomic_load_n(&shm_ring->tail, __ATOMIC_SEQ_CST) != shm_ring->head) {
+        __atomic_store_n(&shm_ring->consumer_waiting, 0, __ATOMIC_RELAXED);
+        return 0;
+    }
+
+    // the mapping is shared between processes, so this can't be a private futex
+    struct timespec timeout = {SHM_RING_WAIT_TIMEOUT_MS / 1000, (SHM_RING_WAIT_TIMEOUT_MS % 1000) * 1000000};
+    syscall(SYS_futex, &shm_ring->wakeup_sequence, FUTEX_WAIT, wakeup_sequence, &timeout, NULL, 0);
+
+    __atomic_store_n(&shm_ring->consumer_waiting, 0, __ATOMIC_RELAXED);
+
+    return is_shm_ring_empty(shm_ring) ? 1 : 0;
+}
+
+/*
+ * Takes the oldest record out of the given shared-memory ring, and places it in the given record buffer. Must
+ * only be called by the ring's single consumer, once 'wait_for_shm_ring_record' has found a record in the ring.
+ *
+ * The other process may write anything to the shared memory, so the record is checked against the ring's
+ * bounds before it is copied out.
+ *
+ * Returns 0 on success and > 0 on failure.
+ */
+int read_from_shm_ring(ShmRing *shm_ring, RecordBuffer *record) {
+    uint64_t head = shm_ring->head;
+    uint64_t tail = __atomic_load_n(&shm_ring->tail, __ATOMIC_ACQUIRE);
+
+    uint64_t available = tail - head;
+    if (available < SHM_RING_RECORD_HEADER_SIZE || available > SHM_RING_CAPACITY) {
+        fprintf(stderr, "read_from_shm_ring: ring holds an invalid number of bytes %lu\n", available);
+        return 1;
+    }
+
+    uint32_t record_size;
+    copy_out_of_shm_ring(shm_ring, head, (uint8_t *)&record_size, SHM_RING_RECORD_HEADER_SIZE);
+    if (record_size > available - SHM_RING_RECORD_HEADER_SIZE) {
+        fprintf(stderr, "read_from_shm_ring: record of size %u overruns the ring\n", record_size);
+        return 2;
+    }
+
+    if (reserve_record_buffer(record, record_size, true) > 0) {
+        return 3;
+    }
+    copy_out_of_shm_ring(shm_ring, head + SHM_RING_RECORD_HEADER_SIZE, record->data, record_size);
+    record->size = record_size;
+
+    __atomic_store_n(&shm_ring->head, head + SHM_RING_RECORD_HEADER_SIZE + record_size, __ATOMIC_RELEASE);
+
+    return 0;
+}
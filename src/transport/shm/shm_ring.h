@@ -0,0 +1,58 @@
+#ifndef shm_ring__HEADER__INCLUDED
+#define shm_ring__HEADER__INCLUDED
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "src/transport/record_buffer_pool.h"
+
+/*
+ * Number of bytes a shared-memory ring can hold, must be a power of 2. A client has at most one RPC call in
+ * its call ring and one RPC reply in its reply ring at a time, so this bounds the size of a single RPC message,
+ * and must leave room for a READ or WRITE of NFS_MAX_TRANSFER_SIZE bytes along with the rest of its message.
+ */
+#define SHM_RING_CAPACITY (2 * 1024 * 1024)
+
+#define SHM_RING_CACHE_LINE_SIZE 64
+
+// each record in a ring is its size in bytes, followed by its data
+#define SHM_RING_RECORD_HEADER_SIZE sizeof(uint32_t)
+
+// number of times a consumer checks an empty ring before going to sleep on it, if there is more than one CPU for
+// the other process to run on while it spins
+#define SHM_RING_SPIN_ITERATIONS 2000
+
+// longest time in milliseconds a consumer sleeps on an empty ring before giving its caller a chance to check
+// whether the other process is still alive
+#define SHM_RING_WAIT_TIMEOUT_MS 1000
+
+/*
+ * A lock-free single-producer single-consumer ring of variable-size records, placed in memory shared between
+ * two processes. Head and tail positions only ever grow, and are reduced modulo the capacity when indexing.
+ *
+ * The consumer sleeps on 'wakeup_sequence' as a futex when it finds the ring empty, and the producer only
+ * makes the wakeup system call if the consumer has said it is going to sleep.
+ */
+typedef struct ShmRing {
+    // the producer and the consumer each get their own cache line
+    uint64_t tail __attribute__((aligned(SHM_RING_CACHE_LINE_SIZE)));
+    uint64_t head __attribute__((aligned(SHM_RING_CACHE_LINE_SIZE)));
+
+    uint32_t wakeup_sequence __attribute__((aligned(SHM_RING_CACHE_LINE_SIZE)));
+    uint32_t consumer_waiting;
+
+    uint8_t data[SHM_RING_CAPACITY] __attribute__((aligned(SHM_RING_CACHE_LINE_SIZE)));
+} ShmRing;
+
+void init_shm_ring(ShmRing *shm_ring);
+
+int write_to_shm_ring(ShmRing *shm_ring, const uint8_t *record_data, size_t record_size);
+
+bool is_shm_ring_empty(ShmRing *shm_ring);
+
+int wait_for_shm_ring_record(ShmRing *shm_ring);
+
+int read_from_shm_ring(ShmRing *shm_ring, RecordBuffer *record);
+
+#endif /* shm_ring__HEADER__INCLUDED */
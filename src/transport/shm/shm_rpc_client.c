@@ -0,0 +1,141 @@
+#include "shm_rpc_client.h"
+
+/*
+ * Waits for the RPC reply in the reply ring of the given shared-memory client, checking that the server is
+ * still alive whenever the wait times out.
+ *
+ * Returns 0 once there is a reply in the ring, and > 0 if the server has gone away.
+ */
+static int wait_for_rpc_reply_shm(ShmClient *shm_client) {
+    while (wait_for_shm_ring_record(&shm_client->shm_region->reply_ring) > 0) {
+        if (is_shm_connection_closed(shm_client->unix_socket_fd) <= 0) {
+            fprintf(stderr, "wait_for_rpc_reply_shm: the server has closed the shared-memory connection\n");
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/*
+ * Sends an RPC call for the given program number, program version, procedure number, and parameters,
+ * through the call ring shared with the server inside the given RpcConnectionContext.
+ *
+ * Returns the RPC reply received from the server on success, and NULL on failure.
+ *
+ * The user of this function takes on the responsibility to call 'rpc__rpc_msg__free_unpacked(rpc_reply, NULL)'
+ * when it's done using the rpc_reply and it's subfields (e.g. procedure parameters).
+ */
+Rpc__RpcMsg *execute_rpc_call_shm(RpcConnectionContext *rpc_connection_context, Rpc__RpcMsg *call_rpc_msg) {
+    if (rpc_connection_context == NULL) {
+        return NULL;
+    }
+
+    if (rpc_connection_context->transport_connection == NULL) {
+        return NULL;
+    }
+
+    ShmClient *shm_client = rpc_connection_context->transport_connection->shm_client;
+    if (shm_client == NULL || shm_client->shm_region == NULL) {
+        return NULL;
+    }
+
+    if (call_rpc_msg == NULL) {
+        return NULL;
+    }
+
+    // serialize RpcMsg around the procedure parameters
+    EncodedRpcMsg encoded_rpc_msg;
+    int error_code = encode_rpc_msg(rpc_connection_context->rpc_codec, call_rpc_msg, &encoded_rpc_msg);
+    if (error_code > 0) {
+        return NULL;
+    }
+
+    pthread_mutex_lock(&shm_client->shm_connection_mutex);
+
+    // place the serialized RpcMsg in the call ring as a single record
+    error_code = write_to_shm_ring(&shm_client->shm_region->call_ring, encoded_rpc_msg.data, encoded_rpc_msg.size);
+    free_encoded_rpc_msg(&encoded_rpc_msg);
+    if (error_code > 0) {
+        pthread_mutex_unlock(&shm_client->shm_connection_mutex);
+        return NULL;
+    }
+
+    // take the RPC reply out of the reply ring
+    error_code = wait_for_rpc_reply_shm(shm_client);
+    if (error_code > 0) {
+        pthread_mutex_unlock(&shm_client->shm_connection_mutex);
+        return NULL;
+    }
+    error_code = read_from_shm_ring(&shm_client->shm_region->reply_ring, &shm_client->reply_rpc_msg_buffer);
+    if (error_code > 0) {
+        pthread_mutex_unlock(&shm_client->shm_connection_mutex);
+        return NULL;
+    }
+
+    // the reply buffer is reused by the next RPC on this connection, so deserialize before releasing the connection
+    Rpc__RpcMsg *reply_rpc_msg =
+        deserialize_rpc_msg(rpc_connection_context->rpc_codec, shm_client->reply_rpc_msg_buffer.data,
+                            shm_client->reply_rpc_msg_buffer.size, call_rpc_msg->cbody);
+    clear_record_buffer(&shm_client->reply_rpc_msg_buffer);
+
+    shm_client->num_rpcs++;
+
+    pthread_mutex_unlock(&shm_client->shm_connection_mutex);
+
+    return reply_rpc_msg;
+}
+
+/*
+ * Given the RPC program number to be called, program version, procedure number, and the parameters for it, calls
+ * the appropriate remote procedure over shared memory.
+ *
+ * The value of the 'parameters' must have been allocated with 'allocate_rpc_payload_buffer', as the RPC call is
+ * serialized around it.
+ *
+ * Returns the server's RPC reply on success, and NULL on failure.
+ *
+ * The user of this function takes the responsibility to call 'rpc__rpc_msg__free_unpacked(rpc_reply, NULL)'
+ * when it's done using the rpc_reply and it's subfields (e.g. procedure parameters).
+ */
+Rpc__RpcMsg *invoke_rpc_remote_shm(RpcConnectionContext *rpc_connection_context, uint32_t program_number,
+                                   uint32_t program_version, uint32_t procedure_number,
+                                   Google__Protobuf__Any parameters) {
+    if (rpc_connection_context == NULL) {
+        fprintf(stderr, "RpcConnectionContext is NULL\n");
+        return NULL;
+    }
+
+    Rpc__CallBody call_body = RPC__CALL_BODY__INIT;
+    call_body.rpcvers = 2;
+    call_body.prog = program_number;
+    call_body.vers = program_version;
+    call_body.proc = procedure_number;
+
+    // once the server has handed out a short handle for the credential, the handle is sent in its place
+    Rpc__OpaqueAuth short_credential;
+    uint8_t short_handle[MAX_AUTH_SHORT_SIZE];
+    call_body.credential = get_rpc_call_credential(rpc_connection_context, &short_credential, short_handle);
+    call_body.verifier = rpc_connection_context->verifier;
+
+    call_body.params = &parameters;
+
+    Rpc__RpcMsg call_rpc_msg = RPC__RPC_MSG__INIT;
+    call_rpc_msg.xid = generate_rpc_xid();
+    call_rpc_msg.mtype = RPC__MSG_TYPE__CALL;
+    call_rpc_msg.body_case = RPC__RPC_MSG__BODY_CBODY; // this body_case enum is not actually sent over the network
+    call_rpc_msg.cbody = &call_body;
+
+    Rpc__RpcMsg *reply_rpc_msg = execute_rpc_call_shm(rpc_connection_context, &call_rpc_msg);
+    if (update_auth_short_handle(rpc_connection_context, reply_rpc_msg, call_body.credential == &short_credential)) {
+        // the server does not know the short handle (anymore), so the call is sent again with the full credential
+        rpc__rpc_msg__free_unpacked(reply_rpc_msg, NULL);
+
+        call_body.credential = rpc_connection_context->credential;
+        call_rpc_msg.xid = generate_rpc_xid();
+        reply_rpc_msg = execute_rpc_call_shm(rpc_connection_context, &call_rpc_msg);
+        update_auth_short_handle(rpc_connection_context, reply_rpc_msg, false);
+    }
+
+    return reply_rpc_msg;
+}
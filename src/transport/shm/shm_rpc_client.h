@@ -0,0 +1,21 @@
+#ifndef shm_rpc_client__header__INCLUDED
+#define shm_rpc_client__header__INCLUDED
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "src/serialization/rpc/rpc.pb-c.h"
+
+#include "src/common_rpc/common_rpc.h"
+#include "src/common_rpc/rpc_connection_context.h"
+
+#include "shm_region.h"
+#include "shm_ring.h"
+
+Rpc__RpcMsg *invoke_rpc_remote_shm(RpcConnectionContext *rpc_connection_context, uint32_t program_number,
+                                   uint32_t program_version, uint32_t procedure_number,
+                                   Google__Protobuf__Any parameters);
+
+#endif /* shm_rpc_client__header__INCLUDED */
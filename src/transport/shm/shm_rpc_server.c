@@ -0,0 +1,377 @@
+#include "shm_rpc_server.h"
+
+#include "src/nfs/server/server.h"
+
+#include "src/nfs/server/nfs_server_threads.h"
+
+#include <sys/un.h>
+
+/*
+ *  Define shared-memory Nfs+Mount server state.
+ */
+
+int shm_server_socket_fd;
+static char shm_server_socket_path[sizeof(((struct sockaddr_un *)0)->sun_path)];
+
+pthread_mutex_t shm_server_cleanup_mutex = PTHREAD_MUTEX_INITIALIZER;
+bool shm_server_resources_released = false;
+
+/*
+ * Sends the given ReplyBody back to the RPC client in a RpcMsg, given the region shared with that client.
+ *
+ * Returns 0 on success, and > 0 on failure.
+ */
+static int send_rpc_reply_body_shm(void *reply_destination, Rpc__ReplyBody *reply_body) {
+    ShmRegion *shm_region = reply_destination;
+
+    Rpc__RpcMsg rpc_msg = RPC__RPC_MSG__INIT;
+    rpc_msg.xid = generate_rpc_xid();
+    rpc_msg.mtype = RPC__MSG_TYPE__REPLY;
+    rpc_msg.body_case = RPC__RPC_MSG__BODY_RBODY; // this body_case enum is not actually sent over the network
+    rpc_msg.rbody = reply_body;
+
+    // serialize the RpcMsg around the procedure results, if it has any
+    EncodedRpcMsg encoded_rpc_msg;
+    int error_code = encode_rpc_msg(get_rpc_call_codec(), &rpc_msg, &encoded_rpc_msg);
+    if (error_code > 0) {
+        return 1;
+    }
+
+    // place the serialized RpcMsg in the reply ring as a single record
+    error_code = write_to_shm_ring(&shm_region->reply_ring, encoded_rpc_msg.data, encoded_rpc_msg.size);
+    free_encoded_rpc_msg(&encoded_rpc_msg);
+    if (error_code > 0) {
+        return 2;
+    }
+
+    return 0;
+}
+
+/*
+ * Decodes the RPC call taken into the given record buffer, runs it, and puts the reply into the reply ring of the
+ * given shared region.
+ *
+ * Returns 0 on success and > 0 on failure.
+ */
+static int serve_rpc_call_shm(ShmRegion *shm_region, RecordBuffer *rpc_msg_buffer) {
+    int error_code;
+
+    RpcReplySender reply_sender = {.send_reply_body = send_rpc_reply_body_shm, .reply_destination = shm_region};
+
+    // the call is replied to in the codec it arrived in
+    RpcCodec codec = detect_rpc_codec(rpc_msg_buffer->data, rpc_msg_buffer->size);
+    set_rpc_call_codec(codec);
+
+    // the procedure parameters are left in the record buffer, so it is only cleared once they have been used
+    Rpc__RpcMsg *rpc_call = decode_rpc_msg_in_place(codec, rpc_msg_buffer->data, rpc_msg_buffer->size);
+    if (rpc_call == NULL) {
+        return 2; // invalid RPC received, no reply given
+    }
+    log_rpc_msg_info(rpc_call);
+
+    if (rpc_call->mtype != RPC__MSG_TYPE__CALL || rpc_call->body_case != RPC__RPC_MSG__BODY_CBODY) {
+        fprintf(stderr, "Server received an RPC reply but it should only be receiving RPC calls.\n");
+        return 3; // invalid RPC received, no reply given
+    }
+
+    Rpc__CallBody *call_body = rpc_call->cbody;
+    if (call_body == NULL) {
+        return 4; // invalid RPC received, no reply given
+    }
+
+    // check RPC version
+    if (call_body->rpcvers != 2) {
+        fprintf(stdout, "Server received an RPC call with RPC version not equal to 2.\n");
+
+        Rpc__RejectedReply *rejected_reply = create_rpc_mismatch_rejected_reply(2, 2);
+
+        error_code = send_rpc_rejected_reply_message(&reply_sender, rejected_reply);
+        free_rejected_reply(rejected_reply);
+        if (error_code > 0) {
+            fprintf(stdout, "Server failed to send RPC mismatch RejectedReply\n");
+            return 5;
+        }
+
+        return 0;
+    }
+
+    // check authentication fields
+    error_code = validate_credential_and_verifier(&reply_sender, call_body->credential, call_body->verifier);
+    if (error_code != 0) {
+        return 6;
+    }
+    log_rpc_call_body_info(call_body);
+    // a short credential is replaced by the AUTH_SYS credential it stands for
+    Rpc__OpaqueAuth *credential = resolve_rpc_call_credential(call_body->credential);
+    if (credential == NULL) {
+        return send_auth_error_rejected_reply(
+            &reply_sender, "Server received an RPC call with an AUTH_SHORT credential it does not know.\n",
+            RPC__AUTH_STAT__AUTH_REJECTEDCRED);
+    }
+    if (credential->flavor == RPC__AUTH_FLAVOR__AUTH_NONE && call_body->proc != 0) {
+        // only NULL procedure is allowed to use AUTH_NONE flavor
+        return send_auth_error_rejected_reply(
+            &reply_sender,
+            "Server received an RPC call with authentication flavor AUTH_NONE for a non-NULL procedure.\n",
+            RPC__AUTH_STAT__AUTH_TOOWEAK);
+    }
+
+    // reply with a AcceptedReply
+    Google__Protobuf__Any *parameters = call_body->params;
+
+    Rpc__AcceptedReply *accepted_reply = forward_rpc_call_to_program(
+        credential, call_body->verifier, call_body->prog, call_body->vers, call_body->proc, parameters);
+    if (credential != call_body->credential) {
+        free_opaque_auth(credential);
+    }
+    free_rpc_msg_decoded_in_place(rpc_call, rpc_msg_buffer->data, rpc_msg_buffer->size);
+    clear_record_buffer(rpc_msg_buffer);
+
+    error_code = send_rpc_accepted_reply_message(&reply_sender, accepted_reply);
+    free_accepted_reply(accepted_reply);
+    if (error_code > 0) {
+        fprintf(stdout, "Server failed to send AcceptedReply\n");
+        return 7;
+    }
+
+    return 0;
+}
+
+/*
+ * Takes a region shared with a client that has a RPC call in its call ring, and takes that RPC out of the ring
+ * into the given record buffer and processes it.
+ *
+ * Returns 0 on success and > 0 on failure.
+ */
+int process_single_rpc_shm(ShmRegion *shm_region, RecordBuffer *rpc_msg_buffer) {
+    // take one RPC call out of the call ring
+    int error_code = read_from_shm_ring(&shm_region->call_ring, rpc_msg_buffer);
+    if (error_code > 0) {
+        return 1; // failed to receive the RPC, no reply given
+    }
+
+    // everything built while serving the RPC is taken from the arena of this thread, and released at once afterwards
+    begin_rpc_arena();
+    error_code = serve_rpc_call_shm(shm_region, rpc_msg_buffer);
+    end_rpc_arena();
+
+    return error_code;
+}
+
+/*
+ * Function for a single NFS thread to wait for RPCs from a client on the same host in the memory shared with
+ * it, and respond to them.
+ */
+void *handle_client_shm(void *arg) {
+    pthread_t tid = pthread_self();
+
+    ShmClient *shm_client = (ShmClient *)arg;
+    if (shm_client == NULL) {
+        fprintf(stderr, "handle_client_shm: server thread received a NULL shared-memory client\n");
+
+        remove_server_thread(tid, &nfs_server_threads_list);
+
+        return NULL;
+    }
+
+    // RPCs from this client are all received into the same buffer
+    RecordBuffer rpc_msg_buffer = RECORD_BUFFER_INIT;
+
+    while (1) {
+        if (wait_for_shm_ring_record(&shm_client->shm_region->call_ring) > 0) {
+            // no RPC for a while, so check that the client is still there
+            int status = is_shm_connection_closed(shm_client->unix_socket_fd);
+            if (status < 0) {
+                perror_msg("handle_client_shm: server thread failed to check if the client is alive\n");
+
+                release_record_buffer(&rpc_msg_buffer);
+                remove_server_thread(tid, &nfs_server_threads_list);
+
+                return NULL;
+            } else if (status == 0) {
+                // the client has closed its end of the connection, so terminate this server thread
+                release_record_buffer(&rpc_msg_buffer);
+                remove_server_thread(tid, &nfs_server_threads_list);
+
+                return NULL;
+            }
+
+            pthread_testcancel();
+            continue;
+        }
+
+        int error_code = process_single_rpc_shm(shm_client->shm_region, &rpc_msg_buffer);
+        if (error_code > 0) {
+            fprintf(stderr, "handle_client_shm: server thread failed to process a RPC with status %d\n", error_code);
+
+            release_record_buffer(&rpc_msg_buffer);
+            remove_server_thread(tid, &nfs_server_threads_list);
+
+            return NULL;
+        }
+    }
+
+    return NULL;
+}
+
+/*
+ * Frees all resources used by the shared-memory server.
+ *
+ * This function executes atomically and checks a flag that says if the
+ * resources have already been released, so that concurrent cleanups
+ * initiated from different places do not cause double free errors.
+ *
+ * Does nothing if the shared-memory server resources have already been released.
+ */
+void release_shm_server_resources(void) {
+    pthread_mutex_lock(&shm_server_cleanup_mutex);
+    if (shm_server_resources_released) {
+        pthread_mutex_unlock(&shm_server_cleanup_mutex);
+        return;
+    }
+
+    close(shm_server_socket_fd);
+    unlink(shm_server_socket_path);
+
+    shm_server_resources_released = true;
+    pthread_mutex_unlock(&shm_server_cleanup_mutex);
+}
+
+/*
+ * Cleans up all shared-memory server state.
+ *
+ * Can be called from signal handlers to ensure graceful shutdown.
+ */
+void clean_up_shm_server_state(void) {
+    release_shm_server_resources();
+}
+
+/*
+ * Hands a region of shared memory to the client that has just connected to the given Unix domain socket.
+ *
+ * Returns the shared-memory client for the new connection on success, and NULL on failure.
+ */
+static ShmClient *accept_shm_client(int unix_socket_fd) {
+    ShmClient *shm_client = malloc(sizeof(ShmClient));
+    if (shm_client == NULL) {
+        fprintf(stderr, "accept_shm_client: server failed to allocate a new shared-memory client\n");
+        return NULL;
+    }
+
+    int shm_region_fd;
+    shm_client->shm_region = create_shm_region(&shm_region_fd);
+    if (shm_client->shm_region == NULL) {
+        free(shm_client);
+        return NULL;
+    }
+
+    // the client maps the region itself, after which the memory file isn't needed anymore
+    int error_code = send_shm_region_fd(unix_socket_fd, shm_region_fd);
+    close(shm_region_fd);
+    if (error_code > 0) {
+        unmap_shm_region(shm_client->shm_region);
+        free(shm_client);
+        return NULL;
+    }
+
+    shm_client->unix_socket_fd = unix_socket_fd;
+    RecordBuffer empty_record_buffer = RECORD_BUFFER_INIT;
+    shm_client->reply_rpc_msg_buffer = empty_record_buffer;
+    shm_client->num_rpcs = 0;
+
+    return shm_client;
+}
+
+/*
+ * Runs the Nfs+Mount server, which awaits RPCs, over shared memory. Clients on the same host connect to a Unix
+ * domain socket named after the given port number, through which they are handed a region of shared memory.
+ *
+ * Returns > 0 on failure.
+ */
+int run_server_shm(uint16_t port_number) {
+    if (get_shm_socket_path(port_number, shm_server_socket_path, sizeof(shm_server_socket_path)) > 0) {
+        return 1;
+    }
+
+    // create the server socket
+    shm_server_socket_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (shm_server_socket_fd < 0) {
+        fprintf(stderr, "run_server_shm: socket creation failed\n");
+        return 1;
+    }
+
+    struct sockaddr_un shm_server_addr;
+    memset(&shm_server_addr, 0, sizeof(shm_server_addr));
+    shm_server_addr.sun_family = AF_UNIX;
+    strcpy(shm_server_addr.sun_path, shm_server_socket_path);
+
+    // remove the socket left behind by a previous server at this port
+    unlink(shm_server_socket_path);
+
+    // bind socket to the path of the server socket
+    if (bind(shm_server_socket_fd, (struct sockaddr *)&shm_server_addr, sizeof(shm_server_addr)) < 0) {
+        fprintf(stderr, "run_server_shm: socket bind failed\n");
+        close(shm_server_socket_fd);
+        return 1;
+    }
+
+    // listen for connections on the socket
+    if (listen(shm_server_socket_fd, 10) < 0) {
+        fprintf(stderr, "run_server_shm: listen failed\n");
+        close(shm_server_socket_fd);
+        unlink(shm_server_socket_path);
+        return 1;
+    }
+
+    fprintf(stdout, "Server listening on %s... (shared memory)\n", shm_server_socket_path);
+
+    while (1) {
+        int unix_socket_fd = accept(shm_server_socket_fd, NULL, NULL);
+        if (unix_socket_fd < 0) {
+            fprintf(stderr, "run_server_shm: server failed to accept connection\n");
+            break;
+        }
+
+        ShmClient *shm_client = accept_shm_client(unix_socket_fd);
+        if (shm_client == NULL) {
+            fprintf(stderr, "run_server_shm: server failed to set up shared memory for a new client\n");
+
+            close(unix_socket_fd);
+
+            continue;
+        }
+
+        // start a new thread for handling this client
+        pthread_t server_thread;
+        if (pthread_create(&server_thread, NULL, handle_client_shm, shm_client) != 0) {
+            fprintf(stderr, "run_server_shm: server failed to create a new client-handling thread\n");
+
+            close(unix_socket_fd);
+            unmap_shm_region(shm_client->shm_region);
+            free(shm_client);
+
+            break;
+        }
+
+        TransportConnection transport_connection;
+        transport_connection.shm_client = shm_client;
+        int error_code =
+            add_server_thread(server_thread, TRANSPORT_PROTOCOL_SHM, transport_connection, &nfs_server_threads_list);
+        if (error_code > 0) {
+            fprintf(stderr, "run_server_shm: server failed to add a new entry in the NFS server threads list\n");
+
+            pthread_cancel(server_thread);
+            pthread_join(server_thread, NULL);
+
+            close(unix_socket_fd);
+            unmap_shm_region(shm_client->shm_region);
+            free(shm_client);
+
+            break;
+        }
+    }
+
+    clean_up_shm_server_state();
+
+    return 0;
+}
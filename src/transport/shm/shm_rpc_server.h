@@ -0,0 +1,29 @@
+#ifndef shm_rpc_server__header__INCLUDED
+#define shm_rpc_server__header__INCLUDED
+
+#include <pthread.h>
+#include <stdbool.h>
+
+#include "src/serialization/rpc/rpc.pb-c.h"
+
+#include "src/common_rpc/common_rpc.h"
+#include "src/common_rpc/server_common_rpc.h"
+
+#include "src/transport/shm/shm_region.h"
+#include "src/transport/shm/shm_ring.h"
+#include "src/transport/transport_common.h"
+
+int run_server_shm(uint16_t port_number);
+
+/*
+ * Shared-memory Nfs+Mount server state.
+ */
+
+extern int shm_server_socket_fd;
+
+extern pthread_mutex_t shm_server_cleanup_mutex;
+extern bool shm_server_resources_released;
+
+void clean_up_shm_server_state(void);
+
+#endif /* shm_rpc_server__header__INCLUDED */
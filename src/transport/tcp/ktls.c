@@ -0,0 +1,338 @@
+#include "ktls.h"
+
+#include <linux/tls.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+
+#include <openssl/err.h>
+#include <openssl/hmac.h>
+
+#ifndef SOL_TLS
+#define SOL_TLS 282
+#endif
+
+/*
+ * The TLS handshake is done in userspace, and the record layer is then handed to the kernel (kTLS), so that the
+ * connection's socket can be used with plain send() and recv() like any TCP socket - encryption happens in the
+ * kernel, and the TCP Record Marking code works on the socket unchanged.
+ *
+ * TLS 1.3 is required, and the server sends no session tickets, so that no TLS message other than application
+ * data is ever sent after the handshake - those would have to be handled by the userspace TLS library, which
+ * is gone by then. Since no application data goes through the library, the record sequence numbers in both
+ * directions start at 0 when the kernel takes over.
+ */
+
+/*
+ * Key log callback that saves the client and server application traffic secrets of the handshake in the
+ * KtlsSecrets attached to the given SSL connection. Key log lines are '<label> <client random> <secret>' with
+ * the client random and secret in hex.
+ */
+static void save_ktls_secret(const SSL *ssl, const char *line) {
+    KtlsSecrets *ktls_secrets = SSL_get_app_data(ssl);
+    if (ktls_secrets == NULL) {
+        return;
+    }
+
+    uint8_t *secret;
+    size_t *secret_size;
+    if (strncmp(line, "CLIENT_TRAFFIC_SECRET_0 ", strlen("CLIENT_TRAFFIC_SECRET_0 ")) == 0) {
+        secret = ktls_secrets->client_secret;
+        secret_size = &ktls_secrets->client_secret_size;
+    } else if (strncmp(line, "SERVER_TRAFFIC_SECRET_0 ", strlen("SERVER_TRAFFIC_SECRET_0 ")) == 0) {
+        secret = ktls_secrets->server_secret;
+        secret_size = &ktls_secrets->server_secret_size;
+    } else {
+        return;
+    }
+
+    const char *secret_hex = strrchr(line, ' ');
+    if (secret_hex == NULL) {
+        return;
+    }
+    secret_hex++;
+
+    size_t secret_hex_len = strlen(secret_hex);
+    if (secret_hex_len % 2 != 0 || secret_hex_len / 2 > KTLS_MAX_SECRET_SIZE) {
+        return;
+    }
+
+    for (size_t i = 0; i < secret_hex_len / 2; i++) {
+        unsigned int byte;
+        if (sscanf(secret_hex + 2 * i, "%2x", &byte) != 1) {
+            return;
+        }
+        secret[i] = byte;
+    }
+    *secret_size = secret_hex_len / 2;
+}
+
+/*
+ * Creates a TLS context with the settings shared by the client and the server.
+ *
+ * Returns NULL on failure.
+ */
+static SSL_CTX *create_ktls_context(const SSL_METHOD *method) {
+    SSL_CTX *ssl_context = SSL_CTX_new(method);
+    if (ssl_context == NULL) {
+        fprintf(stderr, "create_ktls_context: failed to create TLS context\n");
+        return NULL;
+    }
+
+    SSL_CTX_set_min_proto_version(ssl_context, TLS1_3_VERSION);
+    SSL_CTX_set_max_proto_version(ssl_context, TLS1_3_VERSION);
+    SSL_CTX_set_keylog_callback(ssl_context, save_ktls_secret);
+
+    return ssl_context;
+}
+
+/*
+ * Creates the TLS context of the TLS server, with the certificate and private key in KTLS_CERTIFICATE_FILE and
+ * KTLS_PRIVATE_KEY_FILE.
+ *
+ * Returns NULL on failure.
+ *
+ * The user of this function takes the responsibility to free the returned context with 'SSL_CTX_free'.
+ */
+SSL_CTX *create_ktls_server_context(void) {
+    SSL_CTX *ssl_context = create_ktls_context(TLS_server_method());
+    if (ssl_context == NULL) {
+        return NULL;
+    }
+
+    if (SSL_CTX_use_certificate_chain_file(ssl_context, KTLS_CERTIFICATE_FILE) != 1 ||
+        SSL_CTX_use_PrivateKey_file(ssl_context, KTLS_PRIVATE_KEY_FILE, SSL_FILETYPE_PEM) != 1) {
+        fprintf(stderr, "create_ktls_server_context: failed to load the server certificate and private key\n");
+        SSL_CTX_free(ssl_context);
+        return NULL;
+    }
+
+    // a session ticket sent after the handshake would reach the client as a non-data record on the kTLS socket
+    SSL_CTX_set_num_tickets(ssl_context, 0);
+
+    return ssl_context;
+}
+
+/*
+ * Creates the TLS context of a TLS client. The server certificate is verified against the CA certificates in
+ * KTLS_CA_FILE if that is defined at build time, and not verified otherwise, as with QUIC.
+ *
+ * Returns NULL on failure.
+ *
+ * The user of this function takes the responsibility to free the returned context with 'SSL_CTX_free'.
+ */
+SSL_CTX *create_ktls_client_context(void) {
+    SSL_CTX *ssl_context = create_ktls_context(TLS_client_method());
+    if (ssl_context == NULL) {
+        return NULL;
+    }
+
+#ifdef KTLS_CA_FILE
+    if (SSL_CTX_load_verify_locations(ssl_context, KTLS_CA_FILE, NULL) != 1) {
+        fprintf(stderr, "create_ktls_client_context: failed to load the CA certificates\n");
+        SSL_CTX_free(ssl_context);
+        return NULL;
+    }
+    SSL_CTX_set_verify(ssl_context, SSL_VERIFY_PEER, NULL);
+#endif
+
+    return ssl_context;
+}
+
+/*
+ * Derives 'out_size' bytes of key material with the given label from the given traffic secret, with the
+ * TLS 1.3 HKDF-Expand-Label function (RFC 8446, Section 7.1) over the given digest. The key material is never
+ * longer than the digest, so HKDF-Expand takes a single HMAC.
+ *
+ * Returns 0 on success and > 0 on failure.
+ */
+static int hkdf_expand_label(const EVP_MD *digest, const uint8_t *secret, size_t secret_size, const char *label,
+                             uint8_t *out, size_t out_size) {
+    int digest_size = EVP_MD_size(digest);
+    if (digest_size <= 0 || out_size > (size_t)digest_size) {
+        return 1;
+    }
+
+    // HkdfLabel = length (2 bytes) | "tls13 " + label (length-prefixed) | empty context (length-prefixed) | 0x01
+    uint8_t info[2 + 1 + 255 + 1 + 1];
+    size_t full_label_size = strlen("tls13 ") + strlen(label);
+    if (full_label_size > 255) {
+        return 2;
+    }
+
+    size_t info_size = 0;
+    info[info_size++] = out_size >> 8;
+    info[info_size++] = out_size & 0xFF;
+    info[info_size++] = full_label_size;
+    memcpy(info + info_size, "tls13 ", strlen("tls13 "));
+    info_size += strlen("tls13 ");
+    memcpy(info + info_size, label, strlen(label));
+    info_size += strlen(label);
+    info[info_size++] = 0;
+    info[info_size++] = 0x01;
+
+    uint8_t block[EVP_MAX_MD_SIZE];
+    unsigned int block_size;
+    if (HMAC(digest, secret, secret_size, info, info_size, block, &block_size) == NULL) {
+        return 3;
+    }
+    memcpy(out, block, out_size);
+
+    return 0;
+}
+
+/*
+ * Hands the encryption (if 'direction' is TLS_TX) or the decryption (if TLS_RX) of the given socket over to the
+ * kernel, with the key and IV derived from the given traffic secret for the given TLS 1.3 cipher suite.
+ *
+ * Returns 0 on success and > 0 on failure.
+ */
+static int set_ktls_crypto_info(int socket_fd, int direction, const SSL_CIPHER *cipher, const uint8_t *secret,
+                                size_t secret_size) {
+    const EVP_MD *digest = SSL_CIPHER_get_handshake_digest(cipher);
+
+    uint8_t key[32], iv[12];
+    size_t key_size;
+
+    union {
+        struct tls12_crypto_info_aes_gcm_128 aes_gcm_128;
+        struct tls12_crypto_info_aes_gcm_256 aes_gcm_256;
+        struct tls12_crypto_info_chacha20_poly1305 chacha20_poly1305;
+    } crypto_info;
+    memset(&crypto_info, 0, sizeof(crypto_info));
+    size_t crypto_info_size;
+
+    switch (SSL_CIPHER_get_protocol_id(cipher)) {
+    case 0x1301: // TLS_AES_128_GCM_SHA256
+        key_size = TLS_CIPHER_AES_GCM_128_KEY_SIZE;
+        crypto_info.aes_gcm_128.info.cipher_type = TLS_CIPHER_AES_GCM_128;
+        crypto_info_size = sizeof(crypto_info.aes_gcm_128);
+        break;
+    case 0x1302: // TLS_AES_256_GCM_SHA384
+        key_size = TLS_CIPHER_AES_GCM_256_KEY_SIZE;
+        crypto_info.aes_gcm_256.info.cipher_type = TLS_CIPHER_AES_GCM_256;
+        crypto_info_size = sizeof(crypto_info.aes_gcm_256);
+        break;
+    case 0x1303: // TLS_CHACHA20_POLY1305_SHA256
+        key_size = TLS_CIPHER_CHACHA20_POLY1305_KEY_SIZE;
+        crypto_info.chacha20_poly1305.info.cipher_type = TLS_CIPHER_CHACHA20_POLY1305;
+        crypto_info_size = sizeof(crypto_info.chacha20_poly1305);
+        break;
+    default:
+        fprintf(stderr, "set_ktls_crypto_info: cipher suite %s is not supported by kernel TLS\n",
+                SSL_CIPHER_get_name(cipher));
+        return 1;
+    }
+
+    if (digest == NULL || hkdf_expand_label(digest, secret, secret_size, "key", key, key_size) > 0 ||
+        hkdf_expand_label(digest, secret, secret_size, "iv", iv, sizeof(iv)) > 0) {
+        fprintf(stderr, "set_ktls_crypto_info: failed to derive the traffic keys\n");
+        return 2;
+    }
+
+    // the 12 byte TLS 1.3 IV is split into a salt and an IV for AES-GCM, and the record sequence numbers start at 0
+    switch (crypto_info.aes_gcm_128.info.cipher_type) {
+    case TLS_CIPHER_AES_GCM_128:
+        crypto_info.aes_gcm_128.info.version = TLS_1_3_VERSION;
+        memcpy(crypto_info.aes_gcm_128.key, key, key_size);
+        memcpy(crypto_info.aes_gcm_128.salt, iv, TLS_CIPHER_AES_GCM_128_SALT_SIZE);
+        memcpy(crypto_info.aes_gcm_128.iv, iv + TLS_CIPHER_AES_GCM_128_SALT_SIZE, TLS_CIPHER_AES_GCM_128_IV_SIZE);
+        break;
+    case TLS_CIPHER_AES_GCM_256:
+        crypto_info.aes_gcm_256.info.version = TLS_1_3_VERSION;
+        memcpy(crypto_info.aes_gcm_256.key, key, key_size);
+        memcpy(crypto_info.aes_gcm_256.salt, iv, TLS_CIPHER_AES_GCM_256_SALT_SIZE);
+        memcpy(crypto_info.aes_gcm_256.iv, iv + TLS_CIPHER_AES_GCM_256_SALT_SIZE, TLS_CIPHER_AES_GCM_256_IV_SIZE);
+        break;
+    case TLS_CIPHER_CHACHA20_POLY1305:
+        crypto_info.chacha20_poly1305.info.version = TLS_1_3_VERSION;
+        memcpy(crypto_info.chacha20_poly1305.key, key, key_size);
+        memcpy(crypto_info.chacha20_poly1305.iv, iv, TLS_CIPHER_CHACHA20_POLY1305_IV_SIZE);
+        break;
+    }
+
+    int error_code = setsockopt(socket_fd, SOL_TLS, direction, &crypto_info, crypto_info_size);
+    OPENSSL_cleanse(&crypto_info, sizeof(crypto_info));
+    OPENSSL_cleanse(key, sizeof(key));
+    OPENSSL_cleanse(iv, sizeof(iv));
+    if (error_code < 0) {
+        perror("set_ktls_crypto_info: setsockopt(SOL_TLS) failed");
+        return 3;
+    }
+
+    return 0;
+}
+
+/*
+ * Performs a TLS 1.3 handshake on the given connected TCP socket, as the server if 'is_server' is true and as
+ * the client otherwise, and then hands the record layer of the connection over to kernel TLS. From then on
+ * the socket carries encrypted data with plain send() and recv().
+ *
+ * Needs the 'tls' kernel module to be loaded.
+ *
+ * Returns 0 on success and > 0 on failure.
+ */
+int perform_ktls_handshake(SSL_CTX *ssl_context, int socket_fd, bool is_server) {
+    if (ssl_context == NULL) {
+        return 1;
+    }
+
+    SSL *ssl = SSL_new(ssl_context);
+    if (ssl == NULL) {
+        fprintf(stderr, "perform_ktls_handshake: failed to create TLS connection\n");
+        return 2;
+    }
+
+    KtlsSecrets ktls_secrets = {0};
+    SSL_set_app_data(ssl, &ktls_secrets);
+
+    // the socket isn't closed when the TLS connection is freed
+    SSL_set_fd(ssl, socket_fd);
+
+    int error_code = is_server ? SSL_accept(ssl) : SSL_connect(ssl);
+    if (error_code != 1) {
+        fprintf(stderr, "perform_ktls_handshake: TLS handshake failed with error %d\n", SSL_get_error(ssl, error_code));
+        ERR_print_errors_fp(stderr);
+        SSL_free(ssl);
+        return 3;
+    }
+
+    if (ktls_secrets.client_secret_size == 0 || ktls_secrets.server_secret_size == 0) {
+        fprintf(stderr, "perform_ktls_handshake: TLS handshake did not produce traffic secrets\n");
+        SSL_free(ssl);
+        return 4;
+    }
+
+    // a record already read by the TLS library would never reach the kernel
+    if (SSL_pending(ssl) > 0) {
+        fprintf(stderr, "perform_ktls_handshake: data received before the handshake was over\n");
+        SSL_free(ssl);
+        return 5;
+    }
+
+    if (setsockopt(socket_fd, IPPROTO_TCP, TCP_ULP, "tls", sizeof("tls")) < 0) {
+        perror("perform_ktls_handshake: failed to enable kernel TLS (is the 'tls' module loaded?)");
+        SSL_free(ssl);
+        return 6;
+    }
+
+    const SSL_CIPHER *cipher = SSL_get_current_cipher(ssl);
+    uint8_t *write_secret = is_server ? ktls_secrets.server_secret : ktls_secrets.client_secret;
+    size_t write_secret_size = is_server ? ktls_secrets.server_secret_size : ktls_secrets.client_secret_size;
+    uint8_t *read_secret = is_server ? ktls_secrets.client_secret : ktls_secrets.server_secret;
+    size_t read_secret_size = is_server ? ktls_secrets.client_secret_size : ktls_secrets.server_secret_size;
+
+    error_code = set_ktls_crypto_info(socket_fd, TLS_TX, cipher, write_secret, write_secret_size);
+    if (error_code == 0) {
+        error_code = set_ktls_crypto_info(socket_fd, TLS_RX, cipher, read_secret, read_secret_size);
+    }
+    OPENSSL_cleanse(&ktls_secrets, sizeof(ktls_secrets));
+
+    // freed without a shutdown, so that no close_notify alert is sent
+    SSL_free(ssl);
+
+    return error_code > 0 ? 7 : 0;
+}
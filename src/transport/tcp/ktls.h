@@ -0,0 +1,34 @@
+#ifndef ktls__header__INCLUDED
+#define ktls__header__INCLUDED
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <openssl/ssl.h>
+
+// the TLS server uses the same certificate as the QUIC server, created by './generate_certificate'
+#define KTLS_CERTIFICATE_FILE "certificate.cert"
+#define KTLS_PRIVATE_KEY_FILE "certificate.key"
+
+// largest traffic secret of a TLS 1.3 cipher suite (SHA-384)
+#define KTLS_MAX_SECRET_SIZE 48
+
+/*
+ * The TLS 1.3 application traffic secrets of a connection, caught from the key log of its handshake.
+ */
+typedef struct KtlsSecrets {
+    uint8_t client_secret[KTLS_MAX_SECRET_SIZE];
+    size_t client_secret_size;
+
+    uint8_t server_secret[KTLS_MAX_SECRET_SIZE];
+    size_t server_secret_size;
+} KtlsSecrets;
+
+SSL_CTX *create_ktls_server_context(void);
+
+SSL_CTX *create_ktls_client_context(void);
+
+int perform_ktls_handshake(SSL_CTX *ssl_context, int socket_fd, bool is_server);
+
+#endif /* ktls__header__INCLUDED */
@@ -2,10 +2,20 @@
 #define tcp_client__HEADER__INCLUDED
 
 #include "pthread.h"
+#include <time.h>
+
+#include "src/transport/record_buffer_pool.h"
 
 typedef struct TcpClient {
     int *tcp_rpc_client_socket_fd;
     pthread_mutex_t tcp_connection_mutex;
+
+    // RPC replies are all received into the same buffer, guarded by the connection mutex
+    RecordBuffer reply_rpc_msg_buffer;
+
+    // transport statistics, guarded by the connection mutex
+    uint64_t num_rpcs;
+    struct timespec last_stats_report_time;
 } TcpClient;
 
 #endif /* tcp_client__HEADER__INCLUDED */
\ No newline at end of file
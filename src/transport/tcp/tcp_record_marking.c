@@ -93,28 +93,29 @@ int receive_bytes_tcp(int socket_fd, size_t bytes_to_read, uint8_t *destination_
 
 /*
  * Given an open socket, reads a single Record Marking (RM) record (RFC 5531) from it.
- * The data extracted from each RM fragment is concatenated and returned as result, and
- * the total number of bytes in the that result is placed in 'rm_record_data_size'.
+ * The data extracted from each RM fragment is concatenated into the given record buffer, replacing
+ * its previous contents, so the same record buffer can be reused for consecutive records.
  *
- * Returns NULL if reading the RM record was unsuccessful.
+ * Fragment data is received straight into the record buffer. When a fragment header marks the last
+ * fragment of the record, the record buffer is sized exactly for the whole record, otherwise it grows
+ * geometrically.
  *
- * The user of this function takes the reponsibility to free the buffer returned as the result.
+ * Returns 0 on success and > 0 on failure.
  */
-uint8_t *receive_rm_record_tcp(int socket_fd, size_t *rm_record_data_size) {
-    uint8_t *rm_record_data_buffer = NULL;
-    size_t rm_record_data_bytes_read = 0;
-    int is_last_fragment = 0;
+int receive_rm_record_tcp(int socket_fd, RecordBuffer *rm_record) {
+    if (rm_record == NULL) {
+        return 1;
+    }
+    rm_record->size = 0;
 
+    int is_last_fragment = 0;
     while (!is_last_fragment) {
         // read the RM fragment header
         uint8_t fragment_header_buffer[RM_FRAGMENT_HEADER_SIZE];
         int error_code = receive_bytes_tcp(socket_fd, RM_FRAGMENT_HEADER_SIZE, fragment_header_buffer);
         if (error_code > 0) {
             fprintf(stderr, "receive_rm_record_tcp: failed to receive the Record Marking fragment header\n");
-
-            free(rm_record_data_buffer);
-
-            return NULL;
+            return 2;
         }
         uint32_t fragment_header = 0;
         memcpy(&fragment_header, fragment_header_buffer, sizeof(fragment_header));
@@ -125,21 +126,22 @@ uint8_t *receive_rm_record_tcp(int socket_fd, size_t *rm_record_data_size) {
             (fragment_header & 0x80000000) != 0; // if most significant bit is set, this is the last fragment
         size_t fragment_size = fragment_header & 0x7FFFFFFF; // lower 31 bits specify fragment size in bytes
 
+        // make room for the fragment data - the size of the whole record is known on its last fragment
+        error_code = reserve_record_buffer(rm_record, rm_record->size + fragment_size, is_last_fragment);
+        if (error_code > 0) {
+            fprintf(stderr, "receive_rm_record_tcp: failed to allocate memory\n");
+            return 3;
+        }
+
         // read fragment data
-        rm_record_data_buffer = realloc(rm_record_data_buffer, rm_record_data_bytes_read + fragment_size);
-        error_code = receive_bytes_tcp(socket_fd, fragment_size, rm_record_data_buffer + rm_record_data_bytes_read);
+        error_code = receive_bytes_tcp(socket_fd, fragment_size, rm_record->data + rm_record->size);
         if (error_code > 0) {
             fprintf(stderr, "receive_rm_record_tcp: failed to receive the Record Marking fragment data\n");
-
-            free(rm_record_data_buffer);
-
-            return NULL;
+            return 4;
         }
 
-        rm_record_data_bytes_read += fragment_size;
+        rm_record->size += fragment_size;
     }
 
-    *rm_record_data_size = rm_record_data_bytes_read;
-
-    return rm_record_data_buffer;
-}
\ No newline at end of file
+    return 0;
+}
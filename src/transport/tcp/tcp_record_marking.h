@@ -8,10 +8,11 @@
 #include <string.h>
 #include <unistd.h>
 
+#include "src/transport/record_buffer_pool.h"
 #include "src/transport/transport_common.h"
 
 int send_rm_record_tcp(int socket_fd, const uint8_t *rm_record_data, size_t rm_record_data_size);
 
-uint8_t *receive_rm_record_tcp(int socket_fd, size_t *rpc_message_size);
+int receive_rm_record_tcp(int socket_fd, RecordBuffer *rm_record);
 
 #endif /* tcp_record_marking__header__INCLUDED */
\ No newline at end of file
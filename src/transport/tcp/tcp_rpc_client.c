@@ -33,34 +33,44 @@ Rpc__RpcMsg *execute_rpc_call_tcp(RpcConnectionContext *rpc_connection_context,
         return NULL;
     }
 
-    // serialize RpcMsg
-    size_t rpc_msg_size = rpc__rpc_msg__get_packed_size(call_rpc_msg);
-    uint8_t *rpc_msg_buffer = malloc(sizeof(uint8_t) * rpc_msg_size);
-    rpc__rpc_msg__pack(call_rpc_msg, rpc_msg_buffer);
+    // serialize RpcMsg around the procedure parameters
+    EncodedRpcMsg encoded_rpc_msg;
+    int error_code = encode_rpc_msg(rpc_connection_context->rpc_codec, call_rpc_msg, &encoded_rpc_msg);
+    if (error_code > 0) {
+        return NULL;
+    }
 
     pthread_mutex_lock(&tcp_client->tcp_connection_mutex);
 
     // send the serialized RpcMsg to the server as a single Record Marking record
     // TODO: (QNFS-37) implement time-outs + reconnections
-    int error_code = send_rm_record_tcp(rpc_client_socket_fd, rpc_msg_buffer, rpc_msg_size);
-    free(rpc_msg_buffer);
+    error_code = send_rm_record_tcp(rpc_client_socket_fd, encoded_rpc_msg.data, encoded_rpc_msg.size);
+    free_encoded_rpc_msg(&encoded_rpc_msg);
     if (error_code > 0) {
         pthread_mutex_unlock(&tcp_client->tcp_connection_mutex);
         return NULL;
     }
 
     // receive the RPC reply from the server as a single Record Marking record
-    size_t reply_rpc_msg_size = -1;
-    uint8_t *reply_rpc_msg_buffer = receive_rm_record_tcp(rpc_client_socket_fd, &reply_rpc_msg_size);
-    if (reply_rpc_msg_buffer == NULL) {
+    error_code = receive_rm_record_tcp(rpc_client_socket_fd, &tcp_client->reply_rpc_msg_buffer);
+    if (error_code > 0) {
         pthread_mutex_unlock(&tcp_client->tcp_connection_mutex);
         return NULL;
     }
 
-    pthread_mutex_unlock(&tcp_client->tcp_connection_mutex);
+    // the reply buffer is reused by the next RPC on this connection, so deserialize before releasing the connection
+    Rpc__RpcMsg *reply_rpc_msg =
+        deserialize_rpc_msg(rpc_connection_context->rpc_codec, tcp_client->reply_rpc_msg_buffer.data,
+                            tcp_client->reply_rpc_msg_buffer.size, call_rpc_msg->cbody);
+    clear_record_buffer(&tcp_client->reply_rpc_msg_buffer);
 
-    Rpc__RpcMsg *reply_rpc_msg = deserialize_rpc_msg(reply_rpc_msg_buffer, reply_rpc_msg_size);
-    free(reply_rpc_msg_buffer);
+    tcp_client->num_rpcs++;
+    if (is_transport_stats_report_due(&tcp_client->last_stats_report_time)) {
+        report_tcp_connection_stats(rpc_client_socket_fd, "client", tcp_client->num_rpcs);
+        report_rpc_compression_stats();
+    }
+
+    pthread_mutex_unlock(&tcp_client->tcp_connection_mutex);
 
     return reply_rpc_msg;
 }
@@ -69,6 +79,9 @@ Rpc__RpcMsg *execute_rpc_call_tcp(RpcConnectionContext *rpc_connection_context,
  * Given the RPC program number to be called, program version, procedure number, and the parameters for it, calls
  * the appropriate remote procedure over TCP.
  *
+ * The value of the 'parameters' must have been allocated with 'allocate_rpc_payload_buffer', as the RPC call is
+ * serialized around it.
+ *
  * Returns the server's RPC reply on success, and NULL on failure.
  *
  * The user of this function takes the responsibility to call 'rpc__rpc_msg__free_unpacked(rpc_reply, NULL)'
@@ -88,7 +101,10 @@ Rpc__RpcMsg *invoke_rpc_remote_tcp(RpcConnectionContext *rpc_connection_context,
     call_body.vers = program_version;
     call_body.proc = procedure_number;
 
-    call_body.credential = rpc_connection_context->credential;
+    // once the server has handed out a short handle for the credential, the handle is sent in its place
+    Rpc__OpaqueAuth short_credential;
+    uint8_t short_handle[MAX_AUTH_SHORT_SIZE];
+    call_body.credential = get_rpc_call_credential(rpc_connection_context, &short_credential, short_handle);
     call_body.verifier = rpc_connection_context->verifier;
 
     call_body.params = &parameters;
@@ -100,6 +116,15 @@ Rpc__RpcMsg *invoke_rpc_remote_tcp(RpcConnectionContext *rpc_connection_context,
     call_rpc_msg.cbody = &call_body;
 
     Rpc__RpcMsg *reply_rpc_msg = execute_rpc_call_tcp(rpc_connection_context, &call_rpc_msg);
+    if (update_auth_short_handle(rpc_connection_context, reply_rpc_msg, call_body.credential == &short_credential)) {
+        // the server does not know the short handle (anymore), so the call is sent again with the full credential
+        rpc__rpc_msg__free_unpacked(reply_rpc_msg, NULL);
+
+        call_body.credential = rpc_connection_context->credential;
+        call_rpc_msg.xid = generate_rpc_xid();
+        reply_rpc_msg = execute_rpc_call_tcp(rpc_connection_context, &call_rpc_msg);
+        update_auth_short_handle(rpc_connection_context, reply_rpc_msg, false);
+    }
 
     return reply_rpc_msg;
 }
\ No newline at end of file
@@ -13,6 +13,8 @@
 #include "src/common_rpc/common_rpc.h"
 #include "src/common_rpc/rpc_connection_context.h"
 
+#include "src/transport/transport_stats.h"
+
 #include "tcp_record_marking.h"
 
 Rpc__RpcMsg *invoke_rpc_remote_tcp(RpcConnectionContext *rpc_connection_context, uint32_t program_number,
@@ -11,6 +11,7 @@
  */
 
 int rpc_server_socket_fd;
+SSL_CTX *ktls_server_context = NULL;
 
 pthread_mutex_t tcp_server_cleanup_mutex = PTHREAD_MUTEX_INITIALIZER;
 bool tcp_server_resources_released = false;
@@ -20,199 +21,50 @@ bool tcp_server_resources_released = false;
  *
  * Returns 0 on success, and > 0 on failure.
  */
-int send_rpc_reply_body_tcp(int rpc_client_socket_fd, Rpc__ReplyBody *reply_body) {
+static int send_rpc_reply_body_tcp(void *reply_destination, Rpc__ReplyBody *reply_body) {
+    int rpc_client_socket_fd = *(int *)reply_destination;
+
     Rpc__RpcMsg rpc_msg = RPC__RPC_MSG__INIT;
     rpc_msg.xid = generate_rpc_xid();
     rpc_msg.mtype = RPC__MSG_TYPE__REPLY;
     rpc_msg.body_case = RPC__RPC_MSG__BODY_RBODY; // this body_case enum is not actually sent over the network
     rpc_msg.rbody = reply_body;
 
-    // serialize the RpcMsg
-    size_t rpc_msg_size = rpc__rpc_msg__get_packed_size(&rpc_msg);
-    uint8_t *rpc_msg_buffer = malloc(rpc_msg_size);
-    rpc__rpc_msg__pack(&rpc_msg, rpc_msg_buffer);
-
-    // send the serialized RpcMsg back to the client as a single Record Marking record
-    int error_code = send_rm_record_tcp(rpc_client_socket_fd, rpc_msg_buffer, rpc_msg_size);
-    free(rpc_msg_buffer);
+    // serialize the RpcMsg around the procedure results, if it has any
+    EncodedRpcMsg encoded_rpc_msg;
+    int error_code = encode_rpc_msg(get_rpc_call_codec(), &rpc_msg, &encoded_rpc_msg);
     if (error_code > 0) {
         return 1;
     }
 
-    return 0;
-}
-
-/*
- * Sends the given AcceptedReply back to the RPC client, given the opened TCP socket for that client.
- *
- * Returns 0 on success, and > 0 on failure.
- */
-int send_rpc_accepted_reply_message_tcp(int rpc_client_socket_fd, Rpc__AcceptedReply *accepted_reply) {
-    Rpc__ReplyBody reply_body = RPC__REPLY_BODY__INIT;
-    reply_body.stat = RPC__REPLY_STAT__MSG_ACCEPTED;
-    reply_body.reply_case = RPC__REPLY_BODY__REPLY_AREPLY; // reply_case is not actually transfered over network
-    reply_body.areply = accepted_reply;
-
-    return send_rpc_reply_body_tcp(rpc_client_socket_fd, &reply_body);
-}
-
-/*
- * Sends the given RejectedReply back to the RPC client, given the opened TCP socket for that client.
- *
- * Returns 0 on success, and > 0 on failure.
- */
-int send_rpc_rejected_reply_message_tcp(int rpc_client_socket_fd, Rpc__RejectedReply *rejected_reply) {
-    Rpc__ReplyBody reply_body = RPC__REPLY_BODY__INIT;
-    reply_body.stat = RPC__REPLY_STAT__MSG_DENIED;
-    reply_body.reply_case = RPC__REPLY_BODY__REPLY_RREPLY; // reply_case is not actually transfered over network
-    reply_body.rreply = rejected_reply;
-
-    return send_rpc_reply_body_tcp(rpc_client_socket_fd, &reply_body);
-}
-
-/*
- * Prints out the given error message, and sends an AUTH_ERROR RejectedReply with the given AuthStat to the
- * given opened TCP client socket.
- *
- * Returns 0 on success and > 0 on failure.
- */
-int send_auth_error_rejected_reply_tcp(int rpc_client_socket_fd, char *error_msg, Rpc__AuthStat auth_stat) {
-    fprintf(stdout, "%s", error_msg);
-
-    Rpc__RejectedReply *rejected_reply = create_auth_error_rejected_reply(auth_stat);
-
-    int error_code = send_rpc_rejected_reply_message_tcp(rpc_client_socket_fd, rejected_reply);
-    free_rejected_reply(rejected_reply);
+    // send the serialized RpcMsg back to the client as a single Record Marking record
+    error_code = send_rm_record_tcp(rpc_client_socket_fd, encoded_rpc_msg.data, encoded_rpc_msg.size);
+    free_encoded_rpc_msg(&encoded_rpc_msg);
     if (error_code > 0) {
-        fprintf(stdout, "Server failed to send AUTH_ERROR RejectedReply\n");
-        return 1;
+        return 2;
     }
 
     return 0;
 }
 
 /*
- * Validates the 'credential' and 'verifier' OpaqueAuth pair from some RPC CallBody, to check that they have the correct
- * structure (no NULL fields) and correspond to a supported authentication flavor.
+ * Decodes the RPC call received into the given record buffer, runs it, and replies to it on the given TCP
+ * client socket.
  *
- * Returns < 0 on failure.
- * On success, returns 0 if the credential and verifier pair are correct, and if the credential and verifier pair are
- * incorrect, returns > 0 and sends an appropriate RejectedReply to the given opened TCP client socket.
+ * Returns 0 on success and > 0 on failure.
  */
-int validate_credential_and_verifier_tcp(int rpc_client_socket_fd, Rpc__OpaqueAuth *credential,
-                                         Rpc__OpaqueAuth *verifier) {
+static int serve_rpc_call_tcp(int rpc_client_socket_fd, RecordBuffer *rpc_msg_buffer) {
     int error_code;
 
-    if (credential == NULL) {
-        error_code = send_auth_error_rejected_reply_tcp(rpc_client_socket_fd,
-                                                        "Server received an RPC call with 'credential' being NULL.\n",
-                                                        RPC__AUTH_STAT__AUTH_BADCRED);
-        return error_code > 0 ? -1 : 1;
-    }
-    if (credential->flavor == RPC__AUTH_FLAVOR__AUTH_NONE) {
-        if (credential->body_case != RPC__OPAQUE_AUTH__BODY_EMPTY) {
-            error_code =
-                send_auth_error_rejected_reply_tcp(rpc_client_socket_fd,
-                                                   "Server received an RPC call with AUTH_NONE credential, with "
-                                                   "inconsistent credential->flavor and credential->body_case.\n",
-                                                   RPC__AUTH_STAT__AUTH_BADCRED);
-            return error_code > 0 ? -1 : 1;
-        }
-        if (credential->empty == NULL) {
-            error_code = send_auth_error_rejected_reply_tcp(
-                rpc_client_socket_fd,
-                "Server received an RPC call with AUTH_NONE credential, with credential->empty being NULL.\n",
-                RPC__AUTH_STAT__AUTH_BADCRED);
-            return error_code > 0 ? -1 : 1;
-        }
-    } else if (credential->flavor == RPC__AUTH_FLAVOR__AUTH_SYS) {
-        if (credential->body_case != RPC__OPAQUE_AUTH__BODY_AUTH_SYS) {
-            error_code =
-                send_auth_error_rejected_reply_tcp(rpc_client_socket_fd,
-                                                   "Server received an RPC call with AUTH_SYS credential, with "
-                                                   "inconsistent credential->flavor and credential->body_case.\n",
-                                                   RPC__AUTH_STAT__AUTH_BADCRED);
-            return error_code > 0 ? -1 : 1;
-        }
-
-        if (credential->auth_sys == NULL) {
-            error_code = send_auth_error_rejected_reply_tcp(
-                rpc_client_socket_fd,
-                "Server received an RPC call with AUTH_SYS credential, with credential->auth_sys being NULL.\n",
-                RPC__AUTH_STAT__AUTH_BADCRED);
-            return error_code > 0 ? -1 : 1;
-        }
-        Rpc__AuthSysParams *authsysparams = credential->auth_sys;
-
-        if (authsysparams->machinename == NULL) {
-            error_code = send_auth_error_rejected_reply_tcp(rpc_client_socket_fd,
-                                                            "Server received an RPC call with AUTH_SYS credential, "
-                                                            "with credential->auth_sys->machinename being NULL.\n",
-                                                            RPC__AUTH_STAT__AUTH_BADCRED);
-            return error_code > 0 ? -1 : 1;
-        }
-        if (authsysparams->gids == NULL) {
-            error_code = send_auth_error_rejected_reply_tcp(
-                rpc_client_socket_fd,
-                "Server received an RPC call with AUTH_SYS credential, with credential->auth_sys->gids being NULL.\n",
-                RPC__AUTH_STAT__AUTH_BADCRED);
-            return error_code > 0 ? -1 : 1;
-        }
-    } else {
-        // TODO (QNFS-52): Implement AUTH_SHORT
-        error_code = send_auth_error_rejected_reply_tcp(
-            rpc_client_socket_fd, "Server received an RPC call with unsupported authentication flavor %d.\n",
-            RPC__AUTH_STAT__AUTH_BADCRED);
-        return error_code > 0 ? -1 : 1;
-    }
-
-    if (verifier == NULL) {
-        error_code = send_auth_error_rejected_reply_tcp(rpc_client_socket_fd,
-                                                        "Server received an RPC call with 'verifier' being NULL.\n",
-                                                        RPC__AUTH_STAT__AUTH_BADVERF);
-        return error_code > 0 ? -1 : 1;
-    }
-    if (verifier->flavor == RPC__AUTH_FLAVOR__AUTH_NONE) {
-        if (verifier->body_case != RPC__OPAQUE_AUTH__BODY_EMPTY) {
-            error_code = send_auth_error_rejected_reply_tcp(rpc_client_socket_fd,
-                                                            "Server received an RPC call with AUTH_NONE verifier, with "
-                                                            "inconsistent verifier->flavor and verifier->body_case.\n",
-                                                            RPC__AUTH_STAT__AUTH_BADVERF);
-            return error_code > 0 ? -1 : 1;
-        }
-        if (verifier->empty == NULL) {
-            error_code = send_auth_error_rejected_reply_tcp(
-                rpc_client_socket_fd,
-                "Server received an RPC call with AUTH_NONE verifier, with verifier->empty being NULL.\n",
-                RPC__AUTH_STAT__AUTH_BADVERF);
-            return error_code > 0 ? -1 : 1;
-        }
-    } else {
-        // in AUTH_NONE, AUTH_SYS, and AUTH_SHORT, verifier in CallBody always has AUTH_NONE flavor
-        error_code = send_auth_error_rejected_reply_tcp(
-            rpc_client_socket_fd, "Server received an RPC call with 'verifier' having unsupported flavor.\n",
-            RPC__AUTH_STAT__AUTH_BADVERF);
-        return error_code > 0 ? -1 : 1;
-    }
+    RpcReplySender reply_sender = {.send_reply_body = send_rpc_reply_body_tcp,
+                                   .reply_destination = &rpc_client_socket_fd};
 
-    return 0;
-}
+    // the call is replied to in the codec it arrived in
+    RpcCodec codec = detect_rpc_codec(rpc_msg_buffer->data, rpc_msg_buffer->size);
+    set_rpc_call_codec(codec);
 
-/*
- * Takes an opened TCP client socket and reads and processes a single RPC from it.
- *
- * Returns 0 on success and > 0 on failure.
- */
-int process_single_rpc_tcp(int rpc_client_socket_fd) {
-    // read one RPC call as a single Record Marking record
-    size_t rpc_msg_size = -1;
-    uint8_t *rpc_msg_buffer = receive_rm_record_tcp(rpc_client_socket_fd, &rpc_msg_size);
-    if (rpc_msg_buffer == NULL) {
-        return 1; // failed to receive the RPC, no reply given
-    }
-
-    Rpc__RpcMsg *rpc_call = deserialize_rpc_msg(rpc_msg_buffer, rpc_msg_size);
-    free(rpc_msg_buffer);
+    // the procedure parameters are left in the record buffer, so it is only cleared once they have been used
+    Rpc__RpcMsg *rpc_call = decode_rpc_msg_in_place(codec, rpc_msg_buffer->data, rpc_msg_buffer->size);
     if (rpc_call == NULL) {
         return 2; // invalid RPC received, no reply given
     }
@@ -234,7 +86,7 @@ int process_single_rpc_tcp(int rpc_client_socket_fd) {
 
         Rpc__RejectedReply *rejected_reply = create_rpc_mismatch_rejected_reply(2, 2);
 
-        int error_code = send_rpc_rejected_reply_message_tcp(rpc_client_socket_fd, rejected_reply);
+        error_code = send_rpc_rejected_reply_message(&reply_sender, rejected_reply);
         free_rejected_reply(rejected_reply);
         if (error_code > 0) {
             fprintf(stdout, "Server failed to send RPC mismatch RejectedReply\n");
@@ -245,16 +97,22 @@ int process_single_rpc_tcp(int rpc_client_socket_fd) {
     }
 
     // check authentication fields
-    int error_code =
-        validate_credential_and_verifier_tcp(rpc_client_socket_fd, call_body->credential, call_body->verifier);
+    error_code = validate_credential_and_verifier(&reply_sender, call_body->credential, call_body->verifier);
     if (error_code != 0) {
         return 6;
     }
     log_rpc_call_body_info(call_body);
-    if (call_body->credential->flavor == RPC__AUTH_FLAVOR__AUTH_NONE && call_body->proc != 0) {
+    // a short credential is replaced by the AUTH_SYS credential it stands for
+    Rpc__OpaqueAuth *credential = resolve_rpc_call_credential(call_body->credential);
+    if (credential == NULL) {
+        return send_auth_error_rejected_reply(
+            &reply_sender, "Server received an RPC call with an AUTH_SHORT credential it does not know.\n",
+            RPC__AUTH_STAT__AUTH_REJECTEDCRED);
+    }
+    if (credential->flavor == RPC__AUTH_FLAVOR__AUTH_NONE && call_body->proc != 0) {
         // only NULL procedure is allowed to use AUTH_NONE flavor
-        return send_auth_error_rejected_reply_tcp(
-            rpc_client_socket_fd,
+        return send_auth_error_rejected_reply(
+            &reply_sender,
             "Server received an RPC call with authentication flavor AUTH_NONE for a non-NULL procedure.\n",
             RPC__AUTH_STAT__AUTH_TOOWEAK);
     }
@@ -263,10 +121,14 @@ int process_single_rpc_tcp(int rpc_client_socket_fd) {
     Google__Protobuf__Any *parameters = call_body->params;
 
     Rpc__AcceptedReply *accepted_reply = forward_rpc_call_to_program(
-        call_body->credential, call_body->verifier, call_body->prog, call_body->vers, call_body->proc, parameters);
-    rpc__rpc_msg__free_unpacked(rpc_call, NULL);
+        credential, call_body->verifier, call_body->prog, call_body->vers, call_body->proc, parameters);
+    if (credential != call_body->credential) {
+        free_opaque_auth(credential);
+    }
+    free_rpc_msg_decoded_in_place(rpc_call, rpc_msg_buffer->data, rpc_msg_buffer->size);
+    clear_record_buffer(rpc_msg_buffer);
 
-    error_code = send_rpc_accepted_reply_message_tcp(rpc_client_socket_fd, accepted_reply);
+    error_code = send_rpc_accepted_reply_message(&reply_sender, accepted_reply);
     free_accepted_reply(accepted_reply);
     if (error_code > 0) {
         fprintf(stdout, "Server failed to send AcceptedReply\n");
@@ -276,6 +138,27 @@ int process_single_rpc_tcp(int rpc_client_socket_fd) {
     return 0;
 }
 
+/*
+ * Takes an opened TCP client socket and reads and processes a single RPC from it, receiving
+ * the RPC into the given record buffer.
+ *
+ * Returns 0 on success and > 0 on failure.
+ */
+int process_single_rpc_tcp(int rpc_client_socket_fd, RecordBuffer *rpc_msg_buffer) {
+    // read one RPC call as a single Record Marking record
+    int error_code = receive_rm_record_tcp(rpc_client_socket_fd, rpc_msg_buffer);
+    if (error_code > 0) {
+        return 1; // failed to receive the RPC, no reply given
+    }
+
+    // everything built while serving the RPC is taken from the arena of this thread, and released at once afterwards
+    begin_rpc_arena();
+    error_code = serve_rpc_call_tcp(rpc_client_socket_fd, rpc_msg_buffer);
+    end_rpc_arena();
+
+    return error_code;
+}
+
 /*
  * Returns 0 if the client-side socket that was connected to the given rpc_client_socket_fd
  * has been closed using close() (i.e. the TCP connection has been closed).
@@ -312,32 +195,67 @@ void *handle_client_tcp(void *arg) {
         return NULL;
     }
 
+    // RPCs from this client are all received into the same buffer
+    RecordBuffer rpc_msg_buffer = RECORD_BUFFER_INIT;
+
+    uint64_t num_rpcs = 0;
+    struct timespec last_stats_report_time = {0};
+
     while (1) {
         int status = is_tcp_connection_closed(*rpc_client_socket_fd);
         if (status < 0) {
             perror_msg("handle_client_tcp: server thread failed to check if the TCP connection is alive\n");
 
+            release_record_buffer(&rpc_msg_buffer);
             remove_server_thread(tid, &nfs_server_threads_list);
 
             return NULL;
         } else if (status == 0) {
             // client-side socket has been closed, so terminate this server thread
+            report_tcp_connection_stats(*rpc_client_socket_fd, "server", num_rpcs);
+            release_record_buffer(&rpc_msg_buffer);
+
             return NULL;
         }
 
-        int error_code = process_single_rpc_tcp(*rpc_client_socket_fd);
+        int error_code = process_single_rpc_tcp(*rpc_client_socket_fd, &rpc_msg_buffer);
         if (error_code > 0) {
             fprintf(stderr, "handle_client_tcp: server thread failed to process a RPC with status %d\n", error_code);
 
+            release_record_buffer(&rpc_msg_buffer);
             remove_server_thread(tid, &nfs_server_threads_list);
 
             return NULL;
         }
+
+        num_rpcs++;
+        if (is_transport_stats_report_due(&last_stats_report_time)) {
+            report_tcp_connection_stats(*rpc_client_socket_fd, "server", num_rpcs);
+            report_rpc_arena_stats();
+            report_rpc_compression_stats();
+        }
     }
 
     return NULL;
 }
 
+/*
+ * Function for a single NFS thread to perform the TLS handshake with a client, hand the encryption of the
+ * connection over to kernel TLS, and then wait for client RPCs and respond to them as over plain TCP.
+ */
+void *handle_client_tls(void *arg) {
+    int *rpc_client_socket_fd = (int *)arg;
+    if (rpc_client_socket_fd != NULL && perform_ktls_handshake(ktls_server_context, *rpc_client_socket_fd, true) > 0) {
+        fprintf(stderr, "handle_client_tls: TLS handshake with the client failed\n");
+
+        remove_server_thread(pthread_self(), &nfs_server_threads_list);
+
+        return NULL;
+    }
+
+    return handle_client_tcp(arg);
+}
+
 /*
  * Frees all resources used by the TCP server.
  *
@@ -356,6 +274,11 @@ void release_tcp_server_resources(void) {
 
     close(rpc_server_socket_fd);
 
+    if (ktls_server_context != NULL) {
+        SSL_CTX_free(ktls_server_context);
+        ktls_server_context = NULL;
+    }
+
     tcp_server_resources_released = true;
     pthread_mutex_unlock(&tcp_server_cleanup_mutex);
 }
@@ -370,11 +293,11 @@ void clean_up_tcp_server_state(void) {
 }
 
 /*
- * Runs the Nfs+Mount server, which awaits RPCs, over TCP.
+ * Runs the Nfs+Mount server, which awaits RPCs, over TCP, encrypted with TLS if 'use_ktls' is true.
  *
  * Returns > 0 on failure.
  */
-int run_server_tcp(uint16_t port_number) {
+static int run_server_tcp_listener(uint16_t port_number, bool use_ktls) {
     // create the server socket
     rpc_server_socket_fd = socket(AF_INET, SOCK_STREAM, 0);
     if (rpc_server_socket_fd < 0) {
@@ -410,7 +333,7 @@ int run_server_tcp(uint16_t port_number) {
         return 1;
     }
 
-    fprintf(stdout, "Server listening on port %d... (TCP)\n", port_number);
+    fprintf(stdout, "Server listening on port %d... (%s)\n", port_number, use_ktls ? "TLS over TCP" : "TCP");
 
     while (1) {
         struct sockaddr_in rpc_client_addr;
@@ -432,7 +355,8 @@ int run_server_tcp(uint16_t port_number) {
 
         // start a new thread for handling this client
         pthread_t server_thread;
-        if (pthread_create(&server_thread, NULL, handle_client_tcp, rpc_client_socket_fd) != 0) {
+        if (pthread_create(&server_thread, NULL, use_ktls ? handle_client_tls : handle_client_tcp,
+                           rpc_client_socket_fd) != 0) {
             fprintf(stderr, "run_server_tcp: server failed to create a new client-handling thread\n");
 
             close(*rpc_client_socket_fd);
@@ -455,7 +379,8 @@ int run_server_tcp(uint16_t port_number) {
         TransportConnection transport_connection;
         transport_connection.tcp_client = tcp_client;
         int error_code =
-            add_server_thread(server_thread, TRANSPORT_PROTOCOL_TCP, transport_connection, &nfs_server_threads_list);
+            add_server_thread(server_thread, use_ktls ? TRANSPORT_PROTOCOL_TLS : TRANSPORT_PROTOCOL_TCP,
+                              transport_connection, &nfs_server_threads_list);
         if (error_code > 0) {
             fprintf(stderr, "run_server_tcp: server failed to add a new entry in the NFS server threads list\n");
 
@@ -472,4 +397,29 @@ int run_server_tcp(uint16_t port_number) {
     clean_up_tcp_server_state();
 
     return 0;
+}
+
+/*
+ * Runs the Nfs+Mount server, which awaits RPCs, over TCP.
+ *
+ * Returns > 0 on failure.
+ */
+int run_server_tcp(uint16_t port_number) {
+    return run_server_tcp_listener(port_number, false);
+}
+
+/*
+ * Runs the Nfs+Mount server, which awaits RPCs, over TLS over TCP. The TLS handshake with each client is done
+ * with the userspace TLS library, and the encryption of the connection is then handed over to kernel TLS.
+ *
+ * Returns > 0 on failure.
+ */
+int run_server_tls(uint16_t port_number) {
+    ktls_server_context = create_ktls_server_context();
+    if (ktls_server_context == NULL) {
+        fprintf(stderr, "run_server_tls: failed to set up TLS\n");
+        return 1;
+    }
+
+    return run_server_tcp_listener(port_number, true);
 }
\ No newline at end of file
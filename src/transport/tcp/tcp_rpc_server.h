@@ -9,18 +9,23 @@
 #include "src/common_rpc/common_rpc.h"
 #include "src/common_rpc/server_common_rpc.h"
 
+#include "src/transport/tcp/ktls.h"
 #include "src/transport/tcp/tcp_record_marking.h"
+#include "src/transport/transport_stats.h"
 
 #define TCP_RCVBUF_SIZE 65536
 #define TCP_SNDBUF_SIZE 65536
 
 int run_server_tcp(uint16_t port_number);
 
+int run_server_tls(uint16_t port_number);
+
 /*
  * TCP Nfs+Mount server state.
  */
 
 extern int rpc_server_socket_fd;
+extern SSL_CTX *ktls_server_context;
 
 extern pthread_mutex_t tcp_server_cleanup_mutex;
 extern bool tcp_server_resources_released;
@@ -1,7 +1,8 @@
 #ifndef transport_common__header__INCLUDED
 #define transport_common__header__INCLUDED
 
-#include "src/transport/quic/quic_client.h"
+#include "src/transport/quic/quic_client_pool.h"
+#include "src/transport/shm/shm_client.h"
 #include "src/transport/tcp/tcp_client.h"
 
 #define RM_FRAGMENT_HEADER_SIZE 4            // RPC Record Marking fragment header size in bytes
@@ -9,15 +10,20 @@
 
 typedef enum TransportProtocol {
     TRANSPORT_PROTOCOL_TCP = 0,
-    TRANSPORT_PROTOCOL_QUIC = 1
+    TRANSPORT_PROTOCOL_QUIC = 1,
+    TRANSPORT_PROTOCOL_SHM = 2,
+    TRANSPORT_PROTOCOL_TLS = 3
 } TransportProtocol;
 
 typedef union {
-    // TCP
+    // TCP, and TLS over TCP (encrypted by kernel TLS, so that it is used like a TCP connection)
     TcpClient *tcp_client;
 
     // QUIC
-    QuicClient *quic_client;
+    QuicClientPool *quic_client_pool;
+
+    // shared memory, for clients on the same host as the server
+    ShmClient *shm_client;
 } TransportConnection;
 
 #endif /* transport_common__header__INCLUDED */
\ No newline at end of file
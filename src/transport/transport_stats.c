@@ -0,0 +1,301 @@
+#include "transport_stats.h"
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// all connections of a process append to the same statistics file, NULL if statistics are off
+static pthread_mutex_t transport_stats_file_mutex = PTHREAD_MUTEX_INITIALIZER;
+static char *transport_stats_file_path = NULL;
+static FILE *transport_stats_file = NULL;
+
+static pthread_once_t transport_stats_env_once = PTHREAD_ONCE_INIT;
+
+/*
+ * Turns the statistics on if the TRANSPORT_STATS_FILE_ENV environment variable holds a path, and they haven't been
+ * turned on with 'enable_transport_stats' already.
+ */
+static void read_transport_stats_env(void) {
+    const char *stats_file_path = getenv(TRANSPORT_STATS_FILE_ENV);
+    if (stats_file_path == NULL || stats_file_path[0] == '\0') {
+        return;
+    }
+
+    pthread_mutex_lock(&transport_stats_file_mutex);
+    if (transport_stats_file_path == NULL) {
+        transport_stats_file_path = strdup(stats_file_path);
+    }
+    pthread_mutex_unlock(&transport_stats_file_mutex);
+}
+
+/*
+ * Turns the statistics on, appending them to the file at the given path, in place of any path given in the
+ * TRANSPORT_STATS_FILE_ENV environment variable. Should be called before any connection is opened.
+ *
+ * Returns 0 on success and > 0 on failure.
+ */
+int enable_transport_stats(const char *stats_file_path) {
+    if (stats_file_path == NULL || stats_file_path[0] == '\0') {
+        return 1;
+    }
+
+    char *stats_file_path_copy = strdup(stats_file_path);
+    if (stats_file_path_copy == NULL) {
+        return 2;
+    }
+
+    pthread_mutex_lock(&transport_stats_file_mutex);
+    free(transport_stats_file_path);
+    transport_stats_file_path = stats_file_path_copy;
+    if (transport_stats_file != NULL) {
+        fclose(transport_stats_file);
+        transport_stats_file = NULL;
+    }
+    pthread_mutex_unlock(&transport_stats_file_mutex);
+
+    // a path given here takes precedence over the environment
+    pthread_once(&transport_stats_env_once, read_transport_stats_env);
+
+    return 0;
+}
+
+/*
+ * Returns true if this process reports transport statistics.
+ */
+bool are_transport_stats_enabled(void) {
+    if (TRANSPORT_STATS_INTERVAL <= 0) {
+        return false;
+    }
+
+    pthread_once(&transport_stats_env_once, read_transport_stats_env);
+
+    pthread_mutex_lock(&transport_stats_file_mutex);
+    bool enabled = transport_stats_file_path != NULL;
+    pthread_mutex_unlock(&transport_stats_file_mutex);
+
+    return enabled;
+}
+
+/*
+ * Fills in the given statistics with those TQUIC keeps for the given QUIC connection and its active path.
+ * Leaves the number of RPCs and flow control stalls, which TQUIC doesn't know about, unchanged.
+ */
+void collect_quic_connection_stats(struct quic_conn_t *quic_connection, TransportConnectionStats *stats) {
+    const struct quic_conn_stats_t *conn_stats = quic_conn_stats(quic_connection);
+    if (conn_stats != NULL) {
+        stats->packets_sent = conn_stats->sent_count;
+        stats->packets_lost = conn_stats->lost_count;
+        // QUIC never retransmits a packet, it resends the lost frames in new packets
+        stats->retransmits = conn_stats->lost_count;
+        stats->bytes_sent = conn_stats->sent_bytes;
+        stats->bytes_received = conn_stats->recv_bytes;
+    }
+
+    const struct quic_path_stats_t *path_stats = quic_conn_active_path_stats(quic_connection);
+    if (path_stats != NULL) {
+        stats->smoothed_rtt = path_stats->srtt;
+        stats->min_rtt = path_stats->min_rtt;
+        stats->rtt_variance = path_stats->rttvar;
+        stats->congestion_window = path_stats->final_cwnd;
+        stats->congestion_window_limited_count = path_stats->cwnd_limited_count;
+    }
+}
+
+/*
+ * Fills in the given statistics with those the kernel keeps for the TCP connection of the given socket
+ * (TCP_INFO). Leaves the number of RPCs unchanged.
+ *
+ * Returns 0 on success and > 0 on failure.
+ */
+int collect_tcp_connection_stats(int socket_fd, TransportConnectionStats *stats) {
+    struct tcp_info tcp_info;
+    socklen_t tcp_info_len = sizeof(tcp_info);
+    if (getsockopt(socket_fd, IPPROTO_TCP, TCP_INFO, &tcp_info, &tcp_info_len) < 0) {
+        perror("collect_tcp_connection_stats: getsockopt(TCP_INFO) failed");
+        return 1;
+    }
+
+    stats->smoothed_rtt = tcp_info.tcpi_rtt;
+    stats->rtt_variance = tcp_info.tcpi_rttvar;
+    stats->congestion_window = (uint64_t)tcp_info.tcpi_snd_cwnd * tcp_info.tcpi_snd_mss;
+    stats->packets_lost = tcp_info.tcpi_lost;
+    stats->retransmits = tcp_info.tcpi_total_retrans;
+
+    return 0;
+}
+
+/*
+ * Returns true if at least TRANSPORT_STATS_INTERVAL seconds have passed since the given time of the last
+ * report, and sets it to the current time if so. A zeroed time of the last report is set to the current time,
+ * so the first report of a connection is due one interval after it was opened.
+ */
+bool is_transport_stats_report_due(struct timespec *last_report_time) {
+    if (!are_transport_stats_enabled()) {
+        return false;
+    }
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    if (last_report_time->tv_sec == 0 && last_report_time->tv_nsec == 0) {
+        *last_report_time = now;
+        return false;
+    }
+
+    if (now.tv_sec - last_report_time->tv_sec < TRANSPORT_STATS_INTERVAL) {
+        return false;
+    }
+    *last_report_time = now;
+
+    return true;
+}
+
+/*
+ * Appends a line made of the current time followed by the given printf-style formatted text to the statistics file.
+ *
+ * Does nothing if transport statistics are turned off.
+ */
+void append_transport_stats_line(const char *format, ...) {
+    if (!are_transport_stats_enabled()) {
+        return;
+    }
+
+    pthread_mutex_lock(&transport_stats_file_mutex);
+
+    if (transport_stats_file == NULL) {
+        transport_stats_file = fopen(transport_stats_file_path, "a");
+        if (transport_stats_file == NULL) {
+            perror("append_transport_stats_line: failed to open the transport statistics file");
+            pthread_mutex_unlock(&transport_stats_file_mutex);
+            return;
+        }
+    }
+
+    fprintf(transport_stats_file, "%ld ", (long)time(NULL));
+
+    va_list args;
+    va_start(args, format);
+    vfprintf(transport_stats_file, format, args);
+    va_end(args);
+
+    fputc('\n', transport_stats_file);
+    fflush(transport_stats_file);
+
+    pthread_mutex_unlock(&transport_stats_file_mutex);
+}
+
+/*
+ * Appends a line with the given statistics of the connection with the given name, over the given transport
+ * protocol, to the statistics file.
+ */
+void report_transport_connection_stats(const char *transport_protocol, const char *connection_name,
+                                       TransportConnectionStats *stats) {
+    double loss_percentage = stats->packets_sent > 0 ? 100.0 * stats->packets_lost / stats->packets_sent : 0;
+
+    append_transport_stats_line(
+        "%s %s rpcs=%lu srtt_us=%lu min_rtt_us=%lu rttvar_us=%lu cwnd=%lu cwnd_limited=%lu flow_control_stalls=%lu "
+        "packets_sent=%lu packets_lost=%lu loss=%.2f%% retransmits=%lu bytes_sent=%lu bytes_received=%lu",
+        transport_protocol, connection_name, stats->num_rpcs, stats->smoothed_rtt, stats->min_rtt,
+        stats->rtt_variance, stats->congestion_window, stats->congestion_window_limited_count,
+        stats->flow_control_stalls, stats->packets_sent, stats->packets_lost, loss_percentage, stats->retransmits,
+        stats->bytes_sent, stats->bytes_received);
+}
+
+/*
+ * Appends a line with the allocation totals of the RPC arenas of all server threads so far to the statistics file.
+ */
+void report_rpc_arena_stats(void) {
+    RpcArenaStats stats;
+    get_rpc_arena_stats(&stats);
+    if (stats.num_rpcs == 0) {
+        return;
+    }
+
+    append_transport_stats_line("rpc_arena rpcs=%lu arena_allocations=%lu system_allocations=%lu "
+                                "arena_allocations_per_rpc=%.1f system_allocations_per_rpc=%.3f",
+                                stats.num_rpcs, stats.num_arena_allocations, stats.num_system_allocations,
+                                (double)stats.num_arena_allocations / stats.num_rpcs,
+                                (double)stats.num_system_allocations / stats.num_rpcs);
+}
+
+/*
+ * Appends a line with the totals of READ and WRITE data compressed and decompressed by this process so far to
+ * the statistics file - how much the compressed data shrank, and the CPU time spent per MB of data.
+ */
+void report_rpc_compression_stats(void) {
+    RpcCompressionStats stats;
+    get_rpc_compression_stats(&stats);
+    if (stats.num_compressed == 0 && stats.num_skipped == 0 && stats.num_decompressed == 0) {
+        return;
+    }
+
+    double uncompressed_mb = stats.uncompressed_bytes / 1e6;
+    double decompressed_mb = stats.decompressed_bytes / 1e6;
+    append_transport_stats_line(
+        "rpc_compression compressed=%lu skipped=%lu uncompressed_bytes=%lu compressed_bytes=%lu ratio=%.2f "
+        "compress_cpu_us_per_mb=%.1f decompressed=%lu decompressed_bytes=%lu decompress_cpu_us_per_mb=%.1f",
+        stats.num_compressed, stats.num_skipped, stats.uncompressed_bytes, stats.compressed_bytes,
+        stats.compressed_bytes > 0 ? (double)stats.uncompressed_bytes / stats.compressed_bytes : 1.0,
+        uncompressed_mb > 0 ? stats.compression_ns / 1e3 / uncompressed_mb : 0.0, stats.num_decompressed,
+        stats.decompressed_bytes, decompressed_mb > 0 ? stats.decompression_ns / 1e3 / decompressed_mb : 0.0);
+}
+
+/*
+ * Collects and reports the statistics of the TCP connection of the given socket, which has carried the given
+ * number of RPCs. The connection is named after the given role ("server" or "client") and the ports of both ends.
+ */
+void report_tcp_connection_stats(int socket_fd, const char *role, uint64_t num_rpcs) {
+    if (!are_transport_stats_enabled()) {
+        return;
+    }
+
+    TransportConnectionStats stats = {0};
+    if (collect_tcp_connection_stats(socket_fd, &stats) > 0) {
+        return;
+    }
+    stats.num_rpcs = num_rpcs;
+
+    struct sockaddr_in local_addr = {0}, peer_addr = {0};
+    socklen_t local_addr_len = sizeof(local_addr), peer_addr_len = sizeof(peer_addr);
+    getsockname(socket_fd, (struct sockaddr *)&local_addr, &local_addr_len);
+    getpeername(socket_fd, (struct sockaddr *)&peer_addr, &peer_addr_len);
+
+    char connection_name[64];
+    snprintf(connection_name, sizeof(connection_name), "%s_%d_port_%u_peer_port_%u", role, getpid(),
+             ntohs(local_addr.sin_port), ntohs(peer_addr.sin_port));
+    report_transport_connection_stats("tcp", connection_name, &stats);
+}
+
+/*
+ * Makes the given QUIC connection write a qlog trace of its events to '<QUIC_QLOG_DIR>/<connection name>.sqlog'.
+ *
+ * Returns 0 on success and > 0 on failure. Does nothing if QUIC_QLOG_DIR is not defined.
+ */
+int enable_quic_qlog(struct quic_conn_t *quic_connection, const char *connection_name) {
+#ifdef QUIC_QLOG_DIR
+    char qlog_path[512];
+    if (snprintf(qlog_path, sizeof(qlog_path), "%s/%s.sqlog", QUIC_QLOG_DIR, connection_name) >= sizeof(qlog_path)) {
+        fprintf(stderr, "enable_quic_qlog: qlog file path too long\n");
+        return 1;
+    }
+
+    int qlog_fd = open(qlog_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (qlog_fd < 0) {
+        perror("enable_quic_qlog: failed to open the qlog file");
+        return 2;
+    }
+
+    // TQUIC takes the ownership of the file descriptor, and closes it with the connection
+    quic_conn_set_qlog_fd(quic_connection, qlog_fd, connection_name, "");
+#endif
+
+    return 0;
+}
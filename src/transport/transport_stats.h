@@ -0,0 +1,81 @@
+#ifndef transport_stats__header__INCLUDED
+#define transport_stats__header__INCLUDED
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "tquic.h"
+
+#include "src/common_rpc/rpc_arena.h"
+#include "src/common_rpc/rpc_compression.h"
+
+/*
+ * Every TRANSPORT_STATS_INTERVAL seconds, and once more when a connection closes, servers and clients append a
+ * line of statistics for each of their TCP and QUIC connections to a statistics file. Statistics are off unless
+ * the process is given the path of that file, in the TRANSPORT_STATS_FILE_ENV environment variable or through
+ * 'enable_transport_stats'. Building with TRANSPORT_STATS_INTERVAL=0 turns the statistics off altogether.
+ */
+#ifndef TRANSPORT_STATS_INTERVAL
+#define TRANSPORT_STATS_INTERVAL 10
+#endif
+
+#define TRANSPORT_STATS_FILE_ENV "NFS_TRANSPORT_STATS_FILE"
+
+/*
+ * If QUIC_QLOG_DIR is defined, every QUIC connection writes a qlog (JSON-SEQ) trace of its events to a file
+ * in that directory, which can be loaded into qvis.
+ */
+
+/*
+ * A snapshot of the statistics of a single TCP or QUIC connection. Counters are totals since the connection
+ * was opened.
+ */
+typedef struct TransportConnectionStats {
+    uint64_t num_rpcs;
+
+    // round trip times in microseconds (the minimum only for QUIC)
+    uint64_t smoothed_rtt;
+    uint64_t min_rtt;
+    uint64_t rtt_variance;
+
+    // congestion window in bytes
+    uint64_t congestion_window;
+    // times the sender had data to send but the congestion window was full (QUIC only)
+    uint64_t congestion_window_limited_count;
+    // times a reply couldn't be written because its stream was out of flow control credit (QUIC server only)
+    uint64_t flow_control_stalls;
+
+    uint64_t packets_lost;
+    uint64_t retransmits;
+
+    // only known for QUIC connections
+    uint64_t packets_sent;
+    uint64_t bytes_sent;
+    uint64_t bytes_received;
+} TransportConnectionStats;
+
+void collect_quic_connection_stats(struct quic_conn_t *quic_connection, TransportConnectionStats *stats);
+
+int collect_tcp_connection_stats(int socket_fd, TransportConnectionStats *stats);
+
+int enable_transport_stats(const char *stats_file_path);
+
+bool are_transport_stats_enabled(void);
+
+bool is_transport_stats_report_due(struct timespec *last_report_time);
+
+void report_rpc_arena_stats(void);
+
+void report_rpc_compression_stats(void);
+
+void report_tcp_connection_stats(int socket_fd, const char *role, uint64_t num_rpcs);
+
+void append_transport_stats_line(const char *format, ...);
+
+void report_transport_connection_stats(const char *transport_protocol, const char *connection_name,
+                                       TransportConnectionStats *stats);
+
+int enable_quic_qlog(struct quic_conn_t *quic_connection, const char *connection_name);
+
+#endif /* transport_stats__header__INCLUDED */
@@ -0,0 +1,236 @@
+/*
+ * Microbenchmark of the GETATTR attributes cache, on several server threads.
+ *
+ * Every thread repeatedly builds the results of an NFSPROC_GETATTR the way the server does it: lstat() a file, then
+ * either get its attributes and pack the AttrStat, or copy the packed AttrStat from the attributes cache. The files
+ * are spread over the slots of the cache. This is done once without the cache, once with it, and once with the
+ * cached results of a file invalidated before every 8th GETATTR of it (as SETATTR, WRITE, REMOVE and RENAME do).
+ * Reports the throughput in RPCs per second over all threads and the fraction of GETATTRs served from the cache.
+ *
+ * Build with 'make benchmark' and run './build/attributes_cache_benchmark'.
+ */
+
+// first, as it sets the feature test macros it needs before any system header is included
+#include "src/nfs/server/file_management.h"
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "src/common_rpc/rpc_arena.h"
+#include "src/common_rpc/rpc_msg_encoding.h"
+#include "src/nfs/server/attributes_cache.h"
+
+#include "src/serialization/nfs/nfs.pb-c.h"
+
+#define NUM_THREADS 4
+#define NUM_RPCS_PER_THREAD 500000
+#define NUM_FILES 256
+
+// in the benchmark with invalidation, the cached results of a file are invalidated before every this many GETATTRs
+#define INVALIDATION_PERIOD 8
+
+typedef enum BenchmarkMode {
+    BENCHMARK_MODE_NO_CACHE,
+    BENCHMARK_MODE_CACHE,
+    BENCHMARK_MODE_CACHE_WITH_INVALIDATION
+} BenchmarkMode;
+
+typedef struct BenchmarkThread {
+    pthread_t thread;
+    int thread_index;
+
+    char **file_paths;
+    BenchmarkMode mode;
+
+    size_t num_cache_hits;
+    int error_code;
+} BenchmarkThread;
+
+static AttributesCache attributes_cache;
+
+static double seconds_since(struct timespec *start) {
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    return (end.tv_sec - start->tv_sec) + (end.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+/*
+ * Builds the packed GETATTR results of the file at the given path, using the attributes cache if 'use_cache' is true,
+ * and sets 'cache_hit' if they were copied from the cache.
+ *
+ * Returns 0 on success and > 0 on failure.
+ */
+static int serve_getattr(char *file_path, bool use_cache, bool *cache_hit) {
+    struct stat file_stat;
+    if (lstat(file_path, &file_stat) < 0) {
+        return 1;
+    }
+
+    uint8_t *attr_stat_buffer;
+    size_t attr_stat_size;
+    *cache_hit = use_cache && get_cached_attr_stat(&attributes_cache, RPC_CODEC_PROTOBUF, &file_stat,
+                                                   &attr_stat_buffer, &attr_stat_size) == 0;
+    if (*cache_hit) {
+        free_rpc_payload_buffer(attr_stat_buffer);
+        return 0;
+    }
+
+    Nfs__FAttr fattr = NFS__FATTR__INIT;
+    if (get_attributes_from_stat(&file_stat, &fattr) > 0) {
+        return 2;
+    }
+
+    Nfs__NfsStat nfs_status = NFS__NFS_STAT__INIT;
+    nfs_status.stat = NFS__STAT__NFS_OK;
+    Nfs__AttrStat attr_stat = NFS__ATTR_STAT__INIT;
+    attr_stat.nfs_status = &nfs_status;
+    attr_stat.body_case = NFS__ATTR_STAT__BODY_ATTRIBUTES;
+    attr_stat.attributes = &fattr;
+
+    attr_stat_size = get_rpc_payload_packed_size(RPC_CODEC_PROTOBUF, &attr_stat.base);
+    attr_stat_buffer = allocate_rpc_payload_buffer(attr_stat_size);
+    if (attr_stat_buffer == NULL) {
+        clean_up_fattr(&fattr);
+        return 3;
+    }
+    pack_rpc_payload(RPC_CODEC_PROTOBUF, &attr_stat.base, attr_stat_buffer);
+
+    if (use_cache) {
+        add_cached_attr_stat(&attributes_cache, RPC_CODEC_PROTOBUF, &file_stat, attr_stat_buffer, attr_stat_size);
+    }
+
+    free_rpc_payload_buffer(attr_stat_buffer);
+    clean_up_fattr(&fattr);
+
+    return 0;
+}
+
+static void *run_benchmark_thread(void *arg) {
+    BenchmarkThread *benchmark_thread = (BenchmarkThread *)arg;
+    bool use_cache = benchmark_thread->mode != BENCHMARK_MODE_NO_CACHE;
+
+    for (size_t i = 0; i < NUM_RPCS_PER_THREAD && benchmark_thread->error_code == 0; i++) {
+        // threads start on different files, so that they don't all wait on the lock of the same slot
+        size_t file_index = (i + benchmark_thread->thread_index * (NUM_FILES / NUM_THREADS)) % NUM_FILES;
+        char *file_path = benchmark_thread->file_paths[file_index];
+
+        if (benchmark_thread->mode == BENCHMARK_MODE_CACHE_WITH_INVALIDATION &&
+            (i / NUM_FILES) % INVALIDATION_PERIOD == 0) {
+            struct stat file_stat;
+            if (lstat(file_path, &file_stat) == 0) {
+                invalidate_cached_attr_stat(&attributes_cache, file_stat.st_ino);
+            }
+        }
+
+        begin_rpc_arena();
+
+        bool cache_hit;
+        benchmark_thread->error_code = serve_getattr(file_path, use_cache, &cache_hit);
+        benchmark_thread->num_cache_hits += cache_hit;
+
+        end_rpc_arena();
+    }
+
+    return NULL;
+}
+
+/*
+ * Returns 0 on success and > 0 on failure.
+ */
+static int run_benchmark(char **file_paths, BenchmarkMode mode) {
+    BenchmarkThread benchmark_threads[NUM_THREADS];
+
+    init_attributes_cache(&attributes_cache);
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    for (int i = 0; i < NUM_THREADS; i++) {
+        benchmark_threads[i].thread_index = i;
+        benchmark_threads[i].file_paths = file_paths;
+        benchmark_threads[i].mode = mode;
+        benchmark_threads[i].num_cache_hits = 0;
+        benchmark_threads[i].error_code = 0;
+
+        if (pthread_create(&benchmark_threads[i].thread, NULL, run_benchmark_thread, &benchmark_threads[i]) != 0) {
+            fprintf(stderr, "run_benchmark: failed to create a benchmark thread\n");
+            return 1;
+        }
+    }
+
+    int error_code = 0;
+    size_t num_cache_hits = 0;
+    for (int i = 0; i < NUM_THREADS; i++) {
+        pthread_join(benchmark_threads[i].thread, NULL);
+        error_code = error_code > 0 ? error_code : benchmark_threads[i].error_code;
+        num_cache_hits += benchmark_threads[i].num_cache_hits;
+    }
+    if (error_code > 0) {
+        fprintf(stderr, "run_benchmark: serving GETATTR failed with status %d\n", error_code);
+        return 2;
+    }
+
+    double elapsed_seconds = seconds_since(&start);
+    double num_rpcs = (double)NUM_THREADS * NUM_RPCS_PER_THREAD;
+
+    const char *mode_name = mode == BENCHMARK_MODE_NO_CACHE ? "GETATTR (no cache)"
+                            : mode == BENCHMARK_MODE_CACHE  ? "GETATTR (cache)"
+                                                            : "GETATTR (cache, 1/8 invalidated)";
+    fprintf(stdout, "%-34s %12.0f RPCs/s %6.1f%% cache hits\n", mode_name, num_rpcs / elapsed_seconds,
+            100.0 * num_cache_hits / num_rpcs);
+
+    return 0;
+}
+
+int main(void) {
+    char directory_path[] = "/tmp/attributes_cache_benchmark_XXXXXX";
+    if (mkdtemp(directory_path) == NULL) {
+        perror("Error: failed to create a directory for the benchmark files");
+        return 1;
+    }
+
+    char *file_paths[NUM_FILES];
+    int num_created_files = 0, error_code = 0;
+    for (; num_created_files < NUM_FILES; num_created_files++) {
+        file_paths[num_created_files] = malloc(sizeof(directory_path) + 16);
+        if (file_paths[num_created_files] == NULL) {
+            fprintf(stderr, "Error: failed to allocate memory\n");
+            error_code = 1;
+            break;
+        }
+        sprintf(file_paths[num_created_files], "%s/file_%d", directory_path, num_created_files);
+
+        FILE *file = fopen(file_paths[num_created_files], "w");
+        if (file == NULL) {
+            perror("Error: failed to create a benchmark file");
+            free(file_paths[num_created_files]);
+            error_code = 1;
+            break;
+        }
+        fclose(file);
+    }
+
+    error_code = error_code > 0 ? error_code : run_benchmark(file_paths, BENCHMARK_MODE_NO_CACHE);
+    error_code = error_code > 0 ? error_code : run_benchmark(file_paths, BENCHMARK_MODE_CACHE);
+    error_code = error_code > 0 ? error_code : run_benchmark(file_paths, BENCHMARK_MODE_CACHE_WITH_INVALIDATION);
+
+    for (int i = 0; i < num_created_files; i++) {
+        unlink(file_paths[i]);
+        free(file_paths[i]);
+    }
+    rmdir(directory_path);
+
+    if (error_code > 0) {
+        fprintf(stderr, "Error: benchmark failed with status %d\n", error_code);
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,180 @@
+/*
+ * End-to-end benchmark of bulk transfer throughput over an emulated long, lossy link, against a running
+ * Nfs+Mount server. Reads the given file (a file of a few hundred MB on the server) once with NFSPROC_READ,
+ * from several threads sharing one RPC connection, over TCP, TLS over TCP (kernel TLS) and QUIC, and reports
+ * the throughput of each transport and the client CPU time it took per MB read.
+ *
+ * Emulate the link on loopback before running, e.g. with a 50 ms RTT and 0.1% loss:
+ *     sudo tc qdisc add dev lo root netem delay 25ms loss 0.1%
+ * and remove it afterwards with 'sudo tc qdisc del dev lo root'. The TCP, TLS and QUIC servers must all be
+ * running, on the given TCP, TLS and QUIC ports. The TLS transport needs the 'tls' kernel module
+ * ('sudo modprobe tls').
+ *
+ * The congestion control algorithm and windows chosen for the QUIC connections are recorded in the
+ * transport statistics file. To compare algorithms, add e.g.
+ * -DQUIC_CONGESTION_CONTROL_ALGORITHM=QUIC_CONGESTION_CONTROL_ALGORITHM_CUBIC to CFLAGS in the Makefile.
+ *
+ * Build with 'make bulk-transfer-benchmark', and run
+ * './build/bulk_transfer_benchmark <server ip> <tcp port> <tls port> <quic port> <exported directory> <file name>'.
+ */
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <time.h>
+
+#include "src/authentication/authentication.h"
+#include "src/common_rpc/rpc_connection_context.h"
+#include "src/nfs/clients/mount_client.h"
+#include "src/nfs/clients/nfs_client.h"
+
+#define NUM_READERS 16
+
+typedef struct BenchmarkFile {
+    RpcConnectionContext *rpc_connection_context;
+    Nfs__FHandle *fhandle;
+    uint32_t size;
+} BenchmarkFile;
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// user plus system CPU time of the whole process, including the QUIC clients' event loop threads
+static double cpu_sec(void) {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+
+    return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6 + usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+}
+
+/*
+ * Reads every NUM_READERS-th NFS_MAXDATA chunk of the benchmark file, starting at a different chunk in every
+ * reader, so that all readers together read the whole file once. Returns the number of bytes read.
+ */
+static void *reader_runner(void *arg) {
+    BenchmarkFile *benchmark_file = arg;
+
+    static int next_reader_index = 0;
+    int reader_index = __atomic_fetch_add(&next_reader_index, 1, __ATOMIC_RELAXED) % NUM_READERS;
+
+    uint64_t bytes_read = 0;
+    for (uint64_t offset = (uint64_t)reader_index * NFS_MAXDATA; offset < benchmark_file->size;
+         offset += (uint64_t)NUM_READERS * NFS_MAXDATA) {
+        Nfs__ReadArgs readargs = NFS__READ_ARGS__INIT;
+        readargs.file = benchmark_file->fhandle;
+        readargs.offset = offset;
+        readargs.count = NFS_MAXDATA;
+
+        Nfs__ReadRes *readres = malloc(sizeof(Nfs__ReadRes));
+        if (nfs_procedure_6_read_from_file(benchmark_file->rpc_connection_context, readargs, readres) != 0) {
+            fprintf(stderr, "reader_runner: NFSPROC_READ failed\n");
+            free(readres);
+            break;
+        }
+        if (readres->nfs_status->stat == NFS__STAT__NFS_OK) {
+            bytes_read += readres->readresbody->nfsdata.len;
+        }
+        nfs__read_res__free_unpacked(readres, NULL);
+    }
+
+    return (void *)(uintptr_t)bytes_read;
+}
+
+/*
+ * Connects to the server over the given transport protocol, reads the whole given file of the given exported
+ * directory, and prints the throughput and the CPU time per MB read.
+ *
+ * Returns 0 on success and > 0 on failure.
+ */
+static int measure_throughput(const char *server_ip, uint16_t server_port, TransportProtocol transport_protocol,
+                              char *directory, char *file, const char *label) {
+    uint32_t gids[1] = {0};
+    Rpc__OpaqueAuth *credential = create_auth_sys_opaque_auth("benchmark", 0, 0, 1, gids);
+    Rpc__OpaqueAuth *verifier = create_auth_none_opaque_auth();
+    RpcConnectionContext *rpc_connection_context =
+        create_rpc_connection_context((char *)server_ip, server_port, credential, verifier, transport_protocol);
+    if (rpc_connection_context == NULL) {
+        fprintf(stderr, "measure_throughput: failed to connect to the server\n");
+        return 1;
+    }
+
+    // mount the exported directory and look up the file in it
+    Mount__DirPath dirpath = MOUNT__DIR_PATH__INIT;
+    dirpath.path = directory;
+    Mount__FhStatus *fhstatus = malloc(sizeof(Mount__FhStatus));
+    if (mount_procedure_1_add_mount_entry(rpc_connection_context, dirpath, fhstatus) != 0 ||
+        fhstatus->mnt_status->stat != MOUNT__STAT__MNT_OK) {
+        fprintf(stderr, "measure_throughput: failed to mount %s\n", directory);
+        return 2;
+    }
+
+    Nfs__FHandle directory_fhandle = NFS__FHANDLE__INIT;
+    directory_fhandle.nfs_filehandle = fhstatus->directory->nfs_filehandle;
+    Nfs__FileName file_name = NFS__FILE_NAME__INIT;
+    file_name.filename = file;
+    Nfs__DirOpArgs diropargs = NFS__DIR_OP_ARGS__INIT;
+    diropargs.dir = &directory_fhandle;
+    diropargs.name = &file_name;
+
+    Nfs__DirOpRes *diropres = malloc(sizeof(Nfs__DirOpRes));
+    if (nfs_procedure_4_look_up_file_name(rpc_connection_context, diropargs, diropres) != 0 ||
+        diropres->nfs_status->stat != NFS__STAT__NFS_OK) {
+        fprintf(stderr, "measure_throughput: failed to look up %s\n", file);
+        return 3;
+    }
+
+    BenchmarkFile benchmark_file = {rpc_connection_context, diropres->diropok->file,
+                                    diropres->diropok->attributes->size};
+
+    double start = now_sec();
+    double cpu_start = cpu_sec();
+    pthread_t readers[NUM_READERS];
+    for (int i = 0; i < NUM_READERS; i++) {
+        pthread_create(&readers[i], NULL, reader_runner, &benchmark_file);
+    }
+
+    uint64_t total_bytes_read = 0;
+    for (int i = 0; i < NUM_READERS; i++) {
+        void *bytes_read;
+        pthread_join(readers[i], &bytes_read);
+        total_bytes_read += (uintptr_t)bytes_read;
+    }
+    double elapsed_seconds = now_sec() - start;
+    double cpu_seconds = cpu_sec() - cpu_start;
+
+    printf("%-6s %10lu bytes in %7.2f s   %8.1f MB/s   %6.2f ms CPU/MB\n", label, total_bytes_read, elapsed_seconds,
+           total_bytes_read / elapsed_seconds / 1e6, cpu_seconds * 1e3 / (total_bytes_read / 1e6));
+
+    nfs__dir_op_res__free_unpacked(diropres, NULL);
+    mount__fh_status__free_unpacked(fhstatus, NULL);
+    free_rpc_connection_context(rpc_connection_context);
+
+    return total_bytes_read == benchmark_file.size ? 0 : 4;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc != 7) {
+        fprintf(stderr, "Usage: %s <server ip> <tcp port> <tls port> <quic port> <exported directory> <file name>\n",
+                argv[0]);
+        return 1;
+    }
+
+    printf("Reading %s with %d readers\n", argv[6], NUM_READERS);
+
+    int error_code = measure_throughput(argv[1], atoi(argv[2]), TRANSPORT_PROTOCOL_TCP, argv[5], argv[6], "TCP:");
+    if (error_code == 0) {
+        error_code = measure_throughput(argv[1], atoi(argv[3]), TRANSPORT_PROTOCOL_TLS, argv[5], argv[6], "TLS:");
+    }
+    if (error_code == 0) {
+        error_code = measure_throughput(argv[1], atoi(argv[4]), TRANSPORT_PROTOCOL_QUIC, argv[5], argv[6], "QUIC:");
+    }
+
+    return error_code;
+}
@@ -0,0 +1,199 @@
+/*
+ * End-to-end benchmark of metadata RPC latency under bulk load, against a running Nfs+Mount server over QUIC.
+ * Measures the latency of NFSPROC_GETATTR on the given file, first on an idle connection and then while other
+ * threads keep reading the whole file (a multi-GB file on the server, so the reads never run out) with
+ * NFSPROC_READ on the same connection. Reports the p50, p99 and maximum GETATTR latency in both cases.
+ *
+ * The benchmark is built with a single QUIC connection per client (QUIC_CLIENT_POOL_SIZE=1), so GETATTRs and
+ * READs share the connection's congestion window and only stream priorities keep them apart.
+ *
+ * Build with 'make metadata-latency-benchmark', start the server, and run
+ * './build/metadata_latency_benchmark <server ip> <server port> <exported directory> <file name>'.
+ */
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "src/authentication/authentication.h"
+#include "src/common_rpc/rpc_connection_context.h"
+#include "src/nfs/clients/mount_client.h"
+#include "src/nfs/clients/nfs_client.h"
+
+#define NUM_GETATTRS 2000
+#define NUM_READERS 4
+
+typedef struct BenchmarkFile {
+    RpcConnectionContext *rpc_connection_context;
+    Nfs__FHandle *fhandle;
+    uint32_t size;
+} BenchmarkFile;
+
+static volatile bool readers_running;
+
+static double now_usec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static int compare_doubles(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+
+    return (x > y) - (x < y);
+}
+
+/*
+ * Keeps reading the whole benchmark file in NFS_MAXDATA chunks, starting at a different offset in every reader,
+ * until the benchmark is over. Returns the number of bytes read.
+ */
+static void *reader_runner(void *arg) {
+    BenchmarkFile *benchmark_file = arg;
+
+    static int next_reader_index = 0;
+    int reader_index = __atomic_fetch_add(&next_reader_index, 1, __ATOMIC_RELAXED);
+
+    uint64_t bytes_read = 0;
+    uint32_t offset = (uint64_t)benchmark_file->size / NUM_READERS * reader_index;
+    while (readers_running) {
+        Nfs__ReadArgs readargs = NFS__READ_ARGS__INIT;
+        readargs.file = benchmark_file->fhandle;
+        readargs.offset = offset;
+        readargs.count = NFS_MAXDATA;
+
+        Nfs__ReadRes *readres = malloc(sizeof(Nfs__ReadRes));
+        if (nfs_procedure_6_read_from_file(benchmark_file->rpc_connection_context, readargs, readres) != 0) {
+            fprintf(stderr, "reader_runner: NFSPROC_READ failed\n");
+            free(readres);
+            break;
+        }
+        if (readres->nfs_status->stat == NFS__STAT__NFS_OK) {
+            bytes_read += readres->readresbody->nfsdata.len;
+        }
+        nfs__read_res__free_unpacked(readres, NULL);
+
+        offset += NFS_MAXDATA;
+        if (offset >= benchmark_file->size) {
+            offset = 0;
+        }
+    }
+
+    return (void *)(uintptr_t)bytes_read;
+}
+
+/*
+ * Calls NFSPROC_GETATTR on the benchmark file NUM_GETATTRS times, one at a time, and prints the latency
+ * percentiles.
+ *
+ * Returns 0 on success and > 0 on failure.
+ */
+static int measure_getattr_latency(BenchmarkFile *benchmark_file, const char *label) {
+    double *latencies = malloc(sizeof(double) * NUM_GETATTRS);
+    if (latencies == NULL) {
+        return 1;
+    }
+
+    for (int i = 0; i < NUM_GETATTRS; i++) {
+        Nfs__AttrStat *attrstat = malloc(sizeof(Nfs__AttrStat));
+
+        double start = now_usec();
+        int status = nfs_procedure_1_get_file_attributes(benchmark_file->rpc_connection_context,
+                                                         *benchmark_file->fhandle, attrstat);
+        latencies[i] = now_usec() - start;
+        if (status != 0) {
+            fprintf(stderr, "measure_getattr_latency: NFSPROC_GETATTR failed - status %d\n", status);
+            free(attrstat);
+            free(latencies);
+            return 2;
+        }
+        nfs__attr_stat__free_unpacked(attrstat, NULL);
+    }
+
+    qsort(latencies, NUM_GETATTRS, sizeof(double), compare_doubles);
+    printf("%-28s p50 %9.1f us   p99 %9.1f us   max %9.1f us\n", label, latencies[NUM_GETATTRS / 2],
+           latencies[NUM_GETATTRS * 99 / 100], latencies[NUM_GETATTRS - 1]);
+
+    free(latencies);
+
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc != 5) {
+        fprintf(stderr, "Usage: %s <server ip> <server port> <exported directory> <file name>\n", argv[0]);
+        return 1;
+    }
+
+    uint32_t gids[1] = {0};
+    Rpc__OpaqueAuth *credential = create_auth_sys_opaque_auth("benchmark", 0, 0, 1, gids);
+    Rpc__OpaqueAuth *verifier = create_auth_none_opaque_auth();
+    RpcConnectionContext *rpc_connection_context =
+        create_rpc_connection_context(argv[1], atoi(argv[2]), credential, verifier, TRANSPORT_PROTOCOL_QUIC);
+    if (rpc_connection_context == NULL) {
+        fprintf(stderr, "Failed to connect to the server\n");
+        return 1;
+    }
+
+    // mount the exported directory and look up the file in it
+    Mount__DirPath dirpath = MOUNT__DIR_PATH__INIT;
+    dirpath.path = argv[3];
+    Mount__FhStatus *fhstatus = malloc(sizeof(Mount__FhStatus));
+    if (mount_procedure_1_add_mount_entry(rpc_connection_context, dirpath, fhstatus) != 0 ||
+        fhstatus->mnt_status->stat != MOUNT__STAT__MNT_OK) {
+        fprintf(stderr, "Failed to mount %s\n", argv[3]);
+        return 1;
+    }
+
+    Nfs__FHandle directory_fhandle = NFS__FHANDLE__INIT;
+    directory_fhandle.nfs_filehandle = fhstatus->directory->nfs_filehandle;
+    Nfs__FileName file_name = NFS__FILE_NAME__INIT;
+    file_name.filename = argv[4];
+    Nfs__DirOpArgs diropargs = NFS__DIR_OP_ARGS__INIT;
+    diropargs.dir = &directory_fhandle;
+    diropargs.name = &file_name;
+
+    Nfs__DirOpRes *diropres = malloc(sizeof(Nfs__DirOpRes));
+    if (nfs_procedure_4_look_up_file_name(rpc_connection_context, diropargs, diropres) != 0 ||
+        diropres->nfs_status->stat != NFS__STAT__NFS_OK) {
+        fprintf(stderr, "Failed to look up %s\n", argv[4]);
+        return 1;
+    }
+
+    BenchmarkFile benchmark_file = {rpc_connection_context, diropres->diropok->file,
+                                    diropres->diropok->attributes->size};
+    printf("GETATTR latency, %d calls, file of %u bytes, %d readers\n", NUM_GETATTRS, benchmark_file.size,
+           NUM_READERS);
+
+    int error_code = measure_getattr_latency(&benchmark_file, "idle connection:");
+
+    readers_running = true;
+    pthread_t readers[NUM_READERS];
+    for (int i = 0; i < NUM_READERS; i++) {
+        pthread_create(&readers[i], NULL, reader_runner, &benchmark_file);
+    }
+
+    double start = now_usec();
+    if (error_code == 0) {
+        error_code = measure_getattr_latency(&benchmark_file, "concurrent bulk reads:");
+    }
+    double elapsed_seconds = (now_usec() - start) / 1e6;
+
+    readers_running = false;
+    uint64_t total_bytes_read = 0;
+    for (int i = 0; i < NUM_READERS; i++) {
+        void *bytes_read;
+        pthread_join(readers[i], &bytes_read);
+        total_bytes_read += (uintptr_t)bytes_read;
+    }
+    printf("bulk read throughput:        %.1f MB/s\n", total_bytes_read / elapsed_seconds / 1e6);
+
+    nfs__dir_op_res__free_unpacked(diropres, NULL);
+    mount__fh_status__free_unpacked(fhstatus, NULL);
+    free_rpc_connection_context(rpc_connection_context);
+
+    return error_code;
+}
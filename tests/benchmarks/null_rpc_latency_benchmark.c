@@ -0,0 +1,84 @@
+/*
+ * End-to-end benchmark of the round-trip latency of the NULL procedure, against a running Nfs+Mount server on
+ * the same host. Sends NFSPROC_NULL over the given transport protocol from a single thread, and reports the
+ * p50, p99 and maximum latency, which is mostly the cost of the transport itself.
+ *
+ * Build with 'make null-rpc-latency-benchmark', start the server with the same transport protocol, and run
+ * './build/null_rpc_latency_benchmark <server port> <tcp, quic or shm>'.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "src/common_rpc/rpc_connection_context.h"
+#include "src/nfs/clients/nfs_client.h"
+
+#define NUM_WARMUP_CALLS 1000
+#define NUM_CALLS 100000
+
+static double now_usec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static int compare_doubles(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+
+    return (x > y) - (x < y);
+}
+
+int main(int argc, char *argv[]) {
+    if (argc != 3) {
+        fprintf(stderr, "Usage: %s <server port> <tcp, quic or shm>\n", argv[0]);
+        return 1;
+    }
+
+    TransportProtocol transport_protocol;
+    if (strcmp(argv[2], "tcp") == 0) {
+        transport_protocol = TRANSPORT_PROTOCOL_TCP;
+    } else if (strcmp(argv[2], "quic") == 0) {
+        transport_protocol = TRANSPORT_PROTOCOL_QUIC;
+    } else if (strcmp(argv[2], "shm") == 0) {
+        transport_protocol = TRANSPORT_PROTOCOL_SHM;
+    } else {
+        fprintf(stderr, "Invalid transport protocol: %s\n", argv[2]);
+        return 1;
+    }
+
+    RpcConnectionContext *rpc_connection_context =
+        create_auth_none_rpc_connection_context("127.0.0.1", atoi(argv[1]), transport_protocol);
+    if (rpc_connection_context == NULL) {
+        fprintf(stderr, "Failed to connect to the server\n");
+        return 1;
+    }
+
+    for (int i = 0; i < NUM_WARMUP_CALLS; i++) {
+        if (nfs_procedure_0_do_nothing(rpc_connection_context) != 0) {
+            fprintf(stderr, "NFSPROC_NULL failed\n");
+            return 2;
+        }
+    }
+
+    double *latencies = malloc(sizeof(double) * NUM_CALLS);
+    for (int i = 0; i < NUM_CALLS; i++) {
+        double start = now_usec();
+        if (nfs_procedure_0_do_nothing(rpc_connection_context) != 0) {
+            fprintf(stderr, "NFSPROC_NULL failed\n");
+            return 2;
+        }
+        latencies[i] = now_usec() - start;
+    }
+    qsort(latencies, NUM_CALLS, sizeof(double), compare_doubles);
+
+    printf("%-5s NULL RPC latency: p50 %7.1f us   p99 %7.1f us   max %8.1f us\n", argv[2],
+           latencies[NUM_CALLS / 2], latencies[NUM_CALLS * 99 / 100], latencies[NUM_CALLS - 1]);
+
+    free(latencies);
+    free_rpc_connection_context(rpc_connection_context);
+
+    return 0;
+}
@@ -0,0 +1,259 @@
+/*
+ * Microbenchmark of the encoding of READDIR results, comparing the recursive DirectoryEntriesList of READDIR with the
+ * flat ReadDir2Ok of READDIR2, in both codecs, for 100, 10k and 1M directory entries.
+ *
+ * Reports the size of the encoded results, and the time to encode them (get the packed size and pack) and to decode
+ * them (unpack and free). Recursive protobuf results are not encoded beyond RECURSIVE_PROTOBUF_MAX_ENTRIES entries, as
+ * protobuf-c works out the size of every nested entry again for each of the entries around it, which takes quadratic
+ * time in the number of entries.
+ *
+ * Everything runs on a thread with a BENCHMARK_STACK_SIZE stack, as unpacking and freeing the recursive results
+ * recurses once per entry.
+ *
+ * Build with 'make benchmark' and run './build/readdir_encoding_benchmark'.
+ */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "src/serialization/nfs/nfs.pb-c.h"
+
+#include "src/common_rpc/rpc_codec.h"
+
+#define ENTRIES_PER_RUN 2000000 // each size is encoded and decoded this many entries' worth of times
+
+#define RECURSIVE_PROTOBUF_MAX_ENTRIES 10000
+
+#define BENCHMARK_STACK_SIZE ((size_t)2 * 1024 * 1024 * 1024)
+
+#define FILE_NAME_SIZE 16 // "file_" followed by the entry index and a NUL byte
+
+static const size_t num_entries_to_benchmark[] = {100, 10000, 1000000};
+
+static const RpcCodec codecs[] = {RPC_CODEC_PROTOBUF, RPC_CODEC_XDR};
+
+static double seconds_since(struct timespec *start) {
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    return (end.tv_sec - start->tv_sec) + (end.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static const char *get_codec_name(RpcCodec codec) {
+    return codec == RPC_CODEC_XDR ? "xdr" : "protobuf";
+}
+
+/*
+ * Directory entries as the server builds them, in both layouts.
+ */
+typedef struct BenchmarkEntries {
+    size_t num_entries;
+
+    // READDIR - a list of entries, each with its own FileName and NfsCookie
+    Nfs__DirectoryEntriesList *list_entries;
+    Nfs__FileName *file_names;
+    Nfs__NfsCookie *cookies;
+    char *list_names;
+    Nfs__NfsStat nfs_status;
+    Nfs__ReadDirOk readdirok;
+    Nfs__ReadDirRes readdirres;
+
+    // READDIR2 - the same entries laid out flat
+    Nfs__ReadDir2Ok readdir2ok;
+    Nfs__ReadDir2Res readdir2res;
+} BenchmarkEntries;
+
+/*
+ * Returns 0 on success and > 0 on failure.
+ */
+static int build_benchmark_entries(BenchmarkEntries *entries, size_t num_entries) {
+    entries->num_entries = num_entries;
+
+    entries->list_entries = malloc(num_entries * sizeof(Nfs__DirectoryEntriesList));
+    entries->file_names = malloc(num_entries * sizeof(Nfs__FileName));
+    entries->cookies = malloc(num_entries * sizeof(Nfs__NfsCookie));
+    entries->list_names = malloc(num_entries * FILE_NAME_SIZE);
+
+    Nfs__ReadDir2Ok *readdir2ok = &entries->readdir2ok;
+    nfs__read_dir2_ok__init(readdir2ok);
+    readdir2ok->fileids = malloc(num_entries * sizeof(uint64_t));
+    readdir2ok->cookies = malloc(num_entries * sizeof(uint64_t));
+    readdir2ok->name_offsets = malloc(num_entries * sizeof(uint32_t));
+    readdir2ok->names.data = malloc(num_entries * FILE_NAME_SIZE);
+    if (entries->list_entries == NULL || entries->file_names == NULL || entries->cookies == NULL ||
+        entries->list_names == NULL || readdir2ok->fileids == NULL || readdir2ok->cookies == NULL ||
+        readdir2ok->name_offsets == NULL || readdir2ok->names.data == NULL) {
+        return 1;
+    }
+
+    for (size_t i = 0; i < num_entries; i++) {
+        // inode numbers and telldir() cookies of a typical filesystem
+        uint64_t fileid = 1000000 + i;
+        uint64_t cookie = 0x3a5c7e9b1d2f4000 + i * 0x10f;
+
+        char *name = entries->list_names + i * FILE_NAME_SIZE;
+        snprintf(name, FILE_NAME_SIZE, "file_%zu", i);
+
+        nfs__file_name__init(&entries->file_names[i]);
+        entries->file_names[i].filename = name;
+        nfs__nfs_cookie__init(&entries->cookies[i]);
+        entries->cookies[i].value = cookie;
+
+        Nfs__DirectoryEntriesList *list_entry = &entries->list_entries[i];
+        nfs__directory_entries_list__init(list_entry);
+        list_entry->fileid = fileid;
+        list_entry->name = &entries->file_names[i];
+        list_entry->cookie = &entries->cookies[i];
+        list_entry->nextentry = i + 1 < num_entries ? &entries->list_entries[i + 1] : NULL;
+
+        size_t name_size = strlen(name) + 1;
+        readdir2ok->fileids[readdir2ok->n_fileids++] = fileid;
+        readdir2ok->cookies[readdir2ok->n_cookies++] = cookie;
+        readdir2ok->name_offsets[readdir2ok->n_name_offsets++] = readdir2ok->names.len;
+        memcpy(readdir2ok->names.data + readdir2ok->names.len, name, name_size);
+        readdir2ok->names.len += name_size;
+    }
+    readdir2ok->eof = 1;
+
+    nfs__nfs_stat__init(&entries->nfs_status);
+    entries->nfs_status.stat = NFS__STAT__NFS_OK;
+
+    nfs__read_dir_ok__init(&entries->readdirok);
+    entries->readdirok.entries = entries->list_entries;
+    entries->readdirok.eof = 1;
+
+    nfs__read_dir_res__init(&entries->readdirres);
+    entries->readdirres.nfs_status = &entries->nfs_status;
+    entries->readdirres.body_case = NFS__READ_DIR_RES__BODY_READDIROK;
+    entries->readdirres.readdirok = &entries->readdirok;
+
+    nfs__read_dir2_res__init(&entries->readdir2res);
+    entries->readdir2res.nfs_status = &entries->nfs_status;
+    entries->readdir2res.body_case = NFS__READ_DIR2_RES__BODY_READDIR2OK;
+    entries->readdir2res.readdir2ok = readdir2ok;
+
+    return 0;
+}
+
+static void free_benchmark_entries(BenchmarkEntries *entries) {
+    free(entries->list_entries);
+    free(entries->file_names);
+    free(entries->cookies);
+    free(entries->list_names);
+
+    free(entries->readdir2ok.fileids);
+    free(entries->readdir2ok.cookies);
+    free(entries->readdir2ok.name_offsets);
+    free(entries->readdir2ok.names.data);
+}
+
+/*
+ * Encodes and decodes the given READDIR or READDIR2 results with the given codec, and prints the time each took.
+ *
+ * Returns 0 on success and > 0 on failure.
+ */
+static int benchmark_readdir_results(const char *name, RpcCodec codec, const ProtobufCMessage *results,
+                                     size_t num_entries) {
+    size_t num_runs = ENTRIES_PER_RUN / num_entries;
+
+    size_t results_size = 0;
+    uint8_t *results_buffer = NULL;
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    for (size_t i = 0; i < num_runs; i++) {
+        free(results_buffer);
+
+        results_size = get_rpc_payload_packed_size(codec, results);
+        results_buffer = malloc(results_size);
+        if (results_buffer == NULL) {
+            return 1;
+        }
+        pack_rpc_payload(codec, results, results_buffer);
+    }
+
+    double encode_seconds = seconds_since(&start);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    for (size_t i = 0; i < num_runs; i++) {
+        ProtobufCMessage *unpacked_results =
+            unpack_rpc_payload(codec, results->descriptor, NULL, results_size, results_buffer);
+        if (unpacked_results == NULL) {
+            free(results_buffer);
+            return 2;
+        }
+        protobuf_c_message_free_unpacked(unpacked_results, NULL);
+    }
+
+    double decode_seconds = seconds_since(&start);
+
+    free(results_buffer);
+
+    fprintf(stdout, "%-8s %-9s %8zu entries %10zu B %12.3f ms/encode %12.3f ms/decode\n", name, get_codec_name(codec),
+            num_entries, results_size, encode_seconds * 1e3 / num_runs, decode_seconds * 1e3 / num_runs);
+
+    return 0;
+}
+
+static void *run_benchmark(void *arg) {
+    int *error_code = arg;
+
+    for (size_t i = 0; i < sizeof(num_entries_to_benchmark) / sizeof(num_entries_to_benchmark[0]); i++) {
+        size_t num_entries = num_entries_to_benchmark[i];
+
+        BenchmarkEntries entries;
+        if (build_benchmark_entries(&entries, num_entries) > 0) {
+            fprintf(stderr, "run_benchmark: failed to build %zu directory entries\n", num_entries);
+
+            free_benchmark_entries(&entries);
+            *error_code = 1;
+
+            return NULL;
+        }
+
+        for (size_t j = 0; j < sizeof(codecs) / sizeof(codecs[0]); j++) {
+            RpcCodec codec = codecs[j];
+
+            if (codec == RPC_CODEC_PROTOBUF && num_entries > RECURSIVE_PROTOBUF_MAX_ENTRIES) {
+                fprintf(stdout, "%-8s %-9s %8zu entries    skipped, as it takes quadratic time\n", "READDIR",
+                        get_codec_name(codec), num_entries);
+            } else if (benchmark_readdir_results("READDIR", codec, &entries.readdirres.base, num_entries) > 0) {
+                *error_code = 2;
+            }
+
+            if (benchmark_readdir_results("READDIR2", codec, &entries.readdir2res.base, num_entries) > 0) {
+                *error_code = 3;
+            }
+        }
+
+        free_benchmark_entries(&entries);
+    }
+
+    return NULL;
+}
+
+int main(void) {
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    if (pthread_attr_setstacksize(&attr, BENCHMARK_STACK_SIZE) != 0) {
+        fprintf(stderr, "main: failed to set the stack size of the benchmark thread\n");
+        return 1;
+    }
+
+    int error_code = 0;
+    pthread_t benchmark_thread;
+    if (pthread_create(&benchmark_thread, &attr, run_benchmark, &error_code) != 0) {
+        fprintf(stderr, "main: failed to start the benchmark thread\n");
+        return 1;
+    }
+    pthread_join(benchmark_thread, NULL);
+
+    pthread_attr_destroy(&attr);
+
+    return error_code;
+}
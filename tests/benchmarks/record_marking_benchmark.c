@@ -0,0 +1,228 @@
+/*
+ * Microbenchmark of the Record Marking receive path, in records/sec for 64 B, 8 KB and 1 MB records.
+ *
+ * 1) TCP: records are sent with 'send_rm_record_tcp' over a UNIX stream socket pair and received
+ *    with 'receive_rm_record_tcp' into a single reused record buffer.
+ * 2) Reassembly: records split into 16 KB RM fragments are reassembled in memory, once the way the
+ *    QUIC receive path does it (pooled record buffer, reused across records) and once the way it used
+ *    to (malloc'd header and payload buffers per fragment, realloc'd accumulated payloads per fragment).
+ *
+ * Build with 'make benchmark' and run './build/record_marking_benchmark'.
+ */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+
+#include "src/transport/record_buffer_pool.h"
+#include "src/transport/tcp/tcp_record_marking.h"
+
+#define REASSEMBLY_FRAGMENT_SIZE (16 * 1024)
+
+typedef struct BenchmarkCase {
+    size_t record_size;
+    size_t num_records;
+} BenchmarkCase;
+
+static const BenchmarkCase benchmark_cases[] = {
+    {64, 1000000},
+    {8 * 1024, 200000},
+    {1024 * 1024, 2000},
+};
+
+typedef struct SenderArgs {
+    int socket_fd;
+    const uint8_t *record;
+    size_t record_size;
+    size_t num_records;
+} SenderArgs;
+
+static double seconds_since(struct timespec *start) {
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    return (end.tv_sec - start->tv_sec) + (end.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static void print_result(const char *name, size_t record_size, size_t num_records, double elapsed_seconds) {
+    double records_per_second = num_records / elapsed_seconds;
+    double megabytes_per_second = records_per_second * record_size / (1024.0 * 1024.0);
+
+    fprintf(stdout, "%-24s %10zu B %14.0f records/sec %10.1f MB/s\n", name, record_size, records_per_second,
+            megabytes_per_second);
+}
+
+static void *send_records(void *arg) {
+    SenderArgs *sender_args = arg;
+
+    for (size_t i = 0; i < sender_args->num_records; i++) {
+        if (send_rm_record_tcp(sender_args->socket_fd, sender_args->record, sender_args->record_size) > 0) {
+            fprintf(stderr, "send_records: failed to send a record\n");
+            return NULL;
+        }
+    }
+
+    return NULL;
+}
+
+/*
+ * Returns 0 on success and > 0 on failure.
+ */
+static int benchmark_tcp(const BenchmarkCase *benchmark_case, const uint8_t *record) {
+    int socket_fds[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, socket_fds) < 0) {
+        perror("benchmark_tcp: failed to create a socket pair");
+        return 1;
+    }
+
+    SenderArgs sender_args = {socket_fds[0], record, benchmark_case->record_size, benchmark_case->num_records};
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    pthread_t sender_thread;
+    if (pthread_create(&sender_thread, NULL, send_records, &sender_args) != 0) {
+        fprintf(stderr, "benchmark_tcp: failed to create the sender thread\n");
+        close(socket_fds[0]);
+        close(socket_fds[1]);
+        return 2;
+    }
+
+    int ret = 0;
+    RecordBuffer rm_record = RECORD_BUFFER_INIT;
+    for (size_t i = 0; i < benchmark_case->num_records; i++) {
+        if (receive_rm_record_tcp(socket_fds[1], &rm_record) > 0 || rm_record.size != benchmark_case->record_size) {
+            fprintf(stderr, "benchmark_tcp: failed to receive a record\n");
+            ret = 3;
+            break;
+        }
+        clear_record_buffer(&rm_record);
+    }
+
+    double elapsed_seconds = seconds_since(&start);
+
+    pthread_join(sender_thread, NULL);
+    release_record_buffer(&rm_record);
+    close(socket_fds[0]);
+    close(socket_fds[1]);
+
+    if (ret == 0) {
+        print_result("tcp", benchmark_case->record_size, benchmark_case->num_records, elapsed_seconds);
+    }
+
+    return ret;
+}
+
+/*
+ * Returns 0 on success and > 0 on failure.
+ */
+static int benchmark_pooled_reassembly(const BenchmarkCase *benchmark_case, const uint8_t *record) {
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    RecordBuffer accumulated_payloads = RECORD_BUFFER_INIT;
+    for (size_t i = 0; i < benchmark_case->num_records; i++) {
+        size_t offset = 0;
+        while (offset < benchmark_case->record_size) {
+            size_t bytes_left = benchmark_case->record_size - offset;
+            size_t fragment_size = bytes_left < REASSEMBLY_FRAGMENT_SIZE ? bytes_left : REASSEMBLY_FRAGMENT_SIZE;
+            bool is_last_fragment = fragment_size == bytes_left;
+
+            if (reserve_record_buffer(&accumulated_payloads, accumulated_payloads.size + fragment_size,
+                                      is_last_fragment) > 0) {
+                release_record_buffer(&accumulated_payloads);
+                return 1;
+            }
+            memcpy(accumulated_payloads.data + accumulated_payloads.size, record + offset, fragment_size);
+            accumulated_payloads.size += fragment_size;
+
+            offset += fragment_size;
+        }
+
+        clear_record_buffer(&accumulated_payloads);
+    }
+    release_record_buffer(&accumulated_payloads);
+
+    print_result("reassembly (pooled)", benchmark_case->record_size, benchmark_case->num_records,
+                 seconds_since(&start));
+
+    return 0;
+}
+
+/*
+ * Returns 0 on success and > 0 on failure.
+ */
+static int benchmark_legacy_reassembly(const BenchmarkCase *benchmark_case, const uint8_t *record) {
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    for (size_t i = 0; i < benchmark_case->num_records; i++) {
+        uint8_t *accumulated_payloads = NULL;
+        size_t accumulated_payloads_size = 0;
+
+        size_t offset = 0;
+        while (offset < benchmark_case->record_size) {
+            size_t bytes_left = benchmark_case->record_size - offset;
+            size_t fragment_size = bytes_left < REASSEMBLY_FRAGMENT_SIZE ? bytes_left : REASSEMBLY_FRAGMENT_SIZE;
+
+            uint8_t *header_bytes = malloc(RM_FRAGMENT_HEADER_SIZE);
+            uint8_t *payload_bytes = malloc(fragment_size);
+            uint8_t *new_accumulated_payloads =
+                realloc(accumulated_payloads, accumulated_payloads_size + fragment_size);
+            if (header_bytes == NULL || payload_bytes == NULL || new_accumulated_payloads == NULL) {
+                free(header_bytes);
+                free(payload_bytes);
+                free(new_accumulated_payloads == NULL ? accumulated_payloads : new_accumulated_payloads);
+                return 1;
+            }
+            accumulated_payloads = new_accumulated_payloads;
+
+            memcpy(payload_bytes, record + offset, fragment_size);
+            memcpy(accumulated_payloads + accumulated_payloads_size, payload_bytes, fragment_size);
+            accumulated_payloads_size += fragment_size;
+
+            free(header_bytes);
+            free(payload_bytes);
+
+            offset += fragment_size;
+        }
+
+        free(accumulated_payloads);
+    }
+
+    print_result("reassembly (legacy)", benchmark_case->record_size, benchmark_case->num_records,
+                 seconds_since(&start));
+
+    return 0;
+}
+
+int main(void) {
+    int num_benchmark_cases = sizeof(benchmark_cases) / sizeof(benchmark_cases[0]);
+
+    for (int i = 0; i < num_benchmark_cases; i++) {
+        const BenchmarkCase *benchmark_case = &benchmark_cases[i];
+
+        uint8_t *record = malloc(benchmark_case->record_size);
+        if (record == NULL) {
+            fprintf(stderr, "Error: failed to allocate memory\n");
+            return 1;
+        }
+        memset(record, 'a', benchmark_case->record_size);
+
+        int error_code = benchmark_tcp(benchmark_case, record);
+        error_code = error_code > 0 ? error_code : benchmark_pooled_reassembly(benchmark_case, record);
+        error_code = error_code > 0 ? error_code : benchmark_legacy_reassembly(benchmark_case, record);
+        free(record);
+        if (error_code > 0) {
+            fprintf(stderr, "Error: benchmark failed with status %d\n", error_code);
+            return 1;
+        }
+    }
+
+    clean_up_record_buffer_pool();
+
+    return 0;
+}
@@ -0,0 +1,274 @@
+/*
+ * Microbenchmark of the per-RPC arena, under a GETATTR-only load on several server threads.
+ *
+ * Every thread repeatedly runs the server side of an NFSPROC_GETATTR the way the TCP server does it: decode the call
+ * in place, unpack the FHandle, get the attributes of a file, pack the AttrStat, wrap it in an AcceptedReply, and
+ * encode the reply. This is done once with allocations falling back to malloc() (as if no arena was in use), and
+ * once with each RPC served from the arena of its thread. Reports the allocations made per RPC and the throughput
+ * in RPCs per second over all threads.
+ *
+ * Build with 'make benchmark' and run './build/rpc_arena_benchmark'.
+ */
+
+// first, as it sets the feature test macros it needs before any system header is included
+#include "src/nfs/server/file_management.h"
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "src/common_rpc/common_rpc.h"
+#include "src/common_rpc/server_common_rpc.h"
+
+#include "src/serialization/nfs/nfs.pb-c.h"
+#include "src/serialization/rpc/rpc.pb-c.h"
+
+#define NUM_THREADS 4
+#define NUM_RPCS_PER_THREAD 200000
+
+typedef struct BenchmarkThread {
+    pthread_t thread;
+
+    const uint8_t *rpc_call_buffer;
+    size_t rpc_call_size;
+    const char *file_path;
+    bool use_arena;
+
+    int error_code;
+} BenchmarkThread;
+
+static double seconds_since(struct timespec *start) {
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    return (end.tv_sec - start->tv_sec) + (end.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+/*
+ * Serves the given GETATTR call for the given file, and encodes the reply.
+ *
+ * Returns 0 on success and > 0 on failure.
+ */
+static int serve_getattr(const uint8_t *rpc_call_buffer, size_t rpc_call_size, const char *file_path) {
+    Rpc__RpcMsg *rpc_call = decode_rpc_msg_in_place(RPC_CODEC_PROTOBUF, (uint8_t *)rpc_call_buffer, rpc_call_size);
+    if (rpc_call == NULL || rpc_call->cbody == NULL || rpc_call->cbody->params == NULL) {
+        return 1;
+    }
+    Google__Protobuf__Any *parameters = rpc_call->cbody->params;
+
+    Nfs__FHandle *fhandle = nfs__fhandle__unpack(&rpc_arena_allocator, parameters->value.len, parameters->value.data);
+    if (fhandle == NULL) {
+        free_rpc_msg_decoded_in_place(rpc_call, rpc_call_buffer, rpc_call_size);
+        return 2;
+    }
+
+    Nfs__FAttr fattr = NFS__FATTR__INIT;
+    if (get_attributes((char *)file_path, &fattr) > 0) {
+        nfs__fhandle__free_unpacked(fhandle, &rpc_arena_allocator);
+        free_rpc_msg_decoded_in_place(rpc_call, rpc_call_buffer, rpc_call_size);
+        return 3;
+    }
+
+    Nfs__NfsStat nfs_status = NFS__NFS_STAT__INIT;
+    nfs_status.stat = NFS__STAT__NFS_OK;
+    Nfs__AttrStat attr_stat = NFS__ATTR_STAT__INIT;
+    attr_stat.nfs_status = &nfs_status;
+    attr_stat.body_case = NFS__ATTR_STAT__BODY_ATTRIBUTES;
+    attr_stat.attributes = &fattr;
+
+    size_t attr_stat_size = nfs__attr_stat__get_packed_size(&attr_stat);
+    uint8_t *attr_stat_buffer = allocate_rpc_payload_buffer(attr_stat_size);
+    nfs__attr_stat__pack(&attr_stat, attr_stat_buffer);
+
+    Rpc__AcceptedReply *accepted_reply =
+        wrap_procedure_results_in_successful_accepted_reply(attr_stat_size, attr_stat_buffer, "nfs/AttrStat");
+
+    nfs__fhandle__free_unpacked(fhandle, &rpc_arena_allocator);
+    clean_up_fattr(&fattr);
+    free_rpc_msg_decoded_in_place(rpc_call, rpc_call_buffer, rpc_call_size);
+
+    Rpc__ReplyBody reply_body = RPC__REPLY_BODY__INIT;
+    reply_body.stat = RPC__REPLY_STAT__MSG_ACCEPTED;
+    reply_body.reply_case = RPC__REPLY_BODY__REPLY_AREPLY;
+    reply_body.areply = accepted_reply;
+
+    Rpc__RpcMsg rpc_reply = RPC__RPC_MSG__INIT;
+    rpc_reply.xid = 1;
+    rpc_reply.mtype = RPC__MSG_TYPE__REPLY;
+    rpc_reply.body_case = RPC__RPC_MSG__BODY_RBODY;
+    rpc_reply.rbody = &reply_body;
+
+    EncodedRpcMsg encoded_rpc_msg;
+    int error_code = encode_rpc_msg(RPC_CODEC_PROTOBUF, &rpc_reply, &encoded_rpc_msg);
+    if (error_code == 0) {
+        free_encoded_rpc_msg(&encoded_rpc_msg);
+    }
+    free_accepted_reply(accepted_reply);
+
+    return error_code > 0 ? 4 : 0;
+}
+
+static void *run_benchmark_thread(void *arg) {
+    BenchmarkThread *benchmark_thread = (BenchmarkThread *)arg;
+
+    for (size_t i = 0; i < NUM_RPCS_PER_THREAD && benchmark_thread->error_code == 0; i++) {
+        if (benchmark_thread->use_arena) {
+            begin_rpc_arena();
+        }
+
+        benchmark_thread->error_code = serve_getattr(benchmark_thread->rpc_call_buffer,
+                                                     benchmark_thread->rpc_call_size, benchmark_thread->file_path);
+
+        if (benchmark_thread->use_arena) {
+            end_rpc_arena();
+        }
+    }
+
+    return NULL;
+}
+
+/*
+ * Returns 0 on success and > 0 on failure.
+ */
+static int run_benchmark(const uint8_t *rpc_call_buffer, size_t rpc_call_size, const char *file_path,
+                         bool use_arena) {
+    BenchmarkThread benchmark_threads[NUM_THREADS];
+
+    RpcArenaStats stats_before;
+    get_rpc_arena_stats(&stats_before);
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    for (int i = 0; i < NUM_THREADS; i++) {
+        benchmark_threads[i].rpc_call_buffer = rpc_call_buffer;
+        benchmark_threads[i].rpc_call_size = rpc_call_size;
+        benchmark_threads[i].file_path = file_path;
+        benchmark_threads[i].use_arena = use_arena;
+        benchmark_threads[i].error_code = 0;
+
+        if (pthread_create(&benchmark_threads[i].thread, NULL, run_benchmark_thread, &benchmark_threads[i]) != 0) {
+            fprintf(stderr, "run_benchmark: failed to create a benchmark thread\n");
+            return 1;
+        }
+    }
+
+    int error_code = 0;
+    for (int i = 0; i < NUM_THREADS; i++) {
+        pthread_join(benchmark_threads[i].thread, NULL);
+        error_code = error_code > 0 ? error_code : benchmark_threads[i].error_code;
+    }
+    if (error_code > 0) {
+        fprintf(stderr, "run_benchmark: serving GETATTR failed with status %d\n", error_code);
+        return 2;
+    }
+
+    double elapsed_seconds = seconds_since(&start);
+
+    RpcArenaStats stats_after;
+    get_rpc_arena_stats(&stats_after);
+
+    double num_rpcs = (double)NUM_THREADS * NUM_RPCS_PER_THREAD;
+    double arena_allocations = stats_after.num_arena_allocations - stats_before.num_arena_allocations;
+    double system_allocations = stats_after.num_system_allocations - stats_before.num_system_allocations;
+
+    fprintf(stdout, "%-16s %6.1f arena allocations/RPC %8.3f malloc calls/RPC %12.0f RPCs/s\n",
+            use_arena ? "GETATTR (arena)" : "GETATTR (malloc)", arena_allocations / num_rpcs,
+            system_allocations / num_rpcs, num_rpcs / elapsed_seconds);
+
+    return 0;
+}
+
+/*
+ * Packs a GETATTR call with an AUTH_SYS credential into a new buffer, and places its size in 'rpc_call_size'.
+ *
+ * Returns NULL on failure.
+ */
+static uint8_t *pack_getattr_call(size_t *rpc_call_size) {
+    NfsFh__NfsFileHandle nfs_filehandle = NFS_FH__NFS_FILE_HANDLE__INIT;
+    nfs_filehandle.inode_number = 123456;
+    nfs_filehandle.timestamp = 1700000000;
+    Nfs__FHandle fhandle = NFS__FHANDLE__INIT;
+    fhandle.nfs_filehandle = &nfs_filehandle;
+
+    size_t fhandle_size = nfs__fhandle__get_packed_size(&fhandle);
+    uint8_t *fhandle_buffer = malloc(fhandle_size);
+    if (fhandle_buffer == NULL) {
+        return NULL;
+    }
+    nfs__fhandle__pack(&fhandle, fhandle_buffer);
+
+    Google__Protobuf__Any parameters = GOOGLE__PROTOBUF__ANY__INIT;
+    parameters.type_url = "nfs/FHandle";
+    parameters.value.data = fhandle_buffer;
+    parameters.value.len = fhandle_size;
+
+    uint32_t gids[] = {1000, 27, 100};
+    Rpc__AuthSysParams auth_sys = RPC__AUTH_SYS_PARAMS__INIT;
+    auth_sys.timestamp = 1700000000;
+    auth_sys.machinename = "benchmark-client";
+    auth_sys.uid = auth_sys.gid = 1000;
+    auth_sys.n_gids = sizeof(gids) / sizeof(gids[0]);
+    auth_sys.gids = gids;
+
+    Rpc__OpaqueAuth credential = RPC__OPAQUE_AUTH__INIT;
+    credential.flavor = RPC__AUTH_FLAVOR__AUTH_SYS;
+    credential.body_case = RPC__OPAQUE_AUTH__BODY_AUTH_SYS;
+    credential.auth_sys = &auth_sys;
+
+    Google__Protobuf__Empty empty = GOOGLE__PROTOBUF__EMPTY__INIT;
+    Rpc__OpaqueAuth verifier = RPC__OPAQUE_AUTH__INIT;
+    verifier.flavor = RPC__AUTH_FLAVOR__AUTH_NONE;
+    verifier.body_case = RPC__OPAQUE_AUTH__BODY_EMPTY;
+    verifier.empty = &empty;
+
+    Rpc__CallBody call_body = RPC__CALL_BODY__INIT;
+    call_body.rpcvers = 2;
+    call_body.prog = 100003;
+    call_body.vers = 2;
+    call_body.proc = 1;
+    call_body.credential = &credential;
+    call_body.verifier = &verifier;
+    call_body.params = &parameters;
+
+    Rpc__RpcMsg rpc_msg = RPC__RPC_MSG__INIT;
+    rpc_msg.xid = 1;
+    rpc_msg.mtype = RPC__MSG_TYPE__CALL;
+    rpc_msg.body_case = RPC__RPC_MSG__BODY_CBODY;
+    rpc_msg.cbody = &call_body;
+
+    *rpc_call_size = rpc__rpc_msg__get_packed_size(&rpc_msg);
+    uint8_t *rpc_call_buffer = malloc(*rpc_call_size);
+    if (rpc_call_buffer != NULL) {
+        rpc__rpc_msg__pack(&rpc_msg, rpc_call_buffer);
+    }
+    free(fhandle_buffer);
+
+    return rpc_call_buffer;
+}
+
+int main(void) {
+    // any file will do, the attributes of the benchmark itself are as good as any
+    const char *file_path = "/proc/self/exe";
+
+    size_t rpc_call_size;
+    uint8_t *rpc_call_buffer = pack_getattr_call(&rpc_call_size);
+    if (rpc_call_buffer == NULL) {
+        fprintf(stderr, "Error: failed to allocate memory\n");
+        return 1;
+    }
+
+    int error_code = run_benchmark(rpc_call_buffer, rpc_call_size, file_path, false);
+    error_code = error_code > 0 ? error_code : run_benchmark(rpc_call_buffer, rpc_call_size, file_path, true);
+
+    free(rpc_call_buffer);
+    if (error_code > 0) {
+        fprintf(stderr, "Error: benchmark failed with status %d\n", error_code);
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,307 @@
+/*
+ * Microbenchmark of the two RPC codecs, protobuf and XDR, in bytes on the wire and ns per message.
+ *
+ * 1) Reply encoding: GETATTR replies, and READ replies carrying 8 KB of file data, encoded the way the servers do
+ *    it (procedure results packed into a payload buffer with headroom, and the RpcMsg envelope encoded in front).
+ * 2) Call decoding: WRITE calls carrying 8 KB of file data, with an AUTH_SYS credential, decoded the way the servers
+ *    do it (the RpcMsg decoded in place, and the WriteArgs unpacked from the received record).
+ *
+ * Build with 'make benchmark' and run './build/rpc_codec_benchmark'.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "src/serialization/nfs/nfs.pb-c.h"
+#include "src/serialization/rpc/rpc.pb-c.h"
+
+#include "src/common_rpc/rpc_codec.h"
+#include "src/common_rpc/rpc_msg_encoding.h"
+
+#define NUM_MESSAGES 200000
+
+#define FILE_DATA_SIZE (8 * 1024)
+
+static const RpcCodec codecs[] = {RPC_CODEC_PROTOBUF, RPC_CODEC_XDR};
+
+static double seconds_since(struct timespec *start) {
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    return (end.tv_sec - start->tv_sec) + (end.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static const char *get_codec_name(RpcCodec codec) {
+    return codec == RPC_CODEC_XDR ? "xdr" : "protobuf";
+}
+
+static void print_result(const char *name, RpcCodec codec, size_t wire_size, double elapsed_seconds) {
+    fprintf(stdout, "%-16s %-9s %8zu B/msg %10.1f ns/msg\n", name, get_codec_name(codec), wire_size,
+            elapsed_seconds * 1e9 / NUM_MESSAGES);
+}
+
+/*
+ * Fills in the attributes of a regular file, with all of its time values pointing to the given one.
+ */
+static void build_fattr(Nfs__FAttr *fattr, Nfs__NfsFType *nfs_ftype, Nfs__TimeVal *time_val) {
+    nfs_ftype->ftype = NFS__FTYPE__NFREG;
+    time_val->seconds = 1700000000;
+    time_val->useconds = 123456;
+
+    fattr->nfs_ftype = nfs_ftype;
+    fattr->mode = 0100644;
+    fattr->nlink = 1;
+    fattr->uid = fattr->gid = 1000;
+    fattr->size = FILE_DATA_SIZE;
+    fattr->blocksize = 4096;
+    fattr->blocks = 16;
+    fattr->fsid = 2049;
+    fattr->fileid = 123456;
+    fattr->atime = fattr->mtime = fattr->ctime = time_val;
+}
+
+/*
+ * Places a successful reply carrying the given procedure results in the given RpcMsg.
+ */
+static void build_reply(Rpc__RpcMsg *rpc_msg, Rpc__ReplyBody *reply_body, Rpc__AcceptedReply *accepted_reply,
+                        Rpc__OpaqueAuth *verifier, Google__Protobuf__Empty *empty, Google__Protobuf__Any *results) {
+    verifier->flavor = RPC__AUTH_FLAVOR__AUTH_NONE;
+    verifier->body_case = RPC__OPAQUE_AUTH__BODY_EMPTY;
+    verifier->empty = empty;
+
+    accepted_reply->verifier = verifier;
+    accepted_reply->stat = RPC__ACCEPT_STAT__SUCCESS;
+    accepted_reply->reply_data_case = RPC__ACCEPTED_REPLY__REPLY_DATA_RESULTS;
+    accepted_reply->results = results;
+
+    reply_body->stat = RPC__REPLY_STAT__MSG_ACCEPTED;
+    reply_body->reply_case = RPC__REPLY_BODY__REPLY_AREPLY;
+    reply_body->areply = accepted_reply;
+
+    rpc_msg->xid = 1;
+    rpc_msg->mtype = RPC__MSG_TYPE__REPLY;
+    rpc_msg->body_case = RPC__RPC_MSG__BODY_RBODY;
+    rpc_msg->rbody = reply_body;
+}
+
+/*
+ * Returns 0 on success and > 0 on failure.
+ */
+static int benchmark_reply_encoding(const char *name, RpcCodec codec, const ProtobufCMessage *procedure_results,
+                                    char *results_type_url) {
+    Rpc__RpcMsg rpc_msg = RPC__RPC_MSG__INIT;
+    Rpc__ReplyBody reply_body = RPC__REPLY_BODY__INIT;
+    Rpc__AcceptedReply accepted_reply = RPC__ACCEPTED_REPLY__INIT;
+    Rpc__OpaqueAuth verifier = RPC__OPAQUE_AUTH__INIT;
+    Google__Protobuf__Empty empty = GOOGLE__PROTOBUF__EMPTY__INIT;
+    Google__Protobuf__Any results = GOOGLE__PROTOBUF__ANY__INIT;
+    results.type_url = results_type_url;
+    build_reply(&rpc_msg, &reply_body, &accepted_reply, &verifier, &empty, &results);
+
+    size_t wire_size = 0;
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    for (size_t i = 0; i < NUM_MESSAGES; i++) {
+        size_t results_size = get_rpc_payload_packed_size(codec, procedure_results);
+        uint8_t *results_buffer = allocate_rpc_payload_buffer(results_size);
+        if (results_buffer == NULL) {
+            return 1;
+        }
+        pack_rpc_payload(codec, procedure_results, results_buffer);
+        results.value.data = results_buffer;
+        results.value.len = results_size;
+
+        EncodedRpcMsg encoded_rpc_msg;
+        if (encode_rpc_msg(codec, &rpc_msg, &encoded_rpc_msg) > 0) {
+            free_rpc_payload_buffer(results_buffer);
+            return 2;
+        }
+        wire_size = encoded_rpc_msg.size;
+
+        free_encoded_rpc_msg(&encoded_rpc_msg);
+        free_rpc_payload_buffer(results_buffer);
+    }
+
+    print_result(name, codec, wire_size, seconds_since(&start));
+
+    return 0;
+}
+
+/*
+ * Encodes a WRITE call carrying the given amount of file data, with an AUTH_SYS credential, with the given codec,
+ * into a new buffer, and places its size in 'rpc_msg_size'.
+ *
+ * Returns NULL on failure.
+ */
+static uint8_t *encode_write_call(RpcCodec codec, uint8_t *file_data, size_t file_data_size, size_t *rpc_msg_size) {
+    NfsFh__NfsFileHandle nfs_filehandle = NFS_FH__NFS_FILE_HANDLE__INIT;
+    nfs_filehandle.inode_number = 123456;
+    nfs_filehandle.timestamp = 1700000000;
+    Nfs__FHandle fhandle = NFS__FHANDLE__INIT;
+    fhandle.nfs_filehandle = &nfs_filehandle;
+
+    Nfs__WriteArgs writeargs = NFS__WRITE_ARGS__INIT;
+    writeargs.file = &fhandle;
+    writeargs.offset = 0;
+    writeargs.nfsdata.data = file_data;
+    writeargs.nfsdata.len = file_data_size;
+
+    size_t writeargs_size = get_rpc_payload_packed_size(codec, &writeargs.base);
+    uint8_t *writeargs_buffer = allocate_rpc_payload_buffer(writeargs_size);
+    if (writeargs_buffer == NULL) {
+        return NULL;
+    }
+    pack_rpc_payload(codec, &writeargs.base, writeargs_buffer);
+
+    Google__Protobuf__Any parameters = GOOGLE__PROTOBUF__ANY__INIT;
+    parameters.type_url = "nfs/WriteArgs";
+    parameters.value.data = writeargs_buffer;
+    parameters.value.len = writeargs_size;
+
+    uint32_t gids[] = {1000, 27, 100};
+    Rpc__AuthSysParams auth_sys = RPC__AUTH_SYS_PARAMS__INIT;
+    auth_sys.timestamp = 1700000000;
+    auth_sys.machinename = "benchmark-client";
+    auth_sys.uid = auth_sys.gid = 1000;
+    auth_sys.n_gids = sizeof(gids) / sizeof(gids[0]);
+    auth_sys.gids = gids;
+
+    Rpc__OpaqueAuth credential = RPC__OPAQUE_AUTH__INIT;
+    credential.flavor = RPC__AUTH_FLAVOR__AUTH_SYS;
+    credential.body_case = RPC__OPAQUE_AUTH__BODY_AUTH_SYS;
+    credential.auth_sys = &auth_sys;
+
+    Google__Protobuf__Empty empty = GOOGLE__PROTOBUF__EMPTY__INIT;
+    Rpc__OpaqueAuth verifier = RPC__OPAQUE_AUTH__INIT;
+    verifier.flavor = RPC__AUTH_FLAVOR__AUTH_NONE;
+    verifier.body_case = RPC__OPAQUE_AUTH__BODY_EMPTY;
+    verifier.empty = &empty;
+
+    Rpc__CallBody call_body = RPC__CALL_BODY__INIT;
+    call_body.rpcvers = 2;
+    call_body.prog = 100003;
+    call_body.vers = 2;
+    call_body.proc = 8;
+    call_body.credential = &credential;
+    call_body.verifier = &verifier;
+    call_body.params = &parameters;
+
+    Rpc__RpcMsg rpc_msg = RPC__RPC_MSG__INIT;
+    rpc_msg.xid = 1;
+    rpc_msg.mtype = RPC__MSG_TYPE__CALL;
+    rpc_msg.body_case = RPC__RPC_MSG__BODY_CBODY;
+    rpc_msg.cbody = &call_body;
+
+    uint8_t *rpc_msg_buffer = NULL;
+    EncodedRpcMsg encoded_rpc_msg;
+    if (encode_rpc_msg(codec, &rpc_msg, &encoded_rpc_msg) == 0) {
+        *rpc_msg_size = encoded_rpc_msg.size;
+        rpc_msg_buffer = malloc(encoded_rpc_msg.size);
+        if (rpc_msg_buffer != NULL) {
+            memcpy(rpc_msg_buffer, encoded_rpc_msg.data, encoded_rpc_msg.size);
+        }
+        free_encoded_rpc_msg(&encoded_rpc_msg);
+    }
+    free_rpc_payload_buffer(writeargs_buffer);
+
+    return rpc_msg_buffer;
+}
+
+/*
+ * Returns 0 on success and > 0 on failure.
+ */
+static int benchmark_write_call_decoding(RpcCodec codec, uint8_t *file_data) {
+    size_t rpc_msg_size = 0;
+    uint8_t *rpc_msg_buffer = encode_write_call(codec, file_data, FILE_DATA_SIZE, &rpc_msg_size);
+    if (rpc_msg_buffer == NULL) {
+        return 1;
+    }
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    for (size_t i = 0; i < NUM_MESSAGES; i++) {
+        if (detect_rpc_codec(rpc_msg_buffer, rpc_msg_size) != codec) {
+            free(rpc_msg_buffer);
+            return 2;
+        }
+
+        Rpc__RpcMsg *rpc_msg = decode_rpc_msg_in_place(codec, rpc_msg_buffer, rpc_msg_size);
+        if (rpc_msg == NULL || rpc_msg->cbody == NULL || rpc_msg->cbody->params == NULL) {
+            free(rpc_msg_buffer);
+            return 3;
+        }
+
+        Google__Protobuf__Any *parameters = rpc_msg->cbody->params;
+        Nfs__WriteArgs *writeargs = unpack_rpc_payload(codec, &nfs__write_args__descriptor, NULL,
+                                                       parameters->value.len, parameters->value.data);
+        if (writeargs == NULL || writeargs->nfsdata.len != FILE_DATA_SIZE) {
+            free_rpc_msg_decoded_in_place(rpc_msg, rpc_msg_buffer, rpc_msg_size);
+            free(rpc_msg_buffer);
+            return 4;
+        }
+
+        nfs__write_args__free_unpacked(writeargs, NULL);
+        free_rpc_msg_decoded_in_place(rpc_msg, rpc_msg_buffer, rpc_msg_size);
+    }
+
+    print_result("WRITE call", codec, rpc_msg_size, seconds_since(&start));
+
+    free(rpc_msg_buffer);
+
+    return 0;
+}
+
+int main(void) {
+    uint8_t *file_data = malloc(FILE_DATA_SIZE);
+    if (file_data == NULL) {
+        fprintf(stderr, "Error: failed to allocate memory\n");
+        return 1;
+    }
+    memset(file_data, 'a', FILE_DATA_SIZE);
+
+    Nfs__NfsStat nfs_status = NFS__NFS_STAT__INIT;
+    nfs_status.stat = NFS__STAT__NFS_OK;
+    Nfs__NfsFType nfs_ftype = NFS__NFS_FTYPE__INIT;
+    Nfs__TimeVal time_val = NFS__TIME_VAL__INIT;
+    Nfs__FAttr fattr = NFS__FATTR__INIT;
+    build_fattr(&fattr, &nfs_ftype, &time_val);
+
+    Nfs__AttrStat attrstat = NFS__ATTR_STAT__INIT;
+    attrstat.nfs_status = &nfs_status;
+    attrstat.body_case = NFS__ATTR_STAT__BODY_ATTRIBUTES;
+    attrstat.attributes = &fattr;
+
+    Nfs__ReadResBody readresbody = NFS__READ_RES_BODY__INIT;
+    readresbody.attributes = &fattr;
+    readresbody.nfsdata.data = file_data;
+    readresbody.nfsdata.len = FILE_DATA_SIZE;
+    Nfs__ReadRes readres = NFS__READ_RES__INIT;
+    readres.nfs_status = &nfs_status;
+    readres.body_case = NFS__READ_RES__BODY_READRESBODY;
+    readres.readresbody = &readresbody;
+
+    int num_codecs = sizeof(codecs) / sizeof(codecs[0]);
+    for (int i = 0; i < num_codecs; i++) {
+        int error_code = benchmark_reply_encoding("GETATTR reply", codecs[i], &attrstat.base, "nfs/AttrStat");
+        if (error_code == 0) {
+            error_code = benchmark_reply_encoding("READ reply", codecs[i], &readres.base, "nfs/ReadRes");
+        }
+        if (error_code == 0) {
+            error_code = benchmark_write_call_decoding(codecs[i], file_data);
+        }
+        if (error_code > 0) {
+            fprintf(stderr, "Error: %s benchmark failed with error code %d\n", get_codec_name(codecs[i]), error_code);
+            free(file_data);
+            return 1;
+        }
+    }
+
+    free(file_data);
+
+    return 0;
+}
@@ -0,0 +1,318 @@
+/*
+ * Microbenchmark of RPC message encoding, in bytes copied and ns per message, for READ replies and WRITE calls
+ * carrying 512 B, 4 KB and 8 KB of file data.
+ *
+ * 1) READ reply encoding: once the way the servers used to do it (ReadRes packed into a buffer of its own, then
+ *    the RpcMsg around it packed into a second buffer), and once with the single-pass encoding (ReadRes packed into
+ *    a payload buffer with headroom, and only the envelope of the RpcMsg serialized into the headroom).
+ * 2) WRITE call decoding: once with 'rpc__rpc_msg__unpack', which copies the WriteArgs out of the received record,
+ *    and once with 'decode_rpc_msg_in_place', which only copies out the envelope around them.
+ *
+ * Bytes copied count every byte written by packing (for encoding), or copied out of the received record (for
+ * decoding), leaving out the copy of the file data into the ReadRes that both ways of encoding share.
+ *
+ * Build with 'make benchmark' and run './build/rpc_encoding_benchmark'.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "src/serialization/nfs/nfs.pb-c.h"
+#include "src/serialization/rpc/rpc.pb-c.h"
+
+#include "src/common_rpc/rpc_msg_encoding.h"
+
+#define NUM_MESSAGES 200000
+
+static const size_t file_data_sizes[] = {512, 4 * 1024, 8 * 1024};
+
+static double seconds_since(struct timespec *start) {
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    return (end.tv_sec - start->tv_sec) + (end.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static void print_result(const char *name, size_t file_data_size, size_t bytes_copied, double elapsed_seconds) {
+    fprintf(stdout, "%-28s %6zu B data %8zu B copied/msg %10.1f ns/msg\n", name, file_data_size, bytes_copied,
+            elapsed_seconds * 1e9 / NUM_MESSAGES);
+}
+
+/*
+ * Places a successful reply carrying the given procedure results in the given RpcMsg.
+ */
+static void build_reply(Rpc__RpcMsg *rpc_msg, Rpc__ReplyBody *reply_body, Rpc__AcceptedReply *accepted_reply,
+                        Rpc__OpaqueAuth *verifier, Google__Protobuf__Empty *empty, Google__Protobuf__Any *results) {
+    verifier->flavor = RPC__AUTH_FLAVOR__AUTH_NONE;
+    verifier->body_case = RPC__OPAQUE_AUTH__BODY_EMPTY;
+    verifier->empty = empty;
+
+    accepted_reply->verifier = verifier;
+    accepted_reply->stat = RPC__ACCEPT_STAT__SUCCESS;
+    accepted_reply->reply_data_case = RPC__ACCEPTED_REPLY__REPLY_DATA_RESULTS;
+    accepted_reply->results = results;
+
+    reply_body->stat = RPC__REPLY_STAT__MSG_ACCEPTED;
+    reply_body->reply_case = RPC__REPLY_BODY__REPLY_AREPLY;
+    reply_body->areply = accepted_reply;
+
+    rpc_msg->xid = 1;
+    rpc_msg->mtype = RPC__MSG_TYPE__REPLY;
+    rpc_msg->body_case = RPC__RPC_MSG__BODY_RBODY;
+    rpc_msg->rbody = reply_body;
+}
+
+/*
+ * Returns 0 on success and > 0 on failure.
+ */
+static int benchmark_read_reply_encoding(Nfs__ReadRes *readres, size_t file_data_size, bool single_pass) {
+    Rpc__RpcMsg rpc_msg = RPC__RPC_MSG__INIT;
+    Rpc__ReplyBody reply_body = RPC__REPLY_BODY__INIT;
+    Rpc__AcceptedReply accepted_reply = RPC__ACCEPTED_REPLY__INIT;
+    Rpc__OpaqueAuth verifier = RPC__OPAQUE_AUTH__INIT;
+    Google__Protobuf__Empty empty = GOOGLE__PROTOBUF__EMPTY__INIT;
+    Google__Protobuf__Any results = GOOGLE__PROTOBUF__ANY__INIT;
+    results.type_url = "nfs/ReadRes";
+    build_reply(&rpc_msg, &reply_body, &accepted_reply, &verifier, &empty, &results);
+
+    size_t bytes_copied = 0;
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    for (size_t i = 0; i < NUM_MESSAGES; i++) {
+        size_t readres_size = nfs__read_res__get_packed_size(readres);
+
+        if (single_pass) {
+            uint8_t *readres_buffer = allocate_rpc_payload_buffer(readres_size);
+            if (readres_buffer == NULL) {
+                return 1;
+            }
+            nfs__read_res__pack(readres, readres_buffer);
+            results.value.data = readres_buffer;
+            results.value.len = readres_size;
+
+            EncodedRpcMsg encoded_rpc_msg;
+            if (encode_rpc_msg(RPC_CODEC_PROTOBUF, &rpc_msg, &encoded_rpc_msg) > 0) {
+                free_rpc_payload_buffer(readres_buffer);
+                return 2;
+            }
+            bytes_copied = readres_size + (encoded_rpc_msg.allocated_buffer == NULL
+                                               ? encoded_rpc_msg.size - readres_size
+                                               : encoded_rpc_msg.size);
+
+            free_encoded_rpc_msg(&encoded_rpc_msg);
+            free_rpc_payload_buffer(readres_buffer);
+        } else {
+            uint8_t *readres_buffer = malloc(readres_size);
+            if (readres_buffer == NULL) {
+                return 1;
+            }
+            nfs__read_res__pack(readres, readres_buffer);
+            results.value.data = readres_buffer;
+            results.value.len = readres_size;
+
+            size_t rpc_msg_size = rpc__rpc_msg__get_packed_size(&rpc_msg);
+            uint8_t *rpc_msg_buffer = malloc(rpc_msg_size);
+            if (rpc_msg_buffer == NULL) {
+                free(readres_buffer);
+                return 2;
+            }
+            rpc__rpc_msg__pack(&rpc_msg, rpc_msg_buffer);
+            bytes_copied = readres_size + rpc_msg_size;
+
+            free(rpc_msg_buffer);
+            free(readres_buffer);
+        }
+    }
+
+    print_result(single_pass ? "READ reply (single-pass)" : "READ reply (legacy)", file_data_size,
+                 bytes_copied - file_data_size, seconds_since(&start));
+
+    return 0;
+}
+
+/*
+ * Returns 0 on success and > 0 on failure.
+ */
+static int benchmark_write_call_decoding(const uint8_t *rpc_msg_buffer, size_t rpc_msg_size, size_t file_data_size,
+                                         bool in_place) {
+    size_t bytes_copied = 0;
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    for (size_t i = 0; i < NUM_MESSAGES; i++) {
+        Rpc__RpcMsg *rpc_msg =
+            in_place ? decode_rpc_msg_in_place(RPC_CODEC_PROTOBUF, (uint8_t *)rpc_msg_buffer, rpc_msg_size)
+                     : rpc__rpc_msg__unpack(NULL, rpc_msg_size, rpc_msg_buffer);
+        if (rpc_msg == NULL || rpc_msg->cbody == NULL || rpc_msg->cbody->params == NULL) {
+            return 1;
+        }
+
+        Google__Protobuf__Any *parameters = rpc_msg->cbody->params;
+        bool payload_in_place =
+            parameters->value.data >= rpc_msg_buffer && parameters->value.data < rpc_msg_buffer + rpc_msg_size;
+        // the parameters and the envelope around them, or just the envelope
+        bytes_copied = payload_in_place ? rpc_msg_size - parameters->value.len : rpc_msg_size;
+
+        if (in_place) {
+            free_rpc_msg_decoded_in_place(rpc_msg, rpc_msg_buffer, rpc_msg_size);
+        } else {
+            rpc__rpc_msg__free_unpacked(rpc_msg, NULL);
+        }
+    }
+
+    print_result(in_place ? "WRITE call (in-place)" : "WRITE call (legacy)", file_data_size, bytes_copied,
+                 seconds_since(&start));
+
+    return 0;
+}
+
+/*
+ * Packs a WRITE call carrying the given amount of file data, with an AUTH_SYS credential, into a new buffer, and
+ * places its size in 'rpc_msg_size'.
+ *
+ * Returns NULL on failure.
+ */
+static uint8_t *pack_write_call(uint8_t *file_data, size_t file_data_size, size_t *rpc_msg_size) {
+    NfsFh__NfsFileHandle nfs_filehandle = NFS_FH__NFS_FILE_HANDLE__INIT;
+    nfs_filehandle.inode_number = 123456;
+    nfs_filehandle.timestamp = 1700000000;
+    Nfs__FHandle fhandle = NFS__FHANDLE__INIT;
+    fhandle.nfs_filehandle = &nfs_filehandle;
+
+    Nfs__WriteArgs writeargs = NFS__WRITE_ARGS__INIT;
+    writeargs.file = &fhandle;
+    writeargs.offset = 0;
+    writeargs.nfsdata.data = file_data;
+    writeargs.nfsdata.len = file_data_size;
+
+    size_t writeargs_size = nfs__write_args__get_packed_size(&writeargs);
+    uint8_t *writeargs_buffer = malloc(writeargs_size);
+    if (writeargs_buffer == NULL) {
+        return NULL;
+    }
+    nfs__write_args__pack(&writeargs, writeargs_buffer);
+
+    Google__Protobuf__Any parameters = GOOGLE__PROTOBUF__ANY__INIT;
+    parameters.type_url = "nfs/WriteArgs";
+    parameters.value.data = writeargs_buffer;
+    parameters.value.len = writeargs_size;
+
+    uint32_t gids[] = {1000, 27, 100};
+    Rpc__AuthSysParams auth_sys = RPC__AUTH_SYS_PARAMS__INIT;
+    auth_sys.timestamp = 1700000000;
+    auth_sys.machinename = "benchmark-client";
+    auth_sys.uid = auth_sys.gid = 1000;
+    auth_sys.n_gids = sizeof(gids) / sizeof(gids[0]);
+    auth_sys.gids = gids;
+
+    Rpc__OpaqueAuth credential = RPC__OPAQUE_AUTH__INIT;
+    credential.flavor = RPC__AUTH_FLAVOR__AUTH_SYS;
+    credential.body_case = RPC__OPAQUE_AUTH__BODY_AUTH_SYS;
+    credential.auth_sys = &auth_sys;
+
+    Google__Protobuf__Empty empty = GOOGLE__PROTOBUF__EMPTY__INIT;
+    Rpc__OpaqueAuth verifier = RPC__OPAQUE_AUTH__INIT;
+    verifier.flavor = RPC__AUTH_FLAVOR__AUTH_NONE;
+    verifier.body_case = RPC__OPAQUE_AUTH__BODY_EMPTY;
+    verifier.empty = &empty;
+
+    Rpc__CallBody call_body = RPC__CALL_BODY__INIT;
+    call_body.rpcvers = 2;
+    call_body.prog = 100003;
+    call_body.vers = 2;
+    call_body.proc = 8;
+    call_body.credential = &credential;
+    call_body.verifier = &verifier;
+    call_body.params = &parameters;
+
+    Rpc__RpcMsg rpc_msg = RPC__RPC_MSG__INIT;
+    rpc_msg.xid = 1;
+    rpc_msg.mtype = RPC__MSG_TYPE__CALL;
+    rpc_msg.body_case = RPC__RPC_MSG__BODY_CBODY;
+    rpc_msg.cbody = &call_body;
+
+    *rpc_msg_size = rpc__rpc_msg__get_packed_size(&rpc_msg);
+    uint8_t *rpc_msg_buffer = malloc(*rpc_msg_size);
+    if (rpc_msg_buffer != NULL) {
+        rpc__rpc_msg__pack(&rpc_msg, rpc_msg_buffer);
+    }
+    free(writeargs_buffer);
+
+    return rpc_msg_buffer;
+}
+
+int main(void) {
+    int num_file_data_sizes = sizeof(file_data_sizes) / sizeof(file_data_sizes[0]);
+
+    for (int i = 0; i < num_file_data_sizes; i++) {
+        size_t file_data_size = file_data_sizes[i];
+
+        uint8_t *file_data = malloc(file_data_size);
+        if (file_data == NULL) {
+            fprintf(stderr, "Error: failed to allocate memory\n");
+            return 1;
+        }
+        memset(file_data, 'a', file_data_size);
+
+        // the attributes a READ reply carries along with the data
+        Nfs__NfsFType nfs_ftype = NFS__NFS_FTYPE__INIT;
+        nfs_ftype.ftype = NFS__FTYPE__NFREG;
+        Nfs__TimeVal atime = NFS__TIME_VAL__INIT, mtime = NFS__TIME_VAL__INIT, ctime = NFS__TIME_VAL__INIT;
+        atime.seconds = mtime.seconds = ctime.seconds = 1700000000;
+        atime.useconds = mtime.useconds = ctime.useconds = 123456789;
+        Nfs__FAttr fattr = NFS__FATTR__INIT;
+        fattr.nfs_ftype = &nfs_ftype;
+        fattr.mode = 0100644;
+        fattr.nlink = 1;
+        fattr.uid = fattr.gid = 1000;
+        fattr.size = 1 << 20;
+        fattr.blocksize = 4096;
+        fattr.blocks = 2048;
+        fattr.fsid = 2049;
+        fattr.fileid = 123456;
+        fattr.atime = &atime;
+        fattr.mtime = &mtime;
+        fattr.ctime = &ctime;
+
+        Nfs__NfsStat nfs_status = NFS__NFS_STAT__INIT;
+        nfs_status.stat = NFS__STAT__NFS_OK;
+        Nfs__ReadResBody readresbody = NFS__READ_RES_BODY__INIT;
+        readresbody.attributes = &fattr;
+        readresbody.nfsdata.data = file_data;
+        readresbody.nfsdata.len = file_data_size;
+        Nfs__ReadRes readres = NFS__READ_RES__INIT;
+        readres.nfs_status = &nfs_status;
+        readres.body_case = NFS__READ_RES__BODY_READRESBODY;
+        readres.readresbody = &readresbody;
+
+        int error_code = benchmark_read_reply_encoding(&readres, file_data_size, false);
+        error_code = error_code > 0 ? error_code : benchmark_read_reply_encoding(&readres, file_data_size, true);
+
+        size_t rpc_msg_size;
+        uint8_t *rpc_msg_buffer = pack_write_call(file_data, file_data_size, &rpc_msg_size);
+        if (rpc_msg_buffer == NULL) {
+            error_code = error_code > 0 ? error_code : 3;
+        } else {
+            error_code = error_code > 0 ? error_code
+                                        : benchmark_write_call_decoding(rpc_msg_buffer, rpc_msg_size,
+                                                                        file_data_size, false);
+            error_code = error_code > 0 ? error_code
+                                        : benchmark_write_call_decoding(rpc_msg_buffer, rpc_msg_size,
+                                                                        file_data_size, true);
+        }
+
+        free(rpc_msg_buffer);
+        free(file_data);
+        if (error_code > 0) {
+            fprintf(stderr, "Error: benchmark failed with status %d\n", error_code);
+            return 1;
+        }
+    }
+
+    return 0;
+}
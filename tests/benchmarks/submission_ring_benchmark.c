@@ -0,0 +1,325 @@
+/*
+ * Microbenchmark of the hand-off of RPCs between RPC caller threads and the QUIC client's event loop thread,
+ * with null RPCs that the event loop answers as soon as it has allocated a stream for them (no network), so
+ * only the cost of the hand-off itself is measured. Reports ops/sec and per-RPC latency at 1, 16 and 256
+ * concurrent caller threads.
+ *
+ * 1) Locked: the way the QUIC client used to do it - a mutex-protected allocation queue, a condition variable
+ *    wait for stream allocation, a second wake-up of the event loop to process the connection, a condition
+ *    variable wait for the reply, and a mutex-protected list of stream contexts.
+ * 2) Ring: 'submit_stream_context' / 'retire_stream_context' - a lock-free submission ring drained by the event
+ *    loop in batches with streams allocated inline, and a single futex wait per RPC.
+ *
+ * Build with 'make benchmark' and run './build/submission_ring_benchmark'.
+ */
+
+#include <ev.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "src/transport/quic/submission_ring.h"
+
+#define TOTAL_NUM_RPCS 200000
+#define MAX_NUM_CALLERS 256
+
+typedef struct NullRpc {
+    // used by the locked hand-off
+    bool stream_allocated;
+    bool finished;
+    pthread_mutex_t lock;
+    pthread_cond_t stream_allocated_cond;
+    pthread_cond_t finished_cond;
+    struct NullRpc *next;
+
+    // used by the ring hand-off
+    RpcCompletion completion;
+} NullRpc;
+
+typedef struct BenchmarkEventLoop {
+    struct ev_loop *event_loop;
+    pthread_t event_loop_thread;
+
+    ev_async submission_async_watcher;
+    ev_async process_connections_async_watcher;
+    ev_async shutdown_async_watcher;
+
+    // locked hand-off
+    NullRpc *allocation_queue;
+    pthread_mutex_t allocation_queue_lock;
+    NullRpc *in_flight_rpcs;
+    pthread_mutex_t in_flight_rpcs_lock;
+
+    // ring hand-off
+    SubmissionRing submission_ring;
+    SubmissionRing retirement_ring;
+} BenchmarkEventLoop;
+
+typedef struct CallerArgs {
+    BenchmarkEventLoop *benchmark_event_loop;
+    bool use_ring;
+    size_t num_rpcs;
+    double *latencies;
+} CallerArgs;
+
+static double clock_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void init_null_rpc(NullRpc *null_rpc) {
+    null_rpc->stream_allocated = null_rpc->finished = false;
+    pthread_mutex_init(&null_rpc->lock, NULL);
+    pthread_cond_init(&null_rpc->stream_allocated_cond, NULL);
+    pthread_cond_init(&null_rpc->finished_cond, NULL);
+    null_rpc->next = NULL;
+
+    init_rpc_completion(&null_rpc->completion);
+}
+
+static void destroy_null_rpc(NullRpc *null_rpc) {
+    pthread_mutex_destroy(&null_rpc->lock);
+    pthread_cond_destroy(&null_rpc->stream_allocated_cond);
+    pthread_cond_destroy(&null_rpc->finished_cond);
+}
+
+/*
+ * Locked hand-off: allocates streams for all queued RPCs, and wakes up their callers.
+ */
+static void locked_stream_allocator_callback(EV_P_ ev_async *w, int revents) {
+    BenchmarkEventLoop *benchmark_event_loop = w->data;
+
+    pthread_mutex_lock(&benchmark_event_loop->allocation_queue_lock);
+    NullRpc *null_rpc = benchmark_event_loop->allocation_queue;
+    benchmark_event_loop->allocation_queue = NULL;
+    pthread_mutex_unlock(&benchmark_event_loop->allocation_queue_lock);
+
+    while (null_rpc != NULL) {
+        NullRpc *next = null_rpc->next;
+
+        pthread_mutex_lock(&null_rpc->lock);
+        null_rpc->stream_allocated = true;
+        pthread_mutex_unlock(&null_rpc->lock);
+        pthread_cond_signal(&null_rpc->stream_allocated_cond);
+
+        null_rpc = next;
+    }
+}
+
+/*
+ * Locked hand-off: answers all in-flight RPCs, like a reply arriving for each of them.
+ */
+static void locked_process_connections_callback(EV_P_ ev_async *w, int revents) {
+    BenchmarkEventLoop *benchmark_event_loop = w->data;
+
+    pthread_mutex_lock(&benchmark_event_loop->in_flight_rpcs_lock);
+    for (NullRpc *null_rpc = benchmark_event_loop->in_flight_rpcs; null_rpc != NULL; null_rpc = null_rpc->next) {
+        pthread_mutex_lock(&null_rpc->lock);
+        if (!null_rpc->finished) {
+            null_rpc->finished = true;
+            pthread_cond_signal(&null_rpc->finished_cond);
+        }
+        pthread_mutex_unlock(&null_rpc->lock);
+    }
+    pthread_mutex_unlock(&benchmark_event_loop->in_flight_rpcs_lock);
+}
+
+static void execute_null_rpc_locked(BenchmarkEventLoop *benchmark_event_loop, NullRpc *null_rpc) {
+    pthread_mutex_lock(&benchmark_event_loop->allocation_queue_lock);
+    null_rpc->next = benchmark_event_loop->allocation_queue;
+    benchmark_event_loop->allocation_queue = null_rpc;
+    pthread_mutex_unlock(&benchmark_event_loop->allocation_queue_lock);
+    ev_async_send(benchmark_event_loop->event_loop, &benchmark_event_loop->submission_async_watcher);
+
+    pthread_mutex_lock(&null_rpc->lock);
+    while (!null_rpc->stream_allocated) {
+        pthread_cond_wait(&null_rpc->stream_allocated_cond, &null_rpc->lock);
+    }
+    pthread_mutex_unlock(&null_rpc->lock);
+
+    pthread_mutex_lock(&benchmark_event_loop->in_flight_rpcs_lock);
+    null_rpc->next = benchmark_event_loop->in_flight_rpcs;
+    benchmark_event_loop->in_flight_rpcs = null_rpc;
+    pthread_mutex_unlock(&benchmark_event_loop->in_flight_rpcs_lock);
+    ev_async_send(benchmark_event_loop->event_loop, &benchmark_event_loop->process_connections_async_watcher);
+
+    pthread_mutex_lock(&null_rpc->lock);
+    while (!null_rpc->finished) {
+        pthread_cond_wait(&null_rpc->finished_cond, &null_rpc->lock);
+    }
+    pthread_mutex_unlock(&null_rpc->lock);
+
+    pthread_mutex_lock(&benchmark_event_loop->in_flight_rpcs_lock);
+    NullRpc **curr = &benchmark_event_loop->in_flight_rpcs;
+    while (*curr != null_rpc) {
+        curr = &(*curr)->next;
+    }
+    *curr = null_rpc->next;
+    pthread_mutex_unlock(&benchmark_event_loop->in_flight_rpcs_lock);
+    // release the stream
+    ev_async_send(benchmark_event_loop->event_loop, &benchmark_event_loop->submission_async_watcher);
+}
+
+/*
+ * Ring hand-off: takes retired RPCs and submitted RPCs out of the rings in batches, and answers the
+ * submitted ones.
+ */
+static void ring_submission_callback(EV_P_ ev_async *w, int revents) {
+    BenchmarkEventLoop *benchmark_event_loop = w->data;
+
+    void *null_rpcs[SUBMISSION_RING_DRAIN_BATCH_SIZE];
+    while (pop_batch_from_submission_ring(&benchmark_event_loop->retirement_ring, null_rpcs,
+                                          SUBMISSION_RING_DRAIN_BATCH_SIZE) > 0) {
+    }
+
+    size_t num_null_rpcs;
+    while ((num_null_rpcs = pop_batch_from_submission_ring(&benchmark_event_loop->submission_ring, null_rpcs,
+                                                           SUBMISSION_RING_DRAIN_BATCH_SIZE)) > 0) {
+        for (size_t i = 0; i < num_null_rpcs; i++) {
+            NullRpc *null_rpc = null_rpcs[i];
+            complete_rpc(&null_rpc->completion);
+        }
+    }
+}
+
+static void execute_null_rpc_ring(BenchmarkEventLoop *benchmark_event_loop, NullRpc *null_rpc) {
+    init_rpc_completion(&null_rpc->completion);
+
+    push_to_submission_ring(&benchmark_event_loop->submission_ring, null_rpc);
+    ev_async_send(benchmark_event_loop->event_loop, &benchmark_event_loop->submission_async_watcher);
+
+    wait_for_rpc_completion(&null_rpc->completion);
+
+    push_to_submission_ring(&benchmark_event_loop->retirement_ring, null_rpc);
+    ev_async_send(benchmark_event_loop->event_loop, &benchmark_event_loop->submission_async_watcher);
+}
+
+static void shutdown_callback(EV_P_ ev_async *w, int revents) {
+    ev_break(EV_A_ EVBREAK_ALL);
+}
+
+static void *event_loop_runner(void *arg) {
+    BenchmarkEventLoop *benchmark_event_loop = arg;
+
+    ev_run(benchmark_event_loop->event_loop, 0);
+
+    return NULL;
+}
+
+static void *caller_runner(void *arg) {
+    CallerArgs *caller_args = arg;
+
+    NullRpc null_rpc;
+    init_null_rpc(&null_rpc);
+
+    for (size_t i = 0; i < caller_args->num_rpcs; i++) {
+        null_rpc.stream_allocated = null_rpc.finished = false;
+
+        double start = clock_seconds();
+        if (caller_args->use_ring) {
+            execute_null_rpc_ring(caller_args->benchmark_event_loop, &null_rpc);
+        } else {
+            execute_null_rpc_locked(caller_args->benchmark_event_loop, &null_rpc);
+        }
+        caller_args->latencies[i] = clock_seconds() - start;
+    }
+
+    destroy_null_rpc(&null_rpc);
+
+    return NULL;
+}
+
+static int compare_doubles(const void *a, const void *b) {
+    double difference = *(const double *)a - *(const double *)b;
+
+    return (difference > 0) - (difference < 0);
+}
+
+/*
+ * Returns 0 on success and > 0 on failure.
+ */
+static int run_benchmark(bool use_ring, int num_callers) {
+    BenchmarkEventLoop benchmark_event_loop;
+    memset(&benchmark_event_loop, 0, sizeof(BenchmarkEventLoop));
+    pthread_mutex_init(&benchmark_event_loop.allocation_queue_lock, NULL);
+    pthread_mutex_init(&benchmark_event_loop.in_flight_rpcs_lock, NULL);
+    if (init_submission_ring(&benchmark_event_loop.submission_ring, SUBMISSION_RING_CAPACITY) > 0 ||
+        init_submission_ring(&benchmark_event_loop.retirement_ring, SUBMISSION_RING_CAPACITY) > 0) {
+        return 1;
+    }
+
+    benchmark_event_loop.event_loop = ev_loop_new(EVFLAG_AUTO);
+    ev_async_init(&benchmark_event_loop.submission_async_watcher,
+                  use_ring ? ring_submission_callback : locked_stream_allocator_callback);
+    ev_async_init(&benchmark_event_loop.process_connections_async_watcher, locked_process_connections_callback);
+    ev_async_init(&benchmark_event_loop.shutdown_async_watcher, shutdown_callback);
+    benchmark_event_loop.submission_async_watcher.data = &benchmark_event_loop;
+    benchmark_event_loop.process_connections_async_watcher.data = &benchmark_event_loop;
+    ev_async_start(benchmark_event_loop.event_loop, &benchmark_event_loop.submission_async_watcher);
+    ev_async_start(benchmark_event_loop.event_loop, &benchmark_event_loop.process_connections_async_watcher);
+    ev_async_start(benchmark_event_loop.event_loop, &benchmark_event_loop.shutdown_async_watcher);
+
+    if (pthread_create(&benchmark_event_loop.event_loop_thread, NULL, event_loop_runner, &benchmark_event_loop) != 0) {
+        fprintf(stderr, "run_benchmark: failed to create the event loop thread\n");
+        return 2;
+    }
+
+    size_t rpcs_per_caller = TOTAL_NUM_RPCS / num_callers;
+    double *latencies = malloc(sizeof(double) * rpcs_per_caller * num_callers);
+    if (latencies == NULL) {
+        return 3;
+    }
+
+    CallerArgs caller_args[MAX_NUM_CALLERS];
+    pthread_t caller_threads[MAX_NUM_CALLERS];
+
+    double start = clock_seconds();
+    for (int i = 0; i < num_callers; i++) {
+        caller_args[i] =
+            (CallerArgs){&benchmark_event_loop, use_ring, rpcs_per_caller, latencies + i * rpcs_per_caller};
+        if (pthread_create(&caller_threads[i], NULL, caller_runner, &caller_args[i]) != 0) {
+            fprintf(stderr, "run_benchmark: failed to create a caller thread\n");
+            return 4;
+        }
+    }
+    for (int i = 0; i < num_callers; i++) {
+        pthread_join(caller_threads[i], NULL);
+    }
+    double elapsed_seconds = clock_seconds() - start;
+
+    ev_async_send(benchmark_event_loop.event_loop, &benchmark_event_loop.shutdown_async_watcher);
+    pthread_join(benchmark_event_loop.event_loop_thread, NULL);
+
+    size_t num_rpcs = rpcs_per_caller * num_callers;
+    qsort(latencies, num_rpcs, sizeof(double), compare_doubles);
+    fprintf(stdout, "%-7s %3d callers %10.0f ops/sec %8.1f us p50 %8.1f us p99\n", use_ring ? "ring" : "locked",
+            num_callers, num_rpcs / elapsed_seconds, latencies[num_rpcs / 2] * 1e6,
+            latencies[num_rpcs * 99 / 100] * 1e6);
+
+    free(latencies);
+    ev_loop_destroy(benchmark_event_loop.event_loop);
+    free_submission_ring(&benchmark_event_loop.submission_ring);
+    free_submission_ring(&benchmark_event_loop.retirement_ring);
+    pthread_mutex_destroy(&benchmark_event_loop.allocation_queue_lock);
+    pthread_mutex_destroy(&benchmark_event_loop.in_flight_rpcs_lock);
+
+    return 0;
+}
+
+int main(void) {
+    int num_callers[] = {1, 16, 256};
+
+    for (size_t i = 0; i < sizeof(num_callers) / sizeof(num_callers[0]); i++) {
+        if (run_benchmark(false, num_callers[i]) > 0 || run_benchmark(true, num_callers[i]) > 0) {
+            fprintf(stderr, "Error: benchmark failed\n");
+            return 1;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,259 @@
+/*
+ * Microbenchmark of the UDP I/O path of the QUIC endpoints, over loopback, with 1200 B datagrams (a typical
+ * QUIC packet size). Reports datagrams/sec delivered to the receiver and CPU time (sender and receiver
+ * together) per byte delivered.
+ *
+ * 1) Unbatched: one sendto per datagram and one recvfrom per datagram, the way the QUIC endpoints used to.
+ * 2) Batched: 'send_quic_packets_batched' (sendmmsg, with UDP GSO if available) and
+ *    'receive_udp_datagrams_batched' (recvmmsg, with UDP GRO if available).
+ *
+ * Build with 'make benchmark' and run './build/udp_batching_benchmark'.
+ */
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "src/transport/quic/udp_batching.h"
+
+#define DATAGRAM_SIZE 1200
+#define NUM_DATAGRAMS 500000
+#define SEND_BATCH_SIZE 32 // packets per on_packets_send call, as handed over by a QUIC endpoint
+#define RECEIVE_IDLE_TIMEOUT_MS 200
+
+typedef struct BenchmarkSockets {
+    int sender_fd;
+    int receiver_fd;
+    struct sockaddr_in receiver_addr;
+} BenchmarkSockets;
+
+typedef struct BenchmarkResult {
+    size_t datagrams_received;
+    size_t bytes_received;
+    uint64_t syscalls;
+    double elapsed_seconds;
+    double cpu_seconds;
+} BenchmarkResult;
+
+typedef struct SenderArgs {
+    BenchmarkSockets *sockets;
+    bool batched;
+    uint64_t syscalls;
+} SenderArgs;
+
+static double timespec_to_seconds(struct timespec *ts) {
+    return ts->tv_sec + ts->tv_nsec / 1e9;
+}
+
+static double clock_seconds(clockid_t clock) {
+    struct timespec ts;
+    clock_gettime(clock, &ts);
+
+    return timespec_to_seconds(&ts);
+}
+
+/*
+ * Returns 0 on success and > 0 on failure.
+ */
+static int create_benchmark_sockets(BenchmarkSockets *sockets) {
+    sockets->receiver_fd = socket(AF_INET, SOCK_DGRAM, 0);
+    sockets->sender_fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (sockets->receiver_fd < 0 || sockets->sender_fd < 0) {
+        perror("create_benchmark_sockets: failed to create sockets");
+        return 1;
+    }
+
+    int buffer_size = 8 * 1024 * 1024;
+    setsockopt(sockets->receiver_fd, SOL_SOCKET, SO_RCVBUF, &buffer_size, sizeof(buffer_size));
+    setsockopt(sockets->sender_fd, SOL_SOCKET, SO_SNDBUF, &buffer_size, sizeof(buffer_size));
+
+    memset(&sockets->receiver_addr, 0, sizeof(sockets->receiver_addr));
+    sockets->receiver_addr.sin_family = AF_INET;
+    sockets->receiver_addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    sockets->receiver_addr.sin_port = 0;
+    if (bind(sockets->receiver_fd, (struct sockaddr *)&sockets->receiver_addr, sizeof(sockets->receiver_addr)) < 0) {
+        perror("create_benchmark_sockets: failed to bind the receiver socket");
+        return 2;
+    }
+    socklen_t receiver_addr_len = sizeof(sockets->receiver_addr);
+    getsockname(sockets->receiver_fd, (struct sockaddr *)&sockets->receiver_addr, &receiver_addr_len);
+
+    // the QUIC endpoints use non-blocking sockets
+    fcntl(sockets->receiver_fd, F_SETFL, O_NONBLOCK);
+
+    return 0;
+}
+
+static void close_benchmark_sockets(BenchmarkSockets *sockets) {
+    close(sockets->sender_fd);
+    close(sockets->receiver_fd);
+}
+
+static void *send_datagrams(void *arg) {
+    SenderArgs *sender_args = arg;
+    BenchmarkSockets *sockets = sender_args->sockets;
+
+    uint8_t *datagrams = malloc(SEND_BATCH_SIZE * DATAGRAM_SIZE);
+    if (datagrams == NULL) {
+        fprintf(stderr, "send_datagrams: failed to allocate memory\n");
+        return NULL;
+    }
+    memset(datagrams, 'a', SEND_BATCH_SIZE * DATAGRAM_SIZE);
+
+    struct iovec iovs[SEND_BATCH_SIZE];
+    struct quic_packet_out_spec_t pkts[SEND_BATCH_SIZE];
+    for (int i = 0; i < SEND_BATCH_SIZE; i++) {
+        iovs[i].iov_base = datagrams + i * DATAGRAM_SIZE;
+        iovs[i].iov_len = DATAGRAM_SIZE;
+
+        pkts[i].iov = &iovs[i];
+        pkts[i].iovlen = 1;
+        pkts[i].dst_addr = &sockets->receiver_addr;
+        pkts[i].dst_addr_len = sizeof(sockets->receiver_addr);
+    }
+
+    UdpBatchingContext *udp_batching_context = malloc(sizeof(UdpBatchingContext));
+    if (udp_batching_context == NULL || init_udp_batching_context(udp_batching_context, sockets->sender_fd) > 0) {
+        fprintf(stderr, "send_datagrams: failed to set up batched I/O\n");
+        free(udp_batching_context);
+        free(datagrams);
+        return NULL;
+    }
+
+    for (size_t sent = 0; sent < NUM_DATAGRAMS; sent += SEND_BATCH_SIZE) {
+        if (sender_args->batched) {
+            send_quic_packets_batched(udp_batching_context, pkts, SEND_BATCH_SIZE);
+            continue;
+        }
+
+        for (int i = 0; i < SEND_BATCH_SIZE; i++) {
+            sendto(sockets->sender_fd, iovs[i].iov_base, iovs[i].iov_len, 0, pkts[i].dst_addr, pkts[i].dst_addr_len);
+            sender_args->syscalls++;
+        }
+    }
+    sender_args->syscalls += udp_batching_context->stats.send_syscalls;
+
+    free_udp_batching_context(udp_batching_context);
+    free(udp_batching_context);
+    free(datagrams);
+
+    return NULL;
+}
+
+static void count_datagram(uint8_t *datagram, size_t datagram_size, struct sockaddr *peer_addr,
+                           socklen_t peer_addr_len, void *handler_context) {
+    BenchmarkResult *result = handler_context;
+
+    result->datagrams_received++;
+    result->bytes_received += datagram_size;
+}
+
+/*
+ * Returns 0 on success and > 0 on failure.
+ */
+static int run_benchmark(bool batched, BenchmarkResult *result) {
+    BenchmarkSockets sockets;
+    if (create_benchmark_sockets(&sockets) > 0) {
+        return 1;
+    }
+
+    UdpBatchingContext *udp_batching_context = malloc(sizeof(UdpBatchingContext));
+    if (udp_batching_context == NULL || init_udp_batching_context(udp_batching_context, sockets.receiver_fd) > 0) {
+        fprintf(stderr, "run_benchmark: failed to set up batched I/O\n");
+        free(udp_batching_context);
+        close_benchmark_sockets(&sockets);
+        return 2;
+    }
+    uint8_t buffer[UDP_RECV_DATAGRAM_BUFFER_SIZE];
+
+    memset(result, 0, sizeof(BenchmarkResult));
+    SenderArgs sender_args = {&sockets, batched, 0};
+
+    double start = clock_seconds(CLOCK_MONOTONIC);
+    double cpu_start = clock_seconds(CLOCK_PROCESS_CPUTIME_ID);
+
+    pthread_t sender_thread;
+    if (pthread_create(&sender_thread, NULL, send_datagrams, &sender_args) != 0) {
+        fprintf(stderr, "run_benchmark: failed to create the sender thread\n");
+        free_udp_batching_context(udp_batching_context);
+        free(udp_batching_context);
+        close_benchmark_sockets(&sockets);
+        return 3;
+    }
+
+    // receive until all datagrams arrived, or the sender is done and nothing arrives for a while (loss)
+    double last_receive = start;
+    struct pollfd pollfd = {.fd = sockets.receiver_fd, .events = POLLIN};
+    while (result->datagrams_received < NUM_DATAGRAMS) {
+        if (poll(&pollfd, 1, RECEIVE_IDLE_TIMEOUT_MS) == 0) {
+            break;
+        }
+        last_receive = clock_seconds(CLOCK_MONOTONIC);
+
+        if (batched) {
+            receive_udp_datagrams_batched(udp_batching_context, count_datagram, result);
+            continue;
+        }
+
+        while (true) {
+            ssize_t read = recvfrom(sockets.receiver_fd, buffer, sizeof(buffer), 0, NULL, NULL);
+            result->syscalls++;
+            if (read < 0) {
+                break;
+            }
+            count_datagram(buffer, read, NULL, 0, result);
+        }
+    }
+
+    pthread_join(sender_thread, NULL);
+
+    result->elapsed_seconds = last_receive - start;
+    result->cpu_seconds = clock_seconds(CLOCK_PROCESS_CPUTIME_ID) - cpu_start;
+    result->syscalls += sender_args.syscalls + udp_batching_context->stats.recv_syscalls;
+
+    free_udp_batching_context(udp_batching_context);
+    free(udp_batching_context);
+    close_benchmark_sockets(&sockets);
+
+    return 0;
+}
+
+static void print_result(const char *name, BenchmarkResult *result) {
+    fprintf(stdout, "%-10s %12.0f datagrams/sec %8.2f CPU ns/byte %10lu syscalls %6.2f%% loss\n", name,
+            result->datagrams_received / result->elapsed_seconds, result->cpu_seconds * 1e9 / result->bytes_received,
+            result->syscalls, 100.0 * (NUM_DATAGRAMS - result->datagrams_received) / NUM_DATAGRAMS);
+}
+
+int main(void) {
+    UdpBatchingContext *probe = malloc(sizeof(UdpBatchingContext));
+    int probe_fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (probe == NULL || probe_fd < 0 || init_udp_batching_context(probe, probe_fd) > 0) {
+        fprintf(stderr, "Error: failed to probe socket offloads\n");
+        return 1;
+    }
+    fprintf(stdout, "UDP GSO: %s, UDP GRO: %s\n", probe->gso_enabled ? "on" : "off",
+            probe->gro_enabled ? "on" : "off");
+    free_udp_batching_context(probe);
+    free(probe);
+    close(probe_fd);
+
+    BenchmarkResult unbatched_result;
+    BenchmarkResult batched_result;
+    if (run_benchmark(false, &unbatched_result) > 0 || run_benchmark(true, &batched_result) > 0) {
+        fprintf(stderr, "Error: benchmark failed\n");
+        return 1;
+    }
+
+    print_result("unbatched", &unbatched_result);
+    print_result("batched", &batched_result);
+
+    return 0;
+}
@@ -0,0 +1,324 @@
+#include "tests/test_common.h"
+
+#include "src/common_rpc/rpc_codec.h"
+#include "src/common_rpc/rpc_msg_encoding.h"
+
+/*
+ * RPC codec tests - these don't talk to the server
+ */
+
+#define TEST_FILE_DATA_SIZE 4099 // not a multiple of the XDR unit, so that the opaque data is padded
+
+TestSuite(rpc_codec_test_suite);
+
+/*
+ * Packs the given procedure parameters or results with the given codec and unpacks them back as the given type.
+ *
+ * The user of this function takes the responsibility to free the returned message with the '*__free_unpacked'
+ * function of its type.
+ */
+static void *pack_and_unpack_rpc_payload(RpcCodec codec, const ProtobufCMessage *message,
+                                         const ProtobufCMessageDescriptor *descriptor) {
+    size_t packed_size = get_rpc_payload_packed_size(codec, message);
+    uint8_t *buffer = malloc(packed_size);
+    cr_assert_not_null(buffer);
+
+    cr_assert_eq(pack_rpc_payload(codec, message, buffer), packed_size);
+    void *unpacked_message = unpack_rpc_payload(codec, descriptor, NULL, packed_size, buffer);
+    free(buffer);
+    cr_assert_not_null(unpacked_message);
+
+    return unpacked_message;
+}
+
+/*
+ * Encodes a WRITE call carrying the given file data, with an AUTH_SYS credential, with the given codec, into a new
+ * buffer, and places its size in 'rpc_msg_size'.
+ *
+ * The user of this function takes the responsibility to free the returned buffer.
+ */
+static uint8_t *encode_test_write_call(RpcCodec codec, uint8_t *file_data, size_t file_data_size,
+                                       size_t *rpc_msg_size) {
+    NfsFh__NfsFileHandle nfs_filehandle = NFS_FH__NFS_FILE_HANDLE__INIT;
+    nfs_filehandle.inode_number = 123456;
+    nfs_filehandle.timestamp = 1700000000;
+    Nfs__FHandle fhandle = NFS__FHANDLE__INIT;
+    fhandle.nfs_filehandle = &nfs_filehandle;
+
+    Nfs__WriteArgs writeargs = NFS__WRITE_ARGS__INIT;
+    writeargs.file = &fhandle;
+    writeargs.offset = 8192;
+    writeargs.nfsdata.data = file_data;
+    writeargs.nfsdata.len = file_data_size;
+
+    size_t writeargs_size = get_rpc_payload_packed_size(codec, &writeargs.base);
+    uint8_t *writeargs_buffer = allocate_rpc_payload_buffer(writeargs_size);
+    cr_assert_not_null(writeargs_buffer);
+    pack_rpc_payload(codec, &writeargs.base, writeargs_buffer);
+
+    Google__Protobuf__Any parameters = GOOGLE__PROTOBUF__ANY__INIT;
+    parameters.type_url = "nfs/WriteArgs";
+    parameters.value.data = writeargs_buffer;
+    parameters.value.len = writeargs_size;
+
+    uint32_t gids[] = {1000, 27, 100};
+    Rpc__AuthSysParams auth_sys = RPC__AUTH_SYS_PARAMS__INIT;
+    auth_sys.timestamp = 1700000000;
+    auth_sys.machinename = "test-client";
+    auth_sys.uid = 1500;
+    auth_sys.gid = 2000;
+    auth_sys.n_gids = sizeof(gids) / sizeof(gids[0]);
+    auth_sys.gids = gids;
+
+    Rpc__OpaqueAuth credential = RPC__OPAQUE_AUTH__INIT;
+    credential.flavor = RPC__AUTH_FLAVOR__AUTH_SYS;
+    credential.body_case = RPC__OPAQUE_AUTH__BODY_AUTH_SYS;
+    credential.auth_sys = &auth_sys;
+
+    Google__Protobuf__Empty empty = GOOGLE__PROTOBUF__EMPTY__INIT;
+    Rpc__OpaqueAuth verifier = RPC__OPAQUE_AUTH__INIT;
+    verifier.flavor = RPC__AUTH_FLAVOR__AUTH_NONE;
+    verifier.body_case = RPC__OPAQUE_AUTH__BODY_EMPTY;
+    verifier.empty = &empty;
+
+    Rpc__CallBody call_body = RPC__CALL_BODY__INIT;
+    call_body.rpcvers = 2;
+    call_body.prog = NFS_RPC_PROGRAM_NUMBER;
+    call_body.vers = NFS_VERSION_LOW;
+    call_body.proc = NFSPROC_WRITE;
+    call_body.credential = &credential;
+    call_body.verifier = &verifier;
+    call_body.params = &parameters;
+
+    Rpc__RpcMsg rpc_msg = RPC__RPC_MSG__INIT;
+    rpc_msg.xid = 0xabcd1234;
+    rpc_msg.mtype = RPC__MSG_TYPE__CALL;
+    rpc_msg.body_case = RPC__RPC_MSG__BODY_CBODY;
+    rpc_msg.cbody = &call_body;
+
+    EncodedRpcMsg encoded_rpc_msg;
+    cr_assert_eq(encode_rpc_msg(codec, &rpc_msg, &encoded_rpc_msg), 0);
+
+    uint8_t *rpc_msg_buffer = malloc(encoded_rpc_msg.size);
+    cr_assert_not_null(rpc_msg_buffer);
+    memcpy(rpc_msg_buffer, encoded_rpc_msg.data, encoded_rpc_msg.size);
+    *rpc_msg_size = encoded_rpc_msg.size;
+
+    free_encoded_rpc_msg(&encoded_rpc_msg);
+    free_rpc_payload_buffer(writeargs_buffer);
+
+    return rpc_msg_buffer;
+}
+
+Test(rpc_codec_test_suite, xdr_attrstat_round_trip, .description = "XDR AttrStat round trip") {
+    Nfs__NfsFType nfs_ftype = NFS__NFS_FTYPE__INIT;
+    nfs_ftype.ftype = NFS__FTYPE__NFREG;
+    Nfs__TimeVal atime = NFS__TIME_VAL__INIT, mtime = NFS__TIME_VAL__INIT, ctime = NFS__TIME_VAL__INIT;
+    atime.seconds = 1700000001;
+    atime.useconds = 1;
+    mtime.seconds = 1700000002;
+    mtime.useconds = 2;
+    ctime.seconds = 1700000003;
+    ctime.useconds = 3;
+
+    Nfs__FAttr fattr = NFS__FATTR__INIT;
+    fattr.nfs_ftype = &nfs_ftype;
+    fattr.mode = 0100644;
+    fattr.nlink = 2;
+    fattr.uid = 1500;
+    fattr.gid = 2000;
+    fattr.size = 5000000000; // more than 32 bits
+    fattr.blocksize = 4096;
+    fattr.rdev = 7;
+    fattr.blocks = 9765632;
+    fattr.fsid = 2049;
+    fattr.fileid = 123456;
+    fattr.atime = &atime;
+    fattr.mtime = &mtime;
+    fattr.ctime = &ctime;
+
+    Nfs__NfsStat nfs_status = NFS__NFS_STAT__INIT;
+    nfs_status.stat = NFS__STAT__NFS_OK;
+    Nfs__AttrStat attrstat = NFS__ATTR_STAT__INIT;
+    attrstat.nfs_status = &nfs_status;
+    attrstat.body_case = NFS__ATTR_STAT__BODY_ATTRIBUTES;
+    attrstat.attributes = &fattr;
+
+    Nfs__AttrStat *unpacked_attrstat =
+        pack_and_unpack_rpc_payload(RPC_CODEC_XDR, &attrstat.base, &nfs__attr_stat__descriptor);
+
+    cr_assert_not_null(unpacked_attrstat->nfs_status);
+    cr_assert_eq(unpacked_attrstat->nfs_status->stat, NFS__STAT__NFS_OK);
+    cr_assert_eq(unpacked_attrstat->body_case, NFS__ATTR_STAT__BODY_ATTRIBUTES);
+
+    Nfs__FAttr *unpacked_fattr = unpacked_attrstat->attributes;
+    cr_assert_not_null(unpacked_fattr);
+    cr_assert_eq(unpacked_fattr->nfs_ftype->ftype, NFS__FTYPE__NFREG);
+    cr_assert_eq(unpacked_fattr->mode, fattr.mode);
+    cr_assert_eq(unpacked_fattr->nlink, fattr.nlink);
+    cr_assert_eq(unpacked_fattr->uid, fattr.uid);
+    cr_assert_eq(unpacked_fattr->gid, fattr.gid);
+    cr_assert_eq(unpacked_fattr->size, fattr.size);
+    cr_assert_eq(unpacked_fattr->blocksize, fattr.blocksize);
+    cr_assert_eq(unpacked_fattr->rdev, fattr.rdev);
+    cr_assert_eq(unpacked_fattr->blocks, fattr.blocks);
+    cr_assert_eq(unpacked_fattr->fsid, fattr.fsid);
+    cr_assert_eq(unpacked_fattr->fileid, fattr.fileid);
+    cr_assert_eq(unpacked_fattr->atime->seconds, atime.seconds);
+    cr_assert_eq(unpacked_fattr->atime->useconds, atime.useconds);
+    cr_assert_eq(unpacked_fattr->mtime->seconds, mtime.seconds);
+    cr_assert_eq(unpacked_fattr->mtime->useconds, mtime.useconds);
+    cr_assert_eq(unpacked_fattr->ctime->seconds, ctime.seconds);
+    cr_assert_eq(unpacked_fattr->ctime->useconds, ctime.useconds);
+
+    nfs__attr_stat__free_unpacked(unpacked_attrstat, NULL);
+}
+
+Test(rpc_codec_test_suite, xdr_attrstat_error_round_trip, .description = "XDR AttrStat with an error round trip") {
+    Google__Protobuf__Empty empty = GOOGLE__PROTOBUF__EMPTY__INIT;
+    Nfs__NfsStat nfs_status = NFS__NFS_STAT__INIT;
+    nfs_status.stat = NFS__STAT__NFSERR_NOENT;
+    Nfs__AttrStat attrstat = NFS__ATTR_STAT__INIT;
+    attrstat.nfs_status = &nfs_status;
+    attrstat.body_case = NFS__ATTR_STAT__BODY_DEFAULT_CASE;
+    attrstat.default_case = &empty;
+
+    Nfs__AttrStat *unpacked_attrstat =
+        pack_and_unpack_rpc_payload(RPC_CODEC_XDR, &attrstat.base, &nfs__attr_stat__descriptor);
+
+    cr_assert_eq(unpacked_attrstat->nfs_status->stat, NFS__STAT__NFSERR_NOENT);
+    cr_assert_eq(unpacked_attrstat->body_case, NFS__ATTR_STAT__BODY_DEFAULT_CASE);
+    cr_assert_null(unpacked_attrstat->attributes);
+
+    nfs__attr_stat__free_unpacked(unpacked_attrstat, NULL);
+}
+
+Test(rpc_codec_test_suite, xdr_diropargs_round_trip, .description = "XDR DirOpArgs round trip") {
+    NfsFh__NfsFileHandle nfs_filehandle = NFS_FH__NFS_FILE_HANDLE__INIT;
+    nfs_filehandle.inode_number = NONEXISTENT_INODE_NUMBER;
+    nfs_filehandle.timestamp = 1700000000;
+    Nfs__FHandle fhandle = NFS__FHANDLE__INIT;
+    fhandle.nfs_filehandle = &nfs_filehandle;
+
+    Nfs__FileName filename = NFS__FILE_NAME__INIT;
+    filename.filename = "test_file.txt"; // not a multiple of the XDR unit, so that the string is padded
+    Nfs__DirOpArgs diropargs = NFS__DIR_OP_ARGS__INIT;
+    diropargs.dir = &fhandle;
+    diropargs.name = &filename;
+
+    Nfs__DirOpArgs *unpacked_diropargs =
+        pack_and_unpack_rpc_payload(RPC_CODEC_XDR, &diropargs.base, &nfs__dir_op_args__descriptor);
+
+    cr_assert_not_null(unpacked_diropargs->dir);
+    cr_assert_not_null(unpacked_diropargs->dir->nfs_filehandle);
+    cr_assert_eq(unpacked_diropargs->dir->nfs_filehandle->inode_number, NONEXISTENT_INODE_NUMBER);
+    cr_assert_eq(unpacked_diropargs->dir->nfs_filehandle->timestamp, 1700000000);
+    cr_assert_not_null(unpacked_diropargs->name);
+    cr_assert_str_eq(unpacked_diropargs->name->filename, "test_file.txt");
+
+    nfs__dir_op_args__free_unpacked(unpacked_diropargs, NULL);
+}
+
+Test(rpc_codec_test_suite, xdr_call_round_trip, .description = "XDR WRITE call round trip") {
+    uint8_t file_data[TEST_FILE_DATA_SIZE];
+    for (size_t i = 0; i < TEST_FILE_DATA_SIZE; i++) {
+        file_data[i] = i % 251;
+    }
+
+    size_t rpc_msg_size;
+    uint8_t *rpc_msg_buffer = encode_test_write_call(RPC_CODEC_XDR, file_data, TEST_FILE_DATA_SIZE, &rpc_msg_size);
+    cr_assert_eq(rpc_msg_size % XDR_UNIT_SIZE, 0);
+
+    Rpc__RpcMsg *rpc_msg = decode_rpc_msg_in_place(RPC_CODEC_XDR, rpc_msg_buffer, rpc_msg_size);
+    cr_assert_not_null(rpc_msg);
+    cr_assert_eq(rpc_msg->xid, 0xabcd1234);
+    cr_assert_eq(rpc_msg->mtype, RPC__MSG_TYPE__CALL);
+
+    Rpc__CallBody *call_body = rpc_msg->cbody;
+    cr_assert_not_null(call_body);
+    cr_assert_eq(call_body->rpcvers, 2);
+    cr_assert_eq(call_body->prog, NFS_RPC_PROGRAM_NUMBER);
+    cr_assert_eq(call_body->vers, NFS_VERSION_LOW);
+    cr_assert_eq(call_body->proc, NFSPROC_WRITE);
+
+    cr_assert_eq(call_body->credential->flavor, RPC__AUTH_FLAVOR__AUTH_SYS);
+    Rpc__AuthSysParams *auth_sys = call_body->credential->auth_sys;
+    cr_assert_not_null(auth_sys);
+    cr_assert_str_eq(auth_sys->machinename, "test-client");
+    cr_assert_eq(auth_sys->uid, 1500);
+    cr_assert_eq(auth_sys->gid, 2000);
+    cr_assert_eq(auth_sys->n_gids, 3);
+    cr_assert_eq(auth_sys->gids[0], 1000);
+    cr_assert_eq(auth_sys->gids[1], 27);
+    cr_assert_eq(auth_sys->gids[2], 100);
+    cr_assert_eq(call_body->verifier->flavor, RPC__AUTH_FLAVOR__AUTH_NONE);
+
+    // the parameters are left in the received buffer, and unpacked from there
+    Google__Protobuf__Any *parameters = call_body->params;
+    cr_assert_not_null(parameters);
+    cr_assert(parameters->value.data >= rpc_msg_buffer && parameters->value.data < rpc_msg_buffer + rpc_msg_size);
+    Nfs__WriteArgs *writeargs = unpack_rpc_payload(RPC_CODEC_XDR, &nfs__write_args__descriptor, NULL,
+                                                   parameters->value.len, parameters->value.data);
+    cr_assert_not_null(writeargs);
+    cr_assert_eq(writeargs->file->nfs_filehandle->inode_number, 123456);
+    cr_assert_eq(writeargs->offset, 8192);
+    cr_assert_eq(writeargs->nfsdata.len, TEST_FILE_DATA_SIZE);
+    cr_assert_arr_eq(writeargs->nfsdata.data, file_data, TEST_FILE_DATA_SIZE);
+
+    nfs__write_args__free_unpacked(writeargs, NULL);
+    free_rpc_msg_decoded_in_place(rpc_msg, rpc_msg_buffer, rpc_msg_size);
+    free(rpc_msg_buffer);
+}
+
+Test(rpc_codec_test_suite, detect_rpc_codec_xdr_call, .description = "detect_rpc_codec tells an XDR call") {
+    uint8_t file_data[TEST_FILE_DATA_SIZE] = {0};
+
+    size_t rpc_msg_size;
+    uint8_t *rpc_msg_buffer = encode_test_write_call(RPC_CODEC_XDR, file_data, TEST_FILE_DATA_SIZE, &rpc_msg_size);
+
+    cr_assert_eq(detect_rpc_codec(rpc_msg_buffer, rpc_msg_size), RPC_CODEC_XDR);
+
+    free(rpc_msg_buffer);
+}
+
+Test(rpc_codec_test_suite, detect_rpc_codec_protobuf_call, .description = "detect_rpc_codec tells a protobuf call") {
+    uint8_t file_data[TEST_FILE_DATA_SIZE] = {0};
+
+    size_t rpc_msg_size;
+    uint8_t *rpc_msg_buffer =
+        encode_test_write_call(RPC_CODEC_PROTOBUF, file_data, TEST_FILE_DATA_SIZE, &rpc_msg_size);
+
+    cr_assert_eq(detect_rpc_codec(rpc_msg_buffer, rpc_msg_size), RPC_CODEC_PROTOBUF);
+
+    // and a protobuf call decodes as one
+    Rpc__RpcMsg *rpc_msg = decode_rpc_msg_in_place(RPC_CODEC_PROTOBUF, rpc_msg_buffer, rpc_msg_size);
+    cr_assert_not_null(rpc_msg);
+    cr_assert_eq(rpc_msg->xid, 0xabcd1234);
+    cr_assert_eq(rpc_msg->cbody->proc, NFSPROC_WRITE);
+    free_rpc_msg_decoded_in_place(rpc_msg, rpc_msg_buffer, rpc_msg_size);
+
+    free(rpc_msg_buffer);
+}
+
+Test(rpc_codec_test_suite, detect_rpc_codec_short_message,
+     .description = "detect_rpc_codec takes messages too short for an XDR call header for protobuf") {
+    uint8_t xdr_call_header[3 * XDR_UNIT_SIZE];
+    uint8_t *out = xdr_pack_uint32(1, xdr_call_header);
+    out = xdr_pack_uint32(RPC__MSG_TYPE__CALL, out);
+    xdr_pack_uint32(2, out);
+
+    cr_assert_eq(detect_rpc_codec(xdr_call_header, sizeof(xdr_call_header)), RPC_CODEC_XDR);
+    cr_assert_eq(detect_rpc_codec(xdr_call_header, sizeof(xdr_call_header) - 1), RPC_CODEC_PROTOBUF);
+    cr_assert_eq(detect_rpc_codec(xdr_call_header, 0), RPC_CODEC_PROTOBUF);
+}
+
+Test(rpc_codec_test_suite, detect_rpc_codec_xdr_reply,
+     .description = "detect_rpc_codec takes anything but an XDR call for protobuf") {
+    // an XDR reply header, which a server never receives
+    uint8_t xdr_reply_header[3 * XDR_UNIT_SIZE];
+    uint8_t *out = xdr_pack_uint32(1, xdr_reply_header);
+    out = xdr_pack_uint32(RPC__MSG_TYPE__REPLY, out);
+    xdr_pack_uint32(RPC__REPLY_STAT__MSG_ACCEPTED, out);
+
+    cr_assert_eq(detect_rpc_codec(xdr_reply_header, sizeof(xdr_reply_header)), RPC_CODEC_PROTOBUF);
+}
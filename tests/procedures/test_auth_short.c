@@ -0,0 +1,184 @@
+#include "tests/test_common.h"
+
+#include "src/authentication/auth_short_cache.h"
+#include "src/authentication/authentication.h"
+
+/*
+ * AUTH_SHORT credential tests
+ */
+
+TestSuite(auth_short_test_suite);
+
+// a short handle this server never hands out
+static const uint8_t unknown_short_handle[AUTH_SHORT_HANDLE_SIZE] = {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff};
+
+/*
+ * Calls NFSPROC_NULL over the test transport protocol, and returns the RPC reply without validating it.
+ *
+ * The user of this function takes the responsibility to free the returned reply with 'rpc__rpc_msg__free_unpacked'.
+ */
+static Rpc__RpcMsg *call_null_procedure(RpcConnectionContext *rpc_connection_context) {
+    Google__Protobuf__Any parameters = GOOGLE__PROTOBUF__ANY__INIT;
+
+    switch (rpc_connection_context->transport_protocol) {
+    case TRANSPORT_PROTOCOL_QUIC:
+        return invoke_rpc_remote_quic(rpc_connection_context, NFS_RPC_PROGRAM_NUMBER, NFS_VERSION_LOW, NFSPROC_NULL,
+                                      parameters, true);
+    case TRANSPORT_PROTOCOL_SHM:
+        return invoke_rpc_remote_shm(rpc_connection_context, NFS_RPC_PROGRAM_NUMBER, NFS_VERSION_LOW, NFSPROC_NULL,
+                                     parameters);
+    case TRANSPORT_PROTOCOL_TCP:
+    case TRANSPORT_PROTOCOL_TLS:
+    default:
+        return invoke_rpc_remote_tcp(rpc_connection_context, NFS_RPC_PROGRAM_NUMBER, NFS_VERSION_LOW, NFSPROC_NULL,
+                                     parameters);
+    }
+}
+
+/*
+ * Creates a RpcConnectionContext to the test server whose credential is the given short handle alone, so that calls
+ * made on it are never sent again with a full credential.
+ */
+static RpcConnectionContext *create_short_credential_rpc_connection_context(const uint8_t *short_handle,
+                                                                            size_t short_handle_size) {
+    Rpc__OpaqueAuth *short_credential = create_auth_short_opaque_auth(short_handle, short_handle_size);
+    Rpc__OpaqueAuth *verifier = create_auth_none_opaque_auth();
+
+    return create_rpc_connection_context_with_test_ipaddr_and_port(short_credential, verifier,
+                                                                   TEST_TRANSPORT_PROTOCOL);
+}
+
+Test(auth_short_test_suite, auth_short_handle_issued, .description = "AUTH_SHORT handle issued in the verifier") {
+    RpcConnectionContext *rpc_connection_context = create_test_rpc_connection_context(TEST_TRANSPORT_PROTOCOL);
+    if (rpc_connection_context == NULL) {
+        cr_fatal("auth_short_handle_issued: Failed to connect to the server\n");
+    }
+    cr_assert_eq(rpc_connection_context->auth_short_handle_size, 0);
+
+    Rpc__RpcMsg *rpc_reply = call_null_procedure(rpc_connection_context);
+    cr_assert_eq(validate_successful_accepted_reply(rpc_reply), 0);
+
+    // the reply to a call with an AUTH_SYS credential carries a short handle for it
+    Rpc__OpaqueAuth *verifier = rpc_reply->rbody->areply->verifier;
+    cr_assert_not_null(verifier);
+    cr_assert_eq(verifier->flavor, RPC__AUTH_FLAVOR__AUTH_SHORT);
+    cr_assert_eq(verifier->body_case, RPC__OPAQUE_AUTH__BODY_AUTH_SHORT);
+    cr_assert_eq(verifier->auth_short.len, AUTH_SHORT_HANDLE_SIZE);
+
+    // and the client keeps it, to send it in place of the credential from then on
+    cr_assert_eq(rpc_connection_context->auth_short_handle_size, AUTH_SHORT_HANDLE_SIZE);
+    cr_assert_arr_eq(rpc_connection_context->auth_short_handle, verifier->auth_short.data, AUTH_SHORT_HANDLE_SIZE);
+
+    rpc__rpc_msg__free_unpacked(rpc_reply, NULL);
+
+    free_rpc_connection_context(rpc_connection_context);
+}
+
+Test(auth_short_test_suite, auth_short_credential_accepted,
+     .description = "AUTH_SHORT credential accepted on following calls") {
+    RpcConnectionContext *rpc_connection_context = create_test_rpc_connection_context(TEST_TRANSPORT_PROTOCOL);
+    if (rpc_connection_context == NULL) {
+        cr_fatal("auth_short_credential_accepted: Failed to connect to the server\n");
+    }
+
+    cr_assert_eq(nfs_procedure_0_do_nothing(rpc_connection_context), 0);
+    cr_assert_eq(rpc_connection_context->auth_short_handle_size, AUTH_SHORT_HANDLE_SIZE);
+
+    // calls made with nothing but the short handle are served as if made with the root AUTH_SYS credential
+    RpcConnectionContext *short_credential_rpc_connection_context = create_short_credential_rpc_connection_context(
+        rpc_connection_context->auth_short_handle, rpc_connection_context->auth_short_handle_size);
+    free_rpc_connection_context(rpc_connection_context);
+    if (short_credential_rpc_connection_context == NULL) {
+        cr_fatal("auth_short_credential_accepted: Failed to connect to the server\n");
+    }
+
+    Mount__FhStatus *fhstatus = mount_directory_success(short_credential_rpc_connection_context, "/nfs_share");
+
+    Nfs__FHandle fhandle = NFS__FHANDLE__INIT;
+    NfsFh__NfsFileHandle nfs_filehandle_copy = deep_copy_nfs_filehandle(fhstatus->directory->nfs_filehandle);
+    mount__fh_status__free_unpacked(fhstatus, NULL);
+    fhandle.nfs_filehandle = &nfs_filehandle_copy;
+
+    Nfs__AttrStat *attrstat =
+        get_attributes_success(short_credential_rpc_connection_context, fhandle, NFS__FTYPE__NFDIR);
+    nfs__attr_stat__free_unpacked(attrstat, NULL);
+
+    free_rpc_connection_context(short_credential_rpc_connection_context);
+}
+
+Test(auth_short_test_suite, auth_short_handles_not_sequential,
+     .description = "AUTH_SHORT handles of different credentials not handed out in sequence") {
+    uint32_t gids[1] = {DOCKER_IMAGE_TESTUSER_GID};
+    uint64_t handles[2];
+    for (int i = 0; i < 2; i++) {
+        Rpc__OpaqueAuth *credential = create_auth_sys_opaque_auth("test", DOCKER_IMAGE_TESTUSER_UID + i,
+                                                                  DOCKER_IMAGE_TESTUSER_GID, 1, gids);
+        Rpc__OpaqueAuth *verifier = create_auth_none_opaque_auth();
+        RpcConnectionContext *rpc_connection_context =
+            create_rpc_connection_context_with_test_ipaddr_and_port(credential, verifier, TEST_TRANSPORT_PROTOCOL);
+        if (rpc_connection_context == NULL) {
+            cr_fatal("auth_short_handles_not_sequential: Failed to connect to the server\n");
+        }
+
+        cr_assert_eq(nfs_procedure_0_do_nothing(rpc_connection_context), 0);
+        cr_assert_eq(rpc_connection_context->auth_short_handle_size, AUTH_SHORT_HANDLE_SIZE);
+
+        handles[i] = 0;
+        for (int j = 0; j < AUTH_SHORT_HANDLE_SIZE; j++) {
+            handles[i] = (handles[i] << 8) | rpc_connection_context->auth_short_handle[j];
+        }
+
+        free_rpc_connection_context(rpc_connection_context);
+    }
+
+    // a client that sees its own handle must not be able to work out the handle of another client from it
+    cr_assert_neq(handles[0], handles[1]);
+    cr_assert_neq(handles[1], handles[0] + 1);
+    cr_assert_neq(handles[0], handles[1] + 1);
+}
+
+Test(auth_short_test_suite, auth_short_unknown_handle_rejected,
+     .description = "AUTH_SHORT unknown handle rejected with AUTH_REJECTEDCRED") {
+    RpcConnectionContext *rpc_connection_context =
+        create_short_credential_rpc_connection_context(unknown_short_handle, AUTH_SHORT_HANDLE_SIZE);
+    if (rpc_connection_context == NULL) {
+        cr_fatal("auth_short_unknown_handle_rejected: Failed to connect to the server\n");
+    }
+
+    Rpc__RpcMsg *rpc_reply = call_null_procedure(rpc_connection_context);
+    cr_assert_not_null(rpc_reply);
+    cr_assert_eq(rpc_reply->body_case, RPC__RPC_MSG__BODY_RBODY);
+    cr_assert_eq(rpc_reply->rbody->stat, RPC__REPLY_STAT__MSG_DENIED);
+    cr_assert_eq(rpc_reply->rbody->reply_case, RPC__REPLY_BODY__REPLY_RREPLY);
+
+    Rpc__RejectedReply *rejected_reply = rpc_reply->rbody->rreply;
+    cr_assert_eq(rejected_reply->stat, RPC__REJECT_STAT__AUTH_ERROR);
+    cr_assert_eq(rejected_reply->reply_data_case, RPC__REJECTED_REPLY__REPLY_DATA_AUTH_STAT);
+    cr_assert_eq(rejected_reply->auth_stat, RPC__AUTH_STAT__AUTH_REJECTEDCRED);
+
+    rpc__rpc_msg__free_unpacked(rpc_reply, NULL);
+
+    free_rpc_connection_context(rpc_connection_context);
+}
+
+Test(auth_short_test_suite, auth_short_unknown_handle_retried,
+     .description = "AUTH_SHORT call with an unknown handle sent again with the full credential") {
+    RpcConnectionContext *rpc_connection_context = create_test_rpc_connection_context(TEST_TRANSPORT_PROTOCOL);
+    if (rpc_connection_context == NULL) {
+        cr_fatal("auth_short_unknown_handle_retried: Failed to connect to the server\n");
+    }
+
+    // as if the server had forgotten the handle it handed out, e.g. because it restarted
+    memcpy(rpc_connection_context->auth_short_handle, unknown_short_handle, AUTH_SHORT_HANDLE_SIZE);
+    rpc_connection_context->auth_short_handle_size = AUTH_SHORT_HANDLE_SIZE;
+
+    // the call is rejected, sent again with the AUTH_SYS credential, and succeeds
+    cr_assert_eq(nfs_procedure_0_do_nothing(rpc_connection_context), 0);
+
+    // and the client now has a handle the server knows
+    cr_assert_eq(rpc_connection_context->auth_short_handle_size, AUTH_SHORT_HANDLE_SIZE);
+    cr_assert_neq(memcmp(rpc_connection_context->auth_short_handle, unknown_short_handle, AUTH_SHORT_HANDLE_SIZE), 0);
+    cr_assert_eq(nfs_procedure_0_do_nothing(rpc_connection_context), 0);
+
+    free_rpc_connection_context(rpc_connection_context);
+}
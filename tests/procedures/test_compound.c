@@ -0,0 +1,495 @@
+#include "tests/test_common.h"
+
+#include "src/common_rpc/rpc_codec.h"
+
+/*
+ * NFSPROC_COMPOUND (18) tests
+ */
+
+TestSuite(nfs_compound_test_suite);
+
+/*
+ * Fills in the given CompoundOp to run the given Nfs procedure with the given parameters, encoded with the given codec.
+ *
+ * The user of this function takes the responsibility to free the 'parameters.data' of the CompoundOp.
+ */
+static void init_compound_operation(Nfs__CompoundOp *operation, RpcCodec codec, uint32_t procedure,
+                                    const ProtobufCMessage *parameters, bool use_current_fhandle) {
+    nfs__compound_op__init(operation);
+    operation->procedure = procedure;
+    operation->use_current_fhandle = use_current_fhandle;
+
+    operation->parameters.len = get_rpc_payload_packed_size(codec, parameters);
+    operation->parameters.data = malloc(operation->parameters.len);
+    cr_assert_not_null(operation->parameters.data);
+    pack_rpc_payload(codec, parameters, operation->parameters.data);
+}
+
+/*
+ * Calls NFSPROC_COMPOUND with the given arguments over the test transport protocol, and returns the RPC reply without
+ * validating it.
+ *
+ * The user of this function takes the responsibility to free the returned reply with 'rpc__rpc_msg__free_unpacked'.
+ */
+static Rpc__RpcMsg *call_compound_procedure(RpcConnectionContext *rpc_connection_context,
+                                            Nfs__CompoundArgs *compoundargs) {
+    RpcCodec codec = rpc_connection_context->rpc_codec;
+
+    size_t compoundargs_size = get_rpc_payload_packed_size(codec, &compoundargs->base);
+    uint8_t *compoundargs_buffer = malloc(compoundargs_size);
+    cr_assert_not_null(compoundargs_buffer);
+    pack_rpc_payload(codec, &compoundargs->base, compoundargs_buffer);
+
+    Google__Protobuf__Any parameters = GOOGLE__PROTOBUF__ANY__INIT;
+    parameters.type_url = "nfs/CompoundArgs";
+    parameters.value.data = compoundargs_buffer;
+    parameters.value.len = compoundargs_size;
+
+    Rpc__RpcMsg *rpc_reply;
+    switch (rpc_connection_context->transport_protocol) {
+    case TRANSPORT_PROTOCOL_QUIC:
+        rpc_reply = invoke_rpc_remote_quic(rpc_connection_context, NFS_RPC_PROGRAM_NUMBER, NFS_VERSION_LOW,
+                                           NFSPROC_COMPOUND, parameters, true);
+        break;
+    case TRANSPORT_PROTOCOL_SHM:
+        rpc_reply = invoke_rpc_remote_shm(rpc_connection_context, NFS_RPC_PROGRAM_NUMBER, NFS_VERSION_LOW,
+                                          NFSPROC_COMPOUND, parameters);
+        break;
+    case TRANSPORT_PROTOCOL_TCP:
+    case TRANSPORT_PROTOCOL_TLS:
+    default:
+        rpc_reply = invoke_rpc_remote_tcp(rpc_connection_context, NFS_RPC_PROGRAM_NUMBER, NFS_VERSION_LOW,
+                                          NFSPROC_COMPOUND, parameters);
+    }
+    free(compoundargs_buffer);
+
+    return rpc_reply;
+}
+
+/*
+ * Calls NFSPROC_COMPOUND with the given arguments and checks that the server replies with GARBAGE_ARGS.
+ */
+static void compound_garbage_args(RpcConnectionContext *rpc_connection_context, Nfs__CompoundArgs *compoundargs) {
+    Rpc__RpcMsg *rpc_reply = call_compound_procedure(rpc_connection_context, compoundargs);
+    cr_assert_not_null(rpc_reply);
+    cr_assert_eq(rpc_reply->body_case, RPC__RPC_MSG__BODY_RBODY);
+    cr_assert_eq(rpc_reply->rbody->stat, RPC__REPLY_STAT__MSG_ACCEPTED);
+    cr_assert_eq(rpc_reply->rbody->reply_case, RPC__REPLY_BODY__REPLY_AREPLY);
+    cr_assert_eq(rpc_reply->rbody->areply->stat, RPC__ACCEPT_STAT__GARBAGE_ARGS);
+
+    rpc__rpc_msg__free_unpacked(rpc_reply, NULL);
+}
+
+/*
+ * Calls NFSPROC_COMPOUND with the given arguments and checks that the server runs it, with the given overall status
+ * and number of results.
+ *
+ * The user of this function takes the responsibility to free the returned CompoundRes with
+ * 'nfs__compound_res__free_unpacked'.
+ */
+static Nfs__CompoundRes *compound_success(RpcConnectionContext *rpc_connection_context,
+                                          Nfs__CompoundArgs compoundargs, Nfs__Stat expected_status,
+                                          size_t expected_number_of_results) {
+    Nfs__CompoundRes *compoundres = malloc(sizeof(Nfs__CompoundRes));
+    int status = nfs_procedure_18_compound(rpc_connection_context, compoundargs, compoundres);
+    if (status != 0) {
+        free(compoundres);
+        cr_fatal("NFSPROC_COMPOUND failed - status %d\n", status);
+    }
+
+    cr_assert_not_null(compoundres->nfs_status);
+    cr_assert_eq(compoundres->nfs_status->stat, expected_status);
+    cr_assert_eq(compoundres->n_results, expected_number_of_results);
+    for (size_t i = 0; i < compoundres->n_results; i++) {
+        cr_assert_eq(compoundres->results[i]->procedure, compoundargs.operations[i]->procedure);
+        cr_assert_not_null(compoundres->results[i]->nfs_status);
+    }
+
+    return compoundres;
+}
+
+static void free_compound_operations(Nfs__CompoundOp *operations, size_t number_of_operations) {
+    for (size_t i = 0; i < number_of_operations; i++) {
+        free(operations[i].parameters.data);
+    }
+}
+
+Test(nfs_compound_test_suite, compound_operations_run_in_order,
+     .description = "NFSPROC_COMPOUND operations run in order") {
+    RpcConnectionContext *rpc_connection_context = create_test_rpc_connection_context(TEST_TRANSPORT_PROTOCOL);
+    if (rpc_connection_context == NULL) {
+        cr_fatal("compound_operations_run_in_order: Failed to connect to the server\n");
+    }
+    RpcCodec codec = rpc_connection_context->rpc_codec;
+
+    Mount__FhStatus *fhstatus = mount_directory_success(rpc_connection_context, "/nfs_share");
+
+    Nfs__FHandle fhandle = NFS__FHANDLE__INIT;
+    NfsFh__NfsFileHandle nfs_filehandle_copy = deep_copy_nfs_filehandle(fhstatus->directory->nfs_filehandle);
+    mount__fh_status__free_unpacked(fhstatus, NULL);
+    fhandle.nfs_filehandle = &nfs_filehandle_copy;
+
+    // look up /nfs_share/readlink_test/target_file.txt and get its attributes, in a single round trip
+    Nfs__FileName directory_name = NFS__FILE_NAME__INIT;
+    directory_name.filename = "readlink_test";
+    Nfs__DirOpArgs directory_diropargs = NFS__DIR_OP_ARGS__INIT;
+    directory_diropargs.dir = &fhandle;
+    directory_diropargs.name = &directory_name;
+
+    Nfs__FileName file_name = NFS__FILE_NAME__INIT;
+    file_name.filename = "target_file.txt";
+    Nfs__DirOpArgs file_diropargs = NFS__DIR_OP_ARGS__INIT;
+    file_diropargs.dir = &fhandle;
+    file_diropargs.name = &file_name;
+
+    Nfs__CompoundOp operations[3];
+    init_compound_operation(&operations[0], codec, NFSPROC_LOOKUP, &directory_diropargs.base, true);
+    init_compound_operation(&operations[1], codec, NFSPROC_LOOKUP, &file_diropargs.base, true);
+    init_compound_operation(&operations[2], codec, NFSPROC_GETATTR, &fhandle.base, true);
+    Nfs__CompoundOp *operation_pointers[3] = {&operations[0], &operations[1], &operations[2]};
+
+    Nfs__CompoundArgs compoundargs = NFS__COMPOUND_ARGS__INIT;
+    compoundargs.fhandle = &fhandle;
+    compoundargs.n_operations = 3;
+    compoundargs.operations = operation_pointers;
+
+    Nfs__CompoundRes *compoundres = compound_success(rpc_connection_context, compoundargs, NFS__STAT__NFS_OK, 3);
+    free_compound_operations(operations, 3);
+
+    for (size_t i = 0; i < compoundres->n_results; i++) {
+        cr_assert_eq(compoundres->results[i]->nfs_status->stat, NFS__STAT__NFS_OK);
+    }
+
+    // the second LOOKUP ran in the directory found by the first one, and returned the same file a LOOKUP does
+    Nfs__DirOpRes *directory_diropres =
+        lookup_file_or_directory_success(rpc_connection_context, &fhandle, "readlink_test", NFS__FTYPE__NFDIR);
+    Nfs__FHandle directory_fhandle = NFS__FHANDLE__INIT;
+    NfsFh__NfsFileHandle directory_nfs_filehandle_copy =
+        deep_copy_nfs_filehandle(directory_diropres->diropok->file->nfs_filehandle);
+    nfs__dir_op_res__free_unpacked(directory_diropres, NULL);
+    directory_fhandle.nfs_filehandle = &directory_nfs_filehandle_copy;
+
+    Nfs__DirOpRes *file_diropres = lookup_file_or_directory_success(rpc_connection_context, &directory_fhandle,
+                                                                    "target_file.txt", NFS__FTYPE__NFREG);
+
+    Nfs__DirOpRes *compound_file_diropres = unpack_rpc_payload(
+        codec, &nfs__dir_op_res__descriptor, NULL, compoundres->results[1]->results.len,
+        compoundres->results[1]->results.data);
+    cr_assert_not_null(compound_file_diropres);
+    cr_assert_eq(compound_file_diropres->diropok->file->nfs_filehandle->inode_number,
+                 file_diropres->diropok->file->nfs_filehandle->inode_number);
+    nfs__dir_op_res__free_unpacked(compound_file_diropres, NULL);
+    nfs__dir_op_res__free_unpacked(file_diropres, NULL);
+
+    // and the GETATTR ran on that file
+    Nfs__AttrStat *attrstat = unpack_rpc_payload(codec, &nfs__attr_stat__descriptor, NULL,
+                                                 compoundres->results[2]->results.len,
+                                                 compoundres->results[2]->results.data);
+    cr_assert_not_null(attrstat);
+    cr_assert_eq(attrstat->nfs_status->stat, NFS__STAT__NFS_OK);
+    cr_assert_eq(attrstat->body_case, NFS__ATTR_STAT__BODY_ATTRIBUTES);
+    cr_assert_eq(attrstat->attributes->nfs_ftype->ftype, NFS__FTYPE__NFREG);
+    cr_assert_eq(attrstat->attributes->size, strlen("target_file_content"));
+    nfs__attr_stat__free_unpacked(attrstat, NULL);
+
+    nfs__compound_res__free_unpacked(compoundres, NULL);
+
+    free_rpc_connection_context(rpc_connection_context);
+}
+
+Test(nfs_compound_test_suite, compound_current_fhandle_replaced,
+     .description = "NFSPROC_COMPOUND current filehandle replaces the operation's filehandle") {
+    RpcConnectionContext *rpc_connection_context = create_test_rpc_connection_context(TEST_TRANSPORT_PROTOCOL);
+    if (rpc_connection_context == NULL) {
+        cr_fatal("compound_current_fhandle_replaced: Failed to connect to the server\n");
+    }
+    RpcCodec codec = rpc_connection_context->rpc_codec;
+
+    Mount__FhStatus *fhstatus = mount_directory_success(rpc_connection_context, "/nfs_share");
+
+    Nfs__FHandle fhandle = NFS__FHANDLE__INIT;
+    NfsFh__NfsFileHandle nfs_filehandle_copy = deep_copy_nfs_filehandle(fhstatus->directory->nfs_filehandle);
+    mount__fh_status__free_unpacked(fhstatus, NULL);
+    fhandle.nfs_filehandle = &nfs_filehandle_copy;
+
+    // the operations' own filehandles are of a nonexistent file, so only the current filehandle can make them succeed
+    NfsFh__NfsFileHandle nonexistent_nfs_filehandle = NFS_FH__NFS_FILE_HANDLE__INIT;
+    nonexistent_nfs_filehandle.inode_number = NONEXISTENT_INODE_NUMBER;
+    nonexistent_nfs_filehandle.timestamp = time(NULL);
+    Nfs__FHandle nonexistent_fhandle = NFS__FHANDLE__INIT;
+    nonexistent_fhandle.nfs_filehandle = &nonexistent_nfs_filehandle;
+
+    Nfs__FileName file_name = NFS__FILE_NAME__INIT;
+    file_name.filename = "test_file.txt";
+    Nfs__DirOpArgs diropargs = NFS__DIR_OP_ARGS__INIT;
+    diropargs.dir = &nonexistent_fhandle;
+    diropargs.name = &file_name;
+
+    // the first GETATTR runs on the CompoundArgs FHandle (/nfs_share), and the second one on the looked up file
+    Nfs__CompoundOp operations[3];
+    init_compound_operation(&operations[0], codec, NFSPROC_GETATTR, &nonexistent_fhandle.base, true);
+    init_compound_operation(&operations[1], codec, NFSPROC_LOOKUP, &diropargs.base, true);
+    init_compound_operation(&operations[2], codec, NFSPROC_GETATTR, &nonexistent_fhandle.base, true);
+    Nfs__CompoundOp *operation_pointers[3] = {&operations[0], &operations[1], &operations[2]};
+
+    Nfs__CompoundArgs compoundargs = NFS__COMPOUND_ARGS__INIT;
+    compoundargs.fhandle = &fhandle;
+    compoundargs.n_operations = 3;
+    compoundargs.operations = operation_pointers;
+
+    Nfs__CompoundRes *compoundres = compound_success(rpc_connection_context, compoundargs, NFS__STAT__NFS_OK, 3);
+
+    Nfs__AttrStat *directory_attrstat = unpack_rpc_payload(codec, &nfs__attr_stat__descriptor, NULL,
+                                                           compoundres->results[0]->results.len,
+                                                           compoundres->results[0]->results.data);
+    cr_assert_not_null(directory_attrstat);
+    cr_assert_eq(directory_attrstat->nfs_status->stat, NFS__STAT__NFS_OK);
+    cr_assert_eq(directory_attrstat->attributes->nfs_ftype->ftype, NFS__FTYPE__NFDIR);
+    cr_assert_eq(directory_attrstat->attributes->fileid, nfs_filehandle_copy.inode_number);
+    nfs__attr_stat__free_unpacked(directory_attrstat, NULL);
+
+    Nfs__AttrStat *file_attrstat = unpack_rpc_payload(codec, &nfs__attr_stat__descriptor, NULL,
+                                                      compoundres->results[2]->results.len,
+                                                      compoundres->results[2]->results.data);
+    cr_assert_not_null(file_attrstat);
+    cr_assert_eq(file_attrstat->nfs_status->stat, NFS__STAT__NFS_OK);
+    cr_assert_eq(file_attrstat->attributes->nfs_ftype->ftype, NFS__FTYPE__NFREG);
+    cr_assert_eq(file_attrstat->attributes->size, strlen("test_content"));
+    nfs__attr_stat__free_unpacked(file_attrstat, NULL);
+
+    nfs__compound_res__free_unpacked(compoundres, NULL);
+
+    // without 'use_current_fhandle', the operation runs on its own (nonexistent) filehandle
+    operations[0].use_current_fhandle = false;
+    compoundargs.n_operations = 1;
+
+    compoundres = compound_success(rpc_connection_context, compoundargs, NFS__STAT__NFSERR_NOENT, 1);
+    nfs__compound_res__free_unpacked(compoundres, NULL);
+
+    free_compound_operations(operations, 3);
+
+    free_rpc_connection_context(rpc_connection_context);
+}
+
+Test(nfs_compound_test_suite, compound_stops_at_first_failure,
+     .description = "NFSPROC_COMPOUND stops at the first failed operation") {
+    RpcConnectionContext *rpc_connection_context = create_test_rpc_connection_context(TEST_TRANSPORT_PROTOCOL);
+    if (rpc_connection_context == NULL) {
+        cr_fatal("compound_stops_at_first_failure: Failed to connect to the server\n");
+    }
+    RpcCodec codec = rpc_connection_context->rpc_codec;
+
+    Mount__FhStatus *fhstatus = mount_directory_success(rpc_connection_context, "/nfs_share");
+
+    Nfs__FHandle fhandle = NFS__FHANDLE__INIT;
+    NfsFh__NfsFileHandle nfs_filehandle_copy = deep_copy_nfs_filehandle(fhstatus->directory->nfs_filehandle);
+    mount__fh_status__free_unpacked(fhstatus, NULL);
+    fhandle.nfs_filehandle = &nfs_filehandle_copy;
+
+    Nfs__FileName file_name = NFS__FILE_NAME__INIT;
+    file_name.filename = NONEXISTENT_FILENAME;
+    Nfs__DirOpArgs diropargs = NFS__DIR_OP_ARGS__INIT;
+    diropargs.dir = &fhandle;
+    diropargs.name = &file_name;
+
+    // the LOOKUP fails, so neither GETATTR runs
+    Nfs__CompoundOp operations[4];
+    init_compound_operation(&operations[0], codec, NFSPROC_GETATTR, &fhandle.base, true);
+    init_compound_operation(&operations[1], codec, NFSPROC_LOOKUP, &diropargs.base, true);
+    init_compound_operation(&operations[2], codec, NFSPROC_GETATTR, &fhandle.base, true);
+    init_compound_operation(&operations[3], codec, NFSPROC_GETATTR, &fhandle.base, false);
+    Nfs__CompoundOp *operation_pointers[4] = {&operations[0], &operations[1], &operations[2], &operations[3]};
+
+    Nfs__CompoundArgs compoundargs = NFS__COMPOUND_ARGS__INIT;
+    compoundargs.fhandle = &fhandle;
+    compoundargs.n_operations = 4;
+    compoundargs.operations = operation_pointers;
+
+    Nfs__CompoundRes *compoundres =
+        compound_success(rpc_connection_context, compoundargs, NFS__STAT__NFSERR_NOENT, 2);
+    free_compound_operations(operations, 4);
+
+    cr_assert_eq(compoundres->results[0]->nfs_status->stat, NFS__STAT__NFS_OK);
+    cr_assert_eq(compoundres->results[1]->nfs_status->stat, NFS__STAT__NFSERR_NOENT);
+
+    nfs__compound_res__free_unpacked(compoundres, NULL);
+
+    free_rpc_connection_context(rpc_connection_context);
+}
+
+Test(nfs_compound_test_suite, compound_unsupported_procedure,
+     .description = "NFSPROC_COMPOUND unsupported procedure") {
+    RpcConnectionContext *rpc_connection_context = create_test_rpc_connection_context(TEST_TRANSPORT_PROTOCOL);
+    if (rpc_connection_context == NULL) {
+        cr_fatal("compound_unsupported_procedure: Failed to connect to the server\n");
+    }
+    RpcCodec codec = rpc_connection_context->rpc_codec;
+
+    Mount__FhStatus *fhstatus = mount_directory_success(rpc_connection_context, "/nfs_share");
+
+    Nfs__FHandle fhandle = NFS__FHANDLE__INIT;
+    NfsFh__NfsFileHandle nfs_filehandle_copy = deep_copy_nfs_filehandle(fhstatus->directory->nfs_filehandle);
+    mount__fh_status__free_unpacked(fhstatus, NULL);
+    fhandle.nfs_filehandle = &nfs_filehandle_copy;
+
+    // the operations are all checked before any is run, so the GETATTR in front doesn't make it run
+    Nfs__CompoundOp operations[2];
+    init_compound_operation(&operations[0], codec, NFSPROC_GETATTR, &fhandle.base, false);
+    init_compound_operation(&operations[1], codec, NFSPROC_WRITECACHE, &fhandle.base, false);
+    Nfs__CompoundOp *operation_pointers[2] = {&operations[0], &operations[1]};
+
+    Nfs__CompoundArgs compoundargs = NFS__COMPOUND_ARGS__INIT;
+    compoundargs.fhandle = &fhandle;
+    compoundargs.n_operations = 2;
+    compoundargs.operations = operation_pointers;
+
+    compound_garbage_args(rpc_connection_context, &compoundargs);
+
+    // nor can a procedure outside of the Nfs program be run
+    free(operations[1].parameters.data);
+    init_compound_operation(&operations[1], codec, NFSPROC_READDIR2 + 1, &fhandle.base, false);
+
+    compound_garbage_args(rpc_connection_context, &compoundargs);
+
+    free_compound_operations(operations, 2);
+
+    free_rpc_connection_context(rpc_connection_context);
+}
+
+Test(nfs_compound_test_suite, compound_bulk_procedure,
+     .description = "NFSPROC_COMPOUND READ, WRITE and READDIR operations") {
+    RpcConnectionContext *rpc_connection_context = create_test_rpc_connection_context(TEST_TRANSPORT_PROTOCOL);
+    if (rpc_connection_context == NULL) {
+        cr_fatal("compound_bulk_procedure: Failed to connect to the server\n");
+    }
+    RpcCodec codec = rpc_connection_context->rpc_codec;
+
+    Mount__FhStatus *fhstatus = mount_directory_success(rpc_connection_context, "/nfs_share");
+
+    Nfs__FHandle fhandle = NFS__FHANDLE__INIT;
+    NfsFh__NfsFileHandle nfs_filehandle_copy = deep_copy_nfs_filehandle(fhstatus->directory->nfs_filehandle);
+    mount__fh_status__free_unpacked(fhstatus, NULL);
+    fhandle.nfs_filehandle = &nfs_filehandle_copy;
+
+    // operations whose results can be large would let a single COMPOUND build an arbitrarily large reply
+    Nfs__ReadArgs readargs = NFS__READ_ARGS__INIT;
+    readargs.file = &fhandle;
+    readargs.count = NFS_MAXDATA;
+
+    Nfs__WriteArgs writeargs = NFS__WRITE_ARGS__INIT;
+    writeargs.file = &fhandle;
+
+    Nfs__NfsCookie nfs_cookie = NFS__NFS_COOKIE__INIT;
+    Nfs__ReadDirArgs readdirargs = NFS__READ_DIR_ARGS__INIT;
+    readdirargs.dir = &fhandle;
+    readdirargs.cookie = &nfs_cookie;
+    readdirargs.count = NFS_MAXDATA;
+
+    struct {
+        uint32_t procedure;
+        ProtobufCMessage *parameters;
+    } bulk_operations[] = {{NFSPROC_READ, &readargs.base},
+                           {NFSPROC_WRITE, &writeargs.base},
+                           {NFSPROC_READDIR, &readdirargs.base},
+                           {NFSPROC_READDIRPLUS, &readdirargs.base},
+                           {NFSPROC_READDIR2, &readdirargs.base}};
+    for (size_t i = 0; i < sizeof(bulk_operations) / sizeof(bulk_operations[0]); i++) {
+        Nfs__CompoundOp operation;
+        init_compound_operation(&operation, codec, bulk_operations[i].procedure, bulk_operations[i].parameters,
+                                false);
+        Nfs__CompoundOp *operation_pointers[1] = {&operation};
+
+        Nfs__CompoundArgs compoundargs = NFS__COMPOUND_ARGS__INIT;
+        compoundargs.fhandle = &fhandle;
+        compoundargs.n_operations = 1;
+        compoundargs.operations = operation_pointers;
+
+        compound_garbage_args(rpc_connection_context, &compoundargs);
+
+        free_compound_operations(&operation, 1);
+    }
+
+    free_rpc_connection_context(rpc_connection_context);
+}
+
+Test(nfs_compound_test_suite, compound_nested_compound, .description = "NFSPROC_COMPOUND nested COMPOUND") {
+    RpcConnectionContext *rpc_connection_context = create_test_rpc_connection_context(TEST_TRANSPORT_PROTOCOL);
+    if (rpc_connection_context == NULL) {
+        cr_fatal("compound_nested_compound: Failed to connect to the server\n");
+    }
+    RpcCodec codec = rpc_connection_context->rpc_codec;
+
+    Mount__FhStatus *fhstatus = mount_directory_success(rpc_connection_context, "/nfs_share");
+
+    Nfs__FHandle fhandle = NFS__FHANDLE__INIT;
+    NfsFh__NfsFileHandle nfs_filehandle_copy = deep_copy_nfs_filehandle(fhstatus->directory->nfs_filehandle);
+    mount__fh_status__free_unpacked(fhstatus, NULL);
+    fhandle.nfs_filehandle = &nfs_filehandle_copy;
+
+    // a COMPOUND with a single GETATTR, run as an operation of another COMPOUND
+    Nfs__CompoundOp nested_operation;
+    init_compound_operation(&nested_operation, codec, NFSPROC_GETATTR, &fhandle.base, false);
+    Nfs__CompoundOp *nested_operation_pointers[1] = {&nested_operation};
+
+    Nfs__CompoundArgs nested_compoundargs = NFS__COMPOUND_ARGS__INIT;
+    nested_compoundargs.fhandle = &fhandle;
+    nested_compoundargs.n_operations = 1;
+    nested_compoundargs.operations = nested_operation_pointers;
+
+    Nfs__CompoundOp operation;
+    init_compound_operation(&operation, codec, NFSPROC_COMPOUND, &nested_compoundargs.base, false);
+    free_compound_operations(&nested_operation, 1);
+    Nfs__CompoundOp *operation_pointers[1] = {&operation};
+
+    Nfs__CompoundArgs compoundargs = NFS__COMPOUND_ARGS__INIT;
+    compoundargs.fhandle = &fhandle;
+    compoundargs.n_operations = 1;
+    compoundargs.operations = operation_pointers;
+
+    compound_garbage_args(rpc_connection_context, &compoundargs);
+
+    free_compound_operations(&operation, 1);
+
+    free_rpc_connection_context(rpc_connection_context);
+}
+
+Test(nfs_compound_test_suite, compound_max_operations, .description = "NFSPROC_COMPOUND maximum number of operations") {
+    RpcConnectionContext *rpc_connection_context = create_test_rpc_connection_context(TEST_TRANSPORT_PROTOCOL);
+    if (rpc_connection_context == NULL) {
+        cr_fatal("compound_max_operations: Failed to connect to the server\n");
+    }
+    RpcCodec codec = rpc_connection_context->rpc_codec;
+
+    Mount__FhStatus *fhstatus = mount_directory_success(rpc_connection_context, "/nfs_share");
+
+    Nfs__FHandle fhandle = NFS__FHANDLE__INIT;
+    NfsFh__NfsFileHandle nfs_filehandle_copy = deep_copy_nfs_filehandle(fhstatus->directory->nfs_filehandle);
+    mount__fh_status__free_unpacked(fhstatus, NULL);
+    fhandle.nfs_filehandle = &nfs_filehandle_copy;
+
+    // one GETATTR more than the maximum
+    Nfs__CompoundOp operations[NFS_MAX_COMPOUND_OPERATIONS + 1];
+    Nfs__CompoundOp *operation_pointers[NFS_MAX_COMPOUND_OPERATIONS + 1];
+    for (int i = 0; i < NFS_MAX_COMPOUND_OPERATIONS + 1; i++) {
+        init_compound_operation(&operations[i], codec, NFSPROC_GETATTR, &fhandle.base, false);
+        operation_pointers[i] = &operations[i];
+    }
+
+    Nfs__CompoundArgs compoundargs = NFS__COMPOUND_ARGS__INIT;
+    compoundargs.fhandle = &fhandle;
+    compoundargs.n_operations = NFS_MAX_COMPOUND_OPERATIONS + 1;
+    compoundargs.operations = operation_pointers;
+
+    compound_garbage_args(rpc_connection_context, &compoundargs);
+
+    // the maximum number of operations is run in full
+    compoundargs.n_operations = NFS_MAX_COMPOUND_OPERATIONS;
+
+    Nfs__CompoundRes *compoundres =
+        compound_success(rpc_connection_context, compoundargs, NFS__STAT__NFS_OK, NFS_MAX_COMPOUND_OPERATIONS);
+    nfs__compound_res__free_unpacked(compoundres, NULL);
+
+    free_compound_operations(operations, NFS_MAX_COMPOUND_OPERATIONS + 1);
+
+    free_rpc_connection_context(rpc_connection_context);
+}
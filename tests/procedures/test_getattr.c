@@ -1,4 +1,5 @@
 #include "tests/test_common.h"
+#include <pthread.h>
 #include <stdio.h>
 /*
  * NFSPROC_GETATTR (1) tests
@@ -50,3 +51,81 @@ Test(nfs_getattr_test_suite, getattr_no_such_file_or_directory,
 
     free_rpc_connection_context(rpc_connection_context);
 }
+
+#define NUM_CONCURRENT_GETATTRS 8
+
+typedef struct ConcurrentGetattr {
+    RpcConnectionContext *rpc_connection_context;
+    Nfs__FHandle fhandle;
+    pthread_barrier_t *barrier;
+
+    int error_code;
+    Nfs__Stat status;
+    Nfs__FType ftype;
+} ConcurrentGetattr;
+
+static void *get_attributes_concurrently(void *argp) {
+    ConcurrentGetattr *concurrent_getattr = argp;
+
+    // all threads send their calls at once, so they go back to back on the connection
+    pthread_barrier_wait(concurrent_getattr->barrier);
+
+    Nfs__AttrStat *attrstat = malloc(sizeof(Nfs__AttrStat));
+    concurrent_getattr->error_code = nfs_procedure_1_get_file_attributes(
+        concurrent_getattr->rpc_connection_context, concurrent_getattr->fhandle, attrstat);
+    if (concurrent_getattr->error_code != 0) {
+        free(attrstat);
+        return NULL;
+    }
+
+    concurrent_getattr->status = attrstat->nfs_status->stat;
+    if (attrstat->nfs_status->stat == NFS__STAT__NFS_OK) {
+        concurrent_getattr->ftype = attrstat->attributes->nfs_ftype->ftype;
+    }
+    nfs__attr_stat__free_unpacked(attrstat, NULL);
+
+    return NULL;
+}
+
+Test(nfs_getattr_test_suite, getattr_concurrent_calls,
+     .description = "NFSPROC_GETATTR concurrent calls on one connection") {
+    RpcConnectionContext *rpc_connection_context = create_test_rpc_connection_context(TEST_TRANSPORT_PROTOCOL);
+    if (rpc_connection_context == NULL) {
+        cr_fatal("getattr_concurrent_calls: Failed to connect to the server\n");
+    }
+
+    Mount__FhStatus *fhstatus = mount_directory_success(rpc_connection_context, "/nfs_share");
+
+    Nfs__FHandle fhandle = NFS__FHANDLE__INIT;
+    NfsFh__NfsFileHandle nfs_filehandle_copy = deep_copy_nfs_filehandle(fhstatus->directory->nfs_filehandle);
+    mount__fh_status__free_unpacked(fhstatus, NULL);
+    fhandle.nfs_filehandle = &nfs_filehandle_copy;
+
+    // over QUIC with QUIC_PIPELINED_SMALL_RPCS (make test-quic-pipelined), these small calls go back to back on a single
+    // stream, and otherwise each takes its own stream
+    pthread_barrier_t barrier;
+    pthread_barrier_init(&barrier, NULL, NUM_CONCURRENT_GETATTRS);
+
+    pthread_t threads[NUM_CONCURRENT_GETATTRS];
+    ConcurrentGetattr concurrent_getattrs[NUM_CONCURRENT_GETATTRS];
+    for (int i = 0; i < NUM_CONCURRENT_GETATTRS; i++) {
+        concurrent_getattrs[i].rpc_connection_context = rpc_connection_context;
+        concurrent_getattrs[i].fhandle = fhandle;
+        concurrent_getattrs[i].barrier = &barrier;
+        concurrent_getattrs[i].error_code = -1;
+
+        cr_assert_eq(pthread_create(&threads[i], NULL, get_attributes_concurrently, &concurrent_getattrs[i]), 0);
+    }
+    for (int i = 0; i < NUM_CONCURRENT_GETATTRS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    pthread_barrier_destroy(&barrier);
+
+    for (int i = 0; i < NUM_CONCURRENT_GETATTRS; i++) {
+        cr_assert_eq(concurrent_getattrs[i].error_code, 0);
+        cr_assert_eq(concurrent_getattrs[i].status, NFS__STAT__NFS_OK);
+        cr_assert_eq(concurrent_getattrs[i].ftype, NFS__FTYPE__NFDIR);
+    }
+
+    free_rpc_connection_context(rpc_connection_context);
+}
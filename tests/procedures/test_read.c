@@ -1,5 +1,8 @@
 #include "tests/test_common.h"
 
+#include "src/common_rpc/rpc_codec.h"
+#include "src/common_rpc/rpc_compression.h"
+
 /*
  * NFSPROC_READ (6) tests
  */
@@ -100,15 +103,17 @@ Test(nfs_read_test_suite, read_more_than_maxdata_bytes, .description = "NFSPROC_
     Nfs__DirOpRes *diropres =
         lookup_file_or_directory_success(rpc_connection_context, &fhandle, "large_file.txt", NFS__FTYPE__NFREG);
 
-    // try to read NFS_MAXDATA + 20 bytes from this large_file.txt
+    // try to read NFS_MAX_TRANSFER_SIZE + 20 bytes from this large_file.txt
     Nfs__FHandle file_fhandle = NFS__FHANDLE__INIT;
     NfsFh__NfsFileHandle file_nfs_filehandle_copy = deep_copy_nfs_filehandle(diropres->diropok->file->nfs_filehandle);
     file_fhandle.nfs_filehandle = &file_nfs_filehandle_copy;
 
-    uint8_t *expected_read_content = malloc(sizeof(uint8_t) * NFS_MAXDATA); // expect to read NFS_MAXDATA zeros
-    memset(expected_read_content, 0, NFS_MAXDATA);
-    Nfs__ReadRes *readres = read_from_file_success(rpc_connection_context, &file_fhandle, 0, NFS_MAXDATA + 20,
-                                                   diropres->diropok->attributes, NFS_MAXDATA, expected_read_content);
+    // expect to read NFS_MAX_TRANSFER_SIZE zeros
+    uint8_t *expected_read_content = malloc(sizeof(uint8_t) * NFS_MAX_TRANSFER_SIZE);
+    memset(expected_read_content, 0, NFS_MAX_TRANSFER_SIZE);
+    Nfs__ReadRes *readres =
+        read_from_file_success(rpc_connection_context, &file_fhandle, 0, NFS_MAX_TRANSFER_SIZE + 20,
+                               diropres->diropok->attributes, NFS_MAX_TRANSFER_SIZE, expected_read_content);
     nfs__dir_op_res__free_unpacked(diropres, NULL);
 
     nfs__read_res__free_unpacked(readres, NULL);
@@ -118,6 +123,128 @@ Test(nfs_read_test_suite, read_more_than_maxdata_bytes, .description = "NFSPROC_
     free_rpc_connection_context(rpc_connection_context);
 }
 
+/*
+ * Compression tests - only the protobuf codec carries compressed data
+ */
+
+#define COMPRESSION_TEST_DATA_SIZE NFS_MAXDATA
+
+/*
+ * Calls NFSPROC_READ with the given parameters over the test transport protocol, and returns the ReadRes in the reply
+ * as the server sent it, without decompressing its data.
+ *
+ * The user of this function takes the responsibility to free the returned ReadRes with 'nfs__read_res__free_unpacked'.
+ */
+static Nfs__ReadRes *call_read_procedure(RpcConnectionContext *rpc_connection_context, Nfs__ReadArgs *readargs) {
+    RpcCodec codec = rpc_connection_context->rpc_codec;
+
+    size_t readargs_size = get_rpc_payload_packed_size(codec, &readargs->base);
+    uint8_t *readargs_buffer = malloc(readargs_size);
+    cr_assert_not_null(readargs_buffer);
+    pack_rpc_payload(codec, &readargs->base, readargs_buffer);
+
+    Google__Protobuf__Any parameters = GOOGLE__PROTOBUF__ANY__INIT;
+    parameters.type_url = "nfs/ReadArgs";
+    parameters.value.data = readargs_buffer;
+    parameters.value.len = readargs_size;
+
+    Rpc__RpcMsg *rpc_reply;
+    switch (rpc_connection_context->transport_protocol) {
+    case TRANSPORT_PROTOCOL_QUIC:
+        rpc_reply = invoke_rpc_remote_quic(rpc_connection_context, NFS_RPC_PROGRAM_NUMBER, NFS_VERSION_LOW,
+                                           NFSPROC_READ, parameters, true);
+        break;
+    case TRANSPORT_PROTOCOL_SHM:
+        rpc_reply = invoke_rpc_remote_shm(rpc_connection_context, NFS_RPC_PROGRAM_NUMBER, NFS_VERSION_LOW,
+                                          NFSPROC_READ, parameters);
+        break;
+    case TRANSPORT_PROTOCOL_TCP:
+    case TRANSPORT_PROTOCOL_TLS:
+    default:
+        rpc_reply = invoke_rpc_remote_tcp(rpc_connection_context, NFS_RPC_PROGRAM_NUMBER, NFS_VERSION_LOW,
+                                          NFSPROC_READ, parameters);
+    }
+    free(readargs_buffer);
+
+    cr_assert_eq(validate_successful_accepted_reply(rpc_reply), 0);
+    Google__Protobuf__Any *results = rpc_reply->rbody->areply->results;
+    cr_assert_str_eq(results->type_url, "nfs/ReadRes");
+
+    Nfs__ReadRes *readres =
+        unpack_rpc_payload(codec, &nfs__read_res__descriptor, NULL, results->value.len, results->value.data);
+    cr_assert_not_null(readres);
+    rpc__rpc_msg__free_unpacked(rpc_reply, NULL);
+
+    return readres;
+}
+
+Test(nfs_read_test_suite, read_compressed_ok, .description = "NFSPROC_READ ok with compressed nfsdata") {
+    RpcConnectionContext *rpc_connection_context = create_test_rpc_connection_context(TEST_TRANSPORT_PROTOCOL);
+    if (rpc_connection_context == NULL) {
+        cr_fatal("read_compressed_ok: Failed to connect to the server\n");
+    }
+    if (rpc_connection_context->rpc_codec != RPC_CODEC_PROTOBUF || !is_rpc_compression_supported(RPC_COMPRESSION_LZ4)) {
+        free_rpc_connection_context(rpc_connection_context);
+        cr_skip_test("compression is not sent with this codec and build\n");
+    }
+
+    Mount__FhStatus *fhstatus = mount_directory_success(rpc_connection_context, "/nfs_share");
+
+    // lookup the large_file.txt inside the mounted directory, which holds nothing but zeros
+    Nfs__FHandle fhandle = NFS__FHANDLE__INIT;
+    NfsFh__NfsFileHandle nfs_filehandle_copy = deep_copy_nfs_filehandle(fhstatus->directory->nfs_filehandle);
+    mount__fh_status__free_unpacked(fhstatus, NULL);
+    fhandle.nfs_filehandle = &nfs_filehandle_copy;
+
+    Nfs__DirOpRes *diropres =
+        lookup_file_or_directory_success(rpc_connection_context, &fhandle, "large_file.txt", NFS__FTYPE__NFREG);
+
+    Nfs__FHandle file_fhandle = NFS__FHANDLE__INIT;
+    NfsFh__NfsFileHandle file_nfs_filehandle_copy = deep_copy_nfs_filehandle(diropres->diropok->file->nfs_filehandle);
+    file_fhandle.nfs_filehandle = &file_nfs_filehandle_copy;
+
+    uint8_t *expected_read_content = calloc(COMPRESSION_TEST_DATA_SIZE, sizeof(uint8_t));
+
+    RpcCompression compressions[] = {RPC_COMPRESSION_LZ4, RPC_COMPRESSION_ZSTD};
+    for (size_t i = 0; i < sizeof(compressions) / sizeof(compressions[0]); i++) {
+        Nfs__ReadArgs readargs = NFS__READ_ARGS__INIT;
+        readargs.file = &file_fhandle;
+        readargs.offset = 0;
+        readargs.count = COMPRESSION_TEST_DATA_SIZE;
+        readargs.accepted_compression = compressions[i];
+
+        // the server sends the zeros compressed with the compression the client accepts
+        Nfs__ReadRes *readres = call_read_procedure(rpc_connection_context, &readargs);
+        cr_assert_eq(readres->nfs_status->stat, NFS__STAT__NFS_OK);
+        cr_assert_eq(readres->body_case, NFS__READ_RES__BODY_READRESBODY);
+        cr_assert_eq(readres->readresbody->compression, compressions[i]);
+        cr_assert_eq(readres->readresbody->uncompressed_size, COMPRESSION_TEST_DATA_SIZE);
+        cr_assert_lt(readres->readresbody->nfsdata.len, COMPRESSION_TEST_DATA_SIZE);
+
+        uint8_t *read_content = malloc(COMPRESSION_TEST_DATA_SIZE);
+        cr_assert_eq(decompress_rpc_payload_data(compressions[i], readres->readresbody->nfsdata.data,
+                                                 readres->readresbody->nfsdata.len, read_content,
+                                                 COMPRESSION_TEST_DATA_SIZE),
+                     0);
+        cr_assert_arr_eq(read_content, expected_read_content, COMPRESSION_TEST_DATA_SIZE);
+        free(read_content);
+        nfs__read_res__free_unpacked(readres, NULL);
+
+        // and the client hands the data back decompressed
+        rpc_connection_context->payload_compression = compressions[i];
+        readres = read_from_file_success(rpc_connection_context, &file_fhandle, 0, COMPRESSION_TEST_DATA_SIZE,
+                                         diropres->diropok->attributes, COMPRESSION_TEST_DATA_SIZE,
+                                         expected_read_content);
+        cr_assert_eq(readres->readresbody->compression, RPC_COMPRESSION_NONE);
+        nfs__read_res__free_unpacked(readres, NULL);
+    }
+    nfs__dir_op_res__free_unpacked(diropres, NULL);
+
+    free(expected_read_content);
+
+    free_rpc_connection_context(rpc_connection_context);
+}
+
 /*
  * Permission tests
  */
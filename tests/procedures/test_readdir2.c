@@ -0,0 +1,226 @@
+#include "tests/test_common.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/*
+ * NFSPROC_READDIR2 (20) tests
+ */
+
+TestSuite(nfs_readdir2_test_suite);
+
+/*
+ * Calls NFSPROC_READDIR2 on the given directory and checks that it succeeds, and that the entries in the results are
+ * laid out as READDIR2 lays them out - one fileid, cookie and name offset per entry, and the NUL-terminated names back
+ * to back in 'names' at those offsets.
+ *
+ * The user of this function takes the responsibility to free the returned ReadDir2Res with
+ * 'nfs__read_dir2_res__free_unpacked'.
+ */
+static Nfs__ReadDir2Res *read_from_directory_2_success(RpcConnectionContext *rpc_connection_context,
+                                                       Nfs__FHandle *directory_fhandle, uint64_t cookie,
+                                                       uint32_t byte_count) {
+    Nfs__NfsCookie nfs_cookie = NFS__NFS_COOKIE__INIT;
+    nfs_cookie.value = cookie;
+
+    Nfs__ReadDirArgs readdirargs = NFS__READ_DIR_ARGS__INIT;
+    readdirargs.dir = directory_fhandle;
+    readdirargs.cookie = &nfs_cookie;
+    readdirargs.count = byte_count;
+
+    Nfs__ReadDir2Res *readdir2res = malloc(sizeof(Nfs__ReadDir2Res));
+    int status = nfs_procedure_20_read_from_directory_2(rpc_connection_context, readdirargs, readdir2res);
+    if (status != 0) {
+        free(readdir2res);
+        cr_fatal("NFSPROC_READDIR2 failed - status %d\n", status);
+    }
+
+    cr_assert_not_null(readdir2res->nfs_status);
+    cr_assert_eq(readdir2res->nfs_status->stat, NFS__STAT__NFS_OK);
+    cr_assert_eq(readdir2res->body_case, NFS__READ_DIR2_RES__BODY_READDIR2OK);
+    cr_assert_not_null(readdir2res->readdir2ok);
+
+    Nfs__ReadDir2Ok *readdir2ok = readdir2res->readdir2ok;
+    cr_assert_gt(readdir2ok->n_fileids, 0); // the client always makes progress
+    cr_assert_eq(readdir2ok->n_cookies, readdir2ok->n_fileids);
+    cr_assert_eq(readdir2ok->n_name_offsets, readdir2ok->n_fileids);
+
+    size_t next_name_offset = 0;
+    for (size_t i = 0; i < readdir2ok->n_name_offsets; i++) {
+        cr_assert_eq(readdir2ok->name_offsets[i], next_name_offset);
+
+        char *name = (char *)readdir2ok->names.data + readdir2ok->name_offsets[i];
+        size_t name_size = strnlen(name, readdir2ok->names.len - readdir2ok->name_offsets[i]) + 1;
+        cr_assert_leq(readdir2ok->name_offsets[i] + name_size, readdir2ok->names.len); // NUL-terminated
+        next_name_offset += name_size;
+    }
+    cr_assert_eq(next_name_offset, readdir2ok->names.len);
+
+    return readdir2res;
+}
+
+static char *get_read_dir2_ok_name(Nfs__ReadDir2Ok *readdir2ok, size_t i) {
+    return (char *)readdir2ok->names.data + readdir2ok->name_offsets[i];
+}
+
+/*
+ * Checks that the given filename is among the 'expected_filenames' not seen yet, and marks it as seen.
+ */
+static void mark_filename_seen(char *filename, char *expected_filenames[], int expected_number_of_entries) {
+    for (int i = 0; i < expected_number_of_entries; i++) {
+        if (expected_filenames[i] != NULL && strcmp(filename, expected_filenames[i]) == 0) {
+            expected_filenames[i] = NULL;
+            return;
+        }
+    }
+
+    cr_assert_fail("Entry '%s' in procedure results is not among expected directory entries", filename);
+}
+
+/*
+ * Looks up the /nfs_share/readdir_test directory, and places its filehandle in 'directory_nfs_filehandle'.
+ */
+static void lookup_readdir_test_directory(RpcConnectionContext *rpc_connection_context,
+                                          NfsFh__NfsFileHandle *directory_nfs_filehandle) {
+    Mount__FhStatus *fhstatus = mount_directory_success(rpc_connection_context, "/nfs_share");
+
+    Nfs__FHandle fhandle = NFS__FHANDLE__INIT;
+    NfsFh__NfsFileHandle nfs_filehandle_copy = deep_copy_nfs_filehandle(fhstatus->directory->nfs_filehandle);
+    mount__fh_status__free_unpacked(fhstatus, NULL);
+    fhandle.nfs_filehandle = &nfs_filehandle_copy;
+
+    Nfs__DirOpRes *diropres =
+        lookup_file_or_directory_success(rpc_connection_context, &fhandle, "readdir_test", NFS__FTYPE__NFDIR);
+    *directory_nfs_filehandle = deep_copy_nfs_filehandle(diropres->diropok->file->nfs_filehandle);
+    nfs__dir_op_res__free_unpacked(diropres, NULL);
+}
+
+Test(nfs_readdir2_test_suite, readdir2_ok, .description = "NFSPROC_READDIR2 ok") {
+    RpcConnectionContext *rpc_connection_context = create_test_rpc_connection_context(TEST_TRANSPORT_PROTOCOL);
+    if (rpc_connection_context == NULL) {
+        cr_fatal("readdir2_ok: Failed to connect to the server\n");
+    }
+
+    Mount__FhStatus *fhstatus = mount_directory_success(rpc_connection_context, "/nfs_share");
+
+    Nfs__FHandle fhandle = NFS__FHANDLE__INIT;
+    NfsFh__NfsFileHandle nfs_filehandle_copy = deep_copy_nfs_filehandle(fhstatus->directory->nfs_filehandle);
+    mount__fh_status__free_unpacked(fhstatus, NULL);
+    fhandle.nfs_filehandle = &nfs_filehandle_copy;
+
+    Nfs__ReadDir2Res *readdir2res = read_from_directory_2_success(rpc_connection_context, &fhandle, 0, NFS_MAXDATA);
+    Nfs__ReadDir2Ok *readdir2ok = readdir2res->readdir2ok;
+    cr_assert_eq(readdir2ok->eof, 1);
+    cr_assert_eq(readdir2ok->n_fileids, NFS_SHARE_NUMBER_OF_ENTRIES);
+
+    char *expected_filenames[NFS_SHARE_NUMBER_OF_ENTRIES] = NFS_SHARE_ENTRIES;
+    for (size_t i = 0; i < readdir2ok->n_fileids; i++) {
+        mark_filename_seen(get_read_dir2_ok_name(readdir2ok, i), expected_filenames, NFS_SHARE_NUMBER_OF_ENTRIES);
+    }
+
+    // the entries are the same, in the same order, as the ones READDIR gives
+    char *readdir_expected_filenames[NFS_SHARE_NUMBER_OF_ENTRIES] = NFS_SHARE_ENTRIES;
+    Nfs__ReadDirRes *readdirres = read_from_directory_success(
+        rpc_connection_context, &fhandle, 0, NFS_MAXDATA, NFS_SHARE_NUMBER_OF_ENTRIES, readdir_expected_filenames);
+    cr_assert_eq(readdirres->readdirok->eof, 1);
+
+    size_t i = 0;
+    for (Nfs__DirectoryEntriesList *entry = readdirres->readdirok->entries; entry != NULL; entry = entry->nextentry) {
+        cr_assert_lt(i, readdir2ok->n_fileids);
+        cr_assert_str_eq(get_read_dir2_ok_name(readdir2ok, i), entry->name->filename);
+        cr_assert_eq(readdir2ok->fileids[i], entry->fileid);
+        cr_assert_eq(readdir2ok->cookies[i], entry->cookie->value);
+        i++;
+    }
+    cr_assert_eq(i, readdir2ok->n_fileids);
+
+    nfs__read_dir_res__free_unpacked(readdirres, NULL);
+    nfs__read_dir2_res__free_unpacked(readdir2res, NULL);
+
+    free_rpc_connection_context(rpc_connection_context);
+}
+
+Test(nfs_readdir2_test_suite, readdir2_ok_read_directory_entries_in_batches,
+     .description = "NFSPROC_READDIR2 ok read directory entries in batches") {
+    RpcConnectionContext *rpc_connection_context = create_test_rpc_connection_context(TEST_TRANSPORT_PROTOCOL);
+    if (rpc_connection_context == NULL) {
+        cr_fatal("readdir2_ok_read_directory_entries_in_batches: Failed to connect to the server\n");
+    }
+
+    Nfs__FHandle directory_fhandle = NFS__FHANDLE__INIT;
+    NfsFh__NfsFileHandle directory_nfs_filehandle;
+    lookup_readdir_test_directory(rpc_connection_context, &directory_nfs_filehandle);
+    directory_fhandle.nfs_filehandle = &directory_nfs_filehandle;
+
+    int expected_number_of_entries = READDIR_TEST_NUMBER_OF_FILES + 2;
+    char filenames[READDIR_TEST_NUMBER_OF_FILES + 2][NFS_MAXNAMLEN];
+    char *expected_filenames[READDIR_TEST_NUMBER_OF_FILES + 2];
+    for (int i = 0; i < READDIR_TEST_NUMBER_OF_FILES; i++) {
+        snprintf(filenames[i], NFS_MAXNAMLEN, "readdir_test_file_%d.txt", i + 1);
+        expected_filenames[i] = filenames[i];
+    }
+    expected_filenames[READDIR_TEST_NUMBER_OF_FILES] = ".";
+    expected_filenames[READDIR_TEST_NUMBER_OF_FILES + 1] = "..";
+
+    // every call resumes from the last cookie of the one before, and only the last one reaches the end
+    uint64_t cookie = 0;
+    int eof = 0;
+    int number_of_calls = 0, directory_entries_seen = 0;
+    while (eof != 1) {
+        Nfs__ReadDir2Res *readdir2res =
+            read_from_directory_2_success(rpc_connection_context, &directory_fhandle, cookie, 256);
+        Nfs__ReadDir2Ok *readdir2ok = readdir2res->readdir2ok;
+        number_of_calls++;
+
+        for (size_t i = 0; i < readdir2ok->n_fileids; i++) {
+            mark_filename_seen(get_read_dir2_ok_name(readdir2ok, i), expected_filenames, expected_number_of_entries);
+            directory_entries_seen++;
+        }
+        cookie = readdir2ok->cookies[readdir2ok->n_cookies - 1];
+        eof = readdir2ok->eof;
+
+        nfs__read_dir2_res__free_unpacked(readdir2res, NULL);
+
+        cr_assert_leq(directory_entries_seen, expected_number_of_entries);
+    }
+
+    cr_assert_eq(directory_entries_seen, expected_number_of_entries);
+    cr_assert_gt(number_of_calls, 1);
+
+    free_rpc_connection_context(rpc_connection_context);
+}
+
+Test(nfs_readdir2_test_suite, readdir2_truncated_at_count, .description = "NFSPROC_READDIR2 truncated at count") {
+    RpcConnectionContext *rpc_connection_context = create_test_rpc_connection_context(TEST_TRANSPORT_PROTOCOL);
+    if (rpc_connection_context == NULL) {
+        cr_fatal("readdir2_truncated_at_count: Failed to connect to the server\n");
+    }
+
+    Nfs__FHandle directory_fhandle = NFS__FHANDLE__INIT;
+    NfsFh__NfsFileHandle directory_nfs_filehandle;
+    lookup_readdir_test_directory(rpc_connection_context, &directory_nfs_filehandle);
+    directory_fhandle.nfs_filehandle = &directory_nfs_filehandle;
+
+    // a count too small for any entry still gives one, so that the client makes progress
+    Nfs__ReadDir2Res *readdir2res = read_from_directory_2_success(rpc_connection_context, &directory_fhandle, 0, 1);
+    cr_assert_eq(readdir2res->readdir2ok->n_fileids, 1);
+    cr_assert_eq(readdir2res->readdir2ok->eof, 0);
+    nfs__read_dir2_res__free_unpacked(readdir2res, NULL);
+
+    // the names alone never take up more than the count, and a larger count gives more entries
+    size_t previous_number_of_entries = 1;
+    for (uint32_t byte_count = 128; byte_count <= 1024; byte_count *= 2) {
+        readdir2res = read_from_directory_2_success(rpc_connection_context, &directory_fhandle, 0, byte_count);
+        Nfs__ReadDir2Ok *readdir2ok = readdir2res->readdir2ok;
+
+        cr_assert_eq(readdir2ok->eof, 0);
+        cr_assert_lt(readdir2ok->n_fileids, READDIR_TEST_NUMBER_OF_FILES + 2);
+        cr_assert_leq(readdir2ok->names.len, byte_count);
+        cr_assert_gt(readdir2ok->n_fileids, previous_number_of_entries);
+        previous_number_of_entries = readdir2ok->n_fileids;
+
+        nfs__read_dir2_res__free_unpacked(readdir2res, NULL);
+    }
+
+    free_rpc_connection_context(rpc_connection_context);
+}
@@ -0,0 +1,265 @@
+#include "tests/test_common.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "src/common_rpc/rpc_codec.h"
+
+/*
+ * NFSPROC_READDIRPLUS (19) tests
+ */
+
+TestSuite(nfs_readdirplus_test_suite);
+
+/*
+ * Calls NFSPROC_READDIRPLUS on the given directory and checks that it succeeds.
+ *
+ * The user of this function takes the responsibility to free the returned ReadDirPlusRes with
+ * 'nfs__read_dir_plus_res__free_unpacked'.
+ */
+static Nfs__ReadDirPlusRes *read_from_directory_plus_success(RpcConnectionContext *rpc_connection_context,
+                                                             Nfs__FHandle *directory_fhandle, uint64_t cookie,
+                                                             uint32_t byte_count) {
+    Nfs__NfsCookie nfs_cookie = NFS__NFS_COOKIE__INIT;
+    nfs_cookie.value = cookie;
+
+    Nfs__ReadDirArgs readdirargs = NFS__READ_DIR_ARGS__INIT;
+    readdirargs.dir = directory_fhandle;
+    readdirargs.cookie = &nfs_cookie;
+    readdirargs.count = byte_count;
+
+    Nfs__ReadDirPlusRes *readdirplusres = malloc(sizeof(Nfs__ReadDirPlusRes));
+    int status = nfs_procedure_19_read_from_directory_plus(rpc_connection_context, readdirargs, readdirplusres);
+    if (status != 0) {
+        free(readdirplusres);
+        cr_fatal("NFSPROC_READDIRPLUS failed - status %d\n", status);
+    }
+
+    cr_assert_not_null(readdirplusres->nfs_status);
+    cr_assert_eq(readdirplusres->nfs_status->stat, NFS__STAT__NFS_OK);
+    cr_assert_eq(readdirplusres->body_case, NFS__READ_DIR_PLUS_RES__BODY_READDIRPLUSOK);
+    cr_assert_not_null(readdirplusres->readdirplusok);
+
+    return readdirplusres;
+}
+
+/*
+ * Checks that the given filename is among the 'expected_filenames' not seen yet, and marks it as seen.
+ */
+static void mark_filename_seen(char *filename, char *expected_filenames[], int expected_number_of_entries) {
+    for (int i = 0; i < expected_number_of_entries; i++) {
+        if (expected_filenames[i] != NULL && strcmp(filename, expected_filenames[i]) == 0) {
+            expected_filenames[i] = NULL;
+            return;
+        }
+    }
+
+    cr_assert_fail("Entry '%s' in procedure results is not among expected directory entries", filename);
+}
+
+static bool is_dot_or_dot_dot(char *filename) {
+    return strcmp(filename, ".") == 0 || strcmp(filename, "..") == 0;
+}
+
+/*
+ * Looks up the /nfs_share/readdir_test directory, and places its filehandle in 'directory_nfs_filehandle'.
+ */
+static void lookup_readdir_test_directory(RpcConnectionContext *rpc_connection_context,
+                                          NfsFh__NfsFileHandle *directory_nfs_filehandle) {
+    Mount__FhStatus *fhstatus = mount_directory_success(rpc_connection_context, "/nfs_share");
+
+    Nfs__FHandle fhandle = NFS__FHANDLE__INIT;
+    NfsFh__NfsFileHandle nfs_filehandle_copy = deep_copy_nfs_filehandle(fhstatus->directory->nfs_filehandle);
+    mount__fh_status__free_unpacked(fhstatus, NULL);
+    fhandle.nfs_filehandle = &nfs_filehandle_copy;
+
+    Nfs__DirOpRes *diropres =
+        lookup_file_or_directory_success(rpc_connection_context, &fhandle, "readdir_test", NFS__FTYPE__NFDIR);
+    *directory_nfs_filehandle = deep_copy_nfs_filehandle(diropres->diropok->file->nfs_filehandle);
+    nfs__dir_op_res__free_unpacked(diropres, NULL);
+}
+
+Test(nfs_readdirplus_test_suite, readdirplus_ok, .description = "NFSPROC_READDIRPLUS ok") {
+    RpcConnectionContext *rpc_connection_context = create_test_rpc_connection_context(TEST_TRANSPORT_PROTOCOL);
+    if (rpc_connection_context == NULL) {
+        cr_fatal("readdirplus_ok: Failed to connect to the server\n");
+    }
+
+    Mount__FhStatus *fhstatus = mount_directory_success(rpc_connection_context, "/nfs_share");
+
+    Nfs__FHandle fhandle = NFS__FHANDLE__INIT;
+    NfsFh__NfsFileHandle nfs_filehandle_copy = deep_copy_nfs_filehandle(fhstatus->directory->nfs_filehandle);
+    mount__fh_status__free_unpacked(fhstatus, NULL);
+    fhandle.nfs_filehandle = &nfs_filehandle_copy;
+
+    Nfs__ReadDirPlusRes *readdirplusres =
+        read_from_directory_plus_success(rpc_connection_context, &fhandle, 0, NFS_MAXDATA);
+    cr_assert_eq(readdirplusres->readdirplusok->eof, 1);
+
+    char *expected_filenames[NFS_SHARE_NUMBER_OF_ENTRIES] = NFS_SHARE_ENTRIES;
+    int number_of_entries = 0;
+    for (Nfs__DirectoryEntriesPlusList *entry = readdirplusres->readdirplusok->entries; entry != NULL;
+         entry = entry->nextentry) {
+        cr_assert_not_null(entry->name);
+        cr_assert_not_null(entry->cookie);
+        mark_filename_seen(entry->name->filename, expected_filenames, NFS_SHARE_NUMBER_OF_ENTRIES);
+        number_of_entries++;
+
+        // '.' and '..' have neither a filehandle nor attributes, and every other entry has both
+        if (is_dot_or_dot_dot(entry->name->filename)) {
+            cr_assert_null(entry->file);
+            cr_assert_null(entry->attributes);
+        } else {
+            cr_assert_not_null(entry->file);
+            cr_assert_not_null(entry->file->nfs_filehandle);
+            cr_assert_not_null(entry->attributes);
+            cr_assert_eq(entry->attributes->fileid, entry->fileid);
+            cr_assert_eq(entry->file->nfs_filehandle->inode_number, entry->fileid);
+        }
+    }
+    cr_assert_eq(number_of_entries, NFS_SHARE_NUMBER_OF_ENTRIES);
+
+    nfs__read_dir_plus_res__free_unpacked(readdirplusres, NULL);
+
+    free_rpc_connection_context(rpc_connection_context);
+}
+
+Test(nfs_readdirplus_test_suite, readdirplus_filehandles_round_trip,
+     .description = "NFSPROC_READDIRPLUS filehandles round trip through NFSPROC_GETATTR") {
+    RpcConnectionContext *rpc_connection_context = create_test_rpc_connection_context(TEST_TRANSPORT_PROTOCOL);
+    if (rpc_connection_context == NULL) {
+        cr_fatal("readdirplus_filehandles_round_trip: Failed to connect to the server\n");
+    }
+
+    Mount__FhStatus *fhstatus = mount_directory_success(rpc_connection_context, "/nfs_share");
+
+    Nfs__FHandle fhandle = NFS__FHANDLE__INIT;
+    NfsFh__NfsFileHandle nfs_filehandle_copy = deep_copy_nfs_filehandle(fhstatus->directory->nfs_filehandle);
+    mount__fh_status__free_unpacked(fhstatus, NULL);
+    fhandle.nfs_filehandle = &nfs_filehandle_copy;
+
+    Nfs__ReadDirPlusRes *readdirplusres =
+        read_from_directory_plus_success(rpc_connection_context, &fhandle, 0, NFS_MAXDATA);
+
+    bool test_file_seen = false;
+    for (Nfs__DirectoryEntriesPlusList *entry = readdirplusres->readdirplusok->entries; entry != NULL;
+         entry = entry->nextentry) {
+        if (entry->file == NULL) {
+            continue;
+        }
+
+        // the filehandle names the same file as the attributes that came with it
+        Nfs__AttrStat *attrstat =
+            get_attributes_success(rpc_connection_context, *entry->file, entry->attributes->nfs_ftype->ftype);
+        cr_assert_eq(attrstat->attributes->fileid, entry->attributes->fileid);
+        nfs__attr_stat__free_unpacked(attrstat, NULL);
+
+        // and is the same filehandle a LOOKUP of the entry gives
+        if (strcmp(entry->name->filename, "test_file.txt") == 0) {
+            Nfs__DirOpRes *diropres = lookup_file_or_directory_success(rpc_connection_context, &fhandle,
+                                                                       "test_file.txt", NFS__FTYPE__NFREG);
+            cr_assert_eq(diropres->diropok->file->nfs_filehandle->inode_number,
+                         entry->file->nfs_filehandle->inode_number);
+            cr_assert_eq(diropres->diropok->file->nfs_filehandle->timestamp, entry->file->nfs_filehandle->timestamp);
+            cr_assert_eq(diropres->diropok->attributes->size, entry->attributes->size);
+            nfs__dir_op_res__free_unpacked(diropres, NULL);
+
+            test_file_seen = true;
+        }
+    }
+    cr_assert(test_file_seen);
+
+    nfs__read_dir_plus_res__free_unpacked(readdirplusres, NULL);
+
+    free_rpc_connection_context(rpc_connection_context);
+}
+
+Test(nfs_readdirplus_test_suite, readdirplus_ok_read_directory_entries_in_batches,
+     .description = "NFSPROC_READDIRPLUS ok read directory entries in batches") {
+    RpcConnectionContext *rpc_connection_context = create_test_rpc_connection_context(TEST_TRANSPORT_PROTOCOL);
+    if (rpc_connection_context == NULL) {
+        cr_fatal("readdirplus_ok_read_directory_entries_in_batches: Failed to connect to the server\n");
+    }
+
+    Nfs__FHandle directory_fhandle = NFS__FHANDLE__INIT;
+    NfsFh__NfsFileHandle directory_nfs_filehandle;
+    lookup_readdir_test_directory(rpc_connection_context, &directory_nfs_filehandle);
+    directory_fhandle.nfs_filehandle = &directory_nfs_filehandle;
+
+    int expected_number_of_entries = READDIR_TEST_NUMBER_OF_FILES + 2;
+    char filenames[READDIR_TEST_NUMBER_OF_FILES + 2][NFS_MAXNAMLEN];
+    char *expected_filenames[READDIR_TEST_NUMBER_OF_FILES + 2];
+    for (int i = 0; i < READDIR_TEST_NUMBER_OF_FILES; i++) {
+        snprintf(filenames[i], NFS_MAXNAMLEN, "readdir_test_file_%d.txt", i + 1);
+        expected_filenames[i] = filenames[i];
+    }
+    expected_filenames[READDIR_TEST_NUMBER_OF_FILES] = ".";
+    expected_filenames[READDIR_TEST_NUMBER_OF_FILES + 1] = "..";
+
+    // every call resumes from the cookie of the last entry of the one before
+    uint64_t cookie = 0;
+    int eof = 0;
+    int number_of_calls = 0, directory_entries_seen = 0;
+    while (eof != 1) {
+        Nfs__ReadDirPlusRes *readdirplusres =
+            read_from_directory_plus_success(rpc_connection_context, &directory_fhandle, cookie, 1024);
+        number_of_calls++;
+
+        Nfs__DirectoryEntriesPlusList *entry = readdirplusres->readdirplusok->entries;
+        cr_assert_not_null(entry); // the client always makes progress
+        for (; entry != NULL; entry = entry->nextentry) {
+            mark_filename_seen(entry->name->filename, expected_filenames, expected_number_of_entries);
+            directory_entries_seen++;
+
+            cookie = entry->cookie->value;
+        }
+        eof = readdirplusres->readdirplusok->eof;
+
+        nfs__read_dir_plus_res__free_unpacked(readdirplusres, NULL);
+
+        cr_assert_leq(directory_entries_seen, expected_number_of_entries);
+    }
+
+    cr_assert_eq(directory_entries_seen, expected_number_of_entries);
+    cr_assert_gt(number_of_calls, 1);
+
+    free_rpc_connection_context(rpc_connection_context);
+}
+
+Test(nfs_readdirplus_test_suite, readdirplus_count_capped_at_maxdata,
+     .description = "NFSPROC_READDIRPLUS reads at most NFS_MAXDATA bytes of entries") {
+    RpcConnectionContext *rpc_connection_context = create_test_rpc_connection_context(TEST_TRANSPORT_PROTOCOL);
+    if (rpc_connection_context == NULL) {
+        cr_fatal("readdirplus_count_capped_at_maxdata: Failed to connect to the server\n");
+    }
+
+    Nfs__FHandle directory_fhandle = NFS__FHANDLE__INIT;
+    NfsFh__NfsFileHandle directory_nfs_filehandle;
+    lookup_readdir_test_directory(rpc_connection_context, &directory_nfs_filehandle);
+    directory_fhandle.nfs_filehandle = &directory_nfs_filehandle;
+
+    // ask for far more than all the entries take up, which the server doesn't give
+    Nfs__ReadDirPlusRes *readdirplusres =
+        read_from_directory_plus_success(rpc_connection_context, &directory_fhandle, 0, NFS_MAX_TRANSFER_SIZE);
+    cr_assert_eq(readdirplusres->readdirplusok->eof, 0);
+
+    // the server sizes entries by their packed size in the codec of the call
+    size_t total_size = 0;
+    int number_of_entries = 0;
+    for (Nfs__DirectoryEntriesPlusList *entry = readdirplusres->readdirplusok->entries; entry != NULL;
+         entry = entry->nextentry) {
+        Nfs__DirectoryEntriesPlusList *nextentry = entry->nextentry;
+        entry->nextentry = NULL;
+        total_size += get_rpc_payload_packed_size(rpc_connection_context->rpc_codec, &entry->base);
+        entry->nextentry = nextentry;
+
+        number_of_entries++;
+    }
+    cr_assert_gt(number_of_entries, 0);
+    cr_assert_lt(number_of_entries, READDIR_TEST_NUMBER_OF_FILES + 2);
+    cr_assert_leq(total_size, NFS_MAXDATA);
+
+    nfs__read_dir_plus_res__free_unpacked(readdirplusres, NULL);
+
+    free_rpc_connection_context(rpc_connection_context);
+}
@@ -2,6 +2,9 @@
 
 #include <stdio.h>
 
+#include "src/common_rpc/rpc_codec.h"
+#include "src/common_rpc/rpc_compression.h"
+
 /*
  * NFSPROC_WRITE (8) tests
  */
@@ -100,7 +103,8 @@ Test(nfs_write_test_suite, write_is_directory,
     free_rpc_connection_context(rpc_connection_context);
 }
 
-Test(nfs_write_test_suite, write_too_much_data, .description = "NFSPROC_WRITE more than NFS_MAXDATA bytes in nfsdata") {
+Test(nfs_write_test_suite, write_too_much_data,
+     .description = "NFSPROC_WRITE more than NFS_MAX_TRANSFER_SIZE bytes in nfsdata") {
     RpcConnectionContext *rpc_connection_context = create_test_rpc_connection_context(TEST_TRANSPORT_PROTOCOL);
     if (rpc_connection_context == NULL) {
         cr_fatal("write_too_much_data: Failed to connect to the server\n");
@@ -127,17 +131,351 @@ Test(nfs_write_test_suite, write_too_much_data, .description = "NFSPROC_WRITE mo
     Nfs__DirOpRes *diropres = lookup_file_or_directory_success(rpc_connection_context, &write_test_dir_fhandle,
                                                                "write_test_file.txt", NFS__FTYPE__NFREG);
 
-    // try to write 10000 bytes in a single RPC to this write_test_file.txt
+    // try to write NFS_MAX_TRANSFER_SIZE + 20 bytes in a single RPC to this write_test_file.txt
+    Nfs__FHandle file_fhandle = NFS__FHANDLE__INIT;
+    NfsFh__NfsFileHandle file_nfs_filehandle_copy = deep_copy_nfs_filehandle(diropres->diropok->file->nfs_filehandle);
+    nfs__dir_op_res__free_unpacked(diropres, NULL);
+    file_fhandle.nfs_filehandle = &file_nfs_filehandle_copy;
+
+    uint8_t *content = malloc(sizeof(uint8_t) * (NFS_MAX_TRANSFER_SIZE + 20));
+    memset(content, 'a', NFS_MAX_TRANSFER_SIZE + 20);
+    write_to_file_fail(rpc_connection_context, &file_fhandle, 6, NFS_MAX_TRANSFER_SIZE + 20, content,
+                       NFS__STAT__NFSERR_FBIG);
+
+    free(content);
+
+    free_rpc_connection_context(rpc_connection_context);
+}
+
+Test(nfs_write_test_suite, write_max_transfer_size_ok,
+     .description = "NFSPROC_WRITE ok with NFS_MAX_TRANSFER_SIZE bytes in nfsdata") {
+    RpcConnectionContext *rpc_connection_context = create_test_rpc_connection_context(TEST_TRANSPORT_PROTOCOL);
+    if (rpc_connection_context == NULL) {
+        cr_fatal("write_max_transfer_size_ok: Failed to connect to the server\n");
+    }
+
+    Mount__FhStatus *fhstatus = mount_directory_success(rpc_connection_context, "/nfs_share");
+
+    // lookup the write_test directory inside the mounted directory
+    Nfs__FHandle fhandle = NFS__FHANDLE__INIT;
+    NfsFh__NfsFileHandle nfs_filehandle_copy = deep_copy_nfs_filehandle(fhstatus->directory->nfs_filehandle);
+    mount__fh_status__free_unpacked(fhstatus, NULL);
+    fhandle.nfs_filehandle = &nfs_filehandle_copy;
+
+    Nfs__DirOpRes *write_test_dir_diropres =
+        lookup_file_or_directory_success(rpc_connection_context, &fhandle, "write_test", NFS__FTYPE__NFDIR);
+
+    // create a new file inside this /nfs_share/write_test directory
+    Nfs__FHandle write_test_dir_fhandle = NFS__FHANDLE__INIT;
+    NfsFh__NfsFileHandle write_test_dir_nfs_filehandle_copy =
+        deep_copy_nfs_filehandle(write_test_dir_diropres->diropok->file->nfs_filehandle);
+    nfs__dir_op_res__free_unpacked(write_test_dir_diropres, NULL);
+    write_test_dir_fhandle.nfs_filehandle = &write_test_dir_nfs_filehandle_copy;
+
+    Nfs__TimeVal atime = NFS__TIME_VAL__INIT, mtime = NFS__TIME_VAL__INIT;
+    atime.seconds = atime.useconds = mtime.seconds = mtime.useconds = 0;
+
+    Nfs__DirOpRes *diropres =
+        create_file_success(rpc_connection_context, &write_test_dir_fhandle, "write_max_transfer_size_file.txt", 0666,
+                            0, 0, 0, &atime, &mtime, NFS__FTYPE__NFREG);
+
     Nfs__FHandle file_fhandle = NFS__FHANDLE__INIT;
     NfsFh__NfsFileHandle file_nfs_filehandle_copy = deep_copy_nfs_filehandle(diropres->diropok->file->nfs_filehandle);
     nfs__dir_op_res__free_unpacked(diropres, NULL);
     file_fhandle.nfs_filehandle = &file_nfs_filehandle_copy;
 
-    uint8_t *content = malloc(sizeof(uint8_t) * (NFS_MAXDATA + 20));
-    memset(content, 'a', NFS_MAXDATA + 20);
-    write_to_file_fail(rpc_connection_context, &file_fhandle, 6, NFS_MAXDATA + 20, content, NFS__STAT__NFSERR_FBIG);
+    // write NFS_MAX_TRANSFER_SIZE bytes in a single RPC - over QUIC this call is larger than the stream's initial
+    // flow control window, so it is only sent whole if the client resumes writing it on later writable events
+    uint8_t *content = malloc(sizeof(uint8_t) * NFS_MAX_TRANSFER_SIZE);
+    cr_assert_not_null(content);
+    for (size_t i = 0; i < NFS_MAX_TRANSFER_SIZE; i++) {
+        content[i] = (uint8_t)(i % 251); // a prime period, so that misplaced chunks of the record don't match
+    }
+
+    Nfs__AttrStat *attrstat = write_to_file_success(rpc_connection_context, &file_fhandle, 0, NFS_MAX_TRANSFER_SIZE,
+                                                    content, NFS__FTYPE__NFREG);
+    cr_assert_eq(attrstat->attributes->size, NFS_MAX_TRANSFER_SIZE);
+
+    // read the whole file back to confirm that every byte arrived in place
+    Nfs__ReadRes *readres = read_from_file_success(rpc_connection_context, &file_fhandle, 0, NFS_MAX_TRANSFER_SIZE,
+                                                   attrstat->attributes, NFS_MAX_TRANSFER_SIZE, content);
 
     free(content);
+    nfs__attr_stat__free_unpacked(attrstat, NULL);
+    nfs__read_res__free_unpacked(readres, NULL);
+
+    free_rpc_connection_context(rpc_connection_context);
+}
+
+/*
+ * Compression tests - only the protobuf codec carries compressed data
+ */
+
+#define COMPRESSION_TEST_DATA_SIZE NFS_MAXDATA
+
+/*
+ * Skips the test if the given compression can't be sent to the server, because the test codec has no room for it or
+ * the server and client are built without compression.
+ */
+static void skip_unless_compression_sent(RpcConnectionContext *rpc_connection_context, RpcCompression compression) {
+    if (rpc_connection_context->rpc_codec != RPC_CODEC_PROTOBUF || !is_rpc_compression_supported(compression)) {
+        free_rpc_connection_context(rpc_connection_context);
+        cr_skip_test("compression %d is not sent with this codec and build\n", compression);
+    }
+}
+
+/*
+ * Fills the given buffer with data that compresses well.
+ */
+static void fill_with_compressible_data(uint8_t *buffer, size_t size) {
+    const char *pattern = "compressible write data ";
+    for (size_t i = 0; i < size; i++) {
+        buffer[i] = pattern[i % strlen(pattern)];
+    }
+}
+
+/*
+ * Creates an empty file with the given filename in the /nfs_share/write_test directory, and places its filehandle in
+ * 'file_nfs_filehandle'.
+ */
+static void create_compression_test_file(RpcConnectionContext *rpc_connection_context, char *filename,
+                                         NfsFh__NfsFileHandle *file_nfs_filehandle) {
+    Mount__FhStatus *fhstatus = mount_directory_success(rpc_connection_context, "/nfs_share");
+
+    Nfs__FHandle fhandle = NFS__FHANDLE__INIT;
+    NfsFh__NfsFileHandle nfs_filehandle_copy = deep_copy_nfs_filehandle(fhstatus->directory->nfs_filehandle);
+    mount__fh_status__free_unpacked(fhstatus, NULL);
+    fhandle.nfs_filehandle = &nfs_filehandle_copy;
+
+    Nfs__DirOpRes *write_test_dir_diropres =
+        lookup_file_or_directory_success(rpc_connection_context, &fhandle, "write_test", NFS__FTYPE__NFDIR);
+
+    Nfs__FHandle write_test_dir_fhandle = NFS__FHANDLE__INIT;
+    NfsFh__NfsFileHandle write_test_dir_nfs_filehandle_copy =
+        deep_copy_nfs_filehandle(write_test_dir_diropres->diropok->file->nfs_filehandle);
+    nfs__dir_op_res__free_unpacked(write_test_dir_diropres, NULL);
+    write_test_dir_fhandle.nfs_filehandle = &write_test_dir_nfs_filehandle_copy;
+
+    Nfs__TimeVal atime = NFS__TIME_VAL__INIT, mtime = NFS__TIME_VAL__INIT;
+    atime.seconds = atime.useconds = mtime.seconds = mtime.useconds = 0;
+
+    Nfs__DirOpRes *diropres = create_file_success(rpc_connection_context, &write_test_dir_fhandle, filename, 0666, 0,
+                                                  0, 0, &atime, &mtime, NFS__FTYPE__NFREG);
+    *file_nfs_filehandle = deep_copy_nfs_filehandle(diropres->diropok->file->nfs_filehandle);
+    nfs__dir_op_res__free_unpacked(diropres, NULL);
+}
+
+/*
+ * Calls NFSPROC_WRITE with the given parameters over the test transport protocol, and returns the RPC reply without
+ * validating it.
+ *
+ * The user of this function takes the responsibility to free the returned reply with 'rpc__rpc_msg__free_unpacked'.
+ */
+static Rpc__RpcMsg *call_write_procedure(RpcConnectionContext *rpc_connection_context, Nfs__WriteArgs *writeargs) {
+    RpcCodec codec = rpc_connection_context->rpc_codec;
+
+    size_t writeargs_size = get_rpc_payload_packed_size(codec, &writeargs->base);
+    uint8_t *writeargs_buffer = malloc(writeargs_size);
+    cr_assert_not_null(writeargs_buffer);
+    pack_rpc_payload(codec, &writeargs->base, writeargs_buffer);
+
+    Google__Protobuf__Any parameters = GOOGLE__PROTOBUF__ANY__INIT;
+    parameters.type_url = "nfs/WriteArgs";
+    parameters.value.data = writeargs_buffer;
+    parameters.value.len = writeargs_size;
+
+    Rpc__RpcMsg *rpc_reply;
+    switch (rpc_connection_context->transport_protocol) {
+    case TRANSPORT_PROTOCOL_QUIC:
+        rpc_reply = invoke_rpc_remote_quic(rpc_connection_context, NFS_RPC_PROGRAM_NUMBER, NFS_VERSION_LOW,
+                                           NFSPROC_WRITE, parameters, true);
+        break;
+    case TRANSPORT_PROTOCOL_SHM:
+        rpc_reply = invoke_rpc_remote_shm(rpc_connection_context, NFS_RPC_PROGRAM_NUMBER, NFS_VERSION_LOW,
+                                          NFSPROC_WRITE, parameters);
+        break;
+    case TRANSPORT_PROTOCOL_TCP:
+    case TRANSPORT_PROTOCOL_TLS:
+    default:
+        rpc_reply = invoke_rpc_remote_tcp(rpc_connection_context, NFS_RPC_PROGRAM_NUMBER, NFS_VERSION_LOW,
+                                          NFSPROC_WRITE, parameters);
+    }
+    free(writeargs_buffer);
+
+    return rpc_reply;
+}
+
+Test(nfs_write_test_suite, write_compressed_ok, .description = "NFSPROC_WRITE ok with compressed nfsdata") {
+    RpcConnectionContext *rpc_connection_context = create_test_rpc_connection_context(TEST_TRANSPORT_PROTOCOL);
+    if (rpc_connection_context == NULL) {
+        cr_fatal("write_compressed_ok: Failed to connect to the server\n");
+    }
+    skip_unless_compression_sent(rpc_connection_context, RPC_COMPRESSION_LZ4);
+
+    Nfs__FHandle file_fhandle = NFS__FHANDLE__INIT;
+    NfsFh__NfsFileHandle file_nfs_filehandle;
+    create_compression_test_file(rpc_connection_context, "compressed_write_test_file.txt", &file_nfs_filehandle);
+    file_fhandle.nfs_filehandle = &file_nfs_filehandle;
+
+    RpcCompression compressions[] = {RPC_COMPRESSION_LZ4, RPC_COMPRESSION_ZSTD};
+    for (size_t i = 0; i < sizeof(compressions) / sizeof(compressions[0]); i++) {
+        // each compression writes different data, so that the read below shows this write took place
+        uint8_t *content = malloc(COMPRESSION_TEST_DATA_SIZE);
+        fill_with_compressible_data(content, COMPRESSION_TEST_DATA_SIZE);
+        content[0] = '0' + i;
+
+        uint8_t *compressed_content = malloc(get_rpc_compression_bound(compressions[i], COMPRESSION_TEST_DATA_SIZE));
+        size_t compressed_size;
+        cr_assert_eq(compress_rpc_payload_data(&rpc_connection_context->compression_policy, compressions[i],
+                                               file_nfs_filehandle.inode_number, content, COMPRESSION_TEST_DATA_SIZE,
+                                               compressed_content, &compressed_size),
+                     0);
+        cr_assert_lt(compressed_size, COMPRESSION_TEST_DATA_SIZE);
+
+        // the connection has no compression of its own, so the data is sent as compressed here
+        Nfs__WriteArgs writeargs = NFS__WRITE_ARGS__INIT;
+        writeargs.file = &file_fhandle;
+        writeargs.offset = 0;
+        writeargs.nfsdata.data = compressed_content;
+        writeargs.nfsdata.len = compressed_size;
+        writeargs.compression = compressions[i];
+        writeargs.uncompressed_size = COMPRESSION_TEST_DATA_SIZE;
+
+        Nfs__AttrStat *attrstat = malloc(sizeof(Nfs__AttrStat));
+        int status = nfs_procedure_8_write_to_file(rpc_connection_context, writeargs, attrstat);
+        free(compressed_content);
+        if (status != 0) {
+            free(attrstat);
+            cr_fatal("NFSPROC_WRITE failed - status %d\n", status);
+        }
+        cr_assert_eq(attrstat->nfs_status->stat, NFS__STAT__NFS_OK);
+        cr_assert_eq(attrstat->attributes->size, COMPRESSION_TEST_DATA_SIZE);
+
+        // the file holds the data as it was before compression
+        Nfs__ReadRes *readres =
+            read_from_file_success(rpc_connection_context, &file_fhandle, 0, COMPRESSION_TEST_DATA_SIZE,
+                                   attrstat->attributes, COMPRESSION_TEST_DATA_SIZE, content);
+        nfs__read_res__free_unpacked(readres, NULL);
+        nfs__attr_stat__free_unpacked(attrstat, NULL);
+
+        free(content);
+    }
+
+    free_rpc_connection_context(rpc_connection_context);
+}
+
+Test(nfs_write_test_suite, write_compressed_too_much_data,
+     .description = "NFSPROC_WRITE compressed nfsdata of more than NFS_MAX_TRANSFER_SIZE bytes") {
+    RpcConnectionContext *rpc_connection_context = create_test_rpc_connection_context(TEST_TRANSPORT_PROTOCOL);
+    if (rpc_connection_context == NULL) {
+        cr_fatal("write_compressed_too_much_data: Failed to connect to the server\n");
+    }
+    skip_unless_compression_sent(rpc_connection_context, RPC_COMPRESSION_LZ4);
+
+    Nfs__FHandle file_fhandle = NFS__FHANDLE__INIT;
+    NfsFh__NfsFileHandle file_nfs_filehandle;
+    create_compression_test_file(rpc_connection_context, "compressed_write_too_much_data_file.txt",
+                                 &file_nfs_filehandle);
+    file_fhandle.nfs_filehandle = &file_nfs_filehandle;
+
+    uint8_t *content = malloc(COMPRESSION_TEST_DATA_SIZE);
+    fill_with_compressible_data(content, COMPRESSION_TEST_DATA_SIZE);
+
+    uint8_t *compressed_content = malloc(get_rpc_compression_bound(RPC_COMPRESSION_LZ4, COMPRESSION_TEST_DATA_SIZE));
+    size_t compressed_size;
+    cr_assert_eq(compress_rpc_payload_data(&rpc_connection_context->compression_policy, RPC_COMPRESSION_LZ4,
+                                           file_nfs_filehandle.inode_number, content, COMPRESSION_TEST_DATA_SIZE,
+                                           compressed_content, &compressed_size),
+                 0);
+    free(content);
+
+    // small once compressed, but claiming to be more than the server takes in a single RPC
+    Nfs__WriteArgs writeargs = NFS__WRITE_ARGS__INIT;
+    writeargs.file = &file_fhandle;
+    writeargs.offset = 0;
+    writeargs.nfsdata.data = compressed_content;
+    writeargs.nfsdata.len = compressed_size;
+    writeargs.compression = RPC_COMPRESSION_LZ4;
+    writeargs.uncompressed_size = NFS_MAX_TRANSFER_SIZE + 1;
+
+    Nfs__AttrStat *attrstat = malloc(sizeof(Nfs__AttrStat));
+    int status = nfs_procedure_8_write_to_file(rpc_connection_context, writeargs, attrstat);
+    free(compressed_content);
+    if (status != 0) {
+        free(attrstat);
+        cr_fatal("NFSPROC_WRITE failed - status %d\n", status);
+    }
+    cr_assert_eq(attrstat->nfs_status->stat, NFS__STAT__NFSERR_FBIG);
+    cr_assert_eq(attrstat->body_case, NFS__ATTR_STAT__BODY_DEFAULT_CASE);
+    nfs__attr_stat__free_unpacked(attrstat, NULL);
+
+    // and nothing was written
+    Nfs__AttrStat *file_attrstat = get_attributes_success(rpc_connection_context, file_fhandle, NFS__FTYPE__NFREG);
+    cr_assert_eq(file_attrstat->attributes->size, 0);
+    nfs__attr_stat__free_unpacked(file_attrstat, NULL);
+
+    free_rpc_connection_context(rpc_connection_context);
+}
+
+Test(nfs_write_test_suite, write_compressed_corrupt_data,
+     .description = "NFSPROC_WRITE corrupt compressed nfsdata is garbage arguments") {
+    RpcConnectionContext *rpc_connection_context = create_test_rpc_connection_context(TEST_TRANSPORT_PROTOCOL);
+    if (rpc_connection_context == NULL) {
+        cr_fatal("write_compressed_corrupt_data: Failed to connect to the server\n");
+    }
+    skip_unless_compression_sent(rpc_connection_context, RPC_COMPRESSION_LZ4);
+
+    Nfs__FHandle file_fhandle = NFS__FHANDLE__INIT;
+    NfsFh__NfsFileHandle file_nfs_filehandle;
+    create_compression_test_file(rpc_connection_context, "compressed_write_corrupt_data_file.txt",
+                                 &file_nfs_filehandle);
+    file_fhandle.nfs_filehandle = &file_nfs_filehandle;
+
+    uint8_t *content = malloc(COMPRESSION_TEST_DATA_SIZE);
+    fill_with_compressible_data(content, COMPRESSION_TEST_DATA_SIZE);
+
+    uint8_t *compressed_content = malloc(get_rpc_compression_bound(RPC_COMPRESSION_LZ4, COMPRESSION_TEST_DATA_SIZE));
+    size_t compressed_size;
+    cr_assert_eq(compress_rpc_payload_data(&rpc_connection_context->compression_policy, RPC_COMPRESSION_LZ4,
+                                           file_nfs_filehandle.inode_number, content, COMPRESSION_TEST_DATA_SIZE,
+                                           compressed_content, &compressed_size),
+                 0);
+    free(content);
+
+    uint8_t garbage[64];
+    memset(garbage, 0xff, sizeof(garbage));
+
+    Nfs__WriteArgs writeargs = NFS__WRITE_ARGS__INIT;
+    writeargs.file = &file_fhandle;
+    writeargs.offset = 0;
+    writeargs.compression = RPC_COMPRESSION_LZ4;
+
+    // data that isn't LZ4 at all, data that decompresses to fewer bytes than claimed, and data whose end is cut off
+    ProtobufCBinaryData corrupt_nfsdata[] = {
+        {.data = garbage, .len = sizeof(garbage)},
+        {.data = compressed_content, .len = compressed_size},
+        {.data = compressed_content, .len = compressed_size / 2},
+    };
+    size_t uncompressed_sizes[] = {COMPRESSION_TEST_DATA_SIZE, COMPRESSION_TEST_DATA_SIZE + 1,
+                                   COMPRESSION_TEST_DATA_SIZE};
+    for (size_t i = 0; i < sizeof(uncompressed_sizes) / sizeof(uncompressed_sizes[0]); i++) {
+        writeargs.nfsdata = corrupt_nfsdata[i];
+        writeargs.uncompressed_size = uncompressed_sizes[i];
+
+        Rpc__RpcMsg *rpc_reply = call_write_procedure(rpc_connection_context, &writeargs);
+        cr_assert_not_null(rpc_reply);
+        cr_assert_eq(rpc_reply->body_case, RPC__RPC_MSG__BODY_RBODY);
+        cr_assert_eq(rpc_reply->rbody->stat, RPC__REPLY_STAT__MSG_ACCEPTED);
+        cr_assert_eq(rpc_reply->rbody->reply_case, RPC__REPLY_BODY__REPLY_AREPLY);
+        cr_assert_eq(rpc_reply->rbody->areply->stat, RPC__ACCEPT_STAT__GARBAGE_ARGS);
+        rpc__rpc_msg__free_unpacked(rpc_reply, NULL);
+    }
+    free(compressed_content);
+
+    // and nothing was written
+    Nfs__AttrStat *file_attrstat = get_attributes_success(rpc_connection_context, file_fhandle, NFS__FTYPE__NFREG);
+    cr_assert_eq(file_attrstat->attributes->size, 0);
+    nfs__attr_stat__free_unpacked(file_attrstat, NULL);
 
     free_rpc_connection_context(rpc_connection_context);
 }
@@ -4,6 +4,25 @@
  * Common test functions
  */
 
+/*
+ * Creates a RpcConnectionContext with the test server IP address and test server port, and the given credential,
+ * verifier and transport protocol, whose RPCs are encoded with the TEST_RPC_CODEC codec.
+ *
+ * Returns NULL on failure.
+ */
+static RpcConnectionContext *create_test_server_rpc_connection_context(Rpc__OpaqueAuth *credential,
+                                                                       Rpc__OpaqueAuth *verifier,
+                                                                       TransportProtocol transport_protocol) {
+    RpcConnectionContext *rpc_connection_context =
+        create_rpc_connection_context(NFS_AND_MOUNT_TEST_RPC_SERVER_IPV4_ADDR, NFS_AND_MOUNT_TEST_RPC_SERVER_PORT,
+                                      credential, verifier, transport_protocol);
+    if (rpc_connection_context != NULL) {
+        rpc_connection_context->rpc_codec = TEST_RPC_CODEC;
+    }
+
+    return rpc_connection_context;
+}
+
 /*
  * Creates a RpcConnectionContext with the test server IP address and test server port,
  * and an AUTH_SYS credential+verifier pair with uid=0 (tests are a NFS client that is a root user),
@@ -20,8 +39,7 @@ RpcConnectionContext *create_test_rpc_connection_context(TransportProtocol trans
 
     Rpc__OpaqueAuth *verifier = create_auth_none_opaque_auth();
 
-    return create_rpc_connection_context(NFS_AND_MOUNT_TEST_RPC_SERVER_IPV4_ADDR, NFS_AND_MOUNT_TEST_RPC_SERVER_PORT,
-                                         root_credential, verifier, transport_protocol);
+    return create_test_server_rpc_connection_context(root_credential, verifier, transport_protocol);
 }
 
 /*
@@ -36,6 +54,5 @@ RpcConnectionContext *create_test_rpc_connection_context(TransportProtocol trans
 RpcConnectionContext *create_rpc_connection_context_with_test_ipaddr_and_port(Rpc__OpaqueAuth *credential,
                                                                               Rpc__OpaqueAuth *verifier,
                                                                               TransportProtocol transport_protocol) {
-    return create_rpc_connection_context(NFS_AND_MOUNT_TEST_RPC_SERVER_IPV4_ADDR, NFS_AND_MOUNT_TEST_RPC_SERVER_PORT,
-                                         credential, verifier, transport_protocol);
+    return create_test_server_rpc_connection_context(credential, verifier, transport_protocol);
 }
\ No newline at end of file
@@ -5,6 +5,10 @@
 #define TEST_TRANSPORT_PROTOCOL TRANSPORT_PROTOCOL_TCP // by default we use TCP in tests
 #endif
 
+#ifndef TEST_RPC_CODEC
+#define TEST_RPC_CODEC RPC_CODEC_PROTOBUF // by default we use protobuf in tests
+#endif
+
 // Mount and Nfs server are the same process
 #define NFS_AND_MOUNT_TEST_RPC_SERVER_IPV4_ADDR "192.168.100.1"
 #define NFS_AND_MOUNT_TEST_RPC_SERVER_PORT 3000
@@ -20,9 +24,11 @@
 #define NFS_SHARE_ENTRIES                                                                                              \
     {                                                                                                                  \
         "..", ".", "write_test", "readlink_test", "create_test", "remove_test", "rename_test", "link_test",            \
-            "symlink_test", "mkdir_test", "rmdir_test", "permission_test", "a.txt", "test_file.txt", "large_file.txt"  \
+            "symlink_test", "mkdir_test", "rmdir_test", "permission_test", "readdir_test", "a.txt", "test_file.txt",   \
+            "large_file.txt"                                                                                           \
     }
-#define NFS_SHARE_NUMBER_OF_ENTRIES 15
+#define NFS_SHARE_NUMBER_OF_ENTRIES 16
+#define READDIR_TEST_NUMBER_OF_FILES 100 // files in /nfs_share/readdir_test, apart from '.' and '..'
 
 #include <time.h>
 